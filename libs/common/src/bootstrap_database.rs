@@ -174,6 +174,36 @@ pub async fn setup_redis_with_config(
     Ok((url, Arc::new(client)))
 }
 
+/// Connect the additional Redis shards
+///
+/// Returns every shard client in shard order, starting with `primary`
+/// (shard 0). Each shard gets its own pool sized like `redis_config`.
+pub async fn setup_redis_shards(
+    primary: Arc<RedisClient>,
+    shard_urls: &[String],
+    redis_config: crate::redis::RedisPoolConfig,
+) -> VoltageResult<Vec<Arc<RedisClient>>> {
+    let mut clients = Vec::with_capacity(shard_urls.len() + 1);
+    clients.push(primary);
+
+    for (index, url) in shard_urls.iter().enumerate() {
+        let mut config = redis_config.clone();
+        config.url = url.clone();
+        let client = RedisClient::with_config(config).await.map_err(|e| {
+            VoltageError::Internal(format!(
+                "Failed to connect Redis shard {} ({}): {}",
+                index + 1,
+                url,
+                e
+            ))
+        })?;
+        info!("Redis shard {} connected: {}", index + 1, url);
+        clients.push(Arc::new(client));
+    }
+
+    Ok(clients)
+}
+
 /// Validate database exists and has required tables
 pub async fn validate_sqlite_schema(
     pool: &SqlitePool,
@@ -195,6 +195,13 @@ pub struct RedisConfig {
     /// Whether Redis is enabled
     #[serde(default = "crate::serde_helpers::bool_true")]
     pub enabled: bool,
+
+    /// Additional Redis shards (shard 1..N; `url` is shard 0)
+    ///
+    /// Channel keys are placed by channel_id, instance keys by instance_id.
+    /// Every service must list the same shards in the same order.
+    #[serde(default = "default_redis_shard_urls")]
+    pub shard_urls: Vec<String>,
 }
 
 // ============================================================================
@@ -254,6 +261,18 @@ fn default_redis_url() -> String {
     env::var("REDIS_URL").unwrap_or_else(|_| DEFAULT_REDIS_URL.to_string())
 }
 
+fn default_redis_shard_urls() -> Vec<String> {
+    env::var("REDIS_SHARD_URLS")
+        .map(|urls| {
+            urls.split(',')
+                .map(str::trim)
+                .filter(|url| !url.is_empty())
+                .map(str::to_string)
+                .collect()
+        })
+        .unwrap_or_default()
+}
+
 fn default_log_level() -> String {
     env::var("RUST_LOG").unwrap_or_else(|_| "info".to_string())
 }
@@ -285,6 +304,7 @@ impl Default for RedisConfig {
         Self {
             url: default_redis_url(),
             enabled: true,
+            shard_urls: default_redis_shard_urls(),
         }
     }
 }
@@ -833,6 +853,17 @@ impl RedisConfig {
         } else if !self.url.starts_with("redis://") && !self.url.starts_with("rediss://") {
             result.add_warning("Redis URL should start with redis:// or rediss://".to_string());
         }
+        for url in &self.shard_urls {
+            if !url.starts_with("redis://") && !url.starts_with("rediss://") {
+                result.add_warning(format!(
+                    "Redis shard URL should start with redis:// or rediss://: {}",
+                    url
+                ));
+            }
+            if *url == self.url {
+                result.add_error(format!("Redis shard URL duplicates the primary: {}", url));
+            }
+        }
     }
 
     /// Validate Redis connectivity (runtime check)
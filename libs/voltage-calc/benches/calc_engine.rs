@@ -0,0 +1,82 @@
+//! CalcEngine benchmarks
+//!
+//! - Compiled formula evaluation (`evaluate_simple`, async `evaluate`)
+//! - evalexpr fallback for formulas outside the compiled subset
+//! - Column-wise `BatchFormula` vs a per-row loop
+//!
+//! Run: `cargo bench -p voltage-calc`
+
+#![allow(clippy::disallowed_methods)] // unwrap is fine in benches
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use std::collections::HashMap;
+use std::hint::black_box;
+use std::sync::Arc;
+use voltage_calc::{BatchFormula, CalcEngine, MemoryStateStore};
+
+const FORMULA: &str = "clamp(P * 0.95 + Q / 2, 0, 1000)";
+
+fn variables() -> HashMap<String, f64> {
+    HashMap::from([("P".to_string(), 820.0), ("Q".to_string(), 35.0)])
+}
+
+fn bench_evaluate(c: &mut Criterion) {
+    let rt = tokio::runtime::Builder::new_current_thread()
+        .build()
+        .unwrap();
+    let engine = CalcEngine::new(Arc::new(MemoryStateStore::new()), "bench");
+    let vars = variables();
+    let mut group = c.benchmark_group("calc_engine");
+
+    group.bench_function("evaluate_simple", |b| {
+        b.iter(|| engine.evaluate_simple(black_box(FORMULA), &vars).unwrap())
+    });
+    group.bench_function("evaluate_simple_evalexpr_fallback", |b| {
+        b.iter(|| {
+            engine
+                .evaluate_simple(black_box("math::sqrt(P) + Q"), &vars)
+                .unwrap()
+        })
+    });
+    group.bench_function("evaluate", |b| {
+        b.iter(|| {
+            rt.block_on(engine.evaluate(black_box(FORMULA), &vars))
+                .unwrap()
+        })
+    });
+    group.bench_function("evaluate_stateful", |b| {
+        b.iter(|| {
+            rt.block_on(engine.evaluate(black_box("integrate(P) + Q"), &vars))
+                .unwrap()
+        })
+    });
+    group.finish();
+}
+
+fn bench_batch(c: &mut Criterion) {
+    let batch = BatchFormula::compile(FORMULA).unwrap();
+    let mut group = c.benchmark_group("batch_formula");
+
+    for rows in [200usize, 10_000] {
+        let p: Vec<f64> = (0..rows).map(|i| i as f64 * 1.5).collect();
+        let q: Vec<f64> = (0..rows).map(|i| (i % 17) as f64 - 8.0).collect();
+        let mut out = vec![0.0; rows];
+        group.throughput(Throughput::Elements(rows as u64));
+
+        group.bench_with_input(BenchmarkId::new("columns", rows), &rows, |b, _| {
+            b.iter(|| batch.eval(&[&p, &q], black_box(&mut out)).unwrap())
+        });
+        group.bench_with_input(BenchmarkId::new("per_row", rows), &rows, |b, _| {
+            b.iter(|| {
+                for (i, slot) in out.iter_mut().enumerate() {
+                    *slot = batch.formula().eval(&[p[i], q[i]]).unwrap();
+                }
+                black_box(&out);
+            })
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_evaluate, bench_batch);
+criterion_main!(benches);
@@ -0,0 +1,492 @@
+//! BatchFormula - One stateless formula evaluated over columns of inputs
+//!
+//! Instances of the same product run identical formulas on different inputs.
+//! A [`BatchFormula`] lowers a [`CompiledFormula`] into a flat program over
+//! f64 columns (struct-of-arrays: one slice per variable, one element per
+//! instance), so a tick runs one tight loop per operator instead of one tree
+//! walk per instance.
+//!
+//! Types are resolved while lowering: constant subtrees are folded, booleans
+//! are stored as 0.0 / 1.0 and the typed `==` of a float column against an
+//! integer literal folds to its constant result. Formulas whose types depend
+//! on the data (e.g. `if` with an integer literal branch) keep a row-by-row
+//! loop over [`CompiledFormula::eval`], with the same results.
+
+use crate::builtin_functions;
+use crate::compiled::{BinOp, CompiledFormula, Expr, Func, UnOp, Val};
+use crate::error::{CalcError, Result};
+
+/// Column type of a lowered value
+#[derive(Debug, Clone, Copy, PartialEq)]
+enum Ty {
+    Float,
+    Bool,
+}
+
+/// Column source: input variable or program register
+#[derive(Debug, Clone, Copy)]
+enum Src {
+    Input(usize),
+    Reg(usize),
+}
+
+#[derive(Debug, Clone, Copy)]
+enum Lowered {
+    Const(Val),
+    Column(Src, Ty),
+}
+
+#[derive(Debug, Clone, Copy)]
+enum Op {
+    Fill(f64),
+    Neg,
+    Not,
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Eq,
+    Ne,
+    Gt,
+    Lt,
+    Ge,
+    Le,
+    And,
+    Or,
+    Scale,
+    Clamp,
+    Abs,
+    Min,
+    Max,
+    Round(i32),
+    Sign,
+    Select,
+}
+
+#[derive(Debug, Clone)]
+struct Instr {
+    op: Op,
+    args: [Src; 3],
+    dst: usize,
+}
+
+/// Register program; register `n` is only read by instructions after the one writing it
+#[derive(Debug, Clone)]
+struct Program {
+    instrs: Vec<Instr>,
+    regs: usize,
+    result: Lowered,
+}
+
+/// Stateless formula prepared for column-wise evaluation
+#[derive(Debug, Clone)]
+pub struct BatchFormula {
+    formula: CompiledFormula,
+    /// `None` when lowering failed (row-by-row fallback)
+    program: Option<Program>,
+}
+
+impl BatchFormula {
+    /// Prepare a compiled formula for batch evaluation
+    ///
+    /// Stateful formulas are rejected: their state is per context, not per column.
+    pub fn new(formula: CompiledFormula) -> Result<Self> {
+        if formula.is_stateful() {
+            return Err(CalcError::expression(format!(
+                "Formula '{}' needs state, cannot batch",
+                formula.source()
+            )));
+        }
+        let mut lowering = Lowering::default();
+        let program = match lowering.lower(formula.expr()) {
+            Ok(result) => Some(Program {
+                instrs: lowering.instrs,
+                regs: lowering.regs,
+                result,
+            }),
+            Err(e) => {
+                tracing::debug!("Formula '{}' not vectorized: {}", formula.source(), e);
+                None
+            },
+        };
+        Ok(Self { formula, program })
+    }
+
+    /// Parse and prepare a formula
+    pub fn compile(formula: &str) -> Result<Self> {
+        Self::new(CompiledFormula::compile(formula)?)
+    }
+
+    /// Underlying compiled formula
+    pub fn formula(&self) -> &CompiledFormula {
+        &self.formula
+    }
+
+    /// Whether evaluation runs column-wise (false = row-by-row fallback)
+    pub fn is_vectorized(&self) -> bool {
+        self.program.is_some()
+    }
+
+    /// Evaluate over `out.len()` rows
+    ///
+    /// `columns[v][row]` is the value of [`CompiledFormula::variables`]`[v]`
+    /// for that row; each column needs at least `out.len()` entries.
+    pub fn eval(&self, columns: &[&[f64]], out: &mut [f64]) -> Result<()> {
+        let rows = out.len();
+        let vars = self.formula.variables().len();
+        if columns.len() < vars || columns[..vars].iter().any(|c| c.len() < rows) {
+            return Err(CalcError::expression(format!(
+                "Formula '{}' expects {} columns of {} rows",
+                self.formula.source(),
+                vars,
+                rows
+            )));
+        }
+
+        let Some(program) = &self.program else {
+            let mut row = vec![0.0; vars];
+            for (i, slot) in out.iter_mut().enumerate() {
+                for (v, col) in row.iter_mut().zip(columns) {
+                    *v = col[i];
+                }
+                *slot = self.formula.eval(&row)?;
+            }
+            return Ok(());
+        };
+        program.run(columns, out);
+        Ok(())
+    }
+}
+
+impl Program {
+    fn run(&self, columns: &[&[f64]], out: &mut [f64]) {
+        let n = out.len();
+        let mut regs = vec![0.0; self.regs * n];
+        for instr in &self.instrs {
+            let (done, rest) = regs.split_at_mut(instr.dst * n);
+            let dst = &mut rest[..n];
+            let col = |src: Src| match src {
+                Src::Input(i) => &columns[i][..n],
+                Src::Reg(r) => &done[r * n..(r + 1) * n],
+            };
+            let [a, b, c] = instr.args;
+            let flag = |x: bool| if x { 1.0 } else { 0.0 };
+            match instr.op {
+                Op::Fill(v) => dst.fill(v),
+                Op::Neg => map1(dst, col(a), |x| -x),
+                Op::Not => map1(dst, col(a), |x| 1.0 - x),
+                Op::Add => map2(dst, col(a), col(b), |x, y| x + y),
+                Op::Sub => map2(dst, col(a), col(b), |x, y| x - y),
+                Op::Mul => map2(dst, col(a), col(b), |x, y| x * y),
+                Op::Div => map2(dst, col(a), col(b), |x, y| x / y),
+                Op::Mod => map2(dst, col(a), col(b), |x, y| x % y),
+                Op::Pow => map2(dst, col(a), col(b), f64::powf),
+                Op::Eq => map2(dst, col(a), col(b), |x, y| flag(x == y)),
+                Op::Ne => map2(dst, col(a), col(b), |x, y| flag(x != y)),
+                Op::Gt => map2(dst, col(a), col(b), |x, y| flag(x > y)),
+                Op::Lt => map2(dst, col(a), col(b), |x, y| flag(x < y)),
+                Op::Ge => map2(dst, col(a), col(b), |x, y| flag(x >= y)),
+                Op::Le => map2(dst, col(a), col(b), |x, y| flag(x <= y)),
+                Op::And => map2(dst, col(a), col(b), |x, y| flag(x != 0.0 && y != 0.0)),
+                Op::Or => map2(dst, col(a), col(b), |x, y| flag(x != 0.0 || y != 0.0)),
+                Op::Scale => map2(dst, col(a), col(b), builtin_functions::scale),
+                Op::Clamp => map3(dst, col(a), col(b), col(c), builtin_functions::clamp),
+                Op::Abs => map1(dst, col(a), builtin_functions::abs),
+                Op::Min => map2(dst, col(a), col(b), builtin_functions::min),
+                Op::Max => map2(dst, col(a), col(b), builtin_functions::max),
+                Op::Round(d) => map1(dst, col(a), |x| builtin_functions::round(x, d)),
+                Op::Sign => map1(dst, col(a), builtin_functions::sign),
+                Op::Select => map3(
+                    dst,
+                    col(a),
+                    col(b),
+                    col(c),
+                    |s, x, y| {
+                        if s != 0.0 {
+                            x
+                        } else {
+                            y
+                        }
+                    },
+                ),
+            }
+        }
+
+        match self.result {
+            Lowered::Const(v) => out.fill(v.into_f64()),
+            Lowered::Column(Src::Input(i), _) => out.copy_from_slice(&columns[i][..n]),
+            Lowered::Column(Src::Reg(r), _) => out.copy_from_slice(&regs[r * n..(r + 1) * n]),
+        }
+    }
+}
+
+#[inline]
+fn map1(dst: &mut [f64], a: &[f64], f: impl Fn(f64) -> f64) {
+    for (d, &x) in dst.iter_mut().zip(a) {
+        *d = f(x);
+    }
+}
+
+#[inline]
+fn map2(dst: &mut [f64], a: &[f64], b: &[f64], f: impl Fn(f64, f64) -> f64) {
+    for ((d, &x), &y) in dst.iter_mut().zip(a).zip(b) {
+        *d = f(x, y);
+    }
+}
+
+#[inline]
+fn map3(dst: &mut [f64], a: &[f64], b: &[f64], c: &[f64], f: impl Fn(f64, f64, f64) -> f64) {
+    for (((d, &x), &y), &z) in dst.iter_mut().zip(a).zip(b).zip(c) {
+        *d = f(x, y, z);
+    }
+}
+
+// ============================================================================
+// Lowering
+// ============================================================================
+
+#[derive(Default)]
+struct Lowering {
+    instrs: Vec<Instr>,
+    regs: usize,
+}
+
+impl Lowering {
+    fn lower(&mut self, expr: &Expr) -> std::result::Result<Lowered, String> {
+        match expr {
+            Expr::Const(v) => Ok(Lowered::Const(*v)),
+            Expr::Var(i) => Ok(Lowered::Column(Src::Input(*i), Ty::Float)),
+            Expr::Stateful(_) => Err("stateful call".to_string()),
+            Expr::Unary(op, inner) => match (op, self.lower(inner)?) {
+                (op, Lowered::Const(v)) => op.apply(v).map(Lowered::Const),
+                (UnOp::Neg, Lowered::Column(src, Ty::Float)) => {
+                    Ok(self.emit(Op::Neg, &[src], Ty::Float))
+                },
+                (UnOp::Not, Lowered::Column(src, Ty::Bool)) => {
+                    Ok(self.emit(Op::Not, &[src], Ty::Bool))
+                },
+                (op, _) => Err(format!("type mismatch for {:?}", op)),
+            },
+            Expr::Binary(op, a, b) => {
+                let a = self.lower(a)?;
+                let b = self.lower(b)?;
+                self.lower_binary(*op, a, b)
+            },
+            Expr::Call(func, args) => {
+                let args = args
+                    .iter()
+                    .map(|a| self.lower(a))
+                    .collect::<std::result::Result<Vec<_>, _>>()?;
+                self.lower_call(*func, &args)
+            },
+        }
+    }
+
+    fn lower_binary(
+        &mut self,
+        op: BinOp,
+        a: Lowered,
+        b: Lowered,
+    ) -> std::result::Result<Lowered, String> {
+        if let (Lowered::Const(x), Lowered::Const(y)) = (a, b) {
+            return op.apply(x, y).map(Lowered::Const);
+        }
+        let (kind, ty) = match op {
+            BinOp::Add => (Op::Add, Ty::Float),
+            BinOp::Sub => (Op::Sub, Ty::Float),
+            BinOp::Mul => (Op::Mul, Ty::Float),
+            BinOp::Div => (Op::Div, Ty::Float),
+            BinOp::Mod => (Op::Mod, Ty::Float),
+            BinOp::Pow => (Op::Pow, Ty::Float),
+            BinOp::Gt => (Op::Gt, Ty::Bool),
+            BinOp::Lt => (Op::Lt, Ty::Bool),
+            BinOp::Ge => (Op::Ge, Ty::Bool),
+            BinOp::Le => (Op::Le, Ty::Bool),
+            BinOp::Eq | BinOp::Ne => {
+                // Typed equality: operands of different types never compare equal
+                if type_tag(a) != type_tag(b) {
+                    return Ok(Lowered::Const(Val::Bool(op == BinOp::Ne)));
+                }
+                let kind = if op == BinOp::Eq { Op::Eq } else { Op::Ne };
+                let args = [self.operand(a)?, self.operand(b)?];
+                return Ok(self.emit(kind, &args, Ty::Bool));
+            },
+            BinOp::And | BinOp::Or => {
+                let kind = if op == BinOp::And { Op::And } else { Op::Or };
+                let args = [self.boolean(a)?, self.boolean(b)?];
+                return Ok(self.emit(kind, &args, Ty::Bool));
+            },
+        };
+        let args = [self.number(a)?, self.number(b)?];
+        Ok(self.emit(kind, &args, ty))
+    }
+
+    fn lower_call(&mut self, func: Func, args: &[Lowered]) -> std::result::Result<Lowered, String> {
+        if args.iter().all(|a| matches!(a, Lowered::Const(_))) {
+            let vals: Vec<Val> = args
+                .iter()
+                .map(|a| match a {
+                    Lowered::Const(v) => *v,
+                    Lowered::Column(..) => unreachable!(),
+                })
+                .collect();
+            return func.apply(&vals).map(Lowered::Const);
+        }
+        let kind = match func {
+            Func::Scale => Op::Scale,
+            Func::Clamp => Op::Clamp,
+            Func::Abs => Op::Abs,
+            Func::Min => Op::Min,
+            Func::Max => Op::Max,
+            Func::Sign => Op::Sign,
+            Func::Round => {
+                let Lowered::Const(Val::Int(decimals)) = args[1] else {
+                    return Err("round decimals must be an integer literal".to_string());
+                };
+                let decimals = decimals.clamp(i32::MIN as i64, i32::MAX as i64) as i32;
+                let src = self.number(args[0])?;
+                return Ok(self.emit(Op::Round(decimals), &[src], Ty::Float));
+            },
+            Func::If => {
+                let (then, other) = (args[1], args[2]);
+                if let Lowered::Const(cond) = args[0] {
+                    return Ok(if cond.as_bool()? { then } else { other });
+                }
+                // An integer literal branch would change the type per row
+                let ty = match (type_tag(then), type_tag(other)) {
+                    (Some(x), Some(y)) if x == y => x,
+                    _ => return Err("if branches of different types".to_string()),
+                };
+                let srcs = [
+                    self.boolean(args[0])?,
+                    self.operand(then)?,
+                    self.operand(other)?,
+                ];
+                return Ok(self.emit(Op::Select, &srcs, ty));
+            },
+        };
+        let srcs = args
+            .iter()
+            .map(|a| self.number(*a))
+            .collect::<std::result::Result<Vec<_>, _>>()?;
+        Ok(self.emit(kind, &srcs, Ty::Float))
+    }
+
+    fn emit(&mut self, op: Op, srcs: &[Src], ty: Ty) -> Lowered {
+        let mut args = [Src::Reg(0); 3];
+        args[..srcs.len()].copy_from_slice(srcs);
+        let dst = self.regs;
+        self.regs += 1;
+        self.instrs.push(Instr { op, args, dst });
+        Lowered::Column(Src::Reg(dst), ty)
+    }
+
+    /// Column for any value (constants are broadcast)
+    fn operand(&mut self, v: Lowered) -> std::result::Result<Src, String> {
+        match v {
+            Lowered::Column(src, _) => Ok(src),
+            Lowered::Const(c) => match self.emit(Op::Fill(c.into_f64()), &[], Ty::Float) {
+                Lowered::Column(src, _) => Ok(src),
+                Lowered::Const(_) => unreachable!(),
+            },
+        }
+    }
+
+    fn number(&mut self, v: Lowered) -> std::result::Result<Src, String> {
+        match v {
+            Lowered::Column(_, Ty::Bool) | Lowered::Const(Val::Bool(_)) => {
+                Err("expected a number, found a boolean".to_string())
+            },
+            v => self.operand(v),
+        }
+    }
+
+    fn boolean(&mut self, v: Lowered) -> std::result::Result<Src, String> {
+        match v {
+            Lowered::Column(_, Ty::Bool) | Lowered::Const(Val::Bool(_)) => self.operand(v),
+            _ => Err("expected a boolean, found a number".to_string()),
+        }
+    }
+}
+
+/// Column type of a value (`None` for integers, which never live in columns)
+fn type_tag(v: Lowered) -> Option<Ty> {
+    match v {
+        Lowered::Column(_, ty) => Some(ty),
+        Lowered::Const(Val::Float(_)) => Some(Ty::Float),
+        Lowered::Const(Val::Bool(_)) => Some(Ty::Bool),
+        Lowered::Const(Val::Int(_)) => None,
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)]
+mod tests {
+    use super::*;
+
+    /// Batch result must match per-row `CompiledFormula::eval`
+    fn assert_matches_rows(formula: &str, columns: &[&[f64]]) -> BatchFormula {
+        let batch = BatchFormula::compile(formula).unwrap();
+        let rows = columns.first().map_or(3, |c| c.len());
+        let mut out = vec![0.0; rows];
+        batch.eval(columns, &mut out).unwrap();
+        for (i, got) in out.iter().enumerate() {
+            let row: Vec<f64> = columns.iter().map(|c| c[i]).collect();
+            let want = batch.formula().eval(&row).unwrap();
+            assert!(
+                got == &want || (got.is_nan() && want.is_nan()),
+                "{} row {}: {} != {}",
+                formula,
+                i,
+                got,
+                want
+            );
+        }
+        batch
+    }
+
+    #[test]
+    fn test_batch_matches_rows() {
+        let p = [0.0, 250.0, -40.0, 1200.0];
+        let q = [1.0, 0.0, 3.0, -2.5];
+        for formula in [
+            "P * 0.95 + Q / 2",
+            "clamp(P * 1.1, 0, 1000)",
+            "if(P > 0 && !(Q < 0), P, Q)",
+            "round(P / 3, 2) + abs(Q) ^ 2 - 7 / 2",
+            "max(P, Q) % 7 + sign(Q) + scale(P, 2) - min(P, 0.0)",
+            "P == 250.0 || Q != 3.0",
+            "-P >= -Q",
+        ] {
+            let batch = assert_matches_rows(formula, &[&p, &q]);
+            assert!(batch.is_vectorized(), "{}", formula);
+        }
+    }
+
+    #[test]
+    fn test_batch_typed_semantics() {
+        let x = [3.0, 4.0];
+        // Float column never equals an integer literal
+        let batch = assert_matches_rows("x == 3", &[&x]);
+        assert!(batch.is_vectorized());
+        // Integer literal branch: evaluated row by row
+        let batch = assert_matches_rows("if(x > 3, 7, 2) / 2", &[&x]);
+        assert!(!batch.is_vectorized());
+        assert_matches_rows("2 + 3", &[]);
+    }
+
+    #[test]
+    fn test_batch_rejects_bad_input() {
+        assert!(BatchFormula::compile("integrate(P)").is_err());
+        let batch = BatchFormula::compile("a + b").unwrap();
+        let mut out = [0.0; 2];
+        assert!(batch.eval(&[&[1.0, 2.0]], &mut out).is_err());
+        assert!(batch.eval(&[&[1.0, 2.0], &[1.0]], &mut out).is_err());
+        // Type errors surface from the row-by-row path
+        let batch = BatchFormula::compile("(a > 1) + b").unwrap();
+        assert!(!batch.is_vectorized());
+        assert!(batch.eval(&[&[1.0, 2.0], &[1.0, 2.0]], &mut out).is_err());
+    }
+}
@@ -30,6 +30,11 @@ impl<S: StateStore> BuiltinFunctions<S> {
         }
     }
 
+    /// Context identifier used in state keys
+    pub fn context(&self) -> &str {
+        &self.context
+    }
+
     /// Execute integrate function
     ///
     /// Calculates time integral: accumulated += value * dt
@@ -41,10 +46,22 @@ impl<S: StateStore> BuiltinFunctions<S> {
     /// * `unit_factor` - Conversion factor (default 1.0, use 1/3600 for W→Wh)
     pub async fn integrate(&self, var_name: &str, value: f64, unit_factor: f64) -> Result<f64> {
         let key = state_key(&self.context, "integrate", var_name);
+        self.integrate_keyed(&key, var_name, value, unit_factor)
+            .await
+    }
+
+    /// [`integrate`](Self::integrate) with a pre-resolved state key
+    pub async fn integrate_keyed(
+        &self,
+        key: &str,
+        var_name: &str,
+        value: f64,
+        unit_factor: f64,
+    ) -> Result<f64> {
         let now = Utc::now().timestamp() as f64;
 
         // Load existing state
-        let state = if let Some(data) = self.state_store.get(&key).await? {
+        let state = if let Some(data) = self.state_store.get(key).await? {
             serde_json::from_slice::<IntegrateState>(&data)
                 .map_err(|e| CalcError::state(format!("Failed to deserialize state: {}", e)))?
         } else {
@@ -55,7 +72,7 @@ impl<S: StateStore> BuiltinFunctions<S> {
             };
             let data = serde_json::to_vec(&initial)
                 .map_err(|e| CalcError::state(format!("Failed to serialize state: {}", e)))?;
-            self.state_store.set(&key, &data).await?;
+            self.state_store.set(key, &data).await?;
             return Ok(0.0); // First call returns 0
         };
 
@@ -85,7 +102,7 @@ impl<S: StateStore> BuiltinFunctions<S> {
         };
         let data = serde_json::to_vec(&new_state)
             .map_err(|e| CalcError::state(format!("Failed to serialize state: {}", e)))?;
-        self.state_store.set(&key, &data).await?;
+        self.state_store.set(key, &data).await?;
 
         Ok(new_accumulated)
     }
@@ -100,9 +117,19 @@ impl<S: StateStore> BuiltinFunctions<S> {
     /// * `window` - Window size (number of samples)
     pub async fn moving_avg(&self, var_name: &str, value: f64, window: usize) -> Result<f64> {
         let key = state_key(&self.context, "moving_avg", var_name);
+        self.moving_avg_keyed(&key, var_name, value, window).await
+    }
 
+    /// [`moving_avg`](Self::moving_avg) with a pre-resolved state key
+    pub async fn moving_avg_keyed(
+        &self,
+        key: &str,
+        var_name: &str,
+        value: f64,
+        window: usize,
+    ) -> Result<f64> {
         // Load or create state
-        let mut state = if let Some(data) = self.state_store.get(&key).await? {
+        let mut state = if let Some(data) = self.state_store.get(key).await? {
             let s: MovingAvgState = serde_json::from_slice(&data)
                 .map_err(|e| CalcError::state(format!("Failed to deserialize state: {}", e)))?;
             // Handle window size change
@@ -129,7 +156,7 @@ impl<S: StateStore> BuiltinFunctions<S> {
         // Save state
         let data = serde_json::to_vec(&state)
             .map_err(|e| CalcError::state(format!("Failed to serialize state: {}", e)))?;
-        self.state_store.set(&key, &data).await?;
+        self.state_store.set(key, &data).await?;
 
         Ok(avg)
     }
@@ -143,10 +170,15 @@ impl<S: StateStore> BuiltinFunctions<S> {
     /// * `value` - Current value
     pub async fn rate_of_change(&self, var_name: &str, value: f64) -> Result<f64> {
         let key = state_key(&self.context, "rate", var_name);
+        self.rate_of_change_keyed(&key, var_name, value).await
+    }
+
+    /// [`rate_of_change`](Self::rate_of_change) with a pre-resolved state key
+    pub async fn rate_of_change_keyed(&self, key: &str, var_name: &str, value: f64) -> Result<f64> {
         let now = Utc::now().timestamp() as f64;
 
         // Load existing state
-        let state = if let Some(data) = self.state_store.get(&key).await? {
+        let state = if let Some(data) = self.state_store.get(key).await? {
             serde_json::from_slice::<RateOfChangeState>(&data)
                 .map_err(|e| CalcError::state(format!("Failed to deserialize state: {}", e)))?
         } else {
@@ -157,7 +189,7 @@ impl<S: StateStore> BuiltinFunctions<S> {
             };
             let data = serde_json::to_vec(&initial)
                 .map_err(|e| CalcError::state(format!("Failed to serialize state: {}", e)))?;
-            self.state_store.set(&key, &data).await?;
+            self.state_store.set(key, &data).await?;
             return Ok(0.0);
         };
 
@@ -185,7 +217,7 @@ impl<S: StateStore> BuiltinFunctions<S> {
         };
         let data = serde_json::to_vec(&new_state)
             .map_err(|e| CalcError::state(format!("Failed to serialize state: {}", e)))?;
-        self.state_store.set(&key, &data).await?;
+        self.state_store.set(key, &data).await?;
 
         Ok(rate)
     }
@@ -0,0 +1,928 @@
+//! CompiledFormula - Parse-once formulas evaluated against a slice of f64
+//!
+//! A formula is parsed into an operator tree whose variables are bound to
+//! indices (first-appearance order, see [`CompiledFormula::variables`]).
+//! Stateful calls (`integrate`, `moving_avg`, `rate_of_change`) become call
+//! sites that the engine resolves to state keys once per context.
+//!
+//! Semantics follow the evalexpr path of [`CalcEngine`](crate::CalcEngine):
+//! integer literals stay integers (`7 / 2 == 3`), variables are floats,
+//! `==` compares typed values, and stateful results are substituted the way
+//! the textual preprocessing did. Formulas using syntax outside this subset
+//! fail to compile and keep running on evalexpr.
+
+use crate::builtin_functions;
+use crate::error::{CalcError, Result};
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex};
+
+/// Default number of formulas kept per engine
+pub const FORMULA_CACHE_CAPACITY: usize = 512;
+
+/// Typed value (mirrors the evalexpr value types used by formulas)
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) enum Val {
+    Int(i64),
+    Float(f64),
+    Bool(bool),
+}
+
+impl Val {
+    pub(crate) fn as_number(self) -> std::result::Result<f64, String> {
+        match self {
+            Val::Int(i) => Ok(i as f64),
+            Val::Float(f) => Ok(f),
+            Val::Bool(b) => Err(format!("Expected a number, found {}", b)),
+        }
+    }
+
+    pub(crate) fn as_bool(self) -> std::result::Result<bool, String> {
+        match self {
+            Val::Bool(b) => Ok(b),
+            v => Err(format!("Expected a boolean, found {:?}", v)),
+        }
+    }
+
+    pub(crate) fn into_f64(self) -> f64 {
+        match self {
+            Val::Int(i) => i as f64,
+            Val::Float(f) => f,
+            Val::Bool(b) => {
+                if b {
+                    1.0
+                } else {
+                    0.0
+                }
+            },
+        }
+    }
+
+    /// Value as seen by evalexpr after `value.to_string()` was spliced into the formula
+    fn substituted(v: f64) -> Self {
+        if v.fract() == 0.0 && v >= i64::MIN as f64 && v < i64::MAX as f64 {
+            Val::Int(v as i64)
+        } else {
+            Val::Float(v)
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) enum UnOp {
+    Neg,
+    Not,
+}
+
+impl UnOp {
+    pub(crate) fn apply(self, v: Val) -> std::result::Result<Val, String> {
+        match (self, v) {
+            (UnOp::Neg, Val::Int(i)) => i
+                .checked_neg()
+                .map(Val::Int)
+                .ok_or_else(|| format!("Integer negation error: {}", i)),
+            (UnOp::Neg, Val::Float(f)) => Ok(Val::Float(-f)),
+            (UnOp::Not, Val::Bool(b)) => Ok(Val::Bool(!b)),
+            (UnOp::Neg, v) => Err(format!("Expected a number, found {:?}", v)),
+            (UnOp::Not, v) => Err(format!("Expected a boolean, found {:?}", v)),
+        }
+    }
+}
+
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) enum BinOp {
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Mod,
+    Pow,
+    Eq,
+    Ne,
+    Gt,
+    Lt,
+    Ge,
+    Le,
+    And,
+    Or,
+}
+
+impl BinOp {
+    fn from_token(op: &str) -> Option<(Self, u8)> {
+        // Binding powers follow evalexpr precedence (all left-associative)
+        Some(match op {
+            "||" => (BinOp::Or, 70),
+            "&&" => (BinOp::And, 75),
+            "==" => (BinOp::Eq, 80),
+            "!=" => (BinOp::Ne, 80),
+            ">" => (BinOp::Gt, 80),
+            "<" => (BinOp::Lt, 80),
+            ">=" => (BinOp::Ge, 80),
+            "<=" => (BinOp::Le, 80),
+            "+" => (BinOp::Add, 95),
+            "-" => (BinOp::Sub, 95),
+            "*" => (BinOp::Mul, 100),
+            "/" => (BinOp::Div, 100),
+            "%" => (BinOp::Mod, 100),
+            "^" => (BinOp::Pow, 120),
+            _ => return None,
+        })
+    }
+
+    pub(crate) fn apply(self, a: Val, b: Val) -> std::result::Result<Val, String> {
+        // Integer arithmetic stays integer (checked, as in evalexpr)
+        if let (Val::Int(x), Val::Int(y)) = (a, b) {
+            let int = match self {
+                BinOp::Add => Some(x.checked_add(y)),
+                BinOp::Sub => Some(x.checked_sub(y)),
+                BinOp::Mul => Some(x.checked_mul(y)),
+                BinOp::Div => Some(x.checked_div(y)),
+                BinOp::Mod => Some(x.checked_rem(y)),
+                _ => None,
+            };
+            if let Some(result) = int {
+                return result
+                    .map(Val::Int)
+                    .ok_or_else(|| format!("Integer {:?} error: {} and {}", self, x, y));
+            }
+        }
+
+        Ok(match self {
+            BinOp::Add => Val::Float(a.as_number()? + b.as_number()?),
+            BinOp::Sub => Val::Float(a.as_number()? - b.as_number()?),
+            BinOp::Mul => Val::Float(a.as_number()? * b.as_number()?),
+            BinOp::Div => Val::Float(a.as_number()? / b.as_number()?),
+            BinOp::Mod => Val::Float(a.as_number()? % b.as_number()?),
+            BinOp::Pow => Val::Float(a.as_number()?.powf(b.as_number()?)),
+            // Typed equality: Int(1) != Float(1.0), as in evalexpr
+            BinOp::Eq => Val::Bool(a == b),
+            BinOp::Ne => Val::Bool(a != b),
+            BinOp::Gt | BinOp::Lt | BinOp::Ge | BinOp::Le => {
+                let ord = match (a, b) {
+                    (Val::Int(x), Val::Int(y)) => x.partial_cmp(&y),
+                    _ => a.as_number()?.partial_cmp(&b.as_number()?),
+                };
+                Val::Bool(match self {
+                    BinOp::Gt => ord.is_some_and(|o| o.is_gt()),
+                    BinOp::Lt => ord.is_some_and(|o| o.is_lt()),
+                    BinOp::Ge => ord.is_some_and(|o| o.is_ge()),
+                    _ => ord.is_some_and(|o| o.is_le()),
+                })
+            },
+            BinOp::And => Val::Bool(a.as_bool()? && b.as_bool()?),
+            BinOp::Or => Val::Bool(a.as_bool()? || b.as_bool()?),
+        })
+    }
+}
+
+/// Stateless function (registered in the evalexpr context, plus built-in `if`)
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) enum Func {
+    Scale,
+    Clamp,
+    Abs,
+    Min,
+    Max,
+    Round,
+    Sign,
+    If,
+}
+
+impl Func {
+    fn lookup(name: &str) -> Option<(Self, usize)> {
+        Some(match name {
+            "scale" => (Func::Scale, 2),
+            "clamp" => (Func::Clamp, 3),
+            "abs" => (Func::Abs, 1),
+            "min" => (Func::Min, 2),
+            "max" => (Func::Max, 2),
+            "round" => (Func::Round, 2),
+            "sign" => (Func::Sign, 1),
+            "if" => (Func::If, 3),
+            _ => return None,
+        })
+    }
+
+    pub(crate) fn apply(self, args: &[Val]) -> std::result::Result<Val, String> {
+        let num = |i: usize| args[i].as_number();
+        Ok(match self {
+            Func::Scale => Val::Float(builtin_functions::scale(num(0)?, num(1)?)),
+            Func::Clamp => Val::Float(builtin_functions::clamp(num(0)?, num(1)?, num(2)?)),
+            Func::Abs => Val::Float(builtin_functions::abs(num(0)?)),
+            Func::Min => Val::Float(builtin_functions::min(num(0)?, num(1)?)),
+            Func::Max => Val::Float(builtin_functions::max(num(0)?, num(1)?)),
+            Func::Round => {
+                let Val::Int(decimals) = args[1] else {
+                    return Err(format!("Expected an integer, found {:?}", args[1]));
+                };
+                let decimals = decimals.clamp(i32::MIN as i64, i32::MAX as i64) as i32;
+                Val::Float(builtin_functions::round(num(0)?, decimals))
+            },
+            Func::Sign => Val::Float(builtin_functions::sign(num(0)?)),
+            Func::If => {
+                if args[0].as_bool()? {
+                    args[1]
+                } else {
+                    args[2]
+                }
+            },
+        })
+    }
+}
+
+#[derive(Debug, Clone)]
+pub(crate) enum Expr {
+    Const(Val),
+    Var(usize),
+    /// Result of stateful call site `n`
+    Stateful(usize),
+    Unary(UnOp, Box<Expr>),
+    Binary(BinOp, Box<Expr>, Box<Expr>),
+    Call(Func, Vec<Expr>),
+}
+
+/// Stateful built-in function of a call site
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub enum StatefulFn {
+    Integrate { factor: f64 },
+    MovingAvg { window: usize },
+    RateOfChange,
+}
+
+impl StatefulFn {
+    /// Function name used in state keys
+    pub fn state_name(&self) -> &'static str {
+        match self {
+            StatefulFn::Integrate { .. } => "integrate",
+            StatefulFn::MovingAvg { .. } => "moving_avg",
+            StatefulFn::RateOfChange => "rate",
+        }
+    }
+
+    /// Preprocessing order of the textual path (integrate, moving_avg, rate_of_change)
+    fn rank(&self) -> u8 {
+        match self {
+            StatefulFn::Integrate { .. } => 0,
+            StatefulFn::MovingAvg { .. } => 1,
+            StatefulFn::RateOfChange => 2,
+        }
+    }
+}
+
+/// Stateful call site: function applied to a variable
+#[derive(Debug, Clone)]
+pub struct StatefulCall {
+    pub func: StatefulFn,
+    /// Index into [`CompiledFormula::variables`]
+    pub var: usize,
+}
+
+/// Formula parsed once into an operator tree
+#[derive(Debug, Clone)]
+pub struct CompiledFormula {
+    source: String,
+    expr: Expr,
+    variables: Vec<String>,
+    /// Call sites in evaluation order
+    stateful: Vec<StatefulCall>,
+}
+
+impl CompiledFormula {
+    /// Parse a formula
+    ///
+    /// Returns an error for syntax outside the supported subset.
+    pub fn compile(formula: &str) -> Result<Self> {
+        let tokens = tokenize(formula)
+            .map_err(|e| CalcError::expression(format!("Cannot compile '{}': {}", formula, e)))?;
+        let mut parser = Parser {
+            tokens,
+            pos: 0,
+            variables: Vec::new(),
+            stateful: Vec::new(),
+        };
+        let parsed = parser
+            .parse_expr(0)
+            .and_then(|expr| match parser.peek() {
+                None => Ok(expr),
+                Some(t) => Err(format!("unexpected token {:?}", t)),
+            })
+            .map_err(|e| CalcError::expression(format!("Cannot compile '{}': {}", formula, e)))?;
+
+        // Stateful calls ran before evaluation: by function, last occurrence first
+        let mut order: Vec<usize> = (0..parser.stateful.len()).collect();
+        order.sort_by_key(|&i| (parser.stateful[i].1.func.rank(), std::cmp::Reverse(i)));
+        let mut remap = vec![0; order.len()];
+        for (new, &old) in order.iter().enumerate() {
+            remap[old] = new;
+        }
+        let mut slots: Vec<Option<StatefulCall>> =
+            parser.stateful.into_iter().map(|(_, c)| Some(c)).collect();
+        let stateful = order.iter().filter_map(|&i| slots[i].take()).collect();
+
+        Ok(Self {
+            source: formula.to_string(),
+            expr: remap_stateful(parsed, &remap),
+            variables: parser.variables,
+            stateful,
+        })
+    }
+
+    /// Original formula text
+    pub fn source(&self) -> &str {
+        &self.source
+    }
+
+    /// Variable names in binding order (the slice order expected by `eval`)
+    pub fn variables(&self) -> &[String] {
+        &self.variables
+    }
+
+    /// Stateful call sites in evaluation order
+    pub fn stateful_calls(&self) -> &[StatefulCall] {
+        &self.stateful
+    }
+
+    /// Whether the formula uses `integrate`, `moving_avg` or `rate_of_change`
+    pub fn is_stateful(&self) -> bool {
+        !self.stateful.is_empty()
+    }
+
+    pub(crate) fn expr(&self) -> &Expr {
+        &self.expr
+    }
+
+    /// Evaluate a stateless formula against variable values in binding order
+    pub fn eval(&self, values: &[f64]) -> Result<f64> {
+        if self.is_stateful() {
+            return Err(CalcError::expression(format!(
+                "Formula '{}' needs state, use CalcEngine",
+                self.source
+            )));
+        }
+        self.eval_with_stateful(values, &[])
+    }
+
+    /// Evaluate with the results of the stateful call sites (in evaluation order)
+    pub(crate) fn eval_with_stateful(&self, values: &[f64], stateful: &[f64]) -> Result<f64> {
+        if values.len() < self.variables.len() || stateful.len() < self.stateful.len() {
+            return Err(CalcError::expression(format!(
+                "Formula '{}' expects {} values, got {}",
+                self.source,
+                self.variables.len(),
+                values.len()
+            )));
+        }
+        eval_expr(&self.expr, values, stateful)
+            .map(Val::into_f64)
+            .map_err(|e| {
+                CalcError::expression(format!("Failed to evaluate '{}': {}", self.source, e))
+            })
+    }
+}
+
+fn eval_expr(expr: &Expr, values: &[f64], stateful: &[f64]) -> std::result::Result<Val, String> {
+    match expr {
+        Expr::Const(v) => Ok(*v),
+        Expr::Var(i) => Ok(Val::Float(values[*i])),
+        Expr::Stateful(i) => Ok(Val::substituted(stateful[*i])),
+        Expr::Unary(op, inner) => op.apply(eval_expr(inner, values, stateful)?),
+        Expr::Binary(op, a, b) => {
+            // evalexpr evaluates both operands (no short-circuit)
+            let a = eval_expr(a, values, stateful)?;
+            let b = eval_expr(b, values, stateful)?;
+            op.apply(a, b)
+        },
+        Expr::Call(func, args) => {
+            let mut vals = [Val::Int(0); 3];
+            for (slot, arg) in vals.iter_mut().zip(args) {
+                *slot = eval_expr(arg, values, stateful)?;
+            }
+            func.apply(&vals[..args.len()])
+        },
+    }
+}
+
+fn remap_stateful(expr: Expr, remap: &[usize]) -> Expr {
+    match expr {
+        Expr::Stateful(i) => Expr::Stateful(remap[i]),
+        Expr::Unary(op, inner) => Expr::Unary(op, Box::new(remap_stateful(*inner, remap))),
+        Expr::Binary(op, a, b) => Expr::Binary(
+            op,
+            Box::new(remap_stateful(*a, remap)),
+            Box::new(remap_stateful(*b, remap)),
+        ),
+        Expr::Call(func, args) => Expr::Call(
+            func,
+            args.into_iter().map(|a| remap_stateful(a, remap)).collect(),
+        ),
+        e => e,
+    }
+}
+
+// ============================================================================
+// Tokenizer / parser
+// ============================================================================
+
+#[derive(Debug, Clone, PartialEq)]
+enum Token {
+    Num(Val),
+    Ident(String),
+    Op(&'static str),
+    LParen,
+    RParen,
+    Comma,
+}
+
+const OPERATORS: [&str; 16] = [
+    "==", "!=", ">=", "<=", "&&", "||", ">", "<", "+", "-", "*", "/", "%", "^", "!", ",",
+];
+
+fn tokenize(formula: &str) -> std::result::Result<Vec<Token>, String> {
+    let mut tokens = Vec::new();
+    let mut rest = formula;
+
+    while let Some(c) = rest.chars().next() {
+        if c.is_whitespace() {
+            rest = &rest[c.len_utf8()..];
+            continue;
+        }
+        if c == '(' || c == ')' {
+            tokens.push(if c == '(' {
+                Token::LParen
+            } else {
+                Token::RParen
+            });
+            rest = &rest[1..];
+            continue;
+        }
+        if let Some(op) = OPERATORS.iter().find(|op| rest.starts_with(**op)) {
+            tokens.push(if *op == "," {
+                Token::Comma
+            } else {
+                Token::Op(op)
+            });
+            rest = &rest[op.len()..];
+            continue;
+        }
+
+        // Literal or identifier: a run of word characters and dots
+        let len = rest
+            .find(|ch: char| !(ch.is_ascii_alphanumeric() || ch == '_' || ch == '.'))
+            .unwrap_or(rest.len());
+        if len == 0 {
+            return Err(format!("unsupported character '{}'", c));
+        }
+        let word = &rest[..len];
+        rest = &rest[len..];
+
+        tokens.push(
+            if word.starts_with(|ch: char| ch.is_ascii_digit() || ch == '.') {
+                if let Ok(i) = word.parse::<i64>() {
+                    Token::Num(Val::Int(i))
+                } else if let Ok(f) = word.parse::<f64>() {
+                    Token::Num(Val::Float(f))
+                } else {
+                    return Err(format!("invalid number '{}'", word));
+                }
+            } else {
+                match word {
+                    "true" => Token::Num(Val::Bool(true)),
+                    "false" => Token::Num(Val::Bool(false)),
+                    _ => Token::Ident(word.to_string()),
+                }
+            },
+        );
+    }
+
+    Ok(tokens)
+}
+
+struct Parser {
+    tokens: Vec<Token>,
+    pos: usize,
+    variables: Vec<String>,
+    /// Call sites in source order, with their source index
+    stateful: Vec<(usize, StatefulCall)>,
+}
+
+impl Parser {
+    fn peek(&self) -> Option<&Token> {
+        self.tokens.get(self.pos)
+    }
+
+    fn next(&mut self) -> Option<Token> {
+        let token = self.tokens.get(self.pos).cloned();
+        self.pos += 1;
+        token
+    }
+
+    fn expect(&mut self, expected: Token) -> std::result::Result<(), String> {
+        match self.next() {
+            Some(t) if t == expected => Ok(()),
+            other => Err(format!("expected {:?}, found {:?}", expected, other)),
+        }
+    }
+
+    fn bind(&mut self, name: &str) -> usize {
+        match self.variables.iter().position(|v| v == name) {
+            Some(i) => i,
+            None => {
+                self.variables.push(name.to_string());
+                self.variables.len() - 1
+            },
+        }
+    }
+
+    fn parse_expr(&mut self, min_bp: u8) -> std::result::Result<Expr, String> {
+        let mut lhs = match self.next() {
+            Some(Token::Num(v)) => Expr::Const(v),
+            Some(Token::Ident(name)) => {
+                if self.peek() == Some(&Token::LParen) {
+                    self.pos += 1;
+                    self.parse_call(&name)?
+                } else {
+                    Expr::Var(self.bind(&name))
+                }
+            },
+            Some(Token::LParen) => {
+                let inner = self.parse_expr(0)?;
+                self.expect(Token::RParen)?;
+                inner
+            },
+            Some(Token::Op("-")) => Expr::Unary(UnOp::Neg, Box::new(self.parse_expr(110)?)),
+            Some(Token::Op("!")) => Expr::Unary(UnOp::Not, Box::new(self.parse_expr(110)?)),
+            other => return Err(format!("unexpected token {:?}", other)),
+        };
+
+        while let Some(Token::Op(op)) = self.peek() {
+            let Some((op, bp)) = BinOp::from_token(op) else {
+                break;
+            };
+            if bp < min_bp {
+                break;
+            }
+            self.pos += 1;
+            let rhs = self.parse_expr(bp + 1)?;
+            lhs = Expr::Binary(op, Box::new(lhs), Box::new(rhs));
+        }
+
+        Ok(lhs)
+    }
+
+    /// Parse a call; the opening parenthesis is already consumed
+    fn parse_call(&mut self, name: &str) -> std::result::Result<Expr, String> {
+        if matches!(name, "integrate" | "moving_avg" | "rate_of_change") {
+            return self.parse_stateful_call(name);
+        }
+
+        let (func, arity) =
+            Func::lookup(name).ok_or_else(|| format!("unknown function '{}'", name))?;
+        let mut args = Vec::with_capacity(arity);
+        loop {
+            args.push(self.parse_expr(0)?);
+            match self.next() {
+                Some(Token::Comma) => continue,
+                Some(Token::RParen) => break,
+                other => return Err(format!("expected ',' or ')', found {:?}", other)),
+            }
+        }
+        if args.len() != arity {
+            return Err(format!("{}() takes {} arguments", name, arity));
+        }
+        Ok(Expr::Call(func, args))
+    }
+
+    /// Stateful calls take a bare variable (plus a numeric literal), as the textual path did
+    fn parse_stateful_call(&mut self, name: &str) -> std::result::Result<Expr, String> {
+        let Some(Token::Ident(var)) = self.next() else {
+            return Err(format!("{}() takes a variable name", name));
+        };
+        let param = match self.next() {
+            Some(Token::RParen) => None,
+            Some(Token::Comma) => {
+                let value = match self.next() {
+                    Some(Token::Num(v @ (Val::Int(_) | Val::Float(_)))) => v,
+                    other => return Err(format!("{}() parameter {:?}", name, other)),
+                };
+                self.expect(Token::RParen)?;
+                Some(value)
+            },
+            other => return Err(format!("expected ',' or ')', found {:?}", other)),
+        };
+
+        let func = match (name, param) {
+            ("integrate", None) => StatefulFn::Integrate { factor: 1.0 },
+            ("integrate", Some(v)) => StatefulFn::Integrate {
+                factor: v.into_f64(),
+            },
+            ("moving_avg", Some(Val::Int(w))) if w >= 0 => {
+                StatefulFn::MovingAvg { window: w as usize }
+            },
+            ("rate_of_change", None) => StatefulFn::RateOfChange,
+            _ => return Err(format!("invalid {}() arguments", name)),
+        };
+
+        let call = StatefulCall {
+            func,
+            var: self.bind(&var),
+        };
+        let idx = self.stateful.len();
+        self.stateful.push((idx, call));
+        Ok(Expr::Stateful(idx))
+    }
+}
+
+// ============================================================================
+// Per-engine formula cache
+// ============================================================================
+
+/// Compiled formula with state keys resolved for one engine context
+#[derive(Debug)]
+pub struct PreparedFormula {
+    pub formula: CompiledFormula,
+    /// State key per stateful call site (evaluation order)
+    pub state_keys: Vec<String>,
+}
+
+/// LRU of prepared formulas keyed by formula text
+///
+/// `None` entries remember formulas that fail to compile so they go straight
+/// to the evalexpr path.
+pub struct FormulaCache {
+    capacity: usize,
+    inner: Mutex<FormulaCacheInner>,
+}
+
+#[derive(Default)]
+struct FormulaCacheInner {
+    entries: HashMap<String, (Option<Arc<PreparedFormula>>, u64)>,
+    tick: u64,
+}
+
+impl FormulaCache {
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            capacity: capacity.max(1),
+            inner: Mutex::new(FormulaCacheInner::default()),
+        }
+    }
+
+    /// Look up a formula, compiling it with `prepare` on a miss
+    pub fn get_or_prepare(
+        &self,
+        formula: &str,
+        prepare: impl FnOnce(CompiledFormula) -> PreparedFormula,
+    ) -> Option<Arc<PreparedFormula>> {
+        let Ok(mut inner) = self.inner.lock() else {
+            tracing::warn!("Formula cache lock fail");
+            return CompiledFormula::compile(formula)
+                .ok()
+                .map(|f| Arc::new(prepare(f)));
+        };
+        inner.tick += 1;
+        let tick = inner.tick;
+        if let Some((prepared, used)) = inner.entries.get_mut(formula) {
+            *used = tick;
+            return prepared.clone();
+        }
+
+        let prepared = match CompiledFormula::compile(formula) {
+            Ok(f) => Some(Arc::new(prepare(f))),
+            Err(e) => {
+                tracing::debug!("{}, using evalexpr", e);
+                None
+            },
+        };
+        if inner.entries.len() >= self.capacity {
+            let oldest = inner
+                .entries
+                .iter()
+                .min_by_key(|(_, (_, used))| *used)
+                .map(|(k, _)| k.clone());
+            if let Some(oldest) = oldest {
+                inner.entries.remove(&oldest);
+            }
+        }
+        inner
+            .entries
+            .insert(formula.to_string(), (prepared.clone(), tick));
+        prepared
+    }
+
+    /// Number of cached formulas
+    pub fn len(&self) -> usize {
+        self.inner.lock().map(|i| i.entries.len()).unwrap_or(0)
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+impl Default for FormulaCache {
+    fn default() -> Self {
+        Self::new(FORMULA_CACHE_CAPACITY)
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)]
+mod tests {
+    use super::*;
+
+    fn eval(formula: &str, values: &[f64]) -> f64 {
+        CompiledFormula::compile(formula)
+            .unwrap()
+            .eval(values)
+            .unwrap()
+    }
+
+    #[test]
+    fn test_binding_order() {
+        let f = CompiledFormula::compile("b * 2 + a - b").unwrap();
+        assert_eq!(f.variables(), ["b", "a"]);
+        assert_eq!(f.eval(&[3.0, 1.0]).unwrap(), 4.0);
+    }
+
+    #[test]
+    fn test_precedence_and_types() {
+        assert_eq!(eval("2 + 3 * 4", &[]), 14.0);
+        assert_eq!(eval("(2 + 3) * 4", &[]), 20.0);
+        assert_eq!(eval("2 ^ 3 * 2", &[]), 16.0);
+        assert_eq!(eval("-2 ^ 2", &[]), -4.0);
+        assert_eq!(eval("10 - 4 - 3", &[]), 3.0);
+        // Integer literals divide as integers, variables are floats
+        assert_eq!(eval("7 / 2", &[]), 3.0);
+        assert_eq!(eval("x / 2", &[7.0]), 3.5);
+        assert_eq!(eval("x > 1 && !(x > 5)", &[3.0]), 1.0);
+        // Typed equality: float variable vs integer literal
+        assert_eq!(eval("x == 3", &[3.0]), 0.0);
+        assert_eq!(eval("x == 3.0", &[3.0]), 1.0);
+    }
+
+    #[test]
+    fn test_functions() {
+        assert_eq!(eval("clamp(P * 1.1, 0, 1000)", &[1000.0]), 1000.0);
+        assert_eq!(eval("round(2.71828, 2)", &[]), 2.72);
+        assert_eq!(eval("if(x > 0, x, 0)", &[-2.0]), 0.0);
+        assert_eq!(eval("max(abs(x), sign(x))", &[-4.0]), 4.0);
+        assert!(CompiledFormula::compile("round(x, 2.0)")
+            .unwrap()
+            .eval(&[1.0])
+            .is_err());
+    }
+
+    #[test]
+    fn test_unsupported_syntax() {
+        for formula in [
+            "a = 1",
+            "\"text\"",
+            "math::sqrt(x)",
+            "floor(x)",
+            "min(a)",
+            "1 +",
+        ] {
+            assert!(CompiledFormula::compile(formula).is_err(), "{}", formula);
+        }
+        assert!(CompiledFormula::compile("integrate(P * 2)").is_err());
+    }
+
+    #[test]
+    fn test_stateful_call_order() {
+        let f = CompiledFormula::compile("rate_of_change(V) + integrate(P, 0.5) + integrate(Q)")
+            .unwrap();
+        assert!(f.is_stateful());
+        let order: Vec<(&str, &str)> = f
+            .stateful_calls()
+            .iter()
+            .map(|c| (c.func.state_name(), f.variables()[c.var].as_str()))
+            .collect();
+        assert_eq!(
+            order,
+            [("integrate", "Q"), ("integrate", "P"), ("rate", "V")]
+        );
+        assert!(f.eval(&[0.0, 0.0, 0.0]).is_err(), "needs engine state");
+    }
+
+    /// Every corpus formula gives the same result (or fails) on the compiled
+    /// path as on evalexpr; formulas that do not compile fall back unchanged
+    #[test]
+    fn test_matches_evalexpr() {
+        use crate::state::MemoryStateStore;
+        use crate::CalcEngine;
+
+        let engine = CalcEngine::new(Arc::new(MemoryStateStore::new()), "diff");
+        let corpus = [
+            // Arithmetic and precedence
+            "a + b * c",
+            "(a + b) * c",
+            "a - b - c",
+            "a / b",
+            "a % b",
+            "a ^ 2 + b ^ 0.5",
+            "-a ^ 2",
+            "-(a - b) * -c",
+            "7 / 2 + a",
+            "7 % 3 * a",
+            "2 ^ 10",
+            // Comparisons and logic (typed equality)
+            "a > b",
+            "a >= b && b <= c",
+            "a < 0 || c != 0",
+            "!(a > b)",
+            "a == 1",
+            "a == 1.0",
+            "a != b",
+            "true && a > 0",
+            // Functions
+            "scale(a, 0.1)",
+            "clamp(a * 1.1, 0, 100)",
+            "abs(a - b)",
+            "min(a, b) + max(b, c)",
+            "round(a / 3, 2)",
+            "sign(a) * b",
+            "if(a > b, a, b)",
+            "if(a > 0, 1, 2) + c",
+            "max(abs(a), sign(b))",
+            // Errors on both paths
+            "1 / 0",
+            "5 % 0",
+            "9223372036854775807 + 1",
+            "round(a, 2.0)",
+            "a + true",
+            "if(a, 1, 2)",
+            "!a",
+            // Outside the compiled subset (evalexpr fallback)
+            "floor(a)",
+            "min(a)",
+            "math::sqrt(a)",
+        ];
+        let bindings = [
+            [3.0, 4.0, 5.0],
+            [1.0, -2.5, 0.0],
+            [-7.25, 0.5, 1e9],
+            [0.0, 0.0, -1.0],
+        ];
+
+        let same = |x: f64, y: f64| x == y || (x.is_nan() && y.is_nan());
+        for formula in corpus {
+            let compiled = CompiledFormula::compile(formula);
+            for values in &bindings {
+                let variables: HashMap<String, f64> = ["a", "b", "c"]
+                    .iter()
+                    .zip(values)
+                    .map(|(name, v)| (name.to_string(), *v))
+                    .collect();
+                let expected = engine.evaluate_evalexpr(formula, &variables);
+
+                if let Ok(compiled) = &compiled {
+                    let bound: Vec<f64> = compiled
+                        .variables()
+                        .iter()
+                        .map(|name| variables[name])
+                        .collect();
+                    match (compiled.eval(&bound), &expected) {
+                        (Ok(got), Ok(want)) => {
+                            assert!(
+                                same(got, *want),
+                                "{} {:?}: {} vs {}",
+                                formula,
+                                values,
+                                got,
+                                want
+                            )
+                        },
+                        (Err(_), Err(_)) => {},
+                        (got, want) => panic!("{} {:?}: {:?} vs {:?}", formula, values, got, want),
+                    }
+                }
+
+                // The engine's dispatch (compiled or fallback) agrees as well
+                match (engine.evaluate_simple(formula, &variables), &expected) {
+                    (Ok(got), Ok(want)) => assert!(same(got, *want), "{}", formula),
+                    (Err(_), Err(_)) => {},
+                    (got, want) => panic!("{} {:?}: {:?} vs {:?}", formula, values, got, want),
+                }
+            }
+        }
+        for formula in ["floor(a)", "min(a)", "math::sqrt(a)"] {
+            assert!(CompiledFormula::compile(formula).is_err(), "{}", formula);
+        }
+    }
+
+    #[test]
+    fn test_formula_cache_lru() {
+        let cache = FormulaCache::new(2);
+        let prepare = |formula| PreparedFormula {
+            formula,
+            state_keys: vec![],
+        };
+        assert!(cache.get_or_prepare("a + 1", prepare).is_some());
+        assert!(cache.get_or_prepare("a = 1", prepare).is_none());
+        // Touch "a + 1" so "a = 1" is evicted next
+        let first = cache.get_or_prepare("a + 1", prepare).unwrap();
+        cache.get_or_prepare("b + 1", prepare);
+        assert_eq!(cache.len(), 2);
+        let again = cache.get_or_prepare("a + 1", prepare).unwrap();
+        assert!(Arc::ptr_eq(&first, &again));
+    }
+}
@@ -6,9 +6,11 @@
 //! - Logic: &&, ||, !
 //! - Built-in functions: integrate, moving_avg, rate_of_change, scale, clamp, etc.
 
+use crate::batch::BatchFormula;
 use crate::builtin_functions::{self, BuiltinFunctions};
+use crate::compiled::{CompiledFormula, FormulaCache, PreparedFormula, StatefulFn};
 use crate::error::{CalcError, Result};
-use crate::state::StateStore;
+use crate::state::{state_key, StateStore};
 use evalexpr::{ContextWithMutableFunctions, ContextWithMutableVariables, Value};
 use regex::Regex;
 use std::borrow::Cow;
@@ -52,6 +54,8 @@ static RE_RATE_OF_CHANGE: LazyLock<Regex> = LazyLock::new(|| {
 pub struct CalcEngine<S: StateStore> {
     /// Built-in function executor
     builtin: BuiltinFunctions<S>,
+    /// Compiled formulas keyed by formula text (state keys resolved for this context)
+    formulas: FormulaCache,
 }
 
 impl<S: StateStore> CalcEngine<S> {
@@ -63,9 +67,96 @@ impl<S: StateStore> CalcEngine<S> {
     pub fn new(state_store: Arc<S>, context: impl Into<String>) -> Self {
         Self {
             builtin: BuiltinFunctions::new(state_store, context),
+            formulas: FormulaCache::default(),
         }
     }
 
+    /// Compiled form of a formula (parsed on first use, then served from the cache)
+    ///
+    /// Returns `None` for formulas outside the compiled subset; those are
+    /// evaluated through evalexpr.
+    pub fn prepare(&self, formula: &str) -> Option<Arc<PreparedFormula>> {
+        self.formulas.get_or_prepare(formula, |compiled| {
+            let state_keys = compiled
+                .stateful_calls()
+                .iter()
+                .map(|call| {
+                    state_key(
+                        self.builtin.context(),
+                        call.func.state_name(),
+                        &compiled.variables()[call.var],
+                    )
+                })
+                .collect();
+            PreparedFormula {
+                formula: compiled,
+                state_keys,
+            }
+        })
+    }
+
+    /// Evaluate a prepared formula against values in [`CompiledFormula::variables`] order
+    pub async fn evaluate_prepared(
+        &self,
+        prepared: &PreparedFormula,
+        values: &[f64],
+    ) -> Result<f64> {
+        let formula = &prepared.formula;
+        if values.len() < formula.variables().len() {
+            return Err(CalcError::expression(format!(
+                "Formula '{}' expects {} values, got {}",
+                formula.source(),
+                formula.variables().len(),
+                values.len()
+            )));
+        }
+
+        let mut stateful = Vec::with_capacity(formula.stateful_calls().len());
+        for (call, key) in formula.stateful_calls().iter().zip(&prepared.state_keys) {
+            let var_name = &formula.variables()[call.var];
+            let value = values[call.var];
+            stateful.push(match call.func {
+                StatefulFn::Integrate { factor } => {
+                    self.builtin
+                        .integrate_keyed(key, var_name, value, factor)
+                        .await?
+                },
+                StatefulFn::MovingAvg { window } => {
+                    self.builtin
+                        .moving_avg_keyed(key, var_name, value, window)
+                        .await?
+                },
+                StatefulFn::RateOfChange => {
+                    self.builtin
+                        .rate_of_change_keyed(key, var_name, value)
+                        .await?
+                },
+            });
+        }
+
+        formula.eval_with_stateful(values, &stateful)
+    }
+
+    /// Evaluate a formula against values in [`CompiledFormula::variables`] order
+    ///
+    /// Fails if the formula is outside the compiled subset.
+    pub async fn evaluate_values(&self, formula: &str, values: &[f64]) -> Result<f64> {
+        let prepared = self.prepare(formula).ok_or_else(|| {
+            CalcError::expression(format!("Formula '{}' cannot be compiled", formula))
+        })?;
+        self.evaluate_prepared(&prepared, values).await
+    }
+
+    /// Batch form of a stateless formula, for evaluating many instances per call
+    ///
+    /// The caller keeps the returned [`BatchFormula`] across ticks.
+    pub fn prepare_batch(&self, formula: &str) -> Result<BatchFormula> {
+        let prepared = self.prepare(formula).ok_or_else(|| {
+            CalcError::expression(format!("Formula '{}' cannot be compiled", formula))
+        })?;
+        BatchFormula::new(prepared.formula.clone())
+    }
+
     /// Evaluate a simple expression (no stateful functions)
     ///
     /// For expressions without integrate/moving_avg/rate_of_change,
@@ -73,6 +164,22 @@ impl<S: StateStore> CalcEngine<S> {
     ///
     /// Supported stateless functions: scale, clamp, abs, min, max, round, sign
     pub fn evaluate_simple(&self, formula: &str, variables: &HashMap<String, f64>) -> Result<f64> {
+        if let Some(prepared) = self.prepare(formula) {
+            if !prepared.formula.is_stateful() {
+                if let Some(values) = bind_values(&prepared.formula, variables) {
+                    return prepared.formula.eval(&values);
+                }
+            }
+        }
+        self.evaluate_evalexpr(formula, variables)
+    }
+
+    /// Evaluate through evalexpr (formulas outside the compiled subset)
+    pub(crate) fn evaluate_evalexpr(
+        &self,
+        formula: &str,
+        variables: &HashMap<String, f64>,
+    ) -> Result<f64> {
         let mut context = evalexpr::HashMapContext::new();
 
         // Add variables
@@ -105,11 +212,18 @@ impl<S: StateStore> CalcEngine<S> {
     /// Note: Function parsing is done via preprocessing, not evalexpr native functions.
     /// This allows async execution of stateful functions.
     pub async fn evaluate(&self, formula: &str, variables: &HashMap<String, f64>) -> Result<f64> {
+        // Compiled path; unbound variables fall through so errors match evalexpr
+        if let Some(prepared) = self.prepare(formula) {
+            if let Some(values) = bind_values(&prepared.formula, variables) {
+                return self.evaluate_prepared(&prepared, &values).await;
+            }
+        }
+
         // Check for stateful function calls
         let processed_formula = self.process_stateful_functions(formula, variables).await?;
 
         // Evaluate the processed formula
-        self.evaluate_simple(&processed_formula, variables)
+        self.evaluate_evalexpr(&processed_formula, variables)
     }
 
     /// Process stateful functions in formula and replace with computed values
@@ -386,6 +500,15 @@ impl<S: StateStore> CalcEngine<S> {
     }
 }
 
+/// Look up a compiled formula's variables by name (`None` if any is missing)
+fn bind_values(formula: &CompiledFormula, variables: &HashMap<String, f64>) -> Option<Vec<f64>> {
+    formula
+        .variables()
+        .iter()
+        .map(|name| variables.get(name).copied())
+        .collect()
+}
+
 #[cfg(test)]
 #[allow(clippy::disallowed_methods)]
 #[allow(clippy::approx_constant)]
@@ -7,6 +7,10 @@
 //! - **Expression evaluation**: Arithmetic, comparison, and logic operations
 //! - **Stateful functions**: `integrate()`, `moving_avg()`, `rate_of_change()`
 //! - **Stateless functions**: `scale()`, `clamp()`, `abs()`, `min()`, `max()`, `round()`, `sign()`
+//! - **Compiled formulas**: parsed once per engine ([`CompiledFormula`]), evaluated
+//!   against a slice of f64; evalexpr remains the fallback for other syntax
+//! - **Batch evaluation**: one stateless formula over columns of inputs
+//!   ([`BatchFormula`]), e.g. the same product formula for all instances
 //!
 //! # Example
 //!
@@ -65,12 +69,16 @@
 //! | `round` | `round(value, decimals)` | Round to decimals |
 //! | `sign` | `sign(value)` | Sign: -1, 0, or 1 |
 
+pub mod batch;
 pub mod builtin_functions;
+pub mod compiled;
 pub mod error;
 pub mod evaluator;
 pub mod state;
 
 // Re-exports for convenience
+pub use batch::BatchFormula;
+pub use compiled::{CompiledFormula, FormulaCache, PreparedFormula, FORMULA_CACHE_CAPACITY};
 pub use error::{CalcError, Result};
 pub use evaluator::CalcEngine;
 pub use state::{MemoryStateStore, NullStateStore, StateStore};
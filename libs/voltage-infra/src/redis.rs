@@ -662,6 +662,106 @@ impl RedisClient {
         Ok(())
     }
 
+    /// Pipelined HSET with binary values (no UTF-8 validation or copies)
+    ///
+    /// Same as [`pipeline_hmset`](Self::pipeline_hmset), but keys, fields and
+    /// values are borrowed as-is into the RESP pipeline.
+    pub async fn pipeline_hset_bytes<K, F, V>(&self, operations: &[(K, Vec<(F, V)>)]) -> Result<()>
+    where
+        K: AsRef<str>,
+        F: AsRef<str>,
+        V: AsRef<[u8]>,
+    {
+        if operations.is_empty() {
+            return Ok(());
+        }
+
+        let mut conn = self.get_connection().await?;
+        let mut pipe = redis::pipe();
+
+        for (key, fields) in operations {
+            if !fields.is_empty() {
+                let mut cmd = redis::cmd("HSET");
+                cmd.arg(key.as_ref());
+                for (field, value) in fields {
+                    cmd.arg(field.as_ref()).arg(value.as_ref());
+                }
+                pipe.add_command(cmd);
+            }
+        }
+
+        pipe.query_async::<()>(&mut *conn)
+            .await
+            .with_context(|| "Failed to execute pipeline HSET")?;
+
+        Ok(())
+    }
+
+    /// MSET with binary values: many plain string keys in one command
+    pub async fn mset_bytes<K, V>(&self, entries: &[(K, V)]) -> Result<()>
+    where
+        K: AsRef<str>,
+        V: AsRef<[u8]>,
+    {
+        if entries.is_empty() {
+            return Ok(());
+        }
+
+        let mut conn = self.get_connection().await?;
+        let mut cmd = redis::cmd("MSET");
+        for (key, value) in entries {
+            cmd.arg(key.as_ref()).arg(value.as_ref());
+        }
+
+        cmd.query_async::<()>(&mut *conn)
+            .await
+            .with_context(|| "Failed to execute MSET")?;
+
+        Ok(())
+    }
+
+    /// Pipelined XADD with binary values, capping each stream at ~`max_len` entries
+    ///
+    /// Every entry is appended with an auto-generated ID (`XADD key MAXLEN ~ n * ...`).
+    pub async fn pipeline_xadd_bytes<K, F, V>(
+        &self,
+        entries: &[(K, Vec<(F, V)>)],
+        max_len: usize,
+    ) -> Result<()>
+    where
+        K: AsRef<str>,
+        F: AsRef<str>,
+        V: AsRef<[u8]>,
+    {
+        if entries.is_empty() {
+            return Ok(());
+        }
+
+        let mut conn = self.get_connection().await?;
+        let mut pipe = redis::pipe();
+
+        for (key, fields) in entries {
+            if !fields.is_empty() {
+                let mut cmd = redis::cmd("XADD");
+                cmd.arg(key.as_ref())
+                    .arg("MAXLEN")
+                    .arg("~")
+                    .arg(max_len)
+                    .arg("*");
+                for (field, value) in fields {
+                    cmd.arg(field.as_ref()).arg(value.as_ref());
+                }
+                pipe.add_command(cmd);
+            }
+        }
+
+        pipe.query_async::<()>(&mut *conn)
+            .await
+            .with_context(|| "Failed to execute pipeline XADD")?;
+
+        Ok(())
+    }
+
     /// Get pool statistics
     pub fn pool_state(&self) -> bb8::State {
         self.pool.state()
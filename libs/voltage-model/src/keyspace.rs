@@ -270,6 +270,27 @@ impl KeySpaceConfig {
         format!("{}:{}:A:{}", self.inst_prefix, instance_id, point_id)
     }
 
+    /// Build channel history stream key: comsrv:history
+    ///
+    /// Redis Stream of flushed channel point changes, consumed by hissrv.
+    pub fn channel_history_stream_key(&self) -> String {
+        format!("{}:history", self.data_prefix)
+    }
+
+    /// Build instance history stream key: inst:history
+    ///
+    /// Redis Stream of flushed instance point changes, consumed by hissrv.
+    ///
+    /// # Examples
+    /// ```
+    /// use voltage_model::KeySpaceConfig;
+    /// let config = KeySpaceConfig::production();
+    /// assert_eq!(config.instance_history_stream_key(), "inst:history");
+    /// ```
+    pub fn instance_history_stream_key(&self) -> String {
+        format!("{}:history", self.inst_prefix)
+    }
+
     /// Build instance pattern for SCAN/KEYS: inst:{instance_id}:*
     pub fn instance_pattern(&self, instance_id: u32) -> String {
         format!("{}:{}:*", self.inst_prefix, instance_id)
@@ -288,6 +309,63 @@ impl KeySpaceConfig {
     pub fn m2c_route_key(&self, instance_id: u32, point_type: PointType, point_id: &str) -> String {
         format!("{}:{}:{}", instance_id, point_type.as_str(), point_id)
     }
+
+    // ========== Sharding ==========
+
+    /// Entity that owns a key: `{data_prefix}:{channel_id}:*` belongs to a
+    /// channel, `{inst_prefix}:{instance_id}:*` to an instance
+    ///
+    /// Routing tables, history streams and anything else are `Global`.
+    pub fn key_owner(&self, key: &str) -> KeyOwner {
+        if let Some(id) = Self::owner_id(key, &self.data_prefix) {
+            return KeyOwner::Channel(id);
+        }
+        if let Some(id) = self
+            .target_prefix
+            .as_deref()
+            .and_then(|prefix| Self::owner_id(key, prefix))
+        {
+            return KeyOwner::Channel(id);
+        }
+        match Self::owner_id(key, &self.inst_prefix) {
+            Some(id) => KeyOwner::Instance(id),
+            None => KeyOwner::Global,
+        }
+    }
+
+    /// Shard index of a key among `shards` Redis servers
+    ///
+    /// Channel keys (hashes and TODO queues) go to `channel_id % shards`,
+    /// instance keys to `instance_id % shards`, global keys to shard 0.
+    /// Key names are unchanged, so readers that know the selector find every
+    /// key without Redis Cluster hash tags.
+    pub fn shard_of(&self, key: &str, shards: usize) -> usize {
+        if shards <= 1 {
+            return 0;
+        }
+        match self.key_owner(key) {
+            KeyOwner::Channel(id) | KeyOwner::Instance(id) => id as usize % shards,
+            KeyOwner::Global => 0,
+        }
+    }
+
+    /// Parse `{prefix}:{id}` or `{prefix}:{id}:...`
+    fn owner_id(key: &str, prefix: &str) -> Option<u32> {
+        let rest = key.strip_prefix(prefix)?.strip_prefix(':')?;
+        let id = rest.split_once(':').map_or(rest, |(id, _)| id);
+        id.parse().ok()
+    }
+}
+
+/// Owner of a Redis key, see [`KeySpaceConfig::key_owner`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum KeyOwner {
+    /// Channel data, raw/ts hashes and TODO queues
+    Channel(u32),
+    /// Instance measurement/action hashes and metadata
+    Instance(u32),
+    /// Routing tables, history streams, rule state
+    Global,
 }
 
 #[cfg(test)]
@@ -484,4 +562,29 @@ mod tests {
         // Verify direct String return (no Cow overhead)
         assert_eq!(key, "comsrv:1001:T");
     }
+
+    #[test]
+    fn test_key_owner_and_shard() {
+        let config = KeySpaceConfig::production();
+        assert_eq!(config.key_owner("comsrv:1001:T"), KeyOwner::Channel(1001));
+        assert_eq!(
+            config.key_owner(&config.todo_queue_key(1001, PointType::Control)),
+            KeyOwner::Channel(1001)
+        );
+        assert_eq!(config.key_owner("inst:7:M"), KeyOwner::Instance(7));
+        assert_eq!(config.key_owner("inst:7"), KeyOwner::Instance(7));
+        assert_eq!(config.key_owner("comsrv:history"), KeyOwner::Global);
+        assert_eq!(config.key_owner("route:c2m"), KeyOwner::Global);
+        assert_eq!(config.key_owner("comsrvx:1:T"), KeyOwner::Global);
+
+        assert_eq!(config.shard_of("comsrv:1001:T", 1), 0);
+        assert_eq!(config.shard_of("comsrv:1001:T", 4), 1);
+        assert_eq!(config.shard_of("comsrv:1001:C:TODO", 4), 1);
+        assert_eq!(config.shard_of("inst:6:A", 4), 2);
+        assert_eq!(config.shard_of("route:m2c", 4), 0);
+
+        let test = KeySpaceConfig::test();
+        assert_eq!(test.key_owner("test:comsrv:3:A"), KeyOwner::Channel(3));
+        assert_eq!(test.key_owner("test:inst:3:A"), KeyOwner::Instance(3));
+    }
 }
@@ -18,6 +18,6 @@ pub mod validation;
 
 // Re-exports for convenience
 pub use error::{ModelError, Result};
-pub use keyspace::KeySpaceConfig;
+pub use keyspace::{KeyOwner, KeySpaceConfig};
 pub use types::{PointRole, PointType};
 pub use validation::{validate_calculation_id, validate_instance_name, validate_product_name};
@@ -0,0 +1,134 @@
+//! Channel batch routing benchmarks
+//!
+//! - `write_channel_batch_direct` (shared memory + WriteBuffer backup) vs
+//!   `write_channel_batch_buffered` (WriteBuffer only) at 1k/10k/100k points
+//! - C2C cascade depth 0..=MAX_C2C_CASCADE_DEPTH
+//!
+//! Run: `cargo bench -p voltage-routing`
+
+#![allow(clippy::disallowed_methods)] // unwrap is fine in benches
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use std::collections::HashMap;
+use std::hint::black_box;
+use voltage_model::PointType;
+use voltage_routing::{
+    write_channel_batch_buffered, write_channel_batch_direct, ChannelPointUpdate,
+    MAX_C2C_CASCADE_DEPTH,
+};
+use voltage_rtdb::{
+    ChannelToSlotIndex, RoutingCache, SharedConfig, SharedVecRtdbWriter, WriteBuffer,
+    WriteBufferConfig,
+};
+
+/// Points per channel (and per instance)
+const POINTS_PER_CHANNEL: u32 = 1000;
+/// First channel ID; channel N routes C2M to instance N - FIRST_CHANNEL + 1
+const FIRST_CHANNEL: u32 = 1001;
+const MAX_CHANNELS: u32 = 100;
+
+fn instance_for(channel_id: u32) -> u32 {
+    channel_id - FIRST_CHANNEL + 1
+}
+
+/// C2M routes for every telemetry point of every channel
+fn c2m_map(channels: u32) -> HashMap<String, String> {
+    let mut c2m = HashMap::new();
+    for ch in FIRST_CHANNEL..FIRST_CHANNEL + channels {
+        for p in 1..=POINTS_PER_CHANNEL {
+            c2m.insert(
+                format!("{}:T:{}", ch, p),
+                format!("{}:M:{}", instance_for(ch), p),
+            );
+        }
+    }
+    c2m
+}
+
+fn updates(count: u32) -> Vec<ChannelPointUpdate> {
+    (0..count)
+        .map(|i| {
+            let ch = FIRST_CHANNEL + i / POINTS_PER_CHANNEL;
+            let pid = i % POINTS_PER_CHANNEL + 1;
+            ChannelPointUpdate::new(ch, PointType::Telemetry, pid, i as f64 * 0.1)
+        })
+        .collect()
+}
+
+/// Shared memory writer with every channel and instance registered
+fn shm_writer(name: &str, channels: u32) -> (SharedConfig, SharedVecRtdbWriter) {
+    let path = std::env::temp_dir().join(format!("{}_{}.shm", name, std::process::id()));
+    let config = SharedConfig::default()
+        .with_path(path)
+        .with_max_instances(channels as usize)
+        .with_max_points_per_instance(POINTS_PER_CHANNEL as usize)
+        .with_max_channels(channels as usize)
+        .with_max_points_per_channel(POINTS_PER_CHANNEL as usize);
+    let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+    let point_ids: Vec<u32> = (1..=POINTS_PER_CHANNEL).collect();
+    for ch in FIRST_CHANNEL..FIRST_CHANNEL + channels {
+        writer
+            .register_instance(instance_for(ch), &point_ids, &[])
+            .unwrap();
+        writer
+            .register_channel(ch, &point_ids, &[], &[], &[])
+            .unwrap();
+    }
+    (config, writer)
+}
+
+fn bench_batch_paths(c: &mut Criterion) {
+    let cache = RoutingCache::from_maps(c2m_map(MAX_CHANNELS), HashMap::new(), HashMap::new());
+    let (config, writer) = shm_writer("voltage_bench_routing", MAX_CHANNELS);
+    let index = ChannelToSlotIndex::build(&cache, &writer);
+    let buffer = WriteBuffer::new(WriteBufferConfig::default());
+
+    let mut group = c.benchmark_group("channel_batch");
+    for count in [1_000u32, 10_000, 100_000] {
+        group.throughput(Throughput::Elements(count as u64));
+        let batch = updates(count);
+
+        group.bench_with_input(BenchmarkId::new("direct", count), &batch, |b, batch| {
+            b.iter(|| write_channel_batch_direct(&writer, &index, &buffer, &cache, batch.clone()))
+        });
+        group.bench_with_input(BenchmarkId::new("buffered", count), &batch, |b, batch| {
+            b.iter(|| write_channel_batch_buffered(&buffer, &cache, batch.clone()))
+        });
+    }
+    group.finish();
+
+    std::fs::remove_file(&config.path).ok();
+}
+
+fn bench_c2c_cascade(c: &mut Criterion) {
+    // Chain channel 1001 -> 1002 -> 1003 for every point; depth N starts at
+    // the channel N hops from the end of the chain.
+    let depth = MAX_C2C_CASCADE_DEPTH as u32;
+    let mut c2c = HashMap::new();
+    for hop in 0..depth {
+        for p in 1..=POINTS_PER_CHANNEL {
+            c2c.insert(
+                format!("{}:T:{}", FIRST_CHANNEL + hop, p),
+                format!("{}:T:{}", FIRST_CHANNEL + hop + 1, p),
+            );
+        }
+    }
+    let cache = RoutingCache::from_maps(c2m_map(depth + 1), HashMap::new(), c2c);
+    let buffer = WriteBuffer::new(WriteBufferConfig::default());
+
+    let mut group = c.benchmark_group("c2c_cascade");
+    group.throughput(Throughput::Elements(POINTS_PER_CHANNEL as u64));
+    for hops in 0..=depth {
+        let start = FIRST_CHANNEL + depth - hops;
+        let batch: Vec<ChannelPointUpdate> = (1..=POINTS_PER_CHANNEL)
+            .map(|p| ChannelPointUpdate::new(start, PointType::Telemetry, p, p as f64))
+            .collect();
+        group.bench_with_input(BenchmarkId::new("depth", hops), &batch, |b, batch| {
+            b.iter(|| write_channel_batch_buffered(&buffer, &cache, black_box(batch.clone())))
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_batch_paths, bench_c2c_cascade);
+criterion_main!(benches);
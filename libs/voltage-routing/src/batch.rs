@@ -8,9 +8,9 @@ use anyhow::{Context, Result};
 use rustc_hash::FxHashMap;
 use std::sync::Arc;
 use tracing::debug;
-use voltage_model::PointType;
+use voltage_model::{PointRole, PointType};
 use voltage_rtdb::numfmt::{f64_to_bytes, precomputed};
-use voltage_rtdb::{KeySpaceConfig, RoutingCache, Rtdb, WriteBuffer};
+use voltage_rtdb::{C2CTarget, KeySpaceConfig, RoutingCache, Rtdb, WriteBuffer};
 
 use crate::MAX_C2C_CASCADE_DEPTH;
 
@@ -71,13 +71,67 @@ impl BatchRoutingResult {
     }
 }
 
+/// Append the C2C cascade of every update to `updates`
+///
+/// Uses the closure precomputed by `RoutingCache`, so no recursion or
+/// re-grouping per hop. Forwards are appended level by level (all first
+/// hops, then all second hops), so a cascaded value lands after any direct
+/// update of the same point in the batch.
+/// An update entering at `cascade_depth` d follows at most
+/// `MAX_C2C_CASCADE_DEPTH - d` hops.
+///
+/// Returns the number of forwards appended.
+fn expand_c2c_forwards(
+    routing_cache: &RoutingCache,
+    updates: &mut Vec<ChannelPointUpdate>,
+) -> usize {
+    let max_depth = MAX_C2C_CASCADE_DEPTH as usize;
+    let fanouts: Vec<(usize, Arc<[C2CTarget]>)> = updates
+        .iter()
+        .enumerate()
+        .filter(|(_, update)| (update.cascade_depth as usize) < max_depth)
+        .filter_map(|(idx, update)| {
+            routing_cache
+                .lookup_c2c_fanout_by_parts(update.channel_id, update.point_type, update.point_id)
+                .map(|hops| (idx, hops))
+        })
+        .collect();
+    if fanouts.is_empty() {
+        return 0;
+    }
+
+    let original_len = updates.len();
+    for level in 0..max_depth {
+        for (idx, hops) in &fanouts {
+            let source = &updates[*idx];
+            let depth = source.cascade_depth as usize + level + 1;
+            let Some(target) = hops.get(level) else {
+                continue;
+            };
+            if depth > max_depth {
+                continue;
+            }
+            let forward = ChannelPointUpdate {
+                channel_id: target.channel_id,
+                point_type: target.point_type,
+                point_id: target.point_id,
+                value: source.value,
+                raw_value: source.raw_value,
+                cascade_depth: depth as u8,
+            };
+            updates.push(forward);
+        }
+    }
+    updates.len() - original_len
+}
+
 /// Write channel batch with C2M/C2C routing (optimized with itoa/ryu)
 ///
 /// Uses precomputed point ID pool and ryu for zero-allocation formatting.
 pub async fn write_channel_batch<R>(
     rtdb: &R,
     routing_cache: &RoutingCache,
-    updates: Vec<ChannelPointUpdate>,
+    mut updates: Vec<ChannelPointUpdate>,
 ) -> Result<BatchRoutingResult>
 where
     R: Rtdb,
@@ -86,6 +140,12 @@ where
         return Ok(BatchRoutingResult::default());
     }
 
+    // Append cascaded C2C writes so one pass covers every hop
+    let c2c_forwards = expand_c2c_forwards(routing_cache, &mut updates);
+    if c2c_forwards > 0 {
+        debug!("Flattened {} C2C forwards", c2c_forwards);
+    }
+
     // Group updates by (channel_id, point_type) - FxHashMap for faster hashing
     let mut grouped: FxHashMap<(u32, PointType), Vec<ChannelPointUpdate>> = FxHashMap::default();
     for update in updates {
@@ -102,7 +162,10 @@ where
         .as_millis() as i64;
 
     let config = KeySpaceConfig::production_cached();
-    let mut result = BatchRoutingResult::default();
+    let mut result = BatchRoutingResult {
+        c2c_forwards,
+        ..Default::default()
+    };
 
     // Cache point_id -> Arc<str> for O(1) clone - FxHashMap for faster hashing
     let mut point_id_str_cache: FxHashMap<u32, Arc<str>> = FxHashMap::default();
@@ -111,7 +174,6 @@ where
         // Prepare 3-layer data
         let mut points_3layer = Vec::with_capacity(updates.len());
         let mut instance_writes: FxHashMap<u32, Vec<(String, bytes::Bytes)>> = FxHashMap::default();
-        let mut c2c_forwards: Vec<ChannelPointUpdate> = Vec::new();
 
         for update in &updates {
             let raw_value = update.raw_value.unwrap_or(update.value);
@@ -131,22 +193,6 @@ where
                     .or_default()
                     .push((point_id_arc.to_string(), f64_to_bytes(update.value)));
             }
-
-            // C2C routing lookup - zero-allocation using structured key
-            if update.cascade_depth < MAX_C2C_CASCADE_DEPTH {
-                if let Some(target) =
-                    routing_cache.lookup_c2c_by_parts(channel_id, point_type, update.point_id)
-                {
-                    c2c_forwards.push(ChannelPointUpdate {
-                        channel_id: target.channel_id,
-                        point_type: target.point_type,
-                        point_id: target.point_id,
-                        value: update.value,
-                        raw_value: update.raw_value,
-                        cascade_depth: update.cascade_depth + 1,
-                    });
-                }
-            }
         }
 
         // Write 3-layer channel data
@@ -169,19 +215,6 @@ where
                 .context("Failed to write instance measurements")?;
             result.c2m_writes += 1;
         }
-
-        // Process C2C forwards recursively
-        if !c2c_forwards.is_empty() {
-            let forward_count = c2c_forwards.len();
-            debug!(
-                "Processing {} C2C forwards for channel {}",
-                forward_count, channel_id
-            );
-            let sub_result =
-                Box::pin(write_channel_batch(rtdb, routing_cache, c2c_forwards)).await?;
-            result.c2c_forwards += forward_count;
-            result.merge(sub_result);
-        }
     }
 
     Ok(result)
@@ -189,7 +222,7 @@ where
 
 /// Write channel points to buffer (Redis only)
 ///
-/// Uses precomputed point ID pool and ryu for zero-allocation formatting.
+/// Uses the typed WriteBuffer path (integer keys, values formatted at flush).
 /// Removed VecRtdb - using SharedMemory + Redis two-tier architecture.
 ///
 /// # Arguments
@@ -199,12 +232,18 @@ where
 pub fn write_channel_batch_buffered(
     write_buffer: &WriteBuffer,
     routing_cache: &RoutingCache,
-    updates: Vec<ChannelPointUpdate>,
+    mut updates: Vec<ChannelPointUpdate>,
 ) -> BatchRoutingResult {
     if updates.is_empty() {
         return BatchRoutingResult::default();
     }
 
+    // Append cascaded C2C writes so one pass covers every hop
+    let c2c_forwards = expand_c2c_forwards(routing_cache, &mut updates);
+    if c2c_forwards > 0 {
+        debug!("Flattened {} C2C forwards", c2c_forwards);
+    }
+
     // Group updates by (channel_id, point_type) - FxHashMap for faster hashing
     let mut grouped: FxHashMap<(u32, PointType), Vec<ChannelPointUpdate>> = FxHashMap::default();
     for update in updates {
@@ -220,19 +259,16 @@ pub fn write_channel_batch_buffered(
         .expect("System time should be after UNIX epoch")
         .as_millis() as i64;
 
-    let config = KeySpaceConfig::production_cached();
-    let mut result = BatchRoutingResult::default();
-
-    // Cache point_id -> Arc<str> using precomputed pool - FxHashMap
-    let mut point_id_str_cache: FxHashMap<u32, Arc<str>> = FxHashMap::default();
+    let mut result = BatchRoutingResult {
+        c2c_forwards,
+        ..Default::default()
+    };
 
     for ((channel_id, point_type), updates) in grouped {
         // Prepare 3-layer data
         let mut points_3layer = Vec::with_capacity(updates.len());
-        // Use Arc<str> for field names to match WriteBuffer signature - FxHashMap
-        let mut instance_writes: FxHashMap<u32, Vec<(Arc<str>, bytes::Bytes)>> =
-            FxHashMap::default();
-        let mut c2c_forwards: Vec<ChannelPointUpdate> = Vec::new();
+        // Instance writes for C2M routing (typed WriteBuffer path) - FxHashMap
+        let mut instance_writes: FxHashMap<u32, Vec<(u32, f64)>> = FxHashMap::default();
 
         for update in &updates {
             let raw_value = update.raw_value.unwrap_or(update.value);
@@ -242,66 +278,23 @@ pub fn write_channel_batch_buffered(
             if let Some(target) =
                 routing_cache.lookup_c2m_by_parts(channel_id, point_type, update.point_id)
             {
-                // Use precomputed pool (0-255) or itoa, O(1) Arc clone
-                let point_id_str = point_id_str_cache
-                    .entry(target.point_id)
-                    .or_insert_with(|| precomputed::get_point_id_str_or_alloc(target.point_id))
-                    .clone();
-
                 instance_writes
                     .entry(target.instance_id)
                     .or_default()
-                    .push((point_id_str, f64_to_bytes(update.value)));
-            }
-
-            // C2C routing lookup - zero-allocation using structured key
-            if update.cascade_depth < MAX_C2C_CASCADE_DEPTH {
-                if let Some(target) =
-                    routing_cache.lookup_c2c_by_parts(channel_id, point_type, update.point_id)
-                {
-                    c2c_forwards.push(ChannelPointUpdate {
-                        channel_id: target.channel_id,
-                        point_type: target.point_type,
-                        point_id: target.point_id,
-                        value: update.value,
-                        raw_value: update.raw_value,
-                        cascade_depth: update.cascade_depth + 1,
-                    });
-                }
+                    .push((target.point_id, update.value));
             }
         }
 
-        // Removed VecRtdb - write directly to WriteBuffer for Redis
-        let channel_key = config.channel_key(channel_id, point_type);
-
-        // Buffer 3-layer channel data to WriteBuffer (for Redis)
-        let buffered = voltage_rtdb::helpers::buffer_channel_points(
-            write_buffer,
-            &channel_key,
-            points_3layer,
-            timestamp_ms,
-        );
+        // Buffer 3-layer channel data to WriteBuffer (typed keys, for Redis)
+        let buffered =
+            write_buffer.buffer_channel(channel_id, point_type, &points_3layer, timestamp_ms);
         result.channel_writes += buffered;
 
         // Buffer instance data (C2M results)
         for (instance_id, values) in instance_writes {
-            let instance_key = config.instance_measurement_key(instance_id);
-            write_buffer.buffer_hash_mset(&instance_key, values);
+            write_buffer.buffer_instance(instance_id, PointRole::Measurement, &values);
             result.c2m_writes += 1;
         }
-
-        // Process C2C forwards recursively (also buffered)
-        if !c2c_forwards.is_empty() {
-            let forward_count = c2c_forwards.len();
-            debug!(
-                "Processing {} C2C forwards for channel {}",
-                forward_count, channel_id
-            );
-            let sub_result =
-                write_channel_batch_buffered(write_buffer, routing_cache, c2c_forwards);
-            result.c2c_forwards += forward_count;
-            result.merge(sub_result);
-        }
     }
 
     result
@@ -310,7 +303,7 @@ pub fn write_channel_batch_buffered(
 /// High-performance batch write using direct channel-to-slot mapping
 ///
 /// Uses ChannelToSlotIndex to bypass C2M routing lookup during writes.
-/// Uses precomputed point ID pool and ryu for zero-allocation formatting.
+/// Redis backup goes through the typed WriteBuffer path (integer keys).
 ///
 /// # Architecture
 /// ```text
@@ -336,7 +329,7 @@ pub fn write_channel_batch_direct(
     channel_index: &voltage_rtdb::ChannelToSlotIndex,
     write_buffer: &WriteBuffer,
     routing_cache: &RoutingCache,
-    updates: Vec<ChannelPointUpdate>,
+    mut updates: Vec<ChannelPointUpdate>,
 ) -> BatchRoutingResult {
     if updates.is_empty() {
         return BatchRoutingResult::default();
@@ -348,8 +341,16 @@ pub fn write_channel_batch_direct(
         .expect("System time should be after UNIX epoch")
         .as_millis() as u64;
 
-    let config = KeySpaceConfig::production_cached();
-    let mut result = BatchRoutingResult::default();
+    // Append cascaded C2C writes so one pass covers every hop
+    let c2c_forwards = expand_c2c_forwards(routing_cache, &mut updates);
+    if c2c_forwards > 0 {
+        debug!("Flattened {} C2C forwards with direct write", c2c_forwards);
+    }
+
+    let mut result = BatchRoutingResult {
+        c2c_forwards,
+        ..Default::default()
+    };
 
     // Group updates by (channel_id, point_type) for efficient buffer writes - FxHashMap
     let mut grouped: FxHashMap<(u32, PointType), Vec<ChannelPointUpdate>> = FxHashMap::default();
@@ -360,16 +361,11 @@ pub fn write_channel_batch_direct(
             .push(update);
     }
 
-    // Cache point_id -> Arc<str> using precomputed pool - FxHashMap
-    let mut point_id_str_cache: FxHashMap<u32, Arc<str>> = FxHashMap::default();
-    let mut c2c_forwards: Vec<ChannelPointUpdate> = Vec::new();
-
     for ((channel_id, point_type), updates) in grouped {
         // Prepare 3-layer data for Redis backup
         let mut points_3layer = Vec::with_capacity(updates.len());
         // Instance writes for C2M routing (Redis backup) - FxHashMap
-        let mut instance_writes: FxHashMap<u32, Vec<(Arc<str>, bytes::Bytes)>> =
-            FxHashMap::default();
+        let mut instance_writes: FxHashMap<u32, Vec<(u32, f64)>> = FxHashMap::default();
 
         for update in &updates {
             let raw_value = update.raw_value.unwrap_or(update.value);
@@ -395,70 +391,23 @@ pub fn write_channel_batch_direct(
             if let Some(target) =
                 routing_cache.lookup_c2m_by_parts(channel_id, point_type, update.point_id)
             {
-                // Use precomputed pool (0-255) or itoa, O(1) Arc clone
-                let point_id_str = point_id_str_cache
-                    .entry(target.point_id)
-                    .or_insert_with(|| precomputed::get_point_id_str_or_alloc(target.point_id))
-                    .clone();
-
                 instance_writes
                     .entry(target.instance_id)
                     .or_default()
-                    .push((point_id_str, f64_to_bytes(update.value)));
-            }
-
-            // C2C routing lookup
-            if update.cascade_depth < MAX_C2C_CASCADE_DEPTH {
-                if let Some(target) =
-                    routing_cache.lookup_c2c_by_parts(channel_id, point_type, update.point_id)
-                {
-                    c2c_forwards.push(ChannelPointUpdate {
-                        channel_id: target.channel_id,
-                        point_type: target.point_type,
-                        point_id: target.point_id,
-                        value: update.value,
-                        raw_value: update.raw_value,
-                        cascade_depth: update.cascade_depth + 1,
-                    });
-                }
+                    .push((target.point_id, update.value));
             }
         }
 
         // Buffer 3-layer channel data to WriteBuffer (Redis backup)
-        let channel_key = config.channel_key(channel_id, point_type);
-        voltage_rtdb::helpers::buffer_channel_points(
-            write_buffer,
-            &channel_key,
-            points_3layer,
-            timestamp_ms as i64,
-        );
+        write_buffer.buffer_channel(channel_id, point_type, &points_3layer, timestamp_ms as i64);
 
         // Buffer instance data (C2M results for Redis)
         for (instance_id, values) in instance_writes {
-            let instance_key = config.instance_measurement_key(instance_id);
-            write_buffer.buffer_hash_mset(&instance_key, values);
+            write_buffer.buffer_instance(instance_id, PointRole::Measurement, &values);
             result.c2m_writes += 1;
         }
     }
 
-    // Process C2C forwards recursively
-    if !c2c_forwards.is_empty() {
-        let forward_count = c2c_forwards.len();
-        debug!(
-            "Processing {} C2C forwards with direct write",
-            forward_count
-        );
-        let sub_result = write_channel_batch_direct(
-            shared_writer,
-            channel_index,
-            write_buffer,
-            routing_cache,
-            c2c_forwards,
-        );
-        result.c2c_forwards += forward_count;
-        result.merge(sub_result);
-    }
-
     result
 }
 
@@ -501,4 +450,51 @@ mod tests {
         assert_eq!(r1.c2m_writes, 6);
         assert_eq!(r1.c2c_forwards, 3);
     }
+
+    #[tokio::test]
+    #[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+    async fn test_flattened_c2c_cascade() {
+        use std::collections::HashMap;
+        use voltage_rtdb::MemoryRtdb;
+
+        // 1001 -> 1002 -> 1003 -> 1004, plus a cycle 2001 <-> 2002
+        let c2c: HashMap<String, String> = [
+            ("1001:T:1", "1002:T:1"),
+            ("1002:T:1", "1003:T:1"),
+            ("1003:T:1", "1004:T:1"),
+            ("2001:T:1", "2002:T:1"),
+            ("2002:T:1", "2001:T:1"),
+        ]
+        .into_iter()
+        .map(|(k, v)| (k.to_string(), v.to_string()))
+        .collect();
+        let c2m = HashMap::from([("1003:T:1".to_string(), "7:M:3".to_string())]);
+        let cache = RoutingCache::from_maps(c2m, HashMap::new(), c2c);
+        let rtdb = MemoryRtdb::new();
+
+        let updates = vec![
+            ChannelPointUpdate::new(1001, PointType::Telemetry, 1, 12.5),
+            ChannelPointUpdate::new(2001, PointType::Telemetry, 1, 3.0),
+        ];
+        let result = write_channel_batch(&rtdb, &cache, updates).await.unwrap();
+
+        // Two hops from 1001 (depth limit), one from 2001 (cycle cut)
+        assert_eq!(result.c2c_forwards, 3);
+        assert_eq!(result.channel_writes, 5);
+        assert_eq!(result.c2m_writes, 1);
+
+        let config = KeySpaceConfig::production();
+        for channel_id in [1001, 1002, 1003] {
+            let key = config.channel_key(channel_id, PointType::Telemetry);
+            assert!(rtdb.hash_get(&key, "1").await.unwrap().is_some());
+        }
+        let key = config.channel_key(1004, PointType::Telemetry);
+        assert!(rtdb.hash_get(&key, "1").await.unwrap().is_none());
+        let value = rtdb
+            .hash_get(&config.instance_measurement_key(7), "3")
+            .await
+            .unwrap()
+            .unwrap();
+        assert_eq!(&value[..], b"12.5");
+    }
 }
@@ -17,12 +17,13 @@ pub use batch::{
     write_channel_batch, write_channel_batch_buffered, write_channel_batch_direct,
     BatchRoutingResult, ChannelPointUpdate,
 };
-pub use loader::{load_routing_maps, RoutingMaps};
+pub use loader::{load_instance_routing_maps, load_routing_maps, RoutingMaps};
 
 // Re-export RoutingCache for convenience
 pub use voltage_rtdb::RoutingCache;
 
 use anyhow::{Context, Result};
+use tracing::debug;
 use voltage_rtdb::Rtdb;
 
 /// Status string for successful operations
@@ -80,7 +81,6 @@ pub struct RouteContext {
 /// # Returns
 /// * `Ok(ActionRouteOutcome)` - Routing outcome with metadata
 /// * `Err(anyhow::Error)` - Routing error
-#[allow(deprecated)] // Uses time_millis internally until TimeProvider migration is complete
 pub async fn set_action_point<R>(
     redis: &R,
     routing_cache: &voltage_rtdb::RoutingCache,
@@ -88,6 +88,28 @@ pub async fn set_action_point<R>(
     point_id: &str,
     value: f64,
 ) -> Result<ActionRouteOutcome>
+where
+    R: Rtdb,
+{
+    set_action_point_with_commands(redis, routing_cache, None, instance_id, point_id, value).await
+}
+
+/// Execute action routing, pushing routed commands to the shared memory command ring
+///
+/// Same as [`set_action_point`], but when `commands` is available the routed
+/// command is first pushed to the channel's command ring so comsrv picks it up
+/// without a Redis round trip. The Redis writes and TODO trigger still happen
+/// (fallback and audit trail); comsrv drops the duplicate by timestamp.
+/// A full or missing ring is not an error - the TODO queue delivers the command.
+#[allow(deprecated)] // Uses time_millis internally until TimeProvider migration is complete
+pub async fn set_action_point_with_commands<R>(
+    redis: &R,
+    routing_cache: &voltage_rtdb::RoutingCache,
+    commands: Option<&voltage_rtdb::SharedCommandSender>,
+    instance_id: u32,
+    point_id: &str,
+    value: f64,
+) -> Result<ActionRouteOutcome>
 where
     R: Rtdb,
 {
@@ -113,6 +135,27 @@ where
         let point_type_enum = target.point_type;
         let comsrv_point_id = target.point_id;
 
+        // Get current timestamp (milliseconds) - use local system time for efficiency
+        // Shared by the command ring and the TODO trigger so comsrv can deduplicate
+        use voltage_rtdb::{SystemTimeProvider, TimeProvider};
+        let timestamp_ms = SystemTimeProvider.now_millis();
+
+        // Fast path: hand the command to comsrv through shared memory
+        if let Some(sender) = commands {
+            let pushed = sender.push(
+                channel_id,
+                voltage_rtdb::RingCommand {
+                    point_type: point_type_enum,
+                    point_id: comsrv_point_id,
+                    value,
+                    timestamp_ms,
+                },
+            );
+            if !pushed {
+                debug!("Ch{} cmd ring unavailable, TODO only", channel_id);
+            }
+        }
+
         // Step 3: Write to instance Action Hash (state storage)
         let instance_action_key = config.instance_action_key(instance_id);
         redis
@@ -121,10 +164,6 @@ where
             .context("Failed to write instance action point")?;
 
         // Step 4: Write to channel Hash + auto-trigger TODO queue (Write-Triggers-Routing pattern)
-        // Get current timestamp (milliseconds) - use local system time for efficiency
-        use voltage_rtdb::{SystemTimeProvider, TimeProvider};
-        let timestamp_ms = SystemTimeProvider.now_millis();
-
         // Use unified helper: writes channel Hash (value/ts/raw) + triggers TODO queue
         voltage_rtdb::helpers::set_channel_point_with_trigger(
             redis,
@@ -184,7 +223,9 @@ where
 // ============================================================================
 
 /// Maximum cascade depth for C2C routing to prevent infinite loops
-pub const MAX_C2C_CASCADE_DEPTH: u8 = 2;
+///
+/// Defined next to the routing tables, which flatten C2C chains to this depth.
+pub use voltage_rtdb::MAX_C2C_CASCADE_DEPTH;
 
 #[cfg(test)]
 #[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
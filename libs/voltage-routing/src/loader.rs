@@ -50,10 +50,10 @@ pub async fn load_routing_maps(sqlite_pool: &sqlx::SqlitePool) -> Result<Routing
     let mut maps = RoutingMaps::default();
 
     // Load C2M routing (measurement_routing table)
-    load_c2m_routes(sqlite_pool, &keyspace, &mut maps.c2m).await?;
+    load_c2m_routes(sqlite_pool, &keyspace, None, &mut maps.c2m).await?;
 
     // Load M2C routing (action_routing table)
-    load_m2c_routes(sqlite_pool, &keyspace, &mut maps.m2c).await?;
+    load_m2c_routes(sqlite_pool, &keyspace, None, &mut maps.m2c).await?;
 
     // Load C2C routing (channel_routing table) - optional
     load_c2c_routes(sqlite_pool, &keyspace, &mut maps.c2c).await;
@@ -68,10 +68,38 @@ pub async fn load_routing_maps(sqlite_pool: &sqlx::SqlitePool) -> Result<Routing
     Ok(maps)
 }
 
+/// Load the C2M and M2C routes of a single instance
+///
+/// Same format as `load_routing_maps()`, restricted to routes of `instance_id`
+/// (C2C stays empty). Pair with `RoutingCache::replace_instance_routes()` to
+/// refresh one instance without rebuilding every table.
+pub async fn load_instance_routing_maps(
+    sqlite_pool: &sqlx::SqlitePool,
+    instance_id: u32,
+) -> Result<RoutingMaps> {
+    let keyspace = KeySpaceConfig::production();
+    let mut maps = RoutingMaps::default();
+
+    load_c2m_routes(sqlite_pool, &keyspace, Some(instance_id), &mut maps.c2m).await?;
+    load_m2c_routes(sqlite_pool, &keyspace, Some(instance_id), &mut maps.m2c).await?;
+
+    debug!(
+        "Instance {} routes loaded: {} C2M, {} M2C",
+        instance_id,
+        maps.c2m.len(),
+        maps.m2c.len()
+    );
+
+    Ok(maps)
+}
+
 /// Load C2M (Channel to Model) routing from measurement_routing table
+///
+/// `instance_id` restricts the load to one instance (`None` = all).
 async fn load_c2m_routes(
     pool: &sqlx::SqlitePool,
     keyspace: &KeySpaceConfig,
+    instance_id: Option<u32>,
     c2m_map: &mut HashMap<String, String>,
 ) -> Result<()> {
     let rows = sqlx::query_as::<_, (u32, String, u32, String, u32, u32)>(
@@ -79,9 +107,11 @@ async fn load_c2m_routes(
         SELECT instance_id, instance_name, channel_id, channel_type, channel_point_id,
                measurement_id
         FROM measurement_routing
-        WHERE enabled = TRUE
+        WHERE enabled = TRUE AND (? IS NULL OR instance_id = ?)
         "#,
     )
+    .bind(instance_id)
+    .bind(instance_id)
     .fetch_all(pool)
     .await?;
 
@@ -111,9 +141,12 @@ async fn load_c2m_routes(
 }
 
 /// Load M2C (Model to Channel) routing from action_routing table
+///
+/// `instance_id` restricts the load to one instance (`None` = all).
 async fn load_m2c_routes(
     pool: &sqlx::SqlitePool,
     keyspace: &KeySpaceConfig,
+    instance_id: Option<u32>,
     m2c_map: &mut HashMap<String, String>,
 ) -> Result<()> {
     let rows = sqlx::query_as::<_, (u32, String, u32, u32, String, u32)>(
@@ -121,9 +154,11 @@ async fn load_m2c_routes(
         SELECT instance_id, instance_name, action_id, channel_id, channel_type,
                channel_point_id
         FROM action_routing
-        WHERE enabled = TRUE
+        WHERE enabled = TRUE AND (? IS NULL OR instance_id = ?)
         "#,
     )
+    .bind(instance_id)
+    .bind(instance_id)
     .fetch_all(pool)
     .await?;
 
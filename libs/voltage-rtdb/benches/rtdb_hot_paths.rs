@@ -0,0 +1,153 @@
+//! RTDB hot-path benchmarks
+//!
+//! Covers the lookups and writes whose latencies are quoted in the module docs:
+//! - RoutingCache C2M lookup (~25ns)
+//! - ChannelVecStore get/set (~1-5ns)
+//! - ChannelToSlotIndex lookup (~50ns)
+//! - Shared memory direct write (~10ns)
+//! - WriteBuffer flush against MemoryRtdb
+//!
+//! Run: `cargo bench -p voltage-rtdb`
+
+#![allow(clippy::disallowed_methods)] // unwrap is fine in benches
+
+use criterion::{criterion_group, criterion_main, BatchSize, BenchmarkId, Criterion, Throughput};
+use std::collections::HashMap;
+use std::hint::black_box;
+use voltage_model::PointType;
+use voltage_rtdb::{
+    ChannelToSlotIndex, ChannelVecStore, MemoryRtdb, RoutingCache, SharedConfig,
+    SharedVecRtdbWriter, WriteBuffer, WriteBufferConfig,
+};
+
+const CHANNEL_ID: u32 = 1001;
+const INSTANCE_ID: u32 = 5;
+const POINTS: u32 = 1000;
+
+/// 1000 telemetry points of channel 1001 routed 1:1 to instance 5 measurements
+fn c2m_routes() -> RoutingCache {
+    let c2m: HashMap<String, String> = (1..=POINTS)
+        .map(|p| {
+            (
+                format!("{}:T:{}", CHANNEL_ID, p),
+                format!("{}:M:{}", INSTANCE_ID, p),
+            )
+        })
+        .collect();
+    RoutingCache::from_maps(c2m, HashMap::new(), HashMap::new())
+}
+
+fn shm_config(name: &str) -> SharedConfig {
+    let path = std::env::temp_dir().join(format!("{}_{}.shm", name, std::process::id()));
+    SharedConfig::default()
+        .with_path(path)
+        .with_max_instances(4)
+        .with_max_points_per_instance(POINTS as usize + 1)
+        .with_max_channels(4)
+        .with_max_points_per_channel(POINTS as usize + 1)
+}
+
+fn bench_routing_cache(c: &mut Criterion) {
+    let cache = c2m_routes();
+    let mut group = c.benchmark_group("routing_cache");
+
+    group.bench_function("lookup_c2m_by_parts_hit", |b| {
+        b.iter(|| {
+            cache.lookup_c2m_by_parts(black_box(CHANNEL_ID), PointType::Telemetry, black_box(500))
+        })
+    });
+    group.bench_function("lookup_c2m_by_parts_miss", |b| {
+        b.iter(|| cache.lookup_c2m_by_parts(black_box(9999), PointType::Telemetry, black_box(500)))
+    });
+    group.finish();
+}
+
+fn bench_channel_vec_store(c: &mut Criterion) {
+    let point_ids: Vec<u32> = (1..=POINTS).collect();
+    let store = ChannelVecStore::new(CHANNEL_ID, 0, &point_ids);
+    let mut group = c.benchmark_group("channel_vec_store");
+
+    group.bench_function("get", |b| b.iter(|| store.get(black_box(500))));
+    group.bench_function("set", |b| {
+        b.iter(|| {
+            store.set(
+                black_box(500),
+                black_box(1.5),
+                1.5,
+                black_box(1_700_000_000_000),
+            )
+        })
+    });
+    group.finish();
+}
+
+fn bench_shared_memory(c: &mut Criterion) {
+    let config = shm_config("voltage_bench_rtdb");
+    let point_ids: Vec<u32> = (1..=POINTS).collect();
+    let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+    writer
+        .register_instance(INSTANCE_ID, &point_ids, &[])
+        .unwrap();
+
+    let cache = c2m_routes();
+    let index = ChannelToSlotIndex::build(&cache, &writer);
+    let slot = index.lookup(CHANNEL_ID, PointType::Telemetry, 500).unwrap();
+
+    let mut group = c.benchmark_group("shared_memory");
+    group.bench_function("channel_to_slot_lookup", |b| {
+        b.iter(|| index.lookup(black_box(CHANNEL_ID), PointType::Telemetry, black_box(500)))
+    });
+    group.bench_function("set_direct", |b| {
+        b.iter(|| writer.set_direct(black_box(slot), black_box(42.0), 1_700_000_000_000))
+    });
+    group.finish();
+
+    std::fs::remove_file(&config.path).ok();
+}
+
+fn bench_write_buffer_flush(c: &mut Criterion) {
+    let rt = tokio::runtime::Builder::new_current_thread()
+        .build()
+        .unwrap();
+    let rtdb = MemoryRtdb::new();
+    let mut group = c.benchmark_group("write_buffer_flush");
+
+    for points in [100usize, 1_000, 10_000] {
+        let batch: Vec<(u32, f64, f64)> = (0..points as u32)
+            .map(|p| (p % POINTS + 1, p as f64 * 0.5, p as f64))
+            .collect();
+        group.throughput(Throughput::Elements(points as u64));
+        group.bench_with_input(
+            BenchmarkId::new("memory_rtdb", points),
+            &batch,
+            |b, batch| {
+                b.iter_batched(
+                    || {
+                        let buffer = WriteBuffer::new(WriteBufferConfig::default());
+                        for (i, chunk) in batch.chunks(POINTS as usize).enumerate() {
+                            buffer.buffer_channel(
+                                CHANNEL_ID + i as u32,
+                                PointType::Telemetry,
+                                chunk,
+                                1_700_000_000_000,
+                            );
+                        }
+                        buffer
+                    },
+                    |buffer| rt.block_on(buffer.flush(&rtdb)).unwrap(),
+                    BatchSize::SmallInput,
+                )
+            },
+        );
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_routing_cache,
+    bench_channel_vec_store,
+    bench_shared_memory,
+    bench_write_buffer_flush
+);
+criterion_main!(benches);
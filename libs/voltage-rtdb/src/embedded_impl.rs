@@ -0,0 +1,475 @@
+//! Embedded in-process RTDB with an optional asynchronous mirror
+//!
+//! Single-process deployments (comsrv and modsrv hosted together) keep the
+//! whole realtime keyspace in a [`MemoryRtdb`]: reads and writes never leave
+//! the process, and TODO queues become in-process wakeups instead of Redis
+//! round trips.
+//!
+//! A mirror (normally a `RedisRtdb`) can be attached so external consumers
+//! (Python services, hissrv) still see channel/instance hashes and history
+//! streams. Mirror writes are queued and applied by a background task; the
+//! caller never waits on them, and a full queue drops the write (counted in
+//! [`MirrorStats`]) rather than stalling the data path. Lists are not
+//! mirrored: TODO queues are consumed in-process.
+
+use crate::memory_impl::MemoryRtdb;
+use crate::traits::*;
+use anyhow::Result;
+use bytes::Bytes;
+use serde::Serialize;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Arc;
+use tokio::sync::mpsc;
+use tokio::sync::mpsc::error::TrySendError;
+
+/// Default capacity of the mirror queue (pending write operations)
+pub const DEFAULT_MIRROR_QUEUE_CAPACITY: usize = 65_536;
+
+/// Operations applied to the mirror per wakeup
+const MIRROR_BATCH: usize = 1024;
+
+/// Write forwarded to the mirror
+enum MirrorOp {
+    Set(String, Bytes),
+    Del(String),
+    Hash(Arc<str>, SharedHashFields),
+    HashDel(String, Vec<String>),
+    SetAdd(String, String),
+    SetRemove(String, String),
+    Stream(Vec<(Arc<str>, SharedHashFields)>, usize),
+}
+
+#[derive(Debug, Default)]
+struct MirrorCounters {
+    queued: AtomicU64,
+    dropped: AtomicU64,
+    applied: AtomicU64,
+    errors: AtomicU64,
+}
+
+/// Mirror queue counters (snapshot)
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct MirrorStats {
+    /// Writes handed to the mirror task
+    pub queued: u64,
+    /// Writes dropped because the queue was full or the task stopped
+    pub dropped: u64,
+    /// Writes applied to the mirror
+    pub applied: u64,
+    /// Mirror write failures
+    pub errors: u64,
+}
+
+/// In-process RTDB for the embedded single-process mode
+pub struct EmbeddedRtdb {
+    store: MemoryRtdb,
+    mirror_tx: Option<mpsc::Sender<MirrorOp>>,
+    counters: Arc<MirrorCounters>,
+}
+
+impl EmbeddedRtdb {
+    /// Create an embedded RTDB without a mirror
+    pub fn new() -> Self {
+        Self {
+            store: MemoryRtdb::new(),
+            mirror_tx: None,
+            counters: Arc::new(MirrorCounters::default()),
+        }
+    }
+
+    /// Create an embedded RTDB that mirrors writes to `mirror`
+    ///
+    /// Spawns the mirror task on the current Tokio runtime; it stops once
+    /// the RTDB is dropped and the queue has drained.
+    pub fn with_mirror<M: Rtdb>(mirror: Arc<M>, queue_capacity: usize) -> Self {
+        let (tx, rx) = mpsc::channel(queue_capacity.max(1));
+        let counters = Arc::new(MirrorCounters::default());
+        tokio::spawn(mirror_loop(mirror, rx, Arc::clone(&counters)));
+        Self {
+            store: MemoryRtdb::new(),
+            mirror_tx: Some(tx),
+            counters,
+        }
+    }
+
+    /// The in-process store
+    pub fn store(&self) -> &MemoryRtdb {
+        &self.store
+    }
+
+    /// Whether writes are mirrored
+    pub fn is_mirrored(&self) -> bool {
+        self.mirror_tx.is_some()
+    }
+
+    /// Mirror queue counters
+    pub fn mirror_stats(&self) -> MirrorStats {
+        MirrorStats {
+            queued: self.counters.queued.load(Ordering::Relaxed),
+            dropped: self.counters.dropped.load(Ordering::Relaxed),
+            applied: self.counters.applied.load(Ordering::Relaxed),
+            errors: self.counters.errors.load(Ordering::Relaxed),
+        }
+    }
+
+    /// Queue a write for the mirror (never blocks)
+    fn mirror(&self, op: impl FnOnce() -> MirrorOp) {
+        let Some(tx) = &self.mirror_tx else {
+            return;
+        };
+        match tx.try_send(op()) {
+            Ok(()) => {
+                self.counters.queued.fetch_add(1, Ordering::Relaxed);
+            },
+            Err(TrySendError::Full(_) | TrySendError::Closed(_)) => {
+                self.counters.dropped.fetch_add(1, Ordering::Relaxed);
+            },
+        }
+    }
+}
+
+impl Default for EmbeddedRtdb {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// Apply queued writes to the mirror
+///
+/// Consecutive hash writes are coalesced into one pipeline; other operations
+/// keep their order relative to them.
+async fn mirror_loop<M: Rtdb>(
+    mirror: Arc<M>,
+    mut rx: mpsc::Receiver<MirrorOp>,
+    counters: Arc<MirrorCounters>,
+) {
+    let mut batch = Vec::with_capacity(MIRROR_BATCH);
+    let mut hashes: Vec<(Arc<str>, SharedHashFields)> = Vec::new();
+
+    while let Some(op) = rx.recv().await {
+        batch.push(op);
+        while batch.len() < MIRROR_BATCH {
+            match rx.try_recv() {
+                Ok(op) => batch.push(op),
+                Err(_) => break,
+            }
+        }
+
+        let count = batch.len() as u64;
+        for op in batch.drain(..) {
+            if let MirrorOp::Hash(key, fields) = op {
+                hashes.push((key, fields));
+                continue;
+            }
+            flush_hashes(mirror.as_ref(), &mut hashes, &counters).await;
+            if let Err(e) = apply(mirror.as_ref(), op).await {
+                counters.errors.fetch_add(1, Ordering::Relaxed);
+                tracing::warn!("RTDB mirror write failed: {}", e);
+            }
+        }
+        flush_hashes(mirror.as_ref(), &mut hashes, &counters).await;
+        counters.applied.fetch_add(count, Ordering::Relaxed);
+    }
+
+    tracing::debug!("RTDB mirror task stopped");
+}
+
+async fn flush_hashes<M: Rtdb>(
+    mirror: &M,
+    hashes: &mut Vec<(Arc<str>, SharedHashFields)>,
+    counters: &MirrorCounters,
+) {
+    if hashes.is_empty() {
+        return;
+    }
+    if let Err(e) = mirror
+        .pipeline_hash_mset_shared(std::mem::take(hashes))
+        .await
+    {
+        counters.errors.fetch_add(1, Ordering::Relaxed);
+        tracing::warn!("RTDB mirror hash pipeline failed: {}", e);
+    }
+}
+
+async fn apply<M: Rtdb>(mirror: &M, op: MirrorOp) -> Result<()> {
+    match op {
+        MirrorOp::Set(key, value) => mirror.set(&key, value).await,
+        MirrorOp::Del(key) => mirror.del(&key).await.map(|_| ()),
+        MirrorOp::Hash(key, fields) => mirror.pipeline_hash_mset_shared(vec![(key, fields)]).await,
+        MirrorOp::HashDel(key, fields) => mirror.hash_del_many(&key, &fields).await.map(|_| ()),
+        MirrorOp::SetAdd(key, member) => mirror.sadd(&key, &member).await.map(|_| ()),
+        MirrorOp::SetRemove(key, member) => mirror.srem(&key, &member).await.map(|_| ()),
+        MirrorOp::Stream(entries, max_len) => mirror.pipeline_stream_add(entries, max_len).await,
+    }
+}
+
+/// Shared-field form of one hash write
+fn hash_op(key: &str, fields: impl IntoIterator<Item = (String, Bytes)>) -> MirrorOp {
+    MirrorOp::Hash(
+        Arc::from(key),
+        fields
+            .into_iter()
+            .map(|(field, value)| (Arc::from(field), value))
+            .collect(),
+    )
+}
+
+impl Rtdb for EmbeddedRtdb {
+    fn as_any(&self) -> &dyn std::any::Any {
+        self
+    }
+
+    async fn get<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
+        self.store.get(key).await
+    }
+
+    async fn set<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
+        self.mirror(|| MirrorOp::Set(key.to_string(), value.clone()));
+        self.store.set(key, value).await
+    }
+
+    async fn del<'a>(&'a self, key: &'a str) -> Result<bool> {
+        self.mirror(|| MirrorOp::Del(key.to_string()));
+        self.store.del(key).await
+    }
+
+    async fn mset(&self, entries: Vec<(String, Bytes)>) -> Result<()> {
+        for (key, value) in &entries {
+            self.mirror(|| MirrorOp::Set(key.clone(), value.clone()));
+        }
+        self.store.mset(entries).await
+    }
+
+    async fn exists<'a>(&'a self, key: &'a str) -> Result<bool> {
+        self.store.exists(key).await
+    }
+
+    async fn incrbyfloat<'a>(&'a self, key: &'a str, increment: f64) -> Result<f64> {
+        let value = self.store.incrbyfloat(key, increment).await?;
+        self.mirror(|| MirrorOp::Set(key.to_string(), Bytes::from(value.to_string())));
+        Ok(value)
+    }
+
+    async fn hash_set<'a>(&'a self, key: &'a str, field: &'a str, value: Bytes) -> Result<()> {
+        self.mirror(|| hash_op(key, [(field.to_string(), value.clone())]));
+        self.store.hash_set(key, field, value).await
+    }
+
+    async fn hash_get<'a>(&'a self, key: &'a str, field: &'a str) -> Result<Option<Bytes>> {
+        self.store.hash_get(key, field).await
+    }
+
+    async fn hash_mget<'a>(
+        &'a self,
+        key: &'a str,
+        fields: &'a [&'a str],
+    ) -> Result<Vec<Option<Bytes>>> {
+        self.store.hash_mget(key, fields).await
+    }
+
+    async fn hash_mset<'a>(&'a self, key: &'a str, fields: Vec<(String, Bytes)>) -> Result<()> {
+        self.mirror(|| hash_op(key, fields.iter().cloned()));
+        self.store.hash_mset(key, fields).await
+    }
+
+    async fn hash_get_all<'a>(&'a self, key: &'a str) -> Result<HashMap<String, Bytes>> {
+        self.store.hash_get_all(key).await
+    }
+
+    async fn hash_del<'a>(&'a self, key: &'a str, field: &'a str) -> Result<bool> {
+        self.mirror(|| MirrorOp::HashDel(key.to_string(), vec![field.to_string()]));
+        self.store.hash_del(key, field).await
+    }
+
+    async fn hash_del_many<'a>(&'a self, key: &'a str, fields: &'a [String]) -> Result<usize> {
+        self.mirror(|| MirrorOp::HashDel(key.to_string(), fields.to_vec()));
+        self.store.hash_del_many(key, fields).await
+    }
+
+    async fn hincrby<'a>(&'a self, key: &'a str, field: &'a str, increment: i64) -> Result<i64> {
+        let value = self.store.hincrby(key, field, increment).await?;
+        self.mirror(|| hash_op(key, [(field.to_string(), Bytes::from(value.to_string()))]));
+        Ok(value)
+    }
+
+    async fn list_lpush<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
+        self.store.list_lpush(key, value).await
+    }
+
+    async fn list_rpush<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
+        self.store.list_rpush(key, value).await
+    }
+
+    async fn list_lpop<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
+        self.store.list_lpop(key).await
+    }
+
+    async fn list_rpop<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
+        self.store.list_rpop(key).await
+    }
+
+    async fn list_blpop<'a>(
+        &'a self,
+        keys: &'a [&'a str],
+        timeout_seconds: u64,
+    ) -> Result<Option<(String, Bytes)>> {
+        self.store.list_blpop(keys, timeout_seconds).await
+    }
+
+    async fn list_range<'a>(
+        &'a self,
+        key: &'a str,
+        start: isize,
+        stop: isize,
+    ) -> Result<Vec<Bytes>> {
+        self.store.list_range(key, start, stop).await
+    }
+
+    async fn list_trim<'a>(&'a self, key: &'a str, start: isize, stop: isize) -> Result<()> {
+        self.store.list_trim(key, start, stop).await
+    }
+
+    async fn sadd<'a>(&'a self, key: &'a str, member: &'a str) -> Result<bool> {
+        self.mirror(|| MirrorOp::SetAdd(key.to_string(), member.to_string()));
+        self.store.sadd(key, member).await
+    }
+
+    async fn srem<'a>(&'a self, key: &'a str, member: &'a str) -> Result<bool> {
+        self.mirror(|| MirrorOp::SetRemove(key.to_string(), member.to_string()));
+        self.store.srem(key, member).await
+    }
+
+    async fn smembers<'a>(&'a self, key: &'a str) -> Result<Vec<String>> {
+        self.store.smembers(key).await
+    }
+
+    async fn scan_match<'a>(&'a self, pattern: &'a str) -> Result<Vec<String>> {
+        self.store.scan_match(pattern).await
+    }
+
+    #[allow(deprecated)]
+    async fn time_millis(&self) -> Result<i64> {
+        self.store.time_millis().await
+    }
+
+    async fn pipeline_hash_mset(
+        &self,
+        operations: Vec<(String, Vec<(String, Bytes)>)>,
+    ) -> Result<()> {
+        for (key, fields) in &operations {
+            self.mirror(|| hash_op(key, fields.iter().cloned()));
+        }
+        self.store.pipeline_hash_mset(operations).await
+    }
+
+    async fn pipeline_hash_mset_shared(
+        &self,
+        operations: Vec<(Arc<str>, SharedHashFields)>,
+    ) -> Result<()> {
+        for (key, fields) in &operations {
+            self.mirror(|| MirrorOp::Hash(Arc::clone(key), fields.clone()));
+        }
+        self.store.pipeline_hash_mset_shared(operations).await
+    }
+
+    async fn pipeline_stream_add(
+        &self,
+        entries: Vec<(Arc<str>, SharedHashFields)>,
+        max_len: usize,
+    ) -> Result<()> {
+        self.mirror(|| MirrorOp::Stream(entries.clone(), max_len));
+        self.store.pipeline_stream_add(entries, max_len).await
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+    use std::time::Duration;
+
+    async fn wait_applied(rtdb: &EmbeddedRtdb, applied: u64) {
+        for _ in 0..200 {
+            if rtdb.mirror_stats().applied >= applied {
+                return;
+            }
+            tokio::time::sleep(Duration::from_millis(5)).await;
+        }
+        panic!("mirror did not catch up: {:?}", rtdb.mirror_stats());
+    }
+
+    #[tokio::test]
+    async fn test_embedded_without_mirror() {
+        let rtdb = EmbeddedRtdb::new();
+        assert!(!rtdb.is_mirrored());
+
+        rtdb.hash_set("comsrv:1:T", "1", Bytes::from("1.5"))
+            .await
+            .unwrap();
+        assert_eq!(
+            rtdb.hash_get("comsrv:1:T", "1").await.unwrap(),
+            Some(Bytes::from("1.5"))
+        );
+        assert_eq!(rtdb.mirror_stats(), MirrorStats::default());
+    }
+
+    #[tokio::test]
+    async fn test_embedded_mirrors_writes_but_not_queues() {
+        let mirror = Arc::new(MemoryRtdb::new());
+        let rtdb = EmbeddedRtdb::with_mirror(Arc::clone(&mirror), 64);
+
+        rtdb.pipeline_hash_mset_shared(vec![(
+            Arc::from("inst:1:M"),
+            vec![(Arc::from("1"), Bytes::from("10"))],
+        )])
+        .await
+        .unwrap();
+        rtdb.hash_set("inst:1:M", "2", Bytes::from("20"))
+            .await
+            .unwrap();
+        rtdb.hash_del("inst:1:M", "2").await.unwrap();
+        rtdb.hincrby("rule:1:exec", "count", 3).await.unwrap();
+        rtdb.enqueue_control(1, "{}").await.unwrap();
+
+        wait_applied(&rtdb, 4).await;
+        assert_eq!(
+            mirror.hash_get("inst:1:M", "1").await.unwrap(),
+            Some(Bytes::from("10"))
+        );
+        assert_eq!(mirror.hash_get("inst:1:M", "2").await.unwrap(), None);
+        assert_eq!(
+            mirror.hash_get("rule:1:exec", "count").await.unwrap(),
+            Some(Bytes::from("3"))
+        );
+
+        // TODO queues stay in-process
+        assert!(mirror
+            .list_range("comsrv:1:C:TODO", 0, -1)
+            .await
+            .unwrap()
+            .is_empty());
+        assert_eq!(
+            rtdb.list_range("comsrv:1:C:TODO", 0, -1)
+                .await
+                .unwrap()
+                .len(),
+            1
+        );
+    }
+
+    #[tokio::test(flavor = "current_thread")]
+    async fn test_embedded_mirror_drops_when_full() {
+        let mirror = Arc::new(MemoryRtdb::new());
+        let rtdb = EmbeddedRtdb::with_mirror(mirror, 2);
+
+        // The mirror task cannot run until this task yields
+        for i in 0..5 {
+            rtdb.set("k", Bytes::from(i.to_string())).await.unwrap();
+        }
+        let stats = rtdb.mirror_stats();
+        assert_eq!(stats.queued, 2);
+        assert_eq!(stats.dropped, 3);
+        assert_eq!(rtdb.get("k").await.unwrap(), Some(Bytes::from("4")));
+    }
+}
@@ -16,10 +16,16 @@ pub mod redis_impl;
 
 pub mod memory_impl;
 
+pub mod embedded_impl;
+
 pub mod vec_impl;
 
 pub mod shared_impl;
 
+pub mod shared_snapshot;
+
+pub mod shared_batch;
+
 pub mod error;
 
 pub mod cleanup;
@@ -32,12 +38,17 @@ pub mod routing_cache;
 
 pub mod numfmt;
 
+pub mod metrics;
+
 // Re-exports
 pub use bytes::Bytes;
-pub use traits::Rtdb;
+pub use traits::{Rtdb, SharedHashFields};
 
 // KeySpace (canonical location: voltage_model) and Routing exports
-pub use routing_cache::{C2CTarget, C2MTarget, M2CTarget, RoutingCache, RoutingCacheStats};
+pub use routing_cache::{
+    C2CTarget, C2MTarget, M2CTarget, RouteEdit, RoutingCache, RoutingCacheStats,
+    MAX_C2C_CASCADE_DEPTH,
+};
 pub use voltage_model::KeySpaceConfig;
 
 #[cfg(feature = "redis-backend")]
@@ -45,15 +56,30 @@ pub use redis_impl::RedisRtdb;
 
 pub use memory_impl::{MemoryRtdb, MemoryStats};
 
+pub use embedded_impl::{EmbeddedRtdb, MirrorStats, DEFAULT_MIRROR_QUEUE_CAPACITY};
+
 // VecRtdb removed from public API - using SharedMemory + Redis two-tier architecture
 // PointSlot and ChannelVecStore are still used internally by SharedMemory
-pub use vec_impl::{instance_point_type, ChannelVecStore, PointSlot};
+pub use vec_impl::{instance_point_type, ChannelVecStore, PointSlot, PointSnapshot};
 
 // Shared memory exports (123, 145)
+pub use shared_batch::{BatchReadTarget, PointColumns, BATCH_CONTENT_TYPE};
 pub use shared_impl::{
-    default_shm_path, is_shm_available, try_open_reader, ChannelIndex, ChannelToSlotIndex,
+    default_shm_path, is_shm_available, restore_snapshot_into, try_open_reader, ChangeCursor,
+    ChangeEvent, ChannelIndex, ChannelToSlotIndex, HistorySample, RingCommand, SharedCommandSender,
     SharedConfig, SharedHeader, SharedReaderStats, SharedVecRtdbReader, SharedVecRtdbWriter,
-    SharedWriterStats, SHARED_MAGIC,
+    SharedWriterStats, COMMAND_STALL_TIMEOUT_MS, DEFAULT_CHANGE_RING_CAPACITY,
+    DEFAULT_COMMAND_RING_CAPACITY, DEFAULT_HISTORY_CAPACITY, MAX_HISTORY_DEPTH,
+    SHARED_LAYOUT_VERSION, SHARED_MAGIC,
+};
+pub use shared_snapshot::{
+    default_snapshot_path, point_quality, RtdbSnapshot, SnapshotArea, SnapshotRecord,
+    DEFAULT_SNAPSHOT_INTERVAL_SECS,
+};
+
+pub use metrics::{
+    HistogramSnapshot, LatencyHistogram, MetricKind, PrometheusText, LATENCY_BUCKETS_US,
+    PROMETHEUS_CONTENT_TYPE,
 };
 
 pub use cleanup::{cleanup_invalid_keys, CleanupProvider};
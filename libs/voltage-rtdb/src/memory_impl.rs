@@ -13,6 +13,7 @@ use std::collections::{HashMap, VecDeque};
 use std::future::Future;
 use std::sync::Arc;
 use std::time::{SystemTime, UNIX_EPOCH};
+use tokio::sync::Notify;
 
 /// In-memory RTDB implementation with concurrent access support
 ///
@@ -23,6 +24,9 @@ pub struct MemoryRtdb {
     hash_store: Arc<DashMap<String, DashMap<String, Bytes>>>,
     list_store: Arc<DashMap<String, RwLock<VecDeque<Bytes>>>>,
     set_store: Arc<DashMap<String, DashSet<String>>>,
+    stream_store: Arc<DashMap<String, RwLock<VecDeque<SharedHashFields>>>>,
+    /// Wakes `list_blpop` waiters on every push (in-process TODO queues)
+    list_pushed: Arc<Notify>,
 }
 
 impl MemoryRtdb {
@@ -33,6 +37,8 @@ impl MemoryRtdb {
             hash_store: Arc::new(DashMap::new()),
             list_store: Arc::new(DashMap::new()),
             set_store: Arc::new(DashMap::new()),
+            stream_store: Arc::new(DashMap::new()),
+            list_pushed: Arc::new(Notify::new()),
         }
     }
 
@@ -42,6 +48,15 @@ impl MemoryRtdb {
         self.hash_store.clear();
         self.list_store.clear();
         self.set_store.clear();
+        self.stream_store.clear();
+    }
+
+    /// Entries of a stream written by `pipeline_stream_add`, oldest first
+    pub fn stream_entries(&self, key: &str) -> Vec<SharedHashFields> {
+        self.stream_store
+            .get(key)
+            .map(|stream| stream.read().iter().cloned().collect())
+            .unwrap_or_default()
     }
 
     /// Get statistics about stored data
@@ -86,6 +101,13 @@ impl Rtdb for MemoryRtdb {
         async move { Ok(result) }
     }
 
+    fn mset(&self, entries: Vec<(String, Bytes)>) -> impl Future<Output = Result<()>> + Send + '_ {
+        for (key, value) in entries {
+            self.kv_store.insert(key, value);
+        }
+        async move { Ok(()) }
+    }
+
     fn exists(&self, key: &str) -> impl Future<Output = Result<bool>> + Send + '_ {
         let result = self.kv_store.contains_key(key);
         async move { Ok(result) }
@@ -242,6 +264,7 @@ impl Rtdb for MemoryRtdb {
             .or_insert_with(|| RwLock::new(VecDeque::new()))
             .write()
             .push_front(value);
+        self.list_pushed.notify_waiters();
         async move { Ok(()) }
     }
 
@@ -251,6 +274,7 @@ impl Rtdb for MemoryRtdb {
             .or_insert_with(|| RwLock::new(VecDeque::new()))
             .write()
             .push_back(value);
+        self.list_pushed.notify_waiters();
         async move { Ok(()) }
     }
 
@@ -277,16 +301,22 @@ impl Rtdb for MemoryRtdb {
     ) -> impl Future<Output = Result<Option<(String, Bytes)>>> + Send + '_ {
         // For blocking pop, we need to clone the list_store reference
         let list_store = self.list_store.clone();
+        let list_pushed = Arc::clone(&self.list_pushed);
         let keys: Vec<String> = keys.iter().copied().map(String::from).collect();
 
         async move {
-            use tokio::time::{sleep, Duration, Instant};
+            use tokio::time::{timeout_at, Duration, Instant};
 
-            let start = Instant::now();
-            let timeout = Duration::from_secs(timeout_seconds);
+            let deadline = Instant::now() + Duration::from_secs(timeout_seconds);
 
-            // Poll keys until timeout or data found
+            // Sleep on push notifications instead of polling, so an
+            // in-process producer wakes the waiter immediately
             loop {
+                // Register before checking so a push in between is not missed
+                let pushed = list_pushed.notified();
+                tokio::pin!(pushed);
+                pushed.as_mut().enable();
+
                 // Try to pop from each key in order
                 for key in &keys {
                     if let Some(list) = list_store.get(key) {
@@ -297,13 +327,9 @@ impl Rtdb for MemoryRtdb {
                     }
                 }
 
-                // Check timeout
-                if start.elapsed() >= timeout {
+                if timeout_at(deadline, pushed).await.is_err() {
                     return Ok(None);
                 }
-
-                // Sleep briefly before next poll (10ms)
-                sleep(Duration::from_millis(10)).await;
             }
         }
     }
@@ -529,6 +555,25 @@ impl Rtdb for MemoryRtdb {
         }
         async move { Ok(()) }
     }
+
+    fn pipeline_stream_add(
+        &self,
+        entries: Vec<(Arc<str>, SharedHashFields)>,
+        max_len: usize,
+    ) -> impl Future<Output = Result<()>> + Send + '_ {
+        for (key, fields) in entries {
+            let stream = self
+                .stream_store
+                .entry(key.to_string())
+                .or_insert_with(|| RwLock::new(VecDeque::new()));
+            let mut stream = stream.write();
+            stream.push_back(fields);
+            while stream.len() > max_len {
+                stream.pop_front();
+            }
+        }
+        async move { Ok(()) }
+    }
 }
 
 #[cfg(test)]
@@ -1168,6 +1213,38 @@ mod tests {
         );
     }
 
+    #[tokio::test]
+    async fn test_blpop_wakes_on_push() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+
+        let waiter = {
+            let rtdb = Arc::clone(&rtdb);
+            tokio::spawn(async move {
+                let started = std::time::Instant::now();
+                let popped = rtdb
+                    .list_blpop(&["comsrv:1:C:TODO", "comsrv:1:A:TODO"], 5)
+                    .await
+                    .unwrap();
+                (popped, started.elapsed())
+            })
+        };
+        tokio::time::sleep(std::time::Duration::from_millis(20)).await;
+        rtdb.enqueue_adjustment(1, "{}").await.unwrap();
+
+        let (popped, waited) = waiter.await.unwrap();
+        assert_eq!(
+            popped,
+            Some(("comsrv:1:A:TODO".to_string(), Bytes::from("{}")))
+        );
+        assert!(waited < std::time::Duration::from_secs(5));
+
+        // Empty queues time out
+        assert_eq!(
+            rtdb.list_blpop(&["comsrv:1:C:TODO"], 0).await.unwrap(),
+            None
+        );
+    }
+
     // ========== Dual-Mode Write Tests (Init vs Runtime) ==========
 
     #[tokio::test]
@@ -0,0 +1,297 @@
+//! Lock-free latency histograms and Prometheus text exposition
+//!
+//! `LatencyHistogram` is a fixed-bucket histogram of atomic counters:
+//! `record` is a bucket search plus three relaxed `fetch_add`s, cheap
+//! enough for poll loops, buffer flushes and the command path. Services
+//! snapshot the histograms on scrape and render them with
+//! [`PrometheusText`] for their `/metrics` endpoint.
+
+use std::fmt::Write as _;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Duration;
+
+/// Upper bucket bounds in microseconds (50µs … 10s); one overflow bucket follows
+pub const LATENCY_BUCKETS_US: [u64; 17] = [
+    50, 100, 250, 500, 1_000, 2_500, 5_000, 10_000, 25_000, 50_000, 100_000, 250_000, 500_000,
+    1_000_000, 2_500_000, 5_000_000, 10_000_000,
+];
+
+/// Content type of the Prometheus text exposition format
+pub const PROMETHEUS_CONTENT_TYPE: &str = "text/plain; version=0.0.4; charset=utf-8";
+
+/// Lock-free latency histogram over `LATENCY_BUCKETS_US`
+#[derive(Debug, Default)]
+pub struct LatencyHistogram {
+    buckets: [AtomicU64; LATENCY_BUCKETS_US.len() + 1],
+    sum_us: AtomicU64,
+    max_us: AtomicU64,
+}
+
+impl LatencyHistogram {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Record one observation
+    #[inline]
+    pub fn record(&self, elapsed: Duration) {
+        self.record_us(elapsed.as_micros() as u64);
+    }
+
+    /// Record one observation in microseconds
+    #[inline]
+    pub fn record_us(&self, us: u64) {
+        let bucket = LATENCY_BUCKETS_US.partition_point(|&bound| bound < us);
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+        self.sum_us.fetch_add(us, Ordering::Relaxed);
+        self.max_us.fetch_max(us, Ordering::Relaxed);
+    }
+
+    /// Copy the current counters
+    ///
+    /// Buckets are read one by one while writers keep recording, so the
+    /// count is derived from the buckets to stay self-consistent.
+    pub fn snapshot(&self) -> HistogramSnapshot {
+        let buckets: Vec<u64> = self
+            .buckets
+            .iter()
+            .map(|bucket| bucket.load(Ordering::Relaxed))
+            .collect();
+        HistogramSnapshot {
+            bounds_us: &LATENCY_BUCKETS_US,
+            count: buckets.iter().sum(),
+            buckets,
+            sum_us: self.sum_us.load(Ordering::Relaxed),
+            max_us: self.max_us.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Point-in-time copy of a histogram
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct HistogramSnapshot {
+    /// Upper bucket bounds in microseconds
+    pub bounds_us: &'static [u64],
+    /// Counts per bucket (`bounds_us.len() + 1` entries, last is overflow)
+    pub buckets: Vec<u64>,
+    pub count: u64,
+    pub sum_us: u64,
+    pub max_us: u64,
+}
+
+impl HistogramSnapshot {
+    /// Build from externally kept bucket counts (e.g. rule execution times)
+    pub fn from_buckets(
+        bounds_us: &'static [u64],
+        buckets: &[u64],
+        sum_us: u64,
+        max_us: u64,
+    ) -> Self {
+        Self {
+            bounds_us,
+            count: buckets.iter().sum(),
+            buckets: buckets.to_vec(),
+            sum_us,
+            max_us,
+        }
+    }
+
+    /// Upper bound (µs) of the bucket holding quantile `q` (0.0..=1.0)
+    ///
+    /// Observations in the overflow bucket report `max_us`; 0 when empty.
+    pub fn quantile_us(&self, q: f64) -> u64 {
+        if self.count == 0 {
+            return 0;
+        }
+        let rank = ((q.clamp(0.0, 1.0) * self.count as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (i, &n) in self.buckets.iter().enumerate() {
+            seen += n;
+            if seen >= rank {
+                return self.bounds_us.get(i).copied().unwrap_or(self.max_us);
+            }
+        }
+        self.max_us
+    }
+}
+
+/// Prometheus metric type
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MetricKind {
+    Counter,
+    Gauge,
+    Histogram,
+}
+
+impl MetricKind {
+    fn as_str(self) -> &'static str {
+        match self {
+            MetricKind::Counter => "counter",
+            MetricKind::Gauge => "gauge",
+            MetricKind::Histogram => "histogram",
+        }
+    }
+}
+
+/// Prometheus text exposition (format 0.0.4) builder
+///
+/// Call [`family`](Self::family) once per metric name, then add all of its
+/// samples before starting the next family.
+///
+/// ```ignore
+/// let mut text = PrometheusText::new();
+/// text.family("comsrv_poll_duration_seconds", MetricKind::Histogram, "Poll cycle duration");
+/// text.histogram("comsrv_poll_duration_seconds", &[("channel", "1001")], &snapshot);
+/// let body = text.finish();
+/// ```
+#[derive(Debug, Default)]
+pub struct PrometheusText {
+    out: String,
+}
+
+impl PrometheusText {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Start a metric family (HELP and TYPE lines)
+    pub fn family(&mut self, name: &str, kind: MetricKind, help: &str) -> &mut Self {
+        let help = help.replace('\\', "\\\\").replace('\n', "\\n");
+        let _ = writeln!(self.out, "# HELP {} {}", name, help);
+        let _ = writeln!(self.out, "# TYPE {} {}", name, kind.as_str());
+        self
+    }
+
+    /// Add a counter or gauge sample
+    pub fn sample(&mut self, name: &str, labels: &[(&str, &str)], value: f64) -> &mut Self {
+        self.out.push_str(name);
+        self.write_labels(labels, None);
+        let _ = writeln!(self.out, " {}", format_value(value));
+        self
+    }
+
+    /// Add a histogram (`_bucket`, `_sum`, `_count`; durations in seconds)
+    pub fn histogram(
+        &mut self,
+        name: &str,
+        labels: &[(&str, &str)],
+        snapshot: &HistogramSnapshot,
+    ) -> &mut Self {
+        let mut cumulative = 0;
+        for (i, &n) in snapshot.buckets.iter().enumerate() {
+            cumulative += n;
+            let le = match snapshot.bounds_us.get(i) {
+                Some(&bound_us) => format_value(bound_us as f64 / 1e6),
+                None => "+Inf".to_string(),
+            };
+            let _ = write!(self.out, "{}_bucket", name);
+            self.write_labels(labels, Some(&le));
+            let _ = writeln!(self.out, " {}", cumulative);
+        }
+        let _ = write!(self.out, "{}_sum", name);
+        self.write_labels(labels, None);
+        let _ = writeln!(self.out, " {}", format_value(snapshot.sum_us as f64 / 1e6));
+        let _ = write!(self.out, "{}_count", name);
+        self.write_labels(labels, None);
+        let _ = writeln!(self.out, " {}", cumulative);
+        self
+    }
+
+    /// Finish and return the exposition body
+    pub fn finish(self) -> String {
+        self.out
+    }
+
+    fn write_labels(&mut self, labels: &[(&str, &str)], le: Option<&str>) {
+        if labels.is_empty() && le.is_none() {
+            return;
+        }
+        self.out.push('{');
+        let le = le.map(|le| ("le", le));
+        for (i, (key, value)) in labels.iter().copied().chain(le).enumerate() {
+            if i > 0 {
+                self.out.push(',');
+            }
+            let _ = write!(self.out, "{}=\"", key);
+            for c in value.chars() {
+                match c {
+                    '\\' => self.out.push_str("\\\\"),
+                    '"' => self.out.push_str("\\\""),
+                    '\n' => self.out.push_str("\\n"),
+                    c => self.out.push(c),
+                }
+            }
+            self.out.push('"');
+        }
+        self.out.push('}');
+    }
+}
+
+/// Format a sample value (integers without a fraction, NaN/Inf as Prometheus spells them)
+fn format_value(value: f64) -> String {
+    if value.is_nan() {
+        "NaN".to_string()
+    } else if value.is_infinite() {
+        if value > 0.0 { "+Inf" } else { "-Inf" }.to_string()
+    } else {
+        value.to_string()
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_histogram_buckets_and_quantiles() {
+        let histogram = LatencyHistogram::new();
+        for _ in 0..98 {
+            histogram.record_us(80); // ≤ 100µs
+        }
+        histogram.record(Duration::from_millis(20)); // ≤ 25ms
+        histogram.record(Duration::from_secs(30)); // overflow
+
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.count, 100);
+        assert_eq!(snapshot.buckets[1], 98);
+        assert_eq!(snapshot.buckets[8], 1);
+        assert_eq!(snapshot.buckets[LATENCY_BUCKETS_US.len()], 1);
+        assert_eq!(snapshot.max_us, 30_000_000);
+
+        assert_eq!(snapshot.quantile_us(0.5), 100);
+        assert_eq!(snapshot.quantile_us(0.99), 25_000);
+        assert_eq!(snapshot.quantile_us(1.0), 30_000_000);
+
+        // Bounds are inclusive
+        let histogram = LatencyHistogram::new();
+        histogram.record_us(50);
+        histogram.record_us(51);
+        let snapshot = histogram.snapshot();
+        assert_eq!(snapshot.buckets[0], 1);
+        assert_eq!(snapshot.buckets[1], 1);
+    }
+
+    #[test]
+    fn test_prometheus_text_format() {
+        let histogram = LatencyHistogram::new();
+        histogram.record_us(40);
+        histogram.record_us(2_000);
+
+        let mut text = PrometheusText::new();
+        text.family("poll_overruns_total", MetricKind::Counter, "Overruns");
+        text.sample("poll_overruns_total", &[("channel", "1\"x")], 3.0);
+        text.family("poll_seconds", MetricKind::Histogram, "Poll duration");
+        text.histogram("poll_seconds", &[("channel", "1")], &histogram.snapshot());
+        let body = text.finish();
+
+        assert!(body.contains("# TYPE poll_overruns_total counter\n"));
+        assert!(body.contains("poll_overruns_total{channel=\"1\\\"x\"} 3\n"));
+        assert!(body.contains("poll_seconds_bucket{channel=\"1\",le=\"0.00005\"} 1\n"));
+        assert!(body.contains("poll_seconds_bucket{channel=\"1\",le=\"0.001\"} 1\n"));
+        assert!(body.contains("poll_seconds_bucket{channel=\"1\",le=\"0.0025\"} 2\n"));
+        assert!(body.contains("poll_seconds_bucket{channel=\"1\",le=\"+Inf\"} 2\n"));
+        assert!(body.contains("poll_seconds_sum{channel=\"1\"} 0.00204\n"));
+        assert!(body.contains("poll_seconds_count{channel=\"1\"} 2\n"));
+    }
+}
@@ -1,40 +1,125 @@
 //! Redis implementation of RTDB traits
+//!
+//! A `RedisRtdb` talks to one Redis server, or to several shards with one
+//! connection pool each. Keys are routed by [`KeySpaceConfig::shard_of`]
+//! (channel keys by channel_id, instance keys by instance_id, global keys to
+//! shard 0); batched writes are split per shard and pipelined in parallel.
 
 use crate::traits::*;
 use anyhow::{Context, Result};
 use bytes::Bytes;
+use futures::future::try_join_all;
 use std::collections::HashMap;
 use std::sync::Arc;
+use std::time::{Duration, Instant};
 use voltage_infra::redis::RedisClient;
+use voltage_model::KeySpaceConfig;
+
+/// Poll interval of a BLPOP whose keys live on different shards
+const CROSS_SHARD_POLL_INTERVAL: Duration = Duration::from_millis(5);
 
 /// Redis-backed RTDB implementation
 ///
 /// This is a pure storage abstraction. For routing logic, use the
 /// `voltage-routing` library which handles M2C routing externally.
 pub struct RedisRtdb {
+    /// Shard 0 (global keys, server time)
     client: Arc<RedisClient>,
+    /// All shards, `shards[0]` is `client`
+    shards: Vec<Arc<RedisClient>>,
 }
 
 impl RedisRtdb {
     /// Create new Redis RTDB from URL
     pub async fn new(url: &str) -> Result<Self> {
-        Ok(Self {
-            client: Arc::new(RedisClient::new(url).await?),
-        })
+        Ok(Self::from_client(Arc::new(RedisClient::new(url).await?)))
     }
 
     /// Create from existing RedisClient
     pub fn from_client(client: Arc<RedisClient>) -> Self {
-        Self { client }
+        Self {
+            shards: vec![Arc::clone(&client)],
+            client,
+        }
+    }
+
+    /// Create a sharded RTDB, one client (connection pool) per shard
+    ///
+    /// `clients[0]` also holds the global keys. Every process that touches
+    /// the keyspace must use the same shard list in the same order.
+    pub fn from_shards(clients: Vec<Arc<RedisClient>>) -> Result<Self> {
+        let client = clients
+            .first()
+            .cloned()
+            .context("sharded RTDB needs at least one Redis client")?;
+        Ok(Self {
+            client,
+            shards: clients,
+        })
     }
 
     /// Get reference to underlying Redis client
     ///
     /// This is useful for calling Redis commands directly
-    /// that are not part of the Rtdb trait.
+    /// that are not part of the Rtdb trait. With several shards this is
+    /// shard 0; use [`client_for`](Self::client_for) for entity keys.
     pub fn client(&self) -> &Arc<RedisClient> {
         &self.client
     }
+
+    /// Client of the shard that holds `key`
+    #[inline]
+    pub fn client_for(&self, key: &str) -> &Arc<RedisClient> {
+        &self.shards[self.shard_index(key)]
+    }
+
+    #[inline]
+    fn shard_index(&self, key: &str) -> usize {
+        KeySpaceConfig::production_cached().shard_of(key, self.shards.len())
+    }
+
+    /// Group batch entries by shard, dropping empty groups
+    fn split_by_shard<T>(&self, items: Vec<T>, key: impl Fn(&T) -> &str) -> Vec<(usize, Vec<T>)> {
+        let mut groups: Vec<Vec<T>> = (0..self.shards.len()).map(|_| Vec::new()).collect();
+        for item in items {
+            let shard = self.shard_index(key(&item));
+            groups[shard].push(item);
+        }
+        groups
+            .into_iter()
+            .enumerate()
+            .filter(|(_, items)| !items.is_empty())
+            .collect()
+    }
+
+    /// BLPOP over keys on several shards
+    ///
+    /// A blocking pop per shard cannot be cancelled without losing the value
+    /// it may already have popped, so sweep with LPOP until the timeout.
+    async fn cross_shard_blpop(
+        &self,
+        keys: &[&str],
+        timeout_seconds: u64,
+    ) -> Result<Option<(String, Bytes)>> {
+        let deadline =
+            (timeout_seconds > 0).then(|| Instant::now() + Duration::from_secs(timeout_seconds));
+        loop {
+            for key in keys {
+                let value: Option<String> = self
+                    .client_for(key)
+                    .lpop(key)
+                    .await
+                    .map_err(|e| anyhow::anyhow!(e))?;
+                if let Some(value) = value {
+                    return Ok(Some((key.to_string(), Bytes::from(value))));
+                }
+            }
+            if deadline.is_some_and(|deadline| Instant::now() >= deadline) {
+                return Ok(None);
+            }
+            tokio::time::sleep(CROSS_SHARD_POLL_INTERVAL).await;
+        }
+    }
 }
 
 impl Rtdb for RedisRtdb {
@@ -42,22 +127,42 @@ impl Rtdb for RedisRtdb {
         self
     }
 
+    fn shard_count(&self) -> usize {
+        self.shards.len()
+    }
+
     async fn get<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
-        let value: Option<String> = self.client.get(key).await.map_err(|e| anyhow::anyhow!(e))?;
+        let value: Option<String> = self
+            .client_for(key)
+            .get(key)
+            .await
+            .map_err(|e| anyhow::anyhow!(e))?;
         Ok(value.map(Bytes::from))
     }
 
     async fn set<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
         let s = std::str::from_utf8(value.as_ref())?;
-        self.client
+        self.client_for(key)
             .set(key, s)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
+    async fn mset(&self, entries: Vec<(String, Bytes)>) -> Result<()> {
+        let groups = self.split_by_shard(entries, |(key, _)| key.as_str());
+        try_join_all(groups.into_iter().map(|(shard, entries)| async move {
+            self.shards[shard]
+                .mset_bytes(&entries)
+                .await
+                .map_err(|e| anyhow::anyhow!(e))
+        }))
+        .await
+        .map(|_| ())
+    }
+
     async fn del<'a>(&'a self, key: &'a str) -> Result<bool> {
         let count = self
-            .client
+            .client_for(key)
             .del(&[key])
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -65,14 +170,14 @@ impl Rtdb for RedisRtdb {
     }
 
     async fn exists<'a>(&'a self, key: &'a str) -> Result<bool> {
-        self.client
+        self.client_for(key)
             .exists(key)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn incrbyfloat<'a>(&'a self, key: &'a str, increment: f64) -> Result<f64> {
-        self.client
+        self.client_for(key)
             .incrbyfloat(key, increment)
             .await
             .map_err(|e| anyhow::anyhow!(e))
@@ -82,7 +187,7 @@ impl Rtdb for RedisRtdb {
         let s = std::str::from_utf8(value.as_ref())
             .context("UTF-8 conversion failed")?
             .to_owned();
-        self.client
+        self.client_for(key)
             .hset(key, field, s)
             .await
             .map_err(|e| anyhow::anyhow!(e))
@@ -90,7 +195,7 @@ impl Rtdb for RedisRtdb {
 
     async fn hash_get<'a>(&'a self, key: &'a str, field: &'a str) -> Result<Option<Bytes>> {
         let value: Option<String> = self
-            .client
+            .client_for(key)
             .hget(key, field)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -103,7 +208,7 @@ impl Rtdb for RedisRtdb {
         fields: &'a [&'a str],
     ) -> Result<Vec<Option<Bytes>>> {
         let values: Vec<Option<String>> = self
-            .client
+            .client_for(key)
             .hmget(key, fields)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -120,7 +225,7 @@ impl Rtdb for RedisRtdb {
                 Ok((k, s))
             })
             .collect();
-        self.client
+        self.client_for(key)
             .hmset(key, &string_fields?)
             .await
             .map_err(|e| anyhow::anyhow!(e))
@@ -128,7 +233,7 @@ impl Rtdb for RedisRtdb {
 
     async fn hash_get_all<'a>(&'a self, key: &'a str) -> Result<HashMap<String, Bytes>> {
         let data: HashMap<String, String> = self
-            .client
+            .client_for(key)
             .hgetall(key)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -136,14 +241,14 @@ impl Rtdb for RedisRtdb {
     }
 
     async fn hash_del<'a>(&'a self, key: &'a str, field: &'a str) -> Result<bool> {
-        self.client
+        self.client_for(key)
             .hdel(key, field)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn hash_del_many<'a>(&'a self, key: &'a str, fields: &'a [String]) -> Result<usize> {
-        self.client
+        self.client_for(key)
             .hdel_many(key, fields)
             .await
             .map_err(|e| anyhow::anyhow!(e))
@@ -151,7 +256,7 @@ impl Rtdb for RedisRtdb {
 
     async fn list_lpush<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
         let s = std::str::from_utf8(value.as_ref()).context("UTF-8 conversion failed")?;
-        self.client
+        self.client_for(key)
             .lpush(key, s)
             .await
             .map(|_| ())
@@ -160,7 +265,7 @@ impl Rtdb for RedisRtdb {
 
     async fn list_rpush<'a>(&'a self, key: &'a str, value: Bytes) -> Result<()> {
         let s = std::str::from_utf8(value.as_ref()).context("UTF-8 conversion failed")?;
-        self.client
+        self.client_for(key)
             .rpush(key, s)
             .await
             .map(|_| ())
@@ -169,7 +274,7 @@ impl Rtdb for RedisRtdb {
 
     async fn list_lpop<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
         let value: Option<String> = self
-            .client
+            .client_for(key)
             .lpop(key)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -178,7 +283,7 @@ impl Rtdb for RedisRtdb {
 
     async fn list_rpop<'a>(&'a self, key: &'a str) -> Result<Option<Bytes>> {
         let value: Option<String> = self
-            .client
+            .client_for(key)
             .rpop(key)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -190,8 +295,12 @@ impl Rtdb for RedisRtdb {
         keys: &'a [&'a str],
         timeout_seconds: u64,
     ) -> Result<Option<(String, Bytes)>> {
-        let result: Option<(String, String)> = self
-            .client
+        let shard = keys.first().map_or(0, |key| self.shard_index(key));
+        if keys.iter().any(|key| self.shard_index(key) != shard) {
+            return self.cross_shard_blpop(keys, timeout_seconds).await;
+        }
+
+        let result: Option<(String, String)> = self.shards[shard]
             .blpop(keys, timeout_seconds as usize)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -205,7 +314,7 @@ impl Rtdb for RedisRtdb {
         stop: isize,
     ) -> Result<Vec<Bytes>> {
         let values: Vec<String> = self
-            .client
+            .client_for(key)
             .lrange(key, start, stop)
             .await
             .map_err(|e| anyhow::anyhow!(e))?;
@@ -213,42 +322,46 @@ impl Rtdb for RedisRtdb {
     }
 
     async fn list_trim<'a>(&'a self, key: &'a str, start: isize, stop: isize) -> Result<()> {
-        self.client
+        self.client_for(key)
             .ltrim(key, start, stop)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn scan_match<'a>(&'a self, pattern: &'a str) -> Result<Vec<String>> {
-        self.client
-            .scan_match(pattern)
-            .await
-            .map_err(|e| anyhow::anyhow!(e))
+        let per_shard = try_join_all(self.shards.iter().map(|client| async move {
+            client
+                .scan_match(pattern)
+                .await
+                .map_err(|e| anyhow::anyhow!(e))
+        }))
+        .await?;
+        Ok(per_shard.into_iter().flatten().collect())
     }
 
     async fn sadd<'a>(&'a self, key: &'a str, member: &'a str) -> Result<bool> {
-        self.client
+        self.client_for(key)
             .sadd(key, member)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn srem<'a>(&'a self, key: &'a str, member: &'a str) -> Result<bool> {
-        self.client
+        self.client_for(key)
             .srem(key, member)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn smembers<'a>(&'a self, key: &'a str) -> Result<Vec<String>> {
-        self.client
+        self.client_for(key)
             .smembers(key)
             .await
             .map_err(|e| anyhow::anyhow!(e))
     }
 
     async fn hincrby<'a>(&'a self, key: &'a str, field: &'a str, increment: i64) -> Result<i64> {
-        self.client
+        self.client_for(key)
             .hincrby(key, field, increment)
             .await
             .map_err(|e| anyhow::anyhow!(e))
@@ -269,27 +382,56 @@ impl Rtdb for RedisRtdb {
             return Ok(());
         }
 
-        // Convert Bytes to String for the client (let compiler infer complex type)
-        let string_operations: Result<Vec<_>> = operations
-            .into_iter()
-            .map(|(key, fields)| {
-                let string_fields: Result<Vec<_>> = fields
-                    .into_iter()
-                    .map(|(f, v)| {
-                        let s = std::str::from_utf8(v.as_ref())
-                            .context("UTF-8 conversion failed")?
-                            .to_owned();
-                        Ok((f, s))
-                    })
-                    .collect();
-                Ok((key, string_fields?))
-            })
-            .collect();
+        // Values go into the pipeline as raw bytes (Redis strings are binary-safe)
+        let groups = self.split_by_shard(operations, |(key, _)| key.as_str());
+        try_join_all(groups.into_iter().map(|(shard, operations)| async move {
+            self.shards[shard]
+                .pipeline_hset_bytes(&operations)
+                .await
+                .map_err(|e| anyhow::anyhow!(e))
+        }))
+        .await
+        .map(|_| ())
+    }
 
-        self.client
-            .pipeline_hmset(&string_operations?)
-            .await
-            .map_err(|e| anyhow::anyhow!(e))
+    async fn pipeline_hash_mset_shared(
+        &self,
+        operations: Vec<(Arc<str>, SharedHashFields)>,
+    ) -> Result<()> {
+        if operations.is_empty() {
+            return Ok(());
+        }
+
+        // One pipeline per shard, all shards in flight at once
+        let groups = self.split_by_shard(operations, |(key, _)| key.as_ref());
+        try_join_all(groups.into_iter().map(|(shard, operations)| async move {
+            self.shards[shard]
+                .pipeline_hset_bytes(&operations)
+                .await
+                .map_err(|e| anyhow::anyhow!(e))
+        }))
+        .await
+        .map(|_| ())
+    }
+
+    async fn pipeline_stream_add(
+        &self,
+        entries: Vec<(Arc<str>, SharedHashFields)>,
+        max_len: usize,
+    ) -> Result<()> {
+        if entries.is_empty() {
+            return Ok(());
+        }
+
+        let groups = self.split_by_shard(entries, |(key, _)| key.as_ref());
+        try_join_all(groups.into_iter().map(|(shard, entries)| async move {
+            self.shards[shard]
+                .pipeline_xadd_bytes(&entries, max_len)
+                .await
+                .map_err(|e| anyhow::anyhow!(e))
+        }))
+        .await
+        .map(|_| ())
     }
 }
 
@@ -10,18 +10,30 @@
 //! - `C2CTarget`: Channel → Channel (data forwarding)
 //! - `M2CTarget`: Instance → Channel (action/control)
 //!
-//! ## Single Index Design
+//! ## Dense Block Design
 //!
 //! All routing tables use structured tuple keys for zero-allocation lookups:
 //! - C2M/C2C: `(channel_id, point_type, point_id)`
 //! - M2C: `(instance_id, point_type, point_id)`
 //!
+//! Each table is split into one block per `(id, point_type)` holding a dense
+//! `Vec<Option<Target>>` indexed by point_id, so a lookup is one block hash plus
+//! a bounds-checked index. Blocks are shared between snapshots: an edit
+//! (`apply_edits()`, `insert_c2c()`, `replace_instance_routes()`) copies only the
+//! blocks it touches and republishes via `ArcSwap::rcu`.
+//!
 //! String-based lookups (`lookup_c2c("1001:T:1")`) parse the key first, then query the tuple index.
-//! Prefix queries (`get_c2c_by_prefix("1001:")`) iterate and filter the tuple index.
+//! Prefix queries (`get_c2c_by_prefix("1001:")`) walk the matching blocks only.
+//!
+//! ## Flattened C2C Cascades
+//!
+//! Every snapshot also holds the transitive C2C closure of each source point
+//! (up to `MAX_C2C_CASCADE_DEPTH` hops, cut at the first revisited point), so
+//! batch writers emit all cascaded writes in one pass instead of recursing.
 
 use arc_swap::ArcSwap;
-use rustc_hash::FxHashMap;
-use std::collections::HashMap;
+use rustc_hash::{FxHashMap, FxHashSet};
+use std::collections::{BTreeMap, HashMap};
 use std::fmt;
 use std::sync::Arc;
 use voltage_model::PointType;
@@ -163,6 +175,9 @@ fn parse_point_type(s: &str) -> Option<PointType> {
     }
 }
 
+/// Maximum number of C2C hops followed from a source point (prevents infinite loops)
+pub const MAX_C2C_CASCADE_DEPTH: u8 = 2;
+
 /// Structured route key type for C2M and C2C (zero-allocation lookups)
 /// Format: (channel_id, point_type, point_id)
 pub type StructuredRouteKey = (u32, PointType, u32);
@@ -207,18 +222,357 @@ fn format_route_key(key: &StructuredRouteKey) -> String {
 // RoutingTables (internal snapshot)
 // ============================================================================
 
-/// Internal routing tables snapshot (immutable after creation)
+/// Block key: (channel_id or instance_id, point_type)
+type BlockKey = (u32, PointType);
+
+/// Largest point ID kept in a block's dense index (same bound as the write
+/// buffer's typed hashes); larger IDs go to the block's sparse map
+const MAX_DENSE_POINT_ID: u32 = 65535;
+
+/// Dense routes of one (id, point_type) pair, indexed by point_id
+///
+/// Point IDs are small and contiguous per channel/instance (same assumption as
+/// `ChannelVecStore`), so a lookup is one bounds-checked index. IDs above
+/// `MAX_DENSE_POINT_ID` are kept in a sparse map so one stray large ID
+/// cannot allocate a huge index.
+#[derive(Debug, Clone)]
+struct RouteBlock<T> {
+    targets: Vec<Option<T>>,
+    sparse: BTreeMap<u32, T>,
+    len: usize,
+}
+
+impl<T: Clone> RouteBlock<T> {
+    fn new() -> Self {
+        Self {
+            targets: Vec::new(),
+            sparse: BTreeMap::new(),
+            len: 0,
+        }
+    }
+
+    #[inline]
+    fn get(&self, point_id: u32) -> Option<&T> {
+        if point_id > MAX_DENSE_POINT_ID {
+            return self.sparse.get(&point_id);
+        }
+        self.targets.get(point_id as usize)?.as_ref()
+    }
+
+    fn insert(&mut self, point_id: u32, target: T) -> Option<T> {
+        let old = if point_id > MAX_DENSE_POINT_ID {
+            self.sparse.insert(point_id, target)
+        } else {
+            let idx = point_id as usize;
+            if idx >= self.targets.len() {
+                self.targets.resize(idx + 1, None);
+            }
+            self.targets[idx].replace(target)
+        };
+        if old.is_none() {
+            self.len += 1;
+        }
+        old
+    }
+
+    fn remove(&mut self, point_id: u32) -> Option<T> {
+        let old = if point_id > MAX_DENSE_POINT_ID {
+            self.sparse.remove(&point_id)?
+        } else {
+            let old = self.targets.get_mut(point_id as usize)?.take()?;
+            while matches!(self.targets.last(), Some(None)) {
+                self.targets.pop();
+            }
+            old
+        };
+        self.len -= 1;
+        Some(old)
+    }
+
+    fn iter(&self) -> impl Iterator<Item = (u32, &T)> {
+        self.targets
+            .iter()
+            .enumerate()
+            .filter_map(|(i, t)| Some((i as u32, t.as_ref()?)))
+            .chain(self.sparse.iter().map(|(&point_id, t)| (point_id, t)))
+    }
+}
+
+/// One routing table, split into shared dense blocks
+///
+/// Cloning copies only the block pointers; `insert`/`remove` copy the single
+/// block they touch if an older snapshot still references it.
+#[derive(Debug, Clone)]
+struct RouteTable<T> {
+    blocks: FxHashMap<BlockKey, Arc<RouteBlock<T>>>,
+    len: usize,
+}
+
+impl<T> Default for RouteTable<T> {
+    fn default() -> Self {
+        Self {
+            blocks: FxHashMap::default(),
+            len: 0,
+        }
+    }
+}
+
+impl<T: Clone> RouteTable<T> {
+    #[inline]
+    fn get(&self, key: &StructuredRouteKey) -> Option<&T> {
+        self.blocks.get(&(key.0, key.1))?.get(key.2)
+    }
+
+    fn insert(&mut self, key: StructuredRouteKey, target: T) -> Option<T> {
+        let block = self
+            .blocks
+            .entry((key.0, key.1))
+            .or_insert_with(|| Arc::new(RouteBlock::new()));
+        let old = Arc::make_mut(block).insert(key.2, target);
+        if old.is_none() {
+            self.len += 1;
+        }
+        old
+    }
+
+    fn remove(&mut self, key: &StructuredRouteKey) -> Option<T> {
+        let block_key = (key.0, key.1);
+        let block = self.blocks.get_mut(&block_key)?;
+        block.get(key.2)?;
+        let old = Arc::make_mut(block).remove(key.2);
+        if block.len == 0 {
+            self.blocks.remove(&block_key);
+        }
+        self.len -= 1;
+        old
+    }
+
+    fn len(&self) -> usize {
+        self.len
+    }
+
+    fn iter(&self) -> impl Iterator<Item = (StructuredRouteKey, &T)> {
+        self.blocks.iter().flat_map(|(&(id, pt), block)| {
+            block
+                .iter()
+                .map(move |(point_id, target)| ((id, pt, point_id), target))
+        })
+    }
+
+    /// Routes of one id, optionally restricted to one point type
+    fn iter_prefix(
+        &self,
+        id: u32,
+        point_type: Option<PointType>,
+    ) -> impl Iterator<Item = (StructuredRouteKey, &T)> {
+        self.blocks
+            .iter()
+            .filter(move |(k, _)| k.0 == id && point_type.is_none_or(|pt| k.1 == pt))
+            .flat_map(|(&(id, pt), block)| {
+                block
+                    .iter()
+                    .map(move |(point_id, target)| ((id, pt, point_id), target))
+            })
+    }
+}
+
+/// Single routing table edit, applied in batches by `RoutingCache::apply_edits()`
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RouteEdit {
+    InsertC2M(StructuredRouteKey, C2MTarget),
+    RemoveC2M(StructuredRouteKey),
+    InsertM2C(StructuredM2CKey, M2CTarget),
+    RemoveM2C(StructuredM2CKey),
+    InsertC2C(StructuredRouteKey, C2CTarget),
+    RemoveC2C(StructuredRouteKey),
+}
+
+/// Internal routing tables snapshot (immutable once published)
 ///
-/// Replaces DashMap with FxHashMap for lock-free reads.
+/// Each table sits behind its own Arc, so a snapshot derived for an edit
+/// shares every untouched table and block with its predecessor.
 /// Wrapped in Arc for atomic replacement via ArcSwap.
-#[derive(Debug, Default)]
+#[derive(Debug, Default, Clone)]
 struct RoutingTables {
     /// C2M routing: (channel_id, point_type, point_id) -> instance target
-    c2m: FxHashMap<StructuredRouteKey, C2MTarget>,
+    c2m: Arc<RouteTable<C2MTarget>>,
     /// C2C routing: (channel_id, point_type, point_id) -> channel target
-    c2c: FxHashMap<StructuredRouteKey, C2CTarget>,
+    c2c: Arc<RouteTable<C2CTarget>>,
     /// M2C routing: (instance_id, point_type, point_id) -> channel target
-    m2c: FxHashMap<StructuredM2CKey, M2CTarget>,
+    m2c: Arc<RouteTable<M2CTarget>>,
+    /// C2C closure: source point -> cascaded targets in hop order
+    c2c_fanout: Arc<RouteTable<Arc<[C2CTarget]>>>,
+}
+
+impl RoutingTables {
+    /// Build a snapshot from raw string maps, skipping unparsable entries
+    fn from_maps(
+        c2m_data: HashMap<String, String>,
+        m2c_data: HashMap<String, String>,
+        c2c_data: HashMap<String, String>,
+    ) -> Self {
+        let mut c2m = RouteTable::default();
+        for (k, v) in c2m_data {
+            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2m_target(&v)) {
+                c2m.insert(key, target);
+            }
+        }
+
+        let mut m2c = RouteTable::default();
+        for (k, v) in m2c_data {
+            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_m2c_target(&v)) {
+                m2c.insert(key, target);
+            }
+        }
+
+        let mut c2c = RouteTable::default();
+        for (k, v) in c2c_data {
+            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2c_target(&v)) {
+                c2c.insert(key, target);
+            }
+        }
+
+        let mut tables = Self {
+            c2m: Arc::new(c2m),
+            c2c: Arc::new(c2c),
+            m2c: Arc::new(m2c),
+            c2c_fanout: Arc::default(),
+        };
+        let sources: Vec<StructuredRouteKey> = tables.c2c.iter().map(|(k, _)| k).collect();
+        tables.refresh_c2c_fanout(&sources);
+        tables
+    }
+
+    /// Apply edits in order, then re-derive the affected C2C closures
+    fn apply(&mut self, edits: &[RouteEdit]) {
+        let mut c2c_edited = Vec::new();
+        for edit in edits {
+            match *edit {
+                RouteEdit::InsertC2M(key, target) => {
+                    Arc::make_mut(&mut self.c2m).insert(key, target);
+                },
+                RouteEdit::RemoveC2M(key) => {
+                    if self.c2m.get(&key).is_some() {
+                        Arc::make_mut(&mut self.c2m).remove(&key);
+                    }
+                },
+                RouteEdit::InsertM2C(key, target) => {
+                    Arc::make_mut(&mut self.m2c).insert(key, target);
+                },
+                RouteEdit::RemoveM2C(key) => {
+                    if self.m2c.get(&key).is_some() {
+                        Arc::make_mut(&mut self.m2c).remove(&key);
+                    }
+                },
+                RouteEdit::InsertC2C(key, target) => {
+                    Arc::make_mut(&mut self.c2c).insert(key, target);
+                    c2c_edited.push(key);
+                },
+                RouteEdit::RemoveC2C(key) => {
+                    if self.c2c.get(&key).is_some() {
+                        Arc::make_mut(&mut self.c2c).remove(&key);
+                        c2c_edited.push(key);
+                    }
+                },
+            }
+        }
+
+        if !c2c_edited.is_empty() {
+            let affected = self.c2c_affected_sources(c2c_edited);
+            self.refresh_c2c_fanout(&affected);
+        }
+    }
+
+    /// Sources whose closure can change when the routes of `edited` change
+    ///
+    /// A closure follows at most `MAX_C2C_CASCADE_DEPTH` routes, so only points
+    /// reaching an edited point within `MAX_C2C_CASCADE_DEPTH - 1` hops are affected.
+    fn c2c_affected_sources(&self, edited: Vec<StructuredRouteKey>) -> Vec<StructuredRouteKey> {
+        let mut affected: FxHashSet<StructuredRouteKey> = edited.iter().copied().collect();
+        let mut frontier = affected.clone();
+        for _ in 1..MAX_C2C_CASCADE_DEPTH {
+            if frontier.is_empty() {
+                break;
+            }
+            let predecessors: FxHashSet<StructuredRouteKey> = self
+                .c2c
+                .iter()
+                .filter(|(_, t)| frontier.contains(&(t.channel_id, t.point_type, t.point_id)))
+                .map(|(k, _)| k)
+                .filter(|k| !affected.contains(k))
+                .collect();
+            affected.extend(&predecessors);
+            frontier = predecessors;
+        }
+        affected.into_iter().collect()
+    }
+
+    /// Recompute the C2C closure of `sources` from the `c2c` table
+    ///
+    /// Chains stop after `MAX_C2C_CASCADE_DEPTH` hops or before a point the
+    /// chain already visited (cycle), whichever comes first.
+    fn refresh_c2c_fanout(&mut self, sources: &[StructuredRouteKey]) {
+        let max_hops = MAX_C2C_CASCADE_DEPTH as usize;
+        let mut chain: Vec<StructuredRouteKey> = Vec::with_capacity(max_hops + 1);
+        let fanout = Arc::make_mut(&mut self.c2c_fanout);
+
+        for &source in sources {
+            chain.clear();
+            chain.push(source);
+            let mut hops = Vec::with_capacity(max_hops);
+            let mut next = self.c2c.get(&source).copied();
+
+            while let Some(target) = next {
+                let key = (target.channel_id, target.point_type, target.point_id);
+                if hops.len() == max_hops || chain.contains(&key) {
+                    break;
+                }
+                hops.push(target);
+                chain.push(key);
+                next = self.c2c.get(&key).copied();
+            }
+
+            if hops.is_empty() {
+                fanout.remove(&source);
+            } else {
+                fanout.insert(source, Arc::from(hops));
+            }
+        }
+    }
+
+    /// Edits turning this snapshot's routes of `instance_id` into the given ones
+    ///
+    /// Routes that are already identical produce no edit, so their blocks stay shared.
+    fn instance_edits(
+        &self,
+        instance_id: u32,
+        c2m: &FxHashMap<StructuredRouteKey, C2MTarget>,
+        m2c: &FxHashMap<StructuredM2CKey, M2CTarget>,
+    ) -> Vec<RouteEdit> {
+        let mut edits: Vec<RouteEdit> = self
+            .c2m
+            .iter()
+            .filter(|(k, t)| t.instance_id == instance_id && !c2m.contains_key(k))
+            .map(|(k, _)| RouteEdit::RemoveC2M(k))
+            .collect();
+        edits.extend(
+            self.m2c
+                .iter_prefix(instance_id, None)
+                .filter(|(k, _)| !m2c.contains_key(k))
+                .map(|(k, _)| RouteEdit::RemoveM2C(k)),
+        );
+        edits.extend(
+            c2m.iter()
+                .filter(|(k, t)| self.c2m.get(k) != Some(t))
+                .map(|(&k, &t)| RouteEdit::InsertC2M(k, t)),
+        );
+        edits.extend(
+            m2c.iter()
+                .filter(|(k, t)| self.m2c.get(k) != Some(t))
+                .map(|(&k, &t)| RouteEdit::InsertM2C(k, t)),
+        );
+        edits
+    }
 }
 
 // ============================================================================
@@ -227,12 +581,13 @@ struct RoutingTables {
 
 /// Application-layer routing cache for C2M, C2C and M2C routing
 ///
-/// Uses ArcSwap + FxHashMap for lock-free reads (~25ns vs ~50ns for DashMap).
+/// Uses ArcSwap + dense route blocks for lock-free reads (~25ns vs ~50ns for DashMap).
 /// Routing tables are atomically replaced during hot-reload.
 ///
 /// ## Performance
-/// - Read: `ArcSwap::load()` (~5ns) + `FxHashMap::get()` (~20ns) = ~25ns total
-/// - Write: Build new tables + `ArcSwap::store()` (atomic pointer swap)
+/// - Read: `ArcSwap::load()` (~5ns) + block `FxHashMap::get()` + index = ~25ns total
+/// - Reload: Build new tables + `ArcSwap::store()` (atomic pointer swap)
+/// - Edit: Copy touched blocks only + `ArcSwap::rcu()`
 ///
 /// ## Hot Path Usage
 /// For hot paths like `write_channel_batch`, use `lookup_*_by_parts()` methods
@@ -271,28 +626,8 @@ impl RoutingCache {
         m2c_data: HashMap<String, String>,
         c2c_data: HashMap<String, String>,
     ) -> Self {
-        let mut tables = RoutingTables::default();
-
-        for (k, v) in c2m_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2m_target(&v)) {
-                tables.c2m.insert(key, target);
-            }
-        }
-
-        for (k, v) in m2c_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_m2c_target(&v)) {
-                tables.m2c.insert(key, target);
-            }
-        }
-
-        for (k, v) in c2c_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2c_target(&v)) {
-                tables.c2c.insert(key, target);
-            }
-        }
-
         Self {
-            tables: ArcSwap::from_pointee(tables),
+            tables: ArcSwap::from_pointee(RoutingTables::from_maps(c2m_data, m2c_data, c2c_data)),
         }
     }
 
@@ -306,28 +641,73 @@ impl RoutingCache {
         m2c_data: HashMap<String, String>,
         c2c_data: HashMap<String, String>,
     ) {
-        let mut new_tables = RoutingTables::default();
+        let new_tables = RoutingTables::from_maps(c2m_data, m2c_data, c2c_data);
 
-        for (k, v) in c2m_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2m_target(&v)) {
-                new_tables.c2m.insert(key, target);
-            }
-        }
+        // Atomic replacement - readers see either old or new, never partial
+        self.tables.store(Arc::new(new_tables));
+    }
 
-        for (k, v) in m2c_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_m2c_target(&v)) {
-                new_tables.m2c.insert(key, target);
-            }
+    /// Apply a batch of route edits as one copy-on-write snapshot
+    ///
+    /// Only the blocks touched by `edits` are copied; every other block is
+    /// shared with the previous snapshot. Readers see all edits or none.
+    ///
+    /// ## Example
+    /// ```rust
+    /// use voltage_rtdb::{C2MTarget, RouteEdit, RoutingCache};
+    /// use voltage_model::PointType;
+    ///
+    /// let cache = RoutingCache::new();
+    /// cache.apply_edits(&[
+    ///     RouteEdit::InsertC2M((1001, PointType::Telemetry, 1), C2MTarget { instance_id: 5, point_id: 1 }),
+    ///     RouteEdit::InsertC2M((1001, PointType::Telemetry, 2), C2MTarget { instance_id: 5, point_id: 2 }),
+    /// ]);
+    /// assert_eq!(cache.stats().c2m_count, 2);
+    /// ```
+    pub fn apply_edits(&self, edits: &[RouteEdit]) {
+        if edits.is_empty() {
+            return;
         }
+        self.tables.rcu(|old| {
+            let mut tables = RoutingTables::clone(old);
+            tables.apply(edits);
+            Arc::new(tables)
+        });
+    }
 
-        for (k, v) in c2c_data {
-            if let (Some(key), Some(target)) = (parse_route_key(&k), parse_c2c_target(&v)) {
-                new_tables.c2c.insert(key, target);
+    /// Replace every C2M and M2C route of one instance (copy-on-write)
+    ///
+    /// Takes the instance's routes in loader format (see `from_maps()`): C2M
+    /// routes targeting `instance_id` and M2C routes keyed by it that are not
+    /// in the new maps are removed, changed ones are written. Unchanged routes
+    /// keep their blocks shared, so refreshing one instance after an API edit
+    /// copies only the blocks that actually changed.
+    pub fn replace_instance_routes(
+        &self,
+        instance_id: u32,
+        c2m_data: HashMap<String, String>,
+        m2c_data: HashMap<String, String>,
+    ) {
+        let c2m: FxHashMap<StructuredRouteKey, C2MTarget> = c2m_data
+            .iter()
+            .filter_map(|(k, v)| Some((parse_route_key(k)?, parse_c2m_target(v)?)))
+            .filter(|(_, t)| t.instance_id == instance_id)
+            .collect();
+        let m2c: FxHashMap<StructuredM2CKey, M2CTarget> = m2c_data
+            .iter()
+            .filter_map(|(k, v)| Some((parse_route_key(k)?, parse_m2c_target(v)?)))
+            .filter(|(k, _)| k.0 == instance_id)
+            .collect();
+
+        self.tables.rcu(|old| {
+            let edits = old.instance_edits(instance_id, &c2m, &m2c);
+            if edits.is_empty() {
+                return Arc::clone(old);
             }
-        }
-
-        // Atomic replacement - readers see either old or new, never partial
-        self.tables.store(Arc::new(new_tables));
+            let mut tables = RoutingTables::clone(old);
+            tables.apply(&edits);
+            Arc::new(tables)
+        });
     }
 
     /// Lookup C2M routing by string key (parses key first)
@@ -484,6 +864,41 @@ impl RoutingCache {
             .copied()
     }
 
+    /// Lookup the flattened C2C cascade of a source point (zero parsing)
+    ///
+    /// Returns every cascaded target in hop order: `[0]` is the direct C2C
+    /// target, `[1]` the target of that point, and so on. `None` if the point
+    /// has no C2C route.
+    ///
+    /// ## Example
+    /// ```rust
+    /// use voltage_rtdb::RoutingCache;
+    /// use voltage_model::PointType;
+    /// use std::collections::HashMap;
+    ///
+    /// let mut c2c = HashMap::new();
+    /// c2c.insert("1001:T:1".to_string(), "1002:T:5".to_string());
+    /// c2c.insert("1002:T:5".to_string(), "1003:S:2".to_string());
+    /// let cache = RoutingCache::from_maps(HashMap::new(), HashMap::new(), c2c);
+    ///
+    /// let hops = cache.lookup_c2c_fanout_by_parts(1001, PointType::Telemetry, 1).unwrap();
+    /// assert_eq!(hops.len(), 2);
+    /// assert_eq!(hops[1].channel_id, 1003);
+    /// ```
+    #[inline]
+    pub fn lookup_c2c_fanout_by_parts(
+        &self,
+        channel_id: u32,
+        point_type: PointType,
+        point_id: u32,
+    ) -> Option<Arc<[C2CTarget]>> {
+        self.tables
+            .load()
+            .c2c_fanout
+            .get(&(channel_id, point_type, point_id))
+            .cloned()
+    }
+
     /// Insert C2C routing entry from string keys (copy-on-write)
     ///
     /// Note: This is a cold-path operation. For bulk updates, use `update()`.
@@ -498,7 +913,7 @@ impl RoutingCache {
 
     /// Insert C2C routing entry from structured key (copy-on-write)
     ///
-    /// Note: This is a cold-path operation. For bulk updates, use `update()`.
+    /// Note: This is a cold-path operation. For bulk edits, use `apply_edits()`.
     pub fn insert_c2c_by_parts(
         &self,
         channel_id: u32,
@@ -506,17 +921,10 @@ impl RoutingCache {
         point_id: u32,
         target: C2CTarget,
     ) {
-        // Copy-on-write: clone current tables, modify, atomic replace
-        let old = self.tables.load();
-        let mut new_tables = RoutingTables {
-            c2m: old.c2m.clone(),
-            c2c: old.c2c.clone(),
-            m2c: old.m2c.clone(),
-        };
-        new_tables
-            .c2c
-            .insert((channel_id, point_type, point_id), target);
-        self.tables.store(Arc::new(new_tables));
+        self.apply_edits(&[RouteEdit::InsertC2C(
+            (channel_id, point_type, point_id),
+            target,
+        )]);
     }
 
     /// Remove C2C routing entry by string key (copy-on-write)
@@ -532,25 +940,23 @@ impl RoutingCache {
 
     /// Remove C2C routing entry by structured key (copy-on-write)
     ///
-    /// Note: This is a cold-path operation. For bulk updates, use `update()`.
+    /// Note: This is a cold-path operation. For bulk edits, use `apply_edits()`.
     pub fn remove_c2c_by_parts(
         &self,
         channel_id: u32,
         point_type: PointType,
         point_id: u32,
     ) -> Option<C2CTarget> {
-        // Copy-on-write: clone current tables, modify, atomic replace
-        let old = self.tables.load();
-        let target = old.c2c.get(&(channel_id, point_type, point_id)).copied()?;
-
-        let mut new_tables = RoutingTables {
-            c2m: old.c2m.clone(),
-            c2c: old.c2c.clone(),
-            m2c: old.m2c.clone(),
-        };
-        new_tables.c2c.remove(&(channel_id, point_type, point_id));
-        self.tables.store(Arc::new(new_tables));
-        Some(target)
+        let key = (channel_id, point_type, point_id);
+        let previous = self.tables.rcu(|old| {
+            if old.c2c.get(&key).is_none() {
+                return Arc::clone(old);
+            }
+            let mut tables = RoutingTables::clone(old);
+            tables.apply(&[RouteEdit::RemoveC2C(key)]);
+            Arc::new(tables)
+        });
+        previous.c2c.get(&key).copied()
     }
 
     /// Get all C2C routing entries matching a prefix
@@ -564,9 +970,8 @@ impl RoutingCache {
         let tables = self.tables.load();
         tables
             .c2c
-            .iter()
-            .filter(|(k, _)| k.0 == id && point_type_filter.is_none_or(|pt| k.1 == pt))
-            .map(|(k, v)| (Arc::from(format_route_key(k)), *v))
+            .iter_prefix(id, point_type_filter)
+            .map(|(k, v)| (Arc::from(format_route_key(&k)), *v))
             .collect()
     }
 
@@ -581,9 +986,8 @@ impl RoutingCache {
         let tables = self.tables.load();
         tables
             .c2m
-            .iter()
-            .filter(|(k, _)| k.0 == id && point_type_filter.is_none_or(|pt| k.1 == pt))
-            .map(|(k, v)| (Arc::from(format_route_key(k)), *v))
+            .iter_prefix(id, point_type_filter)
+            .map(|(k, v)| (Arc::from(format_route_key(&k)), *v))
             .collect()
     }
 
@@ -598,9 +1002,8 @@ impl RoutingCache {
         let tables = self.tables.load();
         tables
             .m2c
-            .iter()
-            .filter(|(k, _)| k.0 == id && point_type_filter.is_none_or(|pt| k.1 == pt))
-            .map(|(k, v)| (Arc::from(format_route_key(k)), *v))
+            .iter_prefix(id, point_type_filter)
+            .map(|(k, v)| (Arc::from(format_route_key(&k)), *v))
             .collect()
     }
 
@@ -629,7 +1032,7 @@ impl RoutingCache {
     #[inline]
     pub fn c2m_iter(&self) -> Vec<(StructuredRouteKey, C2MTarget)> {
         let tables = self.tables.load();
-        tables.c2m.iter().map(|(&k, &v)| (k, v)).collect()
+        tables.c2m.iter().map(|(k, &v)| (k, v)).collect()
     }
 
     /// Iterate over all M2C routes (for building reverse mappings)
@@ -638,7 +1041,7 @@ impl RoutingCache {
     #[inline]
     pub fn m2c_iter(&self) -> Vec<(StructuredM2CKey, M2CTarget)> {
         let tables = self.tables.load();
-        tables.m2c.iter().map(|(&k, &v)| (k, v)).collect()
+        tables.m2c.iter().map(|(k, &v)| (k, v)).collect()
     }
 }
 
@@ -913,4 +1316,208 @@ mod tests {
         });
         assert!(has_m2c_route);
     }
+
+    #[test]
+    fn test_c2c_fanout_closure() {
+        let mut c2c_data = HashMap::new();
+        // 1001 -> 1002 -> 1003 -> 1004 (longer than MAX_C2C_CASCADE_DEPTH)
+        c2c_data.insert("1001:T:1".to_string(), "1002:T:1".to_string());
+        c2c_data.insert("1002:T:1".to_string(), "1003:S:2".to_string());
+        c2c_data.insert("1003:S:2".to_string(), "1004:T:3".to_string());
+        // Cycle 2001 <-> 2002
+        c2c_data.insert("2001:T:1".to_string(), "2002:T:1".to_string());
+        c2c_data.insert("2002:T:1".to_string(), "2001:T:1".to_string());
+
+        let cache = RoutingCache::from_maps(HashMap::new(), HashMap::new(), c2c_data);
+
+        let hops = cache
+            .lookup_c2c_fanout_by_parts(1001, PointType::Telemetry, 1)
+            .unwrap();
+        assert_eq!(hops.len(), MAX_C2C_CASCADE_DEPTH as usize);
+        assert_eq!(hops[0].channel_id, 1002);
+        assert_eq!(
+            (hops[1].channel_id, hops[1].point_type, hops[1].point_id),
+            (1003, PointType::Signal, 2)
+        );
+
+        // Cycle is cut before returning to the source
+        let hops = cache
+            .lookup_c2c_fanout_by_parts(2001, PointType::Telemetry, 1)
+            .unwrap();
+        assert_eq!(hops.len(), 1);
+        assert_eq!(hops[0].channel_id, 2002);
+
+        // Copy-on-write edits keep the closure in sync
+        cache.remove_c2c("1002:T:1");
+        let hops = cache
+            .lookup_c2c_fanout_by_parts(1001, PointType::Telemetry, 1)
+            .unwrap();
+        assert_eq!(hops.len(), 1);
+        assert!(cache
+            .lookup_c2c_fanout_by_parts(1002, PointType::Telemetry, 1)
+            .is_none());
+        cache.insert_c2c("1002:T:1", "1004:T:3");
+        let hops = cache
+            .lookup_c2c_fanout_by_parts(1001, PointType::Telemetry, 1)
+            .unwrap();
+        assert_eq!(hops[1].channel_id, 1004);
+    }
+
+    #[test]
+    fn test_edit_copies_only_touched_block() {
+        let mut c2m_data = HashMap::new();
+        for p in 1..=3 {
+            c2m_data.insert(format!("1001:T:{}", p), format!("5:M:{}", p));
+            c2m_data.insert(format!("1002:T:{}", p), format!("6:M:{}", p));
+        }
+        let mut m2c_data = HashMap::new();
+        m2c_data.insert("5:A:1".to_string(), "1001:A:1".to_string());
+        let cache = RoutingCache::from_maps(c2m_data, m2c_data, HashMap::new());
+        let before = cache.tables.load_full();
+
+        cache.apply_edits(&[
+            RouteEdit::InsertC2M(
+                (1001, PointType::Telemetry, 10),
+                C2MTarget {
+                    instance_id: 5,
+                    point_id: 10,
+                },
+            ),
+            RouteEdit::RemoveC2M((1001, PointType::Telemetry, 2)),
+        ]);
+        let after = cache.tables.load_full();
+
+        let block = |t: &RoutingTables, ch| Arc::clone(&t.c2m.blocks[&(ch, PointType::Telemetry)]);
+        assert!(!Arc::ptr_eq(&block(&before, 1001), &block(&after, 1001)));
+        assert!(Arc::ptr_eq(&block(&before, 1002), &block(&after, 1002)));
+        assert!(Arc::ptr_eq(&before.m2c, &after.m2c));
+
+        // Old snapshot is untouched, new one has the edits
+        assert!(before.c2m.get(&(1001, PointType::Telemetry, 2)).is_some());
+        assert!(cache
+            .lookup_c2m_by_parts(1001, PointType::Telemetry, 2)
+            .is_none());
+        assert_eq!(
+            cache
+                .lookup_c2m_by_parts(1001, PointType::Telemetry, 10)
+                .unwrap()
+                .point_id,
+            10
+        );
+        assert!(cache
+            .lookup_c2m_by_parts(1001, PointType::Telemetry, 11)
+            .is_none());
+        assert_eq!(cache.stats().c2m_count, 6);
+        assert_eq!(cache.get_c2m_by_prefix("1001:T:").len(), 3);
+
+        // Removing the last route of a block drops the block
+        cache.apply_edits(&[
+            RouteEdit::RemoveM2C((5, PointType::Adjustment, 1)),
+            RouteEdit::RemoveM2C((5, PointType::Adjustment, 99)),
+        ]);
+        assert!(cache.tables.load().m2c.blocks.is_empty());
+        assert_eq!(cache.stats().m2c_count, 0);
+    }
+
+    #[test]
+    fn test_large_point_ids_use_sparse_map() {
+        let mut c2m_data = HashMap::new();
+        c2m_data.insert("1001:T:1".to_string(), "5:M:1".to_string());
+        c2m_data.insert("1001:T:4000000000".to_string(), "5:M:2".to_string());
+        let cache = RoutingCache::from_maps(c2m_data, HashMap::new(), HashMap::new());
+
+        let tables = cache.tables.load();
+        let block = &tables.c2m.blocks[&(1001, PointType::Telemetry)];
+        assert_eq!(block.targets.len(), 2);
+        assert_eq!(block.sparse.len(), 1);
+        assert_eq!(
+            cache
+                .lookup_c2m_by_parts(1001, PointType::Telemetry, 4_000_000_000)
+                .unwrap()
+                .point_id,
+            2
+        );
+        assert_eq!(cache.get_c2m_by_prefix("1001:T:").len(), 2);
+
+        cache.apply_edits(&[RouteEdit::RemoveC2M((
+            1001,
+            PointType::Telemetry,
+            4_000_000_000,
+        ))]);
+        assert!(cache
+            .lookup_c2m_by_parts(1001, PointType::Telemetry, 4_000_000_000)
+            .is_none());
+        assert_eq!(cache.stats().c2m_count, 1);
+    }
+
+    #[test]
+    fn test_incremental_fanout_matches_rebuild() {
+        let mut c2c_data = HashMap::new();
+        c2c_data.insert("1001:T:1".to_string(), "1002:T:1".to_string());
+        c2c_data.insert("1002:T:1".to_string(), "1003:T:1".to_string());
+        c2c_data.insert("1003:T:1".to_string(), "1004:T:1".to_string());
+        c2c_data.insert("1005:T:1".to_string(), "1003:T:1".to_string());
+        let cache = RoutingCache::from_maps(HashMap::new(), HashMap::new(), c2c_data.clone());
+
+        // Redirect the middle of the chain and close a cycle
+        cache.apply_edits(&[
+            RouteEdit::InsertC2C(
+                (1003, PointType::Telemetry, 1),
+                C2CTarget {
+                    channel_id: 1001,
+                    point_type: PointType::Telemetry,
+                    point_id: 1,
+                },
+            ),
+            RouteEdit::RemoveC2C((1005, PointType::Telemetry, 1)),
+        ]);
+        c2c_data.insert("1003:T:1".to_string(), "1001:T:1".to_string());
+        c2c_data.remove("1005:T:1");
+        let rebuilt = RoutingCache::from_maps(HashMap::new(), HashMap::new(), c2c_data);
+
+        for ch in 1001..=1005 {
+            assert_eq!(
+                cache.lookup_c2c_fanout_by_parts(ch, PointType::Telemetry, 1),
+                rebuilt.lookup_c2c_fanout_by_parts(ch, PointType::Telemetry, 1),
+                "fanout of channel {}",
+                ch
+            );
+        }
+    }
+
+    #[test]
+    fn test_replace_instance_routes() {
+        let mut c2m_data = HashMap::new();
+        c2m_data.insert("1001:T:1".to_string(), "5:M:1".to_string());
+        c2m_data.insert("1001:T:2".to_string(), "5:M:2".to_string());
+        c2m_data.insert("1002:T:1".to_string(), "6:M:1".to_string());
+        let mut m2c_data = HashMap::new();
+        m2c_data.insert("5:A:1".to_string(), "1001:A:1".to_string());
+        m2c_data.insert("6:A:1".to_string(), "1002:A:1".to_string());
+        let cache = RoutingCache::from_maps(c2m_data, m2c_data, HashMap::new());
+
+        // Same routes: nothing is republished
+        let before = cache.tables.load_full();
+        let mut same_c2m = HashMap::new();
+        same_c2m.insert("1001:T:1".to_string(), "5:M:1".to_string());
+        same_c2m.insert("1001:T:2".to_string(), "5:M:2".to_string());
+        let mut same_m2c = HashMap::new();
+        same_m2c.insert("5:A:1".to_string(), "1001:A:1".to_string());
+        cache.replace_instance_routes(5, same_c2m, same_m2c);
+        assert!(Arc::ptr_eq(&before, &cache.tables.load_full()));
+
+        // Instance 5 now only routes 1001:T:2 -> 5:M:3, no actions
+        let mut c2m_new = HashMap::new();
+        c2m_new.insert("1001:T:2".to_string(), "5:M:3".to_string());
+        cache.replace_instance_routes(5, c2m_new, HashMap::new());
+
+        assert!(cache.lookup_c2m("1001:T:1").is_none());
+        assert_eq!(cache.lookup_c2m("1001:T:2").unwrap().point_id, 3);
+        assert!(cache.lookup_m2c("5:A:1").is_none());
+        // Other instances are untouched
+        assert_eq!(cache.lookup_c2m("1002:T:1").unwrap().instance_id, 6);
+        assert!(cache.lookup_m2c("6:A:1").is_some());
+        let stats = cache.stats();
+        assert_eq!((stats.c2m_count, stats.m2c_count), (2, 1));
+    }
 }
@@ -0,0 +1,245 @@
+//! Columnar batch reads from the shared memory RTDB
+//!
+//! `SharedVecRtdbReader::read_batch` resolves many instances or channels
+//! against one index snapshot and gathers their slots into [`PointColumns`]
+//! (struct-of-arrays). The encoded form is what the batch HTTP endpoints
+//! return, so dashboards polling hundreds of instances get one response
+//! instead of one Redis hash per instance.
+//!
+//! # Wire Format (v1, little-endian)
+//!
+//! ```text
+//! ┌──────────────────────────────────────────────┐
+//! │ Header (16 bytes)                            │
+//! │   magic [u8; 4] ("VPCB"), version u32,       │
+//! │   row_count u64                              │
+//! ├──────────────────────────────────────────────┤
+//! │ value f64[row_count]                         │
+//! │ timestamp u64[row_count] (ms)                │
+//! │ owner_id u32[row_count]                      │
+//! │ point_id u32[row_count]                      │
+//! │ area u8[row_count] (SnapshotArea)            │
+//! │ type_idx u8[row_count]                       │
+//! │ quality u8[row_count]                        │
+//! └──────────────────────────────────────────────┘
+//! ```
+//!
+//! Columns are ordered by element width, so every column starts at an
+//! offset aligned to its element size: clients can view them in place
+//! (e.g. `Float64Array(buf, 16, n)`) without copying.
+
+use crate::shared_snapshot::SnapshotArea;
+use anyhow::{bail, Result};
+
+/// Batch wire format magic
+pub const BATCH_MAGIC: [u8; 4] = *b"VPCB";
+
+/// Batch wire format version
+pub const BATCH_VERSION: u32 = 1;
+
+/// Batch wire format header size in bytes
+pub const BATCH_HEADER_SIZE: usize = 16;
+
+/// Encoded bytes per row (sum of all column widths)
+pub const BATCH_ROW_SIZE: usize = 8 + 8 + 4 + 4 + 1 + 1 + 1;
+
+/// Content type of the encoded columns
+pub const BATCH_CONTENT_TYPE: &str = "application/vnd.voltage.point-columns";
+
+/// Points of one instance or channel to read in a batch
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BatchReadTarget {
+    pub area: SnapshotArea,
+    /// Instance or channel ID
+    pub owner_id: u32,
+    /// Point type index within the area (instance: 0 = M, 1 = A;
+    /// channel: `ChannelIndex::point_type_to_index`)
+    pub type_idx: u8,
+    /// Registered point IDs to read (any numbering); `None` reads every
+    /// registered point, in ascending point ID order
+    pub point_ids: Option<Vec<u32>>,
+}
+
+/// Point values as parallel columns, one row per point
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct PointColumns {
+    pub values: Vec<f64>,
+    pub timestamps: Vec<u64>,
+    pub owner_ids: Vec<u32>,
+    pub point_ids: Vec<u32>,
+    pub areas: Vec<u8>,
+    pub type_idx: Vec<u8>,
+    pub qualities: Vec<u8>,
+}
+
+impl PointColumns {
+    /// Create with capacity for `rows` points
+    pub fn with_capacity(rows: usize) -> Self {
+        Self {
+            values: Vec::with_capacity(rows),
+            timestamps: Vec::with_capacity(rows),
+            owner_ids: Vec::with_capacity(rows),
+            point_ids: Vec::with_capacity(rows),
+            areas: Vec::with_capacity(rows),
+            type_idx: Vec::with_capacity(rows),
+            qualities: Vec::with_capacity(rows),
+        }
+    }
+
+    /// Append one row
+    #[inline]
+    #[allow(clippy::too_many_arguments)]
+    pub fn push(
+        &mut self,
+        area: SnapshotArea,
+        owner_id: u32,
+        type_idx: u8,
+        point_id: u32,
+        value: f64,
+        timestamp: u64,
+        quality: u8,
+    ) {
+        self.values.push(value);
+        self.timestamps.push(timestamp);
+        self.owner_ids.push(owner_id);
+        self.point_ids.push(point_id);
+        self.areas.push(area as u8);
+        self.type_idx.push(type_idx);
+        self.qualities.push(quality);
+    }
+
+    /// Number of rows
+    pub fn len(&self) -> usize {
+        self.values.len()
+    }
+
+    /// Check if there are no rows
+    pub fn is_empty(&self) -> bool {
+        self.values.is_empty()
+    }
+
+    /// Encode to the v1 wire format
+    pub fn encode(&self) -> Vec<u8> {
+        let rows = self.len();
+        let mut out = Vec::with_capacity(BATCH_HEADER_SIZE + rows * BATCH_ROW_SIZE);
+        out.extend_from_slice(&BATCH_MAGIC);
+        out.extend_from_slice(&BATCH_VERSION.to_le_bytes());
+        out.extend_from_slice(&(rows as u64).to_le_bytes());
+
+        for value in &self.values {
+            out.extend_from_slice(&value.to_bits().to_le_bytes());
+        }
+        for timestamp in &self.timestamps {
+            out.extend_from_slice(&timestamp.to_le_bytes());
+        }
+        for owner_id in &self.owner_ids {
+            out.extend_from_slice(&owner_id.to_le_bytes());
+        }
+        for point_id in &self.point_ids {
+            out.extend_from_slice(&point_id.to_le_bytes());
+        }
+        out.extend_from_slice(&self.areas);
+        out.extend_from_slice(&self.type_idx);
+        out.extend_from_slice(&self.qualities);
+        out
+    }
+
+    /// Decode a v1 wire format buffer
+    pub fn decode(bytes: &[u8]) -> Result<Self> {
+        if bytes.len() < BATCH_HEADER_SIZE {
+            bail!("Point columns too short: {} bytes", bytes.len());
+        }
+        if bytes[0..4] != BATCH_MAGIC {
+            bail!("Invalid point columns magic");
+        }
+        let version = u32::from_le_bytes([bytes[4], bytes[5], bytes[6], bytes[7]]);
+        if version != BATCH_VERSION {
+            bail!("Unsupported point columns version {}", version);
+        }
+        let mut rows_buf = [0u8; 8];
+        rows_buf.copy_from_slice(&bytes[8..16]);
+        let rows = u64::from_le_bytes(rows_buf) as usize;
+        let body = &bytes[BATCH_HEADER_SIZE..];
+        if rows.checked_mul(BATCH_ROW_SIZE) != Some(body.len()) {
+            bail!(
+                "Point columns size mismatch: {} rows, {} body bytes",
+                rows,
+                body.len()
+            );
+        }
+
+        let (values, rest) = body.split_at(rows * 8);
+        let (timestamps, rest) = rest.split_at(rows * 8);
+        let (owner_ids, rest) = rest.split_at(rows * 4);
+        let (point_ids, rest) = rest.split_at(rows * 4);
+        let (areas, rest) = rest.split_at(rows);
+        let (type_idx, qualities) = rest.split_at(rows);
+
+        let u64s = |column: &[u8]| -> Vec<u64> {
+            column
+                .chunks_exact(8)
+                .map(|c| u64::from_le_bytes([c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]]))
+                .collect()
+        };
+        let u32s = |column: &[u8]| -> Vec<u32> {
+            column
+                .chunks_exact(4)
+                .map(|c| u32::from_le_bytes([c[0], c[1], c[2], c[3]]))
+                .collect()
+        };
+
+        Ok(Self {
+            values: u64s(values).into_iter().map(f64::from_bits).collect(),
+            timestamps: u64s(timestamps),
+            owner_ids: u32s(owner_ids),
+            point_ids: u32s(point_ids),
+            areas: areas.to_vec(),
+            type_idx: type_idx.to_vec(),
+            qualities: qualities.to_vec(),
+        })
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_point_columns_roundtrip_and_alignment() {
+        let mut columns = PointColumns::with_capacity(3);
+        columns.push(SnapshotArea::Instance, 5, 0, 1, 100.5, 1000, 0);
+        columns.push(SnapshotArea::Instance, 5, 1, 2, -3.25, 1001, 0x40);
+        columns.push(SnapshotArea::Channel, 1001, 2, 7, 1.0, 1002, 0);
+
+        let bytes = columns.encode();
+        assert_eq!(bytes.len(), BATCH_HEADER_SIZE + 3 * BATCH_ROW_SIZE);
+        assert_eq!(PointColumns::decode(&bytes).unwrap(), columns);
+
+        // Columns start aligned to their element width
+        let value_start = BATCH_HEADER_SIZE;
+        let timestamp_start = value_start + 3 * 8;
+        let owner_start = timestamp_start + 3 * 8;
+        assert_eq!(value_start % 8, 0);
+        assert_eq!(timestamp_start % 8, 0);
+        assert_eq!(owner_start % 4, 0);
+        assert_eq!(
+            f64::from_le_bytes(bytes[value_start + 8..value_start + 16].try_into().unwrap()),
+            -3.25
+        );
+    }
+
+    #[test]
+    fn test_point_columns_rejects_bad_input() {
+        let mut bytes = PointColumns::default().encode();
+        assert_eq!(bytes.len(), BATCH_HEADER_SIZE);
+        assert!(PointColumns::decode(&bytes).unwrap().is_empty());
+
+        // Row count without body
+        bytes[8] = 1;
+        assert!(PointColumns::decode(&bytes).is_err());
+
+        bytes[0] = b'X';
+        assert!(PointColumns::decode(&bytes).is_err());
+    }
+}
@@ -18,29 +18,110 @@
 //!     └─────────────────────────────────────────┘
 //! ```
 //!
-//! # Memory Layout (v2)
+//! # Memory Layout (v5)
 //!
 //! ```text
 //! ┌──────────────────────────────────────────────┐
-//! │ SharedHeader (64 bytes)                      │
+//! │ SharedHeader (128 bytes)                     │
 //! ├──────────────────────────────────────────────┤
 //! │ InstanceIndex[] (48 bytes each)              │
 //! ├──────────────────────────────────────────────┤
 //! │ Instance PointSlot[] (32 bytes each)         │
 //! ├──────────────────────────────────────────────┤
-//! │ ChannelIndex[] (48 bytes each) [v2]          │
+//! │ ChannelIndex[] (48 bytes each)               │
 //! ├──────────────────────────────────────────────┤
-//! │ Channel PointSlot[] (32 bytes each) [v2]     │
+//! │ Channel PointSlot[] (32 bytes each)          │
+//! ├──────────────────────────────────────────────┤
+//! │ ChangeRingHeader (64 bytes)                  │
+//! ├──────────────────────────────────────────────┤
+//! │ ChangeEntry[] (16 bytes each)                │
+//! ├──────────────────────────────────────────────┤
+//! │ Per channel: CommandRingHeader (64 bytes)    │
+//! │            + CommandEntry[] (32 bytes each)  │
+//! ├──────────────────────────────────────────────┤
+//! │ Per history point: HistoryRingHeader (24)    │
+//! │            + HistoryEntry[] (24 bytes each)  │
+//! ├──────────────────────────────────────────────┤
+//! │ Instance point IDs (u32 per instance slot)   │
+//! ├──────────────────────────────────────────────┤
+//! │ Channel point IDs (u32 per channel slot)     │
 //! └──────────────────────────────────────────────┘
 //! ```
+//!
+//! # Layout Version
+//!
+//! The writer stamps `SHARED_LAYOUT_VERSION` and the segment dimensions
+//! (`SharedConfig` limits and ring capacities) into the header. Every
+//! opener checks both, so a reader built for another layout or configured
+//! with other limits fails to open instead of misreading slots. Bump
+//! `SHARED_LAYOUT_VERSION` with every change to the file format.
+//!
+//! # Change Ring
+//!
+//! Every slot write publishes the slot's absolute file offset into a
+//! fixed-size MPSC ring. Readers keep a `ChangeCursor` and call
+//! `drain_changes(cursor, ..)` to process only the points that changed,
+//! instead of scanning every slot.
+//!
+//! # Command Rings
+//!
+//! Downlink runs the other way: modsrv pushes C/A commands through a
+//! `SharedCommandSender` into the ring of the target channel (same position
+//! as its ChannelIndex entry), and comsrv's CommandTrigger drains them via
+//! `SharedVecRtdbWriter::drain_commands`. The Redis TODO queue still carries
+//! every command as fallback and audit trail.
+//!
+//! # Point ID Tables
+//!
+//! Slots are allocated in registration order, so a slot's position says
+//! nothing about its point ID. The writer records the point ID of every
+//! registered slot in the point ID tables (indexed like the slot areas),
+//! and readers build their point → slot mapping from them: readers,
+//! snapshots and batch reads all address points by their real IDs.
+//!
+//! # Layout Generation
+//!
+//! The InstanceIndex and ChannelIndex arrays form an append-only
+//! registration log. The writer bumps `SharedHeader::layout_generation`
+//! after each registration; readers compare it on access and index only
+//! the entries appended since.
+//!
+//! A restarted writer recreates the log from scratch and stamps a new
+//! `SharedHeader::writer_epoch`. Readers that see a different epoch, or a
+//! generation or count below what they indexed, rebuild their index from
+//! the start instead of appending to stale layouts.
+//!
+//! # History Rings
+//!
+//! Channels registered with `register_channel_with_history` get a
+//! fixed-depth (value, timestamp) ring per point of the selected types.
+//! Every `set_channel` appends to the point's ring, and readers fetch the
+//! last N samples or the samples since a timestamp without touching Redis.
+//!
+//! # Warm-start Snapshots
+//!
+//! `SharedVecRtdbWriter::snapshot` captures every written slot by point
+//! identity; after the next `open` and registration, `restore_snapshot`
+//! writes them back with `point_quality::RESTORED` (see `shared_snapshot`).
+//!
+//! # Batch Reads
+//!
+//! `SharedVecRtdbReader::read_batch` gathers the points of many instances
+//! or channels into `PointColumns` under one index snapshot; the batch
+//! HTTP endpoints encode them in the columnar format of `shared_batch`.
 
-use crate::vec_impl::PointSlot;
+use crate::shared_batch::{BatchReadTarget, PointColumns};
+use crate::shared_snapshot::{point_quality, RtdbSnapshot, SnapshotArea, SnapshotRecord};
+use crate::vec_impl::{PointSlot, PointSnapshot};
 use anyhow::{Context, Result};
+use arc_swap::ArcSwap;
 use memmap2::{Mmap, MmapMut, MmapOptions};
+use parking_lot::Mutex;
 use rustc_hash::FxHashMap;
 use std::fs::OpenOptions;
 use std::path::{Path, PathBuf};
 use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+use std::sync::Arc;
 use tracing::{debug, info, warn};
 
 // ========== Constants ==========
@@ -48,6 +129,16 @@ use tracing::{debug, info, warn};
 /// Magic number for validation: "VOLTAGE_" in ASCII
 pub const SHARED_MAGIC: u64 = 0x564F4C544147455F;
 
+/// Version of the shared memory file format
+///
+/// History:
+/// - 2: channel area
+/// - 3: versioned header with segment dimensions, 48-byte ChannelIndex
+///   (change ring, command rings and history rings included)
+/// - 4: point ID tables
+/// - 5: writer epoch
+pub const SHARED_LAYOUT_VERSION: u32 = 5;
+
 /// Default shared memory file path (Docker tmpfs mount point)
 /// This constant is kept for backward compatibility.
 /// Use `default_shm_path()` for intelligent path selection.
@@ -89,10 +180,10 @@ pub fn default_shm_path() -> PathBuf {
 
 // ========== SharedHeader ==========
 
-/// Shared memory header (64 bytes, cache-line aligned)
+/// Shared memory header (128 bytes, cache-line aligned)
 ///
 /// Located at offset 0 of the shared memory file.
-/// Contains metadata and synchronization fields.
+/// Contains metadata, segment dimensions and synchronization fields.
 #[repr(C, align(64))]
 pub struct SharedHeader {
     /// Magic number for validation (0x564F4C544147455F = "VOLTAGE_")
@@ -113,8 +204,35 @@ pub struct SharedHeader {
     pub last_update_ts: AtomicU64,
     /// Writer heartbeat timestamp (for liveness check)
     pub writer_heartbeat: AtomicU64,
+    /// Bumped after every instance/channel registration
+    ///
+    /// Readers compare it with the generation of their index and index only
+    /// the registration log entries appended since.
+    pub layout_generation: AtomicU64,
+    /// File format version (`SHARED_LAYOUT_VERSION`)
+    pub layout_version: u32,
+    /// `SharedConfig::max_instances` the segment was created with
+    pub max_instances: u32,
+    /// `SharedConfig::max_points_per_instance` the segment was created with
+    pub max_points_per_instance: u32,
+    /// `SharedConfig::max_channels` the segment was created with
+    pub max_channels: u32,
+    /// `SharedConfig::max_points_per_channel` the segment was created with
+    pub max_points_per_channel: u32,
+    /// `SharedConfig::change_ring_capacity` the segment was created with
+    pub change_ring_capacity: u32,
+    /// `SharedConfig::command_ring_capacity` the segment was created with
+    pub command_ring_capacity: u32,
+    /// `SharedConfig::history_capacity` the segment was created with
+    pub history_capacity: u64,
+    /// Nonce stamped by each writer `open` (0 while the writer initializes)
+    ///
+    /// Changes whenever the writer restarts and rebuilds the registration log.
+    pub writer_epoch: AtomicU64,
 }
 
+const _: () = assert!(std::mem::size_of::<SharedHeader>() == 128);
+
 impl SharedHeader {
     /// Check if the header is valid
     pub fn is_valid(&self) -> bool {
@@ -125,6 +243,47 @@ impl SharedHeader {
     pub fn is_initialized(&self) -> bool {
         self.initialized.load(Ordering::Acquire) == 1
     }
+
+    /// Check that the segment was created with this layout version and `config`
+    ///
+    /// Every offset is derived from the config, so opening a segment with
+    /// other limits would read the wrong slots.
+    pub fn check_layout(&self, config: &SharedConfig) -> Result<()> {
+        if !self.is_valid() {
+            anyhow::bail!(
+                "Invalid magic: expected {:016x}, got {:016x}",
+                SHARED_MAGIC,
+                self.magic
+            );
+        }
+        if self.layout_version != SHARED_LAYOUT_VERSION {
+            anyhow::bail!(
+                "Unsupported shared memory layout version {} (expected {})",
+                self.layout_version,
+                SHARED_LAYOUT_VERSION
+            );
+        }
+        let found = [
+            self.max_instances as u64,
+            self.max_points_per_instance as u64,
+            self.max_channels as u64,
+            self.max_points_per_channel as u64,
+            self.change_ring_capacity as u64,
+            self.command_ring_capacity as u64,
+            self.history_capacity,
+        ];
+        for (found, (name, expected)) in found.into_iter().zip(config.dimensions()) {
+            if found != expected {
+                anyhow::bail!(
+                    "Shared memory {} mismatch: segment has {}, config has {}",
+                    name,
+                    found,
+                    expected
+                );
+            }
+        }
+        Ok(())
+    }
 }
 
 // ========== InstanceIndex ==========
@@ -166,10 +325,17 @@ pub struct ChannelIndex {
     pub point_offsets: [u32; 4],
     /// Total points across all types
     pub total_points: u32,
-    /// Reserved for future use
-    pub _reserved: [u32; 3],
+    /// History ring depth for each type: [T, S, C, A] (0 = no history)
+    pub history_depths: [u16; 4],
+    /// Offset to the channel's first history ring (relative to history_offset)
+    pub history_offset: u32,
+    /// Padding to 48 bytes
+    pub _reserved: u32,
 }
 
+const _: () = assert!(std::mem::size_of::<InstanceIndex>() == 48);
+const _: () = assert!(std::mem::size_of::<ChannelIndex>() == 48);
+
 impl ChannelIndex {
     /// Point type indices
     pub const TELEMETRY: usize = 0;
@@ -189,6 +355,485 @@ impl ChannelIndex {
     }
 }
 
+// ========== Change Ring ==========
+
+/// Change ring header (64 bytes, cache-line aligned)
+///
+/// Located right after the channel slot area (see `SharedConfig::change_ring_offset`).
+#[repr(C, align(64))]
+pub struct ChangeRingHeader {
+    /// Next sequence number to be claimed by a writer (monotonic)
+    pub head: AtomicU64,
+    /// Number of entries in the ring (power of two, 0 = ring disabled)
+    pub capacity: u64,
+    /// Reserved for future use
+    pub _reserved: [u64; 6],
+}
+
+/// Change ring entry (16 bytes)
+///
+/// `seq` holds `sequence + 1` once the entry is published (0 = empty or
+/// being rewritten), so readers can detect entries that were overwritten.
+#[repr(C)]
+pub struct ChangeEntry {
+    /// Published sequence + 1
+    pub seq: AtomicU64,
+    /// Absolute byte offset of the changed PointSlot in the shared memory file
+    pub slot_offset: AtomicU64,
+}
+
+/// A single change read from the ring
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ChangeEvent {
+    /// Sequence number of this change
+    pub seq: u64,
+    /// Absolute byte offset of the changed slot (see `SharedVecRtdbReader::read_slot`)
+    pub slot_offset: usize,
+}
+
+/// Position in the change ring, returned by `drain_changes`
+///
+/// Pass the returned cursor to the next `drain_changes` call; start from
+/// `SharedVecRtdbReader::change_cursor`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ChangeCursor {
+    /// Sequence of the next change to read
+    pub next_seq: u64,
+    /// `SharedHeader::writer_epoch` the sequence belongs to
+    pub epoch: u64,
+    /// Number of changes lost because the ring wrapped past the cursor or
+    /// the writer restarted
+    ///
+    /// Consumers seeing `lost > 0` should fall back to a full scan once.
+    pub lost: u64,
+}
+
+/// Default number of change ring entries (1MB of ring at 16 bytes/entry)
+pub const DEFAULT_CHANGE_RING_CAPACITY: usize = 65536;
+
+// ========== Command Ring ==========
+
+/// Per-channel command ring header (64 bytes, cache-line aligned)
+///
+/// One ring per ChannelIndex position, in the command ring area after the
+/// change ring (see `SharedConfig::command_ring_offset`). Producers (modsrv)
+/// claim sequences from `head`; the channel's single consumer (comsrv)
+/// advances `tail`. A full ring rejects pushes instead of overwriting.
+///
+/// A producer that dies between claiming a sequence and stamping its entry
+/// would block the ring. The consumer skips such an entry once it has stayed
+/// unpublished for `COMMAND_STALL_TIMEOUT_MS`; a producer that resumes after
+/// that fails to stamp and reports the push as failed.
+#[repr(C, align(64))]
+pub struct CommandRingHeader {
+    /// Next sequence to be claimed by a producer (monotonic)
+    pub head: AtomicU64,
+    /// Next sequence to be consumed (monotonic, consumer-owned)
+    pub tail: AtomicU64,
+    /// Number of entries (power of two, 0 = ring not initialized)
+    pub capacity: AtomicU64,
+    /// Unpublished sequence + 1 the consumer is waiting on (0 = none, consumer-owned)
+    pub stall_seq: AtomicU64,
+    /// When the consumer first saw `stall_seq` unpublished (ms, consumer-owned)
+    pub stall_since_ms: AtomicU64,
+    /// Reserved for future use
+    pub _reserved: [u64; 3],
+}
+
+/// Command ring entry (32 bytes)
+///
+/// `seq` holds `sequence + 1` once the payload is written, so the consumer
+/// only reads entries whose stamp matches its cursor. A stamp with
+/// `COMMAND_SKIPPED` set marks a sequence the consumer gave up on.
+#[repr(C)]
+pub struct CommandEntry {
+    /// Published sequence + 1
+    pub seq: AtomicU64,
+    /// Command value (`f64::to_bits`)
+    pub value: AtomicU64,
+    /// Command timestamp in milliseconds
+    pub timestamp_ms: AtomicU64,
+    /// Channel point ID
+    pub point_id: AtomicU32,
+    /// ChannelIndex point type index (CONTROL or ADJUSTMENT)
+    pub point_type: AtomicU32,
+}
+
+/// A downlink command read from or pushed to a channel's command ring
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct RingCommand {
+    /// Channel point type (Control or Adjustment)
+    pub point_type: voltage_model::PointType,
+    /// Channel point ID
+    pub point_id: u32,
+    /// Command value
+    pub value: f64,
+    /// Command timestamp in milliseconds
+    pub timestamp_ms: i64,
+}
+
+/// Default number of command ring entries per channel
+pub const DEFAULT_COMMAND_RING_CAPACITY: usize = 64;
+
+/// How long a claimed but unpublished command entry may block the ring
+pub const COMMAND_STALL_TIMEOUT_MS: u64 = 500;
+
+/// `CommandEntry::seq` flag for a sequence skipped by the consumer
+const COMMAND_SKIPPED: u64 = 1 << 63;
+
+/// Borrowed view of one channel's command ring inside a mapping
+struct CommandRing<'a> {
+    header: &'a CommandRingHeader,
+    base: *const CommandEntry,
+    capacity: u64,
+}
+
+impl CommandRing<'_> {
+    /// Locate the ring at `position`, or None if it is outside the mapping
+    /// or was not initialized with `config.command_ring_capacity` entries
+    ///
+    /// # Safety
+    /// `mmap_ptr` must point to a mapping of `mmap_len` bytes that outlives the view.
+    unsafe fn at<'a>(
+        mmap_ptr: *const u8,
+        mmap_len: usize,
+        config: &SharedConfig,
+        position: usize,
+    ) -> Option<CommandRing<'a>> {
+        let capacity = config.command_ring_capacity;
+        if capacity == 0 || position >= config.max_channels {
+            return None;
+        }
+        let offset = config.command_ring_offset() + position * config.command_ring_stride();
+        if offset + config.command_ring_stride() > mmap_len {
+            return None;
+        }
+        let header = &*(mmap_ptr.add(offset) as *const CommandRingHeader);
+        if header.capacity.load(Ordering::Acquire) != capacity as u64 {
+            return None;
+        }
+        Some(CommandRing {
+            header,
+            base: mmap_ptr.add(offset + std::mem::size_of::<CommandRingHeader>())
+                as *const CommandEntry,
+            capacity: capacity as u64,
+        })
+    }
+
+    #[inline]
+    fn entry(&self, seq: u64) -> &CommandEntry {
+        unsafe { &*self.base.add((seq & (self.capacity - 1)) as usize) }
+    }
+
+    /// Lock-free MPSC push; false if the ring is full
+    fn push(&self, command: &RingCommand) -> bool {
+        let mut head = self.header.head.load(Ordering::Relaxed);
+        loop {
+            let tail = self.header.tail.load(Ordering::Acquire);
+            if head.wrapping_sub(tail) >= self.capacity {
+                return false;
+            }
+            match self.header.head.compare_exchange_weak(
+                head,
+                head + 1,
+                Ordering::AcqRel,
+                Ordering::Relaxed,
+            ) {
+                Ok(_) => break,
+                Err(current) => head = current,
+            }
+        }
+
+        // The slot is free: the consumer released it by advancing tail past head - capacity
+        let entry = self.entry(head);
+        entry
+            .value
+            .store(command.value.to_bits(), Ordering::Relaxed);
+        entry
+            .timestamp_ms
+            .store(command.timestamp_ms as u64, Ordering::Relaxed);
+        entry.point_id.store(command.point_id, Ordering::Relaxed);
+        entry.point_type.store(
+            ChannelIndex::point_type_to_index(command.point_type) as u32,
+            Ordering::Relaxed,
+        );
+        self.publish(head)
+    }
+
+    /// Stamp the entry of a claimed sequence as published
+    ///
+    /// Fails if the consumer skipped the sequence meanwhile: the entry then
+    /// no longer holds the stamp of the previous lap (0 on the first one).
+    fn publish(&self, seq: u64) -> bool {
+        let entry = self.entry(seq);
+        let previous = (seq + 1).saturating_sub(self.capacity);
+        let current = entry.seq.load(Ordering::Acquire);
+        current & !COMMAND_SKIPPED == previous
+            && entry
+                .seq
+                .compare_exchange(current, seq + 1, Ordering::Release, Ordering::Relaxed)
+                .is_ok()
+    }
+
+    /// Pop up to `max` published commands in order (single consumer)
+    fn drain<F: FnMut(RingCommand)>(&self, max: usize, f: F) -> usize {
+        self.drain_with_timeout(max, COMMAND_STALL_TIMEOUT_MS, f)
+    }
+
+    /// `drain` with an explicit stall timeout for claimed, unpublished entries
+    fn drain_with_timeout<F: FnMut(RingCommand)>(
+        &self,
+        max: usize,
+        stall_timeout_ms: u64,
+        mut f: F,
+    ) -> usize {
+        let mut tail = self.header.tail.load(Ordering::Relaxed);
+        let mut count = 0;
+        while count < max {
+            let entry = self.entry(tail);
+            let stamp = entry.seq.load(Ordering::Acquire);
+            if stamp != tail + 1 {
+                if !self.skip_stalled(entry, stamp, tail, stall_timeout_ms) {
+                    break;
+                }
+                tail += 1;
+                self.header.tail.store(tail, Ordering::Release);
+                continue;
+            }
+            let raw_type = entry.point_type.load(Ordering::Relaxed);
+            let point_type = match raw_type as usize {
+                ChannelIndex::TELEMETRY => Some(voltage_model::PointType::Telemetry),
+                ChannelIndex::SIGNAL => Some(voltage_model::PointType::Signal),
+                ChannelIndex::CONTROL => Some(voltage_model::PointType::Control),
+                ChannelIndex::ADJUSTMENT => Some(voltage_model::PointType::Adjustment),
+                _ => None,
+            };
+            let command = point_type.map(|point_type| RingCommand {
+                point_type,
+                point_id: entry.point_id.load(Ordering::Relaxed),
+                value: f64::from_bits(entry.value.load(Ordering::Relaxed)),
+                timestamp_ms: entry.timestamp_ms.load(Ordering::Relaxed) as i64,
+            });
+            tail += 1;
+            // Release the slot only after the payload has been read
+            self.header.tail.store(tail, Ordering::Release);
+            match command {
+                Some(command) => {
+                    f(command);
+                    count += 1;
+                },
+                None => warn!(
+                    "Command ring: dropped command {} with unknown point type {}",
+                    tail - 1,
+                    raw_type
+                ),
+            }
+        }
+        count
+    }
+
+    /// Whether the unpublished entry at `tail` should be skipped
+    ///
+    /// True once a producer has claimed the sequence and left it unpublished
+    /// for `stall_timeout_ms`; the entry is then stamped as skipped so the
+    /// producer's late publish fails.
+    fn skip_stalled(
+        &self,
+        entry: &CommandEntry,
+        stamp: u64,
+        tail: u64,
+        stall_timeout_ms: u64,
+    ) -> bool {
+        if self.header.head.load(Ordering::Acquire) <= tail {
+            return false; // empty
+        }
+        let now = timestamp_ms();
+        if self.header.stall_seq.load(Ordering::Relaxed) != tail + 1 {
+            self.header.stall_seq.store(tail + 1, Ordering::Relaxed);
+            self.header.stall_since_ms.store(now, Ordering::Relaxed);
+        }
+        let since = self.header.stall_since_ms.load(Ordering::Relaxed);
+        if now.saturating_sub(since) < stall_timeout_ms {
+            return false;
+        }
+        // Fails if the producer published meanwhile; the next drain reads it
+        if entry
+            .seq
+            .compare_exchange(
+                stamp,
+                (tail + 1) | COMMAND_SKIPPED,
+                Ordering::AcqRel,
+                Ordering::Acquire,
+            )
+            .is_err()
+        {
+            return false;
+        }
+        warn!(
+            "Command ring: skipped command {} left unpublished for {} ms",
+            tail,
+            now - since
+        );
+        true
+    }
+
+    /// Reset to an empty ring with the configured capacity (writer only)
+    fn init(header: &CommandRingHeader, capacity: usize) {
+        header.head.store(0, Ordering::Relaxed);
+        header.tail.store(0, Ordering::Relaxed);
+        header.stall_seq.store(0, Ordering::Relaxed);
+        header.capacity.store(capacity as u64, Ordering::Release);
+    }
+}
+
+// ========== History Ring ==========
+
+/// Per-point history ring header (24 bytes, one entry wide)
+///
+/// Rings live in the history area after the command rings (see
+/// `SharedConfig::history_offset`). A channel's rings are allocated at
+/// registration, type by type in slot order, starting at the channel's
+/// `ChannelIndex::history_offset`. The writer is the only producer.
+#[repr(C)]
+pub struct HistoryRingHeader {
+    /// Next sequence to be written (monotonic)
+    pub head: AtomicU64,
+    /// Number of entries (power of two, 0 = ring not initialized)
+    pub depth: AtomicU64,
+    /// Reserved for future use
+    pub _reserved: u64,
+}
+
+/// History ring entry (24 bytes)
+///
+/// `seq` holds `sequence + 1` once the sample is written (0 = being
+/// rewritten), so readers skip samples overwritten while reading.
+#[repr(C)]
+pub struct HistoryEntry {
+    /// Published sequence + 1
+    pub seq: AtomicU64,
+    /// Sample value (`f64::to_bits`)
+    pub value: AtomicU64,
+    /// Sample timestamp in milliseconds
+    pub timestamp_ms: AtomicU64,
+}
+
+/// A sample read from a point's history ring
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct HistorySample {
+    /// Engineering value
+    pub value: f64,
+    /// Timestamp in milliseconds
+    pub timestamp_ms: u64,
+}
+
+/// Default number of history area entries (24MB, only touched pages use RAM)
+pub const DEFAULT_HISTORY_CAPACITY: usize = 1 << 20;
+
+/// Maximum history depth per point
+pub const MAX_HISTORY_DEPTH: usize = 1 << 15;
+
+/// Borrowed view of one point's history ring inside a mapping
+struct HistoryRing<'a> {
+    header: &'a HistoryRingHeader,
+    base: *const HistoryEntry,
+    depth: u64,
+}
+
+impl HistoryRing<'_> {
+    /// Bytes used by a ring of `depth` entries (header + entries)
+    #[inline]
+    fn stride(depth: usize) -> usize {
+        (depth + 1) * std::mem::size_of::<HistoryEntry>()
+    }
+
+    /// Requested depth rounded up to a power of two (0 stays 0)
+    fn normalize_depth(depth: usize) -> usize {
+        if depth == 0 {
+            0
+        } else {
+            depth.min(MAX_HISTORY_DEPTH).next_power_of_two()
+        }
+    }
+
+    /// Locate the ring at `ring_offset` (relative to the history area), or
+    /// None if it is outside the mapping or was not initialized with `depth`
+    ///
+    /// # Safety
+    /// `mmap_ptr` must point to a mapping of `mmap_len` bytes that outlives the view.
+    unsafe fn at<'a>(
+        mmap_ptr: *const u8,
+        mmap_len: usize,
+        config: &SharedConfig,
+        ring_offset: usize,
+        depth: usize,
+    ) -> Option<HistoryRing<'a>> {
+        let offset = config.history_offset() + ring_offset;
+        if depth == 0 || offset + Self::stride(depth) > mmap_len {
+            return None;
+        }
+        let header = &*(mmap_ptr.add(offset) as *const HistoryRingHeader);
+        if header.depth.load(Ordering::Acquire) != depth as u64 {
+            return None;
+        }
+        Some(HistoryRing {
+            header,
+            base: mmap_ptr.add(offset + std::mem::size_of::<HistoryRingHeader>())
+                as *const HistoryEntry,
+            depth: depth as u64,
+        })
+    }
+
+    #[inline]
+    fn entry(&self, seq: u64) -> &HistoryEntry {
+        unsafe { &*self.base.add((seq & (self.depth - 1)) as usize) }
+    }
+
+    /// Append a sample, overwriting the oldest one when full
+    #[inline]
+    fn push(&self, value: f64, timestamp_ms: u64) {
+        let seq = self.header.head.fetch_add(1, Ordering::Relaxed);
+        let entry = self.entry(seq);
+
+        // Invalidate, write payload, then stamp with seq + 1
+        entry.seq.store(0, Ordering::Relaxed);
+        std::sync::atomic::fence(Ordering::Release);
+        entry.value.store(value.to_bits(), Ordering::Relaxed);
+        entry.timestamp_ms.store(timestamp_ms, Ordering::Relaxed);
+        entry.seq.store(seq + 1, Ordering::Release);
+    }
+
+    /// Up to the last `n` samples, oldest first
+    fn read_last(&self, n: usize) -> Vec<HistorySample> {
+        let head = self.header.head.load(Ordering::Acquire);
+        let count = (n as u64).min(self.depth).min(head);
+        let mut samples = Vec::with_capacity(count as usize);
+        for seq in head - count..head {
+            let entry = self.entry(seq);
+            if entry.seq.load(Ordering::Acquire) != seq + 1 {
+                continue;
+            }
+            let value = f64::from_bits(entry.value.load(Ordering::Relaxed));
+            let timestamp_ms = entry.timestamp_ms.load(Ordering::Relaxed);
+            // Payload loads must complete before the stamp re-check
+            std::sync::atomic::fence(Ordering::Acquire);
+            if entry.seq.load(Ordering::Relaxed) == seq + 1 {
+                samples.push(HistorySample {
+                    value,
+                    timestamp_ms,
+                });
+            }
+        }
+        samples
+    }
+
+    /// Reset to an empty ring of `depth` entries (writer only)
+    fn init(header: &HistoryRingHeader, depth: usize) {
+        header.head.store(0, Ordering::Relaxed);
+        header.depth.store(depth as u64, Ordering::Release);
+    }
+}
+
 // ========== SharedConfig ==========
 
 /// Configuration for shared memory
@@ -204,6 +849,12 @@ pub struct SharedConfig {
     pub max_channels: usize,
     /// Maximum points per channel (all types combined)
     pub max_points_per_channel: usize,
+    /// Number of change ring entries (power of two, 0 disables the ring)
+    pub change_ring_capacity: usize,
+    /// Command ring entries per channel (power of two, 0 disables the rings)
+    pub command_ring_capacity: usize,
+    /// Entries in the history area shared by all history rings (0 disables history)
+    pub history_capacity: usize,
 }
 
 impl Default for SharedConfig {
@@ -217,6 +868,9 @@ impl Default for SharedConfig {
             max_points_per_instance: 65536,
             max_channels: 65536,
             max_points_per_channel: 65536,
+            change_ring_capacity: DEFAULT_CHANGE_RING_CAPACITY,
+            command_ring_capacity: DEFAULT_COMMAND_RING_CAPACITY,
+            history_capacity: DEFAULT_HISTORY_CAPACITY,
         }
     }
 }
@@ -252,18 +906,186 @@ impl SharedConfig {
         self
     }
 
-    /// Calculate total file size needed (includes Channel area in v2)
+    /// Create config with custom change ring capacity
+    ///
+    /// Rounded up to the next power of two; 0 disables the change ring.
+    pub fn with_change_ring_capacity(mut self, capacity: usize) -> Self {
+        self.change_ring_capacity = if capacity == 0 {
+            0
+        } else {
+            capacity.next_power_of_two()
+        };
+        self
+    }
+
+    /// Create config with custom per-channel command ring capacity
+    ///
+    /// Rounded up to the next power of two; 0 disables the command rings.
+    pub fn with_command_ring_capacity(mut self, capacity: usize) -> Self {
+        self.command_ring_capacity = if capacity == 0 {
+            0
+        } else {
+            capacity.next_power_of_two()
+        };
+        self
+    }
+
+    /// Create config with custom history area capacity (entries, 0 disables history)
+    ///
+    /// Each history ring of depth D uses D + 1 entries.
+    pub fn with_history_capacity(mut self, capacity: usize) -> Self {
+        self.history_capacity = capacity;
+        self
+    }
+
+    /// Load the configuration of an existing segment from its header
+    ///
+    /// For offline tools that attach to the segment comsrv created: the
+    /// dimensions are taken from the writer's header instead of being
+    /// re-derived, after checking magic and layout version.
+    pub fn from_segment(path: impl Into<PathBuf>) -> Result<Self> {
+        let path = path.into();
+        let file = OpenOptions::new()
+            .read(true)
+            .open(&path)
+            .with_context(|| format!("Failed to open shared memory file: {:?}", path))?;
+        let mmap = unsafe {
+            MmapOptions::new()
+                .map(&file)
+                .context("Failed to memory map file")?
+        };
+        if mmap.len() < std::mem::size_of::<SharedHeader>() {
+            anyhow::bail!(
+                "File size {} too small for the shared memory header",
+                mmap.len()
+            );
+        }
+        // SAFETY: the mapping is page-aligned and holds a full header
+        let header = unsafe { &*(mmap.as_ptr() as *const SharedHeader) };
+        let config = Self {
+            path,
+            max_instances: header.max_instances as usize,
+            max_points_per_instance: header.max_points_per_instance as usize,
+            max_channels: header.max_channels as usize,
+            max_points_per_channel: header.max_points_per_channel as usize,
+            change_ring_capacity: header.change_ring_capacity as usize,
+            command_ring_capacity: header.command_ring_capacity as usize,
+            history_capacity: header.history_capacity as usize,
+        };
+        config.check_segment(&mmap)?;
+        Ok(config)
+    }
+
+    /// Segment dimensions stamped into the header, in `SharedHeader` field order
+    fn dimensions(&self) -> [(&'static str, u64); 7] {
+        [
+            ("max_instances", self.max_instances as u64),
+            (
+                "max_points_per_instance",
+                self.max_points_per_instance as u64,
+            ),
+            ("max_channels", self.max_channels as u64),
+            ("max_points_per_channel", self.max_points_per_channel as u64),
+            ("change_ring_capacity", self.change_ring_capacity as u64),
+            ("command_ring_capacity", self.command_ring_capacity as u64),
+            ("history_capacity", self.history_capacity as u64),
+        ]
+    }
+
+    /// Check a mapped segment against this config before using its offsets
+    ///
+    /// Validates the header (magic, layout version, dimensions) and that the
+    /// file is large enough for every area the config addresses.
+    pub fn check_segment(&self, segment: &[u8]) -> Result<()> {
+        if segment.len() < std::mem::size_of::<SharedHeader>() {
+            anyhow::bail!(
+                "File size {} too small for the shared memory header",
+                segment.len()
+            );
+        }
+        // SAFETY: the mapping is page-aligned and holds a full header
+        let header = unsafe { &*(segment.as_ptr() as *const SharedHeader) };
+        header.check_layout(self)?;
+        if segment.len() < self.calculate_file_size() {
+            anyhow::bail!(
+                "File size {} too small, expected {} bytes",
+                segment.len(),
+                self.calculate_file_size()
+            );
+        }
+        Ok(())
+    }
+
+    /// Calculate total file size needed (channel area, rings, history area
+    /// and point ID tables)
     pub fn calculate_file_size(&self) -> usize {
-        let header_size = std::mem::size_of::<SharedHeader>();
-        // Instance area
-        let inst_index_size = self.max_instances * std::mem::size_of::<InstanceIndex>();
-        let inst_data_size =
-            self.max_instances * self.max_points_per_instance * std::mem::size_of::<PointSlot>();
-        // Channel area
-        let ch_index_size = self.max_channels * std::mem::size_of::<ChannelIndex>();
-        let ch_data_size =
-            self.max_channels * self.max_points_per_channel * std::mem::size_of::<PointSlot>();
-        header_size + inst_index_size + inst_data_size + ch_index_size + ch_data_size
+        self.channel_point_ids_offset()
+            + self.max_channels * self.max_points_per_channel * std::mem::size_of::<u32>()
+    }
+
+    /// End of the history area (command ring end if history is disabled)
+    fn history_end(&self) -> usize {
+        if self.history_capacity == 0 {
+            return self.command_ring_end();
+        }
+        self.history_offset() + self.history_capacity * std::mem::size_of::<HistoryEntry>()
+    }
+
+    /// Offset of the instance point ID table (64-byte aligned, after the history area)
+    ///
+    /// One u32 point ID per instance slot, indexed like the instance slot area.
+    pub fn instance_point_ids_offset(&self) -> usize {
+        self.history_end().div_ceil(64) * 64
+    }
+
+    /// Offset of the channel point ID table (after the instance point IDs)
+    ///
+    /// One u32 point ID per channel slot, indexed like the channel slot area.
+    pub fn channel_point_ids_offset(&self) -> usize {
+        self.instance_point_ids_offset()
+            + self.max_instances * self.max_points_per_instance * std::mem::size_of::<u32>()
+    }
+
+    /// End of the command ring area (change ring end if the rings are disabled)
+    fn command_ring_end(&self) -> usize {
+        if self.command_ring_capacity == 0 {
+            return self.change_ring_end();
+        }
+        self.command_ring_offset() + self.max_channels * self.command_ring_stride()
+    }
+
+    /// Calculate history area offset (64-byte aligned, after the command rings)
+    pub fn history_offset(&self) -> usize {
+        self.command_ring_end().div_ceil(64) * 64
+    }
+
+    /// End of the change ring area (header + entries)
+    fn change_ring_end(&self) -> usize {
+        self.change_ring_offset()
+            + std::mem::size_of::<ChangeRingHeader>()
+            + self.change_ring_capacity * std::mem::size_of::<ChangeEntry>()
+    }
+
+    /// Calculate command ring area offset (64-byte aligned, after the change ring)
+    pub fn command_ring_offset(&self) -> usize {
+        let align = std::mem::align_of::<CommandRingHeader>();
+        self.change_ring_end().div_ceil(align) * align
+    }
+
+    /// Bytes per channel in the command ring area (64-byte aligned)
+    pub fn command_ring_stride(&self) -> usize {
+        let size = std::mem::size_of::<CommandRingHeader>()
+            + self.command_ring_capacity * std::mem::size_of::<CommandEntry>();
+        let align = std::mem::align_of::<CommandRingHeader>();
+        size.div_ceil(align) * align
+    }
+
+    /// Calculate change ring header offset (64-byte aligned, after channel slots)
+    pub fn change_ring_offset(&self) -> usize {
+        let ch_data_end = self.channel_data_offset()
+            + self.max_channels * self.max_points_per_channel * std::mem::size_of::<PointSlot>();
+        let align = std::mem::align_of::<ChangeRingHeader>();
+        ch_data_end.div_ceil(align) * align
     }
 
     /// Calculate channel index offset
@@ -292,6 +1114,29 @@ pub fn timestamp_ms() -> u64 {
         .unwrap_or(0)
 }
 
+/// Fresh non-zero writer epoch (wall clock nanoseconds mixed with the PID)
+fn new_writer_epoch() -> u64 {
+    let nanos = std::time::SystemTime::now()
+        .duration_since(std::time::UNIX_EPOCH)
+        .map(|d| d.as_nanos() as u64)
+        .unwrap_or(0);
+    (nanos ^ ((std::process::id() as u64) << 48)).max(1)
+}
+
+/// Build a point_id → slot index mapping (u32::MAX = not registered)
+///
+/// Returns the mapping and the largest point ID (0 for no points).
+fn point_mapping(points: &[u32]) -> (Box<[u32]>, u32) {
+    let Some(&max_id) = points.iter().max() else {
+        return (Box::new([]), 0);
+    };
+    let mut mapping = vec![u32::MAX; max_id as usize + 1];
+    for (slot_idx, &point_id) in points.iter().enumerate() {
+        mapping[point_id as usize] = slot_idx as u32;
+    }
+    (mapping.into_boxed_slice(), max_id)
+}
+
 // ========== InstanceLayout ==========
 
 /// Per-instance layout with Vec direct indexing for O(1) point lookup
@@ -389,25 +1234,49 @@ struct ChannelLayout {
     type_mappings: [Box<[u32]>; 4],
     /// Max point_id for each type
     max_point_ids: [u32; 4],
+    /// First history ring of each type (relative to history_offset)
+    history_bases: [usize; 4],
+    /// History ring depth of each type (0 = no history)
+    history_depths: [usize; 4],
 }
 
 impl ChannelLayout {
-    /// Get slot offset for a point in this channel
-    ///
-    /// Note: type_mappings stores slot indices, not byte offsets.
-    /// This method returns the final byte offset.
+    /// Get the slot index of a point within its type
     #[inline]
-    fn get_slot_offset(&self, type_idx: usize, point_id: u32) -> Option<usize> {
+    fn slot_index(&self, type_idx: usize, point_id: u32) -> Option<usize> {
         if type_idx >= 4 || point_id > self.max_point_ids[type_idx] {
             return None;
         }
-        // Get slot index from mapping
         let slot_idx = *self.type_mappings[type_idx].get(point_id as usize)?;
         if slot_idx == u32::MAX {
             return None;
         }
+        Some(slot_idx as usize)
+    }
+
+    /// Get slot offset for a point in this channel
+    ///
+    /// Note: type_mappings stores slot indices, not byte offsets.
+    /// This method returns the final byte offset.
+    #[inline]
+    fn get_slot_offset(&self, type_idx: usize, point_id: u32) -> Option<usize> {
+        let slot_idx = self.slot_index(type_idx, point_id)?;
         // Calculate byte offset: base + (slot_index * slot_size)
-        Some(self.type_bases[type_idx] + (slot_idx as usize) * std::mem::size_of::<PointSlot>())
+        Some(self.type_bases[type_idx] + slot_idx * std::mem::size_of::<PointSlot>())
+    }
+
+    /// Get the history ring of a point: (offset relative to history_offset, depth)
+    #[inline]
+    fn history_ring(&self, type_idx: usize, point_id: u32) -> Option<(usize, usize)> {
+        let depth = *self.history_depths.get(type_idx)?;
+        if depth == 0 {
+            return None;
+        }
+        let slot_idx = self.slot_index(type_idx, point_id)?;
+        Some((
+            self.history_bases[type_idx] + slot_idx * HistoryRing::stride(depth),
+            depth,
+        ))
     }
 }
 
@@ -446,6 +1315,8 @@ pub struct SharedVecRtdbWriter {
     next_channel_idx: usize,
     /// Next available channel slot offset (bytes, relative to channel_data_offset)
     next_channel_slot_offset: usize,
+    /// Next available history ring offset (bytes, relative to history_offset)
+    next_history_offset: usize,
 }
 
 impl SharedVecRtdbWriter {
@@ -458,6 +1329,13 @@ impl SharedVecRtdbWriter {
     /// * `Ok(Self)` - Writer instance
     /// * `Err` - If file creation or mapping fails
     pub fn open(config: &SharedConfig) -> Result<Self> {
+        if let Some((name, value)) = config.dimensions()[..6]
+            .iter()
+            .find(|(_, value)| *value > u32::MAX as u64)
+        {
+            anyhow::bail!("Shared memory {} too large: {}", name, value);
+        }
+
         // Ensure parent directory exists
         if let Some(parent) = config.path.parent() {
             std::fs::create_dir_all(parent)
@@ -501,6 +1379,7 @@ impl SharedVecRtdbWriter {
             channel_layouts: FxHashMap::default(),
             next_channel_idx: 0,
             next_channel_slot_offset: 0,
+            next_history_offset: 0,
         };
 
         // Initialize header
@@ -530,6 +1409,20 @@ impl SharedVecRtdbWriter {
             header
                 .writer_heartbeat
                 .store(timestamp_ms(), Ordering::Release);
+            header.layout_generation.store(0, Ordering::Release);
+            header.layout_version = SHARED_LAYOUT_VERSION;
+            header
+                .writer_epoch
+                .store(new_writer_epoch(), Ordering::Release);
+        }
+        self.stamp_dimensions();
+
+        // Initialize change ring header (entries are zeroed by truncate)
+        {
+            let capacity = self.config.change_ring_capacity as u64;
+            let ring = self.change_ring_header_mut();
+            ring.head.store(0, Ordering::Release);
+            ring.capacity = capacity;
         }
 
         // Flush to ensure visibility
@@ -546,6 +1439,19 @@ impl SharedVecRtdbWriter {
         Ok(())
     }
 
+    /// Record the segment dimensions in the header (checked by every opener)
+    fn stamp_dimensions(&mut self) {
+        let config = self.config.clone();
+        let header = self.header_mut();
+        header.max_instances = config.max_instances as u32;
+        header.max_points_per_instance = config.max_points_per_instance as u32;
+        header.max_channels = config.max_channels as u32;
+        header.max_points_per_channel = config.max_points_per_channel as u32;
+        header.change_ring_capacity = config.change_ring_capacity as u32;
+        header.command_ring_capacity = config.command_ring_capacity as u32;
+        header.history_capacity = config.history_capacity as u64;
+    }
+
     /// Get mutable reference to header
     fn header_mut(&mut self) -> &mut SharedHeader {
         unsafe { &mut *(self.mmap.as_mut_ptr() as *mut SharedHeader) }
@@ -556,6 +1462,40 @@ impl SharedVecRtdbWriter {
         unsafe { &*(self.mmap.as_ptr() as *const SharedHeader) }
     }
 
+    /// Get mutable reference to change ring header
+    fn change_ring_header_mut(&mut self) -> &mut ChangeRingHeader {
+        let offset = self.config.change_ring_offset();
+        unsafe { &mut *(self.mmap.as_mut_ptr().add(offset) as *mut ChangeRingHeader) }
+    }
+
+    /// Publish a changed slot (absolute file offset) to the change ring
+    ///
+    /// Lock-free MPSC: each writer claims a sequence with `fetch_add`, then
+    /// publishes the entry under its own sequence stamp.
+    #[inline]
+    fn publish_change(&self, absolute_offset: usize) {
+        let capacity = self.config.change_ring_capacity;
+        if capacity == 0 {
+            return;
+        }
+        let ring_offset = self.config.change_ring_offset();
+        let ring = unsafe { &*(self.mmap.as_ptr().add(ring_offset) as *const ChangeRingHeader) };
+        let seq = ring.head.fetch_add(1, Ordering::Relaxed);
+
+        let entry_offset = ring_offset
+            + std::mem::size_of::<ChangeRingHeader>()
+            + (seq as usize & (capacity - 1)) * std::mem::size_of::<ChangeEntry>();
+        let entry = unsafe { &*(self.mmap.as_ptr().add(entry_offset) as *const ChangeEntry) };
+
+        // Invalidate, write payload, then stamp with seq + 1
+        entry.seq.store(0, Ordering::Relaxed);
+        std::sync::atomic::fence(Ordering::Release);
+        entry
+            .slot_offset
+            .store(absolute_offset as u64, Ordering::Relaxed);
+        entry.seq.store(seq + 1, Ordering::Release);
+    }
+
     /// Get mutable reference to instance index at given position
     fn instance_index_mut(&mut self, idx: usize) -> &mut InstanceIndex {
         let header = self.header();
@@ -570,6 +1510,17 @@ impl SharedVecRtdbWriter {
         unsafe { &*(self.mmap.as_ptr().add(offset) as *const PointSlot) }
     }
 
+    /// Record point IDs for consecutive slots starting at `first_slot`
+    ///
+    /// `table_offset` is the file offset of the instance or channel point ID table.
+    fn write_point_ids(&mut self, table_offset: usize, first_slot: usize, points: &[u32]) {
+        let start = table_offset + first_slot * std::mem::size_of::<u32>();
+        let end = start + points.len() * std::mem::size_of::<u32>();
+        for (chunk, &point_id) in self.mmap[start..end].chunks_exact_mut(4).zip(points) {
+            chunk.copy_from_slice(&point_id.to_ne_bytes());
+        }
+    }
+
     /// Register an instance with its measurement and action points
     ///
     /// # Arguments
@@ -620,6 +1571,12 @@ impl SharedVecRtdbWriter {
         );
         self.instance_layouts.insert(instance_id, layout);
 
+        // Record point IDs in slot order (measurements, then actions)
+        let slot_size = std::mem::size_of::<PointSlot>();
+        let table = self.config.instance_point_ids_offset();
+        self.write_point_ids(table, measurement_base / slot_size, measurement_points);
+        self.write_point_ids(table, action_base / slot_size, action_points);
+
         // Update instance index
         let inst_idx = self.instance_index_mut(idx);
         inst_idx.instance_id = instance_id;
@@ -649,6 +1606,7 @@ impl SharedVecRtdbWriter {
         header
             .total_points
             .fetch_add(total_points as u32, Ordering::Release);
+        header.layout_generation.fetch_add(1, Ordering::Release);
 
         self.next_instance_idx += 1;
 
@@ -692,6 +1650,7 @@ impl SharedVecRtdbWriter {
                 let slot = self.slot_at(slot_offset);
                 // Use Release ordering to ensure visibility to readers
                 slot.set(value, value, timestamp);
+                self.publish_change(self.data_offset() + slot_offset);
 
                 // Update last_update_ts (relaxed is fine here, it's advisory)
                 self.header()
@@ -769,32 +1728,10 @@ impl SharedVecRtdbWriter {
         point_type: u8,
         point_id: u32,
     ) -> Option<usize> {
-        let layout = self.instance_layouts.get(&instance_id)?;
-
-        let (base, mapping, max_point_id) = if point_type == 0 {
-            (
-                layout.measurement_base,
-                &layout.measurement_point_to_offset,
-                layout.max_measurement_point_id,
-            )
-        } else {
-            (
-                layout.action_base,
-                &layout.action_point_to_offset,
-                layout.max_action_point_id,
-            )
-        };
-
-        if point_id > max_point_id {
-            return None;
-        }
-
-        let relative_offset = mapping.get(point_id as usize).copied()?;
-        if relative_offset == u32::MAX {
-            return None;
-        }
-
-        Some(base + (relative_offset as usize) * std::mem::size_of::<PointSlot>())
+        // Layout mappings already hold byte offsets relative to the type base
+        self.instance_layouts
+            .get(&instance_id)?
+            .get_slot_offset(point_type, point_id)
     }
 
     /// Direct write to a slot by offset (bypass instance/point lookup)
@@ -810,6 +1747,7 @@ impl SharedVecRtdbWriter {
     pub fn set_direct(&self, slot_offset: usize, value: f64, timestamp: u64) {
         let slot = self.slot_at(slot_offset);
         slot.set(value, value, timestamp);
+        self.publish_change(self.data_offset() + slot_offset);
 
         // Update last_update_ts
         self.header()
@@ -817,6 +1755,41 @@ impl SharedVecRtdbWriter {
             .store(timestamp, Ordering::Release);
     }
 
+    /// Direct write of many slots with a single `last_update_ts` store
+    ///
+    /// Batch form of [`set_direct`](Self::set_direct) for column results
+    /// (e.g. one calculated point across instances of a product). Offsets
+    /// are relative to the data section; reader offsets convert with
+    /// `absolute - data_offset()`. Extra entries of the longer slice are ignored.
+    ///
+    /// Offsets outside the instance slot area or not on a slot boundary are
+    /// skipped. Returns the number of slots written.
+    pub fn set_direct_batch(
+        &self,
+        slot_offsets: &[usize],
+        values: &[f64],
+        timestamp: u64,
+    ) -> usize {
+        let slot_size = std::mem::size_of::<PointSlot>();
+        let area = self.config.max_instances * self.config.max_points_per_instance * slot_size;
+        let data_offset = self.data_offset();
+        let mut written = 0;
+        for (&slot_offset, &value) in slot_offsets.iter().zip(values) {
+            if slot_offset >= area || slot_offset % slot_size != 0 {
+                continue;
+            }
+            self.slot_at(slot_offset).set(value, value, timestamp);
+            self.publish_change(data_offset + slot_offset);
+            written += 1;
+        }
+        if written > 0 {
+            self.header()
+                .last_update_ts
+                .store(timestamp, Ordering::Release);
+        }
+        written
+    }
+
     // ======================== Channel Storage API ========================
 
     /// Get mutable reference to channel index at given position
@@ -850,6 +1823,30 @@ impl SharedVecRtdbWriter {
         signal_points: &[u32],
         control_points: &[u32],
         adjustment_points: &[u32],
+    ) -> Result<()> {
+        self.register_channel_with_history(
+            channel_id,
+            telemetry_points,
+            signal_points,
+            control_points,
+            adjustment_points,
+            [0; 4],
+        )
+    }
+
+    /// Register a channel with a history ring for the points of selected types
+    ///
+    /// `history_depths` is the ring depth per type [T, S, C, A] (0 = no
+    /// history), rounded up to a power of two and capped at `MAX_HISTORY_DEPTH`.
+    /// If the history area is exhausted the channel is registered without history.
+    pub fn register_channel_with_history(
+        &mut self,
+        channel_id: u32,
+        telemetry_points: &[u32],
+        signal_points: &[u32],
+        control_points: &[u32],
+        adjustment_points: &[u32],
+        history_depths: [usize; 4],
     ) -> Result<()> {
         if self.next_channel_idx >= self.config.max_channels {
             anyhow::bail!("Max channels ({}) exceeded", self.config.max_channels);
@@ -885,29 +1882,19 @@ impl SharedVecRtdbWriter {
         for (i, points) in point_lists.iter().enumerate() {
             type_bases[i] =
                 self.next_channel_slot_offset + running_offset * std::mem::size_of::<PointSlot>();
-
-            if !points.is_empty() {
-                // SAFETY: points is non-empty, so max() always returns Some
-                let max_id = *points.iter().max().expect("non-empty slice has max");
-                max_point_ids[i] = max_id;
-
-                // Create mapping vec: point_id → relative slot offset
-                let mut mapping = vec![u32::MAX; (max_id + 1) as usize];
-                for (slot_idx, &pid) in points.iter().enumerate() {
-                    mapping[pid as usize] = slot_idx as u32;
-                }
-                type_mappings[i] = mapping.into_boxed_slice();
-            } else {
-                type_mappings[i] = Box::new([]);
-            }
-
+            (type_mappings[i], max_point_ids[i]) = point_mapping(points);
             running_offset += points.len();
         }
 
+        let (history_bases, history_depths) =
+            self.allocate_history(channel_id, &point_lists, history_depths);
+
         let layout = ChannelLayout {
             type_bases,
             type_mappings,
             max_point_ids,
+            history_bases,
+            history_depths,
         };
 
         self.channel_layouts.insert(channel_id, layout);
@@ -941,6 +1928,27 @@ impl SharedVecRtdbWriter {
         ch_idx.point_counts = point_counts;
         ch_idx.point_offsets = point_offsets;
         ch_idx.total_points = total_points as u32;
+        ch_idx.history_depths = history_depths.map(|depth| depth as u16);
+        ch_idx.history_offset = history_bases
+            .iter()
+            .zip(&history_depths)
+            .find(|(_, &depth)| depth > 0)
+            .map_or(0, |(&base, _)| base as u32);
+
+        // Record point IDs in slot order (T, S, C, A follow each other)
+        let mut slot_idx = base_offset / slot_size;
+        for points in point_lists {
+            self.write_point_ids(self.config.channel_point_ids_offset(), slot_idx, points);
+            slot_idx += points.len();
+        }
+
+        // Reset the channel's command ring before the channel becomes visible
+        if self.config.command_ring_capacity > 0 {
+            let offset =
+                self.config.command_ring_offset() + ch_idx_slot * self.config.command_ring_stride();
+            let header = unsafe { &*(self.mmap.as_ptr().add(offset) as *const CommandRingHeader) };
+            CommandRing::init(header, self.config.command_ring_capacity);
+        }
 
         // Update counters
         self.next_channel_slot_offset += total_points * slot_size;
@@ -949,10 +1957,10 @@ impl SharedVecRtdbWriter {
         // Memory fence ensures all ChannelIndex writes are visible before count update
         std::sync::atomic::fence(Ordering::Release);
 
-        // Update header
-        self.header_mut()
-            .channel_count
-            .fetch_add(1, Ordering::Release);
+        // Update header, then announce the new layout
+        let header = self.header_mut();
+        header.channel_count.fetch_add(1, Ordering::Release);
+        header.layout_generation.fetch_add(1, Ordering::Release);
 
         debug!(
             "Registered channel {} with T:{} S:{} C:{} A:{} points",
@@ -966,6 +1974,79 @@ impl SharedVecRtdbWriter {
         Ok(())
     }
 
+    /// Allocate and initialize the history rings of a channel being registered
+    ///
+    /// Returns per-type ring bases and depths; all zero if history is disabled
+    /// or the history area has no room left.
+    fn allocate_history(
+        &mut self,
+        channel_id: u32,
+        point_lists: &[&[u32]; 4],
+        requested: [usize; 4],
+    ) -> ([usize; 4], [usize; 4]) {
+        let mut bases = [0usize; 4];
+        let mut depths = [0usize; 4];
+        if self.config.history_capacity == 0 {
+            return (bases, depths);
+        }
+
+        let mut offset = self.next_history_offset;
+        for (t, points) in point_lists.iter().enumerate() {
+            let depth = HistoryRing::normalize_depth(requested[t]);
+            if depth == 0 || points.is_empty() {
+                continue;
+            }
+            bases[t] = offset;
+            depths[t] = depth;
+            offset += points.len() * HistoryRing::stride(depth);
+        }
+        if offset == self.next_history_offset {
+            return (bases, depths);
+        }
+
+        let area = self.config.history_capacity * std::mem::size_of::<HistoryEntry>();
+        if offset > area || offset > u32::MAX as usize {
+            warn!(
+                "Channel {} history needs {} bytes, history area has {} left; history disabled",
+                channel_id,
+                offset - self.next_history_offset,
+                area.saturating_sub(self.next_history_offset)
+            );
+            return ([0; 4], [0; 4]);
+        }
+
+        // Initialize every ring before the channel becomes visible
+        let history_offset = self.config.history_offset();
+        for (t, points) in point_lists.iter().enumerate() {
+            for i in 0..points.len() * usize::from(depths[t] > 0) {
+                let ring_offset = history_offset + bases[t] + i * HistoryRing::stride(depths[t]);
+                let header =
+                    unsafe { &*(self.mmap.as_ptr().add(ring_offset) as *const HistoryRingHeader) };
+                HistoryRing::init(header, depths[t]);
+            }
+        }
+        self.next_history_offset = offset;
+        (bases, depths)
+    }
+
+    /// Append a sample to a channel point's history ring
+    #[inline]
+    fn push_history(&self, ring_offset: usize, depth: usize, value: f64, timestamp: u64) {
+        // SAFETY: the view borrows self.mmap, which lives as long as &self
+        let ring = unsafe {
+            HistoryRing::at(
+                self.mmap.as_ptr(),
+                self.mmap.len(),
+                &self.config,
+                ring_offset,
+                depth,
+            )
+        };
+        if let Some(ring) = ring {
+            ring.push(value, timestamp);
+        }
+    }
+
     /// Write a channel point value
     ///
     /// # Arguments
@@ -999,6 +2080,11 @@ impl SharedVecRtdbWriter {
                             + (relative_offset as usize) * std::mem::size_of::<PointSlot>();
                         let slot = self.channel_slot_at(slot_offset);
                         slot.set(value, value, timestamp);
+                        self.publish_change(self.config.channel_data_offset() + slot_offset);
+                        if let Some((ring_offset, depth)) = layout.history_ring(type_idx, point_id)
+                        {
+                            self.push_history(ring_offset, depth, value, timestamp);
+                        }
 
                         self.header()
                             .last_update_ts
@@ -1038,6 +2124,109 @@ impl SharedVecRtdbWriter {
                 + (relative_offset as usize) * std::mem::size_of::<PointSlot>(),
         )
     }
+
+    /// Read the stored snapshot of a channel point (None if not registered)
+    ///
+    /// Lets the ingest path compare a new value against the current slot
+    /// before writing it. A slot that was never written has timestamp 0.
+    pub fn get_channel_consistent(
+        &self,
+        channel_id: u32,
+        point_type: voltage_model::PointType,
+        point_id: u32,
+    ) -> Option<PointSnapshot> {
+        let slot_offset = self.get_channel_slot_offset(channel_id, point_type, point_id)?;
+        self.channel_slot_at(slot_offset - self.config.channel_data_offset())
+            .read_consistent()
+    }
+
+    // ======================== Command Ring API ========================
+
+    /// Whether registered channels get a downlink command ring
+    pub fn has_command_rings(&self) -> bool {
+        self.config.command_ring_capacity > 0
+    }
+
+    /// Pop up to `max` pending downlink commands of a channel, in push order
+    ///
+    /// Each channel ring has a single consumer (the channel's CommandTrigger);
+    /// calling this concurrently for the same channel is not supported.
+    ///
+    /// # Returns
+    /// Number of commands passed to `f` (0 if the channel is not registered)
+    pub fn drain_commands<F>(&self, channel_id: u32, max: usize, f: F) -> usize
+    where
+        F: FnMut(RingCommand),
+    {
+        let Some(&position) = self.channel_indices.get(&channel_id) else {
+            return 0;
+        };
+        // SAFETY: the view borrows self.mmap, which lives as long as &self
+        let ring =
+            unsafe { CommandRing::at(self.mmap.as_ptr(), self.mmap.len(), &self.config, position) };
+        ring.map_or(0, |ring| ring.drain(max, f))
+    }
+
+    // ======================== Warm-start Snapshot API ========================
+
+    /// Read many instances/channels into columns (see `SharedVecRtdbReader::read_batch`)
+    ///
+    /// Uses the writer's own layouts, for in-process reads in comsrv.
+    pub fn read_batch(&self, targets: &[BatchReadTarget]) -> PointColumns {
+        gather_batch(
+            targets,
+            |id| self.instance_layouts.get(&id),
+            |id| self.channel_layouts.get(&id),
+            |offset| self.slot_at(offset),
+            |offset| self.channel_slot_at(offset),
+        )
+    }
+
+    /// Capture every written instance and channel slot
+    pub fn snapshot(&self) -> RtdbSnapshot {
+        RtdbSnapshot {
+            created_ms: timestamp_ms(),
+            records: collect_snapshot_records(
+                self.instance_layouts
+                    .iter()
+                    .map(|(&id, layout)| (id, layout)),
+                self.channel_layouts
+                    .iter()
+                    .map(|(&id, layout)| (id, layout)),
+                |offset| self.slot_at(offset),
+                |offset| self.channel_slot_at(offset),
+            ),
+        }
+    }
+
+    /// Write snapshot values back into registered slots
+    ///
+    /// Points are marked `point_quality::RESTORED` until the next live write.
+    /// Points no longer registered, or whose slot already holds a value at
+    /// least as recent, are skipped. No change events are published and
+    /// `last_update_ts` is untouched, so liveness checks still reflect polls.
+    ///
+    /// # Returns
+    /// Number of points restored
+    pub fn restore_snapshot(&self, snapshot: &RtdbSnapshot) -> usize {
+        let mut restored = 0;
+        for record in &snapshot.records {
+            let slot = match record.area {
+                SnapshotArea::Instance => {
+                    snapshot_slot_offset(record, self.instance_layouts.get(&record.owner_id), None)
+                        .map(|offset| self.slot_at(offset))
+                },
+                SnapshotArea::Channel => {
+                    snapshot_slot_offset(record, None, self.channel_layouts.get(&record.owner_id))
+                        .map(|offset| self.channel_slot_at(offset))
+                },
+            };
+            if slot.is_some_and(|slot| restore_slot(slot, record)) {
+                restored += 1;
+            }
+        }
+        restored
+    }
 }
 
 /// Statistics for SharedVecRtdbWriter
@@ -1049,8 +2238,137 @@ pub struct SharedWriterStats {
     pub file_size: usize,
 }
 
+// ========== SharedCommandSender ==========
+
+/// Downlink command producer for modsrv
+///
+/// Maps the shared memory file read-write (the reader mapping is read-only)
+/// and pushes commands into the per-channel rings that comsrv's
+/// CommandTrigger polls, skipping the Redis TODO round trip.
+/// Safe to share across tasks: pushes are lock-free MPSC.
+pub struct SharedCommandSender {
+    /// Memory-mapped file (read-write, only the command ring area is written)
+    mmap: MmapMut,
+    /// Configuration (must match the writer's)
+    config: SharedConfig,
+    /// Channel ID → ChannelIndex position (re-validated on every push)
+    positions: parking_lot::RwLock<FxHashMap<u32, usize>>,
+}
+
+impl SharedCommandSender {
+    /// Open the shared memory file created by comsrv for command pushes
+    ///
+    /// # Returns
+    /// * `Ok(Self)` - Sender instance
+    /// * `Err` - If the file is missing, invalid, too small or rings are disabled
+    pub fn open(config: &SharedConfig) -> Result<Self> {
+        if config.command_ring_capacity == 0 {
+            anyhow::bail!("Command rings disabled (command_ring_capacity = 0)");
+        }
+
+        let file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .open(&config.path)
+            .with_context(|| format!("Failed to open shared memory file: {:?}", config.path))?;
+
+        let mmap = unsafe {
+            MmapOptions::new()
+                .map_mut(&file)
+                .context("Failed to memory map file")?
+        };
+
+        config.check_segment(&mmap)?;
+
+        debug!(
+            "SharedCommandSender: opened {:?}, {} entries per channel",
+            config.path, config.command_ring_capacity
+        );
+
+        Ok(Self {
+            mmap,
+            config: config.clone(),
+            positions: parking_lot::RwLock::new(FxHashMap::default()),
+        })
+    }
+
+    /// Push a downlink command to a channel's ring
+    ///
+    /// # Returns
+    /// * `true` - Command queued for the channel's CommandTrigger
+    /// * `false` - Channel not registered, ring full, or the entry was
+    ///   skipped as stalled before it could be published (use the Redis TODO path)
+    pub fn push(&self, channel_id: u32, command: RingCommand) -> bool {
+        let Some(position) = self.position(channel_id) else {
+            return false;
+        };
+        // SAFETY: the view borrows self.mmap, which lives as long as &self
+        let ring =
+            unsafe { CommandRing::at(self.mmap.as_ptr(), self.mmap.len(), &self.config, position) };
+        ring.is_some_and(|ring| ring.push(&command))
+    }
+
+    /// Resolve a channel's ChannelIndex position
+    ///
+    /// Cached positions are checked against the ChannelIndex entry, so a
+    /// comsrv restart that registers channels in another order triggers a rescan.
+    fn position(&self, channel_id: u32) -> Option<usize> {
+        if let Some(&position) = self.positions.read().get(&channel_id) {
+            if self.channel_id_at(position) == Some(channel_id) {
+                return Some(position);
+            }
+        }
+
+        let mut positions = self.positions.write();
+        positions.clear();
+        for position in 0..self.channel_count() {
+            if let Some(id) = self.channel_id_at(position) {
+                positions.insert(id, position);
+            }
+        }
+        positions.get(&channel_id).copied()
+    }
+
+    /// Number of channels registered by the writer (bounded by config)
+    fn channel_count(&self) -> usize {
+        let header = unsafe { &*(self.mmap.as_ptr() as *const SharedHeader) };
+        (header.channel_count.load(Ordering::Acquire) as usize).min(self.config.max_channels)
+    }
+
+    /// Channel ID stored in the registered ChannelIndex entry at `position`
+    fn channel_id_at(&self, position: usize) -> Option<u32> {
+        if position >= self.channel_count() {
+            return None;
+        }
+        let offset =
+            self.config.channel_index_offset() + position * std::mem::size_of::<ChannelIndex>();
+        let index = unsafe { &*(self.mmap.as_ptr().add(offset) as *const ChannelIndex) };
+        Some(index.channel_id)
+    }
+}
+
 // ========== SharedVecRtdbReader ==========
 
+/// Reader-side point index built from the registration log
+///
+/// Layouts are shared between index versions, so an incremental refresh
+/// copies pointers and builds layouts only for new entries.
+#[derive(Default, Clone)]
+struct ReaderIndex {
+    /// `SharedHeader::writer_epoch` this index was built under
+    epoch: u64,
+    /// `SharedHeader::layout_generation` this index reflects
+    generation: u64,
+    /// InstanceIndex entries already indexed
+    instances_indexed: usize,
+    /// ChannelIndex entries already indexed
+    channels_indexed: usize,
+    /// Instance ID → InstanceLayout (Vec direct indexing)
+    instance_layouts: FxHashMap<u32, Arc<InstanceLayout>>,
+    /// Channel ID → ChannelLayout
+    channel_layouts: FxHashMap<u32, Arc<ChannelLayout>>,
+}
+
 /// Shared memory reader for modsrv
 ///
 /// Opens the shared memory file created by comsrv and provides
@@ -1061,14 +2379,18 @@ pub struct SharedWriterStats {
 pub struct SharedVecRtdbReader {
     /// Memory-mapped file (read-only)
     mmap: Mmap,
-    /// Instance ID → InstanceLayout (Vec direct indexing) optimization
-    instance_layouts: FxHashMap<u32, InstanceLayout>,
+    /// Point index, swapped atomically on incremental refresh
+    index: ArcSwap<ReaderIndex>,
+    /// Serializes refreshes (readers keep using the current index meanwhile)
+    refresh_lock: Mutex<()>,
     /// Data offset from header
     data_offset: usize,
     /// Config for offset calculations
     config: SharedConfig,
-    /// Channel ID → ChannelLayout
-    channel_layouts: FxHashMap<u32, ChannelLayout>,
+    /// Change ring header offset (valid only if ring_capacity > 0)
+    ring_offset: usize,
+    /// Change ring capacity read from the ring header (0 = unavailable)
+    ring_capacity: usize,
 }
 
 impl SharedVecRtdbReader {
@@ -1093,54 +2415,67 @@ impl SharedVecRtdbReader {
                 .context("Failed to memory map file")?
         };
 
+        config.check_segment(&mmap)?;
+
         let mut reader = Self {
             mmap,
-            instance_layouts: FxHashMap::default(),
+            index: ArcSwap::from_pointee(ReaderIndex::default()),
+            refresh_lock: Mutex::new(()),
             data_offset: 0,
             config: config.clone(),
-            channel_layouts: FxHashMap::default(),
+            ring_offset: 0,
+            ring_capacity: 0,
         };
 
         // Validate and build index
         reader.validate_and_build_index()?;
 
+        let index = reader.index.load();
         info!(
             "SharedVecRtdbReader: opened {:?}, {} instances, {} channels indexed",
             config.path,
-            reader.instance_layouts.len(),
-            reader.channel_layouts.len()
+            index.instance_layouts.len(),
+            index.channel_layouts.len()
         );
+        drop(index);
 
         Ok(reader)
     }
 
     /// Validate header and build point index
-    ///
-    /// # Note
-    /// The shared memory format only stores point counts, not actual point_ids.
-    /// Reader assumes sequential point_ids (0, 1, 2...) matching writer's slot order.
-    /// For arbitrary point_id support, store point_ids in the shared memory format.
     fn validate_and_build_index(&mut self) -> Result<()> {
-        // Read header values into locals to avoid borrow issues
-        let (magic, data_offset, index_offset, instance_count, channel_count) = {
+        self.header().check_layout(&self.config)?;
+        self.data_offset = self.header().data_offset as usize;
+
+        let (epoch, generation) = self.layout_version_stamp();
+        let mut index = ReaderIndex {
+            epoch,
+            generation,
+            ..Default::default()
+        };
+        self.index_new_entries(&mut index)?;
+        self.index.store(Arc::new(index));
+
+        self.locate_change_ring();
+
+        Ok(())
+    }
+
+    /// Index the registration log entries appended since `index` was built
+    ///
+    /// The InstanceIndex/ChannelIndex arrays are append-only and their header
+    /// counts are published after each entry is complete, so only entries
+    /// past `instances_indexed` / `channels_indexed` need to be read.
+    fn index_new_entries(&self, index: &mut ReaderIndex) -> Result<()> {
+        let (index_offset, instance_count, channel_count) = {
             let header = self.header();
             (
-                header.magic,
-                header.data_offset as usize,
                 header.index_offset as usize,
                 header.instance_count.load(Ordering::Acquire) as usize,
                 header.channel_count.load(Ordering::Acquire) as usize,
             )
         };
 
-        if magic != SHARED_MAGIC {
-            anyhow::bail!(
-                "Invalid magic: expected {:016x}, got {:016x}",
-                SHARED_MAGIC,
-                magic
-            );
-        }
-
         // Validate file size to prevent out-of-bounds access on truncated files
         let file_size = self.mmap.len();
         let expected_min_size = std::mem::size_of::<SharedHeader>()
@@ -1161,10 +2496,8 @@ impl SharedVecRtdbReader {
             );
         }
 
-        self.data_offset = data_offset;
-
-        // Build InstanceLayout from instance indices
-        for i in 0..instance_count {
+        // Build InstanceLayout from new instance indices
+        for i in index.instances_indexed..instance_count {
             // Copy values from instance index to avoid borrow issues
             let (instance_id, measurement_count, action_count, measurement_offset, action_offset) = {
                 let inst_idx = self.instance_index_at(index_offset, i);
@@ -1177,10 +2510,13 @@ impl SharedVecRtdbReader {
                 )
             };
 
-            // Build sequential point_ids (0, 1, 2, ... count-1)
-            // This matches the slot assignment order in writer
-            let measurement_points: Vec<u32> = (0..measurement_count as u32).collect();
-            let action_points: Vec<u32> = (0..action_count as u32).collect();
+            // Point IDs recorded by the writer, in slot order
+            let slot_size = std::mem::size_of::<PointSlot>();
+            let table = self.config.instance_point_ids_offset();
+            let measurement_points =
+                self.read_point_ids(table, measurement_offset / slot_size, measurement_count)?;
+            let action_points =
+                self.read_point_ids(table, action_offset / slot_size, action_count)?;
 
             // Create InstanceLayout with Vec direct indexing
             let layout = InstanceLayout::new(
@@ -1189,46 +2525,230 @@ impl SharedVecRtdbReader {
                 &measurement_points,
                 &action_points,
             );
-            self.instance_layouts.insert(instance_id, layout);
+            index.instance_layouts.insert(instance_id, Arc::new(layout));
         }
 
-        // Build ChannelLayout from channel indices
+        // Build ChannelLayout from new channel indices
         let channel_index_offset = self.config.channel_index_offset();
-        for i in 0..channel_count {
-            let (channel_id, point_counts, point_offsets) = {
+        for i in index.channels_indexed..channel_count {
+            let (channel_id, point_counts, point_offsets, depths, history_offset) = {
                 let ch_idx = self.channel_index_at(channel_index_offset, i);
-                (ch_idx.channel_id, ch_idx.point_counts, ch_idx.point_offsets)
+                (
+                    ch_idx.channel_id,
+                    ch_idx.point_counts,
+                    ch_idx.point_offsets,
+                    ch_idx.history_depths,
+                    ch_idx.history_offset as usize,
+                )
             };
 
-            // Build ChannelLayout with sequential point_ids
+            // Build ChannelLayout from the point IDs recorded by the writer
             let mut type_bases = [0usize; 4];
             let mut type_mappings: [Box<[u32]>; 4] = Default::default();
             let mut max_point_ids = [0u32; 4];
 
+            let slot_size = std::mem::size_of::<PointSlot>();
+            let table = self.config.channel_point_ids_offset();
             for t in 0..4 {
                 type_bases[t] = point_offsets[t] as usize;
-                let count = point_counts[t] as usize;
-                if count > 0 {
-                    max_point_ids[t] = (count - 1) as u32;
-                    // Sequential mapping: point_id 0,1,2... → slot 0,1,2...
-                    let mapping: Vec<u32> = (0..count as u32).collect();
-                    type_mappings[t] = mapping.into_boxed_slice();
-                } else {
-                    type_mappings[t] = Box::new([]);
+                let points = self.read_point_ids(
+                    table,
+                    type_bases[t] / slot_size,
+                    point_counts[t] as usize,
+                )?;
+                (type_mappings[t], max_point_ids[t]) = point_mapping(&points);
+            }
+
+            // History rings follow each other type by type (see allocate_history)
+            let mut history_bases = [0usize; 4];
+            let mut history_depths = [0usize; 4];
+            let mut next_ring = history_offset;
+            for t in 0..4 {
+                let depth = depths[t] as usize;
+                if depth == 0 || point_counts[t] == 0 {
+                    continue;
                 }
+                history_bases[t] = next_ring;
+                history_depths[t] = depth;
+                next_ring += point_counts[t] as usize * HistoryRing::stride(depth);
             }
 
             let layout = ChannelLayout {
                 type_bases,
                 type_mappings,
                 max_point_ids,
+                history_bases,
+                history_depths,
             };
-            self.channel_layouts.insert(channel_id, layout);
+            index.channel_layouts.insert(channel_id, Arc::new(layout));
         }
 
+        index.instances_indexed = index.instances_indexed.max(instance_count);
+        index.channels_indexed = index.channels_indexed.max(channel_count);
         Ok(())
     }
 
+    /// Read the point IDs of `count` consecutive slots starting at `first_slot`
+    ///
+    /// `table_offset` is the file offset of the instance or channel point ID table.
+    fn read_point_ids(
+        &self,
+        table_offset: usize,
+        first_slot: usize,
+        count: usize,
+    ) -> Result<Vec<u32>> {
+        let start = table_offset + first_slot * std::mem::size_of::<u32>();
+        let end = start + count * std::mem::size_of::<u32>();
+        let Some(bytes) = self.mmap.get(start..end) else {
+            anyhow::bail!(
+                "Point ID table range {}..{} exceeds file size {}",
+                start,
+                end,
+                self.mmap.len()
+            );
+        };
+        Ok(bytes
+            .chunks_exact(4)
+            .map(|chunk| u32::from_ne_bytes([chunk[0], chunk[1], chunk[2], chunk[3]]))
+            .collect())
+    }
+
+    /// Current point index, refreshed first if the writer registered new
+    /// instances or channels (one Acquire load when nothing changed)
+    #[inline]
+    fn index(&self) -> arc_swap::Guard<Arc<ReaderIndex>> {
+        let index = self.index.load();
+        if (index.epoch, index.generation) == self.layout_version_stamp() {
+            return index;
+        }
+        drop(index);
+        self.refresh_index();
+        self.index.load()
+    }
+
+    /// Writer epoch and layout generation, read in this order
+    ///
+    /// Both are read before the counts: entries registered meanwhile are
+    /// indexed now and the bumped generation triggers a no-op refresh.
+    #[inline]
+    fn layout_version_stamp(&self) -> (u64, u64) {
+        let header = self.header();
+        (
+            header.writer_epoch.load(Ordering::Acquire),
+            header.layout_generation.load(Ordering::Acquire),
+        )
+    }
+
+    /// Index instances and channels registered since the last refresh
+    ///
+    /// Called automatically on access when the layout generation changed;
+    /// only the new registration log entries are read. After a writer
+    /// restart (new epoch, or a generation or count below the indexed one)
+    /// the index is rebuilt from the start.
+    ///
+    /// # Returns
+    /// `true` if the index changed
+    pub fn refresh_index(&self) -> bool {
+        let _refresh = self.refresh_lock.lock();
+        let (epoch, generation) = self.layout_version_stamp();
+        let current = self.index.load_full();
+        if current.epoch == epoch && current.generation == generation {
+            return false;
+        }
+
+        let restarted = {
+            let header = self.header();
+            current.epoch != epoch
+                || generation < current.generation
+                || (header.instance_count.load(Ordering::Acquire) as usize)
+                    < current.instances_indexed
+                || (header.channel_count.load(Ordering::Acquire) as usize)
+                    < current.channels_indexed
+        };
+        // On failure the generation is still recorded, so a bad log is not
+        // re-read on every access
+        let mut next = if restarted {
+            debug!(
+                "SharedVecRtdbReader: writer restarted (epoch {} → {}), rebuilding index",
+                current.epoch, epoch
+            );
+            ReaderIndex::default()
+        } else {
+            ReaderIndex::clone(&current)
+        };
+        next.epoch = epoch;
+        next.generation = generation;
+        if let Err(e) = self.index_new_entries(&mut next) {
+            warn!(
+                "SharedVecRtdbReader: incremental index refresh failed: {}",
+                e
+            );
+            self.index.store(Arc::new(next));
+            return false;
+        }
+        debug!(
+            "SharedVecRtdbReader: layout generation {} → {}, {} instances, {} channels indexed",
+            current.generation,
+            generation,
+            next.instance_layouts.len(),
+            next.channel_layouts.len()
+        );
+        self.index.store(Arc::new(next));
+        true
+    }
+
+    /// Layout generation the current index reflects
+    pub fn layout_generation(&self) -> u64 {
+        self.index.load().generation
+    }
+
+    /// Current writer epoch and layout generation from the header
+    ///
+    /// Unlike `layout_generation`, reflects the writer immediately; consumers
+    /// caching slot offsets compare it to detect re-registrations.
+    pub fn layout_version(&self) -> (u64, u64) {
+        self.layout_version_stamp()
+    }
+
+    /// Locate the change ring written by the writer
+    ///
+    /// The ring is optional: older files or writers with the ring disabled
+    /// leave it unavailable, and `drain_changes` then reports nothing.
+    fn locate_change_ring(&mut self) {
+        self.ring_offset = self.config.change_ring_offset();
+        self.ring_capacity = 0;
+
+        let header_end = self.ring_offset + std::mem::size_of::<ChangeRingHeader>();
+        if header_end > self.mmap.len() {
+            return;
+        }
+        let capacity = self.change_ring_header().capacity as usize;
+        let ring_end = header_end + capacity * std::mem::size_of::<ChangeEntry>();
+        if capacity == 0 || !capacity.is_power_of_two() || ring_end > self.mmap.len() {
+            if capacity != 0 {
+                warn!(
+                    "SharedVecRtdbReader: invalid change ring (capacity={}), disabled",
+                    capacity
+                );
+            }
+            return;
+        }
+        self.ring_capacity = capacity;
+    }
+
+    /// Get reference to change ring header
+    fn change_ring_header(&self) -> &ChangeRingHeader {
+        unsafe { &*(self.mmap.as_ptr().add(self.ring_offset) as *const ChangeRingHeader) }
+    }
+
+    /// Get reference to change ring entry for a sequence number
+    fn change_entry(&self, seq: u64) -> &ChangeEntry {
+        let offset = self.ring_offset
+            + std::mem::size_of::<ChangeRingHeader>()
+            + (seq as usize & (self.ring_capacity - 1)) * std::mem::size_of::<ChangeEntry>();
+        unsafe { &*(self.mmap.as_ptr().add(offset) as *const ChangeEntry) }
+    }
+
     /// Get reference to header
     fn header(&self) -> &SharedHeader {
         unsafe { &*(self.mmap.as_ptr() as *const SharedHeader) }
@@ -1274,15 +2794,18 @@ impl SharedVecRtdbReader {
     #[inline]
     pub fn get(&self, instance_id: u32, point_type: u8, point_id: u32) -> Option<f64> {
         // Two-level lookup: instance_id → layout → point_id (Vec direct index)
-        self.instance_layouts.get(&instance_id).and_then(|layout| {
-            layout
-                .get_slot_offset(point_type, point_id)
-                .map(|slot_offset| {
-                    let slot = self.slot_at(slot_offset);
-                    // Use Acquire ordering to see Release writes from writer
-                    slot.load_value(Ordering::Acquire)
-                })
-        })
+        self.index()
+            .instance_layouts
+            .get(&instance_id)
+            .and_then(|layout| {
+                layout
+                    .get_slot_offset(point_type, point_id)
+                    .map(|slot_offset| {
+                        let slot = self.slot_at(slot_offset);
+                        // Use Acquire ordering to see Release writes from writer
+                        slot.load_value(Ordering::Acquire)
+                    })
+            })
     }
 
     /// Read measurement value (convenience method)
@@ -1297,6 +2820,28 @@ impl SharedVecRtdbReader {
         self.get(instance_id, 1, point_id)
     }
 
+    /// Read a consistent point snapshot (value, raw, timestamp, quality)
+    ///
+    /// Unlike [`get`](Self::get), all fields are guaranteed to come from the
+    /// same write (seqlock-protected), so the timestamp can be trusted for
+    /// staleness checks.
+    ///
+    /// # Returns
+    /// * `Some(PointSnapshot)` - Consistent snapshot
+    /// * `None` - Point not found (or writer died mid-write)
+    #[inline]
+    pub fn get_consistent(
+        &self,
+        instance_id: u32,
+        point_type: u8,
+        point_id: u32,
+    ) -> Option<PointSnapshot> {
+        let index = self.index();
+        let layout = index.instance_layouts.get(&instance_id)?;
+        let slot_offset = layout.get_slot_offset(point_type, point_id)?;
+        self.slot_at(slot_offset).read_consistent()
+    }
+
     // ======================== Channel Read API ========================
 
     /// Read a channel point value
@@ -1316,13 +2861,87 @@ impl SharedVecRtdbReader {
         point_type: voltage_model::PointType,
         point_id: u32,
     ) -> Option<f64> {
-        let layout = self.channel_layouts.get(&channel_id)?;
+        let index = self.index();
+        let layout = index.channel_layouts.get(&channel_id)?;
         let type_idx = ChannelIndex::point_type_to_index(point_type);
         let slot_offset = layout.get_slot_offset(type_idx, point_id)?;
         let slot = self.channel_slot_at(slot_offset);
         Some(slot.load_value(Ordering::Acquire))
     }
 
+    /// Read a consistent channel point snapshot (value, raw, timestamp, quality)
+    ///
+    /// Channel counterpart of [`get_consistent`](Self::get_consistent).
+    #[inline]
+    pub fn get_channel_consistent(
+        &self,
+        channel_id: u32,
+        point_type: voltage_model::PointType,
+        point_id: u32,
+    ) -> Option<PointSnapshot> {
+        let index = self.index();
+        let layout = index.channel_layouts.get(&channel_id)?;
+        let type_idx = ChannelIndex::point_type_to_index(point_type);
+        let slot_offset = layout.get_slot_offset(type_idx, point_id)?;
+        self.channel_slot_at(slot_offset).read_consistent()
+    }
+
+    /// Read up to the last `n` history samples of a channel point, oldest first
+    ///
+    /// Empty if the point has no history ring. Samples overwritten while
+    /// reading are skipped.
+    pub fn get_channel_history(
+        &self,
+        channel_id: u32,
+        point_type: voltage_model::PointType,
+        point_id: u32,
+        n: usize,
+    ) -> Vec<HistorySample> {
+        self.channel_history_ring(channel_id, point_type, point_id)
+            .map(|ring| ring.read_last(n))
+            .unwrap_or_default()
+    }
+
+    /// Read the history samples of a channel point taken at or after `since_ms`,
+    /// oldest first
+    pub fn get_channel_history_since(
+        &self,
+        channel_id: u32,
+        point_type: voltage_model::PointType,
+        point_id: u32,
+        since_ms: u64,
+    ) -> Vec<HistorySample> {
+        let Some(ring) = self.channel_history_ring(channel_id, point_type, point_id) else {
+            return Vec::new();
+        };
+        let mut samples = ring.read_last(ring.depth as usize);
+        samples.retain(|sample| sample.timestamp_ms >= since_ms);
+        samples
+    }
+
+    /// History ring of a channel point, if it has one
+    fn channel_history_ring(
+        &self,
+        channel_id: u32,
+        point_type: voltage_model::PointType,
+        point_id: u32,
+    ) -> Option<HistoryRing<'_>> {
+        let index = self.index();
+        let layout = index.channel_layouts.get(&channel_id)?;
+        let type_idx = ChannelIndex::point_type_to_index(point_type);
+        let (ring_offset, depth) = layout.history_ring(type_idx, point_id)?;
+        // SAFETY: the view borrows self.mmap, which lives as long as &self
+        unsafe {
+            HistoryRing::at(
+                self.mmap.as_ptr(),
+                self.mmap.len(),
+                &self.config,
+                ring_offset,
+                depth,
+            )
+        }
+    }
+
     /// Read channel telemetry value (convenience method)
     #[inline]
     pub fn get_channel_telemetry(&self, channel_id: u32, point_id: u32) -> Option<f64> {
@@ -1335,54 +2954,203 @@ impl SharedVecRtdbReader {
         self.get_channel(channel_id, voltage_model::PointType::Signal, point_id)
     }
 
-    /// Check if writer is alive based on heartbeat
+    /// Check if writer is alive based on heartbeat
+    ///
+    /// # Arguments
+    /// * `timeout_ms` - Consider writer dead if heartbeat older than this
+    ///
+    /// # Returns
+    /// * `true` - Writer is alive
+    /// * `false` - Writer may be dead or not started
+    pub fn is_writer_alive(&self, timeout_ms: u64) -> bool {
+        let header = self.header();
+
+        // Check if writer has completed initialization
+        if !header.is_initialized() {
+            return false; // Writer still initializing
+        }
+
+        let heartbeat = header.writer_heartbeat.load(Ordering::Acquire);
+        let now = timestamp_ms();
+        if heartbeat == 0 {
+            return false; // Never written
+        }
+        now.saturating_sub(heartbeat) < timeout_ms
+    }
+
+    /// Get last update timestamp
+    pub fn last_update_ts(&self) -> u64 {
+        self.header().last_update_ts.load(Ordering::Acquire)
+    }
+
+    // ======================== Change Ring API ========================
+
+    /// Check if the change ring is available
+    pub fn has_change_ring(&self) -> bool {
+        self.ring_capacity > 0
+    }
+
+    /// Current change ring head (sequence of the next change to be written)
+    pub fn change_head(&self) -> u64 {
+        if self.ring_capacity == 0 {
+            return 0;
+        }
+        self.change_ring_header().head.load(Ordering::Acquire)
+    }
+
+    /// Cursor at the current head, to only receive changes from now on
+    pub fn change_cursor(&self) -> ChangeCursor {
+        // Epoch first: a restart in between is caught by the next drain
+        let epoch = self.header().writer_epoch.load(Ordering::Acquire);
+        ChangeCursor {
+            next_seq: self.change_head(),
+            epoch,
+            lost: 0,
+        }
+    }
+
+    /// Drain changes published since `since`
+    ///
+    /// Calls `f` for every change in sequence order, up to `max` changes, and
+    /// returns the cursor for the next call. The same slot may be reported
+    /// several times if it was written repeatedly.
+    ///
+    /// If the writer lapped the cursor (more than `capacity` writes since the
+    /// last call), the overwritten changes are skipped and counted in
+    /// `ChangeCursor::lost`.
+    /// A cursor from another writer epoch, or ahead of the head, means the
+    /// writer restarted and reset the ring; draining then restarts from the
+    /// oldest retained change with `lost >= 1`.
+    pub fn drain_changes<F>(&self, since: ChangeCursor, max: usize, mut f: F) -> ChangeCursor
+    where
+        F: FnMut(ChangeEvent),
+    {
+        if self.ring_capacity == 0 {
+            return ChangeCursor { lost: 0, ..since };
+        }
+
+        let epoch = self.header().writer_epoch.load(Ordering::Acquire);
+        let head = self.change_ring_header().head.load(Ordering::Acquire);
+        let capacity = self.ring_capacity as u64;
+        let since_seq = since.next_seq;
+
+        // Skip entries already overwritten by the writer
+        let oldest = head.saturating_sub(capacity);
+        let (mut seq, mut lost) = if since.epoch != epoch || since_seq > head {
+            // The writer restarted and reset the ring: the cursor's sequence
+            // means nothing in the new ring
+            (oldest, 1)
+        } else {
+            let seq = since_seq.max(oldest);
+            (seq, seq - since_seq)
+        };
+        let end = head.min(seq.saturating_add(max as u64));
+
+        while seq < end {
+            let entry = self.change_entry(seq);
+            let stamp = entry.seq.load(Ordering::Acquire);
+            if stamp < seq + 1 {
+                // Claimed but not yet published - resume here next time
+                break;
+            }
+            let slot_offset = entry.slot_offset.load(Ordering::Relaxed);
+            std::sync::atomic::fence(Ordering::Acquire);
+            if stamp != seq + 1 || entry.seq.load(Ordering::Relaxed) != stamp {
+                // Overwritten by a newer lap while reading
+                lost += 1;
+            } else {
+                f(ChangeEvent {
+                    seq,
+                    slot_offset: slot_offset as usize,
+                });
+            }
+            seq += 1;
+        }
+
+        ChangeCursor {
+            next_seq: seq,
+            epoch,
+            lost,
+        }
+    }
+
+    /// Read a consistent snapshot of the slot at an absolute file offset
+    ///
+    /// Used with `ChangeEvent::slot_offset` and the `*_slot_offset` helpers.
+    /// Returns `None` if the offset does not point at a slot.
+    pub fn read_slot(&self, slot_offset: usize) -> Option<PointSnapshot> {
+        let slot_size = std::mem::size_of::<PointSlot>();
+        if slot_offset < self.data_offset
+            || slot_offset + slot_size > self.config.change_ring_offset().min(self.mmap.len())
+            || !slot_offset.is_multiple_of(std::mem::align_of::<PointSlot>())
+        {
+            return None;
+        }
+        let slot = unsafe { &*(self.mmap.as_ptr().add(slot_offset) as *const PointSlot) };
+        slot.read_consistent()
+    }
+
+    /// Gather slot values into a column (struct-of-arrays input for batch formulas)
     ///
-    /// # Arguments
-    /// * `timeout_ms` - Consider writer dead if heartbeat older than this
-    ///
-    /// # Returns
-    /// * `true` - Writer is alive
-    /// * `false` - Writer may be dead or not started
-    pub fn is_writer_alive(&self, timeout_ms: u64) -> bool {
-        let header = self.header();
-
-        // Check if writer has completed initialization
-        if !header.is_initialized() {
-            return false; // Writer still initializing
+    /// `slot_offsets` are absolute, as returned by `instance_slot_offset`.
+    /// Returns the number of slots read; unreadable slots leave `out` untouched.
+    pub fn read_values(&self, slot_offsets: &[usize], out: &mut [f64]) -> usize {
+        let mut read = 0;
+        for (&slot_offset, slot) in slot_offsets.iter().zip(out.iter_mut()) {
+            if let Some(snap) = self.read_slot(slot_offset) {
+                *slot = snap.value;
+                read += 1;
+            }
         }
+        read
+    }
 
-        let heartbeat = header.writer_heartbeat.load(Ordering::Acquire);
-        let now = timestamp_ms();
-        if heartbeat == 0 {
-            return false; // Never written
-        }
-        now.saturating_sub(heartbeat) < timeout_ms
+    /// Absolute file offset of an instance point slot (matches `ChangeEvent::slot_offset`)
+    pub fn instance_slot_offset(
+        &self,
+        instance_id: u32,
+        point_type: u8,
+        point_id: u32,
+    ) -> Option<usize> {
+        let index = self.index();
+        let layout = index.instance_layouts.get(&instance_id)?;
+        let rel = layout.get_slot_offset(point_type, point_id)?;
+        Some(self.data_offset + rel)
     }
 
-    /// Get last update timestamp
-    pub fn last_update_ts(&self) -> u64 {
-        self.header().last_update_ts.load(Ordering::Acquire)
+    /// Absolute file offset of a channel point slot (matches `ChangeEvent::slot_offset`)
+    pub fn channel_slot_offset(
+        &self,
+        channel_id: u32,
+        point_type: PointType,
+        point_id: u32,
+    ) -> Option<usize> {
+        let index = self.index();
+        let layout = index.channel_layouts.get(&channel_id)?;
+        let type_idx = ChannelIndex::point_type_to_index(point_type);
+        let rel = layout.get_slot_offset(type_idx, point_id)?;
+        Some(self.config.channel_data_offset() + rel)
     }
 
     /// Rebuild index from current file state
     ///
-    /// Call this if the writer has registered new instances/channels after
-    /// the reader was opened.
+    /// Accesses pick up new registrations and writer restarts on their own
+    /// (see [`refresh_index`](Self::refresh_index)); this forces a full
+    /// rebuild and re-validates the header.
     pub fn rebuild_index(&mut self) -> Result<()> {
-        self.instance_layouts.clear();
-        self.channel_layouts.clear();
         self.validate_and_build_index()
     }
 
     /// Get statistics
     pub fn stats(&self) -> SharedReaderStats {
+        let index = self.index();
         let header = self.header();
         SharedReaderStats {
             instance_count: header.instance_count.load(Ordering::Acquire),
             total_points: header.total_points.load(Ordering::Acquire),
-            indexed_instances: self.instance_layouts.len(),
+            indexed_instances: index.instance_layouts.len(),
             channel_count: header.channel_count.load(Ordering::Acquire),
-            indexed_channels: self.channel_layouts.len(),
+            indexed_channels: index.channel_layouts.len(),
             last_update_ts: header.last_update_ts.load(Ordering::Acquire),
             writer_heartbeat: header.writer_heartbeat.load(Ordering::Acquire),
         }
@@ -1396,14 +3164,14 @@ impl SharedVecRtdbReader {
     /// This is useful for iterating over all instances without
     /// blindly scanning a range.
     pub fn instance_ids(&self) -> Vec<u32> {
-        self.instance_layouts.keys().copied().collect()
+        self.index().instance_layouts.keys().copied().collect()
     }
 
     /// Get all registered channel IDs
     ///
     /// Returns a Vec of channel IDs that have been indexed.
     pub fn channel_ids(&self) -> Vec<u32> {
-        self.channel_layouts.keys().copied().collect()
+        self.index().channel_layouts.keys().copied().collect()
     }
 
     /// Iterate over all measurement points for a given instance
@@ -1414,7 +3182,7 @@ impl SharedVecRtdbReader {
     where
         F: FnMut(u32, f64),
     {
-        if let Some(layout) = self.instance_layouts.get(&instance_id) {
+        if let Some(layout) = self.index().instance_layouts.get(&instance_id) {
             for (point_id, &rel_offset) in layout.measurement_point_to_offset.iter().enumerate() {
                 if rel_offset != InstanceLayout::INVALID_OFFSET {
                     let slot_offset = layout.measurement_base + rel_offset as usize;
@@ -1432,7 +3200,7 @@ impl SharedVecRtdbReader {
     where
         F: FnMut(u32, f64),
     {
-        if let Some(layout) = self.instance_layouts.get(&instance_id) {
+        if let Some(layout) = self.index().instance_layouts.get(&instance_id) {
             for (point_id, &rel_offset) in layout.action_point_to_offset.iter().enumerate() {
                 if rel_offset != InstanceLayout::INVALID_OFFSET {
                     let slot_offset = layout.action_base + rel_offset as usize;
@@ -1450,7 +3218,7 @@ impl SharedVecRtdbReader {
     where
         F: FnMut(u32, f64),
     {
-        if let Some(layout) = self.channel_layouts.get(&channel_id) {
+        if let Some(layout) = self.index().channel_layouts.get(&channel_id) {
             let type_idx = ChannelIndex::point_type_to_index(point_type);
             for (point_id, &slot_idx) in layout.type_mappings[type_idx].iter().enumerate() {
                 if slot_idx != u32::MAX {
@@ -1462,6 +3230,48 @@ impl SharedVecRtdbReader {
             }
         }
     }
+
+    /// Read many instances/channels into columns against one index snapshot
+    ///
+    /// Targets are resolved in order through the registered point IDs (the
+    /// writer's point ID tables); unknown owners and unregistered point IDs
+    /// are skipped, so rows carry their own identity. Slots that stay torn
+    /// after the seqlock retries are skipped as well.
+    pub fn read_batch(&self, targets: &[BatchReadTarget]) -> PointColumns {
+        let index = self.index();
+        gather_batch(
+            targets,
+            |id| {
+                index
+                    .instance_layouts
+                    .get(&id)
+                    .map(|layout| layout.as_ref())
+            },
+            |id| index.channel_layouts.get(&id).map(|layout| layout.as_ref()),
+            |offset| self.slot_at(offset),
+            |offset| self.channel_slot_at(offset),
+        )
+    }
+
+    /// Capture every written slot (offline counterpart of `SharedVecRtdbWriter::snapshot`)
+    pub fn snapshot(&self) -> RtdbSnapshot {
+        let index = self.index();
+        RtdbSnapshot {
+            created_ms: timestamp_ms(),
+            records: collect_snapshot_records(
+                index
+                    .instance_layouts
+                    .iter()
+                    .map(|(&id, layout)| (id, layout.as_ref())),
+                index
+                    .channel_layouts
+                    .iter()
+                    .map(|(&id, layout)| (id, layout.as_ref())),
+                |offset| self.slot_at(offset),
+                |offset| self.channel_slot_at(offset),
+            ),
+        }
+    }
 }
 
 /// Statistics for SharedVecRtdbReader
@@ -1591,6 +3401,254 @@ pub fn is_shm_available(config: &SharedConfig) -> bool {
     config.path.parent().map(|p| p.exists()).unwrap_or(false)
 }
 
+/// Restore a snapshot into a live shared memory file (offline tooling)
+///
+/// Resolves points through the file's registration log and writes them
+/// like [`SharedVecRtdbWriter::restore_snapshot`], so it is safe while
+/// comsrv is running: slots refreshed since the snapshot are kept.
+///
+/// # Returns
+/// Number of points restored
+pub fn restore_snapshot_into(config: &SharedConfig, snapshot: &RtdbSnapshot) -> Result<usize> {
+    let reader = SharedVecRtdbReader::open(config)?;
+    let file = OpenOptions::new()
+        .read(true)
+        .write(true)
+        .open(&config.path)
+        .with_context(|| format!("Failed to open shared memory file: {:?}", config.path))?;
+    let mmap = unsafe {
+        MmapOptions::new()
+            .map_mut(&file)
+            .context("Failed to memory map file")?
+    };
+    config.check_segment(&mmap)?;
+
+    let index = reader.index();
+    let slot_size = std::mem::size_of::<PointSlot>();
+    let mut restored = 0;
+    for record in &snapshot.records {
+        let offset = match record.area {
+            SnapshotArea::Instance => snapshot_slot_offset(
+                record,
+                index
+                    .instance_layouts
+                    .get(&record.owner_id)
+                    .map(|layout| layout.as_ref()),
+                None,
+            )
+            .map(|offset| reader.data_offset + offset),
+            SnapshotArea::Channel => snapshot_slot_offset(
+                record,
+                None,
+                index
+                    .channel_layouts
+                    .get(&record.owner_id)
+                    .map(|layout| layout.as_ref()),
+            )
+            .map(|offset| config.channel_data_offset() + offset),
+        };
+        let Some(offset) = offset.filter(|&offset| offset + slot_size <= mmap.len()) else {
+            continue;
+        };
+        // SAFETY: in-bounds, slot-aligned offset taken from the registration log
+        let slot = unsafe { &*(mmap.as_ptr().add(offset) as *const PointSlot) };
+        if restore_slot(slot, record) {
+            restored += 1;
+        }
+    }
+    Ok(restored)
+}
+
+/// Collect snapshot records of all written slots (timestamp 0 = never written)
+///
+/// Slot offsets passed to the closures are relative to the instance data
+/// area and the channel data area respectively.
+fn collect_snapshot_records<'a>(
+    instances: impl Iterator<Item = (u32, &'a InstanceLayout)>,
+    channels: impl Iterator<Item = (u32, &'a ChannelLayout)>,
+    instance_slot: impl Fn(usize) -> &'a PointSlot,
+    channel_slot: impl Fn(usize) -> &'a PointSlot,
+) -> Vec<SnapshotRecord> {
+    let mut records = Vec::new();
+    let mut push = |area, owner_id, type_idx, point_id, slot: &PointSlot| {
+        if let Some(point) = slot.read_consistent().filter(|point| point.timestamp != 0) {
+            records.push(SnapshotRecord {
+                area,
+                owner_id,
+                type_idx,
+                point_id,
+                point,
+            });
+        }
+    };
+
+    for (instance_id, layout) in instances {
+        let types = [
+            (layout.measurement_base, &layout.measurement_point_to_offset),
+            (layout.action_base, &layout.action_point_to_offset),
+        ];
+        for (type_idx, (base, mapping)) in types.into_iter().enumerate() {
+            for (point_id, &rel_offset) in mapping.iter().enumerate() {
+                if rel_offset != InstanceLayout::INVALID_OFFSET {
+                    let slot = instance_slot(base + rel_offset as usize);
+                    push(
+                        SnapshotArea::Instance,
+                        instance_id,
+                        type_idx as u8,
+                        point_id as u32,
+                        slot,
+                    );
+                }
+            }
+        }
+    }
+
+    for (channel_id, layout) in channels {
+        for (type_idx, mapping) in layout.type_mappings.iter().enumerate() {
+            for (point_id, &slot_idx) in mapping.iter().enumerate() {
+                if slot_idx != u32::MAX {
+                    let slot = channel_slot(
+                        layout.type_bases[type_idx]
+                            + (slot_idx as usize) * std::mem::size_of::<PointSlot>(),
+                    );
+                    push(
+                        SnapshotArea::Channel,
+                        channel_id,
+                        type_idx as u8,
+                        point_id as u32,
+                        slot,
+                    );
+                }
+            }
+        }
+    }
+
+    records
+}
+
+/// Slot offset of a snapshot record within its area (None if not registered)
+fn snapshot_slot_offset(
+    record: &SnapshotRecord,
+    instance: Option<&InstanceLayout>,
+    channel: Option<&ChannelLayout>,
+) -> Option<usize> {
+    match record.area {
+        // InstanceLayout treats any non-zero type as action
+        SnapshotArea::Instance if record.type_idx <= 1 => {
+            instance?.get_slot_offset(record.type_idx, record.point_id)
+        },
+        SnapshotArea::Instance => None,
+        SnapshotArea::Channel => {
+            channel?.get_slot_offset(record.type_idx as usize, record.point_id)
+        },
+    }
+}
+
+/// Write a snapshot record into a slot unless the slot holds newer data
+fn restore_slot(slot: &PointSlot, record: &SnapshotRecord) -> bool {
+    if slot
+        .read_consistent()
+        .is_some_and(|current| current.timestamp >= record.point.timestamp)
+    {
+        return false;
+    }
+    slot.set_with_quality(
+        record.point.value,
+        record.point.raw,
+        record.point.timestamp,
+        point_quality::RESTORED,
+    );
+    true
+}
+
+/// Gather batch targets into columns (shared by writer and reader)
+fn gather_batch<'a>(
+    targets: &[BatchReadTarget],
+    instance_layout: impl Fn(u32) -> Option<&'a InstanceLayout>,
+    channel_layout: impl Fn(u32) -> Option<&'a ChannelLayout>,
+    instance_slot: impl Fn(usize) -> &'a PointSlot,
+    channel_slot: impl Fn(usize) -> &'a PointSlot,
+) -> PointColumns {
+    let mut columns = PointColumns::default();
+    let mut push = |target: &BatchReadTarget, point_id: u32, slot: &PointSlot| {
+        if let Some(point) = slot.read_consistent() {
+            columns.push(
+                target.area,
+                target.owner_id,
+                target.type_idx,
+                point_id,
+                point.value,
+                point.timestamp,
+                point.quality,
+            );
+        }
+    };
+
+    for target in targets {
+        match target.area {
+            SnapshotArea::Instance => {
+                let Some(layout) = instance_layout(target.owner_id) else {
+                    continue;
+                };
+                match &target.point_ids {
+                    Some(point_ids) => {
+                        for &point_id in point_ids {
+                            if let Some(offset) = layout.get_slot_offset(target.type_idx, point_id)
+                            {
+                                push(target, point_id, instance_slot(offset));
+                            }
+                        }
+                    },
+                    None => {
+                        let (base, mapping) = if target.type_idx == 0 {
+                            (layout.measurement_base, &layout.measurement_point_to_offset)
+                        } else {
+                            (layout.action_base, &layout.action_point_to_offset)
+                        };
+                        for (point_id, &rel_offset) in mapping.iter().enumerate() {
+                            if rel_offset != InstanceLayout::INVALID_OFFSET {
+                                let slot = instance_slot(base + rel_offset as usize);
+                                push(target, point_id as u32, slot);
+                            }
+                        }
+                    },
+                }
+            },
+            SnapshotArea::Channel => {
+                let Some(layout) = channel_layout(target.owner_id) else {
+                    continue;
+                };
+                let type_idx = target.type_idx as usize;
+                match &target.point_ids {
+                    Some(point_ids) => {
+                        for &point_id in point_ids {
+                            if let Some(offset) = layout.get_slot_offset(type_idx, point_id) {
+                                push(target, point_id, channel_slot(offset));
+                            }
+                        }
+                    },
+                    None => {
+                        let Some(mapping) = layout.type_mappings.get(type_idx) else {
+                            continue;
+                        };
+                        for (point_id, &slot_idx) in mapping.iter().enumerate() {
+                            if slot_idx != u32::MAX {
+                                let slot = channel_slot(
+                                    layout.type_bases[type_idx]
+                                        + (slot_idx as usize) * std::mem::size_of::<PointSlot>(),
+                                );
+                                push(target, point_id as u32, slot);
+                            }
+                        }
+                    },
+                }
+            },
+        }
+    }
+
+    columns
+}
+
 /// Try to open reader, returning None if unavailable
 pub fn try_open_reader(config: &SharedConfig) -> Option<SharedVecRtdbReader> {
     match SharedVecRtdbReader::open(config) {
@@ -1617,12 +3675,57 @@ mod tests {
             max_points_per_instance: 32,
             max_channels: 8,
             max_points_per_channel: 32,
+            change_ring_capacity: 16,
+            command_ring_capacity: 4,
+            history_capacity: 64,
         }
     }
 
     #[test]
     fn test_shared_header_size() {
-        assert_eq!(std::mem::size_of::<SharedHeader>(), 64);
+        assert_eq!(std::mem::size_of::<SharedHeader>(), 128);
+    }
+
+    #[test]
+    fn test_channel_index_size() {
+        assert_eq!(std::mem::size_of::<ChannelIndex>(), 48);
+    }
+
+    #[test]
+    fn test_open_rejects_other_layout() {
+        let config = test_config("layout_check");
+        let writer = SharedVecRtdbWriter::open(&config).unwrap();
+
+        // Different limits move every offset
+        let other = config.clone().with_max_channels(16);
+        let err = SharedVecRtdbReader::open(&other).err().unwrap();
+        assert!(err.to_string().contains("max_channels"), "{}", err);
+        assert!(SharedCommandSender::open(&other).is_err());
+
+        // Offline tools take the dimensions from the header
+        let loaded = SharedConfig::from_segment(config.path.clone()).unwrap();
+        assert_eq!(loaded.max_channels, config.max_channels);
+        assert_eq!(loaded.history_capacity, config.history_capacity);
+        assert!(SharedVecRtdbReader::open(&loaded).is_ok());
+
+        // Segment written by another format version
+        let file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .open(&config.path)
+            .unwrap();
+        let mut mmap = unsafe { MmapOptions::new().map_mut(&file).unwrap() };
+        let header = unsafe { &mut *(mmap.as_mut_ptr() as *mut SharedHeader) };
+        header.layout_version = SHARED_LAYOUT_VERSION - 1;
+        let err = SharedVecRtdbReader::open(&config).err().unwrap();
+        assert!(err.to_string().contains("layout version"), "{}", err);
+        assert!(SharedConfig::from_segment(config.path.clone()).is_err());
+
+        header.layout_version = SHARED_LAYOUT_VERSION;
+        assert!(SharedVecRtdbReader::open(&config).is_ok());
+
+        drop(writer);
+        let _ = std::fs::remove_file(&config.path);
     }
 
     #[test]
@@ -1672,13 +3775,11 @@ mod tests {
         // Writer creates and writes
         {
             let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
-            // Register with sequential point_ids: measurements [0, 1, 2], actions [0]
-            // Reader uses sequential indices, so we must use sequential point_ids
-            writer.register_instance(5, &[0, 1, 2], &[0]).unwrap();
-            // Write using registered point_ids
-            writer.set_measurement(5, 0, 100.5, 1729000000);
-            writer.set_measurement(5, 1, 200.0, 1729000001);
-            writer.set_action(5, 0, 1.0, 1729000002);
+            // Non-contiguous point_ids: slots are allocated in registration order
+            writer.register_instance(5, &[10, 3, 7], &[2]).unwrap();
+            writer.set_measurement(5, 10, 100.5, 1729000000);
+            writer.set_measurement(5, 3, 200.0, 1729000001);
+            writer.set_action(5, 2, 1.0, 1729000002);
             writer.heartbeat();
             // Flush may fail on some systems (e.g., MacOS) - ignore for tests
             let _ = writer.flush();
@@ -1688,10 +3789,13 @@ mod tests {
         {
             let reader = SharedVecRtdbReader::open(&config).unwrap();
 
-            // Check values (using sequential point indices)
-            assert_eq!(reader.get_measurement(5, 0), Some(100.5));
-            assert_eq!(reader.get_measurement(5, 1), Some(200.0));
-            assert_eq!(reader.get_action(5, 0), Some(1.0));
+            // Reader resolves the same point_ids as the writer
+            assert_eq!(reader.get_measurement(5, 10), Some(100.5));
+            assert_eq!(reader.get_measurement(5, 3), Some(200.0));
+            assert_eq!(reader.get_measurement(5, 7), Some(0.0));
+            assert_eq!(reader.get_action(5, 2), Some(1.0));
+            assert!(reader.get_measurement(5, 0).is_none());
+            assert!(reader.get_action(5, 0).is_none());
             assert!(reader.get_measurement(5, 999).is_none());
 
             // Check stats
@@ -1705,6 +3809,490 @@ mod tests {
         std::fs::remove_file(&config.path).ok();
     }
 
+    #[test]
+    fn test_reader_consistent_snapshot() {
+        let config = test_config("consistent");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(7, &[0, 1], &[]).unwrap();
+        writer.register_channel(1001, &[0], &[], &[], &[]).unwrap();
+        writer.set_measurement(7, 1, 42.0, 1729000000);
+        writer.set_channel(1001, PointType::Telemetry, 0, 3.5, 1729000001);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+
+        let snap = reader.get_consistent(7, 0, 1).unwrap();
+        assert_eq!(snap.value, 42.0);
+        assert_eq!(snap.raw, 42.0);
+        assert_eq!(snap.timestamp, 1729000000);
+        assert_eq!(snap.quality, 0);
+        assert!(reader.get_consistent(7, 0, 99).is_none());
+
+        let snap = reader
+            .get_channel_consistent(1001, PointType::Telemetry, 0)
+            .unwrap();
+        assert_eq!(snap.value, 3.5);
+        assert_eq!(snap.timestamp, 1729000001);
+
+        // Writer sees its own channel slots (ingest deadband comparison)
+        let own = writer
+            .get_channel_consistent(1001, PointType::Telemetry, 0)
+            .unwrap();
+        assert_eq!(own.value, 3.5);
+        assert!(writer
+            .get_channel_consistent(1001, PointType::Signal, 0)
+            .is_none());
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_reader_picks_up_new_registrations() {
+        let config = test_config("generation");
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_channel(1001, &[1], &[], &[], &[]).unwrap();
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        assert_eq!(reader.layout_generation(), 1);
+        assert!(!reader.refresh_index());
+
+        // Registered after the reader was opened
+        writer
+            .register_channel(1002, &[1, 2], &[], &[], &[])
+            .unwrap();
+        writer.register_instance(7, &[1], &[]).unwrap();
+        writer.set_channel(1002, PointType::Telemetry, 2, 9.5, 1000);
+
+        // Picked up on access, without rebuild_index()
+        assert_eq!(reader.get_channel_telemetry(1002, 2), Some(9.5));
+        assert_eq!(reader.get_channel_telemetry(1002, 1), Some(0.0));
+        assert_eq!(reader.layout_generation(), 3);
+        let stats = reader.stats();
+        assert_eq!(stats.indexed_channels, 2);
+        assert_eq!(stats.indexed_instances, 1);
+        assert!(!reader.refresh_index());
+
+        drop(reader);
+        drop(writer);
+        let _ = std::fs::remove_file(&config.path);
+    }
+
+    #[test]
+    fn test_reader_rebuilds_after_writer_restart() {
+        let config = test_config("writer_restart");
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer
+            .register_channel(1001, &[1, 2], &[], &[], &[])
+            .unwrap();
+        writer.register_channel(1002, &[1], &[], &[], &[]).unwrap();
+        writer.set_channel(1001, PointType::Telemetry, 2, 2.0, 1000);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        assert_eq!(reader.get_channel_telemetry(1001, 2), Some(2.0));
+        assert_eq!(reader.layout_generation(), 2);
+
+        // Restarted writer: same generation and counts, different layout
+        drop(writer);
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_channel(1002, &[7], &[], &[], &[]).unwrap();
+        writer.register_channel(1001, &[3], &[], &[], &[]).unwrap();
+        writer.set_channel(1001, PointType::Telemetry, 3, 3.0, 2000);
+        writer.set_channel(1002, PointType::Telemetry, 7, 7.0, 2000);
+
+        assert_eq!(reader.get_channel_telemetry(1001, 3), Some(3.0));
+        assert_eq!(reader.get_channel_telemetry(1002, 7), Some(7.0));
+        assert!(reader.get_channel_telemetry(1001, 2).is_none());
+        assert!(reader.get_channel_telemetry(1002, 1).is_none());
+        assert_eq!(reader.stats().indexed_channels, 2);
+        assert!(!reader.refresh_index());
+
+        // Restarted writer with fewer registrations so far
+        drop(writer);
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_channel(1001, &[4], &[], &[], &[]).unwrap();
+        writer.set_channel(1001, PointType::Telemetry, 4, 4.0, 3000);
+
+        assert_eq!(reader.get_channel_telemetry(1001, 4), Some(4.0));
+        assert!(reader.get_channel_telemetry(1002, 7).is_none());
+        assert_eq!(reader.layout_generation(), 1);
+        assert_eq!(reader.stats().indexed_channels, 1);
+
+        drop(reader);
+        drop(writer);
+        let _ = std::fs::remove_file(&config.path);
+    }
+
+    #[test]
+    fn test_channel_history_ring() {
+        let config = test_config("history");
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        // T rings of depth 3 → 4; 2 points × (4 + 1) entries = 10 of 64
+        writer
+            .register_channel_with_history(1001, &[1, 2], &[1], &[], &[], [3, 0, 0, 0])
+            .unwrap();
+        // Needs 2 × (32 + 1) entries: exceeds the remaining area, no history
+        writer
+            .register_channel_with_history(1002, &[1, 2], &[], &[], &[], [32, 0, 0, 0])
+            .unwrap();
+
+        for i in 1..=6u64 {
+            writer.set_channel(1001, PointType::Telemetry, 1, i as f64, 1000 * i);
+        }
+        writer.set_channel(1001, PointType::Telemetry, 2, 42.0, 7000);
+        writer.set_channel(1001, PointType::Signal, 1, 1.0, 7000);
+        writer.set_channel(1002, PointType::Telemetry, 1, 5.0, 7000);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        let values =
+            |samples: Vec<HistorySample>| -> Vec<f64> { samples.iter().map(|s| s.value).collect() };
+        assert_eq!(
+            values(reader.get_channel_history(1001, PointType::Telemetry, 1, 10)),
+            vec![3.0, 4.0, 5.0, 6.0]
+        );
+        assert_eq!(
+            values(reader.get_channel_history(1001, PointType::Telemetry, 1, 2)),
+            vec![5.0, 6.0]
+        );
+        assert_eq!(
+            reader.get_channel_history_since(1001, PointType::Telemetry, 1, 5000),
+            vec![
+                HistorySample {
+                    value: 5.0,
+                    timestamp_ms: 5000
+                },
+                HistorySample {
+                    value: 6.0,
+                    timestamp_ms: 6000
+                },
+            ]
+        );
+        assert_eq!(
+            values(reader.get_channel_history(1001, PointType::Telemetry, 2, 10)),
+            vec![42.0]
+        );
+        assert!(reader
+            .get_channel_history(1001, PointType::Signal, 1, 10)
+            .is_empty());
+        assert!(reader
+            .get_channel_history(1002, PointType::Telemetry, 1, 10)
+            .is_empty());
+        // Slots are still written for channels without history
+        assert_eq!(reader.get_channel_telemetry(1002, 1), Some(5.0));
+
+        drop(reader);
+        drop(writer);
+        let _ = std::fs::remove_file(&config.path);
+    }
+
+    #[test]
+    fn test_change_ring_drain() {
+        let config = test_config("change_ring");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(3, &[0, 1], &[]).unwrap();
+        writer
+            .register_channel(1001, &[0, 1], &[], &[], &[])
+            .unwrap();
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        assert!(reader.has_change_ring());
+        let start = reader.change_cursor();
+        assert_eq!(start.next_seq, 0);
+
+        writer.set_measurement(3, 1, 10.0, 1729000000);
+        writer.set_channel(1001, PointType::Telemetry, 0, 20.0, 1729000001);
+
+        let mut events = Vec::new();
+        let cursor = reader.drain_changes(start, usize::MAX, |e| events.push(e));
+        assert_eq!(cursor.next_seq, 2);
+        assert_eq!(cursor.lost, 0);
+        assert_eq!(events.len(), 2);
+
+        // Offsets resolve back to the written points
+        assert_eq!(
+            Some(events[0].slot_offset),
+            reader.instance_slot_offset(3, 0, 1)
+        );
+        assert_eq!(
+            Some(events[1].slot_offset),
+            reader.channel_slot_offset(1001, PointType::Telemetry, 0)
+        );
+        assert_eq!(reader.read_slot(events[1].slot_offset).unwrap().value, 20.0);
+
+        // Nothing new since cursor
+        let again = reader.drain_changes(cursor, usize::MAX, |_| panic!("no change"));
+        assert_eq!(again.next_seq, 2);
+
+        // Lapping the ring (capacity 16) reports lost changes
+        for i in 0..20 {
+            writer.set_measurement(3, 0, i as f64, 1729000002 + i);
+        }
+        let mut count = 0;
+        let lapped = reader.drain_changes(cursor, usize::MAX, |_| count += 1);
+        assert_eq!(lapped.next_seq, 22);
+        assert_eq!(lapped.lost, 4);
+        assert_eq!(count, 16);
+
+        // max limits the batch size
+        let rewound = ChangeCursor {
+            next_seq: lapped.next_seq - 3,
+            ..lapped
+        };
+        let partial = reader.drain_changes(rewound, 2, |_| {});
+        assert_eq!(partial.next_seq, lapped.next_seq - 1);
+
+        drop(reader);
+        drop(writer);
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_change_ring_detects_writer_restart() {
+        let config = test_config("change_ring_restart");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(3, &[0, 1], &[]).unwrap();
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+
+        writer.set_measurement(3, 0, 1.0, 1000);
+        writer.set_measurement(3, 1, 2.0, 1000);
+        let cursor = reader.drain_changes(reader.change_cursor(), usize::MAX, |_| {});
+        assert_eq!((cursor.next_seq, cursor.lost), (2, 0));
+
+        // Restarted writer publishes at least as many changes as the cursor
+        // had seen: the sequence alone looks continuous
+        drop(writer);
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(3, &[0, 1], &[]).unwrap();
+        for i in 0..3 {
+            writer.set_measurement(3, 1, i as f64, 2000 + i);
+        }
+
+        let mut count = 0;
+        let restarted = reader.drain_changes(cursor, usize::MAX, |_| count += 1);
+        assert!(restarted.lost > 0);
+        assert_ne!(restarted.epoch, cursor.epoch);
+        assert_eq!(restarted.next_seq, 3);
+        assert_eq!(count, 3);
+
+        // Continuous again under the new epoch
+        let again = reader.drain_changes(restarted, usize::MAX, |_| panic!("no change"));
+        assert_eq!(again.lost, 0);
+
+        drop(reader);
+        drop(writer);
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_command_ring_push_drain() {
+        let config = test_config("command_ring");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer
+            .register_channel(1001, &[0], &[], &[1], &[2])
+            .unwrap();
+        assert!(writer.has_command_rings());
+
+        let sender = SharedCommandSender::open(&config).unwrap();
+        let control = RingCommand {
+            point_type: PointType::Control,
+            point_id: 1,
+            value: 1.0,
+            timestamp_ms: 1729000000,
+        };
+        let adjustment = RingCommand {
+            point_type: PointType::Adjustment,
+            point_id: 2,
+            value: 42.5,
+            timestamp_ms: 1729000001,
+        };
+        assert!(sender.push(1001, control));
+        assert!(sender.push(1001, adjustment));
+        // Unregistered channel has no ring
+        assert!(!sender.push(9999, control));
+
+        let mut commands = Vec::new();
+        assert_eq!(
+            writer.drain_commands(1001, usize::MAX, |c| commands.push(c)),
+            2
+        );
+        assert_eq!(commands, vec![control, adjustment]);
+        assert_eq!(
+            writer.drain_commands(1001, usize::MAX, |_| panic!("empty")),
+            0
+        );
+
+        // Full ring (capacity 4) rejects instead of overwriting
+        for _ in 0..4 {
+            assert!(sender.push(1001, control));
+        }
+        assert!(!sender.push(1001, adjustment));
+        assert_eq!(writer.drain_commands(1001, 3, |_| {}), 3);
+        assert!(sender.push(1001, adjustment));
+
+        let mut rest = Vec::new();
+        writer.drain_commands(1001, usize::MAX, |c| rest.push(c));
+        assert_eq!(rest, vec![control, adjustment]);
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_command_ring_skips_stalled_and_unknown_entries() {
+        let config = test_config("command_ring_stall");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_channel(1001, &[], &[], &[1], &[]).unwrap();
+        let sender = SharedCommandSender::open(&config).unwrap();
+        let ring = unsafe {
+            CommandRing::at(writer.mmap.as_ptr(), writer.mmap.len(), &config, 0).unwrap()
+        };
+        let command = |value| RingCommand {
+            point_type: PointType::Control,
+            point_id: 1,
+            value,
+            timestamp_ms: 1729000000,
+        };
+
+        // A producer claimed sequence 0 and died before publishing it
+        ring.header.head.fetch_add(1, Ordering::AcqRel);
+        assert!(sender.push(1001, command(1.0)));
+
+        // Within the timeout the consumer waits for the claimed entry
+        assert_eq!(ring.drain(usize::MAX, |_| panic!("stalled")), 0);
+        assert_eq!(ring.header.tail.load(Ordering::Acquire), 0);
+
+        // After it the entry is skipped and the ring moves on
+        let mut drained = Vec::new();
+        assert_eq!(
+            ring.drain_with_timeout(usize::MAX, 0, |c| drained.push(c)),
+            1
+        );
+        assert_eq!(drained, vec![command(1.0)]);
+
+        // A late publish of the skipped sequence is rejected
+        assert!(!ring.publish(0));
+        assert_eq!(ring.drain(usize::MAX, |_| panic!("skipped")), 0);
+
+        // The skipped slot is reused on the next lap
+        for i in 0..4 {
+            assert!(sender.push(1001, command(i as f64)));
+        }
+        assert_eq!(ring.drain(usize::MAX, |_| {}), 4);
+
+        // Unknown point type bytes are dropped, not read as telemetry
+        assert!(sender.push(1001, command(2.0)));
+        assert!(sender.push(1001, command(3.0)));
+        let tail = ring.header.tail.load(Ordering::Acquire);
+        ring.entry(tail).point_type.store(9, Ordering::Relaxed);
+        let mut drained = Vec::new();
+        assert_eq!(ring.drain(usize::MAX, |c| drained.push(c)), 1);
+        assert_eq!(drained, vec![command(3.0)]);
+        assert_eq!(ring.header.tail.load(Ordering::Acquire), tail + 2);
+
+        drop(sender);
+        drop(writer);
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_column_gather_and_batch_write() {
+        let config = test_config("column_batch");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        for id in 1..=3 {
+            writer.register_instance(id, &[0, 1], &[]).unwrap();
+            writer.set_measurement(id, 0, id as f64 * 10.0, 1729000000);
+        }
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+
+        let inputs: Vec<usize> = (1..=3)
+            .map(|id| reader.instance_slot_offset(id, 0, 0).unwrap())
+            .collect();
+        let mut column = [0.0; 3];
+        assert_eq!(reader.read_values(&inputs, &mut column), 3);
+        assert_eq!(column, [10.0, 20.0, 30.0]);
+
+        let outputs: Vec<usize> = (1..=3)
+            .map(|id| reader.instance_slot_offset(id, 0, 1).unwrap() - writer.data_offset())
+            .collect();
+        let head = reader.change_head();
+        assert_eq!(
+            writer.set_direct_batch(&outputs, &[1.5, 2.5, 3.5], 1729000001),
+            3
+        );
+        for (id, want) in (1..=3).zip([1.5, 2.5, 3.5]) {
+            assert_eq!(reader.get_measurement(id, 1), Some(want));
+        }
+        assert_eq!(reader.change_head(), head + 3);
+        assert_eq!(reader.last_update_ts(), 1729000001);
+
+        // Unreadable offsets are skipped
+        assert_eq!(reader.read_values(&[0, inputs[0]], &mut column), 1);
+
+        // Out-of-area and misaligned offsets are not written
+        let area = config.max_instances
+            * config.max_points_per_instance
+            * std::mem::size_of::<PointSlot>();
+        let head = reader.change_head();
+        assert_eq!(
+            writer.set_direct_batch(&[area, outputs[0] + 1, usize::MAX], &[9.0; 3], 1729000002),
+            0
+        );
+        assert_eq!(reader.change_head(), head);
+        assert_eq!(reader.get_measurement(1, 1), Some(1.5));
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_read_batch_sparse_point_ids() {
+        let config = test_config("read_batch_sparse");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        // 1-based and sparse IDs, registered out of order
+        writer.register_instance(5, &[1, 2, 3], &[]).unwrap();
+        writer
+            .register_channel(1001, &[40, 7, 1000], &[], &[], &[])
+            .unwrap();
+        writer.set_measurement(5, 1, 10.0, 1000);
+        writer.set_measurement(5, 3, 30.0, 1001);
+        writer.set_channel(1001, PointType::Telemetry, 7, 0.7, 1002);
+        writer.set_channel(1001, PointType::Telemetry, 1000, 100.0, 1003);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        let targets = [
+            BatchReadTarget {
+                area: SnapshotArea::Instance,
+                owner_id: 5,
+                type_idx: 0,
+                point_ids: None,
+            },
+            BatchReadTarget {
+                area: SnapshotArea::Channel,
+                owner_id: 1001,
+                type_idx: 0,
+                // 0 and 2 are slot positions, not registered IDs
+                point_ids: Some(vec![1000, 0, 2, 7]),
+            },
+        ];
+        let columns = reader.read_batch(&targets);
+        assert_eq!(columns.point_ids, vec![1, 2, 3, 1000, 7]);
+        assert_eq!(columns.values, vec![10.0, 0.0, 30.0, 100.0, 0.7]);
+        assert_eq!(columns.timestamps[4], 1002);
+        assert_eq!(reader.read_batch(&targets), writer.read_batch(&targets));
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
     #[test]
     fn test_concurrent_write_read() {
         let config = test_config("concurrent");
@@ -1713,23 +4301,16 @@ mod tests {
 
         // Create shared memory
         let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
-        // Register with sequential point_id 0 (reader uses sequential indices)
         writer.register_instance(1, &[0], &[]).unwrap();
         // Flush may fail on some systems - ignore error for tests
         let _ = writer.flush();
 
-        // Arc for sharing config path
-        let path = config.path.clone();
-
         // Spawn reader thread
+        let reader_config = config.clone();
         let reader_handle = thread::spawn(move || {
-            let reader_config = SharedConfig {
-                path,
-                ..Default::default()
-            };
             let reader = SharedVecRtdbReader::open(&reader_config).unwrap();
 
-            // Read 100 times using sequential point index 0
+            // Read 100 times
             let mut last_value = 0.0f64;
             for _ in 0..100 {
                 if let Some(v) = reader.get_measurement(1, 0) {
@@ -1769,6 +4350,9 @@ mod tests {
             max_points_per_instance: 32,
             max_channels: 8,
             max_points_per_channel: 32,
+            change_ring_capacity: 16,
+            command_ring_capacity: 4,
+            history_capacity: 64,
         };
 
         // Create writer and register instance
@@ -1815,9 +4399,6 @@ mod tests {
         writer.set_direct(slot_offset, 42.5, 1729000000);
 
         // Verify the write by reading the slot directly
-        // Note: SharedVecRtdbReader assumes sequential point_ids, but ChannelToSlotIndex
-        // bypasses this by using pre-computed slot offsets.
-        // We verify by reading from the writer's slot directly using slot_at method.
         let slot = writer.slot_at(slot_offset);
         let value = slot.get_value();
         assert!(
@@ -1830,7 +4411,191 @@ mod tests {
         let ts = slot.get_timestamp();
         assert_eq!(ts, 1729000000, "Expected 1729000000, got {}", ts);
 
+        // Non-first slots resolve to the same slot as the instance write path
+        writer.set_measurement(5, 30, 7.25, 1729000001);
+        let slot_offset = channel_index.lookup(1002, PointType::Signal, 1).unwrap();
+        assert_eq!(writer.slot_at(slot_offset).get_value(), 7.25);
+
         // Cleanup
         std::fs::remove_file(&path).ok();
     }
+
+    #[test]
+    fn test_snapshot_restore_after_reopen() {
+        let config = test_config("snapshot_restore");
+        std::fs::remove_file(&config.path).ok();
+
+        let snapshot = {
+            let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+            writer.register_instance(5, &[0, 1], &[0]).unwrap();
+            writer
+                .register_channel(1001, &[0, 1], &[], &[], &[])
+                .unwrap();
+            writer.set_measurement(5, 0, 100.5, 1729000000);
+            writer.set_channel(1001, PointType::Telemetry, 1, 3.5, 1729000001);
+            writer.snapshot()
+        };
+        // Never-written slots are not captured
+        assert_eq!(snapshot.records.len(), 2);
+
+        // Reopen recreates the file; register in another order
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer
+            .register_channel(1001, &[0, 1], &[], &[], &[])
+            .unwrap();
+        writer.register_instance(5, &[0, 1], &[0]).unwrap();
+        assert_eq!(writer.restore_snapshot(&snapshot), 2);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        let point = reader.get_consistent(5, 0, 0).unwrap();
+        assert_eq!(point.value, 100.5);
+        assert_eq!(point.timestamp, 1729000000);
+        assert_eq!(point.quality, point_quality::RESTORED);
+        let point = reader
+            .get_channel_consistent(1001, PointType::Telemetry, 1)
+            .unwrap();
+        assert_eq!(point.value, 3.5);
+        assert_eq!(point.quality, point_quality::RESTORED);
+
+        // A live write marks the point good again; restore keeps newer data
+        writer.set_measurement(5, 0, 101.0, 1729000005);
+        assert_eq!(reader.get_consistent(5, 0, 0).unwrap().quality, 0);
+        assert_eq!(restore_snapshot_into(&config, &snapshot).unwrap(), 0);
+        assert_eq!(reader.get_measurement(5, 0), Some(101.0));
+
+        // Offline snapshot from the reader sees the same points
+        assert_eq!(reader.snapshot().records.len(), 2);
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_reader_snapshot_restores_sparse_point_ids() {
+        let config = test_config("snapshot_sparse");
+        std::fs::remove_file(&config.path).ok();
+
+        let register = |writer: &mut SharedVecRtdbWriter| {
+            writer.register_instance(5, &[7, 3], &[12]).unwrap();
+            writer
+                .register_channel(1001, &[101, 205], &[4], &[], &[])
+                .unwrap();
+        };
+
+        // Snapshot taken by a reader (monarch rtdb snapshot), not the writer
+        let snapshot = {
+            let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+            register(&mut writer);
+            writer.set_measurement(5, 3, 30.0, 1729000000);
+            writer.set_action(5, 12, 1.0, 1729000001);
+            writer.set_channel(1001, PointType::Telemetry, 205, 2.5, 1729000002);
+            writer.set_channel(1001, PointType::Signal, 4, 1.0, 1729000003);
+            let reader = SharedVecRtdbReader::open(&config).unwrap();
+            reader.snapshot()
+        };
+        let mut ids: Vec<u32> = snapshot.records.iter().map(|r| r.point_id).collect();
+        ids.sort_unstable();
+        assert_eq!(ids, vec![3, 4, 12, 205]);
+
+        // Restored by the writer after a restart
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        register(&mut writer);
+        assert_eq!(writer.restore_snapshot(&snapshot), 4);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        assert_eq!(reader.get_measurement(5, 3), Some(30.0));
+        assert_eq!(reader.get_measurement(5, 7), Some(0.0));
+        assert_eq!(reader.get_action(5, 12), Some(1.0));
+        assert_eq!(reader.get_channel_telemetry(1001, 205), Some(2.5));
+        assert_eq!(reader.get_channel_telemetry(1001, 101), Some(0.0));
+        assert_eq!(reader.get_channel(1001, PointType::Signal, 4), Some(1.0));
+        drop(reader);
+
+        // Offline restore resolves the same IDs
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        register(&mut writer);
+        assert_eq!(restore_snapshot_into(&config, &snapshot).unwrap(), 4);
+        let point = writer
+            .get_channel_consistent(1001, PointType::Telemetry, 205)
+            .unwrap();
+        assert_eq!(point.value, 2.5);
+        assert_eq!(point.quality, point_quality::RESTORED);
+        assert!(writer
+            .get_channel_consistent(1001, PointType::Telemetry, 101)
+            .is_some_and(|point| point.timestamp == 0));
+
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_read_batch_columns() {
+        let config = test_config("read_batch");
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(5, &[0, 1, 2], &[0]).unwrap();
+        writer.register_instance(6, &[0], &[]).unwrap();
+        writer
+            .register_channel(1001, &[0, 1], &[0], &[], &[])
+            .unwrap();
+        writer.set_measurement(5, 1, 11.0, 1000);
+        writer.set_measurement(6, 0, 63.0, 1001);
+        writer.set_action(5, 0, 57.0, 1002);
+        writer.set_channel(1001, PointType::Signal, 0, 1.0, 1003);
+
+        let reader = SharedVecRtdbReader::open(&config).unwrap();
+        let signal_idx = ChannelIndex::point_type_to_index(PointType::Signal) as u8;
+        let columns = reader.read_batch(&[
+            BatchReadTarget {
+                area: SnapshotArea::Instance,
+                owner_id: 5,
+                type_idx: 0,
+                point_ids: None,
+            },
+            BatchReadTarget {
+                area: SnapshotArea::Instance,
+                owner_id: 6,
+                type_idx: 0,
+                // Unregistered point is skipped
+                point_ids: Some(vec![0, 9]),
+            },
+            BatchReadTarget {
+                area: SnapshotArea::Instance,
+                owner_id: 5,
+                type_idx: 1,
+                point_ids: Some(vec![0]),
+            },
+            BatchReadTarget {
+                area: SnapshotArea::Channel,
+                owner_id: 1001,
+                type_idx: signal_idx,
+                point_ids: None,
+            },
+            // Unknown owner is skipped
+            BatchReadTarget {
+                area: SnapshotArea::Channel,
+                owner_id: 4242,
+                type_idx: 0,
+                point_ids: None,
+            },
+        ]);
+
+        assert_eq!(columns.owner_ids, vec![5, 5, 5, 6, 5, 1001]);
+        assert_eq!(columns.point_ids, vec![0, 1, 2, 0, 0, 0]);
+        assert_eq!(columns.values, vec![0.0, 11.0, 0.0, 63.0, 57.0, 1.0]);
+        assert_eq!(columns.timestamps[1], 1000);
+        assert_eq!(columns.type_idx[4], 1);
+        assert_eq!(columns.areas[5], SnapshotArea::Channel as u8);
+        assert_eq!(columns.type_idx[5], signal_idx);
+
+        // The writer resolves the same targets from its own layouts
+        let targets = [BatchReadTarget {
+            area: SnapshotArea::Instance,
+            owner_id: 5,
+            type_idx: 0,
+            point_ids: Some(vec![1]),
+        }];
+        assert_eq!(writer.read_batch(&targets), reader.read_batch(&targets));
+
+        std::fs::remove_file(&config.path).ok();
+    }
 }
@@ -0,0 +1,315 @@
+//! Warm-start snapshots of the shared memory RTDB
+//!
+//! `SharedVecRtdbWriter::open` recreates the shared memory file, so every
+//! slot reads zero until the first successful poll after a comsrv restart.
+//! A snapshot stores the last slot contents keyed by point identity
+//! (instance/channel ID, point type, point ID) rather than by slot offset,
+//! because registration order, and with it the slot layout, can differ
+//! between runs. Restored points carry [`point_quality::RESTORED`] until
+//! the next live write resets the quality.
+//!
+//! # File Format (v1, little-endian)
+//!
+//! ```text
+//! ┌──────────────────────────────────────────────┐
+//! │ Header (64 bytes)                            │
+//! │   magic u64 (SHARED_MAGIC), version u32,     │
+//! │   record_size u32, record_count u64,         │
+//! │   created_ms u64, checksum u64 (FNV-1a)      │
+//! ├──────────────────────────────────────────────┤
+//! │ Record[] (40 bytes each)                     │
+//! │   owner_id u32, point_id u32, area u8,       │
+//! │   type_idx u8, quality u8, reserved[5],      │
+//! │   value f64, raw f64, timestamp u64          │
+//! └──────────────────────────────────────────────┘
+//! ```
+//!
+//! Records are fixed-size, so the file can be mapped and indexed directly.
+//! Files are written to a temporary sibling, fsynced and renamed over the
+//! previous snapshot: a crash leaves either the old or the new file intact.
+
+use crate::shared_impl::{default_shm_path, SHARED_MAGIC};
+use crate::vec_impl::PointSnapshot;
+use anyhow::{bail, Context, Result};
+use std::io::Write;
+use std::path::{Path, PathBuf};
+
+/// Snapshot format version
+pub const SNAPSHOT_VERSION: u32 = 1;
+
+/// Snapshot header size in bytes
+pub const SNAPSHOT_HEADER_SIZE: usize = 64;
+
+/// Snapshot record size in bytes
+pub const SNAPSHOT_RECORD_SIZE: usize = 40;
+
+/// Default interval between periodic snapshots (seconds)
+pub const DEFAULT_SNAPSHOT_INTERVAL_SECS: usize = 30;
+
+/// Point quality codes stored in `PointSlot` flags (7 bits)
+pub mod point_quality {
+    /// Live value from acquisition
+    pub const GOOD: u8 = 0;
+    /// Restored from a warm-start snapshot, not refreshed since
+    pub const RESTORED: u8 = 0x40;
+}
+
+/// Get the default snapshot path
+///
+/// `VOLTAGE_SHM_SNAPSHOT_PATH` if set, otherwise next to the shared memory
+/// file with a `.snap` extension.
+pub fn default_snapshot_path() -> PathBuf {
+    if let Ok(path) = std::env::var("VOLTAGE_SHM_SNAPSHOT_PATH") {
+        return PathBuf::from(path);
+    }
+    default_shm_path().with_extension("snap")
+}
+
+/// Shared memory area a snapshot record belongs to
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SnapshotArea {
+    /// Instance point (`type_idx`: 0 = M, 1 = A)
+    Instance = 0,
+    /// Channel point (`type_idx`: `ChannelIndex::TELEMETRY..=ADJUSTMENT`)
+    Channel = 1,
+}
+
+/// One point in a snapshot
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SnapshotRecord {
+    pub area: SnapshotArea,
+    /// Instance or channel ID
+    pub owner_id: u32,
+    /// Point type index within the area
+    pub type_idx: u8,
+    pub point_id: u32,
+    pub point: PointSnapshot,
+}
+
+/// Point-identity snapshot of the shared memory slots
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct RtdbSnapshot {
+    /// Creation time (milliseconds since epoch)
+    pub created_ms: u64,
+    pub records: Vec<SnapshotRecord>,
+}
+
+impl RtdbSnapshot {
+    /// Encode to the v1 file format
+    pub fn encode(&self) -> Vec<u8> {
+        let mut body = Vec::with_capacity(self.records.len() * SNAPSHOT_RECORD_SIZE);
+        for record in &self.records {
+            body.extend_from_slice(&record.owner_id.to_le_bytes());
+            body.extend_from_slice(&record.point_id.to_le_bytes());
+            body.push(record.area as u8);
+            body.push(record.type_idx);
+            body.push(record.point.quality);
+            body.extend_from_slice(&[0u8; 5]);
+            body.extend_from_slice(&record.point.value.to_bits().to_le_bytes());
+            body.extend_from_slice(&record.point.raw.to_bits().to_le_bytes());
+            body.extend_from_slice(&record.point.timestamp.to_le_bytes());
+        }
+
+        let mut out = Vec::with_capacity(SNAPSHOT_HEADER_SIZE + body.len());
+        out.extend_from_slice(&SHARED_MAGIC.to_le_bytes());
+        out.extend_from_slice(&SNAPSHOT_VERSION.to_le_bytes());
+        out.extend_from_slice(&(SNAPSHOT_RECORD_SIZE as u32).to_le_bytes());
+        out.extend_from_slice(&(self.records.len() as u64).to_le_bytes());
+        out.extend_from_slice(&self.created_ms.to_le_bytes());
+        out.extend_from_slice(&fnv1a64(&body).to_le_bytes());
+        out.resize(SNAPSHOT_HEADER_SIZE, 0);
+        out.extend_from_slice(&body);
+        out
+    }
+
+    /// Decode a v1 snapshot, validating magic, version, size and checksum
+    pub fn decode(bytes: &[u8]) -> Result<Self> {
+        if bytes.len() < SNAPSHOT_HEADER_SIZE {
+            bail!("Snapshot too short: {} bytes", bytes.len());
+        }
+        let magic = read_u64(bytes, 0);
+        if magic != SHARED_MAGIC {
+            bail!(
+                "Invalid snapshot magic: expected {:016x}, got {:016x}",
+                SHARED_MAGIC,
+                magic
+            );
+        }
+        let version = read_u32(bytes, 8);
+        if version != SNAPSHOT_VERSION {
+            bail!("Unsupported snapshot version {}", version);
+        }
+        let record_size = read_u32(bytes, 12) as usize;
+        if record_size != SNAPSHOT_RECORD_SIZE {
+            bail!("Unexpected snapshot record size {}", record_size);
+        }
+        let record_count = read_u64(bytes, 16) as usize;
+        let created_ms = read_u64(bytes, 24);
+        let checksum = read_u64(bytes, 32);
+
+        let body = &bytes[SNAPSHOT_HEADER_SIZE..];
+        if record_count.checked_mul(SNAPSHOT_RECORD_SIZE) != Some(body.len()) {
+            bail!(
+                "Snapshot size mismatch: {} records, {} body bytes",
+                record_count,
+                body.len()
+            );
+        }
+        if fnv1a64(body) != checksum {
+            bail!("Snapshot checksum mismatch");
+        }
+
+        let records = body
+            .chunks_exact(SNAPSHOT_RECORD_SIZE)
+            .map(|chunk| {
+                let area = match chunk[8] {
+                    0 => SnapshotArea::Instance,
+                    1 => SnapshotArea::Channel,
+                    other => bail!("Invalid snapshot area {}", other),
+                };
+                Ok(SnapshotRecord {
+                    area,
+                    owner_id: read_u32(chunk, 0),
+                    type_idx: chunk[9],
+                    point_id: read_u32(chunk, 4),
+                    point: PointSnapshot {
+                        value: f64::from_bits(read_u64(chunk, 16)),
+                        raw: f64::from_bits(read_u64(chunk, 24)),
+                        timestamp: read_u64(chunk, 32),
+                        quality: chunk[10],
+                    },
+                })
+            })
+            .collect::<Result<_>>()?;
+
+        Ok(Self {
+            created_ms,
+            records,
+        })
+    }
+
+    /// Write atomically: temporary sibling, fsync, rename
+    pub fn write_to(&self, path: &Path) -> Result<()> {
+        if let Some(parent) = path.parent() {
+            std::fs::create_dir_all(parent)
+                .with_context(|| format!("Failed to create directory: {:?}", parent))?;
+        }
+
+        let mut tmp_path = path.as_os_str().to_owned();
+        tmp_path.push(".tmp");
+        let tmp_path = PathBuf::from(tmp_path);
+
+        let mut file = std::fs::File::create(&tmp_path)
+            .with_context(|| format!("Failed to create snapshot file: {:?}", tmp_path))?;
+        file.write_all(&self.encode())
+            .context("Failed to write snapshot")?;
+        file.sync_all().context("Failed to sync snapshot")?;
+        std::fs::rename(&tmp_path, path)
+            .with_context(|| format!("Failed to move snapshot into place: {:?}", path))?;
+        Ok(())
+    }
+
+    /// Read and validate a snapshot file
+    pub fn read_from(path: &Path) -> Result<Self> {
+        let bytes = std::fs::read(path)
+            .with_context(|| format!("Failed to read snapshot file: {:?}", path))?;
+        Self::decode(&bytes).with_context(|| format!("Invalid snapshot file: {:?}", path))
+    }
+}
+
+/// FNV-1a 64-bit hash (snapshot checksum)
+fn fnv1a64(bytes: &[u8]) -> u64 {
+    let mut hash: u64 = 0xcbf29ce484222325;
+    for &byte in bytes {
+        hash ^= u64::from(byte);
+        hash = hash.wrapping_mul(0x100000001b3);
+    }
+    hash
+}
+
+#[inline]
+fn read_u32(bytes: &[u8], offset: usize) -> u32 {
+    let mut buf = [0u8; 4];
+    buf.copy_from_slice(&bytes[offset..offset + 4]);
+    u32::from_le_bytes(buf)
+}
+
+#[inline]
+fn read_u64(bytes: &[u8], offset: usize) -> u64 {
+    let mut buf = [0u8; 8];
+    buf.copy_from_slice(&bytes[offset..offset + 8]);
+    u64::from_le_bytes(buf)
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+
+    fn sample_snapshot() -> RtdbSnapshot {
+        RtdbSnapshot {
+            created_ms: 1729000000,
+            records: vec![
+                SnapshotRecord {
+                    area: SnapshotArea::Instance,
+                    owner_id: 5,
+                    type_idx: 0,
+                    point_id: 1,
+                    point: PointSnapshot {
+                        value: 100.5,
+                        raw: 1005.0,
+                        timestamp: 1728999999,
+                        quality: 0,
+                    },
+                },
+                SnapshotRecord {
+                    area: SnapshotArea::Channel,
+                    owner_id: 1001,
+                    type_idx: 1,
+                    point_id: 7,
+                    point: PointSnapshot {
+                        value: 1.0,
+                        raw: 1.0,
+                        timestamp: 1728999998,
+                        quality: 3,
+                    },
+                },
+            ],
+        }
+    }
+
+    #[test]
+    fn test_snapshot_encode_decode_roundtrip() {
+        let snapshot = sample_snapshot();
+        let bytes = snapshot.encode();
+        assert_eq!(bytes.len(), SNAPSHOT_HEADER_SIZE + 2 * SNAPSHOT_RECORD_SIZE);
+        assert_eq!(RtdbSnapshot::decode(&bytes).unwrap(), snapshot);
+    }
+
+    #[test]
+    fn test_snapshot_rejects_corruption() {
+        let mut bytes = sample_snapshot().encode();
+
+        // Flipped value bit fails the checksum
+        bytes[SNAPSHOT_HEADER_SIZE + 16] ^= 1;
+        assert!(RtdbSnapshot::decode(&bytes).is_err());
+        bytes[SNAPSHOT_HEADER_SIZE + 16] ^= 1;
+
+        // Truncated body fails the size check
+        assert!(RtdbSnapshot::decode(&bytes[..bytes.len() - 1]).is_err());
+
+        // Wrong magic
+        bytes[0] ^= 0xFF;
+        assert!(RtdbSnapshot::decode(&bytes).is_err());
+    }
+
+    #[test]
+    fn test_snapshot_file_roundtrip() {
+        let path =
+            std::env::temp_dir().join(format!("voltage_snapshot_test_{}.snap", std::process::id()));
+        let snapshot = sample_snapshot();
+        snapshot.write_to(&path).unwrap();
+        assert_eq!(RtdbSnapshot::read_from(&path).unwrap(), snapshot);
+        std::fs::remove_file(&path).ok();
+    }
+}
@@ -5,6 +5,10 @@ use bytes::Bytes;
 use std::any::Any;
 use std::collections::HashMap;
 use std::future::Future;
+use std::sync::Arc;
+
+/// Hash fields with shared names, as buffered by `WriteBuffer`
+pub type SharedHashFields = Vec<(Arc<str>, Bytes)>;
 
 /// Unified RTDB Storage Trait
 ///
@@ -29,6 +33,15 @@ pub trait Rtdb: Send + Sync + 'static {
     /// like RedisRtdb or MemoryRtdb when needed.
     fn as_any(&self) -> &dyn Any;
 
+    /// Number of backend shards
+    ///
+    /// Sharded backends place channel keys on shard `channel_id % shard_count`;
+    /// callers that block on many keys at once (the comsrv command dispatcher)
+    /// align their own partitioning to it so each wait stays on one shard.
+    fn shard_count(&self) -> usize {
+        1
+    }
+
     // ========== Basic Key-Value Operations ==========
 
     /// Get value by key
@@ -44,6 +57,9 @@ pub trait Rtdb: Send + Sync + 'static {
     /// Delete key
     fn del<'a>(&'a self, key: &'a str) -> impl Future<Output = Result<bool>> + Send + 'a;
 
+    /// Set many plain keys in one round-trip (Redis MSET)
+    fn mset(&self, entries: Vec<(String, Bytes)>) -> impl Future<Output = Result<()>> + Send + '_;
+
     /// Check if key exists
     fn exists<'a>(&'a self, key: &'a str) -> impl Future<Output = Result<bool>> + Send + 'a;
 
@@ -323,6 +339,37 @@ pub trait Rtdb: Send + Sync + 'static {
         operations: Vec<(String, Vec<(String, Bytes)>)>,
     ) -> impl Future<Output = Result<()>> + Send + '_;
 
+    /// [`pipeline_hash_mset`](Self::pipeline_hash_mset) with shared field names
+    ///
+    /// WriteBuffer flush path: keys and fields stay `Arc<str>` so backends
+    /// that can borrow them (Redis) skip the per-field `String` allocation.
+    fn pipeline_hash_mset_shared(
+        &self,
+        operations: Vec<(Arc<str>, SharedHashFields)>,
+    ) -> impl Future<Output = Result<()>> + Send + '_ {
+        let operations = operations
+            .into_iter()
+            .map(|(key, fields)| {
+                let fields = fields
+                    .into_iter()
+                    .map(|(f, v)| (f.to_string(), v))
+                    .collect();
+                (key.to_string(), fields)
+            })
+            .collect();
+        self.pipeline_hash_mset(operations)
+    }
+
+    /// Append entries to Redis Streams in a single pipeline (XADD MAXLEN ~)
+    ///
+    /// WriteBuffer history export path: each entry is (stream key, fields) and
+    /// gets an auto-generated ID. Streams are trimmed to roughly `max_len`.
+    fn pipeline_stream_add(
+        &self,
+        entries: Vec<(Arc<str>, SharedHashFields)>,
+        max_len: usize,
+    ) -> impl Future<Output = Result<()>> + Send + '_;
+
     // ========== Convenience Operations (with default implementations) ==========
 
     /// Write point data in initialization mode (no routing trigger)
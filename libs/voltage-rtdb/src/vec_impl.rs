@@ -23,7 +23,7 @@
 
 use parking_lot::RwLock;
 use rustc_hash::FxHashMap;
-use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::atomic::{fence, AtomicU32, AtomicU64, Ordering};
 
 // ========== Instance Point Type Constants ==========
 
@@ -41,10 +41,32 @@ pub mod instance_point_type {
 
 // ========== PointSlot ==========
 
+/// Consistent snapshot of a [`PointSlot`]
+///
+/// All fields come from the same write, as guaranteed by the slot's
+/// sequence counter (see [`PointSlot::read_consistent`]).
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PointSnapshot {
+    /// Engineering value
+    pub value: f64,
+    /// Raw value
+    pub raw: f64,
+    /// Timestamp in milliseconds
+    pub timestamp: u64,
+    /// Quality code (7 bits, 0 = good)
+    pub quality: u8,
+}
+
 /// Point slot for atomic storage of point data
 ///
 /// 32-byte aligned for cache-line friendliness.
-/// Uses atomic operations for lock-free concurrent access.
+/// Uses a sequence counter (seqlock) so that readers observe value, raw,
+/// timestamp and quality from the same write without taking a lock.
+///
+/// # Seqlock protocol
+/// - Writer: bump `seq` to odd, store fields, bump `seq` to even (Release)
+/// - Reader: load `seq` (Acquire), load fields, re-check `seq`; retry on
+///   odd or changed sequence
 #[repr(C, align(32))]
 pub struct PointSlot {
     /// Engineering value (IEEE 754 double as bits)
@@ -53,8 +75,10 @@ pub struct PointSlot {
     timestamp: AtomicU64,
     /// Raw value (as bits)
     raw_bits: AtomicU64,
+    /// Sequence counter: odd = write in progress, even = stable
+    seq: AtomicU32,
     /// Flags: bit 0 = dirty, bits 1-7 = quality
-    flags: AtomicU64,
+    flags: AtomicU32,
 }
 
 impl Default for PointSlot {
@@ -64,13 +88,21 @@ impl Default for PointSlot {
 }
 
 impl PointSlot {
+    /// Dirty flag bit
+    const DIRTY: u32 = 1;
+
+    /// Max read attempts before giving up on a slot whose writer never finishes
+    /// (e.g. the writer process died in the middle of `set`)
+    const MAX_READ_RETRIES: u32 = 1024;
+
     /// Create a new empty point slot
     pub const fn new() -> Self {
         Self {
             value_bits: AtomicU64::new(0),
             timestamp: AtomicU64::new(0),
             raw_bits: AtomicU64::new(0),
-            flags: AtomicU64::new(0),
+            seq: AtomicU32::new(0),
+            flags: AtomicU32::new(0),
         }
     }
 
@@ -98,31 +130,111 @@ impl PointSlot {
         f64::from_bits(self.raw_bits.load(Ordering::Relaxed))
     }
 
-    /// Set all point data atomically (per-field)
+    /// Get the quality code (bits 1-7 of flags)
+    #[inline]
+    pub fn get_quality(&self) -> u8 {
+        ((self.flags.load(Ordering::Relaxed) >> 1) & 0x7F) as u8
+    }
+
+    /// Get the current sequence number (even = stable)
+    #[inline]
+    pub fn sequence(&self) -> u32 {
+        self.seq.load(Ordering::Acquire)
+    }
+
+    /// Set all point data with good quality
     ///
-    /// Uses Release ordering on timestamp to ensure value/raw writes are visible
-    /// to readers that use Acquire ordering on timestamp. This prevents torn reads
-    /// where a reader might see a new timestamp but old value/raw values.
+    /// See [`set_with_quality`](Self::set_with_quality).
     #[inline]
     pub fn set(&self, value: f64, raw: f64, timestamp: u64) {
+        self.set_with_quality(value, raw, timestamp, 0);
+    }
+
+    /// Set all point data under the slot's sequence counter
+    ///
+    /// Readers using [`read_consistent`](Self::read_consistent) never observe
+    /// a mix of fields from two different writes. Concurrent writers to the
+    /// same slot are serialized by the CAS on the sequence counter.
+    #[inline]
+    pub fn set_with_quality(&self, value: f64, raw: f64, timestamp: u64, quality: u8) {
+        // Enter write section: even → odd
+        let mut seq = self.seq.load(Ordering::Relaxed);
+        loop {
+            if seq & 1 == 0 {
+                match self.seq.compare_exchange_weak(
+                    seq,
+                    seq.wrapping_add(1),
+                    Ordering::Acquire,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => break,
+                    Err(current) => seq = current,
+                }
+            } else {
+                std::hint::spin_loop();
+                seq = self.seq.load(Ordering::Relaxed);
+            }
+        }
+        // Odd sequence must be visible before any field store
+        fence(Ordering::Release);
+
         self.value_bits.store(value.to_bits(), Ordering::Relaxed);
         self.raw_bits.store(raw.to_bits(), Ordering::Relaxed);
-        // Release ensures preceding Relaxed stores are visible before this store
-        self.timestamp.store(timestamp, Ordering::Release);
-        // Set dirty flag (after Release, order doesn't matter for correctness)
-        self.flags.fetch_or(1, Ordering::Relaxed);
+        self.timestamp.store(timestamp, Ordering::Relaxed);
+        // Set dirty flag together with quality
+        self.flags.store(
+            Self::DIRTY | (u32::from(quality & 0x7F) << 1),
+            Ordering::Relaxed,
+        );
+
+        // Leave write section: odd → even, publishes the field stores
+        self.seq.store(seq.wrapping_add(2), Ordering::Release);
+    }
+
+    /// Read value, raw, timestamp and quality from the same write
+    ///
+    /// Lock-free: retries while a write is in progress.
+    /// Returns `None` only if the slot stays mid-write for
+    /// `MAX_READ_RETRIES` attempts, which means the writer died inside `set`.
+    #[inline]
+    pub fn read_consistent(&self) -> Option<PointSnapshot> {
+        for _ in 0..Self::MAX_READ_RETRIES {
+            let seq1 = self.seq.load(Ordering::Acquire);
+            if seq1 & 1 != 0 {
+                std::hint::spin_loop();
+                continue;
+            }
+
+            let value_bits = self.value_bits.load(Ordering::Relaxed);
+            let raw_bits = self.raw_bits.load(Ordering::Relaxed);
+            let timestamp = self.timestamp.load(Ordering::Relaxed);
+            let flags = self.flags.load(Ordering::Relaxed);
+
+            // Field loads must complete before the sequence re-check
+            fence(Ordering::Acquire);
+            if self.seq.load(Ordering::Relaxed) == seq1 {
+                return Some(PointSnapshot {
+                    value: f64::from_bits(value_bits),
+                    raw: f64::from_bits(raw_bits),
+                    timestamp,
+                    quality: ((flags >> 1) & 0x7F) as u8,
+                });
+            }
+            std::hint::spin_loop();
+        }
+        None
     }
 
     /// Check if dirty flag is set
     #[inline]
     pub fn is_dirty(&self) -> bool {
-        self.flags.load(Ordering::Relaxed) & 1 != 0
+        self.flags.load(Ordering::Relaxed) & Self::DIRTY != 0
     }
 
     /// Clear the dirty flag
     #[inline]
     pub fn clear_dirty(&self) {
-        self.flags.fetch_and(!1, Ordering::Relaxed);
+        self.flags.fetch_and(!Self::DIRTY, Ordering::Relaxed);
     }
 }
 
@@ -206,9 +318,10 @@ impl ChannelVecStore {
         if slot_idx == Self::INVALID_SLOT {
             return None;
         }
-        // Access slot data
-        let slot = &self.slots[slot_idx as usize];
-        Some((slot.get_value(), slot.get_raw(), slot.get_timestamp()))
+        // Access slot data (consistent snapshot)
+        self.slots[slot_idx as usize]
+            .read_consistent()
+            .map(|snap| (snap.value, snap.raw, snap.timestamp))
     }
 
     /// Set point data by point ID
@@ -476,6 +589,54 @@ mod tests {
         assert!(!slot.is_dirty());
     }
 
+    #[test]
+    fn test_point_slot_read_consistent() {
+        let slot = PointSlot::new();
+        assert_eq!(slot.sequence(), 0);
+
+        slot.set_with_quality(12.5, 125.0, 1729000000, 3);
+        assert_eq!(slot.sequence(), 2);
+
+        let snap = slot.read_consistent().unwrap();
+        assert_eq!(snap.value, 12.5);
+        assert_eq!(snap.raw, 125.0);
+        assert_eq!(snap.timestamp, 1729000000);
+        assert_eq!(snap.quality, 3);
+        assert_eq!(slot.get_quality(), 3);
+
+        // Plain set resets quality to good
+        slot.set(1.0, 1.0, 1729000001);
+        assert_eq!(slot.read_consistent().unwrap().quality, 0);
+    }
+
+    #[test]
+    fn test_point_slot_concurrent_no_torn_reads() {
+        use std::sync::Arc;
+
+        let slot = Arc::new(PointSlot::new());
+        let writer_slot = Arc::clone(&slot);
+
+        let writer = std::thread::spawn(move || {
+            for i in 1..=200_000u64 {
+                writer_slot.set(i as f64, i as f64, i);
+            }
+        });
+
+        let mut reads = 0;
+        while !writer.is_finished() {
+            if let Some(snap) = slot.read_consistent() {
+                // All fields must come from the same write
+                assert_eq!(snap.value, snap.raw);
+                assert_eq!(snap.value, snap.timestamp as f64);
+                reads += 1;
+            }
+        }
+        writer.join().unwrap();
+
+        assert!(reads > 0);
+        assert_eq!(slot.read_consistent().unwrap().timestamp, 200_000);
+    }
+
     #[test]
     fn test_channel_vec_store() {
         let store = ChannelVecStore::new(1001, 0, &[1, 2, 3]);
@@ -7,6 +7,12 @@
 //! - Reduces Redis round-trips by aggregating writes
 //! - Non-blocking writes for callers (fire-and-forget)
 //! - Configurable flush interval and capacity limits
+//! - Pending map swapped out under a short write lock: the flusher drains
+//!   the retired map while producers fill a fresh one
+//! - Typed channel/instance path: Redis keys rendered once per hash, points
+//!   stored by dense index, values formatted at flush time
+//! - Optional history stream: each flush also appends the typed changes to
+//!   `comsrv:history` / `inst:history` (Redis Streams) for hissrv
 //!
 //! # Usage
 //! ```ignore
@@ -24,13 +30,23 @@
 
 use bytes::Bytes;
 use dashmap::DashMap;
+use parking_lot::{Mutex, RwLock};
+use rustc_hash::FxHashMap;
 use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::Arc;
 use std::time::Duration;
 use tokio::sync::Notify;
+use voltage_model::{KeySpaceConfig, PointRole, PointType};
 
+use crate::metrics::LatencyHistogram;
+use crate::numfmt::{f64_to_bytes, i64_to_bytes, precomputed};
+use crate::time::{SystemTimeProvider, TimeProvider};
+use crate::traits::SharedHashFields;
 use crate::Rtdb;
 
+/// Largest point ID kept in a typed hash's dense index (larger IDs use the string path)
+const MAX_TYPED_POINT_ID: u32 = 65535;
+
 /// Write buffer configuration
 #[derive(Clone, Debug)]
 pub struct WriteBufferConfig {
@@ -80,6 +96,12 @@ pub struct WriteBufferStats {
     pub forced_flushes: AtomicU64,
     /// Number of flush errors
     pub flush_errors: AtomicU64,
+    /// Total number of history stream entries appended
+    pub history_entries: AtomicU64,
+    /// History entries lost because the retry backlog was full
+    pub history_dropped: AtomicU64,
+    /// Duration of flushes that wrote data (drain + pipeline round trips)
+    pub flush_latency: LatencyHistogram,
 }
 
 impl WriteBufferStats {
@@ -91,6 +113,8 @@ impl WriteBufferStats {
             fields_flushed: self.fields_flushed.load(Ordering::Relaxed),
             forced_flushes: self.forced_flushes.load(Ordering::Relaxed),
             flush_errors: self.flush_errors.load(Ordering::Relaxed),
+            history_entries: self.history_entries.load(Ordering::Relaxed),
+            history_dropped: self.history_dropped.load(Ordering::Relaxed),
         }
     }
 }
@@ -103,6 +127,115 @@ pub struct WriteBufferStatsSnapshot {
     pub fields_flushed: u64,
     pub forced_flushes: u64,
     pub flush_errors: u64,
+    pub history_entries: u64,
+    pub history_dropped: u64,
+}
+
+/// Pending data: key -> {field -> value}
+type PendingMap = DashMap<String, DashMap<Arc<str>, Bytes>>;
+
+/// Drained history stream entries: (stream key, fields)
+type StreamEntries = Vec<(Arc<str>, SharedHashFields)>;
+
+/// Stream entry field holding the source hash key (e.g. `inst:1:M`)
+const HISTORY_KEY_FIELD: &str = "key";
+
+/// Stream entry field holding the sample timestamp (ms)
+const HISTORY_TS_FIELD: &str = "ts";
+
+/// Integer identity of a buffered Redis hash
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+enum TypedKey {
+    /// `comsrv:{id}:{T|S|C|A}` with its `:ts` and `:raw` layers
+    Channel(u32, PointType),
+    /// `inst:{id}:M`
+    InstanceMeasurement(u32),
+    /// `inst:{id}:A`
+    InstanceAction(u32),
+}
+
+impl TypedKey {
+    /// Hash keys written per point (value, then ts and raw for channels)
+    fn render(self, keyspace: &KeySpaceConfig) -> Vec<Arc<str>> {
+        match self {
+            TypedKey::Channel(id, point_type) => vec![
+                Arc::from(keyspace.channel_key(id, point_type)),
+                Arc::from(keyspace.channel_ts_key(id, point_type)),
+                Arc::from(keyspace.channel_raw_key(id, point_type)),
+            ],
+            TypedKey::InstanceMeasurement(id) => {
+                vec![Arc::from(keyspace.instance_measurement_key(id))]
+            },
+            TypedKey::InstanceAction(id) => vec![Arc::from(keyspace.instance_action_key(id))],
+        }
+    }
+
+    /// History stream receiving this hash's changes
+    fn history_stream(self, keyspace: &KeySpaceConfig) -> Arc<str> {
+        match self {
+            TypedKey::Channel(..) => Arc::from(keyspace.channel_history_stream_key()),
+            TypedKey::InstanceMeasurement(_) | TypedKey::InstanceAction(_) => {
+                Arc::from(keyspace.instance_history_stream_key())
+            },
+        }
+    }
+}
+
+/// Latest buffered state of one point; formatted to bytes at flush time
+#[derive(Debug, Clone, Copy)]
+struct TypedPoint {
+    value: f64,
+    raw: f64,
+    timestamp_ms: i64,
+}
+
+/// One registered hash: rendered keys plus points by dense index
+struct TypedHash {
+    keys: Vec<Arc<str>>,
+    /// History stream key (see `WriteBuffer::with_history_stream`)
+    stream: Arc<str>,
+    pending: Mutex<TypedPending>,
+}
+
+#[derive(Default)]
+struct TypedPending {
+    /// point_id -> dense index (u32::MAX = not seen yet)
+    index: Vec<u32>,
+    /// Field name per dense index
+    fields: Vec<Arc<str>>,
+    /// Pending point per dense index
+    points: Vec<Option<TypedPoint>>,
+    /// Dense indices holding a pending point
+    dirty: Vec<u32>,
+}
+
+impl TypedPending {
+    /// Store a point, returning false for IDs outside the dense range
+    #[inline]
+    fn set(&mut self, point_id: u32, point: TypedPoint) -> bool {
+        if point_id > MAX_TYPED_POINT_ID {
+            return false;
+        }
+        let pid = point_id as usize;
+        if pid >= self.index.len() {
+            self.index.resize(pid + 1, u32::MAX);
+        }
+        let mut idx = self.index[pid];
+        if idx == u32::MAX {
+            // First sight of this point: render its field name once
+            idx = self.fields.len() as u32;
+            self.index[pid] = idx;
+            self.fields
+                .push(precomputed::get_point_id_str_or_alloc(point_id));
+            self.points.push(None);
+        }
+        let slot = &mut self.points[idx as usize];
+        if slot.is_none() {
+            self.dirty.push(idx);
+        }
+        *slot = Some(point);
+        true
+    }
 }
 
 /// Hash write buffer for aggregating Redis hash operations
@@ -113,10 +246,21 @@ pub struct WriteBufferStatsSnapshot {
 /// # Performance Optimization
 /// Field names use `Arc<str>` internally to avoid string clones in
 /// 3-layer writes (value/timestamp/raw). `Arc::clone()` is O(1).
+/// Flushing swaps the pending map and hands fields to the backend as
+/// `Arc<str>` + `Bytes` without copying.
 pub struct WriteBuffer {
-    /// Pending data: key -> {field -> value}
+    /// Pending data; producers write under the read lock, the flusher swaps
+    /// the map out under the write lock
     /// Field names use Arc<str> for O(1) cloning in multi-layer writes
-    pending: DashMap<String, DashMap<Arc<str>, Bytes>>,
+    pending: RwLock<PendingMap>,
+    /// Typed channel/instance hashes, registered on first write
+    typed: RwLock<FxHashMap<TypedKey, Arc<TypedHash>>>,
+    /// Keyspace used to render typed hash keys
+    keyspace: KeySpaceConfig,
+    /// History stream length cap; `None` = no history export
+    history_max_len: Option<usize>,
+    /// History entries whose append failed, retried first on the next flush
+    history_retry: Mutex<StreamEntries>,
     /// Notification for forced flush
     flush_notify: Arc<Notify>,
     /// Configuration
@@ -129,13 +273,39 @@ impl WriteBuffer {
     /// Create a new write buffer with the given configuration
     pub fn new(config: WriteBufferConfig) -> Self {
         Self {
-            pending: DashMap::new(),
+            pending: RwLock::new(DashMap::new()),
+            typed: RwLock::new(FxHashMap::default()),
+            keyspace: KeySpaceConfig::production(),
+            history_max_len: None,
+            history_retry: Mutex::new(Vec::new()),
             flush_notify: Arc::new(Notify::new()),
             config,
             stats: WriteBufferStats::default(),
         }
     }
 
+    /// Use a non-production keyspace for the typed write path
+    pub fn with_keyspace(mut self, keyspace: KeySpaceConfig) -> Self {
+        self.keyspace = keyspace;
+        self
+    }
+
+    /// Also export typed channel/instance changes to the history streams
+    ///
+    /// Each flush appends one entry per hash and timestamp to
+    /// `comsrv:history` (channels) or `inst:history` (instances), holding
+    /// `key` (the value hash key), `ts` (ms) and one `{point_id}` field per
+    /// changed point. Streams are capped at about `max_len` entries.
+    /// Writes through the string-keyed path are not exported.
+    ///
+    /// Entries of a failed flush are kept and appended first by the next
+    /// one; beyond `max_len` kept entries the oldest are dropped and counted
+    /// in `history_dropped`.
+    pub fn with_history_stream(mut self, max_len: usize) -> Self {
+        self.history_max_len = Some(max_len.max(1));
+        self
+    }
+
     /// Get the configuration
     pub fn config(&self) -> &WriteBufferConfig {
         &self.config
@@ -155,17 +325,21 @@ impl WriteBuffer {
     /// * `field` - Field name as `Arc<str>` for O(1) cloning in 3-layer writes
     /// * `value` - Field value
     pub fn buffer_hash_set(&self, key: &str, field: Arc<str>, value: Bytes) {
+        // Held until the write is in the map, so a flush cannot retire the
+        // map under an in-flight write
+        let pending = self.pending.read();
         // Two-phase check: get_mut first to avoid allocation on hot path
-        let len = if let Some(entry) = self.pending.get_mut(key) {
+        let len = if let Some(entry) = pending.get_mut(key) {
             entry.insert(field, value);
             entry.len()
         } else {
             // Slow path: key doesn't exist, need to allocate
-            let entry = self.pending.entry(key.to_string()).or_default();
+            let entry = pending.entry(key.to_string()).or_default();
             entry.insert(field, value);
             entry.len()
         };
 
+        drop(pending);
         self.stats.buffered_writes.fetch_add(1, Ordering::Relaxed);
 
         // Check if we need to force a flush
@@ -188,22 +362,24 @@ impl WriteBuffer {
         }
 
         let count = fields.len() as u64;
+        let pending = self.pending.read();
 
         // Two-phase check: get_mut first to avoid allocation on hot path
-        let len = if let Some(entry) = self.pending.get_mut(key) {
+        let len = if let Some(entry) = pending.get_mut(key) {
             for (field, value) in fields {
                 entry.insert(field, value);
             }
             entry.len()
         } else {
             // Slow path: key doesn't exist, need to allocate
-            let entry = self.pending.entry(key.to_string()).or_default();
+            let entry = pending.entry(key.to_string()).or_default();
             for (field, value) in fields {
                 entry.insert(field, value);
             }
             entry.len()
         };
 
+        drop(pending);
         self.stats
             .buffered_writes
             .fetch_add(count, Ordering::Relaxed);
@@ -215,47 +391,219 @@ impl WriteBuffer {
         }
     }
 
-    /// Collect and clear all pending data
+    /// Buffer channel points into `comsrv:{id}:{type}` and its `:ts` / `:raw` hashes
+    ///
+    /// Typed equivalent of `helpers::buffer_channel_points`: the three keys
+    /// are rendered once per channel and point type, and values are kept as
+    /// numbers until flush.
     ///
-    /// Optimized to avoid double iteration and unnecessary clones.
-    /// Converts `Arc<str>` field names to `String` for the Rtdb trait.
-    /// This conversion happens at flush time (batched), not per-write.
-    fn drain_pending(&self) -> Vec<(String, Vec<(String, Bytes)>)> {
-        // Pre-allocate with estimated capacity
-        let estimated_len = self.pending.len();
-        let mut operations = Vec::with_capacity(estimated_len);
-
-        // Use retain to iterate and remove in one pass
-        // DashMap::retain provides mutable access and removes entries returning false
-        self.pending.retain(|key, fields_map| {
+    /// # Arguments
+    /// * `channel_id` - Channel ID
+    /// * `point_type` - Point type (T/S/C/A)
+    /// * `points` - (point_id, value, raw_value) tuples
+    /// * `timestamp_ms` - Timestamp in milliseconds
+    ///
+    /// # Returns
+    /// Number of points buffered
+    pub fn buffer_channel(
+        &self,
+        channel_id: u32,
+        point_type: PointType,
+        points: &[(u32, f64, f64)],
+        timestamp_ms: i64,
+    ) -> usize {
+        let points = points.iter().map(|&(point_id, value, raw)| {
+            (
+                point_id,
+                TypedPoint {
+                    value,
+                    raw,
+                    timestamp_ms,
+                },
+            )
+        });
+        self.buffer_typed(TypedKey::Channel(channel_id, point_type), points)
+    }
+
+    /// Buffer instance point values into `inst:{id}:M` or `inst:{id}:A`
+    ///
+    /// # Returns
+    /// Number of points buffered
+    pub fn buffer_instance(
+        &self,
+        instance_id: u32,
+        role: PointRole,
+        values: &[(u32, f64)],
+    ) -> usize {
+        let key = match role {
+            PointRole::Measurement => TypedKey::InstanceMeasurement(instance_id),
+            PointRole::Action => TypedKey::InstanceAction(instance_id),
+        };
+        let points = values.iter().map(|&(point_id, value)| {
+            (
+                point_id,
+                TypedPoint {
+                    value,
+                    raw: value,
+                    timestamp_ms: 0,
+                },
+            )
+        });
+        self.buffer_typed(key, points)
+    }
+
+    fn buffer_typed(
+        &self,
+        key: TypedKey,
+        points: impl ExactSizeIterator<Item = (u32, TypedPoint)>,
+    ) -> usize {
+        let count = points.len();
+        if count == 0 {
+            return 0;
+        }
+
+        let hash = self.typed.read().get(&key).cloned();
+        let hash = match hash {
+            Some(hash) => hash,
+            None => {
+                // Registration: render the Redis keys once
+                let mut typed = self.typed.write();
+                Arc::clone(typed.entry(key).or_insert_with(|| {
+                    Arc::new(TypedHash {
+                        keys: key.render(&self.keyspace),
+                        stream: key.history_stream(&self.keyspace),
+                        pending: Mutex::new(TypedPending::default()),
+                    })
+                }))
+            },
+        };
+
+        let mut overflow = Vec::new();
+        let pending_len = {
+            let mut pending = hash.pending.lock();
+            for (point_id, point) in points {
+                if !pending.set(point_id, point) {
+                    overflow.push((point_id, point));
+                }
+            }
+            pending.dirty.len()
+        };
+
+        self.stats.buffered_writes.fetch_add(
+            ((count - overflow.len()) * hash.keys.len()) as u64,
+            Ordering::Relaxed,
+        );
+
+        // Point IDs outside the dense range go through the string-keyed maps
+        for (point_id, point) in overflow {
+            let field = precomputed::get_point_id_str_or_alloc(point_id);
+            for (layer, key) in hash.keys.iter().enumerate() {
+                self.buffer_hash_set(key, Arc::clone(&field), render_layer(&point, layer));
+            }
+        }
+
+        if pending_len >= self.config.max_fields_per_key {
+            self.stats.forced_flushes.fetch_add(1, Ordering::Relaxed);
+            self.flush_notify.notify_one();
+        }
+
+        count
+    }
+
+    /// Collect pending typed points, rendering them outside the per-hash lock
+    ///
+    /// With history export enabled, the value layer is also rendered into
+    /// stream entries, one per distinct point timestamp.
+    fn drain_typed(
+        &self,
+        operations: &mut Vec<(Arc<str>, SharedHashFields)>,
+        history: &mut StreamEntries,
+    ) {
+        let export = self.history_max_len.is_some();
+        let now_ms = SystemTimeProvider.now_millis();
+        let typed = self.typed.read();
+        for hash in typed.values() {
+            let taken: Vec<(Arc<str>, TypedPoint)> = {
+                let mut pending = hash.pending.lock();
+                if pending.dirty.is_empty() {
+                    continue;
+                }
+                let dirty = std::mem::take(&mut pending.dirty);
+                dirty
+                    .into_iter()
+                    .filter_map(|idx| {
+                        let idx = idx as usize;
+                        let point = pending.points[idx].take()?;
+                        Some((Arc::clone(&pending.fields[idx]), point))
+                    })
+                    .collect()
+            };
+
+            let mut layers: Vec<SharedHashFields> = hash
+                .keys
+                .iter()
+                .map(|_| Vec::with_capacity(taken.len()))
+                .collect();
+            for (field, point) in &taken {
+                for (layer, fields) in layers.iter_mut().enumerate() {
+                    fields.push((Arc::clone(field), render_layer(point, layer)));
+                }
+            }
+            if export {
+                history_entries(hash, &taken, now_ms, history);
+            }
+            operations.extend(hash.keys.iter().cloned().zip(layers));
+        }
+    }
+
+    /// Swap in an empty map and collect the retired one
+    ///
+    /// The write lock waits for writes in flight, so every write is either
+    /// in the retired map or in the fresh one: a later value for a field can
+    /// never be flushed before an earlier one. It is held only for the swap.
+    /// Fields are moved out as-is (no per-field allocation).
+    /// Typed hashes are drained under their own lock.
+    fn drain_pending(&self) -> (Vec<(Arc<str>, SharedHashFields)>, StreamEntries) {
+        let retired = std::mem::take(&mut *self.pending.write());
+        let mut operations = Vec::with_capacity(retired.len());
+
+        for (key, fields_map) in retired {
             if !fields_map.is_empty() {
-                // Convert Arc<str> to String at flush time
-                // Drain the inner map to avoid cloning
-                let fields: Vec<_> = fields_map
-                    .iter()
-                    .map(|entry| (entry.key().to_string(), entry.value().clone()))
-                    .collect();
-
-                // Clear the inner map instead of removing outer entry
-                // This allows potential reuse of the DashMap allocation
-                fields_map.clear();
-
-                operations.push((key.clone(), fields));
+                operations.push((Arc::from(key), fields_map.into_iter().collect()));
             }
-            false // Remove all entries after processing
-        });
+        }
 
-        operations
+        let mut history = Vec::new();
+        self.drain_typed(&mut operations, &mut history);
+        (operations, history)
     }
 
     /// Get the number of pending keys
     pub fn pending_keys(&self) -> usize {
-        self.pending.len()
+        let typed: usize = self
+            .typed
+            .read()
+            .values()
+            .filter(|h| !h.pending.lock().dirty.is_empty())
+            .map(|h| h.keys.len())
+            .sum();
+        self.pending.read().len() + typed
     }
 
     /// Get the total number of pending fields across all keys
     pub fn pending_fields(&self) -> usize {
-        self.pending.iter().map(|e| e.value().len()).sum()
+        let typed: usize = self
+            .typed
+            .read()
+            .values()
+            .map(|h| h.pending.lock().dirty.len() * h.keys.len())
+            .sum();
+        self.pending
+            .read()
+            .iter()
+            .map(|e| e.value().len())
+            .sum::<usize>()
+            + typed
     }
 
     /// Background flush loop - runs until cancelled
@@ -335,26 +683,75 @@ impl WriteBuffer {
     where
         R: Rtdb,
     {
-        let operations = self.drain_pending();
+        let started = std::time::Instant::now();
+        let (operations, mut history) = self.drain_pending();
+        {
+            let mut retry = self.history_retry.lock();
+            if !retry.is_empty() {
+                // Older entries first
+                history.splice(0..0, retry.drain(..));
+            }
+        }
 
-        if operations.is_empty() {
+        if operations.is_empty() && history.is_empty() {
             return Ok(0);
         }
 
         let field_count: usize = operations.iter().map(|(_, fields)| fields.len()).sum();
 
-        rtdb.pipeline_hash_mset(operations).await?;
+        if !operations.is_empty() {
+            if let Err(e) = rtdb.pipeline_hash_mset_shared(operations).await {
+                self.retry_history(history);
+                return Err(e);
+            }
+        }
+
+        if let (Some(max_len), false) = (self.history_max_len, history.is_empty()) {
+            let entries = history.len() as u64;
+            // Clones only bump reference counts; kept in case the append fails
+            if let Err(e) = rtdb.pipeline_stream_add(history.clone(), max_len).await {
+                self.retry_history(history);
+                return Err(e);
+            }
+            self.stats
+                .history_entries
+                .fetch_add(entries, Ordering::Relaxed);
+        }
 
         self.stats.flush_count.fetch_add(1, Ordering::Relaxed);
         self.stats
             .fields_flushed
             .fetch_add(field_count as u64, Ordering::Relaxed);
+        self.stats.flush_latency.record(started.elapsed());
 
         tracing::trace!(fields = field_count, "WriteBuffer flushed");
 
         Ok(field_count)
     }
 
+    /// Keep history entries of a failed flush for the next one
+    ///
+    /// At most `history_max_len` entries are kept (the stream would trim the
+    /// rest anyway); older ones are dropped and counted.
+    fn retry_history(&self, history: StreamEntries) {
+        let Some(max_len) = self.history_max_len else {
+            return;
+        };
+        let mut retry = self.history_retry.lock();
+        retry.extend(history);
+        if retry.len() > max_len {
+            let dropped = retry.len() - max_len;
+            retry.drain(..dropped);
+            self.stats
+                .history_dropped
+                .fetch_add(dropped as u64, Ordering::Relaxed);
+            tracing::warn!(
+                dropped,
+                "History stream backlog full, oldest entries dropped"
+            );
+        }
+    }
+
     /// Force flush all pending data (for graceful shutdown)
     ///
     /// Unlike flush_loop, this is a one-shot operation.
@@ -366,6 +763,60 @@ impl WriteBuffer {
     }
 }
 
+/// Append the history stream entries of one drained hash
+///
+/// Points are grouped by timestamp; instance points carry no timestamp and
+/// are stamped with the flush time.
+fn history_entries(
+    hash: &TypedHash,
+    taken: &[(Arc<str>, TypedPoint)],
+    now_ms: i64,
+    history: &mut StreamEntries,
+) {
+    let mut by_ts: Vec<(i64, SharedHashFields)> = Vec::new();
+    for (field, point) in taken {
+        let ts = if point.timestamp_ms > 0 {
+            point.timestamp_ms
+        } else {
+            now_ms
+        };
+        let pos = match by_ts.iter().position(|(t, _)| *t == ts) {
+            Some(pos) => pos,
+            None => {
+                by_ts.push((
+                    ts,
+                    vec![
+                        (
+                            Arc::from(HISTORY_KEY_FIELD),
+                            Bytes::from(hash.keys[0].to_string()),
+                        ),
+                        (Arc::from(HISTORY_TS_FIELD), i64_to_bytes(ts)),
+                    ],
+                ));
+                by_ts.len() - 1
+            },
+        };
+        by_ts[pos]
+            .1
+            .push((Arc::clone(field), f64_to_bytes(point.value)));
+    }
+    history.extend(
+        by_ts
+            .into_iter()
+            .map(|(_, fields)| (Arc::clone(&hash.stream), fields)),
+    );
+}
+
+/// Field bytes of a point for hash layer 0 (value), 1 (timestamp) or 2 (raw value)
+#[inline]
+fn render_layer(point: &TypedPoint, layer: usize) -> Bytes {
+    match layer {
+        0 => f64_to_bytes(point.value),
+        1 => i64_to_bytes(point.timestamp_ms),
+        _ => f64_to_bytes(point.raw),
+    }
+}
+
 #[cfg(test)]
 #[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
 mod tests {
@@ -438,13 +889,223 @@ mod tests {
         buffer.buffer_hash_set("key1", Arc::from("field1"), Bytes::from("value1"));
         buffer.buffer_hash_set("key2", Arc::from("field1"), Bytes::from("value2"));
 
-        let operations = buffer.drain_pending();
+        let (operations, _) = buffer.drain_pending();
 
         assert_eq!(operations.len(), 2);
         assert_eq!(buffer.pending_keys(), 0);
         assert_eq!(buffer.pending_fields(), 0);
     }
 
+    #[tokio::test]
+    async fn test_writes_after_drain_use_fresh_map() {
+        let buffer = WriteBuffer::new(WriteBufferConfig::default());
+        let rtdb = MemoryRtdb::new();
+
+        buffer.buffer_hash_set("key", Arc::from("f1"), Bytes::from("v1"));
+        let (operations, _) = buffer.drain_pending();
+        assert_eq!(operations[0].1, vec![(Arc::from("f1"), Bytes::from("v1"))]);
+
+        // Writes after the swap go to the fresh map
+        buffer.buffer_hash_set("key", Arc::from("f2"), Bytes::from("v2"));
+        assert_eq!(buffer.pending_fields(), 1);
+        assert_eq!(buffer.flush(&rtdb).await.unwrap(), 1);
+        assert_eq!(
+            rtdb.hash_get("key", "f2").await.unwrap(),
+            Some(Bytes::from("v2"))
+        );
+        assert_eq!(buffer.pending_keys(), 0);
+    }
+
+    #[test]
+    fn test_concurrent_flush_keeps_last_value() {
+        const WRITES: u64 = 20_000;
+        let buffer = Arc::new(WriteBuffer::new(WriteBufferConfig::default()));
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let done = Arc::new(std::sync::atomic::AtomicBool::new(false));
+        let runtime = tokio::runtime::Builder::new_current_thread()
+            .build()
+            .unwrap();
+
+        // Producers write increasing values to their own field
+        let producers: Vec<_> = (0..4)
+            .map(|p| {
+                let buffer = Arc::clone(&buffer);
+                std::thread::spawn(move || {
+                    let field: Arc<str> = Arc::from(format!("f{}", p));
+                    for i in 0..WRITES {
+                        buffer.buffer_hash_set("key", Arc::clone(&field), i64_to_bytes(i as i64));
+                    }
+                })
+            })
+            .collect();
+
+        // Flusher drains concurrently, checking values never go backwards
+        let flusher = {
+            let (buffer, rtdb, done) = (Arc::clone(&buffer), Arc::clone(&rtdb), Arc::clone(&done));
+            std::thread::spawn(move || {
+                let mut last = [-1i64; 4];
+                loop {
+                    let finished = done.load(Ordering::Acquire);
+                    runtime.block_on(buffer.flush(&*rtdb)).unwrap();
+                    for (p, last) in last.iter_mut().enumerate() {
+                        let field = format!("f{}", p);
+                        if let Some(bytes) = runtime.block_on(rtdb.hash_get("key", &field)).unwrap()
+                        {
+                            let value: i64 = std::str::from_utf8(&bytes).unwrap().parse().unwrap();
+                            assert!(
+                                value >= *last,
+                                "f{} went back from {} to {}",
+                                p,
+                                last,
+                                value
+                            );
+                            *last = value;
+                        }
+                    }
+                    if finished {
+                        return last;
+                    }
+                }
+            })
+        };
+
+        for producer in producers {
+            producer.join().unwrap();
+        }
+        done.store(true, Ordering::Release);
+        let last = flusher.join().unwrap();
+
+        assert_eq!(last, [WRITES as i64 - 1; 4]);
+        assert_eq!(buffer.pending_fields(), 0);
+    }
+
+    #[tokio::test]
+    async fn test_typed_channel_and_instance_flush() {
+        let buffer = WriteBuffer::new(WriteBufferConfig::default());
+        let rtdb = MemoryRtdb::new();
+        let keyspace = KeySpaceConfig::production();
+
+        buffer.buffer_channel(1001, PointType::Telemetry, &[(1, 100.5, 1005.0)], 1000);
+        // Same point again: overwrites, stays one pending field per layer
+        buffer.buffer_channel(
+            1001,
+            PointType::Telemetry,
+            &[(1, 101.5, 1015.0), (70000, 7.0, 7.0)],
+            2000,
+        );
+        buffer.buffer_instance(5, PointRole::Measurement, &[(3, 42.0)]);
+        assert_eq!(buffer.pending_fields(), 3 + 3 + 1);
+        assert_eq!(
+            buffer.stats.buffered_writes.load(Ordering::Relaxed),
+            3 + 6 + 1
+        );
+
+        assert_eq!(buffer.flush(&rtdb).await.unwrap(), 7);
+        let channel_key = keyspace.channel_key(1001, PointType::Telemetry);
+        assert_eq!(
+            rtdb.hash_get(&channel_key, "1").await.unwrap(),
+            Some(Bytes::from("101.5"))
+        );
+        assert_eq!(
+            rtdb.hash_get(&keyspace.channel_ts_key(1001, PointType::Telemetry), "1")
+                .await
+                .unwrap(),
+            Some(Bytes::from("2000"))
+        );
+        assert_eq!(
+            rtdb.hash_get(&keyspace.channel_raw_key(1001, PointType::Telemetry), "1")
+                .await
+                .unwrap(),
+            Some(Bytes::from("1015.0"))
+        );
+        // Point ID beyond the dense range took the string path
+        assert_eq!(
+            rtdb.hash_get(&channel_key, "70000").await.unwrap(),
+            Some(Bytes::from("7.0"))
+        );
+        assert_eq!(
+            rtdb.hash_get(&keyspace.instance_measurement_key(5), "3")
+                .await
+                .unwrap(),
+            Some(Bytes::from("42.0"))
+        );
+        assert_eq!(buffer.pending_keys(), 0);
+        assert_eq!(buffer.flush(&rtdb).await.unwrap(), 0);
+    }
+
+    #[tokio::test]
+    async fn test_history_stream_export() {
+        let buffer = WriteBuffer::new(WriteBufferConfig::default()).with_history_stream(2);
+        let rtdb = MemoryRtdb::new();
+        let keyspace = KeySpaceConfig::production();
+
+        buffer.buffer_channel(
+            1001,
+            PointType::Telemetry,
+            &[(1, 1.5, 1.5), (2, 2.5, 2.5)],
+            1000,
+        );
+        buffer.buffer_instance(5, PointRole::Measurement, &[(3, 42.0)]);
+        buffer.buffer_hash_set("plain", Arc::from("f"), Bytes::from("v"));
+        buffer.flush(&rtdb).await.unwrap();
+
+        let channel_stream = rtdb.stream_entries(&keyspace.channel_history_stream_key());
+        assert_eq!(channel_stream.len(), 1);
+        let entry: Vec<(&str, &[u8])> = channel_stream[0]
+            .iter()
+            .map(|(f, v)| (f.as_ref(), v.as_ref()))
+            .collect();
+        assert_eq!(entry[0], ("key", b"comsrv:1001:T".as_slice()));
+        assert_eq!(entry[1], ("ts", b"1000".as_slice()));
+        assert_eq!(entry.len(), 4);
+
+        let instance_stream = rtdb.stream_entries(&keyspace.instance_history_stream_key());
+        assert_eq!(instance_stream.len(), 1);
+        assert_eq!(instance_stream[0][0].1, Bytes::from("inst:5:M"));
+        assert_eq!(instance_stream[0][2], (Arc::from("3"), Bytes::from("42.0")));
+
+        // One entry per distinct timestamp; the stream is capped at max_len
+        buffer.buffer_channel(1001, PointType::Telemetry, &[(1, 1.0, 1.0)], 2000);
+        buffer.buffer_channel(1001, PointType::Telemetry, &[(2, 2.0, 2.0)], 3000);
+        buffer.flush(&rtdb).await.unwrap();
+        let channel_stream = rtdb.stream_entries(&keyspace.channel_history_stream_key());
+        assert_eq!(channel_stream.len(), 2);
+        assert_eq!(channel_stream[0][1].1, Bytes::from("2000"));
+        assert_eq!(buffer.stats.snapshot().history_entries, 4);
+    }
+
+    #[tokio::test]
+    async fn test_history_retry_after_failed_append() {
+        let buffer = WriteBuffer::new(WriteBufferConfig::default()).with_history_stream(2);
+        let rtdb = MemoryRtdb::new();
+        let keyspace = KeySpaceConfig::production();
+        let stream: Arc<str> = Arc::from(keyspace.channel_history_stream_key());
+        let entry = |ts: &str| -> (Arc<str>, SharedHashFields) {
+            (
+                Arc::clone(&stream),
+                vec![(Arc::from("ts"), Bytes::from(ts.to_string()))],
+            )
+        };
+
+        // Entries of three failed flushes: only the newest max_len are kept
+        buffer.retry_history(vec![entry("1000")]);
+        buffer.retry_history(vec![entry("2000"), entry("3000")]);
+        assert_eq!(buffer.stats.snapshot().history_dropped, 1);
+
+        // The next flush appends them even with nothing else pending
+        buffer.buffer_channel(1001, PointType::Telemetry, &[(1, 1.0, 1.0)], 4000);
+        buffer.flush(&rtdb).await.unwrap();
+        let entries = rtdb.stream_entries(&stream);
+        assert_eq!(entries.len(), 2);
+        assert_eq!(entries[0][0].1, Bytes::from("3000"));
+        assert_eq!(entries[1][1].1, Bytes::from("4000"));
+
+        buffer.retry_history(vec![entry("5000")]);
+        assert_eq!(buffer.flush(&rtdb).await.unwrap(), 0);
+        assert_eq!(rtdb.stream_entries(&stream)[1][0].1, Bytes::from("5000"));
+        assert!(buffer.history_retry.lock().is_empty());
+    }
+
     #[tokio::test]
     async fn test_flush() {
         let buffer = WriteBuffer::new(WriteBufferConfig::default());
@@ -0,0 +1,134 @@
+//! Rule execution benchmarks
+//!
+//! - Interpreter (`RuleExecutor::execute`) vs compiled program
+//!   (`execute_compiled`, with and without execution details)
+//! - Switch/changeValue flow and calculation flow
+//!
+//! Run: `cargo bench -p voltage-rules`
+
+#![allow(clippy::disallowed_methods)] // unwrap is fine in benches
+
+use criterion::{criterion_group, criterion_main, Criterion};
+use serde_json::json;
+use std::sync::Arc;
+use voltage_rtdb::{Bytes, MemoryRtdb, RoutingCache, Rtdb};
+use voltage_rules::{Rule, RuleExecutor};
+
+/// SOC strategy: X1 <= 5 → Y1 = 999, X1 >= 49 → Y1 = 1
+fn switch_rule() -> Rule {
+    serde_json::from_value(json!({
+        "id": 1,
+        "name": "SOC Strategy",
+        "flow": {
+            "start_node": "start",
+            "nodes": {
+                "start": {"type": "start", "wires": {"default": ["switch"]}},
+                "switch": {
+                    "type": "function-switch",
+                    "variables": [
+                        {"name": "X1", "instance": 5, "pointType": "measurement", "point": 3}
+                    ],
+                    "rule": [
+                        {"name": "out001", "type": "default", "rule": [
+                            {"type": "variable", "variables": "X1", "operator": "<=", "value": 5}
+                        ]},
+                        {"name": "out002", "type": "default", "rule": [
+                            {"type": "variable", "variables": "X1", "operator": ">=", "value": 49}
+                        ]}
+                    ],
+                    "wires": {"out001": ["low"], "out002": ["high"]}
+                },
+                "low": {
+                    "type": "action-changeValue",
+                    "variables": [
+                        {"name": "Y1", "instance": 5, "pointType": "action", "point": 1}
+                    ],
+                    "rule": [{"Variables": "Y1", "value": 999}],
+                    "wires": {"default": ["end"]}
+                },
+                "high": {
+                    "type": "action-changeValue",
+                    "variables": [
+                        {"name": "Y1", "instance": 5, "pointType": "action", "point": 1}
+                    ],
+                    "rule": [{"Variables": "Y1", "value": 1}],
+                    "wires": {"default": ["end"]}
+                },
+                "end": {"type": "end"}
+            }
+        }
+    }))
+    .unwrap()
+}
+
+/// Calculation flow: T = P * 2, Y = clamp(T + 1, 0, 100)
+fn calculation_rule() -> Rule {
+    serde_json::from_value(json!({
+        "id": 2,
+        "name": "Calc",
+        "flow": {
+            "start_node": "start",
+            "nodes": {
+                "start": {"type": "start", "wires": {"default": ["calc"]}},
+                "calc": {
+                    "type": "action-calculation",
+                    "variables": [
+                        {"name": "P", "instance": 5, "pointType": "measurement", "point": 1},
+                        {"name": "Y", "instance": 5, "pointType": "action", "point": 2}
+                    ],
+                    "rule": [
+                        {"output": "T", "formula": "P * 2"},
+                        {"output": "Y", "formula": "clamp(T + 1, 0, 100)"}
+                    ],
+                    "wires": {"default": ["end"]}
+                },
+                "end": {"type": "end"}
+            }
+        }
+    }))
+    .unwrap()
+}
+
+fn bench_rules(c: &mut Criterion) {
+    let rt = tokio::runtime::Builder::new_current_thread()
+        .build()
+        .unwrap();
+    let rtdb = Arc::new(MemoryRtdb::new());
+    rt.block_on(async {
+        rtdb.hash_set("inst:5:M", "1", Bytes::from("20"))
+            .await
+            .unwrap();
+        rtdb.hash_set("inst:5:M", "3", Bytes::from("3.5"))
+            .await
+            .unwrap();
+    });
+    let executor = RuleExecutor::new(rtdb, Arc::new(RoutingCache::default()));
+
+    for (name, rule) in [
+        ("switch", switch_rule()),
+        ("calculation", calculation_rule()),
+    ] {
+        let program = executor.compile(&rule).unwrap();
+        let mut group = c.benchmark_group(format!("rule_{}", name));
+
+        group.bench_function("execute", |b| {
+            b.iter(|| rt.block_on(executor.execute(&rule)).unwrap())
+        });
+        group.bench_function("execute_compiled_details", |b| {
+            b.iter(|| {
+                rt.block_on(executor.execute_compiled(&program, true))
+                    .unwrap()
+            })
+        });
+        group.bench_function("execute_compiled", |b| {
+            b.iter(|| {
+                rt.block_on(executor.execute_compiled(&program, false))
+                    .unwrap()
+            })
+        });
+        group.finish();
+    }
+}
+
+criterion_group!(benches, bench_rules);
+criterion_main!(benches);
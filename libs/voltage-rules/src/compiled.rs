@@ -0,0 +1,592 @@
+//! Compiled Rule Flows
+//!
+//! Lowers a [`Rule`] into a flat program at load time so the scheduler hot path
+//! does not hash strings on every execution:
+//! - nodes are addressed by index instead of looked up by ID
+//! - variables become register indices, read from pre-resolved shared-memory
+//!   slot offsets (Redis key/field strings are built once as fallback)
+//! - switch conditions are pre-parsed into operator/operand form
+//!
+//! Execution runs over a register file that is reused between runs, see
+//! [`RuleExecutor::execute_compiled`](crate::executor::RuleExecutor::execute_compiled).
+//! Compilation is conservative: any flow the interpreter would reject at
+//! runtime (dangling wire, variable without instance/point) is not compiled
+//! and keeps running on the interpreter.
+
+use crate::logger::format_conditions;
+use crate::types::{CalculationRule, FlowCondition, Rule, RuleNode, RuleVariable};
+use std::collections::HashMap;
+use std::sync::{Arc, Mutex};
+use voltage_calc::CompiledFormula;
+use voltage_rtdb::numfmt::precomputed;
+use voltage_rtdb::{KeySpaceConfig, SharedVecRtdbReader};
+
+/// Register file entry: `None` until the variable is read or computed
+pub(crate) type Register = Option<f64>;
+
+/// Variable read: shared-memory slot first, then Redis hash field
+#[derive(Debug, Clone)]
+pub(crate) struct VarRead {
+    pub reg: usize,
+    /// Absolute shm slot offset (resolved at compile time)
+    pub slot: Option<usize>,
+    pub redis_key: String,
+    pub redis_field: String,
+}
+
+/// Comparison operator of a switch condition
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub(crate) enum CmpOp {
+    Eq,
+    Ne,
+    Gt,
+    Lt,
+    Ge,
+    Le,
+    /// Unknown operator string (always false, as in the interpreter)
+    Never,
+}
+
+impl CmpOp {
+    fn parse(op: &str) -> Self {
+        match op {
+            "==" | "eq" => CmpOp::Eq,
+            "!=" | "ne" => CmpOp::Ne,
+            ">" | "gt" => CmpOp::Gt,
+            "<" | "lt" => CmpOp::Lt,
+            ">=" | "gte" => CmpOp::Ge,
+            "<=" | "lte" => CmpOp::Le,
+            _ => CmpOp::Never,
+        }
+    }
+
+    #[inline]
+    fn apply(self, left: f64, right: f64) -> bool {
+        match self {
+            CmpOp::Eq => (left - right).abs() < f64::EPSILON,
+            CmpOp::Ne => (left - right).abs() >= f64::EPSILON,
+            CmpOp::Gt => left > right,
+            CmpOp::Lt => left < right,
+            CmpOp::Ge => left >= right,
+            CmpOp::Le => left <= right,
+            CmpOp::Never => false,
+        }
+    }
+}
+
+/// Right-hand side of a condition or assignment value
+#[derive(Debug, Clone)]
+pub(crate) enum Operand {
+    Const(f64),
+    /// String operand: register value if set, else the parsed number
+    Ref {
+        name: String,
+        reg: Option<usize>,
+        fallback: Option<f64>,
+    },
+}
+
+impl Operand {
+    fn from_json(value: Option<&serde_json::Value>, registers: &HashMap<String, usize>) -> Self {
+        let Some(v) = value else {
+            return Operand::Const(0.0);
+        };
+        if let Some(n) = v.as_f64() {
+            Operand::Const(n)
+        } else if let Some(n) = v.as_i64() {
+            Operand::Const(n as f64)
+        } else if let Some(s) = v.as_str() {
+            Operand::Ref {
+                name: s.to_string(),
+                reg: registers.get(s).copied(),
+                fallback: s.parse().ok(),
+            }
+        } else {
+            Operand::Const(0.0)
+        }
+    }
+
+    /// Resolve against the register file (`None` = unresolvable reference)
+    #[inline]
+    pub fn resolve(&self, regs: &[Register]) -> Option<f64> {
+        match self {
+            Operand::Const(n) => Some(*n),
+            Operand::Ref { reg, fallback, .. } => reg.and_then(|r| regs[r]).or(*fallback),
+        }
+    }
+}
+
+/// Pre-parsed variable condition, combined with the previous one by `or`
+#[derive(Debug, Clone)]
+pub(crate) struct CompiledCond {
+    pub or: bool,
+    pub left_name: Option<String>,
+    pub left: Option<usize>,
+    pub op: CmpOp,
+    pub right: Operand,
+}
+
+impl CompiledCond {
+    fn eval(&self, regs: &[Register]) -> bool {
+        let Some(name) = &self.left_name else {
+            return false;
+        };
+        let Some(left) = self.left.and_then(|r| regs[r]) else {
+            tracing::warn!("Variable '{}' not found in values, condition fails", name);
+            return false;
+        };
+        let Some(right) = self.right.resolve(regs) else {
+            if let Operand::Ref { name, .. } = &self.right {
+                tracing::warn!("Variable '{}' not found and not a number", name);
+            }
+            return false;
+        };
+        self.op.apply(left, right)
+    }
+}
+
+/// Switch branch with its resolved wire target
+#[derive(Debug, Clone)]
+pub(crate) struct CompiledBranch {
+    pub port: String,
+    /// Formatted condition (e.g. "X1>=49"), built once for logging
+    pub expression: String,
+    pub conds: Vec<CompiledCond>,
+    pub target: Option<usize>,
+}
+
+impl CompiledBranch {
+    /// Same folding as the interpreter: relations apply to the next condition,
+    /// AND by default, starting from `true`
+    pub fn matches(&self, regs: &[Register]) -> bool {
+        self.conds.iter().fold(true, |acc, cond| {
+            let r = cond.eval(regs);
+            if cond.or {
+                acc || r
+            } else {
+                acc && r
+            }
+        })
+    }
+}
+
+/// Pre-resolved write target of an action or calculation output
+#[derive(Debug, Clone)]
+pub(crate) struct WriteTarget {
+    pub instance_id: u32,
+    pub point_id: u32,
+    pub point_str: Arc<str>,
+    /// Static point type code for `ActionResult` ("A", "M", ...)
+    pub point_type: &'static str,
+}
+
+#[derive(Debug, Clone)]
+pub(crate) struct CompiledAssign {
+    pub target: WriteTarget,
+    pub value: Operand,
+}
+
+#[derive(Debug, Clone)]
+pub(crate) struct CompiledCalc {
+    pub rule: CalculationRule,
+    /// Register per formula variable (`CompiledFormula::variables` order);
+    /// `None` if the formula is not compilable or reads an unknown name
+    pub arg_regs: Option<Vec<usize>>,
+    pub output_reg: usize,
+    /// Output variable (write is delegated to the interpreter's writer)
+    pub output_var: Option<RuleVariable>,
+}
+
+#[derive(Debug, Clone)]
+pub(crate) enum CompiledNode {
+    Start {
+        next: Option<usize>,
+    },
+    End,
+    Switch {
+        reads: Vec<VarRead>,
+        branches: Vec<CompiledBranch>,
+    },
+    ChangeValue {
+        reads: Vec<VarRead>,
+        assigns: Vec<CompiledAssign>,
+        next: Option<usize>,
+    },
+    Calculation {
+        reads: Vec<VarRead>,
+        calcs: Vec<CompiledCalc>,
+        next: Option<usize>,
+    },
+}
+
+/// A rule flow lowered to node indices and variable registers
+#[derive(Debug)]
+pub struct CompiledRule {
+    pub(crate) rule_id: i64,
+    pub(crate) start: usize,
+    pub(crate) nodes: Vec<CompiledNode>,
+    /// Original node IDs (execution path / node details)
+    pub(crate) node_ids: Vec<String>,
+    /// Variable name per register
+    pub(crate) registers: Vec<String>,
+    /// Register file reused across runs (taken while a run is in flight)
+    scratch: Mutex<Vec<Register>>,
+}
+
+impl CompiledRule {
+    pub fn rule_id(&self) -> i64 {
+        self.rule_id
+    }
+
+    pub fn register_count(&self) -> usize {
+        self.registers.len()
+    }
+
+    /// Take the cleared register file (allocates only if another run holds it)
+    pub(crate) fn take_registers(&self) -> Vec<Register> {
+        let mut regs = match self.scratch.lock() {
+            Ok(mut guard) => std::mem::take(&mut *guard),
+            Err(_) => Vec::new(),
+        };
+        regs.clear();
+        regs.resize(self.registers.len(), None);
+        regs
+    }
+
+    /// Return the register file for the next run
+    pub(crate) fn put_registers(&self, regs: Vec<Register>) {
+        if let Ok(mut guard) = self.scratch.lock() {
+            *guard = regs;
+        }
+    }
+
+    /// Materialize the set registers as a name → value map
+    pub(crate) fn values_map(&self, regs: &[Register]) -> HashMap<String, f64> {
+        self.registers
+            .iter()
+            .zip(regs)
+            .filter_map(|(name, v)| v.map(|v| (name.clone(), v)))
+            .collect()
+    }
+}
+
+/// Lower a rule into a [`CompiledRule`]
+///
+/// Returns `None` when the flow cannot be compiled faithfully; callers fall
+/// back to the interpreter in that case.
+pub fn compile_rule(rule: &Rule, reader: Option<&SharedVecRtdbReader>) -> Option<CompiledRule> {
+    let flow = &rule.flow;
+    let keyspace = KeySpaceConfig::production();
+
+    // Stable node order so indices (and the first-seen register order) are deterministic
+    let mut node_ids: Vec<String> = flow.nodes.keys().cloned().collect();
+    node_ids.sort();
+    let index: HashMap<&str, usize> = node_ids
+        .iter()
+        .enumerate()
+        .map(|(i, id)| (id.as_str(), i))
+        .collect();
+    let start = *index.get(flow.start_node.as_str())?;
+
+    // Registers: every readable variable and every calculation output
+    let mut registers: Vec<String> = Vec::new();
+    let mut reg_index: HashMap<String, usize> = HashMap::new();
+    let mut add_reg = |name: &str| {
+        if !reg_index.contains_key(name) {
+            reg_index.insert(name.to_string(), registers.len());
+            registers.push(name.to_string());
+        }
+    };
+    for id in &node_ids {
+        match &flow.nodes[id] {
+            RuleNode::Switch { variables, .. } | RuleNode::ChangeValue { variables, .. } => {
+                variables
+                    .iter()
+                    .filter(|v| v.formula.is_empty())
+                    .for_each(|v| add_reg(&v.name));
+            },
+            RuleNode::Calculation {
+                variables,
+                rule: calcs,
+                ..
+            } => {
+                variables
+                    .iter()
+                    .filter(|v| v.formula.is_empty())
+                    .for_each(|v| add_reg(&v.name));
+                calcs.iter().for_each(|c| add_reg(&c.output));
+            },
+            RuleNode::Start { .. } | RuleNode::End => {},
+        }
+    }
+
+    // A wire to a missing node is a runtime error in the interpreter; keep it there
+    let next_of = |targets: &[String]| -> Option<Option<usize>> {
+        match targets.first() {
+            Some(t) => index.get(t.as_str()).map(|&i| Some(i)),
+            None => Some(None),
+        }
+    };
+
+    let mut nodes = Vec::with_capacity(node_ids.len());
+    for id in &node_ids {
+        let node = match &flow.nodes[id] {
+            RuleNode::Start { wires } => CompiledNode::Start {
+                next: next_of(&wires.default)?,
+            },
+            RuleNode::End => CompiledNode::End,
+            RuleNode::Switch {
+                variables,
+                rule: branches,
+                wires,
+            } => {
+                let mut compiled = Vec::with_capacity(branches.len());
+                for branch in branches {
+                    let target = match wires.get(&branch.name) {
+                        Some(targets) => next_of(targets)?,
+                        None => None,
+                    };
+                    compiled.push(CompiledBranch {
+                        port: branch.name.clone(),
+                        expression: format_conditions(&branch.rule),
+                        conds: compile_conditions(&branch.rule, &reg_index),
+                        target,
+                    });
+                }
+                CompiledNode::Switch {
+                    reads: compile_reads(variables, &reg_index, reader, &keyspace)?,
+                    branches: compiled,
+                }
+            },
+            RuleNode::ChangeValue {
+                variables,
+                rule: assignments,
+                wires,
+            } => {
+                let mut assigns = Vec::with_capacity(assignments.len());
+                for assignment in assignments {
+                    // Assignments to unknown variables are skipped by the interpreter too
+                    let Some(var) = variables.iter().find(|v| v.name == assignment.variables)
+                    else {
+                        continue;
+                    };
+                    assigns.push(CompiledAssign {
+                        target: write_target(var, "A")?,
+                        value: Operand::from_json(Some(&assignment.value), &reg_index),
+                    });
+                }
+                CompiledNode::ChangeValue {
+                    reads: compile_reads(variables, &reg_index, reader, &keyspace)?,
+                    assigns,
+                    next: next_of(&wires.default)?,
+                }
+            },
+            RuleNode::Calculation {
+                variables,
+                rule: calcs,
+                wires,
+            } => {
+                let mut compiled = Vec::with_capacity(calcs.len());
+                for calc in calcs {
+                    let output_var = variables.iter().find(|v| v.name == calc.output).cloned();
+                    if let Some(var) = &output_var {
+                        write_target(var, "M")?;
+                    }
+                    let arg_regs = CompiledFormula::compile(&calc.formula).ok().and_then(|f| {
+                        f.variables()
+                            .iter()
+                            .map(|v| reg_index.get(v).copied())
+                            .collect()
+                    });
+                    compiled.push(CompiledCalc {
+                        rule: calc.clone(),
+                        arg_regs,
+                        output_reg: reg_index[&calc.output],
+                        output_var,
+                    });
+                }
+                CompiledNode::Calculation {
+                    reads: compile_reads(variables, &reg_index, reader, &keyspace)?,
+                    calcs: compiled,
+                    next: next_of(&wires.default)?,
+                }
+            },
+        };
+        nodes.push(node);
+    }
+
+    Some(CompiledRule {
+        rule_id: rule.id,
+        start,
+        nodes,
+        node_ids,
+        scratch: Mutex::new(Vec::with_capacity(registers.len())),
+        registers,
+    })
+}
+
+/// Resolve node-local variable reads (formula variables are skipped, as in the interpreter)
+fn compile_reads(
+    variables: &[RuleVariable],
+    registers: &HashMap<String, usize>,
+    reader: Option<&SharedVecRtdbReader>,
+    keyspace: &KeySpaceConfig,
+) -> Option<Vec<VarRead>> {
+    variables
+        .iter()
+        .filter(|v| v.formula.is_empty())
+        .map(|var| {
+            let instance_id = var.instance?;
+            let point = var.point?;
+            let is_action = var.point_type.as_deref() == Some("action");
+            let slot =
+                reader.and_then(|r| r.instance_slot_offset(instance_id, is_action as u8, point));
+            let redis_key = if is_action {
+                keyspace.instance_action_key(instance_id)
+            } else {
+                keyspace.instance_measurement_key(instance_id)
+            };
+            Some(VarRead {
+                reg: registers[&var.name],
+                slot,
+                redis_key,
+                redis_field: precomputed::get_point_id_str_or_alloc(point).to_string(),
+            })
+        })
+        .collect()
+}
+
+fn compile_conditions(
+    conditions: &[FlowCondition],
+    registers: &HashMap<String, usize>,
+) -> Vec<CompiledCond> {
+    let mut compiled = Vec::new();
+    let mut pending_or = false;
+    for cond in conditions {
+        if cond.cond_type == "relation" {
+            pending_or = matches!(
+                cond.value.as_ref().and_then(|v| v.as_str()),
+                Some("||") | Some("or") | Some("OR")
+            );
+            continue;
+        }
+        compiled.push(CompiledCond {
+            or: pending_or,
+            left_name: cond.variables.clone(),
+            left: cond
+                .variables
+                .as_ref()
+                .and_then(|n| registers.get(n).copied()),
+            op: CmpOp::parse(cond.operator.as_deref().unwrap_or("==")),
+            right: Operand::from_json(cond.value.as_ref(), registers),
+        });
+        pending_or = false;
+    }
+    compiled
+}
+
+/// Write target of a variable; `None` if it lacks instance or point
+fn write_target(var: &RuleVariable, default_type: &'static str) -> Option<WriteTarget> {
+    if !var.formula.is_empty() {
+        return None;
+    }
+    let point_id = var.point?;
+    Some(WriteTarget {
+        instance_id: var.instance?,
+        point_id,
+        point_str: Arc::from(&*precomputed::get_point_id_str_or_alloc(point_id)),
+        point_type: crate::executor::point_type_to_static(var.point_type.as_deref(), default_type),
+    })
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+    use crate::parser::extract_rule_flow;
+    use serde_json::json;
+
+    fn rule_from(flow: serde_json::Value) -> Rule {
+        Rule {
+            id: 9,
+            name: "compiled".to_string(),
+            description: None,
+            enabled: true,
+            priority: 0,
+            cooldown_ms: 0,
+            flow: extract_rule_flow(&flow).unwrap(),
+        }
+    }
+
+    fn switch_flow(target: &str) -> serde_json::Value {
+        json!({
+            "nodes": [
+                {"id": "start", "type": "start",
+                 "data": {"config": {"wires": {"default": ["sw"]}}}},
+                {"id": "sw", "type": "custom", "data": {"type": "function-switch", "config": {
+                    "variables": [
+                        {"name": "X1", "instance": 1, "pointType": "measurement", "point": 1},
+                        {"name": "X2", "instance": 1, "pointType": "action", "point": 2}
+                    ],
+                    "rule": [{"name": "out001", "type": "default", "rule": [
+                        {"type": "variable", "variables": "X1", "operator": ">", "value": "X2"},
+                        {"type": "relation", "value": "||"},
+                        {"type": "variable", "variables": "X2", "operator": ">=", "value": 10}
+                    ]}],
+                    "wires": {"out001": [target]}
+                }}},
+                {"id": "end", "type": "end"}
+            ]
+        })
+    }
+
+    #[test]
+    fn test_compile_switch() {
+        let compiled = compile_rule(&rule_from(switch_flow("end")), None).unwrap();
+        assert_eq!(compiled.register_count(), 2);
+        assert_eq!(compiled.node_ids[compiled.start], "start");
+
+        let CompiledNode::Switch { reads, branches } =
+            &compiled.nodes[compiled.node_ids.iter().position(|n| n == "sw").unwrap()]
+        else {
+            panic!("expected switch node");
+        };
+        assert_eq!(reads[0].redis_key, "inst:1:M");
+        assert_eq!(reads[1].redis_key, "inst:1:A");
+        assert_eq!(reads[1].redis_field, "2");
+        assert!(reads.iter().all(|r| r.slot.is_none()));
+
+        let branch = &branches[0];
+        assert_eq!(branch.expression, "X1>X2 || X2>=10");
+        assert!(!branch.conds[0].or && branch.conds[1].or);
+        assert_eq!(
+            compiled.node_ids[branch.target.unwrap()],
+            "end",
+            "wire resolved to node index"
+        );
+
+        // X1=5, X2=3 → first condition true
+        assert!(branch.matches(&[Some(5.0), Some(3.0)]));
+        // X1=1, X2=12 → second condition true via OR
+        assert!(branch.matches(&[Some(1.0), Some(12.0)]));
+        // X1 unset → first fails, X2=3 fails
+        assert!(!branch.matches(&[None, Some(3.0)]));
+    }
+
+    #[test]
+    fn test_compile_rejects_dangling_wire() {
+        assert!(compile_rule(&rule_from(switch_flow("missing")), None).is_none());
+    }
+
+    #[test]
+    fn test_register_file_reuse() {
+        let compiled = compile_rule(&rule_from(switch_flow("end")), None).unwrap();
+        let mut regs = compiled.take_registers();
+        regs[0] = Some(1.0);
+        compiled.put_registers(regs);
+
+        let regs = compiled.take_registers();
+        assert_eq!(regs, vec![None, None], "registers cleared between runs");
+        assert!(regs.capacity() >= 2);
+    }
+}
@@ -5,6 +5,7 @@
 //! 2. For each node: reading node-local variables, evaluating conditions
 //! 3. Executing actions and following wires
 
+use crate::compiled::{compile_rule, CompiledNode, CompiledRule, Register, VarRead};
 use crate::error::Result;
 use crate::logger::format_conditions;
 use crate::types::{
@@ -13,16 +14,16 @@ use crate::types::{
 };
 use serde::Serialize;
 use std::collections::HashMap;
-use std::sync::Arc;
+use std::sync::{Arc, Mutex};
 use voltage_calc::{CalcEngine, MemoryStateStore, StateStore};
-use voltage_routing::set_action_point;
+use voltage_routing::set_action_point_with_commands;
 use voltage_rtdb::numfmt::precomputed;
 use voltage_rtdb::traits::Rtdb;
-use voltage_rtdb::{KeySpaceConfig, RoutingCache, SharedVecRtdbReader};
+use voltage_rtdb::{KeySpaceConfig, RoutingCache, SharedCommandSender, SharedVecRtdbReader};
 
 /// Convert dynamic point type string to static str for zero-allocation ActionResult
 #[inline]
-fn point_type_to_static(pt: Option<&str>, default: &'static str) -> &'static str {
+pub(crate) fn point_type_to_static(pt: Option<&str>, default: &'static str) -> &'static str {
     match pt {
         Some("M") | Some("measurement") => "M",
         Some("A") | Some("action") => "A",
@@ -109,8 +110,12 @@ pub struct RuleExecutor<R: Rtdb, S: StateStore = MemoryStateStore> {
     routing_cache: Arc<RoutingCache>,
     /// State store for stateful calculation functions (integrate, moving_avg, etc.)
     state_store: Arc<S>,
+    /// Per-rule calculation engines (keep compiled formulas across executions)
+    calc_engines: Mutex<HashMap<i64, Arc<CalcEngine<S>>>>,
     /// Optional SharedVecRtdbReader for cross-process zero-copy reads
     shared_reader: Option<Arc<SharedVecRtdbReader>>,
+    /// Optional shared memory command ring producer for routed actions
+    command_sender: Option<Arc<SharedCommandSender>>,
 }
 
 impl<R: Rtdb> RuleExecutor<R, MemoryStateStore> {
@@ -120,7 +125,9 @@ impl<R: Rtdb> RuleExecutor<R, MemoryStateStore> {
             rtdb,
             routing_cache,
             state_store: Arc::new(MemoryStateStore::new()),
+            calc_engines: Mutex::new(HashMap::new()),
             shared_reader: None,
+            command_sender: None,
         }
     }
 }
@@ -136,7 +143,9 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
             rtdb,
             routing_cache,
             state_store,
+            calc_engines: Mutex::new(HashMap::new()),
             shared_reader: None,
+            command_sender: None,
         }
     }
 
@@ -153,6 +162,14 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
         self
     }
 
+    /// Push routed actions to comsrv through the shared memory command rings
+    ///
+    /// Redis writes and the TODO trigger still happen for every action.
+    pub fn with_command_sender(mut self, sender: Arc<SharedCommandSender>) -> Self {
+        self.command_sender = Some(sender);
+        self
+    }
+
     /// Execute a rule with RuleFlow
     pub async fn execute(&self, rule: &Rule) -> Result<RuleExecutionResult> {
         let mut result = RuleExecutionResult {
@@ -344,9 +361,8 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
                         snapshot_or_reuse(&mut values_snapshot, &values, values_changed);
                     result.variable_values = Arc::clone(&input_snapshot);
 
-                    // Create CalcEngine with rule_id as context (for stateful functions)
-                    let calc_engine =
-                        CalcEngine::new(Arc::clone(&self.state_store), format!("rule_{}", rule.id));
+                    // Per-rule CalcEngine (rule_id context for stateful functions, formula cache)
+                    let calc_engine = self.calc_engine(rule.id);
                     let mut node_actions = Vec::new();
 
                     for calc in calculations {
@@ -399,6 +415,303 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
         Ok(result)
     }
 
+    /// Calculation engine of a rule (context `rule_{id}`), created on first use
+    fn calc_engine(&self, rule_id: i64) -> Arc<CalcEngine<S>> {
+        let new_engine = || {
+            Arc::new(CalcEngine::new(
+                Arc::clone(&self.state_store),
+                format!("rule_{}", rule_id),
+            ))
+        };
+        let Ok(mut engines) = self.calc_engines.lock() else {
+            tracing::warn!("Calc engine lock fail");
+            return new_engine();
+        };
+        Arc::clone(engines.entry(rule_id).or_insert_with(new_engine))
+    }
+
+    /// Compile a rule into a flat program for [`execute_compiled`](Self::execute_compiled)
+    ///
+    /// Variable reads are resolved against this executor's shared-memory reader.
+    /// Returns `None` if the flow has to stay on the interpreter.
+    pub fn compile(&self, rule: &Rule) -> Option<CompiledRule> {
+        compile_rule(rule, self.shared_reader.as_deref())
+    }
+
+    /// Execute a compiled rule over its reusable register file
+    ///
+    /// Behaves like [`execute`](Self::execute). With `details == false`,
+    /// `execution_path` and `node_details` stay empty and `variable_values`
+    /// is materialized once when the run ends.
+    pub async fn execute_compiled(
+        &self,
+        program: &CompiledRule,
+        details: bool,
+    ) -> Result<RuleExecutionResult> {
+        let mut regs = program.take_registers();
+        let result = self.run_compiled(program, &mut regs, details).await;
+        program.put_registers(regs);
+        Ok(result)
+    }
+
+    async fn run_compiled(
+        &self,
+        program: &CompiledRule,
+        regs: &mut [Register],
+        details: bool,
+    ) -> RuleExecutionResult {
+        let mut result = RuleExecutionResult {
+            rule_id: program.rule_id,
+            success: false,
+            actions_executed: vec![],
+            error: None,
+            execution_path: vec![],
+            matched_condition: None,
+            variable_values: Arc::new(HashMap::new()),
+            node_details: HashMap::new(),
+        };
+
+        let mut current = program.start;
+        let max_iterations = 100; // Prevent infinite loops
+        let mut iterations = 0;
+
+        // Detail mode keeps the interpreter's per-node snapshot; otherwise snapshot on exit
+        let snapshot = |regs: &[Register]| Arc::new(program.values_map(regs));
+        let finish = |mut result: RuleExecutionResult, regs: &[Register], error: &str| {
+            result.error = Some(error.to_string());
+            if !details {
+                result.variable_values = snapshot(regs);
+            }
+            result
+        };
+
+        loop {
+            iterations += 1;
+            if iterations > max_iterations {
+                return finish(result, regs, "Execution exceeded maximum iterations");
+            }
+            if details {
+                result
+                    .execution_path
+                    .push(program.node_ids[current].clone());
+            }
+
+            match &program.nodes[current] {
+                CompiledNode::End => {
+                    result.variable_values = snapshot(regs);
+                    result.success = true;
+                    return result;
+                },
+                CompiledNode::Start { next } => match next {
+                    Some(next) => current = *next,
+                    None => return finish(result, regs, "Start node has no output wire"),
+                },
+                CompiledNode::Switch { reads, branches } => {
+                    self.read_compiled_variables(reads, regs).await;
+
+                    let mut next_node = None;
+                    let mut matched_port = None;
+                    for branch in branches {
+                        if branch.matches(regs) {
+                            if let Some(target) = branch.target {
+                                next_node = Some(target);
+                                matched_port = Some(branch.port.clone());
+                                result.matched_condition = Some(branch.expression.clone());
+                                break;
+                            }
+                        }
+                    }
+
+                    if details {
+                        let input_values = snapshot(regs);
+                        result.variable_values = Arc::clone(&input_values);
+                        let condition_results = branches
+                            .iter()
+                            .map(|branch| ConditionResult {
+                                expression: branch.expression.clone(),
+                                result: branch.matches(regs),
+                                port: branch.port.clone(),
+                            })
+                            .collect();
+                        result.node_details.insert(
+                            program.node_ids[current].clone(),
+                            NodeExecutionDetail {
+                                node_type: "switch",
+                                input_values,
+                                condition_results: Some(condition_results),
+                                matched_port,
+                                actions: None,
+                            },
+                        );
+                    }
+
+                    match next_node {
+                        Some(next) => current = next,
+                        None => return finish(result, regs, "No matching switch rule"),
+                    }
+                },
+                CompiledNode::ChangeValue {
+                    reads,
+                    assigns,
+                    next,
+                } => {
+                    self.read_compiled_variables(reads, regs).await;
+                    let node_start = result.actions_executed.len();
+                    for assign in assigns {
+                        let value = assign.value.resolve(regs).unwrap_or(0.0);
+                        let target = &assign.target;
+                        let success = self
+                            .route_action(
+                                target.instance_id,
+                                target.point_id,
+                                &target.point_str,
+                                value,
+                            )
+                            .await;
+                        result.actions_executed.push(ActionResult {
+                            target_type: "instance",
+                            target_id: target.instance_id,
+                            point_type: target.point_type,
+                            point_id: target.point_id,
+                            value,
+                            success,
+                        });
+                    }
+
+                    if details {
+                        let input_values = snapshot(regs);
+                        result.variable_values = Arc::clone(&input_values);
+                        result.node_details.insert(
+                            program.node_ids[current].clone(),
+                            NodeExecutionDetail {
+                                node_type: "change",
+                                input_values,
+                                condition_results: None,
+                                matched_port: None,
+                                actions: Some(result.actions_executed[node_start..].to_vec()),
+                            },
+                        );
+                    }
+
+                    match next {
+                        Some(next) => current = *next,
+                        None => return finish(result, regs, "ChangeValue node has no output wire"),
+                    }
+                },
+                CompiledNode::Calculation { reads, calcs, next } => {
+                    self.read_compiled_variables(reads, regs).await;
+                    let input_values = details.then(|| snapshot(regs));
+                    if let Some(input_values) = &input_values {
+                        result.variable_values = Arc::clone(input_values);
+                    }
+
+                    let calc_engine = self.calc_engine(program.rule_id);
+                    let node_start = result.actions_executed.len();
+
+                    for calc in calcs {
+                        // Registers bound at compile time; otherwise evaluate by name
+                        let args = calc.arg_regs.as_ref().and_then(|arg_regs| {
+                            arg_regs
+                                .iter()
+                                .map(|&r| regs[r])
+                                .collect::<Option<Vec<f64>>>()
+                        });
+                        let evaluated = match args {
+                            Some(args) => {
+                                calc_engine.evaluate_values(&calc.rule.formula, &args).await
+                            },
+                            None => {
+                                let values = program.values_map(regs);
+                                calc_engine.evaluate(&calc.rule.formula, &values).await
+                            },
+                        };
+                        let calc_result = match evaluated {
+                            Ok(v) => v,
+                            Err(e) => {
+                                let error = format!("Calc '{}' error: {}", calc.rule.formula, e);
+                                return finish(result, regs, &error);
+                            },
+                        };
+
+                        if let Some(var) = &calc.output_var {
+                            let action = self
+                                .write_calculation_result(var, calc_result, &calc.rule)
+                                .await;
+                            result.actions_executed.push(action);
+                        }
+
+                        regs[calc.output_reg] = Some(calc_result);
+                    }
+
+                    if let Some(input_values) = input_values {
+                        result.node_details.insert(
+                            program.node_ids[current].clone(),
+                            NodeExecutionDetail {
+                                node_type: "calculation",
+                                input_values,
+                                condition_results: None,
+                                matched_port: None,
+                                actions: Some(result.actions_executed[node_start..].to_vec()),
+                            },
+                        );
+                    }
+
+                    match next {
+                        Some(next) => current = *next,
+                        None => return finish(result, regs, "Calculation node has no output wire"),
+                    }
+                },
+            }
+        }
+    }
+
+    /// Read pre-resolved variables into the register file
+    ///
+    /// Same two-tier priority and fallbacks as [`read_rule_variables`](Self::read_rule_variables),
+    /// without building keys or hashing names.
+    async fn read_compiled_variables(&self, reads: &[VarRead], regs: &mut [Register]) {
+        for read in reads {
+            // ★ Priority 1: SharedMemory slot resolved at compile time
+            if let (Some(reader), Some(slot)) = (&self.shared_reader, read.slot) {
+                if let Some(snapshot) = reader.read_slot(slot) {
+                    regs[read.reg] = Some(snapshot.value);
+                    continue;
+                }
+            }
+
+            // ★ Priority 2: Redis (~1ms) - remote fallback
+            let value = match self.rtdb.hash_get(&read.redis_key, &read.redis_field).await {
+                Ok(Some(val_bytes)) => {
+                    let val_str = String::from_utf8_lossy(&val_bytes);
+                    val_str.parse::<f64>().unwrap_or_else(|_| {
+                        tracing::warn!(
+                            "Reg {}: '{}' not number at {}:{}",
+                            read.reg,
+                            val_str,
+                            read.redis_key,
+                            read.redis_field
+                        );
+                        0.0
+                    })
+                },
+                Ok(None) => {
+                    tracing::warn!(
+                        "Reg {}: {}:{} not found",
+                        read.reg,
+                        read.redis_key,
+                        read.redis_field
+                    );
+                    0.0
+                },
+                Err(e) => {
+                    tracing::error!("Reg {} read err: {}", read.reg, e);
+                    0.0
+                },
+            };
+            regs[read.reg] = Some(value);
+        }
+    }
+
     /// Read variables from RTDB with two-tier priority
     ///
     /// Priority order:
@@ -697,15 +1010,37 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
             };
         };
 
-        // Use voltage_routing to set the action point
         // Use precomputed pool for common point IDs (0-255)
         let point_str = precomputed::get_point_id_str_or_alloc(point);
-        let routed = match set_action_point(
+        let routed = self
+            .route_action(instance_id, point, &point_str, resolved_value)
+            .await;
+
+        ActionResult {
+            target_type: "instance",
+            target_id: instance_id,
+            point_type: point_type_to_static(variable.point_type.as_deref(), "A"),
+            point_id: point,
+            value: resolved_value,
+            success: routed,
+        }
+    }
+
+    /// Set an action point through M2C routing, returning whether it was routed
+    async fn route_action(
+        &self,
+        instance_id: u32,
+        point: u32,
+        point_str: &str,
+        value: f64,
+    ) -> bool {
+        match set_action_point_with_commands(
             self.rtdb.as_ref(),
             &self.routing_cache,
+            self.command_sender.as_deref(),
             instance_id,
-            &point_str,
-            resolved_value,
+            point_str,
+            value,
         )
         .await
         {
@@ -719,15 +1054,6 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
                 );
                 false
             },
-        };
-
-        ActionResult {
-            target_type: "instance",
-            target_id: instance_id,
-            point_type: point_type_to_static(variable.point_type.as_deref(), "A"),
-            point_id: point,
-            value: resolved_value,
-            success: routed,
         }
     }
 
@@ -787,9 +1113,10 @@ impl<R: Rtdb, S: StateStore> RuleExecutor<R, S> {
                 // Use M2C routing for action points
                 // Use precomputed pool for common point IDs (0-255)
                 let point_str = precomputed::get_point_id_str_or_alloc(point);
-                match set_action_point(
+                match set_action_point_with_commands(
                     self.rtdb.as_ref(),
                     &self.routing_cache,
+                    self.command_sender.as_deref(),
                     instance_id,
                     &point_str,
                     value,
@@ -1288,6 +1615,109 @@ mod tests {
         assert!(result.error.unwrap().contains("No matching switch rule"));
     }
 
+    /// Helper: executor over a fresh RTDB with the given SOC value
+    async fn soc_executor(soc: &str) -> RuleExecutor<MemoryRtdb> {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        setup_name_index(&rtdb).await;
+        rtdb.hash_set("inst:5:M", "3", Bytes::from(soc.to_string()))
+            .await
+            .unwrap();
+        RuleExecutor::new(rtdb, Arc::new(RoutingCache::default()))
+    }
+
+    #[tokio::test]
+    async fn test_compiled_matches_interpreter() {
+        let rule = create_soc_rule();
+
+        for soc in ["3.5", "5.0", "50.0", "99.5", "25.0"] {
+            // Fresh RTDB per run: actions write back into the points the flow reads
+            let interpreted = soc_executor(soc).await.execute(&rule).await.unwrap();
+            let executor = soc_executor(soc).await;
+            let program = executor.compile(&rule).expect("SOC rule compiles");
+            let compiled = executor.execute_compiled(&program, true).await.unwrap();
+            let executor = soc_executor(soc).await;
+            let program = executor.compile(&rule).unwrap();
+            let lean = executor.execute_compiled(&program, false).await.unwrap();
+
+            for result in [&compiled, &lean] {
+                assert_eq!(result.success, interpreted.success, "SOC {}", soc);
+                assert_eq!(result.error, interpreted.error, "SOC {}", soc);
+                assert_eq!(result.matched_condition, interpreted.matched_condition);
+                assert_eq!(
+                    result.actions_executed.len(),
+                    interpreted.actions_executed.len()
+                );
+                for (a, b) in result
+                    .actions_executed
+                    .iter()
+                    .zip(&interpreted.actions_executed)
+                {
+                    assert_eq!((a.target_id, a.point_id), (b.target_id, b.point_id));
+                    assert_eq!((a.point_type, a.value), (b.point_type, b.value));
+                }
+            }
+
+            // Details only when requested
+            assert_eq!(compiled.variable_values, interpreted.variable_values);
+            assert_eq!(compiled.execution_path, interpreted.execution_path);
+            assert_eq!(compiled.node_details.len(), interpreted.node_details.len());
+            assert!(lean.execution_path.is_empty());
+            assert!(lean.node_details.is_empty());
+        }
+    }
+
+    #[tokio::test]
+    async fn test_compiled_calculation_chain() {
+        let flow = json!({
+            "nodes": [
+                {"id": "start", "type": "start",
+                 "data": {"config": {"wires": {"default": ["calc"]}}}},
+                {"id": "calc", "type": "custom", "data": {"type": "action-calculation", "config": {
+                    "variables": [
+                        {"name": "P", "instance": 5, "pointType": "measurement", "point": 1},
+                        {"name": "Y", "instance": 5, "pointType": "measurement", "point": 2}
+                    ],
+                    "rule": [
+                        {"output": "T", "formula": "P * 2"},
+                        {"output": "Y", "formula": "clamp(T + 1, 0, 100)"}
+                    ],
+                    "wires": {"default": ["end"]}
+                }}},
+                {"id": "end", "type": "end"}
+            ]
+        });
+        let rule = Rule {
+            id: 2,
+            name: "Calc".to_string(),
+            description: None,
+            enabled: true,
+            priority: 0,
+            cooldown_ms: 0,
+            flow: extract_rule_flow(&flow).unwrap(),
+        };
+
+        let rtdb = Arc::new(MemoryRtdb::new());
+        rtdb.hash_set("inst:5:M", "1", Bytes::from("20"))
+            .await
+            .unwrap();
+        let executor = RuleExecutor::new(rtdb.clone(), Arc::new(RoutingCache::default()));
+        let program = executor.compile(&rule).unwrap();
+        let result = executor.execute_compiled(&program, false).await.unwrap();
+
+        assert!(result.success, "{:?}", result.error);
+        assert_eq!(result.variable_values.get("T"), Some(&40.0));
+        assert_eq!(result.variable_values.get("Y"), Some(&41.0));
+        let written = rtdb.hash_get("inst:5:M", "2").await.unwrap().unwrap();
+        assert_eq!(
+            String::from_utf8_lossy(&written).parse::<f64>().unwrap(),
+            41.0
+        );
+
+        // Interpreter shares the rule's engine and reads the value written back
+        let interpreted = executor.execute(&rule).await.unwrap();
+        assert_eq!(interpreted.variable_values.get("Y"), Some(&41.0));
+    }
+
     #[tokio::test]
     async fn test_read_rule_variables_with_name_index() {
         // Test that read_rule_variables correctly uses name index
@@ -21,6 +21,7 @@
 //! └─────────────┘     └──────────────┘
 //! ```
 
+mod compiled;
 mod error;
 mod executor;
 pub mod logger;
@@ -30,18 +31,25 @@ mod scheduler;
 pub mod types;
 
 // Re-export public API
+pub use compiled::{compile_rule, CompiledRule};
 pub use error::{Result, RuleError};
 pub use executor::{ActionResult, RuleExecutionResult, RuleExecutor};
-pub use logger::{format_conditions, RuleLogger, RuleLoggerManager};
+pub use logger::{
+    format_conditions, RuleLogPolicy, RuleLogStats, RuleLogger, RuleLoggerManager,
+    DEFAULT_LOG_QUEUE_CAPACITY,
+};
 pub use parser::extract_rule_flow;
 pub use repository::{
     delete_rule, get_rule, get_rule_for_execution, list_rules, list_rules_paginated,
     load_all_rules, load_enabled_rules, set_rule_enabled, upsert_rule,
 };
-pub use scheduler::{RuleScheduler, SchedulerStatus, TriggerConfig, DEFAULT_TICK_MS};
+pub use scheduler::{
+    ExecTimeHistogram, RuleScheduler, RuleTiming, SchedulerStatus, TriggerConfig, TriggerPoint,
+    DEFAULT_CHANGE_POLL_MS, DEFAULT_RULE_WORKERS, DEFAULT_TICK_MS, EXEC_TIME_BUCKETS_US,
+};
 
 // Re-export rule types for convenience
 pub use types::{
-    CalculationRule, FlowCondition, Rule, RuleFlow, RuleNode, RuleSwitchBranch,
-    RuleValueAssignment, RuleVariable, RuleWires,
+    CalculationRule, FlowCondition, Rule, RuleFlow, RuleNode, RuleSwitchBranch, RuleTrigger,
+    RuleTriggerPoint, RuleValueAssignment, RuleVariable, RuleWires,
 };
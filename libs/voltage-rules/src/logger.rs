@@ -2,118 +2,405 @@
 //!
 //! Provides independent log files for each rule, capturing execution details
 //! including variable values, matched conditions, and action results.
+//!
+//! Logging is off the scheduler path: [`RuleLogger::log_execution`] only
+//! applies the [`RuleLogPolicy`] and pushes a record into a bounded queue.
+//! A background writer thread drains the queue, formats the records and
+//! appends them with one write per rule file per batch. When the queue is
+//! full, records are dropped and counted ([`RuleLogStats::dropped`]).
 
 use std::{
+    collections::hash_map::DefaultHasher,
     collections::HashMap,
     fmt::Write as FmtWrite,
     fs::{self, File, OpenOptions},
+    hash::{Hash, Hasher},
     io::Write,
     path::{Path, PathBuf},
+    str::FromStr,
+    sync::atomic::{AtomicU64, Ordering},
+    sync::mpsc::{self, Receiver, SyncSender, TrySendError},
     sync::{Arc, Mutex},
 };
 
 use crate::types::FlowCondition;
-use chrono::{Local, Utc};
+use chrono::{DateTime, Local, Utc};
+use serde::Serialize;
 use tracing::warn;
 
 use crate::executor::{ActionResult, RuleExecutionResult};
 
-/// Logger for individual rule execution
-pub struct RuleLogger {
-    rule_id: String,
-    log_dir: PathBuf,
-    current_date: Mutex<String>,
-    current_file: Mutex<Option<File>>,
+/// Default capacity of the rule log queue (records)
+pub const DEFAULT_LOG_QUEUE_CAPACITY: usize = 8192;
+
+/// Maximum records drained by the writer per batch
+const LOG_WRITE_BATCH: usize = 512;
+
+/// Which rule executions are written to the rule log
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum RuleLogPolicy {
+    /// Every execution
+    #[default]
+    All,
+    /// Only executions whose matched condition, actions or error differ
+    /// from the previous execution of the same rule
+    OnChange,
+    /// Every n-th execution of each rule (first execution included)
+    Sample(u32),
 }
 
-impl RuleLogger {
-    /// Create a new RuleLogger for a specific rule
-    ///
-    /// Log files will be created in: `{log_root}/rules/{rule_id}/`
-    /// with naming format: `{YYYYMMDD}_{rule_name}.log`
-    pub fn new(log_root: &Path, rule_id: i64, _rule_name: &str) -> Self {
-        let rule_id_str = rule_id.to_string();
-        let rule_dir = log_root.join("rules").join(&rule_id_str);
-        if let Err(e) = fs::create_dir_all(&rule_dir) {
-            warn!("Log dir err {:?}: {}", rule_dir, e);
+impl FromStr for RuleLogPolicy {
+    type Err = String;
+
+    /// Parse `all`, `on_change` or `sample:N`
+    fn from_str(s: &str) -> std::result::Result<Self, Self::Err> {
+        match s.trim() {
+            "all" => Ok(Self::All),
+            "on_change" => Ok(Self::OnChange),
+            other => other
+                .strip_prefix("sample:")
+                .and_then(|n| n.parse::<u32>().ok())
+                .filter(|&n| n > 0)
+                .map(Self::Sample)
+                .ok_or_else(|| format!("invalid rule log policy: {}", other)),
+        }
+    }
+}
+
+/// Rule log pipeline counters
+#[derive(Debug, Clone, Copy, Default, Serialize)]
+pub struct RuleLogStats {
+    /// Records accepted into the queue
+    pub enqueued: u64,
+    /// Records dropped because the queue was full or the writer is gone
+    pub dropped: u64,
+    /// Executions skipped by the log policy
+    pub filtered: u64,
+    /// Lines written to rule log files
+    pub written: u64,
+    /// Lines lost to file open/write errors
+    pub write_errors: u64,
+}
+
+#[derive(Default)]
+struct LogCounters {
+    enqueued: AtomicU64,
+    dropped: AtomicU64,
+    filtered: AtomicU64,
+    written: AtomicU64,
+    write_errors: AtomicU64,
+}
+
+/// One execution captured on the scheduler path, formatted by the writer
+struct LogRecord {
+    rule_id: i64,
+    timestamp: DateTime<Utc>,
+    variables: Arc<HashMap<String, f64>>,
+    matched_condition: Option<String>,
+    actions: Vec<ActionResult>,
+    error: Option<String>,
+}
+
+enum LogMessage {
+    Record(LogRecord),
+    /// Flush and close the rule's file (rule removed)
+    Close(i64),
+}
+
+/// Queue and counters shared by the manager and its loggers
+struct LogPipeline {
+    queue: SyncSender<LogMessage>,
+    counters: LogCounters,
+}
+
+impl LogPipeline {
+    /// Spawn the writer thread and return the producer side
+    fn spawn(log_root: PathBuf, capacity: usize) -> Arc<Self> {
+        let (queue, rx) = mpsc::sync_channel(capacity.max(1));
+        let pipeline = Arc::new(Self {
+            queue,
+            counters: LogCounters::default(),
+        });
+
+        // The writer only holds a weak handle so dropping the last producer
+        // disconnects the queue and lets the thread drain and exit
+        let weak = Arc::downgrade(&pipeline);
+        let spawned = std::thread::Builder::new()
+            .name("rule-log".to_string())
+            .spawn(move || {
+                let mut writer = LogWriter::new(log_root);
+                writer.run(rx, |lines, failed| {
+                    if let Some(pipeline) = weak.upgrade() {
+                        let counters = &pipeline.counters;
+                        counters.written.fetch_add(lines, Ordering::Relaxed);
+                        counters.write_errors.fetch_add(failed, Ordering::Relaxed);
+                    }
+                });
+            });
+        if let Err(e) = spawned {
+            // Receiver is gone: every record is counted as dropped
+            warn!("Rule log writer spawn err: {}", e);
         }
+        pipeline
+    }
+
+    /// Enqueue without blocking; a full queue drops the message
+    fn send(&self, message: LogMessage) {
+        let is_record = matches!(message, LogMessage::Record(_));
+        let counter = match self.queue.try_send(message) {
+            Ok(()) => &self.counters.enqueued,
+            Err(TrySendError::Full(_)) | Err(TrySendError::Disconnected(_)) => {
+                &self.counters.dropped
+            },
+        };
+        if is_record {
+            counter.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+}
+
+/// Open log file of one rule
+struct RuleFile {
+    date: String,
+    file: File,
+}
+
+/// Background side of the pipeline: batches records per rule file
+struct LogWriter {
+    log_root: PathBuf,
+    files: HashMap<i64, RuleFile>,
+    /// Pending lines per rule: (text, line count)
+    pending: HashMap<i64, (String, u64)>,
+}
 
+impl LogWriter {
+    fn new(log_root: PathBuf) -> Self {
         Self {
-            rule_id: rule_id_str,
-            log_dir: rule_dir,
-            current_date: Mutex::new(String::new()),
-            current_file: Mutex::new(None),
+            log_root,
+            files: HashMap::new(),
+            pending: HashMap::new(),
         }
     }
 
-    /// Log rule execution with matched condition only
+    /// Drain the queue until every producer is gone
     ///
-    /// Format: `timestamp [RULE] rule_id vars | matched_condition | action_result`
-    pub fn log_execution(&self, result: &RuleExecutionResult, vars: &HashMap<String, f64>) {
-        // Format variable values: "X1=50.3 X2=25.0"
-        // Optimization: use fmt::Write to avoid intermediate Vec allocation
-        let vars_str = if vars.is_empty() {
-            "-".to_string()
-        } else {
-            let mut result = String::with_capacity(vars.len() * 10);
-            for (i, (k, v)) in vars.iter().enumerate() {
-                if i > 0 {
-                    result.push(' ');
+    /// `report(written, failed)` is called after each batch.
+    fn run(&mut self, rx: Receiver<LogMessage>, mut report: impl FnMut(u64, u64)) {
+        let mut batch: Vec<LogMessage> = Vec::with_capacity(LOG_WRITE_BATCH);
+        while let Ok(first) = rx.recv() {
+            batch.push(first);
+            while batch.len() < LOG_WRITE_BATCH {
+                match rx.try_recv() {
+                    Ok(message) => batch.push(message),
+                    Err(_) => break,
                 }
-                let _ = write!(result, "{}={:.1}", k, v);
             }
-            result
-        };
 
-        // Matched condition or "-"
-        let cond_str = result.matched_condition.as_deref().unwrap_or("-");
-
-        // Action results: "diesel_gen_01:A:2=1 OK"
-        let actions_str = format_actions(&result.actions_executed, result.error.as_deref());
+            let mut written = 0;
+            let mut failed = 0;
+            for message in batch.drain(..) {
+                match message {
+                    LogMessage::Record(record) => {
+                        let (text, lines) = self.pending.entry(record.rule_id).or_default();
+                        format_record(text, &record);
+                        *lines += 1;
+                    },
+                    LogMessage::Close(rule_id) => {
+                        let (ok, err) = self.flush_rule(rule_id);
+                        written += ok;
+                        failed += err;
+                        self.files.remove(&rule_id);
+                        self.pending.remove(&rule_id);
+                    },
+                }
+            }
 
-        // Compose: "X1=50.3 | X1>=49 | diesel_gen_01:A:2=1 OK"
-        let message = format!("{} | {} | {}", vars_str, cond_str, actions_str);
-        self.write_line(&message);
+            let rule_ids: Vec<i64> = self
+                .pending
+                .iter()
+                .filter(|(_, (_, lines))| *lines > 0)
+                .map(|(&id, _)| id)
+                .collect();
+            for rule_id in rule_ids {
+                let (ok, err) = self.flush_rule(rule_id);
+                written += ok;
+                failed += err;
+            }
+            report(written, failed);
+        }
     }
 
-    fn write_line(&self, message: &str) {
-        let today = Local::now().format("%Y%m%d").to_string();
-        let timestamp = Utc::now().format("%Y-%m-%dT%H:%M:%S%.3fZ");
-
-        // Check if we need to rotate the file (new day)
-        let Ok(mut current_date) = self.current_date.lock() else {
-            warn!("Date lock fail");
-            return;
-        };
-        let Ok(mut file_guard) = self.current_file.lock() else {
-            warn!("File lock fail");
-            return;
+    /// Append the pending lines of one rule in a single write
+    ///
+    /// Returns (lines written, lines failed).
+    fn flush_rule(&mut self, rule_id: i64) -> (u64, u64) {
+        let Some((text, lines)) = self.pending.get_mut(&rule_id) else {
+            return (0, 0);
         };
+        if *lines == 0 {
+            return (0, 0);
+        }
+        let count = std::mem::take(lines);
 
-        if *current_date != today {
-            // New day - open new file
-            *current_date = today.clone();
-            let file_path = self.log_dir.join(format!("{}_{}.log", today, self.rule_id));
-
-            match OpenOptions::new()
-                .create(true)
-                .append(true)
-                .open(&file_path)
-            {
-                Ok(file) => *file_guard = Some(file),
-                Err(e) => {
-                    warn!("Log open err {:?}: {}", file_path, e);
-                    return;
+        let today = Local::now().format("%Y%m%d").to_string();
+        let rotate = self.files.get(&rule_id).is_none_or(|f| f.date != today);
+        if rotate {
+            // First write or new day - open new file
+            match open_rule_file(&self.log_root, rule_id, &today) {
+                Some(file) => {
+                    self.files.insert(rule_id, RuleFile { date: today, file });
+                },
+                None => {
+                    self.files.remove(&rule_id);
+                    text.clear();
+                    return (0, count);
                 },
             }
         }
 
-        // Write the log line
-        if let Some(ref mut file) = *file_guard {
-            let line = format!("{} [RULE] {} {}\n", timestamp, self.rule_id, message);
-            if let Err(e) = file.write_all(line.as_bytes()) {
+        let result = match self.files.get_mut(&rule_id) {
+            Some(rule_file) => rule_file.file.write_all(text.as_bytes()),
+            None => Ok(()),
+        };
+        text.clear();
+        match result {
+            Ok(()) => (count, 0),
+            Err(e) => {
                 warn!("Log write err: {}", e);
+                (0, count)
+            },
+        }
+    }
+}
+
+/// Open `{log_root}/rules/{rule_id}/{YYYYMMDD}_{rule_id}.log` for appending
+fn open_rule_file(log_root: &Path, rule_id: i64, date: &str) -> Option<File> {
+    let rule_dir = log_root.join("rules").join(rule_id.to_string());
+    if let Err(e) = fs::create_dir_all(&rule_dir) {
+        warn!("Log dir err {:?}: {}", rule_dir, e);
+        return None;
+    }
+
+    let file_path = rule_dir.join(format!("{}_{}.log", date, rule_id));
+    match OpenOptions::new()
+        .create(true)
+        .append(true)
+        .open(&file_path)
+    {
+        Ok(file) => Some(file),
+        Err(e) => {
+            warn!("Log open err {:?}: {}", file_path, e);
+            None
+        },
+    }
+}
+
+/// Append one log line
+///
+/// Format: `timestamp [RULE] rule_id vars | matched_condition | action_result`
+fn format_record(out: &mut String, record: &LogRecord) {
+    let _ = write!(
+        out,
+        "{} [RULE] {} ",
+        record.timestamp.format("%Y-%m-%dT%H:%M:%S%.3fZ"),
+        record.rule_id
+    );
+
+    // Variable values: "X1=50.3 X2=25.0"
+    if record.variables.is_empty() {
+        out.push('-');
+    } else {
+        for (i, (k, v)) in record.variables.iter().enumerate() {
+            if i > 0 {
+                out.push(' ');
             }
+            let _ = write!(out, "{}={:.1}", k, v);
+        }
+    }
+
+    // Matched condition or "-", then action results
+    let cond_str = record.matched_condition.as_deref().unwrap_or("-");
+    let actions_str = format_actions(&record.actions, record.error.as_deref());
+    let _ = writeln!(out, " | {} | {}", cond_str, actions_str);
+}
+
+/// Fingerprint of what an execution did (condition, actions, error)
+///
+/// Never 0, so 0 can mean "no previous execution".
+fn outcome_signature(result: &RuleExecutionResult) -> u64 {
+    let mut hasher = DefaultHasher::new();
+    result.matched_condition.hash(&mut hasher);
+    result.error.hash(&mut hasher);
+    for a in &result.actions_executed {
+        a.target_type.hash(&mut hasher);
+        a.target_id.hash(&mut hasher);
+        a.point_type.hash(&mut hasher);
+        a.point_id.hash(&mut hasher);
+        a.value.to_bits().hash(&mut hasher);
+        a.success.hash(&mut hasher);
+    }
+    hasher.finish().max(1)
+}
+
+/// Logger for individual rule execution
+///
+/// Cheap handle: records go to the shared background writer.
+pub struct RuleLogger {
+    rule_id: i64,
+    policy: RuleLogPolicy,
+    pipeline: Arc<LogPipeline>,
+    /// Executions seen (for sampling)
+    executions: AtomicU64,
+    /// Outcome signature of the previous execution (0 = none)
+    last_signature: AtomicU64,
+}
+
+impl RuleLogger {
+    fn new(rule_id: i64, policy: RuleLogPolicy, pipeline: Arc<LogPipeline>) -> Self {
+        Self {
+            rule_id,
+            policy,
+            pipeline,
+            executions: AtomicU64::new(0),
+            last_signature: AtomicU64::new(0),
+        }
+    }
+
+    /// Log rule execution with matched condition only
+    ///
+    /// Non-blocking: applies the log policy and enqueues the record.
+    /// Log files are written in: `{log_root}/rules/{rule_id}/`
+    /// with naming format: `{YYYYMMDD}_{rule_id}.log`
+    pub fn log_execution(&self, result: &RuleExecutionResult) {
+        if !self.should_log(result) {
+            self.pipeline
+                .counters
+                .filtered
+                .fetch_add(1, Ordering::Relaxed);
+            return;
+        }
+
+        self.pipeline.send(LogMessage::Record(LogRecord {
+            rule_id: self.rule_id,
+            timestamp: Utc::now(),
+            variables: Arc::clone(&result.variable_values),
+            matched_condition: result.matched_condition.clone(),
+            actions: result.actions_executed.clone(),
+            error: result.error.clone(),
+        }));
+    }
+
+    fn should_log(&self, result: &RuleExecutionResult) -> bool {
+        match self.policy {
+            RuleLogPolicy::All => true,
+            RuleLogPolicy::OnChange => {
+                let signature = outcome_signature(result);
+                self.last_signature.swap(signature, Ordering::Relaxed) != signature
+            },
+            RuleLogPolicy::Sample(every) => {
+                let n = self.executions.fetch_add(1, Ordering::Relaxed);
+                n.is_multiple_of(u64::from(every.max(1)))
+            },
         }
     }
 }
@@ -194,40 +481,60 @@ pub fn format_conditions(conditions: &[FlowCondition]) -> String {
 /// Manager for multiple rule loggers
 pub struct RuleLoggerManager {
     log_root: PathBuf,
-    loggers: Mutex<HashMap<String, Arc<RuleLogger>>>,
+    policy: RuleLogPolicy,
+    pipeline: Arc<LogPipeline>,
+    loggers: Mutex<HashMap<i64, Arc<RuleLogger>>>,
 }
 
 impl RuleLoggerManager {
-    /// Create a new logger manager
+    /// Create a new logger manager (log every execution)
     pub fn new(log_root: PathBuf) -> Self {
+        Self::with_policy(log_root, RuleLogPolicy::All, DEFAULT_LOG_QUEUE_CAPACITY)
+    }
+
+    /// Create a logger manager with a log policy and queue capacity
+    ///
+    /// Spawns the background writer thread.
+    pub fn with_policy(log_root: PathBuf, policy: RuleLogPolicy, queue_capacity: usize) -> Self {
         Self {
+            pipeline: LogPipeline::spawn(log_root.clone(), queue_capacity),
             log_root,
+            policy,
             loggers: Mutex::new(HashMap::new()),
         }
     }
 
+    /// Root directory of the rule log files
+    pub fn log_root(&self) -> &Path {
+        &self.log_root
+    }
+
     /// Get or create a logger for a specific rule
-    pub fn get_logger(&self, rule_id: i64, rule_name: &str) -> Arc<RuleLogger> {
-        let rule_id_str = rule_id.to_string();
+    pub fn get_logger(&self, rule_id: i64, _rule_name: &str) -> Arc<RuleLogger> {
         let Ok(mut loggers) = self.loggers.lock() else {
             warn!("Loggers lock fail, temp logger");
-            return Arc::new(RuleLogger::new(&self.log_root, rule_id, rule_name));
+            return Arc::new(RuleLogger::new(
+                rule_id,
+                self.policy,
+                Arc::clone(&self.pipeline),
+            ));
         };
 
-        if let Some(logger) = loggers.get(&rule_id_str) {
-            return Arc::clone(logger);
-        }
-
-        let logger = Arc::new(RuleLogger::new(&self.log_root, rule_id, rule_name));
-        loggers.insert(rule_id_str, Arc::clone(&logger));
-        logger
+        Arc::clone(loggers.entry(rule_id).or_insert_with(|| {
+            Arc::new(RuleLogger::new(
+                rule_id,
+                self.policy,
+                Arc::clone(&self.pipeline),
+            ))
+        }))
     }
 
     /// Remove a logger (e.g., when rule is deleted)
     pub fn remove_logger(&self, rule_id: i64) {
         if let Ok(mut loggers) = self.loggers.lock() {
-            loggers.remove(&rule_id.to_string());
+            loggers.remove(&rule_id);
         }
+        self.pipeline.send(LogMessage::Close(rule_id));
     }
 
     /// Clear all loggers
@@ -236,6 +543,18 @@ impl RuleLoggerManager {
             loggers.clear();
         }
     }
+
+    /// Snapshot of the pipeline counters
+    pub fn stats(&self) -> RuleLogStats {
+        let c = &self.pipeline.counters;
+        RuleLogStats {
+            enqueued: c.enqueued.load(Ordering::Relaxed),
+            dropped: c.dropped.load(Ordering::Relaxed),
+            filtered: c.filtered.load(Ordering::Relaxed),
+            written: c.written.load(Ordering::Relaxed),
+            write_errors: c.write_errors.load(Ordering::Relaxed),
+        }
+    }
 }
 
 #[cfg(test)]
@@ -352,4 +671,87 @@ mod tests {
         let actions: Vec<ActionResult> = vec![];
         assert_eq!(format_actions(&actions, None), "no action");
     }
+
+    fn exec_result(condition: Option<&str>, value: f64) -> RuleExecutionResult {
+        RuleExecutionResult {
+            rule_id: 1,
+            success: true,
+            actions_executed: vec![ActionResult {
+                target_type: "instance",
+                target_id: 5,
+                point_type: "A",
+                point_id: 2,
+                value,
+                success: true,
+            }],
+            error: None,
+            execution_path: Vec::new(),
+            matched_condition: condition.map(str::to_string),
+            variable_values: Arc::new(HashMap::from([("X1".to_string(), 50.3)])),
+            node_details: HashMap::new(),
+        }
+    }
+
+    fn test_manager(policy: RuleLogPolicy) -> RuleLoggerManager {
+        let root = std::env::temp_dir().join(format!("rule-log-test-{}", std::process::id()));
+        RuleLoggerManager::with_policy(root, policy, 16)
+    }
+
+    #[test]
+    fn test_log_policy_parse() {
+        assert_eq!("all".parse(), Ok(RuleLogPolicy::All));
+        assert_eq!("on_change".parse(), Ok(RuleLogPolicy::OnChange));
+        assert_eq!("sample:10".parse(), Ok(RuleLogPolicy::Sample(10)));
+        assert!("sample:0".parse::<RuleLogPolicy>().is_err());
+        assert!("verbose".parse::<RuleLogPolicy>().is_err());
+    }
+
+    #[test]
+    fn test_on_change_policy_skips_repeats() {
+        let manager = test_manager(RuleLogPolicy::OnChange);
+        let logger = manager.get_logger(1, "r1");
+
+        logger.log_execution(&exec_result(Some("X1>=49"), 1.0));
+        logger.log_execution(&exec_result(Some("X1>=49"), 1.0));
+        logger.log_execution(&exec_result(Some("X1>=49"), 0.0));
+        logger.log_execution(&exec_result(None, 0.0));
+
+        let stats = manager.stats();
+        assert_eq!(stats.enqueued + stats.dropped, 3);
+        assert_eq!(stats.filtered, 1);
+    }
+
+    #[test]
+    fn test_sample_policy_keeps_every_nth() {
+        let manager = test_manager(RuleLogPolicy::Sample(3));
+        let logger = manager.get_logger(2, "r2");
+
+        for _ in 0..7 {
+            logger.log_execution(&exec_result(Some("X1>=49"), 1.0));
+        }
+
+        let stats = manager.stats();
+        assert_eq!(stats.enqueued + stats.dropped, 3);
+        assert_eq!(stats.filtered, 4);
+    }
+
+    #[test]
+    fn test_format_record_line() {
+        let result = exec_result(Some("X1>=49"), 1.0);
+        let record = LogRecord {
+            rule_id: 7,
+            timestamp: DateTime::from_timestamp(0, 0).unwrap_or_default(),
+            variables: Arc::clone(&result.variable_values),
+            matched_condition: result.matched_condition.clone(),
+            actions: result.actions_executed.clone(),
+            error: None,
+        };
+
+        let mut out = String::new();
+        format_record(&mut out, &record);
+        assert_eq!(
+            out,
+            "1970-01-01T00:00:00.000Z [RULE] 7 X1=50.3 | X1>=49 | 5:A:2=1 OK\n"
+        );
+    }
 }
@@ -7,8 +7,8 @@
 //! discarding UI-only data like positions, labels, and edge styling.
 
 use crate::types::{
-    CalculationRule, FlowCondition, RuleFlow, RuleNode, RuleSwitchBranch, RuleValueAssignment,
-    RuleVariable, RuleWires,
+    CalculationRule, FlowCondition, RuleFlow, RuleNode, RuleSwitchBranch, RuleTrigger,
+    RuleValueAssignment, RuleVariable, RuleWires,
 };
 use serde_json::Value;
 use std::collections::HashMap;
@@ -45,6 +45,7 @@ pub fn extract_rule_flow(full_json: &Value) -> Result<RuleFlow> {
 
     let mut nodes = HashMap::new();
     let mut start_node = String::new();
+    let mut trigger = None;
 
     for node in nodes_array {
         let node_id = node
@@ -63,6 +64,7 @@ pub fn extract_rule_flow(full_json: &Value) -> Result<RuleFlow> {
         let compact_node = match node_type {
             "start" => {
                 start_node = node_id.clone();
+                trigger = extract_rule_trigger(data)?;
                 let wires = extract_rule_wires_default(data)?;
                 RuleNode::Start { wires }
             },
@@ -98,7 +100,30 @@ pub fn extract_rule_flow(full_json: &Value) -> Result<RuleFlow> {
         ));
     }
 
-    Ok(RuleFlow { start_node, nodes })
+    Ok(RuleFlow {
+        start_node,
+        nodes,
+        trigger,
+    })
+}
+
+/// Extract the optional trigger declaration from start node data
+fn extract_rule_trigger(data: Option<&Value>) -> Result<Option<RuleTrigger>> {
+    let Some(trigger) = data
+        .and_then(|d| d.get("config"))
+        .and_then(|c| c.get("trigger"))
+        .or_else(|| data.and_then(|d| d.get("trigger")))
+    else {
+        return Ok(None);
+    };
+
+    if trigger.is_null() {
+        return Ok(None);
+    }
+
+    serde_json::from_value(trigger.clone())
+        .map(Some)
+        .map_err(|e| RuleError::ParseError(format!("Invalid trigger: {}", e)))
 }
 
 /// Extract RuleWires from node data (for default wire)
@@ -575,4 +600,46 @@ mod tests {
         assert_eq!(deserialized.start_node, "start");
         assert_eq!(deserialized.nodes.len(), 2);
     }
+
+    #[test]
+    fn test_extract_rule_trigger() {
+        let flow = json!({
+            "nodes": [
+                {
+                    "id": "start",
+                    "type": "start",
+                    "data": {
+                        "config": {
+                            "wires": { "default": ["end"] },
+                            "trigger": {
+                                "type": "on_change",
+                                "points": [{ "instance": 1, "pointType": "action", "point": 7 }]
+                            }
+                        }
+                    }
+                },
+                { "id": "end", "type": "end" }
+            ]
+        });
+
+        let compact = extract_rule_flow(&flow).unwrap();
+        let Some(RuleTrigger::OnChange { points }) = &compact.trigger else {
+            panic!("Expected on_change trigger");
+        };
+        assert_eq!(points.len(), 1);
+        assert_eq!(points[0].instance, 1);
+        assert_eq!(points[0].point_type.as_deref(), Some("action"));
+        assert_eq!(points[0].point, 7);
+
+        // Trigger survives the nodes_json round trip
+        let serialized = serde_json::to_string(&compact).unwrap();
+        let deserialized: RuleFlow = serde_json::from_str(&serialized).unwrap();
+        assert_eq!(deserialized.trigger, compact.trigger);
+
+        // No trigger declared → interval scheduling
+        let flow = json!({
+            "nodes": [{ "id": "start", "type": "start", "data": { "wires": { "default": [] } } }]
+        });
+        assert!(extract_rule_flow(&flow).unwrap().trigger.is_none());
+    }
 }
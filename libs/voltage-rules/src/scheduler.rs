@@ -1,29 +1,66 @@
-//! Rule Scheduler - Periodic rule execution scheduler
+//! Rule Scheduler - Periodic and event-driven rule execution scheduler
 //!
 //! Manages rule execution based on trigger configurations:
-//! - Interval: Execute rules at fixed intervals
+//! - Interval: Execute rules at fixed intervals (tick-based, 100ms granularity)
+//! - OnChange: Execute rules when one of their input points changes
 //!
-//! Current implementation uses a simple tick-based approach with 100ms granularity.
+//! OnChange rules are indexed by the instance points they watch. Changes are
+//! picked up from the shared-memory change ring (polled every
+//! `DEFAULT_CHANGE_POLL_MS`) or pushed in-process via
+//! [`RuleScheduler::notify_points_changed`], and only the affected rules are
+//! re-evaluated. Without a change ring, OnChange rules fall back to running
+//! on every tick, as do rules watching points not (yet) in shared memory.
+//! Watched slots are re-resolved whenever comsrv restarts or registers more
+//! points.
+//!
+//! Due rules of one cycle execute concurrently on up to `workers` tasks, and
+//! per-rule execution times are kept as histograms ([`RuleScheduler::rule_timings`]).
+//! Rules are compiled into flat programs at load time ([`crate::CompiledRule`]);
+//! flows that cannot be compiled run on the interpreter.
 
+use crate::compiled::CompiledRule;
 use crate::error::Result;
 use crate::executor::{RuleExecutionResult, RuleExecutor};
-use crate::logger::RuleLoggerManager;
+use crate::logger::{RuleLogPolicy, RuleLogStats, RuleLoggerManager};
 use crate::repository;
-use crate::types::Rule;
+use crate::types::{Rule, RuleNode, RuleTrigger, RuleTriggerPoint};
 use bytes::Bytes;
+use serde::Serialize;
 use sqlx::SqlitePool;
+use std::collections::{HashMap, HashSet};
 use std::path::PathBuf;
 use std::sync::Arc;
 use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
-use tokio::sync::RwLock;
-use tokio::time::interval;
+use tokio::sync::{Mutex, RwLock, Semaphore};
+use tokio::task::JoinSet;
+use tokio::time::{interval, MissedTickBehavior};
 use tracing::{debug, error, info, warn};
 use voltage_rtdb::traits::Rtdb;
-use voltage_rtdb::{RoutingCache, SharedVecRtdbReader};
+use voltage_rtdb::{ChangeCursor, RoutingCache, SharedCommandSender, SharedVecRtdbReader};
 
 /// Default scheduler tick interval (100ms)
 pub const DEFAULT_TICK_MS: u64 = 100;
 
+/// Shared-memory change ring poll interval for OnChange rules (1ms)
+pub const DEFAULT_CHANGE_POLL_MS: u64 = 1;
+
+/// Maximum change ring entries consumed per poll
+const CHANGE_DRAIN_BATCH: usize = 4096;
+
+/// Default number of rules executed concurrently per cycle
+pub const DEFAULT_RULE_WORKERS: usize = 4;
+
+/// Execution-time histogram bucket upper bounds in microseconds
+///
+/// Durations above the last bound land in an extra overflow bucket.
+pub const EXEC_TIME_BUCKETS_US: [u64; 8] =
+    [100, 500, 1_000, 5_000, 10_000, 50_000, 100_000, 500_000];
+
+/// Instance point watched by an OnChange trigger: (instance_id, point_type, point_id)
+///
+/// `point_type` follows the SharedVecRtdb convention: 0 = measurement, 1 = action.
+pub type TriggerPoint = (u32, u8, u32);
+
 /// Rule trigger configuration
 #[derive(Debug, Clone)]
 pub enum TriggerConfig {
@@ -32,6 +69,42 @@ pub enum TriggerConfig {
         /// Interval in milliseconds
         interval_ms: u64,
     },
+    /// Execute rule when any of the watched points changes
+    OnChange {
+        /// Watched instance points
+        points: Vec<TriggerPoint>,
+    },
+}
+
+impl TriggerConfig {
+    /// Resolve the trigger declared in the rule flow
+    ///
+    /// Rules without a declaration keep the interval derived from cooldown
+    /// (1 second by default). An OnChange trigger without explicit points
+    /// watches the points the rule reads.
+    pub fn for_rule(rule: &Rule) -> Self {
+        match &rule.flow.trigger {
+            Some(RuleTrigger::Interval { interval_ms }) => TriggerConfig::Interval {
+                interval_ms: *interval_ms,
+            },
+            Some(RuleTrigger::OnChange { points }) if points.is_empty() => {
+                TriggerConfig::OnChange {
+                    points: rule_input_points(rule),
+                }
+            },
+            Some(RuleTrigger::OnChange { points }) => TriggerConfig::OnChange {
+                points: points.iter().map(trigger_point).collect(),
+            },
+            None => {
+                let interval_ms = if rule.cooldown_ms > 0 {
+                    rule.cooldown_ms
+                } else {
+                    1000 // Default 1 second
+                };
+                TriggerConfig::Interval { interval_ms }
+            },
+        }
+    }
 }
 
 impl Default for TriggerConfig {
@@ -41,13 +114,226 @@ impl Default for TriggerConfig {
     }
 }
 
+/// Map a SharedVecRtdb point type from the rule variable format
+fn point_type_code(point_type: Option<&str>) -> u8 {
+    match point_type {
+        Some("action") => 1,
+        _ => 0,
+    }
+}
+
+fn trigger_point(point: &RuleTriggerPoint) -> TriggerPoint {
+    (
+        point.instance,
+        point_type_code(point.point_type.as_deref()),
+        point.point,
+    )
+}
+
+/// Collect the instance points a rule reads (switch inputs and calculation inputs)
+///
+/// Calculation output variables and change-value targets are written, not read,
+/// and are excluded so a rule does not re-trigger itself.
+fn rule_input_points(rule: &Rule) -> Vec<TriggerPoint> {
+    let mut points = Vec::new();
+
+    for node in rule.flow.nodes.values() {
+        let (variables, outputs): (_, Vec<&str>) = match node {
+            RuleNode::Switch { variables, .. } => (variables, Vec::new()),
+            RuleNode::Calculation {
+                variables, rule, ..
+            } => (variables, rule.iter().map(|r| r.output.as_str()).collect()),
+            _ => continue,
+        };
+
+        for var in variables {
+            if !var.formula.is_empty() || outputs.contains(&var.name.as_str()) {
+                continue;
+            }
+            if let (Some(instance), Some(point)) = (var.instance, var.point) {
+                points.push((instance, point_type_code(var.point_type.as_deref()), point));
+            }
+        }
+    }
+
+    points.sort_unstable();
+    points.dedup();
+    points
+}
+
+/// Per-rule execution-time histogram
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct ExecTimeHistogram {
+    /// Counts per `EXEC_TIME_BUCKETS_US` bucket, plus the overflow bucket
+    pub buckets: [u64; EXEC_TIME_BUCKETS_US.len() + 1],
+    /// Number of recorded executions
+    pub count: u64,
+    /// Total execution time in microseconds
+    pub sum_us: u64,
+    /// Slowest execution in microseconds
+    pub max_us: u64,
+}
+
+impl ExecTimeHistogram {
+    fn record(&mut self, elapsed: Duration) {
+        let us = elapsed.as_micros() as u64;
+        let bucket = EXEC_TIME_BUCKETS_US
+            .iter()
+            .position(|&bound| us <= bound)
+            .unwrap_or(EXEC_TIME_BUCKETS_US.len());
+        self.buckets[bucket] += 1;
+        self.count += 1;
+        self.sum_us += us;
+        self.max_us = self.max_us.max(us);
+    }
+
+    /// Mean execution time in microseconds (0 when nothing was recorded)
+    pub fn mean_us(&self) -> u64 {
+        self.sum_us.checked_div(self.count).unwrap_or(0)
+    }
+}
+
+/// Execution timing of one scheduled rule
+#[derive(Debug, Clone, Serialize)]
+pub struct RuleTiming {
+    pub rule_id: i64,
+    pub rule_name: String,
+    pub histogram: ExecTimeHistogram,
+}
+
 /// Runtime state for a scheduled rule
 struct ScheduledRule {
-    rule: Rule,
+    rule: Arc<Rule>,
+    /// Flat program for the hot path (`None` = interpreted)
+    compiled: Option<Arc<CompiledRule>>,
     trigger: TriggerConfig,
     last_execution: Option<Instant>,
     /// Track last cooldown trigger time
     last_cooldown_start: Option<Instant>,
+    /// Execution-time histogram (kept across reloads)
+    exec_time: ExecTimeHistogram,
+}
+
+/// Result of one rule execution, applied in Phase 3 of the scheduler cycle
+struct ExecutionOutcome {
+    idx: usize,
+    rule_id: i64,
+    start_cooldown: bool,
+    elapsed: Duration,
+}
+
+/// Execute one rule, log the result and publish it to Redis
+async fn execute_one<R: Rtdb>(
+    executor: &RuleExecutor<R, voltage_calc::MemoryStateStore>,
+    rtdb: &R,
+    logger_manager: &RuleLoggerManager,
+    idx: usize,
+    rule: Arc<Rule>,
+    compiled: Option<Arc<CompiledRule>>,
+    details: bool,
+) -> ExecutionOutcome {
+    debug!("Executing rule: {}", rule.id);
+    let rule_id = rule.id;
+    let started = Instant::now();
+
+    let executed = match &compiled {
+        Some(program) => executor.execute_compiled(program, details).await,
+        None => executor.execute(&rule).await,
+    };
+    match executed {
+        Ok(result) => {
+            let elapsed = started.elapsed();
+
+            // Queue rule execution for the background rule log writer
+            let logger = logger_manager.get_logger(rule.id, &rule.name);
+            logger.log_execution(&result);
+
+            // Write rule execution result to Redis for WebSocket monitoring
+            write_rule_exec_to_redis(rtdb, rule.id, &result).await;
+
+            let start_cooldown = result.success && !result.actions_executed.is_empty();
+
+            if result.success {
+                debug!(
+                    "Rule {} executed successfully, {} actions",
+                    result.rule_id,
+                    result.actions_executed.len()
+                );
+            } else {
+                warn!("Rule {} fail: {:?}", result.rule_id, result.error);
+            }
+
+            ExecutionOutcome {
+                idx,
+                rule_id,
+                start_cooldown,
+                elapsed,
+            }
+        },
+        Err(e) => {
+            error!("Rule {} err: {}", rule_id, e);
+            // Still update last_execution to prevent retry spam
+            ExecutionOutcome {
+                idx,
+                rule_id,
+                start_cooldown: false,
+                elapsed: started.elapsed(),
+            }
+        },
+    }
+}
+
+/// Reverse index from watched points to OnChange rule IDs
+#[derive(Default)]
+struct ChangeIndex {
+    /// Watched point → rule IDs
+    by_point: HashMap<TriggerPoint, Vec<i64>>,
+    /// Shared-memory slot offset (matches `ChangeEvent::slot_offset`) → rule IDs
+    by_slot: HashMap<usize, Vec<i64>>,
+    /// All OnChange rule IDs (re-evaluated when ring entries were lost)
+    rule_ids: Vec<i64>,
+    /// OnChange rules with watched points not (yet) in shm, polled per tick
+    unresolved: HashSet<i64>,
+    /// Reader `layout_version` (writer epoch, generation) the slots were resolved at
+    layout_version: (u64, u64),
+}
+
+impl ChangeIndex {
+    fn build(rules: &[ScheduledRule], reader: Option<&SharedVecRtdbReader>) -> Self {
+        let mut index = ChangeIndex {
+            // Read before resolving: registrations made meanwhile trigger
+            // another rebuild
+            layout_version: reader.map_or((0, 0), |r| r.layout_version()),
+            ..ChangeIndex::default()
+        };
+
+        for scheduled in rules.iter().filter(|r| r.rule.enabled) {
+            let TriggerConfig::OnChange { points } = &scheduled.trigger else {
+                continue;
+            };
+            let rule_id = scheduled.rule.id;
+            index.rule_ids.push(rule_id);
+
+            for &point in points {
+                index.by_point.entry(point).or_default().push(rule_id);
+
+                if let Some(reader) = reader {
+                    match reader.instance_slot_offset(point.0, point.1, point.2) {
+                        Some(offset) => index.by_slot.entry(offset).or_default().push(rule_id),
+                        None => {
+                            debug!(
+                                "Rule {} watches {}:{}:{} not in shm",
+                                rule_id, point.0, point.1, point.2
+                            );
+                            index.unresolved.insert(rule_id);
+                        },
+                    }
+                }
+            }
+        }
+
+        index
+    }
 }
 
 /// Rule Scheduler - manages periodic rule execution
@@ -67,7 +353,19 @@ pub struct RuleScheduler<R: Rtdb> {
     /// Scheduler tick interval in milliseconds
     tick_ms: u64,
     /// Rule logger manager for independent rule log files
-    logger_manager: RuleLoggerManager,
+    logger_manager: Arc<RuleLoggerManager>,
+    /// Maximum number of rules executed concurrently per cycle
+    workers: usize,
+    /// Record execution path and node details for compiled rules (monitoring UI)
+    exec_details: bool,
+    /// Shared memory reader (change ring source for OnChange rules)
+    shared_reader: Option<Arc<SharedVecRtdbReader>>,
+    /// Watched point → OnChange rule index
+    change_index: Arc<RwLock<ChangeIndex>>,
+    /// OnChange rules whose inputs changed since their last evaluation
+    dirty: Arc<Mutex<HashSet<i64>>>,
+    /// Wakes the scheduler loop when points are marked changed in-process
+    change_notify: Arc<tokio::sync::Notify>,
 }
 
 impl<R: Rtdb + 'static> RuleScheduler<R> {
@@ -94,7 +392,13 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
             shutdown: Arc::new(tokio::sync::Notify::new()),
             running: Arc::new(std::sync::atomic::AtomicBool::new(false)),
             tick_ms,
-            logger_manager: RuleLoggerManager::new(log_root),
+            logger_manager: Arc::new(RuleLoggerManager::new(log_root)),
+            workers: DEFAULT_RULE_WORKERS,
+            exec_details: true,
+            shared_reader: None,
+            change_index: Arc::new(RwLock::new(ChangeIndex::default())),
+            dirty: Arc::new(Mutex::new(HashSet::new())),
+            change_notify: Arc::new(tokio::sync::Notify::new()),
         }
     }
 
@@ -106,6 +410,9 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
     ///
     /// SharedMemory is populated by comsrv and works on any filesystem.
     /// Removed VecRtdb - using SharedMemory + Redis two-tier architecture
+    ///
+    /// `command_sender` additionally pushes routed actions to the comsrv
+    /// command rings (Redis TODO queues remain the fallback).
     pub fn with_shared_reader(
         rtdb: Arc<R>,
         routing_cache: Arc<RoutingCache>,
@@ -113,10 +420,14 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
         tick_ms: u64,
         log_root: PathBuf,
         shared_reader: Option<Arc<SharedVecRtdbReader>>,
+        command_sender: Option<Arc<SharedCommandSender>>,
     ) -> Self {
         let mut executor = RuleExecutor::new(Arc::clone(&rtdb), routing_cache);
-        if let Some(reader) = shared_reader {
-            executor = executor.with_shared_reader(reader);
+        if let Some(reader) = &shared_reader {
+            executor = executor.with_shared_reader(Arc::clone(reader));
+        }
+        if let Some(sender) = command_sender {
+            executor = executor.with_command_sender(sender);
         }
         Self {
             rtdb,
@@ -126,39 +437,101 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
             shutdown: Arc::new(tokio::sync::Notify::new()),
             running: Arc::new(std::sync::atomic::AtomicBool::new(false)),
             tick_ms,
-            logger_manager: RuleLoggerManager::new(log_root),
+            logger_manager: Arc::new(RuleLoggerManager::new(log_root)),
+            workers: DEFAULT_RULE_WORKERS,
+            exec_details: true,
+            shared_reader,
+            change_index: Arc::new(RwLock::new(ChangeIndex::default())),
+            dirty: Arc::new(Mutex::new(HashSet::new())),
+            change_notify: Arc::new(tokio::sync::Notify::new()),
         }
     }
 
+    /// Set the number of rules executed concurrently per cycle (1 = sequential)
+    pub fn with_workers(mut self, workers: usize) -> Self {
+        self.workers = workers.max(1);
+        self
+    }
+
+    /// Record execution path and per-node details for compiled rules
+    ///
+    /// Enabled by default so `rule:{id}:exec` keeps feeding the monitoring UI;
+    /// disabling it leaves only variable values, matched condition and actions.
+    pub fn with_exec_details(mut self, exec_details: bool) -> Self {
+        self.exec_details = exec_details;
+        self
+    }
+
+    /// Set which executions are written to the rule logs and the log queue size
+    ///
+    /// Records beyond `queue_capacity` pending lines are dropped, not waited on.
+    pub fn with_log_policy(mut self, policy: RuleLogPolicy, queue_capacity: usize) -> Self {
+        let log_root = self.logger_manager.log_root().to_path_buf();
+        self.logger_manager = Arc::new(RuleLoggerManager::with_policy(
+            log_root,
+            policy,
+            queue_capacity,
+        ));
+        self
+    }
+
+    /// Whether OnChange rules are fed by the shared-memory change ring
+    fn has_change_feed(&self) -> bool {
+        self.shared_reader
+            .as_ref()
+            .is_some_and(|reader| reader.has_change_ring())
+    }
+
     /// Load rules from database and initialize scheduler state
     pub async fn load_rules(&self) -> Result<usize> {
         let db_rules = repository::load_enabled_rules(&self.pool).await?;
         let count = db_rules.len();
 
+        let mut exec_times: HashMap<i64, ExecTimeHistogram> = self
+            .rules
+            .read()
+            .await
+            .iter()
+            .map(|r| (r.rule.id, r.exec_time.clone()))
+            .collect();
+
         let scheduled: Vec<ScheduledRule> = db_rules
             .into_iter()
-            .map(|rule| {
-                // For now, use default interval trigger
-                // TODO: Read trigger config from database
-                let interval_ms = if rule.cooldown_ms > 0 {
-                    rule.cooldown_ms
-                } else {
-                    1000 // Default 1 second
-                };
-
-                ScheduledRule {
-                    rule,
-                    trigger: TriggerConfig::Interval { interval_ms },
-                    last_execution: None,
-                    last_cooldown_start: None,
-                }
+            .map(|rule| ScheduledRule {
+                trigger: TriggerConfig::for_rule(&rule),
+                exec_time: exec_times.remove(&rule.id).unwrap_or_default(),
+                compiled: self.executor.compile(&rule).map(Arc::new),
+                rule: Arc::new(rule),
+                last_execution: None,
+                last_cooldown_start: None,
             })
             .collect();
 
+        let index = ChangeIndex::build(&scheduled, self.shared_reader.as_deref());
+        let on_change = index.rule_ids.len();
+        if !index.unresolved.is_empty() && self.has_change_feed() {
+            warn!(
+                "{} on-change rules watch points not in shm, polled per tick",
+                index.unresolved.len()
+            );
+        }
+        let interpreted = scheduled.iter().filter(|r| r.compiled.is_none()).count();
+        if interpreted > 0 {
+            warn!("{} rules not compiled, interpreted", interpreted);
+        }
+
         let mut rules = self.rules.write().await;
         *rules = scheduled;
+        *self.change_index.write().await = index;
+        drop(rules);
 
-        info!("Rules: {} loaded", count);
+        if on_change > 0 && !self.has_change_feed() {
+            warn!(
+                "No shm change ring, {} on-change rules polled per tick",
+                on_change
+            );
+        }
+        info!("Rules: {} loaded ({} on-change)", count, on_change);
         Ok(count)
     }
 
@@ -182,13 +555,41 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
 
         let mut tick_interval = interval(Duration::from_millis(self.tick_ms));
 
+        let ring_reader = self
+            .shared_reader
+            .as_ref()
+            .filter(|reader| reader.has_change_ring())
+            .cloned();
+        let mut change_interval = interval(Duration::from_millis(DEFAULT_CHANGE_POLL_MS));
+        change_interval.set_missed_tick_behavior(MissedTickBehavior::Skip);
+        // Only react to changes published after startup; the first tick
+        // evaluates every rule once anyway
+        let mut change_cursor = ring_reader
+            .as_ref()
+            .map_or_else(ChangeCursor::default, |r| r.change_cursor());
+
         loop {
             tokio::select! {
                 _ = tick_interval.tick() => {
-                    if let Err(e) = self.tick().await {
+                    if let Err(e) = self.run_cycle(true).await {
                         error!("Tick err: {}", e);
                     }
                 }
+                _ = change_interval.tick(), if ring_reader.is_some() => {
+                    let Some(reader) = ring_reader.as_deref() else { continue };
+                    let (next, touched) = self.poll_change_ring(reader, change_cursor).await;
+                    change_cursor = next;
+                    if touched {
+                        if let Err(e) = self.run_cycle(false).await {
+                            error!("Change dispatch err: {}", e);
+                        }
+                    }
+                }
+                _ = self.change_notify.notified() => {
+                    if let Err(e) = self.run_cycle(false).await {
+                        error!("Change dispatch err: {}", e);
+                    }
+                }
                 _ = self.shutdown.notified() => {
                     info!("Scheduler shutdown");
                     break;
@@ -211,7 +612,103 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
         self.running.load(std::sync::atomic::Ordering::Relaxed)
     }
 
-    /// Single scheduler tick - check all rules and execute if due
+    /// Mark watched points as changed and wake the scheduler
+    ///
+    /// In-process change source for OnChange rules, complementing the
+    /// shared-memory change ring: modsrv calls it for measurement writes
+    /// that go to Redis only (instance measurement sync/set API).
+    pub async fn notify_points_changed(&self, points: &[TriggerPoint]) {
+        let marked = {
+            let index = self.change_index.read().await;
+            let mut dirty = self.dirty.lock().await;
+            let before = dirty.len();
+            for point in points {
+                if let Some(ids) = index.by_point.get(point) {
+                    dirty.extend(ids.iter().copied());
+                }
+            }
+            dirty.len() > before
+        };
+
+        if marked {
+            self.change_notify.notify_one();
+        }
+    }
+
+    /// Re-resolve watched slots after the writer re-registered its layout
+    ///
+    /// A restarted comsrv stamps a new writer epoch and may place slots at
+    /// other offsets; later registrations bump the layout generation and may
+    /// add watched points. Returns the rules whose points resolved only now.
+    async fn refresh_change_index(&self, reader: &SharedVecRtdbReader) -> Vec<i64> {
+        let version = reader.layout_version();
+        if self.change_index.read().await.layout_version == version {
+            return Vec::new();
+        }
+
+        let rules = self.rules.read().await;
+        let mut index = self.change_index.write().await;
+        let rebuilt = ChangeIndex::build(&rules, Some(reader));
+        let resolved: Vec<i64> = index
+            .unresolved
+            .iter()
+            .filter(|id| !rebuilt.unresolved.contains(id))
+            .copied()
+            .collect();
+        debug!(
+            "Change index rebuilt for shm layout {:?} → {:?}, {} unresolved",
+            index.layout_version,
+            rebuilt.layout_version,
+            rebuilt.unresolved.len()
+        );
+        *index = rebuilt;
+        resolved
+    }
+
+    /// Consume new change ring entries and mark affected rules dirty
+    ///
+    /// Rebuilds the slot index first if the shm layout changed. Returns the
+    /// next ring cursor and whether any rule was marked.
+    async fn poll_change_ring(
+        &self,
+        reader: &SharedVecRtdbReader,
+        since: ChangeCursor,
+    ) -> (ChangeCursor, bool) {
+        let mut touched = self.refresh_change_index(reader).await;
+
+        let index = self.change_index.read().await;
+        if index.by_slot.is_empty() {
+            drop(index);
+            let marked = !touched.is_empty();
+            self.dirty.lock().await.extend(touched);
+            return (reader.change_cursor(), marked);
+        }
+
+        let cursor = reader.drain_changes(since, CHANGE_DRAIN_BATCH, |event| {
+            if let Some(ids) = index.by_slot.get(&event.slot_offset) {
+                touched.extend_from_slice(ids);
+            }
+        });
+
+        if cursor.lost > 0 {
+            // Changes were overwritten before we saw them: re-evaluate everything
+            warn!("Change ring lost {}, full re-eval", cursor.lost);
+            touched.extend_from_slice(&index.rule_ids);
+        }
+        drop(index);
+
+        if touched.is_empty() {
+            return (cursor, false);
+        }
+        self.dirty.lock().await.extend(touched);
+        (cursor, true)
+    }
+
+    /// Single scheduler cycle - check rules and execute if due
+    ///
+    /// `include_interval` is true on the periodic tick (Interval rules plus
+    /// dirty OnChange rules) and false for change dispatch (dirty OnChange
+    /// rules only).
     ///
     /// Snapshot execution pattern for minimal lock hold time
     /// - Phase 1: Read lock to collect rules due for execution (~10μs)
@@ -219,11 +716,21 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
     /// - Phase 3: Write lock to update timestamps (~100μs)
     ///
     /// This reduces write lock hold time from 100ms+ to ~100μs.
-    async fn tick(&self) -> Result<()> {
+    async fn run_cycle(&self, include_interval: bool) -> Result<()> {
         let now = Instant::now();
+        let poll_on_change = include_interval && !self.has_change_feed();
+        // OnChange rules the change ring cannot see yet are polled per tick
+        let unresolved = if include_interval {
+            self.change_index.read().await.unresolved.clone()
+        } else {
+            HashSet::new()
+        };
+        let dirty = std::mem::take(&mut *self.dirty.lock().await);
+        // Dirty rules held back by cooldown stay dirty for the next cycle
+        let mut deferred: Vec<i64> = Vec::new();
 
         // Phase 1: Read lock to collect rules that need execution (fast)
-        let rules_to_execute: Vec<(usize, Rule)> = {
+        let rules_to_execute: Vec<(usize, Arc<Rule>, Option<Arc<CompiledRule>>)> = {
             let rules = self.rules.read().await;
             rules
                 .iter()
@@ -233,15 +740,23 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
                         return None;
                     }
 
+                    let is_dirty = dirty.contains(&scheduled.rule.id);
                     let should_execute = match &scheduled.trigger {
                         TriggerConfig::Interval { interval_ms } => {
-                            match scheduled.last_execution {
-                                None => true, // First execution
-                                Some(last) => {
-                                    let elapsed = now.duration_since(last).as_millis() as u64;
-                                    elapsed >= *interval_ms
-                                },
-                            }
+                            include_interval
+                                && match scheduled.last_execution {
+                                    None => true, // First execution
+                                    Some(last) => {
+                                        let elapsed = now.duration_since(last).as_millis() as u64;
+                                        elapsed >= *interval_ms
+                                    },
+                                }
+                        },
+                        TriggerConfig::OnChange { .. } => {
+                            is_dirty
+                                || poll_on_change
+                                || unresolved.contains(&scheduled.rule.id)
+                                || (include_interval && scheduled.last_execution.is_none())
                         },
                     };
 
@@ -259,70 +774,109 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
                     };
 
                     if should_execute && cooldown_ok {
-                        Some((idx, scheduled.rule.clone()))
+                        Some((idx, Arc::clone(&scheduled.rule), scheduled.compiled.clone()))
                     } else {
+                        if is_dirty {
+                            deferred.push(scheduled.rule.id);
+                        }
                         None
                     }
                 })
                 .collect()
         }; // Read lock released here (~10μs)
 
+        if !deferred.is_empty() {
+            self.dirty.lock().await.extend(deferred);
+        }
+
         if rules_to_execute.is_empty() {
             return Ok(());
         }
 
         // Phase 2: Execute rules without holding any lock (bulk of time)
-        // Track execution outcomes for Phase 3 timestamp updates
-        struct ExecutionOutcome {
-            idx: usize,
-            rule_id: i64,
-            start_cooldown: bool,
-        }
+        // Independent rules run concurrently (bounded by `workers`); each rule
+        // appears at most once per cycle and cycles never overlap, so per-rule
+        // execution order is preserved
         let mut outcomes: Vec<ExecutionOutcome> = Vec::with_capacity(rules_to_execute.len());
 
-        for (idx, rule) in rules_to_execute {
-            debug!("Executing rule: {}", rule.id);
-            let rule_id = rule.id;
-
-            match self.executor.execute(&rule).await {
-                Ok(result) => {
-                    // Log rule execution to independent rule log file
-                    let logger = self.logger_manager.get_logger(rule.id, &rule.name);
-                    logger.log_execution(&result, &result.variable_values);
-
-                    // Write rule execution result to Redis for WebSocket monitoring
-                    self.write_rule_exec_to_redis(rule.id, &result).await;
-
-                    let start_cooldown = result.success && !result.actions_executed.is_empty();
-
-                    if result.success {
-                        debug!(
-                            "Rule {} executed successfully, {} actions",
-                            result.rule_id,
-                            result.actions_executed.len()
-                        );
-                    } else {
-                        warn!("Rule {} fail: {:?}", result.rule_id, result.error);
-                    }
-
-                    outcomes.push(ExecutionOutcome {
+        if self.workers <= 1 || rules_to_execute.len() == 1 {
+            for (idx, rule, compiled) in rules_to_execute {
+                outcomes.push(
+                    execute_one(
+                        &self.executor,
+                        &self.rtdb,
+                        &self.logger_manager,
                         idx,
-                        rule_id,
-                        start_cooldown,
-                    });
-                },
-                Err(e) => {
-                    error!("Rule {} err: {}", rule_id, e);
-                    // Still update last_execution to prevent retry spam
-                    outcomes.push(ExecutionOutcome {
+                        rule,
+                        compiled,
+                        self.exec_details,
+                    )
+                    .await,
+                );
+            }
+        } else {
+            let limiter = Arc::new(Semaphore::new(self.workers));
+            let mut tasks = JoinSet::new();
+            let mut in_flight: HashMap<tokio::task::Id, (usize, i64)> = HashMap::new();
+
+            let details = self.exec_details;
+            for (idx, rule, compiled) in rules_to_execute {
+                let Ok(permit) = Arc::clone(&limiter).acquire_owned().await else {
+                    break;
+                };
+                let rule_id = rule.id;
+                let executor = Arc::clone(&self.executor);
+                let rtdb = Arc::clone(&self.rtdb);
+                let logger_manager = Arc::clone(&self.logger_manager);
+                let handle = tasks.spawn(async move {
+                    let outcome = execute_one(
+                        &executor,
+                        &rtdb,
+                        &logger_manager,
                         idx,
-                        rule_id,
-                        start_cooldown: false,
-                    });
-                },
+                        rule,
+                        compiled,
+                        details,
+                    )
+                    .await;
+                    drop(permit);
+                    outcome
+                });
+                in_flight.insert(handle.id(), (idx, rule_id));
+            }
+
+            while let Some(joined) = tasks.join_next().await {
+                match joined {
+                    Ok(outcome) => outcomes.push(outcome),
+                    Err(e) => {
+                        // Panicked rule: still record it to prevent retry spam
+                        let Some(&(idx, rule_id)) = in_flight.get(&e.id()) else {
+                            error!("Rule task err: {}", e);
+                            continue;
+                        };
+                        error!("Rule {} panic: {}", rule_id, e);
+                        outcomes.push(ExecutionOutcome {
+                            idx,
+                            rule_id,
+                            start_cooldown: false,
+                            elapsed: Duration::ZERO,
+                        });
+                    },
+                }
             }
         }
 
+        let cycle_time = now.elapsed();
+        if include_interval && cycle_time > Duration::from_millis(self.tick_ms) {
+            warn!(
+                "Tick overrun: {} rules in {}ms (tick {}ms, {} workers)",
+                outcomes.len(),
+                cycle_time.as_millis(),
+                self.tick_ms,
+                self.workers
+            );
+        }
+
         // Phase 3: Write lock to update timestamps (fast)
         if !outcomes.is_empty() {
             let mut rules = self.rules.write().await;
@@ -334,6 +888,7 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
                         if outcome.start_cooldown {
                             scheduled.last_cooldown_start = Some(now);
                         }
+                        scheduled.exec_time.record(outcome.elapsed);
                     }
                 }
             }
@@ -351,15 +906,40 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
     pub async fn status(&self) -> SchedulerStatus {
         let rules = self.rules.read().await;
         let enabled_count = rules.iter().filter(|r| r.rule.enabled).count();
+        let on_change_count = rules
+            .iter()
+            .filter(|r| matches!(r.trigger, TriggerConfig::OnChange { .. }))
+            .count();
 
         SchedulerStatus {
             running: self.is_running(),
             total_rules: rules.len(),
             enabled_rules: enabled_count,
+            on_change_rules: on_change_count,
             tick_interval_ms: DEFAULT_TICK_MS,
+            workers: self.workers,
         }
     }
 
+    /// Get per-rule execution-time histograms
+    pub async fn rule_timings(&self) -> Vec<RuleTiming> {
+        self.rules
+            .read()
+            .await
+            .iter()
+            .map(|r| RuleTiming {
+                rule_id: r.rule.id,
+                rule_name: r.rule.name.clone(),
+                histogram: r.exec_time.clone(),
+            })
+            .collect()
+    }
+
+    /// Get rule log pipeline counters (queued, dropped, filtered, written)
+    pub fn rule_log_stats(&self) -> RuleLogStats {
+        self.logger_manager.stats()
+    }
+
     /// Execute a specific rule by ID (manual trigger)
     pub async fn execute_rule(&self, rule_id: i64) -> Result<RuleExecutionResult> {
         // Load the rule from database
@@ -375,72 +955,66 @@ impl<R: Rtdb + 'static> RuleScheduler<R> {
         // TODO: Implement result caching if needed
         None
     }
+}
 
-    /// Write rule execution result to Redis
-    ///
-    /// Stores result in `rule:{rule_id}:exec` Hash with fields:
-    /// - `timestamp` → execution timestamp
-    /// - `success` → "true" or "false"
-    /// - `execution_path` → JSON array of node IDs
-    /// - `variable_values` → JSON object of variable values
-    /// - `node_details` → JSON object of node execution details
-    /// - `error` → error message if any
-    async fn write_rule_exec_to_redis(&self, rule_id: i64, result: &RuleExecutionResult) {
-        let exec_key = format!("rule:{}:exec", rule_id);
-        let ts = SystemTime::now()
-            .duration_since(UNIX_EPOCH)
-            .expect("System time should be after UNIX epoch")
-            .as_secs();
-
-        // Write timestamp
-        let _ = self
-            .rtdb
-            .hash_set(&exec_key, "timestamp", Bytes::from(ts.to_string()))
-            .await;
+/// Write rule execution result to Redis
+///
+/// Stores result in `rule:{rule_id}:exec` Hash with fields:
+/// - `timestamp` → execution timestamp
+/// - `success` → "true" or "false"
+/// - `execution_path` → JSON array of node IDs
+/// - `variable_values` → JSON object of variable values
+/// - `node_details` → JSON object of node execution details
+/// - `error` → error message if any
+async fn write_rule_exec_to_redis<R: Rtdb>(rtdb: &R, rule_id: i64, result: &RuleExecutionResult) {
+    let exec_key = format!("rule:{}:exec", rule_id);
+    let ts = SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .expect("System time should be after UNIX epoch")
+        .as_secs();
 
-        // Write success flag
-        let _ = self
-            .rtdb
-            .hash_set(
-                &exec_key,
-                "success",
-                Bytes::from(result.success.to_string()),
-            )
-            .await;
+    // Write timestamp
+    let _ = rtdb
+        .hash_set(&exec_key, "timestamp", Bytes::from(ts.to_string()))
+        .await;
 
-        // Write execution path as JSON
-        if let Ok(path_json) = serde_json::to_string(&result.execution_path) {
-            let _ = self
-                .rtdb
-                .hash_set(&exec_key, "execution_path", Bytes::from(path_json))
-                .await;
-        }
-
-        // Write variable values as JSON
-        if let Ok(vars_json) = serde_json::to_string(&result.variable_values) {
-            let _ = self
-                .rtdb
-                .hash_set(&exec_key, "variable_values", Bytes::from(vars_json))
-                .await;
-        }
+    // Write success flag
+    let _ = rtdb
+        .hash_set(
+            &exec_key,
+            "success",
+            Bytes::from(result.success.to_string()),
+        )
+        .await;
 
-        // Write node details as JSON
-        if let Ok(details_json) = serde_json::to_string(&result.node_details) {
-            let _ = self
-                .rtdb
-                .hash_set(&exec_key, "node_details", Bytes::from(details_json))
-                .await;
-        }
+    // Write execution path as JSON
+    if let Ok(path_json) = serde_json::to_string(&result.execution_path) {
+        let _ = rtdb
+            .hash_set(&exec_key, "execution_path", Bytes::from(path_json))
+            .await;
+    }
 
-        // Write error if present
-        let error_str = result.error.clone().unwrap_or_default();
-        let _ = self
-            .rtdb
-            .hash_set(&exec_key, "error", Bytes::from(error_str))
+    // Write variable values as JSON
+    if let Ok(vars_json) = serde_json::to_string(&result.variable_values) {
+        let _ = rtdb
+            .hash_set(&exec_key, "variable_values", Bytes::from(vars_json))
             .await;
+    }
 
-        debug!("Written rule execution result to Redis: {}", rule_id);
+    // Write node details as JSON
+    if let Ok(details_json) = serde_json::to_string(&result.node_details) {
+        let _ = rtdb
+            .hash_set(&exec_key, "node_details", Bytes::from(details_json))
+            .await;
     }
+
+    // Write error if present
+    let error_str = result.error.clone().unwrap_or_default();
+    let _ = rtdb
+        .hash_set(&exec_key, "error", Bytes::from(error_str))
+        .await;
+
+    debug!("Written rule execution result to Redis: {}", rule_id);
 }
 
 /// Scheduler status information
@@ -449,17 +1023,249 @@ pub struct SchedulerStatus {
     pub running: bool,
     pub total_rules: usize,
     pub enabled_rules: usize,
+    pub on_change_rules: usize,
     pub tick_interval_ms: u64,
+    pub workers: usize,
 }
 
 #[cfg(test)]
 mod tests {
     use super::*;
 
+    use crate::types::{CalculationRule, RuleFlow, RuleVariable, RuleWires};
+    use voltage_rtdb::{MemoryRtdb, SharedConfig, SharedVecRtdbWriter};
+
+    fn var(name: &str, instance: u32, point_type: &str, point: u32) -> RuleVariable {
+        RuleVariable {
+            name: name.to_string(),
+            instance: Some(instance),
+            point_type: Some(point_type.to_string()),
+            point: Some(point),
+            formula: vec![],
+        }
+    }
+
+    fn rule_with(nodes: Vec<(&str, RuleNode)>, trigger: Option<RuleTrigger>) -> Rule {
+        Rule {
+            id: 1,
+            name: "r".to_string(),
+            description: None,
+            enabled: true,
+            priority: 0,
+            cooldown_ms: 0,
+            flow: RuleFlow {
+                start_node: "start".to_string(),
+                nodes: nodes
+                    .into_iter()
+                    .map(|(id, node)| (id.to_string(), node))
+                    .collect(),
+                trigger,
+            },
+        }
+    }
+
+    fn schedule(rule: Rule) -> ScheduledRule {
+        ScheduledRule {
+            trigger: TriggerConfig::for_rule(&rule),
+            rule: Arc::new(rule),
+            compiled: None,
+            last_execution: None,
+            last_cooldown_start: None,
+            exec_time: ExecTimeHistogram::default(),
+        }
+    }
+
+    fn on_change_rule(id: i64, instance: u32, point: u32) -> Rule {
+        let trigger = RuleTrigger::OnChange {
+            points: vec![RuleTriggerPoint {
+                instance,
+                point_type: Some("measurement".to_string()),
+                point,
+            }],
+        };
+        let mut rule = rule_with(vec![], Some(trigger));
+        rule.id = id;
+        rule
+    }
+
     #[test]
     fn test_trigger_config_default() {
         let config = TriggerConfig::default();
-        let TriggerConfig::Interval { interval_ms } = config;
-        assert_eq!(interval_ms, 1000);
+        assert!(matches!(
+            config,
+            TriggerConfig::Interval { interval_ms: 1000 }
+        ));
+    }
+
+    #[test]
+    fn test_rule_input_points() {
+        let nodes = vec![
+            (
+                "switch",
+                RuleNode::Switch {
+                    variables: vec![var("X1", 1, "measurement", 3), var("X2", 2, "action", 4)],
+                    rule: vec![],
+                    wires: HashMap::new(),
+                },
+            ),
+            (
+                "calc",
+                RuleNode::Calculation {
+                    variables: vec![
+                        var("a", 1, "measurement", 3),
+                        var("out", 5, "measurement", 9),
+                    ],
+                    rule: vec![CalculationRule {
+                        output: "out".to_string(),
+                        formula: "a * 2".to_string(),
+                    }],
+                    wires: RuleWires::default(),
+                },
+            ),
+            (
+                "change",
+                RuleNode::ChangeValue {
+                    variables: vec![var("Y1", 7, "action", 1)],
+                    rule: vec![],
+                    wires: RuleWires::default(),
+                },
+            ),
+        ];
+
+        // Inputs only, deduplicated: calc output and change targets are excluded
+        let rule = rule_with(nodes, None);
+        assert_eq!(rule_input_points(&rule), vec![(1, 0, 3), (2, 1, 4)]);
+        assert!(matches!(
+            TriggerConfig::for_rule(&rule),
+            TriggerConfig::Interval { interval_ms: 1000 }
+        ));
+
+        // OnChange without explicit points watches the inputs
+        let mut rule = rule;
+        rule.flow.trigger = Some(RuleTrigger::OnChange { points: vec![] });
+        let TriggerConfig::OnChange { points } = TriggerConfig::for_rule(&rule) else {
+            panic!("Expected on-change trigger");
+        };
+        assert_eq!(points, vec![(1, 0, 3), (2, 1, 4)]);
+    }
+
+    #[test]
+    fn test_change_index_build() {
+        let explicit = RuleTrigger::OnChange {
+            points: vec![RuleTriggerPoint {
+                instance: 1,
+                point_type: Some("action".to_string()),
+                point: 2,
+            }],
+        };
+        let mut on_change = rule_with(vec![], Some(explicit));
+        on_change.id = 10;
+        let interval = rule_with(vec![], None);
+
+        let scheduled: Vec<ScheduledRule> =
+            [on_change, interval].into_iter().map(schedule).collect();
+
+        let index = ChangeIndex::build(&scheduled, None);
+        assert_eq!(index.rule_ids, vec![10]);
+        assert_eq!(index.by_point.get(&(1, 1, 2)), Some(&vec![10]));
+        assert!(index.by_slot.is_empty());
+    }
+
+    async fn take_dirty<R: Rtdb + 'static>(scheduler: &RuleScheduler<R>) -> HashSet<i64> {
+        std::mem::take(&mut *scheduler.dirty.lock().await)
+    }
+
+    #[tokio::test]
+    async fn test_on_change_rule_fires_after_writer_restart() {
+        let config = SharedConfig {
+            path: std::env::temp_dir().join("voltage-rules-test-writer-restart.shm"),
+            max_instances: 8,
+            max_points_per_instance: 32,
+            max_channels: 8,
+            max_points_per_channel: 32,
+            change_ring_capacity: 16,
+            command_ring_capacity: 4,
+            history_capacity: 0,
+        };
+        std::fs::remove_file(&config.path).ok();
+
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(1, &[3], &[]).unwrap();
+        let reader = Arc::new(SharedVecRtdbReader::open(&config).unwrap());
+        let old_offset = reader.instance_slot_offset(1, 0, 3).unwrap();
+
+        let scheduler = RuleScheduler::with_shared_reader(
+            Arc::new(MemoryRtdb::new()),
+            Arc::new(RoutingCache::new()),
+            SqlitePool::connect_lazy("sqlite::memory:").unwrap(),
+            100,
+            std::env::temp_dir().join("voltage-rules-test-logs"),
+            Some(Arc::clone(&reader)),
+            None,
+        );
+        // Rule 11 watches a point comsrv has not registered yet
+        let scheduled = vec![
+            schedule(on_change_rule(10, 1, 3)),
+            schedule(on_change_rule(11, 1, 5)),
+        ];
+        *scheduler.change_index.write().await = ChangeIndex::build(&scheduled, Some(&reader));
+        *scheduler.rules.write().await = scheduled;
+        assert_eq!(
+            scheduler.change_index.read().await.unresolved,
+            HashSet::from([11])
+        );
+
+        let cursor = reader.change_cursor();
+        writer.set_measurement(1, 3, 1.0, 1000);
+        let (cursor, touched) = scheduler.poll_change_ring(&reader, cursor).await;
+        assert!(touched);
+        assert_eq!(take_dirty(&scheduler).await, HashSet::from([10]));
+
+        // Restarted comsrv registers another instance first: the watched
+        // slot moves, and the previously missing point now exists
+        drop(writer);
+        let mut writer = SharedVecRtdbWriter::open(&config).unwrap();
+        writer.register_instance(2, &[3], &[]).unwrap();
+        writer.register_instance(1, &[3, 5], &[]).unwrap();
+        assert_eq!(reader.instance_slot_offset(2, 0, 3), Some(old_offset));
+        assert_ne!(reader.instance_slot_offset(1, 0, 3), Some(old_offset));
+
+        // The restart itself forces a full re-evaluation
+        let (cursor, touched) = scheduler.poll_change_ring(&reader, cursor).await;
+        assert!(touched);
+        assert_eq!(take_dirty(&scheduler).await, HashSet::from([10, 11]));
+        assert!(scheduler.change_index.read().await.unresolved.is_empty());
+
+        // Writes to the old offset no longer fire rule 10; the new ones do
+        writer.set_measurement(2, 3, 2.0, 2000);
+        let (cursor, touched) = scheduler.poll_change_ring(&reader, cursor).await;
+        assert!(!touched);
+
+        writer.set_measurement(1, 3, 3.0, 2000);
+        writer.set_measurement(1, 5, 4.0, 2000);
+        let (_, touched) = scheduler.poll_change_ring(&reader, cursor).await;
+        assert!(touched);
+        assert_eq!(take_dirty(&scheduler).await, HashSet::from([10, 11]));
+
+        drop(writer);
+        std::fs::remove_file(&config.path).ok();
+    }
+
+    #[test]
+    fn test_exec_time_histogram() {
+        let mut hist = ExecTimeHistogram::default();
+        assert_eq!(hist.mean_us(), 0);
+
+        hist.record(Duration::from_micros(50));
+        hist.record(Duration::from_micros(100));
+        hist.record(Duration::from_millis(2));
+        hist.record(Duration::from_secs(1));
+
+        assert_eq!(hist.count, 4);
+        assert_eq!(hist.buckets[0], 2); // <= 100μs (bound inclusive)
+        assert_eq!(hist.buckets[3], 1); // <= 5ms
+        assert_eq!(hist.buckets[EXEC_TIME_BUCKETS_US.len()], 1); // overflow
+        assert_eq!(hist.max_us, 1_000_000);
+        assert_eq!(hist.mean_us(), (50 + 100 + 2_000 + 1_000_000) / 4);
     }
 }
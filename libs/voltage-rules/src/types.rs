@@ -59,6 +59,50 @@ pub struct RuleFlow {
 
     /// Nodes indexed by ID for O(1) lookup
     pub nodes: HashMap<String, RuleNode>,
+
+    /// Trigger mode declared on the start node (None = interval scheduling)
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub trigger: Option<RuleTrigger>,
+}
+
+/// Rule trigger declaration (start node `trigger` field)
+///
+/// ```json
+/// {"type": "on_change", "points": [{"instance": 1, "pointType": "measurement", "point": 3}]}
+/// ```
+///
+/// An `on_change` trigger without points watches every instance point the
+/// rule's variables read.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+#[serde(tag = "type", rename_all = "snake_case")]
+pub enum RuleTrigger {
+    /// Execute at a fixed interval
+    Interval {
+        /// Interval in milliseconds
+        interval_ms: u64,
+    },
+
+    /// Execute when any watched point changes
+    OnChange {
+        /// Watched points (empty = derive from rule variables)
+        #[serde(default)]
+        points: Vec<RuleTriggerPoint>,
+    },
+}
+
+/// Point watched by an `on_change` trigger (same field names as RuleVariable)
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct RuleTriggerPoint {
+    /// Instance ID
+    #[serde(alias = "instance_id")]
+    pub instance: u32,
+
+    /// Point type: "measurement" (default) or "action"
+    #[serde(rename = "pointType", default, skip_serializing_if = "Option::is_none")]
+    pub point_type: Option<String>,
+
+    /// Point ID
+    pub point: u32,
 }
 
 /// Rule node - execution-only node structure
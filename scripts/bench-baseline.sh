@@ -0,0 +1,61 @@
+#!/bin/bash
+# VoltageEMS Benchmark Baseline Script
+#
+# Usage:
+#   scripts/bench-baseline.sh save       # run benches, record results as the committed baseline
+#   scripts/bench-baseline.sh compare    # run benches against the committed baseline
+#
+# The baseline lives in benches/baseline/ (criterion "main" baseline files only).
+# Record it on the reference hardware; numbers from other machines are not comparable.
+
+set -e
+
+# Color definitions
+GREEN='\033[0;32m'
+YELLOW='\033[0;33m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+CRATES=(voltage-rtdb voltage-routing voltage-rules voltage-calc)
+BASELINE_NAME="main"
+BASELINE_DIR="benches/baseline"
+CRITERION_DIR="target/criterion"
+
+cd "$(dirname "$0")/.."
+
+PACKAGES=()
+for crate in "${CRATES[@]}"; do
+    PACKAGES+=(-p "$crate")
+done
+
+case "$1" in
+    save)
+        echo -e "${YELLOW}Running benchmarks and saving baseline '${BASELINE_NAME}'...${NC}"
+        cargo bench "${PACKAGES[@]}" -- --save-baseline "$BASELINE_NAME"
+
+        # Replace the recorded benchmark directories; keep README.md and other files
+        mkdir -p "$BASELINE_DIR"
+        find "$BASELINE_DIR" -mindepth 1 -maxdepth 1 -type d -exec rm -rf {} +
+        # Keep only the named baseline of each benchmark (drop reports and "new" runs)
+        (cd "$CRITERION_DIR" && find . -type d -name "$BASELINE_NAME" -print0) |
+            while IFS= read -r -d '' dir; do
+                mkdir -p "$BASELINE_DIR/$dir"
+                cp "$CRITERION_DIR/$dir"/*.json "$BASELINE_DIR/$dir/"
+            done
+        echo -e "${GREEN}Baseline written to ${BASELINE_DIR} - commit it with the change${NC}"
+        ;;
+    compare)
+        if [ ! -d "$BASELINE_DIR" ]; then
+            echo -e "${RED}ERROR: no baseline in ${BASELINE_DIR} (run '$0 save' first)${NC}"
+            exit 1
+        fi
+        mkdir -p "$CRITERION_DIR"
+        cp -r "$BASELINE_DIR"/. "$CRITERION_DIR"/
+        echo -e "${YELLOW}Comparing against baseline '${BASELINE_NAME}'...${NC}"
+        cargo bench "${PACKAGES[@]}" -- --baseline "$BASELINE_NAME"
+        ;;
+    *)
+        echo "Usage: $0 {save|compare}"
+        exit 1
+        ;;
+esac
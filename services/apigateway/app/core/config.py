@@ -25,6 +25,8 @@ class Settings(BaseSettings):
     REDIS_DB: int = 0
     REDIS_PASSWORD: Optional[str] = None
     REDIS_PREFIX: str = "apigateway:"
+    # comsrv/modsrv的Redis分片列表；本服务只连接单个Redis，设置后拒绝启动
+    REDIS_SHARD_URLS: str = ""
     
     # 开发环境Redis设置（通过.env文件覆盖）
     # REDIS_HOST: str = "192.168.30.62"  # 开发环境
@@ -38,6 +40,13 @@ class Settings(BaseSettings):
     WEBSOCKET_HEARTBEAT_INTERVAL: int = 30
     WEBSOCKET_MAX_CONNECTIONS: int = 1000
     
+    # 实时扇出设置（需comsrv通道开启 history_stream）
+    WS_FANOUT_ENABLED: bool = False  # 启用后实时数据由变化流推送，替代定时轮询
+    WS_FANOUT_STREAMS: List[str] = ["inst:history", "comsrv:history"]
+    WS_FANOUT_FRAME_MS: int = 100  # 每个客户端的帧合并间隔
+    WS_FANOUT_SEND_TIMEOUT_MS: int = 5000  # 单帧发送超时，超时断开
+    WS_FANOUT_EXPORT_TTL_S: int = 60  # 键在此时间内出现在变化流中才视为已导出，否则回退轮询
+    
     # 数据调度设置
     DATA_FETCH_INTERVAL: int = 5  # 秒
     DATA_BATCH_SIZE: int = 100
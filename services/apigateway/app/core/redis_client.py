@@ -21,6 +21,9 @@ class RedisClient:
         
     async def connect(self):
         """连接到Redis"""
+        if settings.REDIS_SHARD_URLS.strip():
+            # 通道/实例键按ID分布在多个分片上，单连接只能读到分片0
+            raise RuntimeError("API网关不支持Redis分片（REDIS_SHARD_URLS），请在单Redis部署下运行")
         try:
             self.connection_pool = redis.ConnectionPool(
                 host=settings.REDIS_HOST,
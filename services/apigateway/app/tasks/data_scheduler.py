@@ -85,6 +85,11 @@ class DataScheduler:
                 if client_id not in self.websocket_manager.connection_manager.active_connections:
                     continue
 
+                # 由变化流扇出推送的订阅无需轮询
+                fanout = self.websocket_manager.fanout
+                if fanout and fanout.is_handled(subscription):
+                    continue
+
                 # 获取数据源类型
                 source = subscription.get("source", "inst")
 
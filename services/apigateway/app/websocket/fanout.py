@@ -0,0 +1,267 @@
+"""
+实时数据扇出服务
+读取comsrv写入的历史变化流（comsrv:history / inst:history），按订阅索引分发到WebSocket客户端
+
+- 每个网关只有一个流读取任务，Redis读取量与客户端数量无关
+- 订阅索引: Redis键(source:channel_id:data_type) → {client_id: 点位过滤集合或None}
+- 每个客户端的更新按帧（默认100ms）合并，同一点位只保留最新值，仅发送变化点位
+- 慢客户端: 上一帧尚未发送完成时不发新帧，期间的更新继续合并，过期的中间值被丢弃
+- 只有开启 history_stream 的通道会写入变化流: 订阅的键最近出现在流中才由扇出推送，
+  其余订阅（未导出的通道、规则监控）仍由数据调度器轮询
+
+流条目格式（comsrv WriteBuffer每次flush写入）:
+    key=<值Hash键，如 inst:1:M>  ts=<毫秒时间戳>  <point_id>=<值> ...
+"""
+
+import asyncio
+import json
+import logging
+import time
+from typing import Any, Dict, List, Optional, Set
+
+from app.core.config import settings
+from app.models.response import SafeJSONEncoder
+
+logger = logging.getLogger(__name__)
+
+# 流条目中的系统字段
+KEY_FIELD = "key"
+TS_FIELD = "ts"
+
+
+def _parse_value(value: str) -> Any:
+    """与EdgeDataClient.get_data保持一致的数值转换"""
+    try:
+        if '.' in value:
+            return round(float(value), 4)
+        return int(value)
+    except ValueError:
+        return value
+
+
+class ClientState:
+    """单个客户端的合并状态"""
+
+    def __init__(self):
+        # Redis键 → {point_id: value}
+        self.pending: Dict[str, Dict[str, Any]] = {}
+        self.send_task: Optional[asyncio.Task] = None
+        self.frames_sent = 0
+        self.frames_skipped = 0
+
+    @property
+    def sending(self) -> bool:
+        return self.send_task is not None and not self.send_task.done()
+
+
+class FanoutService:
+    """基于变化流的WebSocket扇出服务"""
+
+    def __init__(self, redis_client, websocket_manager):
+        self.redis = redis_client.redis_client
+        self.websocket_manager = websocket_manager
+        self.streams: List[str] = settings.WS_FANOUT_STREAMS
+        self.frame_interval = settings.WS_FANOUT_FRAME_MS / 1000.0
+        self.send_timeout = settings.WS_FANOUT_SEND_TIMEOUT_MS / 1000.0
+        self.export_ttl = settings.WS_FANOUT_EXPORT_TTL_S
+
+        # Redis键 → {client_id: 点位过滤集合（None表示全部点位）}
+        self.index: Dict[str, Dict[str, Optional[Set[str]]]] = {}
+        # client_id → 订阅的Redis键，用于更新/移除订阅
+        self.client_keys: Dict[str, Set[str]] = {}
+        self.clients: Dict[str, ClientState] = {}
+        # 流中出现过的Redis键 → 最近一次出现的时间（monotonic秒）
+        self.exported: Dict[str, float] = {}
+
+        self.running = False
+        self.tasks: List[asyncio.Task] = []
+        self.stats = {
+            "entries_read": 0,
+            "updates_merged": 0,
+            "frames_sent": 0,
+            "frames_skipped": 0,
+            "send_failures": 0,
+        }
+
+    async def start(self):
+        """启动流读取与帧发送任务"""
+        self.running = True
+        self.tasks = [
+            asyncio.create_task(self._read_loop()),
+            asyncio.create_task(self._frame_loop()),
+        ]
+        logger.info(f"实时扇出服务已启动: streams={self.streams}, 帧间隔={self.frame_interval * 1000:.0f}ms")
+
+    async def stop(self):
+        """停止扇出服务"""
+        self.running = False
+        for task in self.tasks:
+            task.cancel()
+        for task in self.tasks:
+            try:
+                await task
+            except asyncio.CancelledError:
+                pass
+        self.tasks = []
+        logger.info("实时扇出服务已停止")
+
+    # ========== 订阅索引 ==========
+
+    def update_subscription(self, client_id: str, subscription: Dict[str, Any]):
+        """根据客户端订阅信息重建其索引项"""
+        self.remove_client(client_id)
+
+        source = subscription.get("source", "inst")
+        channels = subscription.get("channels", [])
+        data_types = subscription.get("data_types", [])
+        points = subscription.get("points")
+        point_filter = {str(p) for p in points} if points else None
+
+        keys = {f"{source}:{channel_id}:{data_type}" for channel_id in channels for data_type in data_types}
+        for key in keys:
+            self.index.setdefault(key, {})[client_id] = point_filter
+        if keys:
+            self.client_keys[client_id] = keys
+            self.clients[client_id] = ClientState()
+
+    def remove_client(self, client_id: str):
+        """移除客户端的全部订阅"""
+        for key in self.client_keys.pop(client_id, set()):
+            subscribers = self.index.get(key)
+            if subscribers is not None:
+                subscribers.pop(client_id, None)
+                if not subscribers:
+                    del self.index[key]
+        state = self.clients.pop(client_id, None)
+        if state and state.sending and state.send_task is not asyncio.current_task():
+            state.send_task.cancel()
+
+    def is_handled(self, subscription: Dict[str, Any]) -> bool:
+        """订阅的全部键最近都出现在变化流中时由扇出推送，否则由数据调度器轮询"""
+        source = subscription.get("source", "inst")
+        if source == "rule":
+            return False
+        channels = subscription.get("channels", [])
+        data_types = subscription.get("data_types", [])
+        if not channels or not data_types:
+            return False
+        deadline = time.monotonic() - self.export_ttl
+        return all(
+            self.exported.get(f"{source}:{channel_id}:{data_type}", 0.0) >= deadline
+            for channel_id in channels
+            for data_type in data_types
+        )
+
+    # ========== 流读取 ==========
+
+    async def _read_loop(self):
+        """读取变化流并合并到订阅客户端的待发送帧"""
+        # 从当前位置开始读取，历史数据由订阅时的初始推送提供
+        last_ids = {stream: '$' for stream in self.streams}
+        while self.running:
+            try:
+                response = await self.redis.xread(last_ids, count=1000, block=1000)
+                for stream, entries in response or []:
+                    for entry_id, fields in entries:
+                        last_ids[stream] = entry_id
+                        self._dispatch(fields)
+                    self.stats["entries_read"] += len(entries)
+            except asyncio.CancelledError:
+                break
+            except Exception as e:
+                logger.error(f"读取变化流失败: {e}")
+                await asyncio.sleep(5)
+
+    def _dispatch(self, fields: Dict[str, str]):
+        """将一个流条目合并到订阅者的待发送帧"""
+        key = fields.get(KEY_FIELD)
+        if not key:
+            return
+        self.exported[key] = time.monotonic()
+        subscribers = self.index.get(key)
+        if not subscribers:
+            return
+
+        points = [(pid, value) for pid, value in fields.items() if pid not in (KEY_FIELD, TS_FIELD)]
+        for client_id, point_filter in subscribers.items():
+            state = self.clients.get(client_id)
+            if state is None:
+                continue
+            for point_id, value in points:
+                if point_filter is None or point_id in point_filter:
+                    state.pending.setdefault(key, {})[point_id] = _parse_value(value)
+                    self.stats["updates_merged"] += 1
+
+    # ========== 帧发送 ==========
+
+    async def _frame_loop(self):
+        """每帧为有变化的客户端发送一次合并后的增量"""
+        while self.running:
+            try:
+                await asyncio.sleep(self.frame_interval)
+                for client_id, state in list(self.clients.items()):
+                    if not state.pending:
+                        continue
+                    if state.sending:
+                        # 慢客户端: 跳过本帧，更新继续合并到下一帧
+                        state.frames_skipped += 1
+                        self.stats["frames_skipped"] += 1
+                        continue
+                    frame = self._build_frame(state.pending)
+                    state.pending = {}
+                    state.send_task = asyncio.create_task(self._send(client_id, state, frame))
+            except asyncio.CancelledError:
+                break
+            except Exception as e:
+                logger.error(f"扇出帧发送循环出错: {e}")
+
+    def _build_frame(self, pending: Dict[str, Dict[str, Any]]) -> str:
+        """构建紧凑的增量帧（与data_batch格式兼容，仅包含变化点位）"""
+        updates = []
+        for key, values in pending.items():
+            source, channel_id, data_type = key.rsplit(':', 2)
+            updates.append({
+                "source": source,
+                "channel_id": int(channel_id) if channel_id.isdigit() else channel_id,
+                "data_type": data_type,
+                "values": values
+            })
+        message = {
+            "type": "data_batch",
+            "timestamp": int(time.time()),
+            "data": {
+                "delta": True,
+                "updates": updates
+            }
+        }
+        return json.dumps(message, ensure_ascii=False, separators=(',', ':'), cls=SafeJSONEncoder)
+
+    async def _send(self, client_id: str, state: ClientState, frame: str):
+        """发送一帧；超时或失败的客户端被断开"""
+        websocket = self.websocket_manager.connection_manager.active_connections.get(client_id)
+        if websocket is None:
+            self.remove_client(client_id)
+            return
+        try:
+            await asyncio.wait_for(websocket.send_text(frame), timeout=self.send_timeout)
+            state.frames_sent += 1
+            self.stats["frames_sent"] += 1
+        except asyncio.CancelledError:
+            raise
+        except Exception as e:
+            self.stats["send_failures"] += 1
+            logger.warning(f"扇出帧发送到 {client_id} 失败，断开连接: {e}")
+            self.remove_client(client_id)
+            self.websocket_manager.connection_manager.disconnect(client_id)
+
+    def get_status(self) -> Dict[str, Any]:
+        """获取扇出服务状态"""
+        return {
+            "running": self.running,
+            "streams": self.streams,
+            "frame_interval_ms": int(self.frame_interval * 1000),
+            "indexed_keys": len(self.index),
+            "exported_keys": len(self.exported),
+            "clients": len(self.clients),
+            "stats": self.stats.copy(),
+        }
@@ -73,7 +73,7 @@ async def websocket_endpoint(
         logger.error(f"WebSocket连接处理失败: {e}")
     finally:
         # 清理连接
-        manager.disconnect_client(client_id)
+        await manager.disconnect_client(client_id)
         logger.info(f"WebSocket连接清理完成: {client_id}")
 
 async def websocket_status():
@@ -11,8 +11,10 @@ from fastapi import WebSocket, WebSocketDisconnect
 from datetime import datetime
 import time
 
+from app.core.config import settings
 from app.core.redis_client import RedisClient
 from app.core.edge_data_client import EdgeDataClient
+from app.websocket.fanout import FanoutService
 from app.models.edge_data import (
     WebSocketMessageType, create_data_update_message, 
     create_alarm_message, create_subscribe_ack_message, create_unsubscribe_ack_message,
@@ -116,6 +118,10 @@ class WebSocketManager:
         self.connection_manager = ConnectionManager()
         self.running = False
         self.heartbeat_task = None
+        # 基于变化流的实时扇出（未启用时由数据调度器定时轮询推送）
+        self.fanout: Optional[FanoutService] = (
+            FanoutService(redis_client, self) if settings.WS_FANOUT_ENABLED else None
+        )
     
     async def start(self):
         """启动WebSocket管理器"""
@@ -133,6 +139,8 @@ class WebSocketManager:
                 await self.heartbeat_task
             except asyncio.CancelledError:
                 pass
+        if self.fanout:
+            await self.fanout.stop()
         logger.info("WebSocket管理器已停止")
     
     async def connect_client(self, websocket: WebSocket, client_id: str, data_type: str = "general"):
@@ -156,6 +164,8 @@ class WebSocketManager:
     
     async def disconnect_client(self, client_id: str):
         """断开客户端"""
+        if self.fanout:
+            self.fanout.remove_client(client_id)
         self.connection_manager.disconnect(client_id)
     
     async def send_message(self, client_id: str, message: Any):
@@ -269,6 +279,7 @@ class WebSocketManager:
             channels = data.get("data", {}).get("channels", [])
             data_types = data.get("data", {}).get("data_types", ["T"])
             interval = data.get("data", {}).get("interval", 1000)
+            points = data.get("data", {}).get("points")  # 可选: 仅订阅指定点位
 
             # 前端完全控制订阅的source/channels/data_types，不做额外验证
             # 数据源可以是任意字符串（如 inst/comsrv/aaasrv 等）
@@ -278,8 +289,11 @@ class WebSocketManager:
                 "source": source,
                 "channels": channels,
                 "data_types": data_types,
-                "interval": interval
+                "interval": interval,
+                "points": points
             }
+            if self.fanout:
+                self.fanout.update_subscription(client_id, self.connection_manager.subscriptions[client_id])
 
             # 发送订阅确认
             ack_message = create_subscribe_ack_message(
@@ -330,6 +344,8 @@ class WebSocketManager:
                 "rule_id": rule_id,    # 保留 rule_id 便于内部使用
                 "interval": interval
             }
+            if self.fanout:
+                self.fanout.remove_client(client_id)
 
             # 发送订阅确认（统一格式）
             ack_message = {
@@ -504,6 +520,8 @@ class WebSocketManager:
                 self.connection_manager.subscriptions[client_id]["channels"] = [
                     ch for ch in current_channels if ch not in channels
                 ]
+                if self.fanout:
+                    self.fanout.update_subscription(client_id, self.connection_manager.subscriptions[client_id])
             
             # 发送取消订阅确认
             ack_message = create_unsubscribe_ack_message(
@@ -619,12 +637,12 @@ class WebSocketManager:
         # 断开超时的连接
         for client_id in disconnected_clients:
             logger.info(f"断开超时连接: {client_id}")
-            self.disconnect_client(client_id)
+            await self.disconnect_client(client_id)
     
     async def close_all(self):
         """关闭所有连接"""
         for client_id in list(self.connection_manager.active_connections.keys()):
-            self.disconnect_client(client_id)
+            await self.disconnect_client(client_id)
         await self.stop()
     
     def get_status(self) -> Dict[str, Any]:
@@ -633,7 +651,8 @@ class WebSocketManager:
             "running": self.running,
             "connection_count": self.connection_manager.get_connection_count(),
             "connections_info": self.connection_manager.get_connections_info(),
-            "subscriptions": self.connection_manager.get_subscriptions()
+            "subscriptions": self.connection_manager.get_subscriptions(),
+            "fanout": self.fanout.get_status() if self.fanout else None
         }
     
     async def push_alarm(self, alarm_data: Dict[str, Any]):
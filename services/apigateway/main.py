@@ -152,6 +152,11 @@ async def startup_event():
         # 将数据调度器引用传递给WebSocket管理器
         websocket_manager.data_scheduler = data_scheduler
         
+        # 启动实时扇出服务（可选）
+        if websocket_manager.fanout:
+            await websocket_manager.fanout.start()
+            logger.info("实时扇出服务启动成功")
+        
         # 设置WebSocket管理器到广播路由
         set_websocket_manager(websocket_manager)
         
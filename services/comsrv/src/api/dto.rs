@@ -432,6 +432,17 @@ pub struct ChannelCreateRequest {
     /// - timeout_ms (number, optional, default: 1000): Timeout in milliseconds
     /// - retry_count (number, optional, default: 3): Number of retries
     /// - poll_interval_ms (number, optional): Polling interval in milliseconds
+    /// - command_priority (boolean, optional, default: false): Queued commands are written before the next poll starts
+    /// - poll_missed_tick (string, optional, default: "skip"): "skip", "delay" or "burst" after an overrun
+    /// - poll_adaptive (boolean, optional, default: false): Back off polling while no data is returned
+    /// - poll_max_interval_ms (number, optional, default: 8 × poll_interval_ms): Adaptive backoff ceiling
+    /// - read_plan_max_gap (number, optional, default: 10): Max unused registers merged into one read of the reported read plan (diagnostics only, does not change polling)
+    /// - read_plan_max_registers (number, optional, default: 125): Max registers per read request of the reported read plan (diagnostics only, does not change polling)
+    /// - change_only (boolean, optional, default: false): Write points only when their value changes
+    /// - heartbeat_secs (number, optional, default: 60): Rewrite unchanged points at least this often (0 = never)
+    /// - history_depth (number or object, optional): Shared-memory history samples per T/S point, or per type (`{"T": 64}`)
+    /// - history_stream (boolean, optional, default: false): Export flushed changes to the `comsrv:history` / `inst:history` streams for hissrv
+    /// - history_stream_max_len (number, optional, default: 100000): Approximate length cap of the history streams
     ///
     /// **CAN**:
     /// - interface (string, required): CAN interface name (e.g., "can0")
@@ -226,12 +226,14 @@ pub async fn write_channel_point<R: Rtdb + 'static>(
                                 point_id,
                                 value: *value,
                                 timestamp: timestamp_ms / 1000,
+                                received_at: std::time::Instant::now(),
                             },
                             PointType::Adjustment => ChannelCommand::Adjustment {
                                 command_id: format!("direct_{}_{}", channel_id, timestamp_ms),
                                 point_id,
                                 value: *value,
                                 timestamp: timestamp_ms / 1000,
+                                received_at: std::time::Instant::now(),
                             },
                             _ => unreachable!(),
                         };
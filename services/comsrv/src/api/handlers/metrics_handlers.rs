@@ -0,0 +1,152 @@
+//! Prometheus Metrics Handler
+//!
+//! Exposes per-channel hot-path latency histograms (poll cycle, batch write,
+//! WriteBuffer flush, command intake → write) and counters in the Prometheus
+//! text format for scraping.
+
+use axum::{
+    extract::State,
+    http::header,
+    response::{IntoResponse, Response},
+};
+use voltage_rtdb::{MetricKind, PrometheusText, Rtdb, PROMETHEUS_CONTENT_TYPE};
+
+use crate::api::routes::AppState;
+use crate::core::channels::ChannelMetrics;
+
+/// Prometheus metrics endpoint
+///
+/// @route GET /metrics
+/// @input State(state): AppState - Application state with channel manager
+/// @output `text/plain; version=0.0.4` - Prometheus text exposition
+/// @status 200 - Metrics rendered
+#[utoipa::path(
+    get,
+    path = "/metrics",
+    responses(
+        (status = 200, description = "Prometheus text exposition (text/plain; version=0.0.4)", body = String)
+    ),
+    tag = "comsrv"
+)]
+pub async fn metrics_handler<R: Rtdb>(State(state): State<AppState<R>>) -> Response {
+    let manager = &state.channel_manager;
+    let mut channels = Vec::new();
+    for channel_id in manager.get_channel_ids() {
+        if let Some(channel_impl) = manager.get_channel(channel_id) {
+            channels.push((channel_id.to_string(), channel_impl.read().await.metrics()));
+        }
+    }
+
+    (
+        [(header::CONTENT_TYPE, PROMETHEUS_CONTENT_TYPE)],
+        render_metrics(&channels),
+    )
+        .into_response()
+}
+
+/// Render channel metrics, grouped by metric family
+fn render_metrics(channels: &[(String, ChannelMetrics)]) -> String {
+    let mut text = PrometheusText::new();
+
+    text.family(
+        "comsrv_poll_duration_seconds",
+        MetricKind::Histogram,
+        "Poll cycle duration (tick to data stored)",
+    );
+    for (id, m) in channels {
+        text.histogram(
+            "comsrv_poll_duration_seconds",
+            &[("channel", id)],
+            &m.poll_duration,
+        );
+    }
+
+    text.family("comsrv_polls_total", MetricKind::Counter, "Poll cycles");
+    for (id, m) in channels {
+        text.sample(
+            "comsrv_polls_total",
+            &[("channel", id)],
+            m.poll.polls as f64,
+        );
+    }
+
+    text.family(
+        "comsrv_poll_overruns_total",
+        MetricKind::Counter,
+        "Poll cycles that took longer than the interval",
+    );
+    for (id, m) in channels {
+        text.sample(
+            "comsrv_poll_overruns_total",
+            &[("channel", id)],
+            m.poll.overruns as f64,
+        );
+    }
+
+    text.family(
+        "comsrv_poll_interval_seconds",
+        MetricKind::Gauge,
+        "Current poll interval (differs from the configured one when backed off)",
+    );
+    for (id, m) in channels {
+        text.sample(
+            "comsrv_poll_interval_seconds",
+            &[("channel", id)],
+            m.poll.interval_ms as f64 / 1e3,
+        );
+    }
+
+    text.family(
+        "comsrv_write_batch_duration_seconds",
+        MetricKind::Histogram,
+        "Batch write duration (shared memory, buffering and C2M routing)",
+    );
+    for (id, m) in channels {
+        text.histogram(
+            "comsrv_write_batch_duration_seconds",
+            &[("channel", id)],
+            &m.write_latency,
+        );
+    }
+
+    text.family(
+        "comsrv_write_buffer_flush_duration_seconds",
+        MetricKind::Histogram,
+        "WriteBuffer flush duration (Redis pipeline round trips)",
+    );
+    for (id, m) in channels {
+        text.histogram(
+            "comsrv_write_buffer_flush_duration_seconds",
+            &[("channel", id)],
+            &m.flush_latency,
+        );
+    }
+
+    text.family(
+        "comsrv_write_buffer_pending_fields",
+        MetricKind::Gauge,
+        "Fields buffered and not yet flushed to Redis",
+    );
+    for (id, m) in channels {
+        text.sample(
+            "comsrv_write_buffer_pending_fields",
+            &[("channel", id)],
+            m.pending_fields as f64,
+        );
+    }
+
+    text.family(
+        "comsrv_command_latency_seconds",
+        MetricKind::Histogram,
+        "Command latency from intake (TODO queue pop or API request) to protocol write",
+    );
+    for (id, m) in channels {
+        text.histogram(
+            "comsrv_command_latency_seconds",
+            &[("channel", id)],
+            &m.command_latency,
+        );
+    }
+
+    text.finish()
+}
@@ -11,10 +11,11 @@ use crate::api::routes::AppState;
 use crate::dto::{AppError, SuccessResponse};
 use axum::{
     extract::{Path, Query, State},
-    response::Json,
+    http::header,
+    response::{IntoResponse, Json, Response},
 };
 use voltage_model::{KeySpaceConfig, PointType};
-use voltage_rtdb::Rtdb;
+use voltage_rtdb::{BatchReadTarget, ChannelIndex, Rtdb, SnapshotArea, BATCH_CONTENT_TYPE};
 
 /// Get point information including value, timestamp and raw value
 ///
@@ -2841,6 +2842,100 @@ pub async fn delete_adjustment_point_handler<R: Rtdb>(
     delete_point_handler_inner(channel_id, "A", point_id, state, reload_query).await
 }
 
+// ============================================================================
+// Batch Value Reads (shared memory)
+// ============================================================================
+
+/// One channel in a batch value request
+#[derive(Debug, serde::Deserialize, serde::Serialize, utoipa::ToSchema)]
+pub struct BatchChannelTarget {
+    /// Channel ID
+    #[schema(example = 1001)]
+    pub id: u32,
+
+    /// Point type: T, S, C, or A
+    #[serde(rename = "type")]
+    #[schema(example = "T")]
+    pub point_type: String,
+
+    /// Point IDs to read (omit for all registered points)
+    #[serde(default)]
+    pub points: Option<Vec<u32>>,
+}
+
+/// Batch value read request
+#[derive(Debug, serde::Deserialize, serde::Serialize, utoipa::ToSchema)]
+pub struct BatchChannelValuesRequest {
+    pub channels: Vec<BatchChannelTarget>,
+}
+
+/// Read many channels' values from shared memory as binary columns
+///
+/// Served from the shared memory slots comsrv writes, without touching
+/// Redis. The body uses the columnar format of `voltage_rtdb::shared_batch`
+/// (value, timestamp, channel ID, point ID, area, type, quality); unknown
+/// channels and unregistered points are omitted.
+///
+/// @route POST /api/channels/values/batch
+/// @input Json(request): BatchChannelValuesRequest - Channels, point types and optional point lists
+/// @output `Result<Response, AppError>` - application/vnd.voltage.point-columns body
+/// @status 200 - Encoded point columns
+/// @status 400 - Invalid point type
+/// @status 503 - Shared memory not enabled
+#[utoipa::path(
+    post,
+    path = "/api/channels/values/batch",
+    request_body(content = BatchChannelValuesRequest, description = "Channels to read",
+        example = json!({
+            "channels": [
+                {"id": 1001, "type": "T"},
+                {"id": 1002, "type": "S", "points": [1, 2, 3]}
+            ]
+        })
+    ),
+    responses(
+        (status = 200, description = "Encoded point columns (application/vnd.voltage.point-columns)"),
+        (status = 400, description = "Invalid point type"),
+        (status = 503, description = "Shared memory not enabled")
+    ),
+    tag = "comsrv"
+)]
+pub async fn batch_channel_values_handler<R: Rtdb>(
+    State(state): State<AppState<R>>,
+    Json(request): Json<BatchChannelValuesRequest>,
+) -> Result<Response, AppError> {
+    let writer = state
+        .channel_manager
+        .shared_writer()
+        .ok_or_else(|| AppError::service_unavailable("Shared memory not enabled"))?;
+
+    let targets = request
+        .channels
+        .into_iter()
+        .map(|target| {
+            let point_type = PointType::from_str(&target.point_type).ok_or_else(|| {
+                AppError::bad_request(format!(
+                    "Invalid telemetry type '{}' for channel {}. Must be T, S, C, or A",
+                    target.point_type, target.id
+                ))
+            })?;
+            Ok(BatchReadTarget {
+                area: SnapshotArea::Channel,
+                owner_id: target.id,
+                type_idx: ChannelIndex::point_type_to_index(point_type) as u8,
+                point_ids: target.points,
+            })
+        })
+        .collect::<Result<Vec<_>, AppError>>()?;
+
+    let columns = writer.read_batch(&targets);
+    Ok((
+        [(header::CONTENT_TYPE, BATCH_CONTENT_TYPE)],
+        columns.encode(),
+    )
+        .into_response())
+}
+
 // ============================================================================
 // Tests for cache priority read
 // ============================================================================
@@ -2945,4 +3040,23 @@ mod cache_tests {
             "Error should mention invalid type"
         );
     }
+
+    /// Test: Batch values need shared memory
+    #[tokio::test]
+    async fn test_batch_channel_values_without_shared_memory() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let state = create_test_state(rtdb).await;
+
+        let request = BatchChannelValuesRequest {
+            channels: vec![BatchChannelTarget {
+                id: 1,
+                point_type: "T".to_string(),
+                points: None,
+            }],
+        };
+        let err = batch_channel_values_handler(State(state), Json(request))
+            .await
+            .expect_err("Should fail without shared memory");
+        assert!(format!("{:?}", err).contains("Shared memory not enabled"));
+    }
 }
@@ -20,7 +20,7 @@ use crate::api::{
     handlers::health::*,
     handlers::{
         channel_handlers::*, channel_management_handlers::*, control_handlers::*,
-        mapping_handlers::*, point_handlers::*, protocol_handlers::*,
+        mapping_handlers::*, metrics_handlers::*, point_handlers::*, protocol_handlers::*,
     },
 };
 use common::admin_api::{get_log_level, set_log_level};
@@ -122,6 +122,7 @@ pub type ProductionAppState = AppState<voltage_rtdb::RedisRtdb>;
         // Health and service status
         crate::api::handlers::health::get_service_status,
         crate::api::handlers::health::health_check,
+        crate::api::handlers::metrics_handlers::metrics_handler,
 
         // Channel queries and status
         crate::api::handlers::channel_handlers::get_all_channels,
@@ -147,6 +148,7 @@ pub type ProductionAppState = AppState<voltage_rtdb::RedisRtdb>;
         crate::api::handlers::point_handlers::create_control_point_handler,
         crate::api::handlers::point_handlers::create_adjustment_point_handler,
         crate::api::handlers::point_handlers::batch_point_operations_handler,
+        crate::api::handlers::point_handlers::batch_channel_values_handler,
         // Note: GET/PUT/DELETE use type-specific wrappers at runtime, but OpenAPI
         // documents the parameterized inner handlers for simplicity
 
@@ -211,6 +213,8 @@ pub type ProductionAppState = AppState<voltage_rtdb::RedisRtdb>;
             crate::api::handlers::point_handlers::OperationStats,
             crate::api::handlers::point_handlers::OperationStat,
             crate::api::handlers::point_handlers::PointBatchError,
+            crate::api::handlers::point_handlers::BatchChannelValuesRequest,
+            crate::api::handlers::point_handlers::BatchChannelTarget,
             // Admin schemas
             common::admin_api::SetLogLevelRequest,
             common::admin_api::LogLevelResponse
@@ -225,15 +229,16 @@ pub struct ComsrvApiDoc;
 
 /// Create the API router with all routes (production version with Redis)
 ///
+/// Takes the service's RTDB so handlers see the same (possibly sharded) keyspace.
+///
 /// # Lock-free channel_manager
 /// # Removed VecRtdb
 pub fn create_api_routes(
     channel_manager: Arc<ChannelManager<voltage_rtdb::RedisRtdb>>,
-    redis_client: Arc<common::redis::RedisClient>,
+    rtdb: Arc<voltage_rtdb::RedisRtdb>,
     sqlite_pool: sqlx::SqlitePool,
     command_tx_cache: Arc<CommandTxCache>,
 ) -> Router {
-    let rtdb = Arc::new(voltage_rtdb::RedisRtdb::from_client(redis_client));
     create_api_routes_generic(channel_manager, rtdb, sqlite_pool, command_tx_cache)
 }
 
@@ -253,6 +258,7 @@ pub fn create_api_routes_generic<R: Rtdb>(
     Router::new()
         // Health check (top-level for monitoring systems)
         .route("/health", get(health_check))
+        .route("/metrics", get(metrics_handler))
         // Service management
         .route("/api/status", get(get_service_status))
         // Protocol discovery
@@ -262,6 +268,7 @@ pub fn create_api_routes_generic<R: Rtdb>(
         .route("/api/channels/list", get(list_channels))
         .route("/api/channels/search", get(search_channels))
         .route("/api/points", get(list_all_points))
+        .route("/api/channels/values/batch", post(batch_channel_values_handler))
         .route("/api/channels/{id}", get(get_channel_detail_handler).put(update_channel_handler).delete(delete_channel_handler))
         .route("/api/channels/{id}/status", get(get_channel_status))
         .route("/api/channels/{id}/control", post(control_channel))
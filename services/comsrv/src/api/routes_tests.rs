@@ -1182,7 +1182,7 @@ fn test_api_routes_compile() {
     let _ = create_api_routes
         as fn(
             Arc<ChannelManager<RedisRtdb>>,
-            Arc<common::redis::RedisClient>,
+            Arc<RedisRtdb>,
             sqlx::SqlitePool,
             Arc<CommandTxCache>,
         ) -> Router;
@@ -0,0 +1,313 @@
+//! Embedded Edge Host (`voltage-edge`)
+//!
+//! Runs comsrv channels and the modsrv rule engine in one process for small
+//! edge deployments. Both sides share one `RoutingCache`, one in-process
+//! `EmbeddedRtdb` and the shared memory segment, so rule actions reach the
+//! channels through the in-process command rings / TODO queues instead of a
+//! Redis round trip. Redis is only an optional asynchronous mirror
+//! (`embedded.redis_mirror = true` in the global config) for external readers.
+//!
+//! Serves the comsrv API on its usual port and the rule engine API on the
+//! modsrv port. The modsrv instance/product API still requires the standalone
+//! modsrv service.
+
+use std::net::SocketAddr;
+use std::path::PathBuf;
+use std::sync::Arc;
+
+use clap::Parser;
+use tokio_util::sync::CancellationToken;
+use tracing::{error, info, warn};
+
+use common::service_bootstrap::ServiceInfo;
+use comsrv::{
+    api::{
+        command_cache::CommandTxCache,
+        routes::{create_api_routes_generic, set_service_start_time},
+    },
+    core::{
+        bootstrap::{self, Args},
+        channels::ChannelManager,
+        config::{ConfigManager, DEFAULT_PORT},
+    },
+    error::ComSrvError,
+    runtime::{
+        load_shared_config, open_shared_writer, shutdown_services_generic,
+        start_cleanup_task_generic, start_communication_service_generic, start_snapshot_task,
+    },
+    wait_for_shutdown,
+};
+use errors::VoltageResult;
+use modsrv::{
+    rule_routes::{create_rule_routes, RuleEngineState},
+    RuleScheduler, DEFAULT_LOG_QUEUE_CAPACITY,
+};
+use voltage_routing::load_routing_maps;
+use voltage_rtdb::{
+    default_snapshot_path, EmbeddedRtdb, RedisRtdb, SharedCommandSender, SharedVecRtdbReader,
+    DEFAULT_MIRROR_QUEUE_CAPACITY,
+};
+
+#[tokio::main]
+async fn main() -> VoltageResult<()> {
+    let args = Args::parse();
+    let service_args = args.clone().into();
+
+    let service_info = ServiceInfo::new(
+        "voltage-edge",
+        "Embedded Edge Host - comsrv + rule engine in one process",
+        DEFAULT_PORT,
+    );
+
+    bootstrap::initialize_logging(&service_args, &service_info, None)?;
+    common::logging::enable_sighup_log_reopen();
+    if !args.no_color {
+        common::service_bootstrap::print_startup_banner(&service_info);
+    }
+    bootstrap::check_system_requirements()?;
+
+    if args.validate {
+        bootstrap::validate_configuration().await?;
+        info!("Validation completed successfully");
+        return Ok(());
+    }
+
+    // Load configuration from unified database
+    let db_path = service_args.get_db_path("comsrv");
+    info!(
+        "Loading configuration from unified SQLite database: {}",
+        db_path
+    );
+    let config_manager = Arc::new(ConfigManager::load().await?);
+    let app_config = config_manager.config();
+
+    let sqlite_pool = sqlx::SqlitePool::connect(&format!("sqlite:{}", db_path))
+        .await
+        .map_err(|e| ComSrvError::ConfigError(format!("Failed to create SQLite pool: {}", e)))?;
+
+    // One routing cache shared by the channels and the rule engine
+    let routing_cache = {
+        let maps = load_routing_maps(&sqlite_pool)
+            .await
+            .map_err(|e| ComSrvError::ConfigError(format!("Failed to load routing: {}", e)))?;
+        info!("Loaded routing cache: {} total routes", maps.total_routes());
+        Arc::new(voltage_rtdb::RoutingCache::from_maps(
+            maps.c2m, maps.m2c, maps.c2c,
+        ))
+    };
+
+    // In-process RTDB, optionally mirrored to Redis for external readers
+    let redis_mirror: bool = sqlx::query_scalar::<_, String>(
+        "SELECT value FROM service_config WHERE service_name = 'global' AND key = 'embedded.redis_mirror'",
+    )
+    .fetch_optional(&sqlite_pool)
+    .await
+    .ok()
+    .flatten()
+    .and_then(|s| s.parse().ok())
+    .unwrap_or(false);
+
+    let rtdb = if redis_mirror {
+        match RedisRtdb::new(&app_config.redis.url).await {
+            Ok(redis) => {
+                info!("Mirroring RTDB writes to Redis at {}", app_config.redis.url);
+                EmbeddedRtdb::with_mirror(Arc::new(redis), DEFAULT_MIRROR_QUEUE_CAPACITY)
+            },
+            Err(e) => {
+                warn!("Redis mirror unavailable, running without it: {}", e);
+                EmbeddedRtdb::new()
+            },
+        }
+    } else {
+        info!("Redis mirror disabled (embedded.redis_mirror)");
+        EmbeddedRtdb::new()
+    };
+    let rtdb = Arc::new(rtdb);
+
+    // Shared memory: written by the channels, read by the rule engine in-process
+    let (shared_config, snapshot_interval_secs) = load_shared_config(&sqlite_pool).await;
+    let (shared_writer, channel_index) =
+        open_shared_writer(&shared_config, &routing_cache, &app_config.channels).unzip();
+
+    let shared_reader = match shared_writer {
+        Some(_) => match SharedVecRtdbReader::open(&shared_config) {
+            Ok(reader) => Some(Arc::new(reader)),
+            Err(e) => {
+                warn!(
+                    "SharedVecRtdbReader unavailable, rules read the RTDB: {}",
+                    e
+                );
+                None
+            },
+        },
+        None => None,
+    };
+    let command_sender = match &shared_writer {
+        Some(writer) if writer.has_command_rings() => {
+            match SharedCommandSender::open(&shared_config) {
+                Ok(sender) => Some(Arc::new(sender)),
+                Err(e) => {
+                    warn!("Command rings unavailable, using TODO queues: {}", e);
+                    None
+                },
+            }
+        },
+        _ => None,
+    };
+
+    let command_tx_cache = Arc::new(CommandTxCache::new());
+    let shutdown_token = CancellationToken::new();
+
+    if let Some(writer) = shared_writer
+        .as_ref()
+        .filter(|_| snapshot_interval_secs > 0)
+    {
+        start_snapshot_task(
+            Arc::clone(writer),
+            default_snapshot_path(),
+            std::time::Duration::from_secs(snapshot_interval_secs as u64),
+            shutdown_token.clone(),
+        );
+    }
+
+    let channel_manager = Arc::new(ChannelManager::with_shared_memory(
+        Arc::clone(&rtdb),
+        Arc::clone(&routing_cache),
+        sqlite_pool.clone(),
+        shared_writer,
+        channel_index,
+        Some(Arc::clone(&command_tx_cache)),
+    ));
+
+    // Rule engine on the same RTDB and routing cache
+    let rule_settings = modsrv::bootstrap::load_rule_settings(&sqlite_pool).await;
+    let scheduler = Arc::new(
+        RuleScheduler::with_shared_reader(
+            Arc::clone(&rtdb),
+            routing_cache,
+            sqlite_pool.clone(),
+            rule_settings.tick_ms,
+            PathBuf::from("logs/modsrv"),
+            shared_reader,
+            command_sender,
+        )
+        .with_workers(rule_settings.workers)
+        .with_exec_details(rule_settings.exec_details)
+        .with_log_policy(rule_settings.log_policy, DEFAULT_LOG_QUEUE_CAPACITY),
+    );
+    match scheduler.load_rules().await {
+        Ok(count) => info!("Rule Engine: loaded {} rules", count),
+        Err(e) => warn!("Rule Engine: failed to load rules: {}", e),
+    }
+
+    // Start communication channels
+    let configured_count =
+        start_communication_service_generic(config_manager.clone(), Arc::clone(&channel_manager))
+            .await?;
+    let (cleanup_handle, cleanup_token) =
+        start_cleanup_task_generic(Arc::clone(&channel_manager), configured_count);
+
+    let scheduler_handle = {
+        let scheduler = Arc::clone(&scheduler);
+        tokio::spawn(async move {
+            scheduler.start().await;
+        })
+    };
+    info!("Rule scheduler started");
+
+    // comsrv API + rule engine API, each on its usual port
+    set_service_start_time(chrono::Utc::now());
+    let comsrv_app = create_api_routes_generic(
+        Arc::clone(&channel_manager),
+        Arc::clone(&rtdb),
+        sqlite_pool.clone(),
+        Arc::clone(&command_tx_cache),
+    );
+    let rule_app = create_rule_routes(Arc::new(RuleEngineState::new(
+        sqlite_pool,
+        Arc::clone(&scheduler),
+    )));
+
+    let comsrv_addr = parse_addr(&bootstrap::determine_bind_address(
+        args.bind_address,
+        &app_config.api.host,
+        app_config.api.port,
+    ))?;
+    let rule_addr = parse_addr(&format!(
+        "{}:{}",
+        app_config.api.host,
+        modsrv::config::DEFAULT_PORT
+    ))?;
+
+    let comsrv_listener = bind_listener(comsrv_addr)?;
+    let rule_listener = bind_listener(rule_addr)?;
+    info!("Channel API listening on http://{}", comsrv_addr);
+    info!("Rule Engine API listening on http://{}", rule_addr);
+
+    let server_token = shutdown_token.clone();
+    let server_handle = tokio::spawn(async move {
+        let comsrv_token = server_token.clone();
+        let comsrv_server = axum::serve(comsrv_listener, comsrv_app)
+            .with_graceful_shutdown(async move { comsrv_token.cancelled().await });
+        let rule_server = axum::serve(rule_listener, rule_app)
+            .with_graceful_shutdown(async move { server_token.cancelled().await });
+        let (comsrv_result, rule_result) = tokio::join!(comsrv_server, rule_server);
+        if let Err(e) = comsrv_result {
+            error!("Channel API server error: {}", e);
+        }
+        if let Err(e) = rule_result {
+            error!("Rule Engine API server error: {}", e);
+        }
+    });
+
+    // No Redis warning monitor in embedded mode
+    let warning_handle = tokio::spawn(async {});
+
+    wait_for_shutdown().await;
+    scheduler.stop();
+    shutdown_services_generic(
+        channel_manager,
+        shutdown_token,
+        cleanup_token,
+        cleanup_handle,
+        server_handle,
+        warning_handle,
+    )
+    .await;
+
+    match tokio::time::timeout(std::time::Duration::from_secs(30), scheduler_handle).await {
+        Ok(Ok(())) => info!("Scheduler shut down gracefully"),
+        Ok(Err(e)) => error!("Scheduler task failed: {}", e),
+        Err(_) => error!("Scheduler shutdown timed out"),
+    }
+
+    if rtdb.is_mirrored() {
+        let stats = rtdb.mirror_stats();
+        info!(
+            "Redis mirror: {} queued, {} applied, {} dropped, {} errors",
+            stats.queued, stats.applied, stats.dropped, stats.errors
+        );
+    }
+
+    Ok(())
+}
+
+fn parse_addr(address: &str) -> Result<SocketAddr, ComSrvError> {
+    address
+        .parse()
+        .map_err(|e| ComSrvError::ConfigError(format!("Invalid bind address '{}': {}", address, e)))
+}
+
+fn bind_listener(addr: SocketAddr) -> Result<tokio::net::TcpListener, ComSrvError> {
+    let socket = tokio::net::TcpSocket::new_v4()
+        .map_err(|e| ComSrvError::ConnectionError(format!("Failed to create socket: {}", e)))?;
+    socket
+        .set_reuseaddr(true)
+        .map_err(|e| ComSrvError::ConnectionError(format!("Failed to set SO_REUSEADDR: {}", e)))?;
+    socket
+        .bind(addr)
+        .map_err(|e| ComSrvError::ConnectionError(format!("Failed to bind to {}: {}", addr, e)))?;
+    socket
+        .listen(1024)
+        .map_err(|e| ComSrvError::ConnectionError(format!("Failed to listen: {}", e)))
+}
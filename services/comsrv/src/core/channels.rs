@@ -5,6 +5,9 @@
 
 // Core modules
 pub mod channel_manager; // Channel lifecycle manager (includes ChannelEntry, ChannelStats)
+pub mod dispatcher; // Multiplexed TODO queue / command ring dispatcher
+pub mod poll_scheduler; // Phase-offset, adaptive channel poll timers
+pub mod read_plan; // Modbus read request planner
 pub mod traits; // Core traits and type definitions (re-exports from types)
 pub mod trigger; // Command trigger for storage and synchronization
 pub mod types; // Channel communication types (owned by comsrv)
@@ -18,12 +21,13 @@ pub use types::{ChannelCommand, ChannelStatus, ConnectionState, ProtocolValue};
 // Re-export other types from local modules
 pub use crate::core::config::FourRemote;
 pub use channel_manager::{ChannelEntry, ChannelManager, ChannelMetadata, ChannelStats};
+pub use dispatcher::{CommandDispatcher, DispatchStats, DispatcherConfig};
 pub use trigger::{CommandStatus, CommandTrigger, CommandTriggerConfig, ControlCommand};
 
 // IGW bridge types (ProtocolClientImpl removed - now using Box<dyn ChannelRuntime>)
 pub use igw_bridge::{
     convert_to_igw_point_configs as convert_to_point_configs, create_virtual_channel, ChannelImpl,
-    IgwChannelWrapper,
+    ChannelMetrics, IgwChannelWrapper,
 };
 
 /// Initialize channels module
@@ -19,16 +19,22 @@ use crate::core::channels::igw_bridge::{
     create_modbus_rtu_channel, create_virtual_channel, ChannelImpl, IgwChannelWrapper,
 };
 
+use crate::core::channels::dispatcher::{CommandDispatcher, DispatchStats, DispatcherConfig};
 #[cfg(all(target_os = "linux", feature = "gpio"))]
 use crate::core::channels::igw_bridge::create_gpio_channel;
 #[cfg(all(feature = "can", target_os = "linux"))]
 use crate::core::channels::igw_bridge::{
     convert_can_to_igw_point_configs, convert_to_can_point_configs, create_can_channel,
 };
+use crate::core::channels::poll_scheduler::{
+    PollScheduler, PollStatsSnapshot, PollTimer, PollTimerConfig,
+};
+use crate::core::channels::read_plan::{ReadPlan, ReadPlanConfig};
 use crate::core::channels::trigger::CommandTrigger;
 use crate::core::config::{ChannelConfig, RuntimeChannelConfig};
 use crate::error::{ComSrvError, Result};
-use crate::store::RedisDataStore;
+use crate::store::{IngestFilter, RedisDataStore, DEFAULT_HISTORY_STREAM_MAX_LEN};
+use igw::core::point::PointConfig;
 use voltage_rtdb::{ChannelToSlotIndex, Rtdb, SharedVecRtdbWriter};
 
 // ============================================================================
@@ -152,6 +158,10 @@ pub struct ChannelManager<R: Rtdb> {
     /// Command TX cache for O(1) hot path access
     /// Shared with AppState for direct API access bypassing RwLock
     command_tx_cache: Option<Arc<crate::api::command_cache::CommandTxCache>>,
+    /// Shared TODO queue / command ring dispatcher for all channel triggers
+    command_dispatcher: Arc<CommandDispatcher<R>>,
+    /// Phase-offset poll timers for all channels
+    poll_scheduler: Arc<PollScheduler>,
 }
 
 impl<R: Rtdb> std::fmt::Debug for ChannelManager<R> {
@@ -173,12 +183,17 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
     pub fn new(rtdb: Arc<R>, routing_cache: Arc<voltage_rtdb::RoutingCache>) -> Self {
         Self {
             channels: Self::create_channel_slots(),
+            command_dispatcher: Arc::new(CommandDispatcher::new(
+                Arc::clone(&rtdb),
+                DispatcherConfig::default(),
+            )),
             rtdb,
             routing_cache,
             sqlite_pool: None,
             shared_writer: None,
             channel_index: None,
             command_tx_cache: None,
+            poll_scheduler: Arc::new(PollScheduler::new()),
         }
     }
 
@@ -190,12 +205,17 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
     ) -> Self {
         Self {
             channels: Self::create_channel_slots(),
+            command_dispatcher: Arc::new(CommandDispatcher::new(
+                Arc::clone(&rtdb),
+                DispatcherConfig::default(),
+            )),
             rtdb,
             routing_cache,
             sqlite_pool: Some(sqlite_pool),
             shared_writer: None,
             channel_index: None,
             command_tx_cache: None,
+            poll_scheduler: Arc::new(PollScheduler::new()),
         }
     }
 
@@ -218,6 +238,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         channel_index: Option<Arc<ChannelToSlotIndex>>,
         command_tx_cache: Option<Arc<crate::api::command_cache::CommandTxCache>>,
     ) -> Self {
+        // Shared memory command rings: modsrv actions arrive without a Redis round trip
+        let command_dispatcher = match shared_writer.as_ref().filter(|w| w.has_command_rings()) {
+            Some(writer) => CommandDispatcher::with_command_ring(
+                Arc::clone(&rtdb),
+                DispatcherConfig::default(),
+                Arc::clone(writer),
+            ),
+            None => CommandDispatcher::new(Arc::clone(&rtdb), DispatcherConfig::default()),
+        };
         Self {
             channels: Self::create_channel_slots(),
             rtdb,
@@ -226,6 +255,8 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             shared_writer,
             channel_index,
             command_tx_cache,
+            command_dispatcher: Arc::new(command_dispatcher),
+            poll_scheduler: Arc::new(PollScheduler::new()),
         }
     }
 
@@ -356,11 +387,14 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         debug!("Ch{} creating via IGW path", channel_id);
 
         // 1. Create RedisDataStore for this channel (with optional shared memory)
-        let store = self.create_data_store();
+        let store = self.create_data_store(runtime_config);
 
         // 2. Convert point configs to IGW format and register with store
         let point_configs = convert_to_igw_point_configs(runtime_config);
         store.set_point_configs(channel_id, point_configs.clone());
+        if let Some(filter) = IngestFilter::from_runtime_config(runtime_config) {
+            store.set_ingest_filter(channel_id, filter);
+        }
 
         // 3. Start background flush task for write buffer
         store.start_flush_task().await;
@@ -381,7 +415,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             .unwrap_or(1000);
 
         // Point types are encoded in internal_id by igw_bridge - no registration needed
-        let wrapper = IgwChannelWrapper::new(protocol, channel_id, store, rx, poll_interval_ms);
+        let wrapper = IgwChannelWrapper::new(
+            protocol,
+            channel_id,
+            store,
+            rx,
+            command_tx.as_ref(),
+            self.poll_timer(channel_id, runtime_config, poll_interval_ms),
+            command_priority(runtime_config),
+        );
         let channel_impl: ChannelImpl<R> = Arc::new(RwLock::new(wrapper));
 
         info!("Ch{} created via IGW (virtual)", channel_id);
@@ -404,11 +446,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         debug!("Ch{} creating via IGW Modbus path", channel_id);
 
         // 1. Create RedisDataStore for this channel (with optional shared memory)
-        let store = self.create_data_store();
+        let store = self.create_data_store(runtime_config);
 
-        // 2. Convert Modbus point configs to IGW format
+        // 2. Convert Modbus point configs to IGW format and plan the reads
         let point_configs = convert_to_modbus_point_configs(runtime_config);
         store.set_point_configs(channel_id, point_configs.clone());
+        if let Some(filter) = IngestFilter::from_runtime_config(runtime_config) {
+            store.set_ingest_filter(channel_id, filter);
+        }
+        let read_plan = plan_modbus_reads(channel_id, runtime_config, &point_configs);
 
         // 3. Start background flush task for write buffer
         store.start_flush_task().await;
@@ -439,7 +485,16 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             .unwrap_or(1000);
 
         // Point types are encoded in internal_id by igw_bridge - no registration needed
-        let wrapper = IgwChannelWrapper::new(protocol, channel_id, store, rx, poll_interval_ms);
+        let wrapper = IgwChannelWrapper::new(
+            protocol,
+            channel_id,
+            store,
+            rx,
+            command_tx.as_ref(),
+            self.poll_timer(channel_id, runtime_config, poll_interval_ms),
+            command_priority(runtime_config),
+        )
+        .with_read_plan(read_plan);
         let channel_impl: ChannelImpl<R> = Arc::new(RwLock::new(wrapper));
 
         info!("Ch{} created via IGW (modbus_tcp)", channel_id);
@@ -462,11 +517,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         debug!("Ch{} creating via IGW Modbus RTU path", channel_id);
 
         // 1. Create RedisDataStore for this channel (with optional shared memory)
-        let store = self.create_data_store();
+        let store = self.create_data_store(runtime_config);
 
-        // 2. Convert Modbus point configs to IGW format
+        // 2. Convert Modbus point configs to IGW format and plan the reads
         let point_configs = convert_to_modbus_point_configs(runtime_config);
         store.set_point_configs(channel_id, point_configs.clone());
+        if let Some(filter) = IngestFilter::from_runtime_config(runtime_config) {
+            store.set_ingest_filter(channel_id, filter);
+        }
+        let read_plan = plan_modbus_reads(channel_id, runtime_config, &point_configs);
 
         // 3. Start background flush task for write buffer
         store.start_flush_task().await;
@@ -497,7 +556,16 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             .unwrap_or(1000);
 
         // Point types are encoded in internal_id by igw_bridge - no registration needed
-        let wrapper = IgwChannelWrapper::new(protocol, channel_id, store, rx, poll_interval_ms);
+        let wrapper = IgwChannelWrapper::new(
+            protocol,
+            channel_id,
+            store,
+            rx,
+            command_tx.as_ref(),
+            self.poll_timer(channel_id, runtime_config, poll_interval_ms),
+            command_priority(runtime_config),
+        )
+        .with_read_plan(read_plan);
         let channel_impl: ChannelImpl<R> = Arc::new(RwLock::new(wrapper));
 
         info!("Ch{} created via IGW (modbus_rtu)", channel_id);
@@ -522,11 +590,14 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         debug!("Ch{} creating via IGW GPIO path", channel_id);
 
         // 1. Create RedisDataStore for this channel (with optional shared memory)
-        let store = self.create_data_store();
+        let store = self.create_data_store(runtime_config);
 
         // 2. Convert point configs to IGW format (for signal/control points)
         let point_configs = convert_to_igw_point_configs(runtime_config);
         store.set_point_configs(channel_id, point_configs);
+        if let Some(filter) = IngestFilter::from_runtime_config(runtime_config) {
+            store.set_ingest_filter(channel_id, filter);
+        }
 
         // 3. Start background flush task for write buffer
         store.start_flush_task().await;
@@ -547,7 +618,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             .unwrap_or(200);
 
         // Point types are encoded in internal_id by igw_bridge - no registration needed
-        let wrapper = IgwChannelWrapper::new(protocol, channel_id, store, rx, poll_interval_ms);
+        let wrapper = IgwChannelWrapper::new(
+            protocol,
+            channel_id,
+            store,
+            rx,
+            command_tx.as_ref(),
+            self.poll_timer(channel_id, runtime_config, poll_interval_ms),
+            command_priority(runtime_config),
+        );
         let channel_impl: ChannelImpl<R> = Arc::new(RwLock::new(wrapper));
 
         info!("Ch{} created via IGW (gpio)", channel_id);
@@ -571,7 +650,7 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         debug!("Ch{} creating via IGW CAN path", channel_id);
 
         // 1. Create RedisDataStore for this channel (with optional shared memory)
-        let store = self.create_data_store();
+        let store = self.create_data_store(runtime_config);
 
         // 2. Convert CAN mappings to IGW formats
         let can_point_configs = convert_to_can_point_configs(runtime_config);
@@ -583,6 +662,10 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
 
         store.set_point_configs(channel_id, igw_point_configs);
 
+        if let Some(filter) = IngestFilter::from_runtime_config(runtime_config) {
+            store.set_ingest_filter(channel_id, filter);
+        }
+
         // 3. Start background flush task for write buffer
         store.start_flush_task().await;
 
@@ -607,7 +690,15 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
             .unwrap_or(200);
 
         // Point types are encoded in internal_id by igw_bridge - no registration needed
-        let wrapper = IgwChannelWrapper::new(protocol, channel_id, store, rx, poll_interval_ms);
+        let wrapper = IgwChannelWrapper::new(
+            protocol,
+            channel_id,
+            store,
+            rx,
+            command_tx.as_ref(),
+            self.poll_timer(channel_id, runtime_config, poll_interval_ms),
+            command_priority(runtime_config),
+        );
         let channel_impl: ChannelImpl<R> = Arc::new(RwLock::new(wrapper));
 
         info!("Ch{} created via IGW (can)", channel_id);
@@ -620,9 +711,25 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
     /// configures it with shared memory support if available.
     ///
     /// Note: Removed VecRtdb - using SharedMemory + Redis two-tier architecture
-    fn create_data_store(&self) -> Arc<RedisDataStore<R>> {
+    fn create_data_store(&self, runtime_config: &RuntimeChannelConfig) -> Arc<RedisDataStore<R>> {
         let store = RedisDataStore::new(Arc::clone(&self.rtdb), Arc::clone(&self.routing_cache));
 
+        // Export changes to the history streams when `history_stream` is set
+        let params = &runtime_config.base.parameters;
+        let store = if params
+            .get("history_stream")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false)
+        {
+            let max_len = params
+                .get("history_stream_max_len")
+                .and_then(|v| v.as_u64())
+                .map_or(DEFAULT_HISTORY_STREAM_MAX_LEN, |n| n as usize);
+            store.with_history_stream(max_len)
+        } else {
+            store
+        };
+
         // Add shared memory support if available
         let store = if let (Some(writer), Some(index)) = (&self.shared_writer, &self.channel_index)
         {
@@ -713,6 +820,33 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
         self.channels.get(channel_id as usize)?.load_full()
     }
 
+    /// Command dispatch counters of a channel (None if it has no trigger)
+    pub fn command_dispatch_stats(&self, channel_id: u32) -> Option<DispatchStats> {
+        self.command_dispatcher.stats(channel_id)
+    }
+
+    /// Shared memory writer (None when running without shared memory)
+    pub fn shared_writer(&self) -> Option<&Arc<SharedVecRtdbWriter>> {
+        self.shared_writer.as_ref()
+    }
+
+    /// Poll jitter/overrun statistics of all polling channels
+    pub fn poll_stats(&self) -> Vec<(u32, PollStatsSnapshot)> {
+        self.poll_scheduler.channel_stats()
+    }
+
+    /// Create the phase-offset poll timer of a channel
+    fn poll_timer(
+        &self,
+        channel_id: u32,
+        runtime_config: &RuntimeChannelConfig,
+        poll_interval_ms: u64,
+    ) -> PollTimer {
+        let config =
+            PollTimerConfig::from_parameters(poll_interval_ms, &runtime_config.base.parameters);
+        self.poll_scheduler.timer(channel_id, config)
+    }
+
     /// Get channel IDs
     ///
     /// # Iterate over pre-allocated Vec
@@ -1040,15 +1174,13 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
 
         debug!("Ch{} trigger creating", channel_id);
 
-        let config = CommandTriggerConfig {
-            channel_id,
-            timeout_seconds: 1, // Default BLPOP timeout
-        };
+        let config = CommandTriggerConfig { channel_id };
 
         let (tx, rx) = tokio::sync::mpsc::channel(100);
 
-        // Pass RTDB directly to trigger (works with both RedisRtdb and MemoryRtdb)
-        let mut trigger = CommandTrigger::new(config, tx.clone(), self.rtdb.clone()).await?;
+        // Register with the shared dispatcher (works with both RedisRtdb and MemoryRtdb)
+        let mut trigger =
+            CommandTrigger::new(config, tx.clone(), Arc::clone(&self.command_dispatcher)).await?;
         trigger.start().await?;
 
         debug!("Ch{} trigger created", channel_id);
@@ -1058,6 +1190,36 @@ impl<R: Rtdb + 'static> ChannelManager<R> {
     }
 }
 
+/// Whether queued commands go ahead of the next poll on this channel.
+///
+/// Enabled per channel with `command_priority: true` in `parameters`; useful on
+/// slow serial links where one poll cycle takes hundreds of milliseconds.
+fn command_priority(runtime_config: &RuntimeChannelConfig) -> bool {
+    runtime_config
+        .base
+        .parameters
+        .get("command_priority")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false)
+}
+
+/// Plan the Modbus read requests of a channel from its point configs.
+fn plan_modbus_reads(
+    channel_id: u32,
+    runtime_config: &RuntimeChannelConfig,
+    point_configs: &[PointConfig],
+) -> ReadPlan {
+    let config = ReadPlanConfig::from_parameters(&runtime_config.base.parameters);
+    let plan = ReadPlan::build(point_configs, &config);
+    info!(
+        "Ch{} read plan: {} points in {} planned requests/poll",
+        channel_id,
+        plan.point_count(),
+        plan.planned_requests_per_poll()
+    );
+    plan
+}
+
 #[cfg(test)]
 #[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
 mod tests {
@@ -0,0 +1,853 @@
+//! Multiplexed command dispatcher
+//!
+//! Replaces the per-channel BLPOP loops with one dispatcher per ChannelManager:
+//! - Channels are spread over a few shards; each shard waits on the TODO
+//!   queues of all its channels with a single multi-key BLPOP, so a gateway
+//!   holds `shards` pooled connections instead of one per channel
+//! - Decoded commands go to each channel's mpsc sender (`IgwChannelWrapper`)
+//! - Per-channel backpressure: a channel whose sender is full is left out of
+//!   the next BLPOPs (its commands stay in Redis) until the backlog drains;
+//!   commands already popped wait in an ordered per-channel overflow queue
+//! - One task polls the shared memory command rings of every channel
+//! - Per-channel counters via [`CommandDispatcher::stats`]
+
+use common::timeouts;
+use dashmap::mapref::entry::Entry;
+use dashmap::DashMap;
+use serde::Serialize;
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use std::time::Duration;
+use tokio::sync::{mpsc, watch, Notify};
+use tokio::task::JoinHandle;
+use tokio::time::MissedTickBehavior;
+use tracing::{debug, error, info, warn};
+use voltage_model::{KeySpaceConfig, PointType};
+use voltage_rtdb::{Rtdb, SharedVecRtdbWriter};
+
+use super::traits::ChannelCommand;
+use super::trigger::{
+    classify_redis_error, CommandTrigger, CommandType, ControlCommand, TriggerMessage,
+};
+
+/// Default number of dispatcher shards (concurrent multi-key BLPOPs)
+pub const DEFAULT_DISPATCHER_SHARDS: usize = 4;
+
+/// Poll interval of the shared memory command rings (no cross-process wakeup primitive)
+const COMMAND_RING_POLL_INTERVAL: Duration = Duration::from_millis(1);
+
+/// Command dispatcher configuration
+#[derive(Debug, Clone)]
+pub struct DispatcherConfig {
+    /// Number of shards; channel N is served by shard `N % shards`
+    /// (rounded up to a multiple of the RTDB's shard count)
+    pub shards: usize,
+    /// BLPOP timeout in seconds; also bounds how long a shard takes to pick
+    /// up newly registered or resumed channels
+    pub timeout_seconds: u64,
+}
+
+impl Default for DispatcherConfig {
+    fn default() -> Self {
+        Self {
+            shards: DEFAULT_DISPATCHER_SHARDS,
+            timeout_seconds: super::trigger::default_timeout(),
+        }
+    }
+}
+
+/// Per-channel dispatch counters (snapshot)
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct DispatchStats {
+    /// Commands handed to the channel
+    pub dispatched: u64,
+    /// Commands dropped by timestamp deduplication (e.g. ring + TODO copies)
+    pub duplicates: u64,
+    /// Commands that found the channel's command queue full
+    pub backpressured: u64,
+    /// TODO messages that could not be decoded
+    pub decode_errors: u64,
+    /// Commands waiting in the channel's command queue and overflow queue
+    pub pending: usize,
+}
+
+/// Registered channel
+struct ChannelRoute {
+    channel_id: u32,
+    /// Registration token, so a stale handle cannot unregister a newer route
+    token: u64,
+    command_tx: mpsc::Sender<ChannelCommand>,
+    control_queue: String,
+    adjustment_queue: String,
+    /// Timestamp deduplication: last executed timestamp per point
+    /// (shared by the TODO and ring paths, so a command delivered twice executes once)
+    last_ts: DashMap<u32, i64>,
+    /// Commands that found the channel full, forwarded in order by one task
+    overflow: Mutex<VecDeque<ChannelCommand>>,
+    /// Set while the overflow queue is non-empty (changed under its lock)
+    paused: AtomicBool,
+    dispatched: AtomicU64,
+    duplicates: AtomicU64,
+    backpressured: AtomicU64,
+    decode_errors: AtomicU64,
+}
+
+impl ChannelRoute {
+    fn stats(&self) -> DispatchStats {
+        DispatchStats {
+            dispatched: self.dispatched.load(Ordering::Relaxed),
+            duplicates: self.duplicates.load(Ordering::Relaxed),
+            backpressured: self.backpressured.load(Ordering::Relaxed),
+            decode_errors: self.decode_errors.load(Ordering::Relaxed),
+            pending: self.command_tx.max_capacity() - self.command_tx.capacity()
+                + self.overflow().len(),
+        }
+    }
+
+    fn overflow(&self) -> std::sync::MutexGuard<'_, VecDeque<ChannelCommand>> {
+        self.overflow.lock().unwrap_or_else(|e| e.into_inner())
+    }
+}
+
+/// State shared with the dispatcher tasks
+struct Shared<R: Rtdb> {
+    rtdb: Arc<R>,
+    config: DispatcherConfig,
+    routes: DashMap<u32, Arc<ChannelRoute>>,
+    command_ring: Option<Arc<SharedVecRtdbWriter>>,
+    /// Wakes idle shards when a channel registers or resumes
+    changed: Notify,
+    shutdown_tx: watch::Sender<bool>,
+}
+
+/// Multiplexed TODO queue / command ring dispatcher
+///
+/// Tasks start on the first registration and stop when the dispatcher is dropped.
+pub struct CommandDispatcher<R: Rtdb> {
+    shared: Arc<Shared<R>>,
+    next_token: AtomicU64,
+    tasks: Mutex<Vec<JoinHandle<()>>>,
+}
+
+impl<R: Rtdb + 'static> CommandDispatcher<R> {
+    /// Create a dispatcher (no tasks are spawned until a channel registers)
+    pub fn new(rtdb: Arc<R>, config: DispatcherConfig) -> Self {
+        Self::build(rtdb, config, None)
+    }
+
+    /// Create a dispatcher that also drains the shared memory command rings
+    pub fn with_command_ring(
+        rtdb: Arc<R>,
+        config: DispatcherConfig,
+        writer: Arc<SharedVecRtdbWriter>,
+    ) -> Self {
+        Self::build(rtdb, config, Some(writer))
+    }
+
+    fn build(
+        rtdb: Arc<R>,
+        config: DispatcherConfig,
+        command_ring: Option<Arc<SharedVecRtdbWriter>>,
+    ) -> Self {
+        let (shutdown_tx, _) = watch::channel(false);
+        // Round up to a multiple of the Redis shards so every dispatch shard's
+        // TODO queues live on one server and its BLPOP stays a single command
+        let backend_shards = rtdb.shard_count().max(1);
+        let shards = config.shards.max(1).div_ceil(backend_shards) * backend_shards;
+        Self {
+            shared: Arc::new(Shared {
+                rtdb,
+                config: DispatcherConfig { shards, ..config },
+                routes: DashMap::new(),
+                command_ring,
+                changed: Notify::new(),
+                shutdown_tx,
+            }),
+            next_token: AtomicU64::new(1),
+            tasks: Mutex::new(Vec::new()),
+        }
+    }
+
+    /// Route a channel's TODO queues (and command ring) to `command_tx`
+    ///
+    /// Replaces any previous registration of the channel.
+    ///
+    /// # Returns
+    /// Registration token for [`unregister`](Self::unregister)
+    pub fn register(&self, channel_id: u32, command_tx: mpsc::Sender<ChannelCommand>) -> u64 {
+        let keyspace = KeySpaceConfig::production_cached();
+        let token = self.next_token.fetch_add(1, Ordering::Relaxed);
+        let route = Arc::new(ChannelRoute {
+            channel_id,
+            token,
+            command_tx,
+            control_queue: keyspace.todo_queue_key(channel_id, PointType::Control),
+            adjustment_queue: keyspace.todo_queue_key(channel_id, PointType::Adjustment),
+            last_ts: DashMap::new(),
+            overflow: Mutex::new(VecDeque::new()),
+            paused: AtomicBool::new(false),
+            dispatched: AtomicU64::new(0),
+            duplicates: AtomicU64::new(0),
+            backpressured: AtomicU64::new(0),
+            decode_errors: AtomicU64::new(0),
+        });
+        self.shared.routes.insert(channel_id, route);
+        self.ensure_started();
+        self.shared.changed.notify_waiters();
+        debug!("Ch{} dispatch registered", channel_id);
+        token
+    }
+
+    /// Stop routing a channel, if `token` is still its current registration
+    ///
+    /// A command popped by an in-flight BLPOP after this call is dropped.
+    pub fn unregister(&self, channel_id: u32, token: u64) {
+        if self
+            .shared
+            .routes
+            .remove_if(&channel_id, |_, route| route.token == token)
+            .is_some()
+        {
+            debug!("Ch{} dispatch unregistered", channel_id);
+        }
+    }
+
+    /// Dispatch counters of a registered channel
+    pub fn stats(&self, channel_id: u32) -> Option<DispatchStats> {
+        self.shared
+            .routes
+            .get(&channel_id)
+            .map(|route| route.stats())
+    }
+
+    /// Number of registered channels
+    pub fn channel_count(&self) -> usize {
+        self.shared.routes.len()
+    }
+
+    /// Spawn the shard tasks (and ring poller) once
+    fn ensure_started(&self) {
+        let mut tasks = self.tasks.lock().unwrap_or_else(|e| e.into_inner());
+        if !tasks.is_empty() {
+            return;
+        }
+        for shard in 0..self.shared.config.shards {
+            let shared = Arc::clone(&self.shared);
+            tasks.push(tokio::spawn(Self::shard_loop(shared, shard)));
+        }
+        if self.shared.command_ring.is_some() {
+            let shared = Arc::clone(&self.shared);
+            tasks.push(tokio::spawn(Self::command_ring_loop(shared)));
+        }
+        info!(
+            "Command dispatcher: {} shards ({}s), command rings {}",
+            self.shared.config.shards,
+            self.shared.config.timeout_seconds,
+            if self.shared.command_ring.is_some() {
+                "on"
+            } else {
+                "off"
+            }
+        );
+    }
+
+    /// Wait on the TODO queues of every active channel of one shard
+    async fn shard_loop(shared: Arc<Shared<R>>, shard: usize) {
+        let shards = shared.config.shards;
+        let timeout = shared.config.timeout_seconds;
+        let idle_wait = Duration::from_secs(timeout.max(1));
+        let mut shutdown_rx = shared.shutdown_tx.subscribe();
+
+        // Reconnection backoff with failure tracking.
+        let mut reconnect_delay = timeouts::MIN_RECONNECT_DELAY;
+        let mut consecutive_failures = 0u32;
+        // Last queue served, as (channel_id, 0 = control / 1 = adjustment)
+        let mut last_served: Option<(u32, u8)> = None;
+
+        while !*shutdown_rx.borrow() {
+            // Paused channels are skipped: their commands wait in Redis
+            let mut routes: Vec<Arc<ChannelRoute>> = shared
+                .routes
+                .iter()
+                .filter(|route| {
+                    route.channel_id as usize % shards == shard
+                        && !route.paused.load(Ordering::Acquire)
+                })
+                .map(|route| Arc::clone(route.value()))
+                .collect();
+
+            if routes.is_empty() {
+                // Nothing to wait on: sleep until a channel registers or resumes
+                tokio::select! {
+                    _ = shared.changed.notified() => {}
+                    _ = tokio::time::sleep(idle_wait) => {}
+                    _ = shutdown_rx.changed() => {}
+                }
+                continue;
+            }
+
+            // BLPOP serves the first non-empty key: start after the last
+            // queue served so a busy channel cannot starve the others
+            routes.sort_unstable_by_key(|route| route.channel_id);
+            let mut ordered: Vec<((u32, u8), &str)> = routes
+                .iter()
+                .flat_map(|route| {
+                    [
+                        ((route.channel_id, 0), route.control_queue.as_str()),
+                        ((route.channel_id, 1), route.adjustment_queue.as_str()),
+                    ]
+                })
+                .collect();
+            let start = ordered.partition_point(|(order, _)| Some(*order) <= last_served);
+            ordered.rotate_left(start);
+            let keys: Vec<&str> = ordered.iter().map(|(_, key)| *key).collect();
+
+            let result = tokio::select! {
+                _ = shutdown_rx.changed() => continue,
+                result = shared.rtdb.list_blpop(&keys, timeout) => result,
+            };
+
+            match result {
+                Ok(Some((queue, data))) => {
+                    reconnect_delay = timeouts::MIN_RECONNECT_DELAY;
+                    consecutive_failures = 0;
+
+                    let target = routes.iter().find_map(|route| {
+                        if queue == route.control_queue {
+                            Some((route.channel_id, true))
+                        } else if queue == route.adjustment_queue {
+                            Some((route.channel_id, false))
+                        } else {
+                            None
+                        }
+                    });
+                    match target {
+                        Some((channel_id, is_control)) => {
+                            last_served = Some((channel_id, u8::from(!is_control)));
+                            Self::handle_todo(&shared, channel_id, is_control, &data).await;
+                        },
+                        None => warn!("Unknown TODO queue: {}", queue),
+                    }
+                },
+                Ok(None) => {}, // Timeout; rebuild the key set
+                Err(e) => {
+                    consecutive_failures += 1;
+                    let error_type = classify_redis_error(&e);
+                    error!(
+                        "Dispatch shard {} BLPOP err #{}: {} ({}), retry {:?}",
+                        shard, consecutive_failures, e, error_type, reconnect_delay
+                    );
+                    if consecutive_failures >= 10 {
+                        error!(
+                            "CRITICAL: dispatch shard {} {}x failures",
+                            shard, consecutive_failures
+                        );
+                    }
+
+                    tokio::select! {
+                        _ = tokio::time::sleep(reconnect_delay) => {
+                            reconnect_delay = (reconnect_delay * 2).min(timeouts::MAX_RECONNECT_DELAY);
+                        }
+                        _ = shutdown_rx.changed() => {}
+                    }
+                },
+            }
+        }
+        debug!("Dispatch shard {} stopped", shard);
+    }
+
+    /// Decode a TODO message and dispatch it
+    async fn handle_todo(shared: &Arc<Shared<R>>, channel_id: u32, is_control: bool, data: &[u8]) {
+        let Some(route) = shared
+            .routes
+            .get(&channel_id)
+            .map(|r| Arc::clone(r.value()))
+        else {
+            warn!("Ch{} unregistered, TODO dropped", channel_id);
+            return;
+        };
+
+        // ★ Parse with untagged enum (single JSON parse for both formats)
+        let decoded = match serde_json::from_slice::<TriggerMessage>(data) {
+            Ok(TriggerMessage::Compact(trigger)) => {
+                Some((trigger.point_id, trigger.value, trigger.timestamp))
+            },
+            Ok(TriggerMessage::Legacy { point_id }) => {
+                debug!("Legacy trigger Ch{} pt{}", channel_id, point_id);
+                let point_type = if is_control {
+                    PointType::Control
+                } else {
+                    PointType::Adjustment
+                };
+                Self::read_legacy(shared.rtdb.as_ref(), channel_id, point_type, point_id).await
+            },
+            Err(e) => {
+                error!("Ch{} TODO parse err: {}", channel_id, e);
+                None
+            },
+        };
+
+        match decoded {
+            Some((point_id, value, timestamp_ms)) => Self::dispatch(
+                shared,
+                &route,
+                is_control,
+                point_id,
+                value,
+                timestamp_ms,
+                "list_queue",
+            ),
+            None => {
+                route.decode_errors.fetch_add(1, Ordering::Relaxed);
+            },
+        }
+    }
+
+    /// Legacy format: read value/timestamp from the channel hashes
+    async fn read_legacy(
+        rtdb: &R,
+        channel_id: u32,
+        point_type: PointType,
+        point_id: u32,
+    ) -> Option<(u32, f64, i64)> {
+        let keyspace = KeySpaceConfig::production_cached();
+        let channel_key = keyspace.channel_key(channel_id, point_type);
+        let ts_key = keyspace.channel_ts_key(channel_id, point_type);
+        let point_id_str = point_id.to_string();
+
+        fn parse<T: std::str::FromStr>(bytes: &[u8]) -> Option<T> {
+            std::str::from_utf8(bytes).ok()?.parse().ok()
+        }
+
+        let timestamp_ms: i64 = match rtdb.hash_get(&ts_key, &point_id_str).await {
+            Ok(Some(ts_bytes)) => match parse(&ts_bytes) {
+                Some(ts) => ts,
+                None => {
+                    error!("Ch{} pt{} ts parse err", channel_id, point_id);
+                    return None;
+                },
+            },
+            Ok(None) => 0, // Treat as new command if timestamp missing
+            Err(e) => {
+                error!("Ch{} pt{} ts read err: {}", channel_id, point_id, e);
+                return None;
+            },
+        };
+
+        let value: f64 = match rtdb.hash_get(&channel_key, &point_id_str).await {
+            Ok(Some(value_bytes)) => match parse(&value_bytes) {
+                Some(v) => v,
+                None => {
+                    error!("Ch{} pt{} val parse err", channel_id, point_id);
+                    return None;
+                },
+            },
+            Ok(None) => {
+                error!("Ch{} pt{} no value", channel_id, point_id);
+                return None;
+            },
+            Err(e) => {
+                error!("Ch{} pt{} val read err: {}", channel_id, point_id, e);
+                return None;
+            },
+        };
+
+        Some((point_id, value, timestamp_ms))
+    }
+
+    /// Drain the command rings of every active channel
+    async fn command_ring_loop(shared: Arc<Shared<R>>) {
+        let Some(writer) = shared.command_ring.clone() else {
+            return;
+        };
+        let mut shutdown_rx = shared.shutdown_tx.subscribe();
+        let mut ticker = tokio::time::interval(COMMAND_RING_POLL_INTERVAL);
+        ticker.set_missed_tick_behavior(MissedTickBehavior::Skip);
+        let mut routes: Vec<Arc<ChannelRoute>> = Vec::new();
+        let mut batch = Vec::new();
+
+        loop {
+            tokio::select! {
+                _ = shutdown_rx.changed() => {
+                    if *shutdown_rx.borrow() {
+                        break;
+                    }
+                }
+                _ = ticker.tick() => {
+                    // Paused channels keep their ring full, so producers fall back to Redis
+                    routes.clear();
+                    routes.extend(
+                        shared
+                            .routes
+                            .iter()
+                            .filter(|route| !route.paused.load(Ordering::Acquire))
+                            .map(|route| Arc::clone(route.value())),
+                    );
+                    for route in &routes {
+                        writer.drain_commands(route.channel_id, usize::MAX, |c| batch.push(c));
+                        for command in batch.drain(..) {
+                            Self::dispatch(
+                                &shared,
+                                route,
+                                command.point_type == PointType::Control,
+                                command.point_id,
+                                command.value,
+                                command.timestamp_ms,
+                                "command_ring",
+                            );
+                        }
+                    }
+                }
+            }
+        }
+        debug!("Command ring poller stopped");
+    }
+
+    /// Deduplicate by timestamp and hand a command to the channel
+    fn dispatch(
+        shared: &Arc<Shared<R>>,
+        route: &Arc<ChannelRoute>,
+        is_control: bool,
+        point_id: u32,
+        value: f64,
+        timestamp_ms: i64,
+        source: &str,
+    ) {
+        // ★ Atomic timestamp deduplication using entry API
+        let should_execute = match route.last_ts.entry(point_id) {
+            Entry::Occupied(mut entry) => {
+                if timestamp_ms > *entry.get() {
+                    entry.insert(timestamp_ms);
+                    true
+                } else {
+                    false
+                }
+            },
+            Entry::Vacant(entry) => {
+                entry.insert(timestamp_ms);
+                true
+            },
+        };
+        if !should_execute {
+            debug!("Skip pt{}: ts={} (same)", point_id, timestamp_ms);
+            route.duplicates.fetch_add(1, Ordering::Relaxed);
+            return;
+        }
+
+        debug!(
+            "Exec Ch{} pt{}: val={} ts={} ({})",
+            route.channel_id, point_id, value, timestamp_ms, source
+        );
+
+        let command = CommandTrigger::<R>::to_channel_command(ControlCommand {
+            command_id: format!("trigger_{}_{}", route.channel_id, timestamp_ms),
+            channel_id: Some(route.channel_id),
+            command_type: if is_control {
+                CommandType::Control
+            } else {
+                CommandType::Adjustment
+            },
+            point_id,
+            value,
+            timestamp: timestamp_ms / 1000, // Convert ms to seconds
+            metadata: serde_json::Value::Null,
+        });
+
+        // The overflow lock orders this command after any backlog
+        let mut overflow = route.overflow();
+        if route.paused.load(Ordering::Acquire) {
+            // Popped by a BLPOP or ring drain that was already in flight
+            route.backpressured.fetch_add(1, Ordering::Relaxed);
+            overflow.push_back(command);
+            return;
+        }
+        match route.command_tx.try_send(command) {
+            Ok(()) => {
+                route.dispatched.fetch_add(1, Ordering::Relaxed);
+            },
+            Err(mpsc::error::TrySendError::Full(command)) => {
+                // Keep the command, pause the channel until the executor catches up
+                route.backpressured.fetch_add(1, Ordering::Relaxed);
+                route.paused.store(true, Ordering::Release);
+                overflow.push_back(command);
+                warn!("Ch{} cmd queue full, pausing dispatch", route.channel_id);
+                tokio::spawn(Self::forward_overflow(
+                    Arc::clone(shared),
+                    Arc::clone(route),
+                ));
+            },
+            Err(mpsc::error::TrySendError::Closed(_)) => {
+                warn!("Ch{} cmd channel closed", route.channel_id);
+            },
+        }
+    }
+
+    /// Forward a paused channel's overflow queue in order, then resume it
+    async fn forward_overflow(shared: Arc<Shared<R>>, route: Arc<ChannelRoute>) {
+        loop {
+            let command = {
+                let mut overflow = route.overflow();
+                match overflow.pop_front() {
+                    Some(command) => command,
+                    None => {
+                        route.paused.store(false, Ordering::Release);
+                        break;
+                    },
+                }
+            };
+            if route.command_tx.send(command).await.is_err() {
+                let mut overflow = route.overflow();
+                warn!(
+                    "Ch{} cmd channel closed, {} queued commands dropped",
+                    route.channel_id,
+                    overflow.len() + 1
+                );
+                overflow.clear();
+                route.paused.store(false, Ordering::Release);
+                return;
+            }
+            route.dispatched.fetch_add(1, Ordering::Relaxed);
+        }
+        debug!(
+            "Ch{} cmd queue drained, resuming dispatch",
+            route.channel_id
+        );
+        // Busy shards pick the channel up again within one BLPOP timeout
+        shared.changed.notify_waiters();
+    }
+}
+
+impl<R: Rtdb> Drop for CommandDispatcher<R> {
+    fn drop(&mut self) {
+        let _ = self.shared.shutdown_tx.send(true);
+        let tasks = self.tasks.get_mut().unwrap_or_else(|e| e.into_inner());
+        for task in tasks.drain(..) {
+            task.abort();
+        }
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // Test code - unwrap is acceptable
+mod tests {
+    use super::*;
+    use bytes::Bytes;
+    use voltage_rtdb::MemoryRtdb;
+
+    fn todo(point_id: u32, value: f64, timestamp: i64) -> Bytes {
+        Bytes::from(format!(
+            r#"{{"point_id":{},"value":{},"timestamp":{}}}"#,
+            point_id, value, timestamp
+        ))
+    }
+
+    #[tokio::test]
+    async fn test_dispatch_multiplexes_channels() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let dispatcher = CommandDispatcher::new(
+            Arc::clone(&rtdb),
+            DispatcherConfig {
+                shards: 1,
+                timeout_seconds: 1,
+            },
+        );
+        let (tx1, mut rx1) = mpsc::channel(8);
+        let (tx2, mut rx2) = mpsc::channel(8);
+        dispatcher.register(1001, tx1);
+        dispatcher.register(1002, tx2);
+
+        let keyspace = KeySpaceConfig::production_cached();
+        rtdb.list_rpush(
+            &keyspace.todo_queue_key(1001, PointType::Control),
+            todo(1, 1.0, 1000),
+        )
+        .await
+        .unwrap();
+        rtdb.list_rpush(
+            &keyspace.todo_queue_key(1002, PointType::Adjustment),
+            todo(7, 42.5, 2000),
+        )
+        .await
+        .unwrap();
+        // Same timestamp again: deduplicated
+        rtdb.list_rpush(
+            &keyspace.todo_queue_key(1001, PointType::Control),
+            todo(1, 1.0, 1000),
+        )
+        .await
+        .unwrap();
+
+        let timeout = Duration::from_secs(3);
+        let first = tokio::time::timeout(timeout, rx1.recv()).await.unwrap();
+        assert!(matches!(
+            first,
+            Some(ChannelCommand::Control { point_id: 1, .. })
+        ));
+        let second = tokio::time::timeout(timeout, rx2.recv()).await.unwrap();
+        assert!(matches!(
+            second,
+            Some(ChannelCommand::Adjustment { point_id: 7, value, .. }) if value == 42.5
+        ));
+
+        // Wait for the duplicate to be consumed
+        for _ in 0..100 {
+            if dispatcher.stats(1001).unwrap().duplicates == 1 {
+                break;
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+        let stats = dispatcher.stats(1001).unwrap();
+        assert_eq!(stats.dispatched, 1);
+        assert_eq!(stats.duplicates, 1);
+        assert!(rx1.try_recv().is_err());
+    }
+
+    #[tokio::test]
+    async fn test_busy_channel_does_not_starve_others() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let keyspace = KeySpaceConfig::production_cached();
+        // Backlogs queued before the dispatcher starts
+        for i in 0..4u32 {
+            for channel_id in [1001, 1002] {
+                rtdb.list_rpush(
+                    &keyspace.todo_queue_key(channel_id, PointType::Control),
+                    todo(channel_id * 10 + i, 1.0, 1000 + i as i64),
+                )
+                .await
+                .unwrap();
+            }
+        }
+
+        let dispatcher = CommandDispatcher::new(
+            Arc::clone(&rtdb),
+            DispatcherConfig {
+                shards: 1,
+                timeout_seconds: 1,
+            },
+        );
+        let (tx, mut rx) = mpsc::channel(16);
+        dispatcher.register(1001, tx.clone());
+        dispatcher.register(1002, tx);
+
+        let mut channels = Vec::new();
+        for _ in 0..8 {
+            match tokio::time::timeout(Duration::from_secs(3), rx.recv()).await {
+                Ok(Some(ChannelCommand::Control { point_id, .. })) => channels.push(point_id / 10),
+                other => panic!("unexpected: {:?}", other),
+            }
+        }
+        // Served alternately, not 1001's backlog first
+        assert!(
+            channels.windows(2).all(|pair| pair[0] != pair[1]),
+            "{:?}",
+            channels
+        );
+    }
+
+    #[tokio::test]
+    async fn test_full_channel_keeps_commands() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let dispatcher = CommandDispatcher::new(
+            Arc::clone(&rtdb),
+            DispatcherConfig {
+                shards: 1,
+                timeout_seconds: 1,
+            },
+        );
+        let (tx, mut rx) = mpsc::channel(1);
+        dispatcher.register(1001, tx);
+
+        let queue = KeySpaceConfig::production_cached().todo_queue_key(1001, PointType::Control);
+        for i in 0..3 {
+            rtdb.list_rpush(&queue, todo(i + 1, i as f64, 1000 + i as i64))
+                .await
+                .unwrap();
+        }
+
+        // Nobody reads yet: the channel fills and dispatch backs off
+        for _ in 0..100 {
+            if dispatcher.stats(1001).unwrap().backpressured > 0 {
+                break;
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+        assert!(dispatcher.stats(1001).unwrap().backpressured > 0);
+
+        // Every command is still delivered, in order
+        let mut points = Vec::new();
+        for _ in 0..3 {
+            match tokio::time::timeout(Duration::from_secs(3), rx.recv()).await {
+                Ok(Some(ChannelCommand::Control { point_id, .. })) => points.push(point_id),
+                other => panic!("unexpected: {:?}", other),
+            }
+        }
+        assert_eq!(points, vec![1, 2, 3]);
+    }
+
+    #[tokio::test]
+    async fn test_overflow_keeps_order_behind_backlog() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let dispatcher = CommandDispatcher::new(Arc::clone(&rtdb), DispatcherConfig::default());
+        let (tx, mut rx) = mpsc::channel(1);
+        dispatcher.register(1001, tx);
+        let route = dispatcher
+            .shared
+            .routes
+            .get(&1001)
+            .map(|r| Arc::clone(r.value()))
+            .unwrap();
+
+        // A burst (e.g. one ring drain) larger than the channel
+        for i in 0..5u32 {
+            CommandDispatcher::dispatch(
+                &dispatcher.shared,
+                &route,
+                true,
+                i + 1,
+                i as f64,
+                1000 + i as i64,
+                "test",
+            );
+        }
+        let stats = dispatcher.stats(1001).unwrap();
+        assert_eq!(stats.backpressured, 4);
+        assert_eq!(stats.pending, 5);
+        assert!(route.paused.load(Ordering::Acquire));
+
+        let mut points = Vec::new();
+        for _ in 0..5 {
+            match tokio::time::timeout(Duration::from_secs(3), rx.recv()).await {
+                Ok(Some(ChannelCommand::Control { point_id, .. })) => points.push(point_id),
+                other => panic!("unexpected: {:?}", other),
+            }
+        }
+        assert_eq!(points, vec![1, 2, 3, 4, 5]);
+
+        // Resumed once the backlog is forwarded
+        for _ in 0..100 {
+            if !route.paused.load(Ordering::Acquire) {
+                break;
+            }
+            tokio::time::sleep(Duration::from_millis(10)).await;
+        }
+        assert!(!route.paused.load(Ordering::Acquire));
+        assert_eq!(dispatcher.stats(1001).unwrap().dispatched, 5);
+    }
+
+    #[tokio::test]
+    async fn test_unregister_respects_token() {
+        let rtdb = Arc::new(MemoryRtdb::new());
+        let dispatcher = CommandDispatcher::new(rtdb, DispatcherConfig::default());
+        let (tx, _rx) = mpsc::channel(1);
+        let old = dispatcher.register(1001, tx.clone());
+        let new = dispatcher.register(1001, tx);
+
+        // Stale handle leaves the newer registration in place
+        dispatcher.unregister(1001, old);
+        assert_eq!(dispatcher.channel_count(), 1);
+        dispatcher.unregister(1001, new);
+        assert_eq!(dispatcher.channel_count(), 0);
+        assert!(dispatcher.stats(1001).is_none());
+    }
+}
@@ -16,10 +16,22 @@
 //!         ├─ store: RedisDataStore (service layer storage)
 //!         └─ poll_once() → protocol.poll_once() → store.write_batch()
 //! ```
-
+//!
+//! # Command Priority
+//!
+//! The polling task and the command executor share the protocol lock. With
+//! `command_priority` enabled, the poller does not start the next poll while
+//! commands are queued for the channel or executing, and the executor writes
+//! queued commands under a single lock acquisition. A poll already on the
+//! wire is never interrupted. Queue-wait and end-to-end latency are reported
+//! by `get_diagnostics()`.
+
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
 use std::sync::Arc;
+use std::time::{Duration, Instant};
 
-use tokio::sync::{mpsc, RwLock};
+use serde::Serialize;
+use tokio::sync::{mpsc, Notify, RwLock};
 use tracing::{debug, error, info, warn};
 
 use igw::core::point::{
@@ -44,12 +56,14 @@ use igw::gateway::wrappers::GpioRuntime;
 #[cfg(all(target_os = "linux", feature = "gpio"))]
 use igw::protocols::gpio::{GpioChannel, GpioChannelConfig, GpioPinConfig};
 
+use crate::core::channels::poll_scheduler::{PollStats, PollStatsSnapshot, PollTimer};
+use crate::core::channels::read_plan::ReadPlan;
 use crate::core::channels::traits::ChannelCommand;
 use crate::core::channels::types::ChannelStatus;
 use crate::core::config::RuntimeChannelConfig;
 use crate::store::RedisDataStore;
 use voltage_model::PointType;
-use voltage_rtdb::Rtdb;
+use voltage_rtdb::{HistogramSnapshot, LatencyHistogram, Rtdb};
 
 // ============================================================================
 // IgwChannelWrapper - Protocol wrapper with storage integration
@@ -73,6 +87,13 @@ pub struct IgwChannelWrapper<R: Rtdb> {
     executor_handle: Option<tokio::task::JoinHandle<()>>,
     /// Polling task handle (used for cleanup on disconnect)
     polling_handle: Option<tokio::task::JoinHandle<()>>,
+    /// Command/poll arbitration and command latency statistics
+    scheduler: Arc<CommandScheduler>,
+    /// Poll jitter/overrun statistics (shared with the polling task)
+    poll_stats: Arc<PollStats>,
+    /// Modbus read plan computed at channel creation (None for other protocols);
+    /// reported only, igw batches the actual reads itself
+    read_plan: Option<Arc<ReadPlan>>,
 }
 
 impl<R: Rtdb> IgwChannelWrapper<R> {
@@ -85,32 +106,53 @@ impl<R: Rtdb> IgwChannelWrapper<R> {
     /// * `channel_id` - Unique channel identifier
     /// * `store` - Data store for persisting polled data
     /// * `command_rx` - Receiver for control commands
-    /// * `poll_interval_ms` - Polling interval in milliseconds
+    /// * `command_tx` - Sender side of `command_rx`, lets the poller see queued commands
+    /// * `poll_timer` - Phase-offset polling timer from the `PollScheduler`
+    /// * `command_priority` - Let pending commands jump ahead of the next poll
     pub fn new(
         protocol: Box<dyn ChannelRuntime>,
         channel_id: u32,
         store: Arc<RedisDataStore<R>>,
         command_rx: mpsc::Receiver<ChannelCommand>,
-        poll_interval_ms: u64,
+        command_tx: Option<&mpsc::Sender<ChannelCommand>>,
+        poll_timer: PollTimer,
+        command_priority: bool,
     ) -> Self {
         let protocol = Arc::new(RwLock::new(protocol));
-        let protocol_clone = Arc::clone(&protocol);
+        let mut scheduler = CommandScheduler::new(command_priority);
+        if let Some(tx) = command_tx {
+            scheduler = scheduler.with_queue(tx);
+        }
+        let scheduler = Arc::new(scheduler);
+        let poll_stats = Arc::clone(poll_timer.stats());
+        let poll_interval_ms = poll_timer.period().as_millis();
 
         // Spawn command executor task
+        let protocol_clone = Arc::clone(&protocol);
+        let scheduler_clone = Arc::clone(&scheduler);
         let executor_handle = tokio::spawn(async move {
-            Self::run_command_executor(protocol_clone, command_rx, channel_id).await;
+            Self::run_command_executor(protocol_clone, command_rx, channel_id, scheduler_clone)
+                .await;
         });
 
         // Start polling task with configured interval
         let protocol_clone = Arc::clone(&protocol);
         let store_clone = Arc::clone(&store);
+        let scheduler_clone = Arc::clone(&scheduler);
         let polling_handle = Some(tokio::spawn(async move {
-            run_polling_task(protocol_clone, store_clone, channel_id, poll_interval_ms).await;
+            run_polling_task(
+                protocol_clone,
+                store_clone,
+                channel_id,
+                poll_timer,
+                scheduler_clone,
+            )
+            .await;
         }));
 
         info!(
-            "Ch{} started polling task (interval: {}ms)",
-            channel_id, poll_interval_ms
+            "Ch{} started polling task (interval: {}ms, command priority: {})",
+            channel_id, poll_interval_ms, command_priority
         );
 
         Self {
@@ -119,9 +161,23 @@ impl<R: Rtdb> IgwChannelWrapper<R> {
             store,
             executor_handle: Some(executor_handle),
             polling_handle,
+            scheduler,
+            poll_stats,
+            read_plan: None,
         }
     }
 
+    /// Attach the channel's Modbus read plan (reported in diagnostics).
+    pub fn with_read_plan(mut self, read_plan: ReadPlan) -> Self {
+        self.read_plan = Some(Arc::new(read_plan));
+        self
+    }
+
+    /// Get the Modbus read plan, if any.
+    pub fn read_plan(&self) -> Option<&Arc<ReadPlan>> {
+        self.read_plan.as_ref()
+    }
+
     /// Poll once and write data to store.
     ///
     /// This is the main data acquisition method:
@@ -222,97 +278,303 @@ impl<R: Rtdb> IgwChannelWrapper<R> {
     ///
     /// Uses ChannelRuntime's `write_control` and `write_adjustment` which
     /// take `&[(u32, f64)]` tuples instead of command structs.
+    ///
+    /// In priority mode commands already queued behind the first one are
+    /// executed under the same lock acquisition, so a burst waits for at most
+    /// one poll instead of one poll per command. At most
+    /// `MAX_COMMANDS_PER_POLL` run per acquisition so polling keeps going
+    /// under a steady command stream.
     async fn run_command_executor(
         protocol: Arc<RwLock<Box<dyn ChannelRuntime>>>,
         mut command_rx: mpsc::Receiver<ChannelCommand>,
         channel_id: u32,
+        scheduler: Arc<CommandScheduler>,
     ) {
         debug!("Ch{} igw command executor started", channel_id);
 
         while let Some(cmd) = command_rx.recv().await {
+            scheduler.begin_command();
+            let received_at = cmd.received_at();
             let mut protocol_guard = protocol.write().await;
 
-            match cmd {
-                ChannelCommand::Control {
-                    point_id, value, ..
-                } => {
-                    // Convert to internal_id: IGW pins use PointType offset encoding
-                    // to distinguish Control from Signal points with same point_id
-                    let internal_id = PointType::Control.to_internal_id(point_id);
-                    match protocol_guard.write_control(&[(internal_id, value)]).await {
-                        Ok(success_count) => {
-                            if success_count > 0 {
-                                debug!("Ch{} control pt{} = {} ok", channel_id, point_id, value);
-                            } else {
-                                warn!("Ch{} control pt{} = {} failed", channel_id, point_id, value);
-                            }
-                        },
-                        Err(e) => {
-                            error!("Ch{} control pt{} err: {}", channel_id, point_id, e);
-                        },
-                    }
-                },
-                ChannelCommand::Adjustment {
-                    point_id, value, ..
-                } => {
-                    // Convert to internal_id: IGW pins use PointType offset encoding
-                    let internal_id = PointType::Adjustment.to_internal_id(point_id);
-                    match protocol_guard
-                        .write_adjustment(&[(internal_id, value)])
-                        .await
-                    {
-                        Ok(success_count) => {
-                            if success_count > 0 {
-                                debug!("Ch{} adjustment pt{} = {} ok", channel_id, point_id, value);
-                            } else {
-                                warn!(
-                                    "Ch{} adjustment pt{} = {} failed",
-                                    channel_id, point_id, value
-                                );
-                            }
-                        },
-                        Err(e) => {
-                            error!("Ch{} adjustment pt{} err: {}", channel_id, point_id, e);
-                        },
-                    }
-                },
+            let acquired = Instant::now();
+            Self::execute_command(protocol_guard.as_mut(), cmd, channel_id).await;
+            scheduler.finish_command(received_at, acquired);
+
+            if scheduler.is_priority() {
+                for _ in 1..MAX_COMMANDS_PER_POLL {
+                    let Ok(cmd) = command_rx.try_recv() else {
+                        break;
+                    };
+                    scheduler.begin_command();
+                    let received_at = cmd.received_at();
+                    let acquired = Instant::now();
+                    Self::execute_command(protocol_guard.as_mut(), cmd, channel_id).await;
+                    scheduler.finish_command(received_at, acquired);
+                }
             }
         }
 
         debug!("Ch{} igw command executor stopped", channel_id);
     }
+
+    /// Write a single command to the protocol.
+    async fn execute_command(
+        protocol: &mut dyn ChannelRuntime,
+        cmd: ChannelCommand,
+        channel_id: u32,
+    ) {
+        match cmd {
+            ChannelCommand::Control {
+                point_id, value, ..
+            } => {
+                // Convert to internal_id: IGW pins use PointType offset encoding
+                // to distinguish Control from Signal points with same point_id
+                let internal_id = PointType::Control.to_internal_id(point_id);
+                match protocol.write_control(&[(internal_id, value)]).await {
+                    Ok(success_count) => {
+                        if success_count > 0 {
+                            debug!("Ch{} control pt{} = {} ok", channel_id, point_id, value);
+                        } else {
+                            warn!("Ch{} control pt{} = {} failed", channel_id, point_id, value);
+                        }
+                    },
+                    Err(e) => {
+                        error!("Ch{} control pt{} err: {}", channel_id, point_id, e);
+                    },
+                }
+            },
+            ChannelCommand::Adjustment {
+                point_id, value, ..
+            } => {
+                // Convert to internal_id: IGW pins use PointType offset encoding
+                let internal_id = PointType::Adjustment.to_internal_id(point_id);
+                match protocol.write_adjustment(&[(internal_id, value)]).await {
+                    Ok(success_count) => {
+                        if success_count > 0 {
+                            debug!("Ch{} adjustment pt{} = {} ok", channel_id, point_id, value);
+                        } else {
+                            warn!(
+                                "Ch{} adjustment pt{} = {} failed",
+                                channel_id, point_id, value
+                            );
+                        }
+                    },
+                    Err(e) => {
+                        error!("Ch{} adjustment pt{} err: {}", channel_id, point_id, e);
+                    },
+                }
+            },
+        }
+    }
+}
+
+// ============================================================================
+// Command Scheduling
+// ============================================================================
+
+/// Commands written per poll boundary in priority mode before the poller
+/// gets the protocol again
+const MAX_COMMANDS_PER_POLL: usize = 16;
+
+/// Arbitration between the command executor and the polling task of one channel.
+///
+/// The protocol lock is held for a whole `poll_once()`, which igw does not
+/// split into smaller requests, so nothing is preempted. In priority mode the
+/// poller checks at each poll boundary for commands still in the channel
+/// queue or taken by the executor, and waits until they are written before
+/// starting the next poll. A command arriving during a poll still waits for
+/// that poll. The wait ends after `MAX_COMMANDS_PER_POLL` commands so a
+/// steady stream cannot stop polling.
+#[derive(Debug)]
+pub struct CommandScheduler {
+    /// Whether pending commands jump ahead of the next poll
+    priority: bool,
+    /// Channel queue feeding the executor (weak: does not keep it open)
+    queue: Option<mpsc::WeakSender<ChannelCommand>>,
+    /// Commands taken by the executor but not yet written
+    pending: AtomicUsize,
+    /// Commands written so far
+    finished: AtomicUsize,
+    /// Signalled on every written command
+    idle: Notify,
+    /// Command latency statistics
+    latency: CommandLatencyStats,
+}
+
+impl CommandScheduler {
+    pub fn new(priority: bool) -> Self {
+        Self {
+            priority,
+            queue: None,
+            pending: AtomicUsize::new(0),
+            finished: AtomicUsize::new(0),
+            idle: Notify::new(),
+            latency: CommandLatencyStats::default(),
+        }
+    }
+
+    /// Count commands still queued in `command_tx`'s channel as pending.
+    pub fn with_queue(mut self, command_tx: &mpsc::Sender<ChannelCommand>) -> Self {
+        self.queue = Some(command_tx.downgrade());
+        self
+    }
+
+    pub fn is_priority(&self) -> bool {
+        self.priority
+    }
+
+    /// Commands queued in the channel plus those taken by the executor.
+    fn outstanding(&self) -> usize {
+        // A command moving from the queue to the executor between the two
+        // reads can be missed; it then waits for one poll, as without priority
+        let queued = self
+            .queue
+            .as_ref()
+            .and_then(mpsc::WeakSender::upgrade)
+            .map_or(0, |tx| tx.max_capacity() - tx.capacity());
+        queued + self.pending.load(Ordering::Acquire)
+    }
+
+    /// Mark a command taken by the executor as pending.
+    fn begin_command(&self) {
+        self.pending.fetch_add(1, Ordering::AcqRel);
+    }
+
+    /// Record a written command and wake a waiting poller.
+    ///
+    /// `received_at` is the command's intake (TODO queue pop or API
+    /// request), so queue wait includes the time spent in the channel.
+    fn finish_command(&self, received_at: Instant, acquired: Instant) {
+        let end_to_end = received_at.elapsed();
+        self.latency
+            .record(acquired.saturating_duration_since(received_at), end_to_end);
+        self.latency.dispatch.record(end_to_end);
+        self.finished.fetch_add(1, Ordering::AcqRel);
+        self.pending.fetch_sub(1, Ordering::AcqRel);
+        self.idle.notify_waiters();
+    }
+
+    /// Wait until no command is queued or pending, or `MAX_COMMANDS_PER_POLL`
+    /// were written meanwhile (no-op outside priority mode).
+    async fn yield_to_commands(&self) {
+        if !self.priority {
+            return;
+        }
+        let start = self.finished.load(Ordering::Acquire);
+        loop {
+            let idle = self.idle.notified();
+            tokio::pin!(idle);
+            idle.as_mut().enable();
+            if self.outstanding() == 0
+                || self.finished.load(Ordering::Acquire).wrapping_sub(start)
+                    >= MAX_COMMANDS_PER_POLL
+            {
+                return;
+            }
+            idle.await;
+        }
+    }
+
+    /// Snapshot of the command latency statistics.
+    pub fn latency(&self) -> CommandLatencySnapshot {
+        self.latency.snapshot()
+    }
+
+    /// Histogram of the intake-to-written command latency.
+    pub fn dispatch_latency(&self) -> HistogramSnapshot {
+        self.latency.dispatch.snapshot()
+    }
+}
+
+/// Lock-free command latency accumulators (microseconds).
+#[derive(Debug, Default)]
+struct CommandLatencyStats {
+    count: AtomicU64,
+    queue_wait_total_us: AtomicU64,
+    queue_wait_max_us: AtomicU64,
+    end_to_end_total_us: AtomicU64,
+    end_to_end_max_us: AtomicU64,
+    /// Intake (TODO queue pop / API request) → protocol write completed
+    dispatch: LatencyHistogram,
+}
+
+impl CommandLatencyStats {
+    fn record(&self, queue_wait: Duration, end_to_end: Duration) {
+        let queue_wait_us = queue_wait.as_micros() as u64;
+        let end_to_end_us = end_to_end.as_micros() as u64;
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.queue_wait_total_us
+            .fetch_add(queue_wait_us, Ordering::Relaxed);
+        self.queue_wait_max_us
+            .fetch_max(queue_wait_us, Ordering::Relaxed);
+        self.end_to_end_total_us
+            .fetch_add(end_to_end_us, Ordering::Relaxed);
+        self.end_to_end_max_us
+            .fetch_max(end_to_end_us, Ordering::Relaxed);
+    }
+
+    fn snapshot(&self) -> CommandLatencySnapshot {
+        let count = self.count.load(Ordering::Relaxed);
+        let avg = |total: &AtomicU64| match count {
+            0 => 0,
+            n => total.load(Ordering::Relaxed) / n,
+        };
+        CommandLatencySnapshot {
+            commands: count,
+            queue_wait_avg_us: avg(&self.queue_wait_total_us),
+            queue_wait_max_us: self.queue_wait_max_us.load(Ordering::Relaxed),
+            end_to_end_avg_us: avg(&self.end_to_end_total_us),
+            end_to_end_max_us: self.end_to_end_max_us.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Command latency as reported in channel diagnostics.
+///
+/// - `queue_wait`: command intake → protocol lock acquired
+/// - `end_to_end`: command intake → protocol write completed
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct CommandLatencySnapshot {
+    pub commands: u64,
+    pub queue_wait_avg_us: u64,
+    pub queue_wait_max_us: u64,
+    pub end_to_end_avg_us: u64,
+    pub end_to_end_max_us: u64,
 }
 
 /// Run the polling task for all channels.
 ///
 /// Periodically calls poll_once() to retrieve data and write to store.
-/// The polling interval is configurable via `poll_interval_ms`.
+/// Timing (interval, phase offset, missed ticks, backoff) comes from the
+/// channel's `PollTimer`.
 async fn run_polling_task<R: Rtdb>(
     protocol: Arc<RwLock<Box<dyn ChannelRuntime>>>,
     store: Arc<RedisDataStore<R>>,
     channel_id: u32,
-    poll_interval_ms: u64,
+    mut timer: PollTimer,
+    scheduler: Arc<CommandScheduler>,
 ) {
     info!(
-        "Ch{} polling task started (interval: {}ms)",
-        channel_id, poll_interval_ms
+        "Ch{} polling task started (interval: {}ms, phase: {}ms)",
+        channel_id,
+        timer.period().as_millis(),
+        timer.stats().snapshot().phase_ms
     );
 
-    // Wait a bit for the connection to be established
-    tokio::time::sleep(tokio::time::Duration::from_millis(500)).await;
-
-    // Use configured poll interval
-    let mut interval = tokio::time::interval(tokio::time::Duration::from_millis(poll_interval_ms));
-
     // Track previous error count to detect new errors
     let mut prev_error_count: u64 = 0;
 
     loop {
-        interval.tick().await;
+        // First tick fires after the start delay plus this channel's phase offset
+        let started = timer.tick().await;
 
-        // Poll data using ChannelRuntime interface
-        let mut protocol_guard = protocol.write().await;
-        let result: PollResult = protocol_guard.poll_once().await;
+        // Let pending commands go first in priority mode
+        scheduler.yield_to_commands().await;
+
+        // Poll data using ChannelRuntime interface; the lock is released
+        // before storage so commands don't wait behind Redis writes
+        let result: PollResult = protocol.write().await.poll_once().await;
 
         // Log partial failures from poll result (before moving data)
         let failure_count = result.failures.len();
@@ -330,9 +592,10 @@ async fn run_polling_task<R: Rtdb>(
                 error!("Ch{} failed to write to Redis: {}", channel_id, e);
             }
         }
+        timer.finish(started, count > 0);
 
         // Check diagnostics for accumulated errors
-        if let Ok(diag) = protocol_guard.diagnostics().await {
+        if let Ok(diag) = protocol.read().await.diagnostics().await {
             if diag.error_count > prev_error_count {
                 let new_errors = diag.error_count - prev_error_count;
                 warn!(
@@ -800,8 +1063,6 @@ pub fn create_gpio_channel(
     channel_id: u32,
     runtime_config: &RuntimeChannelConfig,
 ) -> Box<dyn ChannelRuntime> {
-    use std::time::Duration;
-
     // Use sysfs driver - simpler and works directly with global GPIO numbers
     let mut gpio_config = GpioChannelConfig::new_sysfs("/sys/class/gpio");
 
@@ -882,9 +1143,43 @@ impl<R: Rtdb> IgwChannelWrapper<R> {
         Ok(serde_json::json!({
             "protocol_type": "igw",
             "connected": is_connected,
-            "channel_id": self.channel_id()
+            "channel_id": self.channel_id(),
+            "command_priority": self.scheduler.is_priority(),
+            "command_latency": self.scheduler.latency(),
+            "polling": self.poll_stats.snapshot(),
+            "ingest": self.store.ingest_stats(self.channel_id),
+            "read_plan": self.read_plan.as_ref().map(|plan| plan.summary())
         }))
     }
+
+    /// Hot-path latency histograms and buffer depth for `/metrics`.
+    pub fn metrics(&self) -> ChannelMetrics {
+        let (flush_latency, pending_fields) = self.store.write_buffer_metrics();
+        ChannelMetrics {
+            poll: self.poll_stats.snapshot(),
+            poll_duration: self.poll_stats.duration_histogram(),
+            write_latency: self.store.write_latency(),
+            flush_latency,
+            pending_fields,
+            command_latency: self.scheduler.dispatch_latency(),
+        }
+    }
+}
+
+/// Per-channel metrics exported by `/metrics`.
+#[derive(Debug, Clone)]
+pub struct ChannelMetrics {
+    pub poll: PollStatsSnapshot,
+    /// Poll cycle duration (tick → data stored)
+    pub poll_duration: HistogramSnapshot,
+    /// `RedisDataStore::write_batch` duration
+    pub write_latency: HistogramSnapshot,
+    /// WriteBuffer flush duration
+    pub flush_latency: HistogramSnapshot,
+    /// Fields buffered and not yet flushed
+    pub pending_fields: usize,
+    /// Command intake → protocol write completed
+    pub command_latency: HistogramSnapshot,
 }
 
 /// Drop implementation for defensive cleanup.
@@ -1414,7 +1709,10 @@ mod tests {
         let mock_clone = Arc::clone(&mock);
         let handle = tokio::spawn(async move {
             IgwChannelWrapper::<voltage_rtdb::MemoryRtdb>::run_command_executor(
-                mock_clone, rx, 1, // channel_id
+                mock_clone,
+                rx,
+                1, // channel_id
+                Arc::new(CommandScheduler::new(false)),
             )
             .await;
         });
@@ -1426,6 +1724,7 @@ mod tests {
             point_id: control_point_id,
             value: 1.0,
             timestamp: 0,
+            received_at: Instant::now(),
         })
         .await
         .unwrap();
@@ -1453,6 +1752,7 @@ mod tests {
             point_id: adjustment_point_id,
             value: 42.5,
             timestamp: 0,
+            received_at: Instant::now(),
         })
         .await
         .unwrap();
@@ -1473,6 +1773,122 @@ mod tests {
         let _ = tokio::time::timeout(tokio::time::Duration::from_millis(100), handle).await;
     }
 
+    /// Test that in priority mode the poller waits for pending commands and
+    /// that the executor records their latency.
+    #[tokio::test]
+    async fn test_priority_mode_poller_yields_to_commands() {
+        let scheduler = Arc::new(CommandScheduler::new(true));
+        let received = Instant::now();
+        scheduler.begin_command();
+
+        let poller = {
+            let scheduler = Arc::clone(&scheduler);
+            tokio::spawn(async move { scheduler.yield_to_commands().await })
+        };
+        tokio::time::sleep(tokio::time::Duration::from_millis(20)).await;
+        assert!(
+            !poller.is_finished(),
+            "poller must wait for pending command"
+        );
+
+        scheduler.finish_command(received, Instant::now());
+        tokio::time::timeout(tokio::time::Duration::from_millis(100), poller)
+            .await
+            .expect("poller resumes once commands drain")
+            .unwrap();
+
+        let latency = scheduler.latency();
+        assert_eq!(latency.commands, 1);
+        assert!(latency.queue_wait_max_us >= 20_000);
+        assert!(latency.end_to_end_max_us >= latency.queue_wait_max_us);
+
+        // Non-priority mode never blocks the poller
+        let scheduler = CommandScheduler::new(false);
+        scheduler.begin_command();
+        tokio::time::timeout(
+            tokio::time::Duration::from_millis(10),
+            scheduler.yield_to_commands(),
+        )
+        .await
+        .expect("poller ignores pending commands without priority");
+    }
+
+    /// Test that in priority mode the poller also waits for commands still
+    /// queued in the channel, not only the one the executor has taken.
+    #[tokio::test]
+    async fn test_priority_mode_poller_sees_queued_commands() {
+        let (tx, mut rx) = mpsc::channel::<ChannelCommand>(10);
+        let scheduler = Arc::new(CommandScheduler::new(true).with_queue(&tx));
+        for point_id in 1..=2 {
+            tx.send(ChannelCommand::Control {
+                command_id: format!("queued-{}", point_id),
+                point_id,
+                value: 1.0,
+                timestamp: 0,
+                received_at: Instant::now(),
+            })
+            .await
+            .unwrap();
+        }
+
+        let poller = {
+            let scheduler = Arc::clone(&scheduler);
+            tokio::spawn(async move { scheduler.yield_to_commands().await })
+        };
+        tokio::time::sleep(tokio::time::Duration::from_millis(20)).await;
+        assert!(
+            !poller.is_finished(),
+            "poller must wait for queued commands"
+        );
+
+        // Executor takes and writes the commands one by one
+        for remaining in (0..2).rev() {
+            let cmd = rx.recv().await.unwrap();
+            scheduler.begin_command();
+            scheduler.finish_command(cmd.received_at(), Instant::now());
+            tokio::time::sleep(tokio::time::Duration::from_millis(10)).await;
+            assert_eq!(poller.is_finished(), remaining == 0);
+        }
+        poller.await.unwrap();
+
+        // The weak queue handle does not keep the channel open
+        drop(tx);
+        assert!(rx.recv().await.is_none());
+    }
+
+    /// Test that a steady command stream delays the poller by at most
+    /// `MAX_COMMANDS_PER_POLL` commands, and that queue wait starts at intake.
+    #[tokio::test]
+    async fn test_priority_mode_poller_not_starved() {
+        let scheduler = Arc::new(CommandScheduler::new(true));
+        scheduler.begin_command();
+
+        let poller = {
+            let scheduler = Arc::clone(&scheduler);
+            tokio::spawn(async move { scheduler.yield_to_commands().await })
+        };
+        tokio::time::sleep(tokio::time::Duration::from_millis(10)).await;
+
+        // The next command always arrives before the previous one is written
+        let intake = Instant::now() - Duration::from_millis(50);
+        for _ in 0..MAX_COMMANDS_PER_POLL - 1 {
+            scheduler.begin_command();
+            scheduler.finish_command(intake, Instant::now());
+            tokio::task::yield_now().await;
+            assert!(!poller.is_finished());
+        }
+        scheduler.begin_command();
+        scheduler.finish_command(intake, Instant::now());
+        tokio::time::timeout(tokio::time::Duration::from_millis(100), poller)
+            .await
+            .expect("poller resumes after MAX_COMMANDS_PER_POLL commands")
+            .unwrap();
+
+        let latency = scheduler.latency();
+        assert_eq!(latency.commands, MAX_COMMANDS_PER_POLL as u64);
+        assert!(latency.queue_wait_max_us >= 50_000);
+    }
+
     /// Test the specific internal_id encoding for all four point types.
     #[test]
     fn test_internal_id_encoding_for_all_point_types() {
@@ -0,0 +1,428 @@
+//! Poll Scheduler
+//!
+//! comsrv-wide coordination of channel polling timers.
+//!
+//! - **Phase offsets**: each channel's first poll is shifted by a golden-ratio
+//!   fraction of its interval, so channels started together spread evenly
+//!   across the interval instead of firing in lockstep.
+//! - **Missed ticks**: `poll_missed_tick` selects tokio's `MissedTickBehavior`
+//!   (`skip` by default, so a slow poll never triggers a catch-up burst).
+//! - **Adaptive rate** (`poll_adaptive`): channels whose polls return no data
+//!   (offline or idle devices) back off exponentially up to
+//!   `poll_max_interval_ms`, and return to the base interval on the first
+//!   poll that yields data. Changed intervals stay on the channel's
+//!   `start + phase + k × interval` grid, so the phase offset survives.
+//! - **Metrics**: per-channel jitter, overrun, current interval and a poll
+//!   duration histogram, available via `PollScheduler::channel_stats()`,
+//!   channel diagnostics and `/metrics`.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Weak};
+use std::time::Duration;
+
+use dashmap::DashMap;
+use serde::Serialize;
+use tokio::time::{Instant, Interval, MissedTickBehavior};
+use voltage_rtdb::{HistogramSnapshot, LatencyHistogram};
+
+/// Delay before the first poll, giving connections time to be established
+pub const POLL_START_DELAY: Duration = Duration::from_millis(500);
+
+/// Default backoff ceiling as a multiple of the base interval
+const DEFAULT_MAX_INTERVAL_FACTOR: u32 = 8;
+
+/// Fractional part of the golden ratio; successive multiples are evenly spread
+const GOLDEN_RATIO_FRACTION: f64 = 0.618_033_988_749_895;
+
+/// Per-channel poll timer configuration.
+#[derive(Debug, Clone, Copy)]
+pub struct PollTimerConfig {
+    /// Base polling interval
+    pub period: Duration,
+    /// Behaviour when a poll overruns one or more ticks
+    pub missed_tick: MissedTickBehavior,
+    /// Back off on polls that return no data
+    pub adaptive: bool,
+    /// Upper bound of the adaptive interval
+    pub max_period: Duration,
+}
+
+impl PollTimerConfig {
+    /// Build from the channel's poll interval and `parameters`.
+    pub fn from_parameters(
+        poll_interval_ms: u64,
+        params: &HashMap<String, serde_json::Value>,
+    ) -> Self {
+        let period = Duration::from_millis(poll_interval_ms.max(1));
+        let missed_tick = match params.get("poll_missed_tick").and_then(|v| v.as_str()) {
+            Some("burst") => MissedTickBehavior::Burst,
+            Some("delay") => MissedTickBehavior::Delay,
+            _ => MissedTickBehavior::Skip,
+        };
+        let adaptive = params
+            .get("poll_adaptive")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false);
+        let max_period = params
+            .get("poll_max_interval_ms")
+            .and_then(|v| v.as_u64())
+            .map(Duration::from_millis)
+            .unwrap_or(period * DEFAULT_MAX_INTERVAL_FACTOR)
+            .max(period);
+
+        Self {
+            period,
+            missed_tick,
+            adaptive,
+            max_period,
+        }
+    }
+}
+
+/// comsrv-wide poll scheduler: hands out phase-offset timers and keeps a
+/// registry of their statistics for metrics export.
+#[derive(Debug, Default)]
+pub struct PollScheduler {
+    /// Number of timers handed out (drives the phase sequence)
+    timers: AtomicU64,
+    /// Live per-channel statistics
+    channels: DashMap<u32, Weak<PollStats>>,
+}
+
+impl PollScheduler {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Phase offset of the next timer within `period`.
+    fn next_phase(&self, period: Duration) -> Duration {
+        let k = self.timers.fetch_add(1, Ordering::Relaxed);
+        let fraction = (k as f64 * GOLDEN_RATIO_FRACTION).fract();
+        period.mul_f64(fraction)
+    }
+
+    /// Create the poll timer of a channel, replacing any previous registration.
+    pub fn timer(&self, channel_id: u32, config: PollTimerConfig) -> PollTimer {
+        let phase = self.next_phase(config.period);
+        let stats = Arc::new(PollStats::new(config.period, phase));
+        self.channels.insert(channel_id, Arc::downgrade(&stats));
+
+        let start = Instant::now() + POLL_START_DELAY + phase;
+        PollTimer {
+            interval: build_interval(start, config.period, config.missed_tick),
+            anchor: start,
+            period: config.period,
+            idle_streak: 0,
+            config,
+            stats,
+        }
+    }
+
+    /// Statistics of all channels with a live timer, sorted by channel id.
+    pub fn channel_stats(&self) -> Vec<(u32, PollStatsSnapshot)> {
+        self.channels.retain(|_, stats| stats.strong_count() > 0);
+        let mut stats: Vec<_> = self
+            .channels
+            .iter()
+            .filter_map(|entry| {
+                entry
+                    .value()
+                    .upgrade()
+                    .map(|s| (*entry.key(), s.snapshot()))
+            })
+            .collect();
+        stats.sort_unstable_by_key(|(channel_id, _)| *channel_id);
+        stats
+    }
+}
+
+fn build_interval(start: Instant, period: Duration, missed_tick: MissedTickBehavior) -> Interval {
+    let mut interval = tokio::time::interval_at(start, period);
+    interval.set_missed_tick_behavior(missed_tick);
+    interval
+}
+
+/// First instant of the `anchor + k × period` grid strictly after `now`.
+fn next_on_grid(anchor: Instant, period: Duration, now: Instant) -> Instant {
+    if now < anchor {
+        return anchor;
+    }
+    let period_ns = period.as_nanos().max(1);
+    let k = now.duration_since(anchor).as_nanos() / period_ns + 1;
+    anchor + Duration::from_nanos((k * period_ns).min(u64::MAX as u128) as u64)
+}
+
+/// Polling timer of one channel.
+#[derive(Debug)]
+pub struct PollTimer {
+    interval: Interval,
+    /// First tick (start delay + phase offset); all intervals stay on its grid
+    anchor: Instant,
+    /// Current (possibly backed-off) interval
+    period: Duration,
+    /// Consecutive polls without data
+    idle_streak: u32,
+    config: PollTimerConfig,
+    stats: Arc<PollStats>,
+}
+
+impl PollTimer {
+    /// Current polling interval.
+    pub fn period(&self) -> Duration {
+        self.period
+    }
+
+    /// Shared statistics handle.
+    pub fn stats(&self) -> &Arc<PollStats> {
+        &self.stats
+    }
+
+    /// Wait for the next poll; returns the actual start instant.
+    pub async fn tick(&mut self) -> Instant {
+        let scheduled = self.interval.tick().await;
+        let now = Instant::now();
+        self.stats
+            .record_jitter(now.saturating_duration_since(scheduled));
+        now
+    }
+
+    /// Record a finished poll started at `started`.
+    ///
+    /// `has_data` is false when the poll returned nothing (device offline or
+    /// idle); in adaptive mode such polls back off the interval.
+    pub fn finish(&mut self, started: Instant, has_data: bool) {
+        self.stats.record_poll(started.elapsed(), self.period);
+
+        if !self.config.adaptive {
+            return;
+        }
+        self.idle_streak = if has_data {
+            0
+        } else {
+            self.idle_streak.saturating_add(1)
+        };
+        let factor = 1u32 << self.idle_streak.min(16);
+        let period = (self.config.period * factor).min(self.config.max_period);
+        if period != self.period {
+            self.period = period;
+            self.stats.set_period(period);
+            // Backed-off periods are multiples of the base one (unless capped
+            // by a non-multiple ceiling), so the next grid point is normally
+            // at least one base period after the last tick
+            let next = next_on_grid(self.anchor, period, Instant::now());
+            self.interval = build_interval(next, period, self.config.missed_tick);
+        }
+    }
+}
+
+/// Lock-free per-channel poll statistics (microseconds unless noted).
+#[derive(Debug)]
+pub struct PollStats {
+    polls: AtomicU64,
+    overruns: AtomicU64,
+    jitter_total_us: AtomicU64,
+    jitter_max_us: AtomicU64,
+    last_duration_us: AtomicU64,
+    duration: LatencyHistogram,
+    period_ms: AtomicU64,
+    phase_ms: u64,
+}
+
+impl PollStats {
+    fn new(period: Duration, phase: Duration) -> Self {
+        Self {
+            polls: AtomicU64::new(0),
+            overruns: AtomicU64::new(0),
+            jitter_total_us: AtomicU64::new(0),
+            jitter_max_us: AtomicU64::new(0),
+            last_duration_us: AtomicU64::new(0),
+            duration: LatencyHistogram::new(),
+            period_ms: AtomicU64::new(period.as_millis() as u64),
+            phase_ms: phase.as_millis() as u64,
+        }
+    }
+
+    fn record_jitter(&self, jitter: Duration) {
+        let jitter_us = jitter.as_micros() as u64;
+        self.jitter_total_us.fetch_add(jitter_us, Ordering::Relaxed);
+        self.jitter_max_us.fetch_max(jitter_us, Ordering::Relaxed);
+    }
+
+    fn record_poll(&self, duration: Duration, period: Duration) {
+        self.polls.fetch_add(1, Ordering::Relaxed);
+        self.last_duration_us
+            .store(duration.as_micros() as u64, Ordering::Relaxed);
+        self.duration.record(duration);
+        if duration > period {
+            self.overruns.fetch_add(1, Ordering::Relaxed);
+        }
+    }
+
+    fn set_period(&self, period: Duration) {
+        self.period_ms
+            .store(period.as_millis() as u64, Ordering::Relaxed);
+    }
+
+    pub fn snapshot(&self) -> PollStatsSnapshot {
+        let polls = self.polls.load(Ordering::Relaxed);
+        PollStatsSnapshot {
+            polls,
+            overruns: self.overruns.load(Ordering::Relaxed),
+            jitter_avg_us: match polls {
+                0 => 0,
+                n => self.jitter_total_us.load(Ordering::Relaxed) / n,
+            },
+            jitter_max_us: self.jitter_max_us.load(Ordering::Relaxed),
+            last_duration_us: self.last_duration_us.load(Ordering::Relaxed),
+            interval_ms: self.period_ms.load(Ordering::Relaxed),
+            phase_ms: self.phase_ms,
+        }
+    }
+
+    /// Poll duration histogram
+    pub fn duration_histogram(&self) -> HistogramSnapshot {
+        self.duration.snapshot()
+    }
+}
+
+/// Poll statistics as reported in diagnostics and metrics.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct PollStatsSnapshot {
+    pub polls: u64,
+    /// Polls that took longer than the interval
+    pub overruns: u64,
+    /// Delay between the scheduled and actual poll start
+    pub jitter_avg_us: u64,
+    pub jitter_max_us: u64,
+    pub last_duration_us: u64,
+    /// Current interval (differs from the configured one when backed off)
+    pub interval_ms: u64,
+    /// Phase offset assigned at start
+    pub phase_ms: u64,
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // unwrap is fine in tests
+mod tests {
+    use super::*;
+
+    fn config(period_ms: u64, adaptive: bool) -> PollTimerConfig {
+        PollTimerConfig {
+            period: Duration::from_millis(period_ms),
+            missed_tick: MissedTickBehavior::Skip,
+            adaptive,
+            max_period: Duration::from_millis(period_ms * 4),
+        }
+    }
+
+    #[test]
+    fn test_phases_spread_across_interval() {
+        let scheduler = PollScheduler::new();
+        let period = Duration::from_millis(1000);
+        let mut phases: Vec<u128> = (0..10)
+            .map(|_| scheduler.next_phase(period).as_millis())
+            .collect();
+        phases.sort_unstable();
+
+        // 10 channels over 1000ms: no two closer than 50ms, none beyond the interval
+        assert!(phases.windows(2).all(|w| w[1] - w[0] >= 50));
+        assert!(phases.iter().all(|p| *p < 1000));
+    }
+
+    #[test]
+    fn test_config_from_parameters() {
+        let params: HashMap<String, serde_json::Value> = serde_json::from_value(
+            serde_json::json!({"poll_missed_tick": "delay", "poll_adaptive": true}),
+        )
+        .unwrap();
+        let config = PollTimerConfig::from_parameters(200, &params);
+
+        assert_eq!(config.period, Duration::from_millis(200));
+        assert_eq!(config.missed_tick, MissedTickBehavior::Delay);
+        assert!(config.adaptive);
+        assert_eq!(config.max_period, Duration::from_millis(1600));
+
+        let config = PollTimerConfig::from_parameters(200, &HashMap::new());
+        assert_eq!(config.missed_tick, MissedTickBehavior::Skip);
+        assert!(!config.adaptive);
+    }
+
+    #[tokio::test]
+    async fn test_adaptive_backoff_and_reset() {
+        let scheduler = PollScheduler::new();
+        let mut timer = scheduler.timer(1, config(100, true));
+
+        let started = Instant::now();
+        timer.finish(started, false);
+        assert_eq!(timer.period(), Duration::from_millis(200));
+        timer.finish(started, false);
+        timer.finish(started, false);
+        assert_eq!(timer.period(), Duration::from_millis(400)); // capped
+
+        timer.finish(started, true);
+        assert_eq!(timer.period(), Duration::from_millis(100));
+
+        let stats = scheduler.channel_stats();
+        assert_eq!(stats.len(), 1);
+        assert_eq!(stats[0].0, 1);
+        assert_eq!(stats[0].1.polls, 4);
+        assert_eq!(stats[0].1.interval_ms, 100);
+
+        assert_eq!(timer.stats().duration_histogram().count, 4);
+    }
+
+    #[test]
+    fn test_next_on_grid() {
+        let anchor = Instant::now();
+        let period = Duration::from_millis(100);
+
+        assert_eq!(next_on_grid(anchor, period, anchor), anchor + period);
+        assert_eq!(
+            next_on_grid(anchor, period, anchor + Duration::from_millis(250)),
+            anchor + Duration::from_millis(300)
+        );
+        assert_eq!(
+            next_on_grid(anchor + period, period, anchor),
+            anchor + period
+        );
+    }
+
+    #[tokio::test]
+    async fn test_period_change_keeps_phase() {
+        let scheduler = PollScheduler::new();
+        let mut timers: Vec<PollTimer> = (0..2)
+            .map(|channel_id| scheduler.timer(channel_id, config(100, true)))
+            .collect();
+
+        // Both back off and recover at the same moment
+        let now = Instant::now();
+        for timer in &mut timers {
+            timer.finish(now, false);
+            assert_eq!(timer.period(), Duration::from_millis(200));
+        }
+        for timer in &mut timers {
+            timer.finish(now, true);
+            assert_eq!(timer.period(), Duration::from_millis(100));
+        }
+
+        // Rebuilt intervals stay on each channel's phase grid, not in lockstep
+        let mut ticks = Vec::new();
+        for timer in &mut timers {
+            let scheduled = timer.interval.tick().await;
+            assert_eq!(scheduled, timer.anchor);
+            ticks.push(scheduled);
+        }
+        assert!(ticks[1].duration_since(ticks[0]) >= Duration::from_millis(50));
+    }
+
+    #[tokio::test]
+    async fn test_dropped_timer_leaves_registry() {
+        let scheduler = PollScheduler::new();
+        let timer = scheduler.timer(7, config(100, false));
+        assert_eq!(scheduler.channel_stats().len(), 1);
+
+        drop(timer);
+        assert!(scheduler.channel_stats().is_empty());
+    }
+}
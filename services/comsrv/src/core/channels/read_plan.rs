@@ -0,0 +1,302 @@
+//! Modbus Read Planner
+//!
+//! Groups a channel's Modbus points into the minimal set of read requests.
+//! The plan is computed once at channel creation and reported in channel
+//! diagnostics, because on serial buses the transaction count (not the byte
+//! count) bounds the achievable poll rate.
+//!
+//! The plan is advisory only: igw batches its reads on its own and does not
+//! accept a request plan, so the planner limits change the reported plan,
+//! not the requests put on the wire.
+//!
+//! ```text
+//! points ─→ group by (slave_id, function_code) ─→ sort by address
+//!        ─→ merge spans within `max_gap` / `max_registers` ─→ ReadPlan
+//! ```
+
+use std::collections::BTreeMap;
+use std::collections::HashMap;
+
+use igw::core::point::{DataFormat, PointConfig, ProtocolAddress};
+use serde::Serialize;
+
+/// Modbus limit for registers per read (FC03/FC04)
+pub const MAX_READ_REGISTERS: u16 = 125;
+
+/// Modbus limit for bits per read (FC01/FC02)
+pub const MAX_READ_BITS: u16 = 2000;
+
+/// Default number of unused registers tolerated between two merged spans
+pub const DEFAULT_MAX_GAP: u16 = 10;
+
+/// Planner limits, configurable per channel through `parameters`.
+///
+/// Only affect the reported plan, not how igw polls.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ReadPlanConfig {
+    /// Max unused addresses bridged when merging spans (`read_plan_max_gap`)
+    pub max_gap: u16,
+    /// Max registers per request (`read_plan_max_registers`, capped at 125)
+    pub max_registers: u16,
+}
+
+impl Default for ReadPlanConfig {
+    fn default() -> Self {
+        Self {
+            max_gap: DEFAULT_MAX_GAP,
+            max_registers: MAX_READ_REGISTERS,
+        }
+    }
+}
+
+impl ReadPlanConfig {
+    /// Load limits from channel parameters, falling back to defaults.
+    pub fn from_parameters(params: &HashMap<String, serde_json::Value>) -> Self {
+        let read_u16 = |key: &str| {
+            params
+                .get(key)
+                .and_then(|v| v.as_u64())
+                .and_then(|n| u16::try_from(n).ok())
+        };
+        let defaults = Self::default();
+        Self {
+            max_gap: read_u16("read_plan_max_gap").unwrap_or(defaults.max_gap),
+            max_registers: read_u16("read_plan_max_registers")
+                .unwrap_or(defaults.max_registers)
+                .clamp(1, MAX_READ_REGISTERS),
+        }
+    }
+
+    /// Max request length in addresses for a function code.
+    ///
+    /// Bit reads scale the register limit by 16 (one register = 16 coils).
+    fn max_len(&self, function_code: u8) -> u16 {
+        if is_bit_read(function_code) {
+            self.max_registers.saturating_mul(16).min(MAX_READ_BITS)
+        } else {
+            self.max_registers
+        }
+    }
+}
+
+/// One planned read request.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize)]
+pub struct ReadBlock {
+    pub slave_id: u8,
+    pub function_code: u8,
+    /// First address read
+    pub start: u16,
+    /// Number of registers (FC03/04) or bits (FC01/02) read
+    pub count: u16,
+    /// Points served by this request
+    pub points: usize,
+}
+
+/// Read plan for one channel: one block per request issued each poll.
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ReadPlan {
+    blocks: Vec<ReadBlock>,
+}
+
+impl ReadPlan {
+    /// Plan the reads for a channel's point configs.
+    ///
+    /// Non-Modbus points and write-only function codes are ignored.
+    pub fn build(points: &[PointConfig], config: &ReadPlanConfig) -> Self {
+        // (slave_id, function_code) → [(start, end_exclusive)]
+        let mut groups: BTreeMap<(u8, u8), Vec<(u32, u32)>> = BTreeMap::new();
+        for point in points {
+            let ProtocolAddress::Modbus(addr) = &point.address else {
+                continue;
+            };
+            if !is_read_function(addr.function_code) {
+                continue;
+            }
+            let width = if is_bit_read(addr.function_code) {
+                1
+            } else {
+                register_width(&addr.format)
+            };
+            let start = u32::from(addr.register);
+            groups
+                .entry((addr.slave_id, addr.function_code))
+                .or_default()
+                .push((start, start + width));
+        }
+
+        let mut blocks = Vec::new();
+        for ((slave_id, function_code), mut spans) in groups {
+            spans.sort_unstable();
+            let max_len = u32::from(config.max_len(function_code));
+            let max_gap = u32::from(config.max_gap);
+
+            let (mut start, mut end) = spans[0];
+            let mut count = 0usize;
+            for (span_start, span_end) in spans {
+                let merged_end = end.max(span_end);
+                if count > 0 && (span_start > end + max_gap || merged_end - start > max_len) {
+                    blocks.push(make_block(slave_id, function_code, start, end, count));
+                    start = span_start;
+                    end = span_end;
+                    count = 0;
+                } else {
+                    end = merged_end;
+                }
+                count += 1;
+            }
+            blocks.push(make_block(slave_id, function_code, start, end, count));
+        }
+
+        Self { blocks }
+    }
+
+    /// Planned read requests.
+    pub fn blocks(&self) -> &[ReadBlock] {
+        &self.blocks
+    }
+
+    /// Number of Modbus transactions per poll cycle under this plan.
+    pub fn planned_requests_per_poll(&self) -> usize {
+        self.blocks.len()
+    }
+
+    /// Number of points covered by the plan.
+    pub fn point_count(&self) -> usize {
+        self.blocks.iter().map(|b| b.points).sum()
+    }
+
+    /// Plan summary for channel diagnostics.
+    #[allow(clippy::disallowed_methods)] // json! macro internally uses unwrap
+    pub fn summary(&self) -> serde_json::Value {
+        serde_json::json!({
+            "planned_requests_per_poll": self.planned_requests_per_poll(),
+            "points": self.point_count(),
+            "blocks": self.blocks,
+        })
+    }
+}
+
+fn make_block(slave_id: u8, function_code: u8, start: u32, end: u32, points: usize) -> ReadBlock {
+    ReadBlock {
+        slave_id,
+        function_code,
+        start: start as u16,
+        count: (end - start) as u16,
+        points,
+    }
+}
+
+/// FC01-FC04 are the Modbus read function codes.
+fn is_read_function(function_code: u8) -> bool {
+    (1..=4).contains(&function_code)
+}
+
+/// FC01 (coils) and FC02 (discrete inputs) address bits, not registers.
+fn is_bit_read(function_code: u8) -> bool {
+    function_code == 1 || function_code == 2
+}
+
+/// Number of 16-bit registers occupied by a value.
+fn register_width(format: &DataFormat) -> u32 {
+    match format {
+        DataFormat::UInt32 | DataFormat::Int32 | DataFormat::Float32 => 2,
+        DataFormat::UInt64 | DataFormat::Int64 | DataFormat::Float64 => 4,
+        _ => 1,
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // unwrap is fine in tests
+mod tests {
+    use super::*;
+    use igw::core::point::{ByteOrder, ModbusAddress};
+
+    fn point(
+        id: u32,
+        slave_id: u8,
+        function_code: u8,
+        register: u16,
+        format: DataFormat,
+    ) -> PointConfig {
+        PointConfig::new(
+            id,
+            ProtocolAddress::Modbus(ModbusAddress {
+                slave_id,
+                function_code,
+                register,
+                format,
+                byte_order: ByteOrder::Abcd,
+                bit_position: None,
+            }),
+        )
+    }
+
+    #[test]
+    fn test_merges_contiguous_and_near_registers() {
+        let points = vec![
+            point(1, 1, 3, 0, DataFormat::Float32), // 0..2
+            point(2, 1, 3, 2, DataFormat::UInt16),  // 2..3
+            point(3, 1, 3, 8, DataFormat::UInt16),  // gap 5 → merged
+            point(4, 1, 3, 40, DataFormat::UInt16), // gap 31 → new block
+        ];
+        let plan = ReadPlan::build(&points, &ReadPlanConfig::default());
+
+        assert_eq!(plan.planned_requests_per_poll(), 2);
+        assert_eq!(plan.point_count(), 4);
+        assert_eq!(
+            plan.blocks()[0],
+            ReadBlock {
+                slave_id: 1,
+                function_code: 3,
+                start: 0,
+                count: 9,
+                points: 3
+            }
+        );
+        assert_eq!((plan.blocks()[1].start, plan.blocks()[1].count), (40, 1));
+    }
+
+    #[test]
+    fn test_groups_by_slave_and_function_code() {
+        let points = vec![
+            point(1, 1, 3, 0, DataFormat::UInt16),
+            point(2, 2, 3, 1, DataFormat::UInt16),
+            point(3, 1, 4, 1, DataFormat::UInt16),
+            point(4, 1, 1, 5, DataFormat::Bool),
+            point(5, 1, 6, 0, DataFormat::UInt16), // write-only FC, not planned
+        ];
+        let plan = ReadPlan::build(&points, &ReadPlanConfig::default());
+
+        assert_eq!(plan.planned_requests_per_poll(), 4);
+        assert_eq!(plan.point_count(), 4);
+    }
+
+    #[test]
+    fn test_respects_max_registers() {
+        let points: Vec<_> = (0..10)
+            .map(|i| point(i, 1, 3, (i * 2) as u16, DataFormat::Float32))
+            .collect();
+        let config = ReadPlanConfig {
+            max_gap: 0,
+            max_registers: 8,
+        };
+        let plan = ReadPlan::build(&points, &config);
+
+        // 20 registers in blocks of at most 8 → 8 + 8 + 4
+        let counts: Vec<u16> = plan.blocks().iter().map(|b| b.count).collect();
+        assert_eq!(counts, vec![8, 8, 4]);
+    }
+
+    #[test]
+    fn test_config_from_parameters() {
+        let params: HashMap<String, serde_json::Value> = serde_json::from_value(
+            serde_json::json!({"read_plan_max_gap": 0, "read_plan_max_registers": 500}),
+        )
+        .unwrap();
+        let config = ReadPlanConfig::from_parameters(&params);
+
+        assert_eq!(config.max_gap, 0);
+        assert_eq!(config.max_registers, MAX_READ_REGISTERS);
+        assert_eq!(config.max_len(1), MAX_READ_BITS);
+    }
+}
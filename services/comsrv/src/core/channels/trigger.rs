@@ -1,18 +1,15 @@
 //! Control command subscriber
 //!
-//! Responsible for subscribing to control commands from Redis and distributing them to corresponding channels for processing
+//! Responsible for subscribing to control commands from Redis and distributing them to corresponding channels for processing.
+//! The waiting itself is multiplexed across channels by [`CommandDispatcher`].
 
-use common::timeouts;
-use dashmap::mapref::entry::Entry;
-use dashmap::DashMap;
 use serde::{Deserialize, Serialize};
 use std::sync::Arc;
 use tokio::sync::mpsc;
-use tokio::task::JoinHandle;
-use tracing::{debug, error, info, warn};
-use voltage_model::{KeySpaceConfig, PointType};
+use tracing::{debug, warn};
 use voltage_rtdb::Rtdb;
 
+use super::dispatcher::{CommandDispatcher, DispatchStats};
 use super::traits::ChannelCommand;
 use crate::error::Result;
 
@@ -28,20 +25,20 @@ pub enum CommandType {
 /// Compact trigger message (minimal format for TODO queue)
 /// Contains only the core fields needed for command execution
 #[derive(Debug, Clone, Deserialize)]
-struct CompactTrigger {
+pub(super) struct CompactTrigger {
     /// Point ID
-    point_id: u32,
+    pub(super) point_id: u32,
     /// Command value
-    value: f64,
+    pub(super) value: f64,
     /// Timestamp in milliseconds
-    timestamp: i64,
+    pub(super) timestamp: i64,
 }
 
 /// Trigger message parsed from TODO queue
 /// Uses `#[serde(untagged)]` to try formats in order with single parse
 #[derive(Debug, Deserialize)]
 #[serde(untagged)]
-enum TriggerMessage {
+pub(super) enum TriggerMessage {
     /// Full format with all fields (preferred, avoids Redis lookups)
     Compact(CompactTrigger),
     /// Legacy format with only point_id (value/timestamp fetched from Redis)
@@ -95,25 +92,24 @@ pub struct CommandStatus {
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct CommandTriggerConfig {
     pub channel_id: u32,
-    /// BLPOP timeout in seconds; 0 means block forever.
-    #[serde(default = "default_timeout")]
-    pub timeout_seconds: u64,
 }
 
-fn default_timeout() -> u64 {
+/// Default BLPOP timeout of the command dispatcher in seconds
+pub(super) fn default_timeout() -> u64 {
     1 // Use a 1 second timeout to reduce connection pool contention; select! ensures timely response.
 }
 
-/// Command trigger - listen to RTDB commands and trigger protocol execution
+/// Command trigger - a channel's registration with the command dispatcher
+///
+/// The shared [`CommandDispatcher`] waits on the TODO queues (and command
+/// rings) of all channels; starting the trigger routes this channel's
+/// commands to `command_tx`, stopping or dropping it removes the route.
 pub struct CommandTrigger<R: Rtdb> {
     config: CommandTriggerConfig,
     command_tx: mpsc::Sender<ChannelCommand>,
-    shutdown_tx: tokio::sync::watch::Sender<bool>, // false = running, true = shutdown
-    _shutdown_rx_keepalive: tokio::sync::watch::Receiver<bool>, // Keep receiver alive.
-    task_handle: Option<JoinHandle<()>>,
-    rtdb: Arc<R>,
-    /// Timestamp deduplication: tracks last executed timestamp for each point
-    last_ts_map: Arc<DashMap<u32, i64>>,
+    dispatcher: Arc<CommandDispatcher<R>>,
+    /// Registration token while started
+    registration: Option<u64>,
 }
 
 impl<R: Rtdb + 'static> CommandTrigger<R> {
@@ -121,308 +117,45 @@ impl<R: Rtdb + 'static> CommandTrigger<R> {
     pub async fn new(
         config: CommandTriggerConfig,
         command_tx: mpsc::Sender<ChannelCommand>,
-        rtdb: Arc<R>,
+        dispatcher: Arc<CommandDispatcher<R>>,
     ) -> Result<Self> {
-        // Create watch channel; the initial value false means not stopped.
-        let (tx, rx) = tokio::sync::watch::channel(false);
-
         Ok(Self {
             config,
             command_tx,
-            shutdown_tx: tx,
-            _shutdown_rx_keepalive: rx,
-            task_handle: None,
-            rtdb,
-            last_ts_map: Arc::new(DashMap::new()),
+            dispatcher,
+            registration: None,
         })
     }
 
     /// Start subscription
     pub async fn start(&mut self) -> Result<()> {
-        // Use task_handle to check if it is already running.
-        if self.task_handle.is_some() {
+        if self.registration.is_some() {
             warn!("Ch{} trigger running", self.config.channel_id);
             return Ok(());
         }
 
         let channel_id = self.config.channel_id;
-
-        debug!("Ch{} trigger starting", channel_id);
-
-        // Clone necessary objects for task
-        let command_tx = self.command_tx.clone();
-        let shutdown_rx = self.shutdown_tx.subscribe();
-        let config = self.config.clone();
-        let rtdb = self.rtdb.clone();
-        let last_ts_map = self.last_ts_map.clone();
-
-        // Start ListQueue subscription task
-        let task_handle = tokio::spawn(async move {
-            let result =
-                Self::list_queue_loop(rtdb, command_tx, shutdown_rx, config, last_ts_map).await;
-
-            if let Err(e) = result {
-                error!("Ch{} trigger err: {}", channel_id, e);
-            }
-        });
-
-        self.task_handle = Some(task_handle);
+        self.registration = Some(
+            self.dispatcher
+                .register(channel_id, self.command_tx.clone()),
+        );
+        debug!("Ch{} trigger started", channel_id);
         Ok(())
     }
 
     /// Stop subscription
     pub async fn stop(&mut self) -> Result<()> {
-        // Send stop signal (true = shutdown).
-        let _ = self.shutdown_tx.send(true);
-
-        // Wait for task to finish
-        if let Some(handle) = self.task_handle.take() {
-            // Give the task some time to exit gracefully
-            match tokio::time::timeout(timeouts::SHUTDOWN_TIMEOUT, handle).await {
-                Ok(Ok(())) => debug!("Ch{} trigger stopped", self.config.channel_id),
-                Ok(Err(e)) => warn!("Trigger task err: {}", e),
-                Err(_) => warn!("Trigger timeout, force stop"),
-            }
+        if let Some(token) = self.registration.take() {
+            self.dispatcher.unregister(self.config.channel_id, token);
+            debug!("Ch{} trigger stopped", self.config.channel_id);
         }
-
         Ok(())
     }
 
-    /// List queue loop using a BLPOP blocking wait with reconnection logic.
-    async fn list_queue_loop(
-        rtdb: Arc<R>,
-        command_tx: mpsc::Sender<ChannelCommand>,
-        mut shutdown_rx: tokio::sync::watch::Receiver<bool>,
-        config: CommandTriggerConfig,
-        last_ts_map: Arc<DashMap<u32, i64>>,
-    ) -> Result<()> {
-        let channel_id = config.channel_id;
-        let timeout = config.timeout_seconds;
-
-        // Define the queues to listen to (using cached &'static config for zero allocation)
-        let keyspace = KeySpaceConfig::production_cached();
-        let control_queue = keyspace.todo_queue_key(channel_id, PointType::Control);
-        let adjustment_queue = keyspace.todo_queue_key(channel_id, PointType::Adjustment);
-
-        info!("Ch{} queues: C/A todo ({}s)", channel_id, timeout);
-
-        // Reconnection loop with failure tracking.
-        let mut reconnect_delay = timeouts::MIN_RECONNECT_DELAY;
-        let max_reconnect_delay = timeouts::MAX_RECONNECT_DELAY;
-        let mut consecutive_failures = 0u32;
-
-        loop {
-            // Check the stop signal.
-            if *shutdown_rx.borrow() {
-                debug!("Ch{} trigger stopping", channel_id);
-                break;
-            }
-
-            // Use BLPOP to block and wait for commands (fixed array: no heap allocation)
-            let queues = [control_queue.as_str(), adjustment_queue.as_str()];
-
-            let inner_loop_result: Result<()> = async {
-                loop {
-                    tokio::select! {
-                        // Listen for the stop signal.
-                        _ = shutdown_rx.changed() => {
-                            if *shutdown_rx.borrow() {
-                                return Ok(());
-                            }
-                        }
-                        // Use BLPOP to wait for commands.
-                        result = rtdb.list_blpop(&queues, timeout) => {
-                            match result {
-                                Ok(Some((queue, data_bytes))) => {
-                                    // Determine the command type.
-                                    let is_control = queue.contains(":C:");
-                                    let point_type_str = if is_control { "C" } else { "A" };
-
-                                    // ★ Parse with untagged enum (single JSON parse for both formats)
-                                    let trigger_msg: TriggerMessage = match serde_json::from_slice(&data_bytes) {
-                                        Ok(msg) => msg,
-                                        Err(e) => {
-                                            error!("Parse err q={}: {}", queue, e);
-                                            continue;
-                                        }
-                                    };
-
-                                    let (point_id, value, current_ts) = match trigger_msg {
-                                        TriggerMessage::Compact(trigger) => {
-                                            // Full format - all data in JSON
-                                            (trigger.point_id, trigger.value, trigger.timestamp)
-                                        }
-                                        TriggerMessage::Legacy { point_id } => {
-                                            // Legacy format - read value/timestamp from Redis hashes
-                                            debug!("Legacy trigger Ch{} pt{}", channel_id, point_id);
-
-                                            // Structure B: comsrv:{channel_id}:{type} for values
-                                            //              comsrv:{channel_id}:{type}:ts for timestamps
-                                            let channel_key = format!("comsrv:{}:{}", channel_id, point_type_str);
-                                            let ts_key = format!("{}:ts", channel_key);
-                                            let point_id_str = point_id.to_string(); // Pre-allocate for reuse
-
-                                            // Read timestamp from :ts hash
-                                            let current_ts: i64 = match rtdb.hash_get(&ts_key, &point_id_str).await {
-                                                Ok(Some(ts_bytes)) => {
-                                                    let ts_str = std::str::from_utf8(&ts_bytes).map_err(|e| {
-                                                        crate::error::ComSrvError::data(
-                                                            format!("Failed to parse UTF-8 timestamp: {}", e)
-                                                        )
-                                                    })?;
-                                                    match ts_str.parse() {
-                                                        Ok(ts) => ts,
-                                                        Err(e) => {
-                                                            error!("Ch{} pt{} ts parse err: {}", channel_id, point_id, e);
-                                                            continue;
-                                                        }
-                                                    }
-                                                }
-                                                Ok(None) => 0, // Treat as new command if timestamp missing
-                                                Err(e) => {
-                                                    error!("Ch{} pt{} ts read err: {}", channel_id, point_id, e);
-                                                    continue;
-                                                }
-                                            };
-
-                                            // Read value from Hash
-                                            let value: f64 = match rtdb.hash_get(&channel_key, &point_id_str).await {
-                                                Ok(Some(value_bytes)) => {
-                                                    let value_str = std::str::from_utf8(&value_bytes).map_err(|e| {
-                                                        crate::error::ComSrvError::data(
-                                                            format!("Failed to parse UTF-8 value: {}", e)
-                                                        )
-                                                    })?;
-                                                    match value_str.parse() {
-                                                        Ok(v) => v,
-                                                        Err(e) => {
-                                                            error!("Ch{} pt{} val parse err: {}", channel_id, point_id, e);
-                                                            continue;
-                                                        }
-                                                    }
-                                                }
-                                                Ok(None) => {
-                                                    error!("Ch{} pt{} no value", channel_id, point_id);
-                                                    continue;
-                                                }
-                                                Err(e) => {
-                                                    error!("Ch{} pt{} val read err: {}", channel_id, point_id, e);
-                                                    continue;
-                                                }
-                                            };
-
-                                            (point_id, value, current_ts)
-                                        }
-                                    };
-
-                                    // ★ Atomic timestamp deduplication using entry API
-                                    // This prevents race conditions where two concurrent handlers
-                                    // could both pass the check and execute the same command
-                                    let should_execute = match last_ts_map.entry(point_id) {
-                                        Entry::Occupied(mut entry) => {
-                                            if current_ts > *entry.get() {
-                                                entry.insert(current_ts);
-                                                true
-                                            } else {
-                                                debug!("Skip pt{}: ts={} (same)", point_id, current_ts);
-                                                false
-                                            }
-                                        }
-                                        Entry::Vacant(entry) => {
-                                            entry.insert(current_ts);
-                                            true
-                                        }
-                                    };
-
-                                    if !should_execute {
-                                        continue;
-                                    }
-
-                                    // ★ Timestamp changed - execute command
-                                    debug!("Exec pt{}: val={} ts={}", point_id, value, current_ts);
-
-                                    // Build metadata without json! macro to avoid clippy warnings
-                                    let mut metadata = serde_json::Map::new();
-                                    metadata.insert("trigger_source".to_string(), serde_json::Value::String("list_queue".to_string()));
-                                    metadata.insert("timestamp_ms".to_string(), serde_json::Value::Number(current_ts.into()));
-
-                                    // Build ControlCommand
-                                    let command = ControlCommand {
-                                        command_id: format!("trigger_{}_{}", channel_id, current_ts),
-                                        channel_id: Some(channel_id),
-                                        command_type: if is_control { CommandType::Control } else { CommandType::Adjustment },
-                                        point_id,
-                                        value,
-                                        timestamp: current_ts / 1000,  // Convert ms to seconds
-                                        metadata: serde_json::Value::Object(metadata),
-                                    };
-
-                                    // Convert to ChannelCommand and send
-                                    let channel_command = Self::to_channel_command(command);
-                                    if let Err(e) = command_tx.send(channel_command).await {
-                                        error!("Cmd send err: {}", e);
-                                        return Err(crate::error::ComSrvError::InternalError(
-                                            "Command channel closed".to_string()
-                                        ));
-                                    }
-                                },
-                                Ok(None) => {
-                                    // Timeout; continue the loop.
-                                    continue;
-                                },
-                                Err(e) => {
-                                    // Redis error; classify and trigger reconnection.
-                                    let error_type = classify_redis_error(&e);
-                                    error!("Ch{} BLPOP err: {} ({:?})", channel_id, e, error_type);
-                                    return Err(crate::error::ComSrvError::InternalError(
-                                        format!("Redis {:?} Ch{}: {}", error_type, channel_id, e)
-                                    ));
-                                },
-                            }
-                        }
-                    }
-                }
-            }.await;
-
-            // Process the inner loop result.
-            match inner_loop_result {
-                Ok(()) => {
-                    // Normal exit after receiving the stop signal.
-                    break;
-                },
-                Err(e) => {
-                    // Error; attempt reconnection with failure tracking.
-                    consecutive_failures += 1;
-                    warn!(
-                        "Ch{} err #{}: {}, retry {:?}",
-                        channel_id, consecutive_failures, e, reconnect_delay
-                    );
-
-                    // Log critical if too many consecutive failures
-                    if consecutive_failures >= 10 {
-                        error!(
-                            "CRITICAL: Ch{} {}x failures",
-                            channel_id, consecutive_failures
-                        );
-                    }
-
-                    // Wait before retrying with exponential backoff.
-                    tokio::select! {
-                        _ = tokio::time::sleep(reconnect_delay) => {
-                            reconnect_delay = (reconnect_delay * 2).min(max_reconnect_delay);
-                        }
-                        _ = shutdown_rx.changed() => {
-                            if *shutdown_rx.borrow() {
-                                debug!("Ch{} backoff stop", channel_id);
-                                break;
-                            }
-                        }
-                    }
-                },
-            }
-        }
-
-        Ok(())
+    /// Dispatch counters of this channel (None while stopped)
+    pub fn stats(&self) -> Option<DispatchStats> {
+        self.registration
+            .and(self.dispatcher.stats(self.config.channel_id))
     }
 
     /// Parse command data with unified deserialization logic.
@@ -487,19 +220,21 @@ impl<R: Rtdb + 'static> CommandTrigger<R> {
     }
 
     /// Convert to ChannelCommand.
-    fn to_channel_command(command: ControlCommand) -> ChannelCommand {
+    pub(super) fn to_channel_command(command: ControlCommand) -> ChannelCommand {
         match command.command_type {
             CommandType::Control => ChannelCommand::Control {
                 command_id: command.command_id,
                 point_id: command.point_id,
                 value: command.value,
                 timestamp: command.timestamp,
+                received_at: std::time::Instant::now(),
             },
             CommandType::Adjustment => ChannelCommand::Adjustment {
                 command_id: command.command_id,
                 point_id: command.point_id,
                 value: command.value,
                 timestamp: command.timestamp,
+                received_at: std::time::Instant::now(),
             },
         }
     }
@@ -508,7 +243,7 @@ impl<R: Rtdb + 'static> CommandTrigger<R> {
 }
 
 /// Classify Redis error types for better debugging
-fn classify_redis_error(error: &dyn std::fmt::Display) -> &'static str {
+pub(super) fn classify_redis_error(error: &dyn std::fmt::Display) -> &'static str {
     let error_str = error.to_string().to_lowercase();
 
     if error_str.contains("timeout") {
@@ -528,18 +263,8 @@ fn classify_redis_error(error: &dyn std::fmt::Display) -> &'static str {
 
 impl<R: Rtdb> Drop for CommandTrigger<R> {
     fn drop(&mut self) {
-        // Send stop signal.
-        let _ = self.shutdown_tx.send(true);
-
-        // If the task is still running, abort it as a fallback.
-        if let Some(handle) = self.task_handle.take() {
-            if !handle.is_finished() {
-                warn!(
-                    "CommandTrigger for channel {} dropped with running task, aborting",
-                    self.config.channel_id
-                );
-                handle.abort();
-            }
+        if let Some(token) = self.registration.take() {
+            self.dispatcher.unregister(self.config.channel_id, token);
         }
     }
 }
@@ -907,12 +632,8 @@ mod tests {
 
     #[test]
     fn test_command_trigger_config_creation() {
-        let config = CommandTriggerConfig {
-            channel_id: 3001,
-            timeout_seconds: 60,
-        };
+        let config = CommandTriggerConfig { channel_id: 3001 };
 
         assert_eq!(config.channel_id, 3001);
-        assert_eq!(config.timeout_seconds, 60);
     }
 }
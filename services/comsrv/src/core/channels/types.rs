@@ -6,6 +6,7 @@
 use serde::{Deserialize, Serialize};
 use std::borrow::Cow;
 use std::collections::HashMap;
+use std::time::Instant;
 
 use crate::core::config::FourRemote;
 
@@ -240,6 +241,8 @@ pub enum ChannelCommand {
         point_id: u32,
         value: f64,
         timestamp: i64,
+        /// When comsrv took the command in (TODO queue pop or API request)
+        received_at: Instant,
     },
     /// Adjustment command (YT)
     Adjustment {
@@ -247,9 +250,21 @@ pub enum ChannelCommand {
         point_id: u32,
         value: f64,
         timestamp: i64,
+        /// When comsrv took the command in (TODO queue pop or API request)
+        received_at: Instant,
     },
 }
 
+impl ChannelCommand {
+    /// When comsrv took the command in (start of the command latency histogram)
+    pub fn received_at(&self) -> Instant {
+        match self {
+            ChannelCommand::Control { received_at, .. }
+            | ChannelCommand::Adjustment { received_at, .. } => *received_at,
+        }
+    }
+}
+
 /// Batch telemetry data for channel transmission
 #[derive(Debug, Clone)]
 pub struct TelemetryBatch {
@@ -45,6 +45,7 @@ pub use types::{
     IecMapping,
     ModbusMapping,
     Point,
+    PointDeadband,
     ProtocolQueries,
     RuntimeChannelConfig,
     SignalPoint,
@@ -58,6 +59,7 @@ pub use types::{
     CHANNEL_ROUTING_TABLE,
     CONTROL_POINTS_TABLE,
     DEFAULT_PORT,
+    POINT_DEADBANDS_TABLE,
     SERVICE_CONFIG_TABLE,
     SIGNAL_POINTS_TABLE,
     SYNC_METADATA_TABLE,
@@ -4,13 +4,13 @@
 
 use crate::core::config::Point;
 use crate::core::config::{
-    AdjustmentPoint, AppConfig, ChannelConfig, ControlPoint, RuntimeChannelConfig, ServiceConfig,
-    SignalPoint, TelemetryPoint,
+    AdjustmentPoint, AppConfig, ChannelConfig, ControlPoint, PointDeadband, RuntimeChannelConfig,
+    ServiceConfig, SignalPoint, TelemetryPoint,
 };
 #[cfg(test)]
 use crate::core::config::{
-    ADJUSTMENT_POINTS_TABLE, CHANNELS_TABLE, CONTROL_POINTS_TABLE, SERVICE_CONFIG_TABLE,
-    SIGNAL_POINTS_TABLE, TELEMETRY_POINTS_TABLE,
+    ADJUSTMENT_POINTS_TABLE, CHANNELS_TABLE, CONTROL_POINTS_TABLE, POINT_DEADBANDS_TABLE,
+    SERVICE_CONFIG_TABLE, SIGNAL_POINTS_TABLE, TELEMETRY_POINTS_TABLE,
 };
 use crate::error::{ComSrvError, Result};
 use common::sqlite::ServiceConfigLoader;
@@ -19,7 +19,8 @@ use sqlx::{Row, SqlitePool};
 use std::collections::HashMap;
 use std::path::Path;
 use std::sync::Arc;
-use tracing::info;
+use tracing::{info, warn};
+use voltage_model::PointType;
 
 /// Comsrv-specific SQLite configuration loader
 pub struct ComsrvSqliteLoader {
@@ -109,6 +110,7 @@ impl ComsrvSqliteLoader {
         let redis = crate::core::config::RedisConfig {
             url: service_config.redis_url.clone(),
             enabled: true,
+            ..Default::default()
         };
 
         // Load channels
@@ -447,6 +449,8 @@ impl ComsrvSqliteLoader {
             runtime_config.adjustment_points.push(point);
         }
 
+        runtime_config.deadbands = self.load_point_deadbands(channel_id).await?;
+
         info!(
             "Loaded {} points for channel {}: {} telemetry, {} signal, {} control, {} adjustment",
             runtime_config.telemetry_points.len()
@@ -462,6 +466,57 @@ impl ComsrvSqliteLoader {
 
         Ok(())
     }
+
+    /// Load the ingest deadbands of a channel from `point_deadbands`.
+    ///
+    /// The table is optional: databases created before it existed yield no
+    /// deadbands, so every point is written.
+    async fn load_point_deadbands(&self, channel_id: u32) -> Result<Vec<PointDeadband>> {
+        let rows = match sqlx::query(
+            "SELECT point_type, point_id, absolute, percent, heartbeat_secs
+             FROM point_deadbands
+             WHERE channel_id = ?",
+        )
+        .bind(channel_id as i64)
+        .fetch_all(self.pool())
+        .await
+        {
+            Ok(rows) => rows,
+            Err(e) if e.to_string().contains("no such table") => return Ok(Vec::new()),
+            Err(e) => {
+                return Err(ComSrvError::ConfigError(format!(
+                    "Failed to load point deadbands: {}",
+                    e
+                )))
+            },
+        };
+
+        let mut deadbands = Vec::with_capacity(rows.len());
+        for row in rows {
+            let point_type: String = row.try_get("point_type").unwrap_or_default();
+            let Some(point_type) = PointType::from_str(&point_type) else {
+                warn!(
+                    "Ch{} deadband with invalid point_type '{}' ignored",
+                    channel_id, point_type
+                );
+                continue;
+            };
+            let point_id: i64 = row
+                .try_get("point_id")
+                .map_err(|e| ComSrvError::ConfigError(format!("Failed to get point_id: {}", e)))?;
+            deadbands.push(PointDeadband {
+                point_type,
+                point_id: point_id as u32,
+                absolute: row.try_get("absolute").unwrap_or(0.0),
+                percent: row.try_get("percent").unwrap_or(0.0),
+                heartbeat_secs: row
+                    .try_get::<i64, _>("heartbeat_secs")
+                    .map(|secs| secs.clamp(0, i64::from(u32::MAX)) as u32)
+                    .unwrap_or(0),
+            });
+        }
+        Ok(deadbands)
+    }
 }
 
 #[cfg(test)]
@@ -703,6 +758,51 @@ mod tests {
         assert!(mappings_json.contains("100"));
     }
 
+    #[tokio::test]
+    async fn test_load_point_deadbands() {
+        let (_temp_dir, db_path) = create_test_database().await;
+        let loader = ComsrvSqliteLoader::new(&db_path).await.unwrap();
+        let config = loader.load_config().await.unwrap();
+        let channel = config.channels.into_iter().next().unwrap();
+
+        // Table missing (older database): no deadbands
+        let mut runtime_config = RuntimeChannelConfig::from_base((*channel).clone());
+        loader
+            .load_runtime_channel_points(&mut runtime_config)
+            .await
+            .unwrap();
+        assert!(runtime_config.deadbands.is_empty());
+
+        sqlx::query(POINT_DEADBANDS_TABLE)
+            .execute(loader.pool())
+            .await
+            .unwrap();
+        sqlx::query(
+            "INSERT INTO point_deadbands (channel_id, point_type, point_id, absolute, percent, heartbeat_secs) VALUES
+                (1001, 'T', 1, 0.5, 0.0, 30),
+                (1001, 'X', 2, 1.0, 0.0, 0),
+                (1002, 'T', 1, 9.0, 0.0, 0)",
+        )
+        .execute(loader.pool())
+        .await
+        .unwrap();
+
+        loader
+            .load_runtime_channel_points(&mut runtime_config)
+            .await
+            .unwrap();
+        assert_eq!(
+            runtime_config.deadbands,
+            vec![PointDeadband {
+                point_type: PointType::Telemetry,
+                point_id: 1,
+                absolute: 0.5,
+                percent: 0.0,
+                heartbeat_secs: 30,
+            }]
+        );
+    }
+
     #[tokio::test]
     async fn test_load_runtime_channel_points_virtual() {
         let (_temp_dir, db_path) = create_test_database().await;
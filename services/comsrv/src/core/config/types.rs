@@ -120,6 +120,35 @@ impl ChannelConfig {
     pub fn is_enabled(&self) -> bool {
         self.core.enabled
     }
+
+    /// Shared-memory history depth per point type [T, S, C, A]
+    ///
+    /// From the `history_depth` parameter: a number applies to T and S
+    /// points, an object such as `{"T": 64, "S": 16}` sets depths per type.
+    pub fn history_depths(&self) -> [usize; 4] {
+        let mut depths = [0usize; 4];
+        match self.parameters.get("history_depth") {
+            Some(serde_json::Value::Number(n)) => {
+                let depth = n.as_u64().unwrap_or(0) as usize;
+                depths[0] = depth;
+                depths[1] = depth;
+            },
+            Some(serde_json::Value::Object(per_type)) => {
+                for (key, value) in per_type {
+                    let index = match PointType::from_str(key) {
+                        Some(PointType::Telemetry) => 0,
+                        Some(PointType::Signal) => 1,
+                        Some(PointType::Control) => 2,
+                        Some(PointType::Adjustment) => 3,
+                        None => continue,
+                    };
+                    depths[index] = value.as_u64().unwrap_or(0) as usize;
+                }
+            },
+            _ => {},
+        }
+        depths
+    }
 }
 
 /// Channels table record
@@ -464,6 +493,52 @@ pub const CONTROL_POINTS_TABLE: &str = ControlPointRecord::CREATE_TABLE_SQL;
 /// Adjustment points table SQL (generated by Schema macro)
 pub const ADJUSTMENT_POINTS_TABLE: &str = AdjustmentPointRecord::CREATE_TABLE_SQL;
 
+// ────────────────────── Point Deadband Table ──────────────────────
+
+/// Point deadbands table record
+/// Optional per-point ingest filtering: points without a row are always written
+#[allow(dead_code)]
+#[derive(Schema)]
+#[table(
+    name = "point_deadbands",
+    suffix = "PRIMARY KEY (channel_id, point_type, point_id)"
+)]
+struct PointDeadbandRecord {
+    #[column(not_null, references = "channels(channel_id)")]
+    channel_id: u32,
+
+    #[column(not_null)]
+    point_type: String, // T/S/C/A
+
+    #[column(not_null)]
+    point_id: u32,
+
+    #[column(default = "0.0")]
+    absolute: f64,
+
+    #[column(default = "0.0")]
+    percent: f64,
+
+    #[column(default = "0")]
+    heartbeat_secs: u32,
+}
+
+/// Point deadbands table SQL (generated by Schema macro)
+pub const POINT_DEADBANDS_TABLE: &str = PointDeadbandRecord::CREATE_TABLE_SQL;
+
+/// Ingest deadband of one point (row of `point_deadbands`)
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PointDeadband {
+    pub point_type: PointType,
+    pub point_id: u32,
+    /// Suppress changes with |Δ| <= absolute
+    pub absolute: f64,
+    /// Suppress changes with |Δ| <= percent% of the stored value
+    pub percent: f64,
+    /// Force a write after this many seconds without one (0 = never)
+    pub heartbeat_secs: u32,
+}
+
 // ────────────────────── Channel Routing Table ──────────────────────
 
 /// Channel routing table record (C2C routing)
@@ -691,6 +766,9 @@ pub struct RuntimeChannelConfig {
 
     /// Adjustment points (with embedded protocol_mappings JSON)
     pub adjustment_points: Vec<AdjustmentPoint>,
+
+    /// Ingest deadbands (from `point_deadbands`)
+    pub deadbands: Vec<PointDeadband>,
     // Protocol mappings are now embedded in each point's protocol_mappings field
 }
 
@@ -708,6 +786,7 @@ impl RuntimeChannelConfig {
             signal_points: Vec::new(),
             control_points: Vec::new(),
             adjustment_points: Vec::new(),
+            deadbands: Vec::new(),
         }
     }
 
@@ -1434,4 +1513,27 @@ channels:
         );
         assert_eq!(config.channels.len(), 0);
     }
+
+    #[test]
+    fn test_channel_history_depths() {
+        let yaml = r#"
+channels:
+  - id: 1
+    name: "uniform"
+    protocol: "virtual"
+    parameters:
+      history_depth: 32
+  - id: 2
+    name: "per_type"
+    protocol: "virtual"
+    parameters:
+      history_depth: { T: 64, A: 8 }
+  - id: 3
+    name: "none"
+    protocol: "virtual"
+"#;
+        let config: ComsrvConfig = serde_yaml::from_str(yaml).unwrap();
+        let depths: Vec<[usize; 4]> = config.channels.iter().map(|c| c.history_depths()).collect();
+        assert_eq!(depths, vec![[32, 32, 0, 0], [64, 0, 0, 8], [0, 0, 0, 0]]);
+    }
 }
@@ -22,6 +22,7 @@ pub mod api {
         pub mod control_handlers;
         pub mod health;
         pub mod mapping_handlers;
+        pub mod metrics_handlers;
         pub mod point_handlers;
         pub mod protocol_handlers;
     }
@@ -54,6 +55,7 @@ pub mod runtime {
     pub mod cleanup_provider;
     pub mod lifecycle;
     pub mod reconnect;
+    pub mod shared_memory;
 
     #[cfg(test)]
     pub mod test_utils;
@@ -61,10 +63,12 @@ pub mod runtime {
     // Re-export common types
     pub use cleanup_provider::ComsrvCleanupProvider;
     pub use lifecycle::{
-        shutdown_handler, shutdown_services, start_cleanup_task, start_communication_service,
-        wait_for_shutdown,
+        shutdown_handler, shutdown_services, shutdown_services_generic, start_cleanup_task,
+        start_cleanup_task_generic, start_communication_service,
+        start_communication_service_generic, start_snapshot_task, wait_for_shutdown,
     };
     pub use reconnect::{ReconnectContext, ReconnectError, ReconnectHelper, ReconnectPolicy};
+    pub use shared_memory::{load_shared_config, open_shared_writer};
 }
 
 // Re-export dto at crate root for compatibility
@@ -10,7 +10,7 @@ use clap::Parser;
 #[cfg(feature = "swagger-ui")]
 use comsrv::api::routes::ComsrvApiDoc;
 use tokio_util::sync::CancellationToken;
-use tracing::{debug, error, info};
+use tracing::{error, info};
 #[cfg(feature = "swagger-ui")]
 use utoipa::OpenApi;
 #[cfg(feature = "swagger-ui")]
@@ -33,11 +33,14 @@ use comsrv::{
         config::ConfigManager,
     },
     error::ComSrvError,
-    runtime::{start_cleanup_task, start_communication_service},
+    runtime::{
+        load_shared_config, open_shared_writer, start_cleanup_task, start_communication_service,
+        start_snapshot_task,
+    },
     shutdown_services, wait_for_shutdown,
 };
 use voltage_routing::load_routing_maps;
-use voltage_rtdb::{is_shm_available, ChannelToSlotIndex, SharedConfig, SharedVecRtdbWriter};
+use voltage_rtdb::default_snapshot_path;
 
 #[tokio::main]
 async fn main() -> VoltageResult<()> {
@@ -96,13 +99,25 @@ async fn main() -> VoltageResult<()> {
 
     let (redis_url, redis_client) = common::bootstrap_database::setup_redis_with_config(
         Some(app_config.redis.url.clone()),
-        redis_config,
+        redis_config.clone(),
     )
     .await?;
 
     // ============ Phase 1: Create initial rtdb for cleanup ============
     // Reuse the existing connection pool instead of creating a new one
-    let redis_rtdb = voltage_rtdb::RedisRtdb::from_client(redis_client.clone());
+    let redis_rtdb = if app_config.redis.shard_urls.is_empty() {
+        voltage_rtdb::RedisRtdb::from_client(redis_client.clone())
+    } else {
+        let shards = common::bootstrap_database::setup_redis_shards(
+            redis_client.clone(),
+            &app_config.redis.shard_urls,
+            redis_config,
+        )
+        .await?;
+        info!("Redis keyspace sharded over {} servers", shards.len());
+        voltage_rtdb::RedisRtdb::from_shards(shards)
+            .map_err(|e| ComSrvError::ConfigError(e.to_string()))?
+    };
 
     // Perform Redis cleanup first (before loading routing)
     info!("Performing Redis cleanup based on database configuration...");
@@ -141,193 +156,9 @@ async fn main() -> VoltageResult<()> {
     // ============ Phase 2.5: Initialize shared memory (optional) ============
     // SharedVecRtdbWriter provides zero-copy cross-process data sharing via tmpfs
     // Load SharedConfig from global config (SQLite key-value table)
-    let (shared_writer, channel_index) = {
-        // Load SharedConfig parameters from database
-        let config = {
-            let mut cfg = SharedConfig::default();
-
-            // Helper to load usize value from service_config
-            async fn load_usize(pool: &sqlx::SqlitePool, key: &str) -> Option<usize> {
-                sqlx::query_scalar::<_, String>(&format!(
-                    "SELECT value FROM service_config WHERE service_name = 'global' AND key = '{}'",
-                    key
-                ))
-                .fetch_optional(pool)
-                .await
-                .ok()
-                .flatten()
-                .and_then(|s| s.parse().ok())
-            }
-
-            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.max_instances").await {
-                cfg = cfg.with_max_instances(v);
-            }
-            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.max_points_per_instance").await
-            {
-                cfg = cfg.with_max_points_per_instance(v);
-            }
-            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.max_channels").await {
-                cfg = cfg.with_max_channels(v);
-            }
-            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.max_points_per_channel").await
-            {
-                cfg = cfg.with_max_points_per_channel(v);
-            }
-
-            debug!(
-                "SharedConfig: max_instances={}, max_channels={}, points_per_inst={}, points_per_ch={}",
-                cfg.max_instances, cfg.max_channels, cfg.max_points_per_instance, cfg.max_points_per_channel
-            );
-            cfg
-        };
-        if is_shm_available(&config) {
-            match SharedVecRtdbWriter::open(&config) {
-                Ok(mut writer) => {
-                    // Register all instances with both Measurement and Action points
-                    // Measurement points from C2M routing (Channel → Instance)
-                    let mut measurements: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-                    for ((_, _, _), target) in routing_cache.c2m_iter() {
-                        measurements
-                            .entry(target.instance_id)
-                            .or_default()
-                            .push(target.point_id);
-                    }
-
-                    // Action points from M2C routing (Instance → Channel)
-                    let mut actions: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-                    for ((instance_id, _, point_id), _) in routing_cache.m2c_iter() {
-                        actions.entry(instance_id).or_default().push(point_id);
-                    }
-
-                    // Merge all instance IDs and register with both point types
-                    let all_instances: std::collections::HashSet<u32> =
-                        measurements.keys().chain(actions.keys()).copied().collect();
-                    let mut registered_count = 0;
-                    let mut total_m_points = 0;
-                    let mut total_a_points = 0;
-                    for instance_id in all_instances {
-                        let m_points = measurements
-                            .get(&instance_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-                        let a_points = actions
-                            .get(&instance_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-                        if let Err(e) = writer.register_instance(instance_id, m_points, a_points) {
-                            tracing::warn!("Failed to register instance {}: {}", instance_id, e);
-                        } else {
-                            registered_count += 1;
-                            total_m_points += m_points.len();
-                            total_a_points += a_points.len();
-                        }
-                    }
-                    info!(
-                        "SharedMemory: registered {} instances ({} M + {} A points)",
-                        registered_count, total_m_points, total_a_points
-                    );
-
-                    // Register all channels with T/S/C/A points
-                    // Collect channel points from routing
-                    let mut ch_telemetry: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-                    let mut ch_signal: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-                    let mut ch_control: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-                    let mut ch_adjustment: std::collections::HashMap<u32, Vec<u32>> =
-                        std::collections::HashMap::new();
-
-                    // C2M routing gives us T/S points (uplink: Channel → Instance)
-                    for ((channel_id, point_type, point_id), _) in routing_cache.c2m_iter() {
-                        match point_type {
-                            voltage_model::PointType::Telemetry => {
-                                ch_telemetry.entry(channel_id).or_default().push(point_id);
-                            },
-                            voltage_model::PointType::Signal => {
-                                ch_signal.entry(channel_id).or_default().push(point_id);
-                            },
-                            _ => {}, // C2M should only have T/S
-                        }
-                    }
-
-                    // M2C routing gives us C/A points (downlink: Instance → Channel)
-                    for (_, target) in routing_cache.m2c_iter() {
-                        match target.point_type {
-                            voltage_model::PointType::Control => {
-                                ch_control
-                                    .entry(target.channel_id)
-                                    .or_default()
-                                    .push(target.point_id);
-                            },
-                            voltage_model::PointType::Adjustment => {
-                                ch_adjustment
-                                    .entry(target.channel_id)
-                                    .or_default()
-                                    .push(target.point_id);
-                            },
-                            _ => {}, // M2C should only have C/A
-                        }
-                    }
-
-                    // Register all channels
-                    let all_channels: std::collections::HashSet<u32> = ch_telemetry
-                        .keys()
-                        .chain(ch_signal.keys())
-                        .chain(ch_control.keys())
-                        .chain(ch_adjustment.keys())
-                        .copied()
-                        .collect();
-
-                    let mut ch_count = 0;
-                    let mut ch_points = 0;
-                    for channel_id in all_channels {
-                        let t = ch_telemetry
-                            .get(&channel_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-                        let s = ch_signal
-                            .get(&channel_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-                        let c = ch_control
-                            .get(&channel_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-                        let a = ch_adjustment
-                            .get(&channel_id)
-                            .map(|v| v.as_slice())
-                            .unwrap_or(&[]);
-
-                        if let Err(e) = writer.register_channel(channel_id, t, s, c, a) {
-                            tracing::warn!("Failed to register channel {}: {}", channel_id, e);
-                        } else {
-                            ch_count += 1;
-                            ch_points += t.len() + s.len() + c.len() + a.len();
-                        }
-                    }
-                    info!(
-                        "SharedMemory: registered {} channels ({} T/S/C/A points)",
-                        ch_count, ch_points
-                    );
-
-                    // Build pre-computed channel → slot direct mapping
-                    let index = ChannelToSlotIndex::build(&routing_cache, &writer);
-                    info!("SharedMemory initialized: {} channel mappings", index.len());
-                    (Some(Arc::new(writer)), Some(Arc::new(index)))
-                },
-                Err(e) => {
-                    tracing::warn!("SharedMemory not available: {}", e);
-                    (None, None)
-                },
-            }
-        } else {
-            info!("SharedMemory path not found, skipping (non-Docker environment)");
-            (None, None)
-        }
-    };
+    let (shared_config, snapshot_interval_secs) = load_shared_config(&sqlite_pool).await;
+    let (shared_writer, channel_index) =
+        open_shared_writer(&shared_config, &routing_cache, &app_config.channels).unzip();
 
     // CommandTxCache for O(1) hot path access
     // Bypasses ChannelManager RwLock for Control/Adjustment writes
@@ -337,6 +168,19 @@ async fn main() -> VoltageResult<()> {
     // Initialize services
     let shutdown_token = CancellationToken::new();
 
+    // Periodic warm-start snapshots of the shared memory slots
+    if let Some(writer) = shared_writer
+        .as_ref()
+        .filter(|_| snapshot_interval_secs > 0)
+    {
+        start_snapshot_task(
+            Arc::clone(writer),
+            default_snapshot_path(),
+            std::time::Duration::from_secs(snapshot_interval_secs as u64),
+            shutdown_token.clone(),
+        );
+    }
+
     // Use concrete type (native AFIT requires static dispatch)
     let rtdb: Arc<voltage_rtdb::RedisRtdb> = Arc::new(redis_rtdb);
 
@@ -344,7 +188,7 @@ async fn main() -> VoltageResult<()> {
     // Lock-free architecture - no RwLock wrapper needed
     // Removed VecRtdb - SharedMemory + Redis two-tier architecture
     let channel_manager = Arc::new(ChannelManager::with_shared_memory(
-        rtdb,
+        Arc::clone(&rtdb),
         routing_cache,
         sqlite_pool.clone(),
         shared_writer,
@@ -385,7 +229,7 @@ async fn main() -> VoltageResult<()> {
     set_service_start_time(chrono::Utc::now());
     let app = create_api_routes(
         Arc::clone(&channel_manager),
-        redis_client,
+        Arc::clone(&rtdb),
         sqlite_pool,
         Arc::clone(&command_tx_cache),
     );
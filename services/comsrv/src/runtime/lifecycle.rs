@@ -6,10 +6,11 @@
 use crate::core::channels::ChannelManager;
 use crate::core::config::ConfigManager;
 use crate::error::Result;
+use std::path::PathBuf;
 use std::sync::Arc;
 use tokio_util::sync::CancellationToken;
 use tracing::{debug, error, info, warn};
-use voltage_rtdb::{RedisRtdb, Rtdb};
+use voltage_rtdb::{RedisRtdb, Rtdb, SharedVecRtdbWriter};
 
 /// Start the communication service with optimized performance and monitoring
 ///
@@ -97,10 +98,10 @@ pub async fn start_communication_service(
 }
 
 /// Generic version of start_communication_service that accepts any Rtdb implementation.
-/// Used by tests with MemoryRtdb.
+/// Used by tests with MemoryRtdb and by the embedded single-process host.
 ///
 /// # Lock-free channel_manager
-pub(crate) async fn start_communication_service_generic<R: Rtdb + 'static>(
+pub async fn start_communication_service_generic<R: Rtdb + 'static>(
     config_manager: Arc<ConfigManager>,
     channel_manager: Arc<ChannelManager<R>>,
 ) -> Result<usize> {
@@ -306,12 +307,10 @@ pub async fn shutdown_handler(channel_manager: Arc<ChannelManager<RedisRtdb>>) {
 }
 
 /// Generic version of shutdown_handler that accepts any Rtdb implementation.
-/// Used by tests with MemoryRtdb.
+/// Used by tests with MemoryRtdb and by the embedded single-process host.
 ///
 /// # Lock-free channel_manager
-pub(crate) async fn shutdown_handler_generic<R: Rtdb + 'static>(
-    channel_manager: Arc<ChannelManager<R>>,
-) {
+pub async fn shutdown_handler_generic<R: Rtdb + 'static>(channel_manager: Arc<ChannelManager<R>>) {
     info!("Starting graceful shutdown...");
 
     // Get all channel IDs (Direct access without RwLock)
@@ -465,10 +464,10 @@ pub fn start_cleanup_task(
 }
 
 /// Generic version of start_cleanup_task that accepts any Rtdb implementation.
-/// Used by tests with MemoryRtdb.
+/// Used by tests with MemoryRtdb and by the embedded single-process host.
 ///
 /// # Lock-free channel_manager
-pub(crate) fn start_cleanup_task_generic<R: Rtdb + 'static>(
+pub fn start_cleanup_task_generic<R: Rtdb + 'static>(
     channel_manager: Arc<ChannelManager<R>>,
     configured_count: usize,
 ) -> (tokio::task::JoinHandle<()>, CancellationToken) {
@@ -523,6 +522,51 @@ pub(crate) fn start_cleanup_task_generic<R: Rtdb + 'static>(
     (handle, token)
 }
 
+/// Start periodic warm-start snapshots of the shared memory RTDB
+///
+/// Every `interval` the writer's slots are captured and written atomically
+/// to `path`; a final snapshot is taken when `shutdown_token` is cancelled,
+/// so a graceful restart resumes from the latest values.
+pub fn start_snapshot_task(
+    writer: Arc<SharedVecRtdbWriter>,
+    path: PathBuf,
+    interval: std::time::Duration,
+    shutdown_token: CancellationToken,
+) -> tokio::task::JoinHandle<()> {
+    info!(
+        "Shared memory snapshots every {}s to {:?}",
+        interval.as_secs(),
+        path
+    );
+
+    tokio::spawn(async move {
+        let mut ticker = tokio::time::interval(interval);
+        // First tick completes immediately; nothing worth saving yet
+        ticker.tick().await;
+
+        loop {
+            let shutting_down = tokio::select! {
+                _ = ticker.tick() => false,
+                () = shutdown_token.cancelled() => true,
+            };
+
+            let writer = Arc::clone(&writer);
+            let path = path.clone();
+            let result =
+                tokio::task::spawn_blocking(move || writer.snapshot().write_to(&path)).await;
+            match result {
+                Ok(Ok(())) => debug!("Shared memory snapshot written"),
+                Ok(Err(e)) => warn!("Shared memory snapshot failed: {:#}", e),
+                Err(e) => warn!("Shared memory snapshot task failed: {}", e),
+            }
+
+            if shutting_down {
+                break;
+            }
+        }
+    })
+}
+
 /// Wait for shutdown signal (Ctrl+C or SIGTERM on Unix)
 ///
 /// Re-exports the common shutdown handler for backwards compatibility.
@@ -553,10 +597,10 @@ pub async fn shutdown_services(
 }
 
 /// Generic version of shutdown_services that accepts any Rtdb implementation.
-/// Used by tests with MemoryRtdb.
+/// Used by tests with MemoryRtdb and by the embedded single-process host.
 ///
 /// # Lock-free channel_manager
-pub(crate) async fn shutdown_services_generic<R: Rtdb + 'static>(
+pub async fn shutdown_services_generic<R: Rtdb + 'static>(
     channel_manager: Arc<ChannelManager<R>>,
     shutdown_token: CancellationToken,
     cleanup_token: CancellationToken,
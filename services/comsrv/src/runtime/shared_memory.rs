@@ -0,0 +1,253 @@
+//! Shared memory segment setup
+//!
+//! Opens the `SharedVecRtdbWriter` segment, registers every routed channel and
+//! instance, and restores the warm-start snapshot. Used by the comsrv binary
+//! and by the embedded single-process host.
+
+use std::sync::Arc;
+
+use tracing::{debug, info};
+use voltage_rtdb::{
+    default_snapshot_path, is_shm_available, ChannelToSlotIndex, RoutingCache, RtdbSnapshot,
+    SharedConfig, SharedVecRtdbWriter, DEFAULT_SNAPSHOT_INTERVAL_SECS,
+};
+
+use crate::core::config::ChannelConfig;
+
+/// Load the shared memory layout from the global config (SQLite key-value table)
+///
+/// Returns the segment configuration and the warm-start snapshot interval in
+/// seconds (0 disables periodic snapshots).
+pub async fn load_shared_config(sqlite_pool: &sqlx::SqlitePool) -> (SharedConfig, usize) {
+    let mut cfg = SharedConfig::default();
+
+    // Helper to load usize value from service_config
+    async fn load_usize(pool: &sqlx::SqlitePool, key: &str) -> Option<usize> {
+        sqlx::query_scalar::<_, String>(&format!(
+            "SELECT value FROM service_config WHERE service_name = 'global' AND key = '{}'",
+            key
+        ))
+        .fetch_optional(pool)
+        .await
+        .ok()
+        .flatten()
+        .and_then(|s| s.parse().ok())
+    }
+
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.max_instances").await {
+        cfg = cfg.with_max_instances(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.max_points_per_instance").await {
+        cfg = cfg.with_max_points_per_instance(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.max_channels").await {
+        cfg = cfg.with_max_channels(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.max_points_per_channel").await {
+        cfg = cfg.with_max_points_per_channel(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.change_ring_capacity").await {
+        cfg = cfg.with_change_ring_capacity(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.command_ring_capacity").await {
+        cfg = cfg.with_command_ring_capacity(v);
+    }
+    if let Some(v) = load_usize(sqlite_pool, "shared_memory.history_capacity").await {
+        cfg = cfg.with_history_capacity(v);
+    }
+    // Warm-start snapshot interval (0 disables periodic snapshots)
+    let snapshot_interval_secs = load_usize(sqlite_pool, "shared_memory.snapshot_interval_secs")
+        .await
+        .unwrap_or(DEFAULT_SNAPSHOT_INTERVAL_SECS);
+
+    debug!(
+        "SharedConfig: max_instances={}, max_channels={}, points_per_inst={}, points_per_ch={}",
+        cfg.max_instances,
+        cfg.max_channels,
+        cfg.max_points_per_instance,
+        cfg.max_points_per_channel
+    );
+    (cfg, snapshot_interval_secs)
+}
+
+/// Open the shared memory writer and register all routed channels and instances
+///
+/// Returns `None` when the segment path is unavailable (non-Docker
+/// environment) or cannot be opened; callers then fall back to RTDB-only writes.
+pub fn open_shared_writer(
+    config: &SharedConfig,
+    routing_cache: &RoutingCache,
+    channels: &[Arc<ChannelConfig>],
+) -> Option<(Arc<SharedVecRtdbWriter>, Arc<ChannelToSlotIndex>)> {
+    if is_shm_available(config) {
+        match SharedVecRtdbWriter::open(config) {
+            Ok(mut writer) => {
+                // Register all instances with both Measurement and Action points
+                // Measurement points from C2M routing (Channel → Instance)
+                let mut measurements: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+                for ((_, _, _), target) in routing_cache.c2m_iter() {
+                    measurements
+                        .entry(target.instance_id)
+                        .or_default()
+                        .push(target.point_id);
+                }
+
+                // Action points from M2C routing (Instance → Channel)
+                let mut actions: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+                for ((instance_id, _, point_id), _) in routing_cache.m2c_iter() {
+                    actions.entry(instance_id).or_default().push(point_id);
+                }
+
+                // Merge all instance IDs and register with both point types
+                let all_instances: std::collections::HashSet<u32> =
+                    measurements.keys().chain(actions.keys()).copied().collect();
+                let mut registered_count = 0;
+                let mut total_m_points = 0;
+                let mut total_a_points = 0;
+                for instance_id in all_instances {
+                    let m_points = measurements
+                        .get(&instance_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+                    let a_points = actions
+                        .get(&instance_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+                    if let Err(e) = writer.register_instance(instance_id, m_points, a_points) {
+                        tracing::warn!("Failed to register instance {}: {}", instance_id, e);
+                    } else {
+                        registered_count += 1;
+                        total_m_points += m_points.len();
+                        total_a_points += a_points.len();
+                    }
+                }
+                info!(
+                    "SharedMemory: registered {} instances ({} M + {} A points)",
+                    registered_count, total_m_points, total_a_points
+                );
+
+                // Register all channels with T/S/C/A points
+                // Collect channel points from routing
+                let mut ch_telemetry: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+                let mut ch_signal: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+                let mut ch_control: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+                let mut ch_adjustment: std::collections::HashMap<u32, Vec<u32>> =
+                    std::collections::HashMap::new();
+
+                // C2M routing gives us T/S points (uplink: Channel → Instance)
+                for ((channel_id, point_type, point_id), _) in routing_cache.c2m_iter() {
+                    match point_type {
+                        voltage_model::PointType::Telemetry => {
+                            ch_telemetry.entry(channel_id).or_default().push(point_id);
+                        },
+                        voltage_model::PointType::Signal => {
+                            ch_signal.entry(channel_id).or_default().push(point_id);
+                        },
+                        _ => {}, // C2M should only have T/S
+                    }
+                }
+
+                // M2C routing gives us C/A points (downlink: Instance → Channel)
+                for (_, target) in routing_cache.m2c_iter() {
+                    match target.point_type {
+                        voltage_model::PointType::Control => {
+                            ch_control
+                                .entry(target.channel_id)
+                                .or_default()
+                                .push(target.point_id);
+                        },
+                        voltage_model::PointType::Adjustment => {
+                            ch_adjustment
+                                .entry(target.channel_id)
+                                .or_default()
+                                .push(target.point_id);
+                        },
+                        _ => {}, // M2C should only have C/A
+                    }
+                }
+
+                // Per-channel history ring depths (`history_depth` parameter)
+                let history_depths: std::collections::HashMap<u32, [usize; 4]> = channels
+                    .iter()
+                    .map(|channel| (channel.id(), channel.history_depths()))
+                    .collect();
+
+                // Register all channels
+                let all_channels: std::collections::HashSet<u32> = ch_telemetry
+                    .keys()
+                    .chain(ch_signal.keys())
+                    .chain(ch_control.keys())
+                    .chain(ch_adjustment.keys())
+                    .copied()
+                    .collect();
+
+                let mut ch_count = 0;
+                let mut ch_points = 0;
+                for channel_id in all_channels {
+                    let t = ch_telemetry
+                        .get(&channel_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+                    let s = ch_signal
+                        .get(&channel_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+                    let c = ch_control
+                        .get(&channel_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+                    let a = ch_adjustment
+                        .get(&channel_id)
+                        .map(|v| v.as_slice())
+                        .unwrap_or(&[]);
+
+                    let history = history_depths.get(&channel_id).copied().unwrap_or([0; 4]);
+                    if let Err(e) =
+                        writer.register_channel_with_history(channel_id, t, s, c, a, history)
+                    {
+                        tracing::warn!("Failed to register channel {}: {}", channel_id, e);
+                    } else {
+                        ch_count += 1;
+                        ch_points += t.len() + s.len() + c.len() + a.len();
+                    }
+                }
+                info!(
+                    "SharedMemory: registered {} channels ({} T/S/C/A points)",
+                    ch_count, ch_points
+                );
+
+                // Build pre-computed channel → slot direct mapping
+                let index = ChannelToSlotIndex::build(routing_cache, &writer);
+                info!("SharedMemory initialized: {} channel mappings", index.len());
+
+                // Warm start: restored points are marked RESTORED until polled
+                let snapshot_path = default_snapshot_path();
+                if snapshot_path.exists() {
+                    match RtdbSnapshot::read_from(&snapshot_path) {
+                        Ok(snapshot) => info!(
+                            "SharedMemory: restored {}/{} points from {:?}",
+                            writer.restore_snapshot(&snapshot),
+                            snapshot.records.len(),
+                            snapshot_path
+                        ),
+                        Err(e) => tracing::warn!("SharedMemory snapshot ignored: {:#}", e),
+                    }
+                }
+
+                Some((Arc::new(writer), Arc::new(index)))
+            },
+            Err(e) => {
+                tracing::warn!("SharedMemory not available: {}", e);
+                None
+            },
+        }
+    } else {
+        info!("SharedMemory path not found, skipping (non-Docker environment)");
+        None
+    }
+}
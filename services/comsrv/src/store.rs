@@ -18,6 +18,8 @@
 //! Note: Data transformation (scale/offset/reverse) is now handled by IGW's
 //! TransformConfig in poll_once(), so RedisDataStore receives pre-transformed values.
 
+mod ingest_filter;
 mod redis_store;
 
-pub use redis_store::RedisDataStore;
+pub use ingest_filter::{IngestFilter, IngestFilterStats};
+pub use redis_store::{RedisDataStore, DEFAULT_HISTORY_STREAM_MAX_LEN};
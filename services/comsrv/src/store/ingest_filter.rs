@@ -0,0 +1,268 @@
+//! Ingest filtering (deadband / change-only)
+//!
+//! Decides per point whether a polled value is worth writing. Suppressed
+//! values skip the shared-memory write, the WriteBuffer, C2M fan-out and
+//! subscriber notification.
+//!
+//! A value is written when:
+//! - the point has no stored value yet, or
+//! - the heartbeat interval elapsed since the last write, or
+//! - |new - stored| exceeds the deadband, `max(absolute, percent% × |stored|)`;
+//!   a zero deadband means change-only (any bit-level change is written).
+//!
+//! The stored value is read from the channel's `PointSlot` in shared memory;
+//! without shared memory the filter keeps its own last-written cache.
+
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use dashmap::DashMap;
+use serde::Serialize;
+use voltage_model::PointType;
+use voltage_routing::ChannelPointUpdate;
+use voltage_rtdb::SharedVecRtdbWriter;
+
+use crate::core::config::{PointDeadband, RuntimeChannelConfig};
+
+/// Default heartbeat for channel-wide change-only filtering (seconds)
+pub const DEFAULT_HEARTBEAT_SECS: u32 = 60;
+
+/// Filtering rule of one point.
+#[derive(Debug, Clone, Copy, PartialEq)]
+struct Rule {
+    absolute: f64,
+    percent: f64,
+    heartbeat_ms: u64,
+}
+
+impl Rule {
+    fn admits(&self, stored: Option<(f64, u64)>, value: f64, now_ms: u64) -> bool {
+        let Some((stored_value, stored_ts)) = stored else {
+            return true;
+        };
+        if self.heartbeat_ms > 0 && now_ms.saturating_sub(stored_ts) >= self.heartbeat_ms {
+            return true;
+        }
+        let deadband = self.absolute.max(self.percent / 100.0 * stored_value.abs());
+        if deadband > 0.0 {
+            (value - stored_value).abs() > deadband
+        } else {
+            value.to_bits() != stored_value.to_bits()
+        }
+    }
+}
+
+impl From<&PointDeadband> for Rule {
+    fn from(deadband: &PointDeadband) -> Self {
+        Self {
+            absolute: deadband.absolute.max(0.0),
+            percent: deadband.percent.max(0.0),
+            heartbeat_ms: u64::from(deadband.heartbeat_secs) * 1000,
+        }
+    }
+}
+
+/// Per-channel ingest filter.
+#[derive(Debug)]
+pub struct IngestFilter {
+    /// Per-point rules from `point_deadbands`
+    rules: HashMap<(PointType, u32), Rule>,
+    /// Channel-wide change-only rule (`change_only` parameter)
+    default_rule: Option<Rule>,
+    /// Last written (value, timestamp_ms), used only without shared memory
+    last_written: DashMap<(PointType, u32), (f64, u64)>,
+    written: AtomicU64,
+    suppressed: AtomicU64,
+}
+
+impl IngestFilter {
+    /// Build the filter of a channel; `None` if it filters nothing.
+    ///
+    /// Per-point rules come from `point_deadbands`. The `change_only` channel
+    /// parameter enables change-only filtering for all other points, with a
+    /// heartbeat of `heartbeat_secs` (default 60s, 0 = never).
+    pub fn from_runtime_config(runtime_config: &RuntimeChannelConfig) -> Option<Self> {
+        let params = &runtime_config.base.parameters;
+        let default_rule = params
+            .get("change_only")
+            .and_then(|v| v.as_bool())
+            .unwrap_or(false)
+            .then(|| Rule {
+                absolute: 0.0,
+                percent: 0.0,
+                heartbeat_ms: params
+                    .get("heartbeat_secs")
+                    .and_then(|v| v.as_u64())
+                    .unwrap_or(u64::from(DEFAULT_HEARTBEAT_SECS))
+                    * 1000,
+            });
+        let rules: HashMap<_, _> = runtime_config
+            .deadbands
+            .iter()
+            .map(|d| ((d.point_type, d.point_id), Rule::from(d)))
+            .collect();
+
+        if rules.is_empty() && default_rule.is_none() {
+            return None;
+        }
+        Some(Self {
+            rules,
+            default_rule,
+            last_written: DashMap::new(),
+            written: AtomicU64::new(0),
+            suppressed: AtomicU64::new(0),
+        })
+    }
+
+    /// Whether `update` should be written.
+    ///
+    /// `shared` is the shared-memory writer holding the channel's point slots;
+    /// without it the filter compares against its own last-written cache.
+    pub fn admit(
+        &self,
+        update: &ChannelPointUpdate,
+        shared: Option<&SharedVecRtdbWriter>,
+        now_ms: u64,
+    ) -> bool {
+        let key = (update.point_type, update.point_id);
+        let Some(rule) = self.rules.get(&key).or(self.default_rule.as_ref()) else {
+            self.written.fetch_add(1, Ordering::Relaxed);
+            return true;
+        };
+
+        let stored = match shared {
+            Some(writer) => writer
+                .get_channel_consistent(update.channel_id, update.point_type, update.point_id)
+                .filter(|snapshot| snapshot.timestamp > 0)
+                .map(|snapshot| (snapshot.value, snapshot.timestamp)),
+            None => self.last_written.get(&key).map(|entry| *entry.value()),
+        };
+
+        if rule.admits(stored, update.value, now_ms) {
+            if shared.is_none() {
+                self.last_written.insert(key, (update.value, now_ms));
+            }
+            self.written.fetch_add(1, Ordering::Relaxed);
+            true
+        } else {
+            self.suppressed.fetch_add(1, Ordering::Relaxed);
+            false
+        }
+    }
+
+    /// Written/suppressed counters.
+    pub fn stats(&self) -> IngestFilterStats {
+        IngestFilterStats {
+            written: self.written.load(Ordering::Relaxed),
+            suppressed: self.suppressed.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Ingest filter counters as reported in channel diagnostics.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct IngestFilterStats {
+    pub written: u64,
+    pub suppressed: u64,
+}
+
+#[cfg(test)]
+#[allow(clippy::disallowed_methods)] // unwrap is fine in tests
+mod tests {
+    use super::*;
+    use crate::core::config::{ChannelConfig, ChannelCore};
+
+    fn runtime_config(
+        parameters: serde_json::Value,
+        deadbands: Vec<PointDeadband>,
+    ) -> RuntimeChannelConfig {
+        let mut config = RuntimeChannelConfig::from_base(ChannelConfig {
+            core: ChannelCore {
+                id: 1,
+                name: "filter".to_string(),
+                description: None,
+                protocol: "virtual".to_string(),
+                enabled: true,
+            },
+            parameters: serde_json::from_value(parameters).unwrap(),
+            logging: Default::default(),
+        });
+        config.deadbands = deadbands;
+        config
+    }
+
+    fn update(point_id: u32, value: f64) -> ChannelPointUpdate {
+        ChannelPointUpdate {
+            channel_id: 1,
+            point_type: PointType::Telemetry,
+            point_id,
+            value,
+            raw_value: None,
+            cascade_depth: 0,
+        }
+    }
+
+    #[test]
+    fn test_no_filter_without_configuration() {
+        let config = runtime_config(serde_json::json!({}), Vec::new());
+        assert!(IngestFilter::from_runtime_config(&config).is_none());
+    }
+
+    #[test]
+    fn test_absolute_and_percent_deadband() {
+        let config = runtime_config(
+            serde_json::json!({}),
+            vec![
+                PointDeadband {
+                    point_type: PointType::Telemetry,
+                    point_id: 1,
+                    absolute: 0.5,
+                    percent: 0.0,
+                    heartbeat_secs: 0,
+                },
+                PointDeadband {
+                    point_type: PointType::Telemetry,
+                    point_id: 2,
+                    absolute: 0.0,
+                    percent: 10.0,
+                    heartbeat_secs: 0,
+                },
+            ],
+        );
+        let filter = IngestFilter::from_runtime_config(&config).unwrap();
+
+        assert!(filter.admit(&update(1, 10.0), None, 1_000));
+        assert!(!filter.admit(&update(1, 10.4), None, 2_000));
+        assert!(filter.admit(&update(1, 10.6), None, 3_000));
+
+        assert!(filter.admit(&update(2, 100.0), None, 1_000));
+        assert!(!filter.admit(&update(2, 109.0), None, 2_000));
+        assert!(filter.admit(&update(2, 111.0), None, 3_000));
+
+        // Points without a rule are always written
+        assert!(filter.admit(&update(3, 1.0), None, 1_000));
+        assert!(filter.admit(&update(3, 1.0), None, 2_000));
+
+        assert_eq!(
+            filter.stats(),
+            IngestFilterStats {
+                written: 6,
+                suppressed: 2
+            }
+        );
+    }
+
+    #[test]
+    fn test_change_only_with_heartbeat() {
+        let config = runtime_config(
+            serde_json::json!({"change_only": true, "heartbeat_secs": 5}),
+            Vec::new(),
+        );
+        let filter = IngestFilter::from_runtime_config(&config).unwrap();
+
+        assert!(filter.admit(&update(1, 1.0), None, 0));
+        assert!(!filter.admit(&update(1, 1.0), None, 4_999));
+        assert!(filter.admit(&update(1, 1.0), None, 5_000)); // heartbeat
+        assert!(filter.admit(&update(1, 1.5), None, 5_100)); // changed
+    }
+}
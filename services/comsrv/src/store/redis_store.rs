@@ -30,12 +30,18 @@ use igw::core::error::Result as IgwResult;
 use igw::core::point::PointConfig;
 use igw::core::traits::{DataEvent, DataEventReceiver, DataEventSender};
 
+use super::ingest_filter::{IngestFilter, IngestFilterStats};
 use voltage_model::{KeySpaceConfig, PointType};
 use voltage_routing::ChannelPointUpdate;
+
 use voltage_rtdb::{
-    ChannelToSlotIndex, RoutingCache, Rtdb, SharedVecRtdbWriter, WriteBuffer, WriteBufferConfig,
+    ChannelToSlotIndex, HistogramSnapshot, LatencyHistogram, RoutingCache, Rtdb,
+    SharedVecRtdbWriter, WriteBuffer, WriteBufferConfig,
 };
 
+/// Default approximate length cap of the history streams (`history_stream_max_len`)
+pub const DEFAULT_HISTORY_STREAM_MAX_LEN: usize = 100_000;
+
 /// Redis-backed data store for VoltageEMS.
 ///
 /// This is the bridge between IGW protocols and the VoltageEMS Redis storage.
@@ -64,6 +70,8 @@ pub struct RedisDataStore<R: Rtdb> {
     channel_index: Option<Arc<ChannelToSlotIndex>>,
     /// Point configurations cache (channel_id -> Arc<configs> for O(1) clone)
     point_configs: DashMap<u32, Arc<Vec<PointConfig>>>,
+    /// Per-channel deadband / change-only filters (channels without one write every point)
+    ingest_filters: DashMap<u32, Arc<IngestFilter>>,
     /// Single broadcast sender for all subscribers (avoids clone * N)
     event_sender: DataEventSender,
     /// KeySpace configuration
@@ -72,6 +80,8 @@ pub struct RedisDataStore<R: Rtdb> {
     flush_handle: RwLock<Option<tokio::task::JoinHandle<()>>>,
     /// Shutdown signal for flush task
     shutdown_notify: Arc<Notify>,
+    /// Duration of `write_batch` calls that reached the write path
+    write_latency: LatencyHistogram,
 }
 
 impl<R: Rtdb> RedisDataStore<R> {
@@ -93,10 +103,12 @@ impl<R: Rtdb> RedisDataStore<R> {
             shared_writer: None,
             channel_index: None,
             point_configs: DashMap::new(),
+            ingest_filters: DashMap::new(),
             event_sender,
             key_config: KeySpaceConfig::production(),
             flush_handle: RwLock::new(None),
             shutdown_notify: Arc::new(Notify::new()),
+            write_latency: LatencyHistogram::new(),
         }
     }
 
@@ -117,6 +129,14 @@ impl<R: Rtdb> RedisDataStore<R> {
         self
     }
 
+    /// Export flushed channel and C2M-routed instance changes to the
+    /// history streams consumed by hissrv (see `WriteBuffer::with_history_stream`).
+    pub fn with_history_stream(mut self, max_len: usize) -> Self {
+        self.write_buffer =
+            Arc::new(WriteBuffer::new(WriteBufferConfig::default()).with_history_stream(max_len));
+        self
+    }
+
     /// Start the background flush task for the write buffer.
     ///
     /// The task runs until `shutdown()` is called or the store is dropped.
@@ -158,6 +178,19 @@ impl<R: Rtdb> RedisDataStore<R> {
         }
     }
 
+    /// Latency of batch writes (ingest filter, shared memory, buffering and routing)
+    pub fn write_latency(&self) -> HistogramSnapshot {
+        self.write_latency.snapshot()
+    }
+
+    /// Write buffer flush latency and current depth (pending fields)
+    pub fn write_buffer_metrics(&self) -> (HistogramSnapshot, usize) {
+        (
+            self.write_buffer.stats().flush_latency.snapshot(),
+            self.write_buffer.pending_fields(),
+        )
+    }
+
     /// Convert DataBatch to ChannelPointUpdates for voltage-routing.
     ///
     /// The internal_id from IGW encodes both point type and original point_id.
@@ -223,9 +256,40 @@ impl<R: Rtdb> RedisDataStore<R> {
         if batch.is_empty() {
             return Ok(());
         }
+        let started = std::time::Instant::now();
 
         // Convert to ChannelPointUpdates (values already transformed by IGW)
-        let updates = self.batch_to_updates(channel_id, &batch);
+        let mut updates = self.batch_to_updates(channel_id, &batch);
+
+        // Drop unchanged / in-deadband points before any write or fan-out
+        let filter = self
+            .ingest_filters
+            .get(&channel_id)
+            .map(|f| Arc::clone(f.value()));
+        let batch = match filter {
+            Some(filter) => {
+                let now_ms = std::time::SystemTime::now()
+                    .duration_since(std::time::UNIX_EPOCH)
+                    .map(|d| d.as_millis() as u64)
+                    .unwrap_or(0);
+                let shared = self.shared_writer.as_deref();
+
+                let mut admitted = DataBatch::default();
+                let mut kept = Vec::with_capacity(updates.len());
+                for (point, update) in batch.iter().zip(updates) {
+                    if filter.admit(&update, shared, now_ms) {
+                        admitted.add(point.clone());
+                        kept.push(update);
+                    }
+                }
+                if kept.is_empty() {
+                    return Ok(());
+                }
+                updates = kept;
+                admitted
+            },
+            None => batch,
+        };
 
         // Select write path: prefer shared memory direct write for best performance
         let _stats = if let (Some(writer), Some(index)) = (&self.shared_writer, &self.channel_index)
@@ -246,6 +310,7 @@ impl<R: Rtdb> RedisDataStore<R> {
                 updates,
             )
         };
+        self.write_latency.record(started.elapsed());
 
         // Notify subscribers - wrap batch in Arc for 0.2.18 API
         self.notify_subscribers(DataEvent::DataUpdate(Arc::new(batch)));
@@ -328,6 +393,18 @@ impl<R: Rtdb> RedisDataStore<R> {
         self.point_configs.insert(channel_id, Arc::new(configs));
     }
 
+    /// Install the ingest filter of a channel, replacing any previous one.
+    pub fn set_ingest_filter(&self, channel_id: u32, filter: IngestFilter) {
+        self.ingest_filters.insert(channel_id, Arc::new(filter));
+    }
+
+    /// Ingest filter counters of a channel, if it has a filter.
+    pub fn ingest_stats(&self, channel_id: u32) -> Option<IngestFilterStats> {
+        self.ingest_filters
+            .get(&channel_id)
+            .map(|filter| filter.stats())
+    }
+
     /// Get all point configurations for a channel (O(1) Arc clone instead of Vec clone).
     pub fn get_all_point_configs(&self, channel_id: u32) -> Arc<Vec<PointConfig>> {
         self.point_configs
@@ -351,6 +428,7 @@ impl<R: Rtdb> RedisDataStore<R> {
 
         // Clear configs
         self.point_configs.remove(&channel_id);
+        self.ingest_filters.remove(&channel_id);
 
         Ok(())
     }
@@ -26,6 +26,8 @@ class Settings(BaseSettings):
     REDIS_DB: int = 0
     REDIS_PASSWORD: Optional[str] = None
     REDIS_PREFIX: str = "hissrv:"
+    # comsrv/modsrv的Redis分片列表；本服务只连接单个Redis，设置后拒绝启动
+    REDIS_SHARD_URLS: str = ""
     
     # 开发环境Redis设置（通过.env文件覆盖）
     # REDIS_HOST: str = "192.168.30.62"  # 开发环境
@@ -176,6 +176,10 @@ class ConfigLoader:
         """获取Redis订阅模式"""
         return self.get_config('redis_source.subscribe_patterns', [])
     
+    def is_stream_collection_enabled(self) -> bool:
+        """是否通过历史变化流（Redis Stream）收集数据"""
+        return self.get_config('redis_source.stream.enabled', False)
+    
 
 # 全局配置加载器实例
 config_loader = ConfigLoader()
@@ -11,6 +11,9 @@ class RedisManager:
     """Redis连接管理器"""
     
     def __init__(self):
+        if settings.REDIS_SHARD_URLS.strip():
+            # 通道/实例键按ID分布在多个分片上，单连接只能读到分片0
+            raise RuntimeError("历史数据服务不支持Redis分片（REDIS_SHARD_URLS），请在单Redis部署下运行")
         self.redis_client: Optional[redis.Redis] = None
         self._connect()
     
@@ -2,7 +2,7 @@
 InfluxDB数据库连接模块
 """
 
-from influxdb_client import InfluxDBClient, Point
+from influxdb_client import InfluxDBClient, Point, WritePrecision
 from influxdb_client.client.write_api import SYNCHRONOUS, ASYNCHRONOUS
 from typing import Optional, List, Dict, Any
 from loguru import logger
@@ -188,6 +188,17 @@ class InfluxDBManager:
             logger.error(f"批量写入数据点失败: {e}")
         return False
     
+    def write_lines(self, lines: List[str]) -> bool:
+        """批量写入行协议数据（毫秒时间戳）"""
+        try:
+            if self.write_api and lines:
+                self.write_api.write(bucket=self._get_bucket_name(), record=lines,
+                                     write_precision=WritePrecision.MS)
+                return True
+        except Exception as e:
+            logger.error(f"批量写入行协议数据失败: {e}")
+        return False
+    
     def query_data(self, query: str) -> List[Dict[str, Any]]:
         """查询数据"""
         try:
@@ -15,6 +15,7 @@ from loguru import logger
 from ..core.config import settings
 from ..core.config_loader import config_loader
 from ..services.data_collector import data_collector
+from ..services.stream_collector import stream_collector
 from ..services.data_storage import data_storage
 from ..services.query_service import query_service
 
@@ -70,14 +71,21 @@ class SchedulerService:
         if self.scheduler_thread and self.scheduler_thread.is_alive():
             self.scheduler_thread.join(timeout=5)
         
+        stream_collector.stop()
+        
         # 清除所有任务
         schedule.clear()
         logger.info("定时任务服务已停止")
     
     def _setup_schedules(self):
         """设置定时任务"""
+        # 历史变化流消费（替代轮询收集）
+        if config_loader.is_scheduler_task_enabled('data_collection') and \
+                config_loader.is_stream_collection_enabled():
+            stream_collector.start()
+            logger.info("使用历史变化流收集数据，跳过轮询收集任务")
         # 数据收集任务（收集到缓冲区）
-        if config_loader.is_scheduler_task_enabled('data_collection'):
+        elif config_loader.is_scheduler_task_enabled('data_collection'):
             collection_interval = config_loader.get_data_collection_interval()
             schedule.every(collection_interval).seconds.do(self._collect_data_to_buffer)
             logger.info(f"设置数据收集任务，间隔: {collection_interval} 秒")
@@ -366,7 +374,8 @@ class SchedulerService:
                 job.job_func.__name__: job.next_run 
                 for job in schedule.jobs
             } if schedule.jobs else {},
-            "job_count": len(schedule.jobs)
+            "job_count": len(schedule.jobs),
+            "stream": stream_collector.get_status()
         }
     
 
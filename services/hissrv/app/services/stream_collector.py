@@ -0,0 +1,208 @@
+"""
+历史数据流消费服务
+通过消费者组读取comsrv写入的历史变化流（Redis Stream），
+按batch_size批量转换为InfluxDB行协议写入
+
+流条目格式（comsrv WriteBuffer每次flush写入）:
+    key=<值Hash键，如 inst:1:M>  ts=<毫秒时间戳>  <point_id>=<值> ...
+"""
+
+import math
+import threading
+import time
+from datetime import datetime
+from typing import Any, Dict, List, Optional
+
+from loguru import logger
+
+from ..core.config_loader import config_loader
+from ..core.database import redis_manager
+from ..core.influxdb import influxdb_manager
+from ..services.data_collector import data_collector
+
+# 流条目中的系统字段
+KEY_FIELD = "key"
+TS_FIELD = "ts"
+
+
+def _escape_tag(value: str) -> str:
+    """转义行协议标签值（逗号、等号、空格）"""
+    return value.replace(",", r"\,").replace("=", r"\=").replace(" ", r"\ ")
+
+
+def _escape_measurement(value: str) -> str:
+    """转义行协议measurement名称（逗号、空格）"""
+    return value.replace(",", r"\,").replace(" ", r"\ ")
+
+
+def entry_to_lines(fields: Dict[str, str]) -> List[str]:
+    """将一个流条目转换为InfluxDB行协议（毫秒精度）
+
+    标签与轮询路径（data_storage.create_point_from_history_data）保持一致:
+    measurement为键的第一段，标签为redis_key/point_id/source
+    """
+    redis_key = fields.get(KEY_FIELD)
+    ts = fields.get(TS_FIELD)
+    if not redis_key or not ts:
+        return []
+
+    source = redis_key.split(':')[0]
+    prefix = (f"{_escape_measurement(source)},redis_key={_escape_tag(redis_key)},"
+              f"point_id=")
+    suffix = f",source={_escape_tag(source)}"
+
+    lines = []
+    for point_id, value in fields.items():
+        if point_id in (KEY_FIELD, TS_FIELD):
+            continue
+        try:
+            numeric_value = float(value)
+        except (ValueError, TypeError):
+            continue
+        if not math.isfinite(numeric_value):
+            continue
+        lines.append(f"{prefix}{_escape_tag(point_id)}{suffix} value={numeric_value!r} {ts}")
+    return lines
+
+
+class StreamCollector:
+    """历史变化流消费者"""
+
+    def __init__(self):
+        self.redis_client = redis_manager.get_client()
+        self.streams: List[str] = config_loader.get_config('redis_source.stream.keys', ['inst:history'])
+        self.group: str = config_loader.get_config('redis_source.stream.group', 'hissrv')
+        self.consumer: str = config_loader.get_config('redis_source.stream.consumer', 'hissrv-1')
+        self.block_ms: int = config_loader.get_config('redis_source.stream.block_ms', 1000)
+        self.batch_size: int = config_loader.get_data_batch_size()
+        self.flush_interval: float = config_loader.get_data_flush_interval()
+
+        self.is_running = False
+        self.thread: Optional[threading.Thread] = None
+
+        # 待写入的行协议及其对应的待确认条目ID
+        self.lines: List[str] = []
+        self.pending_ids: Dict[str, List[str]] = {}
+        self.last_flush = time.monotonic()
+
+        self.stats = {
+            "entries_read": 0,
+            "points_written": 0,
+            "batches_written": 0,
+            "write_failures": 0,
+            "last_flush_time": None,
+        }
+
+    def start(self):
+        """启动消费线程"""
+        if self.is_running:
+            return
+        if not self.redis_client:
+            logger.error("Redis客户端未连接，无法启动历史流消费")
+            return
+
+        for stream in self.streams:
+            self._ensure_group(stream)
+
+        self.is_running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+        logger.info(f"历史流消费已启动: streams={self.streams}, group={self.group}, "
+                    f"batch_size={self.batch_size}")
+
+    def stop(self):
+        """停止消费线程，写入剩余数据"""
+        if not self.is_running:
+            return
+        self.is_running = False
+        if self.thread and self.thread.is_alive():
+            self.thread.join(timeout=self.block_ms / 1000 + 5)
+        self._flush()
+        logger.info("历史流消费已停止")
+
+    def _ensure_group(self, stream: str):
+        """创建消费者组（已存在则忽略）"""
+        try:
+            self.redis_client.xgroup_create(stream, self.group, id='0', mkstream=True)
+            logger.info(f"创建消费者组: {stream} / {self.group}")
+        except Exception as e:
+            if 'BUSYGROUP' not in str(e):
+                logger.error(f"创建消费者组失败: {stream}, {e}")
+
+    def _run(self):
+        """消费循环：先处理本消费者未确认的条目，再读取新条目"""
+        # '0' 读取已投递但未确认的条目（上次写入InfluxDB前退出），确认后再读下一批
+        try:
+            while self.is_running and self._read({stream: '0' for stream in self.streams}, block=None):
+                if not self._flush():
+                    break
+        except Exception as e:
+            logger.error(f"处理未确认历史流条目失败: {e}")
+
+        while self.is_running:
+            try:
+                count = self._read({stream: '>' for stream in self.streams}, block=self.block_ms)
+                if count == 0 or len(self.lines) >= self.batch_size or self._flush_due():
+                    if not self._flush():
+                        time.sleep(5)  # InfluxDB不可用，暂停读取
+            except Exception as e:
+                logger.error(f"历史流消费异常: {e}")
+                time.sleep(5)
+
+    def _read(self, streams: Dict[str, str], block: Optional[int]) -> int:
+        """读取一批条目并转换为行协议，返回读取的条目数"""
+        response = self.redis_client.xreadgroup(
+            self.group, self.consumer, streams, count=self.batch_size, block=block
+        )
+        count = 0
+        for stream, entries in response or []:
+            for entry_id, fields in entries:
+                count += 1
+                self.pending_ids.setdefault(stream, []).append(entry_id)
+                if data_collector.should_exclude_key(fields.get(KEY_FIELD, '')):
+                    continue
+                self.lines.extend(entry_to_lines(fields))
+        self.stats["entries_read"] += count
+        return count
+
+    def _flush_due(self) -> bool:
+        return time.monotonic() - self.last_flush >= self.flush_interval
+
+    def _flush(self) -> bool:
+        """按batch_size分批写入InfluxDB，全部成功后确认条目"""
+        self.last_flush = time.monotonic()
+        if not self.pending_ids:
+            return True
+
+        for start in range(0, len(self.lines), self.batch_size):
+            batch = self.lines[start:start + self.batch_size]
+            if not influxdb_manager.write_lines(batch):
+                # 不确认，条目保留在PEL中，下次启动时重新处理
+                self.stats["write_failures"] += 1
+                self.lines = self.lines[start:]
+                logger.error(f"历史流写入InfluxDB失败，保留 {len(self.lines)} 条待重试")
+                return False
+            self.stats["points_written"] += len(batch)
+            self.stats["batches_written"] += 1
+
+        for stream, ids in self.pending_ids.items():
+            self.redis_client.xack(stream, self.group, *ids)
+        self.lines = []
+        self.pending_ids = {}
+        self.stats["last_flush_time"] = datetime.utcnow()
+        return True
+
+    def get_status(self) -> Dict[str, Any]:
+        """获取消费状态"""
+        return {
+            "is_running": self.is_running,
+            "streams": self.streams,
+            "group": self.group,
+            "consumer": self.consumer,
+            "buffered_points": len(self.lines),
+            "stats": self.stats.copy(),
+        }
+
+
+# 全局历史流消费者实例
+stream_collector = StreamCollector()
@@ -400,9 +400,19 @@ pub async fn sync_instance_measurement(
 pub async fn sync_all_instances(
     State(state): State<Arc<AppState>>,
 ) -> Result<Json<SuccessResponse<serde_json::Value>>, ModSrvError> {
-    match state.instance_manager.sync_instances_to_redis().await {
-        Ok(_) => Ok(Json(SuccessResponse::new(json!({
-            "message": "All instances synced to Redis"
+    match state
+        .instance_manager
+        .bulk_sync_instances_to_redis(true)
+        .await
+    {
+        Ok(report) => Ok(Json(SuccessResponse::new(json!({
+            "message": "All instances synced to Redis",
+            "total": report.total,
+            "added": report.added.len(),
+            "updated": report.updated.len(),
+            "removed": report.removed.len(),
+            "errors": report.errors,
+            "duration_ms": report.duration_ms
         })))),
         Err(e) => Err(ModSrvError::InternalError(format!(
             "Failed to sync instances: {}",
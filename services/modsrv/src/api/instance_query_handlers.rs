@@ -6,7 +6,8 @@
 
 use axum::{
     extract::{Path, Query, RawQuery, State},
-    response::Json,
+    http::header,
+    response::{IntoResponse, Json, Response},
 };
 use bytes::Bytes;
 use common::SuccessResponse;
@@ -16,7 +17,9 @@ use std::collections::HashMap;
 use std::sync::Arc;
 use tracing::info;
 use utoipa::ToSchema;
-use voltage_rtdb::Rtdb;
+use voltage_rtdb::{
+    BatchReadTarget, Rtdb, SnapshotArea, SystemTimeProvider, TimeProvider, BATCH_CONTENT_TYPE,
+};
 
 use crate::app_state::AppState;
 use crate::dto::{DataTypeQuery, InstancePointsResponse};
@@ -601,10 +604,27 @@ pub async fn set_instance_measurement(
     let key = crate::config::InstanceRedisKeys::measurement_hash(id);
 
     // Write to Redis Hash
-    rtdb.hash_set(&key, &req.point_id, Bytes::from(req.value.to_string()))
+    let value = Bytes::from(req.value.to_string());
+    rtdb.hash_set(&key, &req.point_id, value.clone())
         .await
         .map_err(|e| ModSrvError::RedisError(e.to_string()))?;
 
+    if let Some(&max_len) = state.instance_manager.history_max_len.get() {
+        crate::redis_state::append_measurement_history(
+            rtdb.as_ref(),
+            id,
+            vec![(req.point_id.clone(), value)],
+            SystemTimeProvider.now_millis(),
+            max_len,
+        )
+        .await
+        .map_err(|e| ModSrvError::RedisError(e.to_string()))?;
+    }
+    state
+        .instance_manager
+        .notify_measurements_changed(id, [req.point_id.as_str()])
+        .await;
+
     info!(
         "Set measurement inst:{}:M[{}] = {}",
         id, req.point_id, req.value
@@ -617,3 +637,97 @@ pub async fn set_instance_measurement(
         "status": "set"
     }))))
 }
+
+/// One instance in a batch value request
+#[derive(Debug, Clone, Deserialize, Serialize, ToSchema)]
+pub struct BatchInstanceTarget {
+    /// Instance ID
+    #[schema(example = 1)]
+    pub id: u32,
+
+    /// Point type: "M"/"measurement" (default) or "A"/"action"
+    #[serde(rename = "type", default)]
+    #[schema(example = "M")]
+    pub data_type: Option<String>,
+
+    /// Point IDs to read (omit for all registered points)
+    #[serde(default)]
+    pub points: Option<Vec<u32>>,
+}
+
+/// Request DTO for batch value reads
+#[derive(Debug, Clone, Deserialize, Serialize, ToSchema)]
+pub struct BatchValuesRequest {
+    pub instances: Vec<BatchInstanceTarget>,
+}
+
+/// Read many instances' values from shared memory as binary columns
+///
+/// Resolves every target against one index snapshot of comsrv's shared
+/// memory and returns the rows in the columnar format of
+/// `voltage_rtdb::shared_batch` (value, timestamp, instance ID, point ID,
+/// area, type, quality). Unknown instances and unregistered points are
+/// omitted; rows carry their own identity.
+///
+/// @route POST /api/instances/values/batch
+/// @input Json(req): BatchValuesRequest - Instances, point types and optional point lists
+/// @output `Result<Response, ModSrvError>` - application/vnd.voltage.point-columns body
+/// @status 200 - Encoded point columns
+/// @status 400 - Invalid point type
+/// @status 500 - Shared memory not available
+#[utoipa::path(
+    post,
+    path = "/api/instances/values/batch",
+    request_body(content = BatchValuesRequest, description = "Instances to read",
+        example = json!({
+            "instances": [
+                {"id": 1, "type": "M"},
+                {"id": 2, "type": "A", "points": [1, 2]}
+            ]
+        })
+    ),
+    responses(
+        (status = 200, description = "Encoded point columns (application/vnd.voltage.point-columns)"),
+        (status = 400, description = "Invalid point type"),
+        (status = 500, description = "Shared memory not available")
+    ),
+    tag = "modsrv"
+)]
+pub async fn batch_instance_values(
+    State(state): State<Arc<AppState>>,
+    Json(req): Json<BatchValuesRequest>,
+) -> Result<Response, ModSrvError> {
+    let reader = state.instance_manager.shared_reader.get().ok_or_else(|| {
+        ModSrvError::InternalError("Shared memory not available for batch reads".to_string())
+    })?;
+
+    let targets = req
+        .instances
+        .into_iter()
+        .map(|target| {
+            let type_idx = match target.data_type.as_deref() {
+                None | Some("M") | Some("m") | Some("measurement") => 0,
+                Some("A") | Some("a") | Some("action") => 1,
+                Some(other) => {
+                    return Err(ModSrvError::InvalidData(format!(
+                        "Invalid point type '{}' for instance {}",
+                        other, target.id
+                    )))
+                },
+            };
+            Ok(BatchReadTarget {
+                area: SnapshotArea::Instance,
+                owner_id: target.id,
+                type_idx,
+                point_ids: target.points,
+            })
+        })
+        .collect::<Result<Vec<_>, _>>()?;
+
+    let columns = reader.read_batch(&targets);
+    Ok((
+        [(header::CONTENT_TYPE, BATCH_CONTENT_TYPE)],
+        columns.encode(),
+    )
+        .into_response())
+}
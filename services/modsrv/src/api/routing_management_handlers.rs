@@ -191,9 +191,10 @@ pub async fn create_instance_routing(
     }
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -433,9 +434,10 @@ pub async fn update_instance_routing(
         }
 
         // Refresh routing cache after successful database update
-        if let Err(e) = crate::bootstrap::refresh_routing_cache(
+        if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
             &state.instance_manager.pool,
             state.instance_manager.routing_cache(),
+            id,
         )
         .await
         {
@@ -486,9 +488,10 @@ pub async fn delete_instance_routing(
             let total_count = measurement_count + action_count;
 
             // Refresh routing cache after successful database update
-            if let Err(e) = crate::bootstrap::refresh_routing_cache(
+            if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
                 &state.instance_manager.pool,
                 state.instance_manager.routing_cache(),
+                id,
             )
             .await
             {
@@ -85,9 +85,10 @@ pub async fn upsert_measurement_routing(
         .map_err(|e| ModSrvError::InvalidData(format!("Failed to upsert routing: {}", e)))?;
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -138,9 +139,10 @@ pub async fn delete_measurement_routing(
     }
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -194,9 +196,10 @@ pub async fn toggle_measurement_routing(
     }
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -285,9 +288,10 @@ pub async fn upsert_action_routing(
         .map_err(|e| ModSrvError::InvalidData(format!("Failed to upsert routing: {}", e)))?;
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -338,9 +342,10 @@ pub async fn delete_action_routing(
     }
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
@@ -394,9 +399,10 @@ pub async fn toggle_action_routing(
     }
 
     // Refresh routing cache after successful database update
-    if let Err(e) = crate::bootstrap::refresh_routing_cache(
+    if let Err(e) = crate::bootstrap::refresh_instance_routing_cache(
         &state.instance_manager.pool,
         state.instance_manager.routing_cache(),
+        id,
     )
     .await
     {
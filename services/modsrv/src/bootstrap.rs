@@ -6,7 +6,7 @@
 #[allow(unused_imports)] // Used at runtime but not in tests
 use crate::config::{ModsrvConfig, ModsrvQueries};
 use common::bootstrap_args::ServiceArgs;
-use common::bootstrap_database::{setup_redis_connection, setup_sqlite_pool};
+use common::bootstrap_database::{setup_redis_connection, setup_redis_shards, setup_sqlite_pool};
 use common::bootstrap_system::{check_system_requirements_with, SystemRequirements};
 use common::redis::RedisClient;
 use common::service_bootstrap::{get_service_port, ServiceInfo};
@@ -22,6 +22,7 @@ use super::error::{ModSrvError, Result};
 use crate::app_state::AppState;
 use crate::instance_manager::InstanceManager;
 use crate::product_loader::ProductLoader;
+use crate::{RuleLogPolicy, DEFAULT_RULE_WORKERS, DEFAULT_TICK_MS};
 
 /// Initialize service info for unified bootstrap
 pub fn create_service_info() -> ServiceInfo {
@@ -96,6 +97,7 @@ pub async fn load_configuration(service_info: &ServiceInfo) -> Result<ModsrvConf
         redis: RedisConfig {
             url: service_config.redis_url,
             enabled: true,
+            ..Default::default()
         },
         products_path: service_config
             .extra_config
@@ -449,7 +451,18 @@ pub async fn create_app_state(service_info: &ServiceInfo) -> Result<Arc<AppState
 
     // ============ Phase 2: Create RTDB ============
     debug!("Creating RedisRtdb");
-    let rtdb = Arc::new(voltage_rtdb::RedisRtdb::from_client(redis_client.clone()));
+    let rtdb = if config.redis.shard_urls.is_empty() {
+        Arc::new(voltage_rtdb::RedisRtdb::from_client(redis_client.clone()))
+    } else {
+        let shards = setup_redis_shards(
+            redis_client.clone(),
+            &config.redis.shard_urls,
+            common::redis::RedisPoolConfig::default(),
+        )
+        .await?;
+        info!("Redis keyspace sharded over {} servers", shards.len());
+        Arc::new(voltage_rtdb::RedisRtdb::from_shards(shards)?)
+    };
 
     // ============ Phase 3: Use the single rtdb for all operations ============
     // Perform Redis cleanup (uses basic methods, no routing triggered)
@@ -542,3 +555,110 @@ async fn rebuild_instance_name_index<R: voltage_rtdb::Rtdb>(
 
     Ok(count)
 }
+
+/// Refresh the routing cache entries of a single instance from SQLite
+///
+/// Used after instance-scoped routing operations (create/update/delete of one
+/// instance's routing). Only that instance's rows are loaded, and the cache
+/// copies only the route blocks whose routes actually changed.
+///
+/// # Arguments
+/// * `sqlite_pool` - SQLite connection pool
+/// * `routing_cache` - Shared routing cache to refresh
+/// * `instance_id` - Instance whose routes changed
+///
+/// # Returns
+/// * `Ok(usize)` - Number of routes loaded for the instance (c2m + m2c)
+/// * `Err(anyhow::Error)` - Database or parsing errors
+pub async fn refresh_instance_routing_cache(
+    sqlite_pool: &SqlitePool,
+    routing_cache: &Arc<voltage_rtdb::RoutingCache>,
+    instance_id: u32,
+) -> anyhow::Result<usize> {
+    debug!("Refreshing routes of instance {}", instance_id);
+
+    let maps = voltage_routing::load_instance_routing_maps(sqlite_pool, instance_id).await?;
+
+    let total_routes = maps.c2m.len() + maps.m2c.len();
+
+    routing_cache.replace_instance_routes(instance_id, maps.c2m, maps.m2c);
+
+    debug!(
+        "Instance {} routes refreshed: {}",
+        instance_id, total_routes
+    );
+
+    Ok(total_routes)
+}
+
+/// Rule scheduler settings from the global config (`rules.*` keys)
+#[derive(Debug, Clone)]
+pub struct RuleSettings {
+    /// Scheduler tick interval in milliseconds
+    pub tick_ms: u64,
+    /// Concurrent rule executions per cycle
+    pub workers: usize,
+    /// Record execution path/node details (monitoring UI)
+    pub exec_details: bool,
+    /// Rule log policy: "all" (default), "on_change" or "sample:N"
+    pub log_policy: RuleLogPolicy,
+}
+
+/// Default `inst:history` length cap (same as comsrv's channel export)
+pub const DEFAULT_HISTORY_STREAM_MAX_LEN: usize = 100_000;
+
+async fn load_global(pool: &SqlitePool, key: &str) -> Option<String> {
+    sqlx::query_scalar::<_, String>(
+        "SELECT value FROM service_config WHERE service_name = 'global' AND key = ?",
+    )
+    .bind(key)
+    .fetch_optional(pool)
+    .await
+    .ok()
+    .flatten()
+}
+
+/// Stream length cap when instance measurement writes are exported to
+/// `inst:history` (`modsrv.history_stream` / `modsrv.history_stream_max_len`)
+pub async fn load_history_stream(pool: &SqlitePool) -> Option<usize> {
+    let enabled = load_global(pool, "modsrv.history_stream")
+        .await
+        .and_then(|s| s.parse().ok())
+        .unwrap_or(false);
+    if !enabled {
+        return None;
+    }
+    Some(
+        load_global(pool, "modsrv.history_stream_max_len")
+            .await
+            .and_then(|s| s.parse().ok())
+            .unwrap_or(DEFAULT_HISTORY_STREAM_MAX_LEN),
+    )
+}
+
+/// Load rule scheduler settings, falling back to defaults for missing keys
+pub async fn load_rule_settings(pool: &SqlitePool) -> RuleSettings {
+    let log_policy = match load_global(pool, "rules.log_policy").await {
+        Some(s) => s.parse().unwrap_or_else(|e| {
+            warn!("{}, logging all", e);
+            RuleLogPolicy::default()
+        }),
+        None => RuleLogPolicy::default(),
+    };
+
+    RuleSettings {
+        tick_ms: load_global(pool, "rules.tick_ms")
+            .await
+            .and_then(|s| s.parse().ok())
+            .unwrap_or(DEFAULT_TICK_MS),
+        workers: load_global(pool, "rules.workers")
+            .await
+            .and_then(|s| s.parse().ok())
+            .unwrap_or(DEFAULT_RULE_WORKERS),
+        exec_details: load_global(pool, "rules.exec_details")
+            .await
+            .and_then(|s| s.parse().ok())
+            .unwrap_or(true),
+        log_policy,
+    }
+}
@@ -356,7 +356,17 @@ impl<R: Rtdb + 'static> InstanceManager<R> {
         instance_id: u32,
         data: HashMap<String, serde_json::Value>,
     ) -> Result<()> {
-        redis_state::sync_measurement(self.rtdb.as_ref(), instance_id, data).await?;
+        let point_ids: Vec<String> = data.keys().cloned().collect();
+        redis_state::sync_measurement(
+            self.rtdb.as_ref(),
+            instance_id,
+            data,
+            self.history_max_len.get().copied(),
+        )
+        .await?;
+
+        self.notify_measurements_changed(instance_id, point_ids.iter().map(String::as_str))
+            .await;
 
         debug!("Synced measurement data for instance {}", instance_id);
         Ok(())
@@ -370,9 +380,10 @@ impl<R: Rtdb + 'static> InstanceManager<R> {
         value: f64,
     ) -> Result<()> {
         // Use application-layer routing with cache
-        let outcome = voltage_routing::set_action_point(
+        let outcome = voltage_routing::set_action_point_with_commands(
             self.rtdb.as_ref(),
             &self.routing_cache,
+            self.command_sender.get().map(|sender| sender.as_ref()),
             instance_id,
             action_id,
             value,
@@ -10,7 +10,7 @@ use crate::config::InstanceRedisKeys;
 use anyhow::{anyhow, Result};
 use sqlx::SqlitePool;
 use std::collections::HashMap;
-use std::sync::Arc;
+use std::sync::{Arc, OnceLock};
 use tracing::{error, info, warn};
 use voltage_model::validate_instance_name;
 use voltage_rtdb::Rtdb;
@@ -57,6 +57,14 @@ pub struct InstanceManager<R: Rtdb> {
     pub rtdb: Arc<R>,
     pub(crate) routing_cache: Arc<voltage_rtdb::RoutingCache>,
     pub(crate) product_loader: Arc<ProductLoader>,
+    /// Shared memory command ring producer (set once comsrv's segment is open)
+    pub(crate) command_sender: OnceLock<Arc<voltage_rtdb::SharedCommandSender>>,
+    /// Shared memory reader for batch value reads (set once comsrv's segment is open)
+    pub(crate) shared_reader: OnceLock<Arc<voltage_rtdb::SharedVecRtdbReader>>,
+    /// `inst:history` length cap when measurement writes are exported
+    pub(crate) history_max_len: OnceLock<usize>,
+    /// Rule scheduler told about measurement writes (OnChange rules)
+    pub(crate) rule_scheduler: OnceLock<Arc<crate::RuleScheduler<R>>>,
 }
 
 impl<R: Rtdb + 'static> InstanceManager<R> {
@@ -71,6 +79,57 @@ impl<R: Rtdb + 'static> InstanceManager<R> {
             rtdb,
             routing_cache,
             product_loader,
+            command_sender: OnceLock::new(),
+            shared_reader: OnceLock::new(),
+            history_max_len: OnceLock::new(),
+            rule_scheduler: OnceLock::new(),
+        }
+    }
+
+    /// Route actions through the shared memory command rings as well as Redis
+    ///
+    /// Only the first call takes effect.
+    pub fn set_command_sender(&self, sender: Arc<voltage_rtdb::SharedCommandSender>) {
+        let _ = self.command_sender.set(sender);
+    }
+
+    /// Serve batch value reads from shared memory
+    ///
+    /// Only the first call takes effect.
+    pub fn set_shared_reader(&self, reader: Arc<voltage_rtdb::SharedVecRtdbReader>) {
+        let _ = self.shared_reader.set(reader);
+    }
+
+    /// Also append measurement writes to `inst:history` for hissrv
+    ///
+    /// Only the first call takes effect.
+    pub fn set_history_stream(&self, max_len: usize) {
+        let _ = self.history_max_len.set(max_len.max(1));
+    }
+
+    /// Re-evaluate OnChange rules after measurement writes made here
+    ///
+    /// These writes go to Redis only, so the shared-memory change ring never
+    /// sees them. Only the first call takes effect.
+    pub fn set_rule_scheduler(&self, scheduler: Arc<crate::RuleScheduler<R>>) {
+        let _ = self.rule_scheduler.set(scheduler);
+    }
+
+    /// Tell the rule scheduler which measurement points were written
+    pub(crate) async fn notify_measurements_changed<'a>(
+        &self,
+        instance_id: u32,
+        point_ids: impl IntoIterator<Item = &'a str>,
+    ) {
+        let Some(scheduler) = self.rule_scheduler.get() else {
+            return;
+        };
+        let points: Vec<crate::TriggerPoint> = point_ids
+            .into_iter()
+            .filter_map(|point_id| Some((instance_id, 0, point_id.parse().ok()?)))
+            .collect();
+        if !points.is_empty() {
+            scheduler.notify_points_changed(&points).await;
         }
     }
 
@@ -524,56 +583,6 @@ impl<R: Rtdb + 'static> InstanceManager<R> {
         })
     }
 
-    /// Load all routing mappings for multiple instances in batch (O(1) queries instead of O(N))
-    ///
-    /// Returns a tuple of:
-    /// - HashMap<instance_id, HashMap<point_id, redis_key>> for measurements
-    /// - HashMap<instance_id, HashMap<point_id, redis_key>> for actions
-    pub(crate) async fn load_all_routings_batch(
-        &self,
-    ) -> Result<(
-        HashMap<u32, HashMap<u32, String>>,
-        HashMap<u32, HashMap<u32, String>>,
-    )> {
-        // Query all measurement routings in one batch
-        let all_measurements: Vec<(i32, i32)> =
-            sqlx::query_as("SELECT instance_id, measurement_id FROM measurement_routing")
-                .fetch_all(&self.pool)
-                .await?;
-
-        // Query all action routings in one batch
-        let all_actions: Vec<(i32, i32)> =
-            sqlx::query_as("SELECT instance_id, action_id FROM action_routing")
-                .fetch_all(&self.pool)
-                .await?;
-
-        // Group measurements by instance_id
-        let mut measurement_routings: HashMap<u32, HashMap<u32, String>> = HashMap::new();
-        for (instance_id, point_id) in all_measurements {
-            let instance_id = instance_id as u32;
-            let point_id = point_id as u32;
-            let redis_key = InstanceRedisKeys::measurement(instance_id, point_id);
-            measurement_routings
-                .entry(instance_id)
-                .or_default()
-                .insert(point_id, redis_key);
-        }
-
-        // Group actions by instance_id
-        let mut action_routings: HashMap<u32, HashMap<u32, String>> = HashMap::new();
-        for (instance_id, point_id) in all_actions {
-            let instance_id = instance_id as u32;
-            let point_id = point_id as u32;
-            let redis_key = InstanceRedisKeys::action(instance_id, point_id);
-            action_routings
-                .entry(instance_id)
-                .or_default()
-                .insert(point_id, redis_key);
-        }
-
-        Ok((measurement_routings, action_routings))
-    }
-
     /// Delete an instance by ID
     pub async fn delete_instance(&self, instance_id: u32) -> Result<()> {
         // 1. Query instance_name before deletion (needed for Redis cleanup and logging)
@@ -314,6 +314,61 @@ async fn test_delete_instance() {
     assert!(get_result.is_err());
 }
 
+#[tokio::test]
+async fn test_bulk_sync_writes_only_changed_instances() {
+    use bytes::Bytes;
+    use voltage_rtdb::Rtdb;
+
+    let (_temp_dir, pool) = create_test_database().await;
+    let product_loader = create_test_product_loader(pool.clone());
+    let rtdb = create_test_rtdb();
+    let routing_cache = Arc::new(voltage_rtdb::RoutingCache::new());
+    let manager = InstanceManager::new(pool, rtdb.clone(), routing_cache, product_loader);
+
+    for (id, name) in [(1001, "bulk_01"), (1002, "bulk_02")] {
+        manager
+            .create_instance(CreateInstanceRequest {
+                instance_id: id,
+                instance_name: name.to_string(),
+                product_name: "Battery".to_string(),
+                properties: HashMap::new(),
+            })
+            .await
+            .unwrap();
+    }
+
+    // Stale instance left in Redis, plus one instance missing from Redis
+    rtdb.set("inst:99:name", Bytes::from("stale"))
+        .await
+        .unwrap();
+    rtdb.hash_set("inst:name:index", "stale", Bytes::from("99"))
+        .await
+        .unwrap();
+    rtdb.del("inst:1002:name").await.unwrap();
+
+    let report = manager.bulk_sync_instances_to_redis(false).await.unwrap();
+    assert_eq!(report.total, 2);
+    assert_eq!(report.unchanged, 1);
+    assert_eq!(report.added, vec![1002]);
+    assert_eq!(report.removed, vec![99]);
+    assert!(report.errors.is_empty());
+    assert_eq!(
+        rtdb.get("inst:1002:name").await.unwrap(),
+        Some(Bytes::from("bulk_02"))
+    );
+    assert!(rtdb
+        .hash_get("inst:name:index", "stale")
+        .await
+        .unwrap()
+        .is_none());
+
+    // Second pass has nothing to do; force rewrites everything
+    let report = manager.bulk_sync_instances_to_redis(false).await.unwrap();
+    assert_eq!(report.unchanged, 2);
+    let report = manager.bulk_sync_instances_to_redis(true).await.unwrap();
+    assert_eq!(report.updated.len(), 2);
+}
+
 // ==================== Phase 2: M2C Routing Tests (execute_action) ====================
 
 /// Helper: Setup instance name index in RTDB (required for voltage-routing)
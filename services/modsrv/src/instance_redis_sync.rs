@@ -4,7 +4,7 @@
 //! Extracted from instance_manager.rs for better code organization.
 
 use anyhow::{anyhow, Result};
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
 use tracing::{debug, info, warn};
 
 use crate::config::InstanceRedisKeys;
@@ -13,147 +13,236 @@ use crate::redis_state;
 use super::instance_manager::InstanceManager;
 use voltage_rtdb::Rtdb;
 
+/// Instances written per pipelined batch during bulk sync
+const BULK_SYNC_BATCH_SIZE: usize = 1000;
+
+/// Outcome of [`InstanceManager::bulk_sync_instances_to_redis`]
+#[derive(Debug, Default)]
+pub struct BulkSyncReport {
+    /// Instances in SQLite
+    pub total: usize,
+    /// Instance IDs newly written to Redis
+    pub added: Vec<u32>,
+    /// Instance IDs re-written (renamed, or forced)
+    pub updated: Vec<u32>,
+    /// Stale instance IDs removed from Redis
+    pub removed: Vec<u32>,
+    /// Instances already up to date in Redis
+    pub unchanged: usize,
+    pub errors: Vec<String>,
+    pub duration_ms: u64,
+}
+
 impl<R: Rtdb + 'static> InstanceManager<R> {
     /// Sync all instances from SQLite to Redis (called on startup)
     ///
-    /// Optimized to use batch queries: 3 queries total instead of 1 + 3N
-    /// (1 list_instances + 1 all_measurements + 1 all_actions)
+    /// Only instances missing from Redis or whose name changed are written;
+    /// see [`bulk_sync_instances_to_redis`](Self::bulk_sync_instances_to_redis).
     pub async fn sync_instances_to_redis(&self) -> Result<()> {
-        use std::sync::Arc;
+        let report = self.bulk_sync_instances_to_redis(false).await?;
 
-        info!("Syncing instances from SQLite to Redis...");
+        if !report.errors.is_empty() {
+            warn!(
+                "Instance sync completed with {} failures out of {}",
+                report.errors.len(),
+                report.total
+            );
+        }
 
-        let instances = self.list_instances(None).await?;
-        let total = instances.len();
+        Ok(()) // Always return Ok to allow service to start
+    }
 
-        if total == 0 {
-            info!("No instances to sync");
-            return Ok(());
-        }
+    /// Bulk sync all instances from SQLite to Redis
+    ///
+    /// Diffs SQLite against the instances already in Redis (`inst:*:name` keys
+    /// and the name index): new instances are added, renamed ones re-written
+    /// and stale ones removed. With `force`, every instance is re-written.
+    ///
+    /// Writes go out in pipelined batches of [`BULK_SYNC_BATCH_SIZE`] instances
+    /// (three round-trips per batch), with progress logged per batch.
+    pub async fn bulk_sync_instances_to_redis(&self, force: bool) -> Result<BulkSyncReport> {
+        use std::sync::Arc;
 
-        // Batch load all routings in 2 queries (instead of 2N queries)
-        let (all_measurement_routings, all_action_routings) =
-            self.load_all_routings_batch().await?;
-        debug!(
-            "Loaded {} measurement routings, {} action routings in batch",
-            all_measurement_routings.len(),
-            all_action_routings.len()
-        );
+        let start_time = std::time::Instant::now();
+        let mut report = BulkSyncReport::default();
 
-        // Collect all instance data for batch sync
-        // Use Arc<Product> to share product data across instances with same product type
-        struct InstanceRedisPayload {
-            instance_id: u32,
-            instance_name: String,
-            product_name: String,
-            properties: HashMap<String, serde_json::Value>,
-            // Point routing mappings - Maps point IDs to Redis keys
-            measurement_point_routings: HashMap<u32, String>,
-            action_point_routings: HashMap<u32, String>,
-            // Arc-wrapped product to avoid cloning for instances with same product
-            product: Arc<crate::product_loader::Product>,
+        let instances = self.list_instances(None).await?;
+        report.total = instances.len();
+
+        // Current Redis state: instance IDs and name index (name -> id)
+        let redis_ids = self.get_redis_instance_ids().await?;
+        let name_index: HashMap<String, u32> = self
+            .rtdb
+            .hash_get_all("inst:name:index")
+            .await?
+            .into_iter()
+            .filter_map(|(name, id)| {
+                let id = std::str::from_utf8(&id).ok()?.parse::<u32>().ok()?;
+                Some((name, id))
+            })
+            .collect();
+
+        // 1. Remove instances that are no longer in SQLite
+        let db_ids: HashSet<u32> = instances.iter().map(|inst| inst.instance_id()).collect();
+        for id in redis_ids.difference(&db_ids) {
+            let instance_name = name_index
+                .iter()
+                .find(|(_, index_id)| *index_id == id)
+                .map(|(name, _)| name.clone())
+                .unwrap_or_else(|| format!("instance_{}", id));
+
+            match redis_state::unregister_instance(self.rtdb.as_ref(), *id, &instance_name).await {
+                Ok(_) => report.removed.push(*id),
+                Err(e) => {
+                    warn!("Failed to remove instance {} from Redis: {}", id, e);
+                    report.errors.push(format!("Remove {} err: {}", id, e));
+                },
+            }
         }
 
-        let mut batch_data: Vec<InstanceRedisPayload> = Vec::new();
-        let mut failed_count = 0;
-
-        // Cache products by name to avoid repeated loads and clones
-        // Products are compile-time constants, synchronous access
+        // 2. Select instances to write (products are compile-time constants, cached)
         let mut product_cache: HashMap<String, Arc<crate::product_loader::Product>> =
             HashMap::new();
+        let mut to_write = Vec::new();
+
+        for instance in &instances {
+            let id = instance.instance_id();
+            let in_redis = redis_ids.contains(&id);
+            if !force && in_redis && name_index.get(instance.instance_name()) == Some(&id) {
+                report.unchanged += 1;
+                continue;
+            }
 
-        for instance in instances {
-            // Get product details (cached, sync access)
             let product = match product_cache.get(instance.product_name()) {
                 Some(cached) => Arc::clone(cached),
                 None => match self.product_loader.get_product(instance.product_name()) {
                     Ok(p) => {
-                        let arc_product = Arc::new(p);
-                        product_cache.insert(
-                            instance.product_name().to_string(),
-                            Arc::clone(&arc_product),
-                        );
-                        arc_product
+                        let product = Arc::new(p);
+                        product_cache
+                            .insert(instance.product_name().to_string(), Arc::clone(&product));
+                        product
                     },
                     Err(e) => {
                         warn!(
                             "Product {} not found for instance {}: {}",
                             instance.product_name(),
-                            instance.instance_id(),
+                            id,
                             e
                         );
-                        failed_count += 1;
+                        report.errors.push(format!(
+                            "Product {} err: {}",
+                            instance.product_name(),
+                            e
+                        ));
                         continue;
                     },
                 },
             };
 
-            // Get point routings from batch-loaded data (O(1) lookup, no DB query)
-            let measurement_point_routings = all_measurement_routings
-                .get(&instance.instance_id())
-                .cloned()
-                .unwrap_or_default();
-            let action_point_routings = all_action_routings
-                .get(&instance.instance_id())
-                .cloned()
-                .unwrap_or_default();
-
-            batch_data.push(InstanceRedisPayload {
-                instance_id: instance.instance_id(),
-                instance_name: instance.instance_name().to_string(),
-                product_name: instance.product_name().to_string(),
-                properties: instance.core.properties.clone(),
-                measurement_point_routings, // from batch lookup
-                action_point_routings,      // from batch lookup
-                product,                    // Arc::clone, not deep clone
-            });
+            to_write.push((instance, product, in_redis));
         }
 
-        // Perform batch sync to Redis if we have data
-        if !batch_data.is_empty() {
-            info!("Batch syncing {} instances to Redis", batch_data.len());
-
-            // Process in chunks to avoid overwhelming Redis
-            const BATCH_SIZE: usize = 50;
-            for chunk in batch_data.chunks(BATCH_SIZE) {
-                for payload in chunk {
-                    if let Err(e) = redis_state::register_instance(
-                        self.rtdb.as_ref(),
-                        payload.instance_id,
-                        &payload.instance_name,
-                        &payload.product_name,
-                        &payload.properties,
-                        &payload.measurement_point_routings,
-                        &payload.action_point_routings,
-                        &payload.product.measurements,
-                        &payload.product.actions,
-                        None,
-                    )
-                    .await
-                    {
-                        warn!(
-                            "Failed to sync instance {} to Redis: {}",
-                            payload.instance_name, e
-                        );
-                        failed_count += 1;
-                    }
-                }
+        // Old names of renamed instances must leave the name index
+        let written_names: HashMap<u32, &str> = to_write
+            .iter()
+            .map(|(instance, _, _)| (instance.instance_id(), instance.instance_name()))
+            .collect();
+        let stale_names: Vec<String> = name_index
+            .iter()
+            .filter(|(name, id)| {
+                written_names
+                    .get(*id)
+                    .is_some_and(|current| *current != name.as_str())
+            })
+            .map(|(name, _)| name.clone())
+            .collect();
+        if !stale_names.is_empty() {
+            self.rtdb
+                .hash_del_many("inst:name:index", &stale_names)
+                .await?;
+        }
 
-                // Small delay between chunks to avoid overwhelming Redis
-                tokio::time::sleep(std::time::Duration::from_millis(10)).await;
+        // 3. Write in pipelined batches
+        let pending = to_write.len();
+        let mut done = 0;
+        for chunk in to_write.chunks(BULK_SYNC_BATCH_SIZE) {
+            let registrations: Vec<redis_state::InstanceRegistration<'_>> = chunk
+                .iter()
+                .map(|(instance, product, _)| redis_state::InstanceRegistration {
+                    instance_id: instance.instance_id(),
+                    instance_name: instance.instance_name(),
+                    measurements: &product.measurements,
+                })
+                .collect();
+
+            match redis_state::register_instances(self.rtdb.as_ref(), &registrations).await {
+                Ok(_) => {
+                    for (instance, _, in_redis) in chunk {
+                        if *in_redis {
+                            report.updated.push(instance.instance_id());
+                        } else {
+                            report.added.push(instance.instance_id());
+                        }
+                    }
+                },
+                Err(e) => {
+                    warn!("Failed to sync {} instances to Redis: {}", chunk.len(), e);
+                    for (instance, _, _) in chunk {
+                        report
+                            .errors
+                            .push(format!("Sync {} err: {}", instance.instance_name(), e));
+                    }
+                },
             }
-        }
 
-        if failed_count > 0 {
-            warn!(
-                "Instance sync completed with {} failures out of {}",
-                failed_count, total
+            done += chunk.len();
+            info!(
+                "Instance sync: {}/{} written ({}ms)",
+                done,
+                pending,
+                start_time.elapsed().as_millis()
             );
-        } else {
-            info!("All {} instances synced successfully", total);
         }
 
-        Ok(()) // Always return Ok to allow service to start
+        report.duration_ms = start_time.elapsed().as_millis() as u64;
+        info!(
+            "Instance sync: {} total, +{} ~{} -{} ={} err:{} ({}ms)",
+            report.total,
+            report.added.len(),
+            report.updated.len(),
+            report.removed.len(),
+            report.unchanged,
+            report.errors.len(),
+            report.duration_ms
+        );
+
+        Ok(report)
+    }
+
+    /// Get all instance IDs from Redis by scanning inst:*:name keys
+    pub(crate) async fn get_redis_instance_ids(&self) -> Result<HashSet<u32>> {
+        // Scan for all inst:*:name keys
+        let pattern = "inst:*:name";
+        let keys = self.rtdb.scan_match(pattern).await?;
+
+        let mut instance_ids = HashSet::new();
+
+        for key in keys {
+            // Extract instance ID from key format: inst:{id}:name
+            if let Some(id_str) = key
+                .strip_prefix("inst:")
+                .and_then(|s| s.strip_suffix(":name"))
+            {
+                if let Ok(id) = id_str.parse::<u32>() {
+                    instance_ids.insert(id);
+                } else {
+                    warn!("Invalid ID in key: {}", key);
+                }
+            }
+        }
+
+        debug!("{} instances in Redis", instance_ids.len());
+        Ok(instance_ids)
     }
 
     /// Sync a single instance to Redis (for hot reload)
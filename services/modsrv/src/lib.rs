@@ -54,7 +54,8 @@ pub mod rule_routes;
 pub use voltage_rules::{
     delete_rule, extract_rule_flow, get_rule, get_rule_for_execution, list_rules, load_all_rules,
     load_enabled_rules, set_rule_enabled, upsert_rule, ActionResult, Result as RuleResult,
-    RuleError, RuleExecutionResult, RuleExecutor, RuleScheduler, SchedulerStatus, TriggerConfig,
+    RuleError, RuleExecutionResult, RuleExecutor, RuleLogPolicy, RuleLogStats, RuleScheduler,
+    SchedulerStatus, TriggerConfig, TriggerPoint, DEFAULT_LOG_QUEUE_CAPACITY, DEFAULT_RULE_WORKERS,
     DEFAULT_TICK_MS,
 };
 
@@ -18,9 +18,9 @@ use modsrv::rule_routes::RuleApiDoc;
 use modsrv::{
     bootstrap, routes,
     rule_routes::{create_rule_routes, RuleEngineState},
-    Result, RuleScheduler, DEFAULT_TICK_MS,
+    Result, RuleScheduler, DEFAULT_LOG_QUEUE_CAPACITY,
 };
-use voltage_rtdb::{is_shm_available, SharedConfig, SharedVecRtdbReader};
+use voltage_rtdb::{is_shm_available, SharedCommandSender, SharedConfig, SharedVecRtdbReader};
 
 #[tokio::main]
 async fn main() -> Result<()> {
@@ -57,25 +57,23 @@ async fn main() -> Result<()> {
     let rtdb = state.instance_manager.rtdb.clone();
     let routing_cache = state.instance_manager.routing_cache().clone();
 
-    // Load tick_ms from global config (SQLite key-value table)
-    let tick_ms: u64 = sqlx::query_scalar::<_, String>(
-        "SELECT value FROM service_config WHERE service_name = 'global' AND key = 'rules.tick_ms'",
-    )
-    .fetch_optional(&sqlite_pool)
-    .await
-    .ok()
-    .flatten()
-    .and_then(|s| s.parse().ok())
-    .unwrap_or(DEFAULT_TICK_MS);
+    // Load rule scheduler settings from global config (SQLite key-value table)
+    let rule_settings = bootstrap::load_rule_settings(&sqlite_pool).await;
 
-    debug!("Rule scheduler tick_ms: {}", tick_ms);
+    debug!(
+        "Rule scheduler tick_ms: {}, workers: {}, exec_details: {}, log_policy: {:?}",
+        rule_settings.tick_ms,
+        rule_settings.workers,
+        rule_settings.exec_details,
+        rule_settings.log_policy
+    );
 
     // Initialize SharedVecRtdbReader for cross-process zero-copy reads
     // Uses smart path selection - works on any filesystem
     // Added retry mechanism for cold start race condition
     // Load SharedConfig from global config (SQLite key-value table)
     // This enables direct mmap access to comsrv's shared memory
-    let shared_reader = {
+    let (shared_reader, command_sender) = {
         // Load SharedConfig parameters from database
         let config = {
             let mut cfg = SharedConfig::default();
@@ -107,6 +105,15 @@ async fn main() -> Result<()> {
             {
                 cfg = cfg.with_max_points_per_channel(v);
             }
+            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.change_ring_capacity").await {
+                cfg = cfg.with_change_ring_capacity(v);
+            }
+            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.command_ring_capacity").await {
+                cfg = cfg.with_command_ring_capacity(v);
+            }
+            if let Some(v) = load_usize(&sqlite_pool, "shared_memory.history_capacity").await {
+                cfg = cfg.with_history_capacity(v);
+            }
 
             debug!(
                 "SharedConfig: max_instances={}, max_channels={}, points_per_inst={}, points_per_ch={}",
@@ -118,7 +125,7 @@ async fn main() -> Result<()> {
         const RETRY_DELAY: Duration = Duration::from_secs(2);
         let mut retry_count = 0;
 
-        loop {
+        let reader = loop {
             if is_shm_available(&config) {
                 match SharedVecRtdbReader::open(&config) {
                     Ok(reader) => {
@@ -162,20 +169,67 @@ async fn main() -> Result<()> {
                 );
                 break None;
             }
-        }
+        };
+
+        // Downlink command rings share the segment; only open once comsrv created it
+        let sender = match &reader {
+            Some(_) if config.command_ring_capacity > 0 => {
+                match SharedCommandSender::open(&config) {
+                    Ok(sender) => {
+                        info!(
+                            "Command rings enabled ({} slots/channel)",
+                            config.command_ring_capacity
+                        );
+                        Some(Arc::new(sender))
+                    },
+                    Err(e) => {
+                        warn!("Command rings unavailable, using TODO queues: {}", e);
+                        None
+                    },
+                }
+            },
+            _ => None,
+        };
+        (reader, sender)
     };
+    if let Some(sender) = &command_sender {
+        state
+            .instance_manager
+            .set_command_sender(Arc::clone(sender));
+    }
+    if let Some(reader) = &shared_reader {
+        state.instance_manager.set_shared_reader(Arc::clone(reader));
+    }
+    if let Some(max_len) = bootstrap::load_history_stream(&sqlite_pool).await {
+        state.instance_manager.set_history_stream(max_len);
+        info!(
+            "Instance measurements exported to inst:history (max {})",
+            max_len
+        );
+    }
 
     // Create rule scheduler with two-tier priority (SharedMemory > Redis)
     // Removed VecRtdb - using SharedMemory + Redis two-tier architecture
     let rule_log_root = PathBuf::from("logs/modsrv");
-    let scheduler = Arc::new(RuleScheduler::with_shared_reader(
-        rtdb,
-        routing_cache,
-        sqlite_pool.clone(),
-        tick_ms,
-        rule_log_root,
-        shared_reader,
-    ));
+    let scheduler = Arc::new(
+        RuleScheduler::with_shared_reader(
+            rtdb,
+            routing_cache,
+            sqlite_pool.clone(),
+            rule_settings.tick_ms,
+            rule_log_root,
+            shared_reader,
+            command_sender,
+        )
+        .with_workers(rule_settings.workers)
+        .with_exec_details(rule_settings.exec_details)
+        .with_log_policy(rule_settings.log_policy, DEFAULT_LOG_QUEUE_CAPACITY),
+    );
+
+    // Measurement writes through the API re-trigger OnChange rules
+    state
+        .instance_manager
+        .set_rule_scheduler(Arc::clone(&scheduler));
 
     // Load rules into scheduler
     match scheduler.load_rules().await {
@@ -206,6 +260,7 @@ async fn main() -> Result<()> {
     info!("  GET/POST /api/instances - Instance management");
     info!("  GET /api/products - Product management");
     info!("  GET /api/instances/:id/data - Get instance data");
+    info!("  POST /api/instances/values/batch - Batch values (binary columns)");
     info!("  POST /api/instances/:id/sync - Sync measurement");
     info!("  POST /api/instances/:id/action - Execute action");
     info!("  POST /api/instances/sync/all - Sync all instances");
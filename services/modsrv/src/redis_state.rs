@@ -11,7 +11,8 @@ use common::RedisRoutingKeys;
 use serde_json::{Map, Value};
 use std::collections::HashMap;
 use std::fmt;
-use voltage_rtdb::{Rtdb, SystemTimeProvider, TimeProvider};
+use std::sync::Arc;
+use voltage_rtdb::{KeySpaceConfig, Rtdb, SharedHashFields, SystemTimeProvider, TimeProvider};
 
 use crate::product_loader::{ActionPoint, MeasurementPoint, Product};
 
@@ -425,6 +426,70 @@ where
     Ok(())
 }
 
+/// Instance data written by [`register_instances`].
+#[derive(Debug, Clone, Copy)]
+pub struct InstanceRegistration<'a> {
+    pub instance_id: u32,
+    pub instance_name: &'a str,
+    pub measurements: &'a [MeasurementPoint],
+}
+
+/// Register many instances with batched writes.
+///
+/// Writes the same keys as [`register_instance`] for every entry, but in
+/// three round-trips regardless of batch size: one pipeline for all
+/// `inst:{id}:M` hashes, one MSET for the `inst:{id}:name` keys and one
+/// HSET for the name index.
+pub async fn register_instances<R>(redis: &R, instances: &[InstanceRegistration<'_>]) -> Result<()>
+where
+    R: Rtdb,
+{
+    if instances.is_empty() {
+        return Ok(());
+    }
+
+    let measurement_hashes: Vec<(String, Vec<(String, Bytes)>)> = instances
+        .iter()
+        .filter(|inst| !inst.measurements.is_empty())
+        .map(|inst| {
+            let fields = inst
+                .measurements
+                .iter()
+                .map(|point| (point.measurement_id.to_string(), Bytes::from_static(b"0")))
+                .collect();
+            (
+                InstanceRedisKeys::measurement_hash(inst.instance_id),
+                fields,
+            )
+        })
+        .collect();
+    redis.pipeline_hash_mset(measurement_hashes).await?;
+
+    let names: Vec<(String, Bytes)> = instances
+        .iter()
+        .map(|inst| {
+            (
+                InstanceRedisKeys::instance_name(inst.instance_id),
+                Bytes::from(inst.instance_name.to_string()),
+            )
+        })
+        .collect();
+    redis.mset(names).await?;
+
+    let index_fields: Vec<(String, Bytes)> = instances
+        .iter()
+        .map(|inst| {
+            (
+                inst.instance_name.to_string(),
+                Bytes::from(inst.instance_id.to_string()),
+            )
+        })
+        .collect();
+    redis.hash_mset("inst:name:index", index_fields).await?;
+
+    Ok(())
+}
+
 /// Delete instance-related Redis data and clean up routing mappings.
 /// EN: Remove Redis data related to an instance and clean up routing mappings.
 pub async fn unregister_instance<R>(redis: &R, instance_id: u32, instance_name: &str) -> Result<()>
@@ -551,11 +616,14 @@ where
 
 /// Write measurement data (replaces `modsrv_sync_measurement`).
 /// EN: Write measurement data (replaces `modsrv_sync_measurement`).
+///
+/// With `history_max_len` set the values are also appended to `inst:history`.
 #[allow(deprecated)] // Uses time_millis internally until TimeProvider migration is complete
 pub async fn sync_measurement<R>(
     redis: &R,
     instance_id: u32,
     measurement: HashMap<String, Value>,
+    history_max_len: Option<usize>,
 ) -> Result<()>
 where
     R: Rtdb,
@@ -567,9 +635,48 @@ where
         .into_iter()
         .map(|(k, v)| (k, Bytes::from(value_to_string(&v))))
         .collect();
+    let history = history_max_len.map(|max_len| (fields.clone(), max_len));
     fields.push(("_updated_at".to_string(), Bytes::from(now_ms.to_string())));
 
-    redis.hash_mset(&key, fields).await
+    redis.hash_mset(&key, fields).await?;
+    if let Some((points, max_len)) = history {
+        append_measurement_history(redis, instance_id, points, now_ms, max_len).await?;
+    }
+    Ok(())
+}
+
+/// Append measurement changes to `inst:history`
+///
+/// Same entry layout as comsrv's WriteBuffer export: `key` (the value hash
+/// key), `ts` (ms) and one `{point_id}` field per changed point.
+pub async fn append_measurement_history<R>(
+    redis: &R,
+    instance_id: u32,
+    points: Vec<(String, Bytes)>,
+    ts_ms: i64,
+    max_len: usize,
+) -> Result<()>
+where
+    R: Rtdb,
+{
+    if points.is_empty() {
+        return Ok(());
+    }
+    let stream: Arc<str> = Arc::from(KeySpaceConfig::production().instance_history_stream_key());
+    let mut fields: SharedHashFields = Vec::with_capacity(points.len() + 2);
+    fields.push((
+        Arc::from("key"),
+        Bytes::from(InstanceRedisKeys::measurement_hash(instance_id)),
+    ));
+    fields.push((Arc::from("ts"), Bytes::from(ts_ms.to_string())));
+    fields.extend(
+        points
+            .into_iter()
+            .map(|(point_id, value)| (Arc::from(point_id), value)),
+    );
+    redis
+        .pipeline_stream_add(vec![(stream, fields)], max_len)
+        .await
 }
 
 /// Read instance real-time data (replaces `modsrv_get_instance_data`).
@@ -860,4 +967,75 @@ mod tests {
             .unwrap();
         assert!(m2c_after.is_empty());
     }
+
+    #[tokio::test]
+    async fn test_register_instances_batch() {
+        let rtdb = create_test_rtdb();
+
+        let measurements: Vec<MeasurementPoint> = (1..=3)
+            .map(|id| MeasurementPoint {
+                measurement_id: id,
+                name: format!("point_{}", id),
+                unit: None,
+                description: None,
+            })
+            .collect();
+        let registrations = vec![
+            InstanceRegistration {
+                instance_id: 1,
+                instance_name: "pv_01",
+                measurements: &measurements,
+            },
+            InstanceRegistration {
+                instance_id: 2,
+                instance_name: "pv_02",
+                measurements: &[],
+            },
+        ];
+
+        register_instances(&rtdb, &registrations).await.unwrap();
+
+        let m1 = rtdb
+            .hash_get_all(&InstanceRedisKeys::measurement_hash(1))
+            .await
+            .unwrap();
+        assert_eq!(m1.len(), 3);
+        assert_eq!(m1.get("2"), Some(&Bytes::from("0")));
+        assert!(rtdb
+            .hash_get_all(&InstanceRedisKeys::measurement_hash(2))
+            .await
+            .unwrap()
+            .is_empty());
+
+        assert_eq!(
+            rtdb.get(&InstanceRedisKeys::instance_name(2))
+                .await
+                .unwrap(),
+            Some(Bytes::from("pv_02"))
+        );
+        assert_eq!(
+            rtdb.hash_get("inst:name:index", "pv_01").await.unwrap(),
+            Some(Bytes::from("1"))
+        );
+    }
+
+    #[tokio::test]
+    async fn test_sync_measurement_exports_history() {
+        let rtdb = create_test_rtdb();
+        let data = HashMap::from([("3".to_string(), Value::from(42.5))]);
+
+        sync_measurement(&rtdb, 5, data.clone(), None)
+            .await
+            .unwrap();
+        assert!(rtdb.stream_entries("inst:history").is_empty());
+
+        sync_measurement(&rtdb, 5, data, Some(10)).await.unwrap();
+        let entries = rtdb.stream_entries("inst:history");
+        assert_eq!(entries.len(), 1);
+        assert_eq!(entries[0][0], (Arc::from("key"), Bytes::from("inst:5:M")));
+        assert_eq!(entries[0][1].0.as_ref(), "ts");
+        assert_eq!(entries[0][2], (Arc::from("3"), Bytes::from("42.5")));
+        // Bookkeeping fields stay out of the stream
+        assert_eq!(entries[0].len(), 3);
+    }
 }
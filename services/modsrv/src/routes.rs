@@ -23,8 +23,8 @@ use crate::api::instance_management_handlers::{
     sync_all_instances, sync_instance_measurement, update_instance,
 };
 use crate::api::instance_query_handlers::{
-    get_instance, get_instance_data, get_instance_points, list_instances, list_instances_slim,
-    search_instances, set_instance_measurement,
+    batch_instance_values, get_instance, get_instance_data, get_instance_points, list_instances,
+    list_instances_slim, search_instances, set_instance_measurement,
 };
 
 // New global routing handlers (work with unified database)
@@ -62,6 +62,7 @@ use common::admin_api::{get_log_level, set_log_level};
         crate::api::instance_management_handlers::delete_instance,
         crate::api::instance_query_handlers::get_instance_data,
         crate::api::instance_query_handlers::get_instance_points,
+        crate::api::instance_query_handlers::batch_instance_values,
         crate::api::instance_management_handlers::sync_instance_measurement,
         crate::api::instance_management_handlers::execute_instance_action,
         crate::api::instance_query_handlers::set_instance_measurement,
@@ -110,6 +111,8 @@ use common::admin_api::{get_log_level, set_log_level};
             crate::dto::EnergyRequest,
             crate::dto::TimeSeriesRequest,
             crate::api::instance_query_handlers::SetMeasurementRequest,
+            crate::api::instance_query_handlers::BatchValuesRequest,
+            crate::api::instance_query_handlers::BatchInstanceTarget,
             crate::config::Product,
             crate::config::MeasurementPoint,
             crate::config::ActionPoint,
@@ -144,6 +147,7 @@ pub fn create_routes(state: Arc<AppState>) -> Router {
         )
         .route("/api/instances/{id}/data", get(get_instance_data))
         .route("/api/instances/{id}/points", get(get_instance_points))
+        .route("/api/instances/values/batch", post(batch_instance_values))
         .route(
             "/api/instances/{id}/sync",
             post(sync_instance_measurement),
@@ -8,7 +8,8 @@
 use crate::error::ModSrvError;
 use axum::{
     extract::{Path, Query, State},
-    response::Json,
+    http::header,
+    response::{IntoResponse, Json, Response},
     routing::{get, post},
     Router,
 };
@@ -20,7 +21,10 @@ use tracing::{debug, error, info, warn};
 #[cfg(feature = "swagger-ui")]
 use utoipa::OpenApi;
 use voltage_rtdb::traits::Rtdb;
-use voltage_rules::{self as rule_repository, RuleNode, RuleScheduler, RuleVariable};
+use voltage_rtdb::{HistogramSnapshot, MetricKind, PrometheusText, PROMETHEUS_CONTENT_TYPE};
+use voltage_rules::{
+    self as rule_repository, RuleNode, RuleScheduler, RuleVariable, EXEC_TIME_BUCKETS_US,
+};
 
 /// Rule Engine state shared across handlers
 pub struct RuleEngineState<R: Rtdb> {
@@ -56,6 +60,9 @@ pub fn create_rule_routes<R: Rtdb + Send + Sync + 'static>(
         // Scheduler control
         .route("/api/scheduler/status", get(scheduler_status::<R>))
         .route("/api/scheduler/reload", post(scheduler_reload::<R>))
+        .route("/api/scheduler/timings", get(scheduler_timings::<R>))
+        // Prometheus scrape endpoint
+        .route("/metrics", get(metrics_handler::<R>))
         // Apply HTTP request logging middleware
         .layer(axum::middleware::from_fn(common::logging::http_request_logger))
         .with_state(state)
@@ -68,7 +75,7 @@ pub fn create_rule_routes<R: Rtdb + Send + Sync + 'static>(
 #[cfg(feature = "swagger-ui")]
 #[derive(OpenApi)]
 #[openapi(
-    paths(list_rules, create_rule, get_rule, update_rule, delete_rule, enable_rule, disable_rule, execute_rule_now, scheduler_status, scheduler_reload),
+    paths(list_rules, create_rule, get_rule, update_rule, delete_rule, enable_rule, disable_rule, execute_rule_now, scheduler_status, scheduler_reload, scheduler_timings, metrics_handler),
     components(
         schemas(
             CreateRuleRequest,
@@ -603,7 +610,9 @@ pub async fn scheduler_status<R: Rtdb + Send + Sync + 'static>(
         "running": status.running,
         "total_rules": status.total_rules,
         "enabled_rules": status.enabled_rules,
-        "tick_interval_ms": status.tick_interval_ms
+        "on_change_rules": status.on_change_rules,
+        "tick_interval_ms": status.tick_interval_ms,
+        "workers": status.workers
     }))))
 }
 
@@ -637,6 +646,120 @@ pub async fn scheduler_reload<R: Rtdb + Send + Sync + 'static>(
     }
 }
 
+/// Get per-rule execution-time histograms
+///
+/// Bucket upper bounds (μs) are returned alongside the counts; the last
+/// bucket counts executions slower than the largest bound.
+#[cfg_attr(feature = "swagger-ui", utoipa::path(
+    get,
+    path = "/api/scheduler/timings",
+    responses(
+        (status = 200, description = "Rule execution timings", body = serde_json::Value)
+    ),
+    tag = "rules"
+))]
+pub async fn scheduler_timings<R: Rtdb + Send + Sync + 'static>(
+    State(state): State<Arc<RuleEngineState<R>>>,
+) -> Result<Json<SuccessResponse<serde_json::Value>>, ModSrvError> {
+    let timings = state.scheduler.rule_timings().await;
+
+    Ok(Json(SuccessResponse::new(json!({
+        "bucket_bounds_us": EXEC_TIME_BUCKETS_US,
+        "rules": timings
+    }))))
+}
+
+/// Prometheus metrics endpoint
+///
+/// Exports the per-rule execution-time histograms (same buckets as
+/// `/api/scheduler/timings`), scheduler rule counts and rule log counters.
+///
+/// @route GET /metrics
+/// @output `text/plain; version=0.0.4` - Prometheus text exposition
+/// @status 200 - Metrics rendered
+#[cfg_attr(feature = "swagger-ui", utoipa::path(
+    get,
+    path = "/metrics",
+    responses(
+        (status = 200, description = "Prometheus text exposition (text/plain; version=0.0.4)", body = String)
+    ),
+    tag = "rules"
+))]
+pub async fn metrics_handler<R: Rtdb + Send + Sync + 'static>(
+    State(state): State<Arc<RuleEngineState<R>>>,
+) -> Response {
+    let status = state.scheduler.status().await;
+    let timings = state.scheduler.rule_timings().await;
+
+    let mut text = PrometheusText::new();
+    text.family(
+        "modsrv_rules",
+        MetricKind::Gauge,
+        "Scheduled rules by state",
+    );
+    text.sample(
+        "modsrv_rules",
+        &[("state", "total")],
+        status.total_rules as f64,
+    );
+    text.sample(
+        "modsrv_rules",
+        &[("state", "enabled")],
+        status.enabled_rules as f64,
+    );
+    text.sample(
+        "modsrv_rules",
+        &[("state", "on_change")],
+        status.on_change_rules as f64,
+    );
+
+    let log_stats = state.scheduler.rule_log_stats();
+    text.family(
+        "modsrv_rule_log_records_total",
+        MetricKind::Counter,
+        "Rule log records by outcome",
+    );
+    for (outcome, value) in [
+        ("enqueued", log_stats.enqueued),
+        ("dropped", log_stats.dropped),
+        ("filtered", log_stats.filtered),
+        ("written", log_stats.written),
+        ("write_error", log_stats.write_errors),
+    ] {
+        text.sample(
+            "modsrv_rule_log_records_total",
+            &[("outcome", outcome)],
+            value as f64,
+        );
+    }
+
+    text.family(
+        "modsrv_rule_execution_duration_seconds",
+        MetricKind::Histogram,
+        "Rule execution duration",
+    );
+    for timing in &timings {
+        let rule_id = timing.rule_id.to_string();
+        let histogram = HistogramSnapshot::from_buckets(
+            &EXEC_TIME_BUCKETS_US,
+            &timing.histogram.buckets,
+            timing.histogram.sum_us,
+            timing.histogram.max_us,
+        );
+        text.histogram(
+            "modsrv_rule_execution_duration_seconds",
+            &[("rule_id", &rule_id), ("rule", &timing.rule_name)],
+            &histogram,
+        );
+    }
+
+    (
+        [(header::CONTENT_TYPE, PROMETHEUS_CONTENT_TYPE)],
+        text.finish(),
+    )
+        .into_response()
+}
+
 /// Get rule variables for monitoring
 ///
 /// Returns all variable definitions from a rule's nodes, which can be used
@@ -0,0 +1,801 @@
+//! Load and latency harness for Monarch CLI
+//!
+//! `monarch bench` provisions N virtual channels × M points in a private
+//! shared-memory segment and an in-memory RTDB, then drives them through the
+//! same library paths comsrv and modsrv run in production:
+//!
+//! ```text
+//! poll ─► write_channel_batch_direct ─► shared memory ─► change ring ─► RuleScheduler
+//!                 │                                                        │
+//!                 └─► WriteBuffer ─► inst:{id}:M          inst:{id}:A ◄─────┘
+//!                                                              │ M2C
+//!                                              command ring ◄──┴──► TODO queue
+//! ```
+//!
+//! Point 1 of every channel is a probe: each poll writes the poll sequence
+//! number to it, and one `on_change` rule per instance copies it to an action
+//! point. Every stage reports when a sequence number first arrives, giving
+//! latency percentiles from the poll to that stage. Stages after shared
+//! memory are sampled every millisecond, so their latencies include up to
+//! 1ms of observation delay.
+//!
+//! The protocol layer is synthetic: values are generated at the store
+//! boundary (where `RedisDataStore::write_batch` hands them to routing), so
+//! the numbers exclude device I/O.
+
+use anyhow::{Context, Result};
+use clap::Args;
+use colored::*;
+use serde::Serialize;
+use sqlx::sqlite::SqlitePoolOptions;
+use std::collections::{HashMap, VecDeque};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
+use tokio::sync::Notify;
+use tokio::time::{interval, MissedTickBehavior};
+use voltage_model::{KeySpaceConfig, PointType};
+use voltage_routing::ChannelPointUpdate;
+use voltage_rtdb::{
+    ChannelToSlotIndex, MemoryRtdb, RoutingCache, Rtdb, SharedCommandSender, SharedConfig,
+    SharedVecRtdbReader, SharedVecRtdbWriter, WriteBuffer, WriteBufferConfig,
+};
+use voltage_rules::{
+    RuleLogPolicy, RuleScheduler, DEFAULT_LOG_QUEUE_CAPACITY, DEFAULT_RULE_WORKERS, DEFAULT_TICK_MS,
+};
+
+use crate::core::schema::RULE_CHAINS_TABLE;
+
+/// First virtual channel ID (channel i ↔ instance i + 1)
+const BASE_CHANNEL_ID: u32 = 1001;
+
+/// Probe point carrying the poll sequence number (T:1 → M:1 → A:n)
+const PROBE_POINT: u32 = 1;
+
+/// Poll start times kept per channel for latency lookups
+const TRACE_WINDOW: usize = 4096;
+
+/// Stage observation interval
+const TRACE_INTERVAL_MS: u64 = 1;
+
+/// Grace period for in-flight values after the pollers stop
+const DRAIN_GRACE_MS: u64 = 500;
+
+/// Traced pipeline stages, in pipeline order: (name, description)
+const STAGES: [(&str, &str); 5] = [
+    ("shm", "poll → shared memory"),
+    ("inst_m", "poll → inst:{id}:M"),
+    ("inst_a", "poll → rule → inst:{id}:A"),
+    ("cmd_ring", "poll → command ring consumed"),
+    ("todo", "poll → TODO queue consumed"),
+];
+const STAGE_SHM: usize = 0;
+const STAGE_INST_M: usize = 1;
+const STAGE_INST_A: usize = 2;
+const STAGE_CMD_RING: usize = 3;
+const STAGE_TODO: usize = 4;
+
+/// Load harness options
+#[derive(Args, Debug, Clone)]
+pub struct BenchArgs {
+    /// Number of virtual channels (one instance per channel)
+    #[arg(long, default_value = "10")]
+    pub channels: u32,
+
+    /// Telemetry points per channel (C2M-routed 1:1 to instance measurements)
+    #[arg(long, default_value = "100")]
+    pub points: u32,
+
+    /// Poll interval per channel in milliseconds
+    #[arg(long, default_value = "100")]
+    pub poll_ms: u64,
+
+    /// Fraction of points changing per poll (0.0-1.0; the probe always changes)
+    #[arg(long, default_value = "0.1")]
+    pub change_rate: f64,
+
+    /// Number of on_change rules, spread over the instances (default: one per channel)
+    #[arg(long)]
+    pub rules: Option<u32>,
+
+    /// Telemetry points per channel forwarded C2C to the next channel's signals
+    #[arg(long, default_value = "0")]
+    pub c2c_points: u32,
+
+    /// Test duration in seconds
+    #[arg(short, long, default_value = "10")]
+    pub duration_secs: u64,
+
+    /// Rules executed concurrently per scheduler cycle
+    #[arg(long, default_value_t = DEFAULT_RULE_WORKERS)]
+    pub rule_workers: usize,
+
+    /// Output the report as JSON
+    #[arg(long)]
+    pub json: bool,
+}
+
+impl BenchArgs {
+    fn rule_count(&self) -> u32 {
+        self.rules.unwrap_or(self.channels)
+    }
+
+    /// Action points per instance (one per rule targeting it)
+    fn actions_per_instance(&self) -> u32 {
+        self.rule_count().div_ceil(self.channels.max(1)).max(1)
+    }
+
+    fn validate(&self) -> Result<()> {
+        if self.channels == 0 || self.points == 0 {
+            anyhow::bail!("--channels and --points must be at least 1");
+        }
+        if self.poll_ms == 0 || self.duration_secs == 0 {
+            anyhow::bail!("--poll-ms and --duration-secs must be at least 1");
+        }
+        if !(0.0..=1.0).contains(&self.change_rate) {
+            anyhow::bail!("--change-rate must be between 0.0 and 1.0");
+        }
+        if self.c2c_points > self.points {
+            anyhow::bail!("--c2c-points cannot exceed --points");
+        }
+        Ok(())
+    }
+}
+
+/// Latency percentiles of one stage
+#[derive(Debug, Serialize)]
+pub struct StageReport {
+    pub stage: &'static str,
+    pub description: &'static str,
+    pub samples: usize,
+    pub p50_us: u64,
+    pub p95_us: u64,
+    pub p99_us: u64,
+    pub max_us: u64,
+}
+
+/// Harness result
+#[derive(Debug, Serialize)]
+pub struct BenchReport {
+    pub channels: u32,
+    pub points_per_channel: u32,
+    pub rules: u32,
+    pub poll_ms: u64,
+    pub change_rate: f64,
+    pub duration_secs: f64,
+    pub polls: u64,
+    pub point_updates: u64,
+    pub point_updates_per_sec: f64,
+    pub c2m_writes: u64,
+    pub c2c_forwards: u64,
+    pub rule_executions: u64,
+    pub rule_exec_mean_us: u64,
+    pub rule_exec_max_us: u64,
+    pub commands_ring: u64,
+    pub commands_todo: u64,
+    pub stages: Vec<StageReport>,
+}
+
+/// Poll timestamps and per-stage arrival latencies
+struct Trace {
+    /// Per channel: (sequence, poll start), oldest first
+    sent: Vec<Mutex<VecDeque<(u64, Instant)>>>,
+    /// Per stage × channel: highest sequence already observed
+    last_seen: Vec<AtomicU64>,
+    /// Per stage: latencies in microseconds
+    latencies: Vec<Mutex<Vec<u64>>>,
+    channels: usize,
+}
+
+impl Trace {
+    fn new(channels: usize) -> Self {
+        Self {
+            sent: (0..channels)
+                .map(|_| Mutex::new(VecDeque::with_capacity(TRACE_WINDOW)))
+                .collect(),
+            last_seen: (0..channels * STAGES.len())
+                .map(|_| AtomicU64::new(0))
+                .collect(),
+            latencies: STAGES.iter().map(|_| Mutex::new(Vec::new())).collect(),
+            channels,
+        }
+    }
+
+    fn record_sent(&self, channel: usize, seq: u64, at: Instant) {
+        let Ok(mut sent) = self.sent[channel].lock() else {
+            return;
+        };
+        if sent.len() == TRACE_WINDOW {
+            sent.pop_front();
+        }
+        sent.push_back((seq, at));
+    }
+
+    /// Record the first arrival of `seq` at `stage`; older or repeated values are ignored
+    fn observe(&self, stage: usize, channel: usize, seq: u64, now: Instant) {
+        if channel >= self.channels || seq == 0 {
+            return;
+        }
+        let previous =
+            self.last_seen[stage * self.channels + channel].fetch_max(seq, Ordering::Relaxed);
+        if previous >= seq {
+            return;
+        }
+
+        let sent_at = {
+            let Ok(sent) = self.sent[channel].lock() else {
+                return;
+            };
+            let Some(&(first, _)) = sent.front() else {
+                return;
+            };
+            match seq.checked_sub(first) {
+                Some(offset) => sent.get(offset as usize).map(|&(_, at)| at),
+                None => None,
+            }
+        };
+        if let (Some(at), Ok(mut latencies)) = (sent_at, self.latencies[stage].lock()) {
+            latencies.push(now.duration_since(at).as_micros() as u64);
+        }
+    }
+
+    fn stage_reports(&self) -> Vec<StageReport> {
+        STAGES
+            .iter()
+            .zip(&self.latencies)
+            .map(|(&(stage, description), latencies)| {
+                let mut samples = latencies.lock().map(|l| l.clone()).unwrap_or_default();
+                samples.sort_unstable();
+                StageReport {
+                    stage,
+                    description,
+                    samples: samples.len(),
+                    p50_us: percentile(&samples, 0.50),
+                    p95_us: percentile(&samples, 0.95),
+                    p99_us: percentile(&samples, 0.99),
+                    max_us: samples.last().copied().unwrap_or(0),
+                }
+            })
+            .collect()
+    }
+}
+
+/// Nearest-rank percentile of sorted samples (0 when empty)
+fn percentile(sorted: &[u64], q: f64) -> u64 {
+    if sorted.is_empty() {
+        return 0;
+    }
+    let rank = ((q * sorted.len() as f64).ceil() as usize).clamp(1, sorted.len());
+    sorted[rank - 1]
+}
+
+/// Whether a non-probe point changes in poll `seq` (deterministic, ~`rate` of points)
+fn point_changes(point_id: u32, seq: u64, rate: f64) -> bool {
+    let h = (u64::from(point_id).wrapping_mul(0x9E37_79B9_7F4A_7C15) ^ seq)
+        .wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    (h >> 32) % 10_000 < (rate * 10_000.0) as u64
+}
+
+/// Compact rule flow: on probe change, copy `X1 = inst:M:1` to `Y1 = inst:A:{action}`
+fn probe_rule_flow(instance_id: u32, action_point: u32) -> serde_json::Value {
+    serde_json::json!({
+        "start_node": "start",
+        "nodes": {
+            "start": {"type": "start", "wires": {"default": ["switch"]}},
+            "switch": {
+                "type": "function-switch",
+                "variables": [{
+                    "name": "X1", "instance": instance_id,
+                    "pointType": "measurement", "point": PROBE_POINT
+                }],
+                "rule": [{
+                    "name": "out001",
+                    "type": "default",
+                    "rule": [{"type": "variable", "variables": "X1", "operator": ">=", "value": 0}]
+                }],
+                "wires": {"out001": ["change"]}
+            },
+            "change": {
+                "type": "action-changeValue",
+                "variables": [{
+                    "name": "Y1", "instance": instance_id,
+                    "pointType": "action", "point": action_point
+                }],
+                "rule": [{"Variables": "Y1", "value": "X1"}],
+                "wires": {"default": ["end"]}
+            },
+            "end": {"type": "end"}
+        },
+        "trigger": {"type": "on_change", "points": []}
+    })
+}
+
+/// Routing tables: C2M (T:p → M:p), C2C (T:p → next channel S:p), M2C (A:a → A:a)
+fn build_routes(args: &BenchArgs) -> RoutingCache {
+    let mut c2m = HashMap::new();
+    let mut c2c = HashMap::new();
+    let mut m2c = HashMap::new();
+
+    for i in 0..args.channels {
+        let channel_id = BASE_CHANNEL_ID + i;
+        let instance_id = i + 1;
+        for p in 1..=args.points {
+            c2m.insert(
+                format!("{}:T:{}", channel_id, p),
+                format!("{}:M:{}", instance_id, p),
+            );
+        }
+        let next_channel = BASE_CHANNEL_ID + (i + 1) % args.channels;
+        for p in 1..=args.c2c_points {
+            c2c.insert(
+                format!("{}:T:{}", channel_id, p),
+                format!("{}:S:{}", next_channel, p),
+            );
+        }
+        for a in 1..=args.actions_per_instance() {
+            m2c.insert(
+                format!("{}:A:{}", instance_id, a),
+                format!("{}:A:{}", channel_id, a),
+            );
+        }
+    }
+
+    RoutingCache::from_maps(c2m, m2c, c2c)
+}
+
+/// Create the segment and register every instance and channel
+fn provision_shm(
+    args: &BenchArgs,
+    config: &SharedConfig,
+    routing: &RoutingCache,
+) -> Result<(SharedVecRtdbWriter, ChannelToSlotIndex)> {
+    let mut writer = SharedVecRtdbWriter::open(config).context("Failed to create bench segment")?;
+
+    let measurements: Vec<u32> = (1..=args.points).collect();
+    let actions: Vec<u32> = (1..=args.actions_per_instance()).collect();
+    let signals: Vec<u32> = (1..=args.c2c_points).collect();
+    for i in 0..args.channels {
+        writer.register_instance(i + 1, &measurements, &actions)?;
+        writer.register_channel(BASE_CHANNEL_ID + i, &measurements, &signals, &[], &actions)?;
+    }
+
+    let index = ChannelToSlotIndex::build(routing, &writer);
+    Ok((writer, index))
+}
+
+/// Insert the probe rules into an in-memory rules database
+async fn provision_rules(args: &BenchArgs) -> Result<sqlx::SqlitePool> {
+    let pool = SqlitePoolOptions::new()
+        .max_connections(1)
+        .connect("sqlite::memory:")
+        .await?;
+    sqlx::query(RULE_CHAINS_TABLE).execute(&pool).await?;
+
+    for k in 0..args.rule_count() {
+        let instance_id = k % args.channels + 1;
+        let action_point = k / args.channels + 1;
+        let flow = probe_rule_flow(instance_id, action_point);
+        sqlx::query("INSERT INTO rules (id, name, nodes_json, enabled) VALUES (?, ?, ?, 1)")
+            .bind(i64::from(k) + 1)
+            .bind(format!("bench_{}", k + 1))
+            .bind(serde_json::to_string(&flow)?)
+            .execute(&pool)
+            .await?;
+    }
+    Ok(pool)
+}
+
+/// Throughput counters shared by the pollers and the tracer
+#[derive(Default)]
+struct Counters {
+    polls: AtomicU64,
+    point_updates: AtomicU64,
+    c2m_writes: AtomicU64,
+    c2c_forwards: AtomicU64,
+    commands_ring: AtomicU64,
+    commands_todo: AtomicU64,
+}
+
+/// One channel's poll loop (comsrv side)
+#[allow(clippy::too_many_arguments)]
+async fn run_poller(
+    channel: usize,
+    args: BenchArgs,
+    writer: Arc<SharedVecRtdbWriter>,
+    index: Arc<ChannelToSlotIndex>,
+    buffer: Arc<WriteBuffer>,
+    routing: Arc<RoutingCache>,
+    trace: Arc<Trace>,
+    counters: Arc<Counters>,
+    running: Arc<AtomicBool>,
+) {
+    let channel_id = BASE_CHANNEL_ID + channel as u32;
+
+    // Stagger channels over the poll interval like the poll scheduler does
+    let offset = args.poll_ms * channel as u64 / u64::from(args.channels);
+    tokio::time::sleep(Duration::from_millis(offset)).await;
+
+    let mut ticker = interval(Duration::from_millis(args.poll_ms));
+    ticker.set_missed_tick_behavior(MissedTickBehavior::Delay);
+    let mut seq: u64 = 0;
+
+    while running.load(Ordering::Relaxed) {
+        ticker.tick().await;
+        seq += 1;
+        let started = Instant::now();
+        trace.record_sent(channel, seq, started);
+
+        let mut updates = vec![ChannelPointUpdate::new(
+            channel_id,
+            PointType::Telemetry,
+            PROBE_POINT,
+            seq as f64,
+        )];
+        for p in (PROBE_POINT + 1)..=args.points {
+            if point_changes(p, seq, args.change_rate) {
+                let value = f64::from(p) + (seq % 1000) as f64 * 0.1;
+                updates.push(ChannelPointUpdate::new(
+                    channel_id,
+                    PointType::Telemetry,
+                    p,
+                    value,
+                ));
+            }
+        }
+        let count = updates.len() as u64;
+
+        let result = voltage_routing::write_channel_batch_direct(
+            &writer, &index, &buffer, &routing, updates,
+        );
+        trace.observe(STAGE_SHM, channel, seq, Instant::now());
+
+        counters.polls.fetch_add(1, Ordering::Relaxed);
+        counters.point_updates.fetch_add(count, Ordering::Relaxed);
+        counters
+            .c2m_writes
+            .fetch_add(result.c2m_writes as u64, Ordering::Relaxed);
+        counters
+            .c2c_forwards
+            .fetch_add(result.c2c_forwards as u64, Ordering::Relaxed);
+    }
+}
+
+/// Parse a hash field written by the WriteBuffer / action routing
+fn parse_seq(bytes: &[u8]) -> Option<u64> {
+    let value: f64 = std::str::from_utf8(bytes).ok()?.trim().parse().ok()?;
+    (value >= 1.0).then_some(value as u64)
+}
+
+/// Observe the downstream stages every millisecond (Redis side and command executor)
+async fn run_tracer(
+    channels: u32,
+    rtdb: Arc<MemoryRtdb>,
+    writer: Arc<SharedVecRtdbWriter>,
+    trace: Arc<Trace>,
+    counters: Arc<Counters>,
+    stop: Arc<Notify>,
+) {
+    let keyspace = KeySpaceConfig::production_cached();
+    let probe_field = PROBE_POINT.to_string();
+    let keys: Vec<(u32, String, String, String)> = (0..channels)
+        .map(|i| {
+            let channel_id = BASE_CHANNEL_ID + i;
+            (
+                channel_id,
+                keyspace.instance_measurement_key(i + 1),
+                keyspace.instance_action_key(i + 1),
+                keyspace.todo_queue_key(channel_id, PointType::Adjustment),
+            )
+        })
+        .collect();
+
+    let mut ticker = interval(Duration::from_millis(TRACE_INTERVAL_MS));
+    ticker.set_missed_tick_behavior(MissedTickBehavior::Skip);
+    let mut ring_values: Vec<u64> = Vec::new();
+
+    loop {
+        tokio::select! {
+            _ = ticker.tick() => {},
+            _ = stop.notified() => break,
+        }
+
+        for (channel, (channel_id, m_key, a_key, todo_key)) in keys.iter().enumerate() {
+            if let Ok(Some(bytes)) = rtdb.hash_get(m_key, &probe_field).await {
+                if let Some(seq) = parse_seq(&bytes) {
+                    trace.observe(STAGE_INST_M, channel, seq, Instant::now());
+                }
+            }
+            if let Ok(Some(bytes)) = rtdb.hash_get(a_key, &probe_field).await {
+                if let Some(seq) = parse_seq(&bytes) {
+                    trace.observe(STAGE_INST_A, channel, seq, Instant::now());
+                }
+            }
+
+            // Command executor: ring first (comsrv CommandTrigger), then TODO fallback
+            ring_values.clear();
+            let drained = writer.drain_commands(*channel_id, 256, |command| {
+                ring_values.push(command.value as u64);
+            });
+            let now = Instant::now();
+            for &seq in &ring_values {
+                trace.observe(STAGE_CMD_RING, channel, seq, now);
+            }
+            counters
+                .commands_ring
+                .fetch_add(drained as u64, Ordering::Relaxed);
+
+            while let Ok(Some(payload)) = rtdb.list_lpop(todo_key).await {
+                counters.commands_todo.fetch_add(1, Ordering::Relaxed);
+                let seq = serde_json::from_slice::<serde_json::Value>(&payload)
+                    .ok()
+                    .and_then(|v| v.get("value").and_then(serde_json::Value::as_f64))
+                    .map(|v| v as u64);
+                if let Some(seq) = seq {
+                    trace.observe(STAGE_TODO, channel, seq, Instant::now());
+                }
+            }
+        }
+    }
+}
+
+/// Run the harness and return its report
+pub async fn run_bench(args: BenchArgs) -> Result<BenchReport> {
+    args.validate()?;
+    let workdir = tempfile::tempdir().context("Failed to create bench directory")?;
+
+    // comsrv side: routing, shared memory, write buffer
+    let routing = Arc::new(build_routes(&args));
+    let actions = args.actions_per_instance() as usize;
+    let shm_config = SharedConfig::default()
+        .with_path(workdir.path().join("bench.shm"))
+        .with_max_instances(args.channels as usize + 1)
+        .with_max_points_per_instance(args.points as usize + actions + 1)
+        .with_max_channels(args.channels as usize + 1)
+        .with_max_points_per_channel((args.points + args.c2c_points) as usize + actions + 1);
+    let (writer, index) = provision_shm(&args, &shm_config, &routing)?;
+    let writer = Arc::new(writer);
+    let index = Arc::new(index);
+
+    let rtdb = Arc::new(MemoryRtdb::new());
+    let buffer = Arc::new(WriteBuffer::new(WriteBufferConfig::default()));
+    let flush_stop = Arc::new(Notify::new());
+    let flush_task = {
+        let buffer = Arc::clone(&buffer);
+        let rtdb = Arc::clone(&rtdb);
+        let stop = Arc::clone(&flush_stop);
+        tokio::spawn(async move { buffer.flush_loop_with_shutdown(&*rtdb, stop).await })
+    };
+
+    // modsrv side: on_change rules fed by the change ring, commands via the rings
+    let reader = Arc::new(SharedVecRtdbReader::open(&shm_config)?);
+    let sender = Arc::new(SharedCommandSender::open(&shm_config)?);
+    let pool = provision_rules(&args).await?;
+    let scheduler = Arc::new(
+        RuleScheduler::with_shared_reader(
+            Arc::clone(&rtdb),
+            Arc::clone(&routing),
+            pool,
+            DEFAULT_TICK_MS,
+            workdir.path().join("logs"),
+            Some(reader),
+            Some(sender),
+        )
+        .with_workers(args.rule_workers)
+        .with_log_policy(RuleLogPolicy::Sample(100), DEFAULT_LOG_QUEUE_CAPACITY),
+    );
+    scheduler.load_rules().await?;
+    let scheduler_task = {
+        let scheduler = Arc::clone(&scheduler);
+        tokio::spawn(async move { scheduler.start().await })
+    };
+
+    let trace = Arc::new(Trace::new(args.channels as usize));
+    let counters = Arc::new(Counters::default());
+    let tracer_stop = Arc::new(Notify::new());
+    let tracer_task = tokio::spawn(run_tracer(
+        args.channels,
+        Arc::clone(&rtdb),
+        Arc::clone(&writer),
+        Arc::clone(&trace),
+        Arc::clone(&counters),
+        Arc::clone(&tracer_stop),
+    ));
+
+    let running = Arc::new(AtomicBool::new(true));
+    let started = Instant::now();
+    let pollers: Vec<_> = (0..args.channels as usize)
+        .map(|channel| {
+            tokio::spawn(run_poller(
+                channel,
+                args.clone(),
+                Arc::clone(&writer),
+                Arc::clone(&index),
+                Arc::clone(&buffer),
+                Arc::clone(&routing),
+                Arc::clone(&trace),
+                Arc::clone(&counters),
+                Arc::clone(&running),
+            ))
+        })
+        .collect();
+
+    tokio::time::sleep(Duration::from_secs(args.duration_secs)).await;
+    running.store(false, Ordering::Relaxed);
+    for poller in pollers {
+        let _ = poller.await;
+    }
+    let elapsed = started.elapsed();
+
+    // Let in-flight values reach the downstream stages
+    tokio::time::sleep(Duration::from_millis(DRAIN_GRACE_MS)).await;
+    tracer_stop.notify_one();
+    let _ = tracer_task.await;
+    scheduler.stop();
+    let _ = scheduler_task.await;
+    flush_stop.notify_one();
+    let _ = flush_task.await;
+
+    let timings = scheduler.rule_timings().await;
+    let rule_executions: u64 = timings.iter().map(|t| t.histogram.count).sum();
+    let rule_exec_sum_us: u64 = timings.iter().map(|t| t.histogram.sum_us).sum();
+    let rule_exec_max_us = timings
+        .iter()
+        .map(|t| t.histogram.max_us)
+        .max()
+        .unwrap_or(0);
+
+    let point_updates = counters.point_updates.load(Ordering::Relaxed);
+    Ok(BenchReport {
+        channels: args.channels,
+        points_per_channel: args.points,
+        rules: args.rule_count(),
+        poll_ms: args.poll_ms,
+        change_rate: args.change_rate,
+        duration_secs: elapsed.as_secs_f64(),
+        polls: counters.polls.load(Ordering::Relaxed),
+        point_updates,
+        point_updates_per_sec: point_updates as f64 / elapsed.as_secs_f64(),
+        c2m_writes: counters.c2m_writes.load(Ordering::Relaxed),
+        c2c_forwards: counters.c2c_forwards.load(Ordering::Relaxed),
+        rule_executions,
+        rule_exec_mean_us: rule_exec_sum_us.checked_div(rule_executions).unwrap_or(0),
+        rule_exec_max_us,
+        commands_ring: counters.commands_ring.load(Ordering::Relaxed),
+        commands_todo: counters.commands_todo.load(Ordering::Relaxed),
+        stages: trace.stage_reports(),
+    })
+}
+
+/// Format microseconds for the report table
+fn format_us(us: u64) -> String {
+    if us >= 1_000 {
+        format!("{:.2}ms", us as f64 / 1_000.0)
+    } else {
+        format!("{}µs", us)
+    }
+}
+
+fn print_report(report: &BenchReport) {
+    println!("{}", "Load Harness Report".bright_cyan().bold());
+    println!(
+        "  {} channels × {} points, {} rules, poll {}ms, change rate {:.0}%",
+        report.channels,
+        report.points_per_channel,
+        report.rules,
+        report.poll_ms,
+        report.change_rate * 100.0
+    );
+    println!();
+    println!("{}", "Throughput".bright_cyan());
+    println!(
+        "  Polls:          {} in {:.1}s",
+        report.polls, report.duration_secs
+    );
+    println!(
+        "  Point updates:  {} ({:.0}/s)",
+        report.point_updates, report.point_updates_per_sec
+    );
+    println!(
+        "  C2M / C2C:      {} instance writes, {} forwards",
+        report.c2m_writes, report.c2c_forwards
+    );
+    println!(
+        "  Rule runs:      {} (mean {}, max {})",
+        report.rule_executions,
+        format_us(report.rule_exec_mean_us),
+        format_us(report.rule_exec_max_us)
+    );
+    println!(
+        "  Commands:       {} via ring, {} via TODO",
+        report.commands_ring, report.commands_todo
+    );
+    println!();
+    println!(
+        "{}",
+        format!(
+            "  {:<32} {:>8} {:>10} {:>10} {:>10} {:>10}",
+            "Stage", "Samples", "p50", "p95", "p99", "max"
+        )
+        .bright_cyan()
+    );
+    for stage in &report.stages {
+        println!(
+            "  {:<32} {:>8} {:>10} {:>10} {:>10} {:>10}",
+            stage.description,
+            stage.samples,
+            format_us(stage.p50_us),
+            format_us(stage.p95_us),
+            format_us(stage.p99_us),
+            format_us(stage.max_us)
+        );
+    }
+}
+
+/// Handle `monarch bench`
+pub async fn handle_command(args: BenchArgs) -> Result<()> {
+    let json = args.json;
+    if !json {
+        println!(
+            "{} {} channels × {} points for {}s...",
+            "Running load harness:".bright_cyan(),
+            args.channels,
+            args.points,
+            args.duration_secs
+        );
+    }
+
+    let report = run_bench(args).await?;
+    if json {
+        println!("{}", serde_json::to_string_pretty(&report)?);
+    } else {
+        print_report(&report);
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_percentile_nearest_rank() {
+        let samples: Vec<u64> = (1..=100).collect();
+        assert_eq!(percentile(&samples, 0.50), 50);
+        assert_eq!(percentile(&samples, 0.99), 99);
+        assert_eq!(percentile(&samples, 1.0), 100);
+        assert_eq!(percentile(&[], 0.5), 0);
+    }
+
+    #[test]
+    fn test_point_changes_rate() {
+        let changed = (2..=10_001).filter(|&p| point_changes(p, 7, 0.1)).count();
+        assert!((800..=1200).contains(&changed), "changed {}", changed);
+        assert!(!(2..=1000).any(|p| point_changes(p, 7, 0.0)));
+        assert!((2..=1000).all(|p| point_changes(p, 7, 1.0)));
+    }
+
+    #[test]
+    fn test_probe_rule_flow_parses() {
+        let flow: voltage_rules::types::RuleFlow =
+            serde_json::from_value(probe_rule_flow(3, 2)).expect("valid rule flow");
+        assert_eq!(flow.start_node, "start");
+        assert_eq!(flow.nodes.len(), 4);
+        assert!(flow.trigger.is_some());
+    }
+
+    #[test]
+    fn test_trace_first_arrival_only() {
+        let trace = Trace::new(1);
+        let t0 = Instant::now();
+        trace.record_sent(0, 1, t0);
+        trace.record_sent(0, 2, t0);
+
+        trace.observe(STAGE_INST_M, 0, 2, t0 + Duration::from_millis(3));
+        trace.observe(STAGE_INST_M, 0, 2, t0 + Duration::from_millis(9));
+        trace.observe(STAGE_INST_M, 0, 1, t0 + Duration::from_millis(9));
+
+        let reports = trace.stage_reports();
+        assert_eq!(reports[STAGE_INST_M].samples, 1);
+        assert_eq!(reports[STAGE_INST_M].max_us, 3_000);
+    }
+}
@@ -27,8 +27,11 @@ pub struct ServiceConfig {
     /// Base path for configuration files (e.g., "config" or "/opt/MonarchEdge/config")
     pub config_path: PathBuf,
 
-    /// Redis URL (e.g., "redis://localhost:6379")
+    /// Redis URL (e.g., "redis://localhost:6379"), shard 0 when sharded
     pub redis_url: String,
+
+    /// Additional Redis shards 1..N (`REDIS_SHARD_URLS`), same order as comsrv/modsrv
+    pub redis_shard_urls: Vec<String>,
 }
 
 impl ServiceConfig {
@@ -59,11 +62,45 @@ impl ServiceConfig {
         let redis_url =
             std::env::var("REDIS_URL").unwrap_or_else(|_| "redis://localhost:6379".to_string());
 
+        let redis_shard_urls = std::env::var("REDIS_SHARD_URLS")
+            .map(|urls| {
+                urls.split(',')
+                    .map(str::trim)
+                    .filter(|url| !url.is_empty())
+                    .map(str::to_string)
+                    .collect()
+            })
+            .unwrap_or_default();
+
         Self {
             db_path,
             config_path,
             redis_url,
+            redis_shard_urls,
+        }
+    }
+
+    /// Connect the RTDB, sharded the same way as comsrv/modsrv when
+    /// `REDIS_SHARD_URLS` is set
+    #[cfg(feature = "lib-mode")]
+    async fn connect_rtdb(&self) -> Result<RedisRtdb> {
+        let redis_client = Arc::new(
+            RedisClient::new(&self.redis_url)
+                .await
+                .with_context(|| format!("Failed to connect to Redis at {}", self.redis_url))?,
+        );
+        if self.redis_shard_urls.is_empty() {
+            return Ok(RedisRtdb::from_client(redis_client));
         }
+
+        let shards = common::bootstrap_database::setup_redis_shards(
+            redis_client,
+            &self.redis_shard_urls,
+            common::redis::RedisPoolConfig::default(),
+        )
+        .await
+        .map_err(|e| anyhow::anyhow!("{}", e))?;
+        RedisRtdb::from_shards(shards).context("Invalid Redis shard configuration")
     }
 }
 
@@ -142,15 +179,8 @@ impl ComsrvContext {
             .await
             .with_context(|| format!("Failed to connect to comsrv database at {:?}", db_path))?;
 
-        // Initialize Redis connection via RedisClient
-        let redis_client = Arc::new(
-            RedisClient::new(&config.redis_url)
-                .await
-                .with_context(|| format!("Failed to connect to Redis at {}", config.redis_url))?,
-        );
-
-        // Create RedisRtdb from RedisClient (using concrete type for static dispatch)
-        let rtdb: Arc<RedisRtdb> = Arc::new(RedisRtdb::from_client(redis_client.clone()));
+        // Create RedisRtdb (using concrete type for static dispatch)
+        let rtdb: Arc<RedisRtdb> = Arc::new(config.connect_rtdb().await?);
 
         // Create empty routing cache (Monarch doesn't use routing)
         let routing_cache = Arc::new(voltage_rtdb::RoutingCache::new());
@@ -188,14 +218,7 @@ impl ModsrvContext {
             .await
             .with_context(|| format!("Failed to connect to modsrv database at {:?}", db_path))?;
 
-        // Initialize Redis connection
-        let redis_client = Arc::new(
-            RedisClient::new(&config.redis_url)
-                .await
-                .with_context(|| format!("Failed to connect to Redis at {}", config.redis_url))?,
-        );
-
-        let rtdb = Arc::new(RedisRtdb::from_client(redis_client.clone()));
+        let rtdb = Arc::new(config.connect_rtdb().await?);
 
         // Create product loader (products are now loaded from code definitions)
         let product_loader = Arc::new(ProductLoader::new(sqlite_pool.clone()));
@@ -19,7 +19,7 @@ use super::file_utils;
 // ============================================================================
 
 /// Rules table SQL
-const RULE_CHAINS_TABLE: &str = r#"
+pub(crate) const RULE_CHAINS_TABLE: &str = r#"
     CREATE TABLE IF NOT EXISTS rules (
         id INTEGER PRIMARY KEY,
         name TEXT NOT NULL,
@@ -130,6 +130,9 @@ pub async fn init_database(db_path: impl AsRef<Path>) -> Result<()> {
     sqlx::query(comsrv_schema::ADJUSTMENT_POINTS_TABLE)
         .execute(&pool)
         .await?;
+    sqlx::query(comsrv_schema::POINT_DEADBANDS_TABLE)
+        .execute(&pool)
+        .await?;
 
     // === Instance tables (modsrv) ===
     // Note: Product tables (products, measurement_points, action_points, property_templates)
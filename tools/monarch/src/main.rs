@@ -3,6 +3,7 @@
 //! A powerful management tool that combines configuration synchronization,
 //! service management, and operational control for all VoltageEMS services.
 
+mod bench;
 mod channels;
 mod context;
 mod core;
@@ -112,6 +113,7 @@ Service Operations:
   rules       Manage and execute business rules
   services    Start, stop, and manage VoltageEMS services
   logs        Dynamically adjust log levels for running services
+  bench       Load and latency harness on virtual channels
 
 Examples:
   monarch sync                          # Sync all configurations
@@ -122,6 +124,7 @@ Examples:
   monarch services status               # Check service status
   monarch logs level all debug          # Switch all services to debug mode
   monarch logs get all                  # Show current log levels
+  monarch bench --channels 50 --points 200   # Size a gateway
 
 Use 'monarch <command> --help' for more information on a specific command.")]
 #[command(version)]
@@ -251,6 +254,13 @@ enum Commands {
         command: Option<shm::ShmCommands>,
     },
 
+    /// Load and latency harness
+    #[command(about = "Drive virtual channels through comsrv/modsrv paths and report latencies")]
+    Bench {
+        #[command(flatten)]
+        args: bench::BenchArgs,
+    },
+
     /// System health check and diagnostics
     #[command(about = "Check system health and diagnose issues")]
     Doctor {
@@ -454,6 +464,9 @@ async fn main() -> Result<()> {
             // Shm command doesn't need async or service context
             shm::handle_command(command)?;
         },
+        Commands::Bench { args } => {
+            bench::handle_command(args).await?;
+        },
         Commands::Doctor { verbose, json } => {
             doctor::run_doctor(config_path, db_path, verbose, json).await?;
         },
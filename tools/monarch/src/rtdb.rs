@@ -2,15 +2,20 @@
 //!
 //! Provides direct Redis operations for debugging and inspection
 
-use anyhow::Result;
+use anyhow::{Context, Result};
 use clap::Subcommand;
+use std::path::PathBuf;
 use tracing::{info, warn};
+use voltage_rtdb::{
+    default_shm_path, default_snapshot_path, restore_snapshot_into, RtdbSnapshot, SharedConfig,
+    SharedVecRtdbReader,
+};
 
 #[cfg(feature = "lib-mode")]
 use crate::context::ServiceContext;
 
 #[cfg(feature = "lib-mode")]
-use voltage_rtdb::{Bytes, Rtdb};
+use voltage_rtdb::{Bytes, RedisRtdb, Rtdb};
 
 #[derive(Subcommand)]
 pub enum RtdbCommands {
@@ -69,55 +74,97 @@ pub enum RtdbCommands {
     /// List common key patterns
     #[command(about = "Show common Redis key patterns used in VoltageEMS")]
     Patterns,
+
+    /// Save a warm-start snapshot of the shared memory RTDB
+    #[command(about = "Save a warm-start snapshot of the shared memory point slots")]
+    Snapshot {
+        /// Snapshot file (default: next to the shared memory file, or VOLTAGE_SHM_SNAPSHOT_PATH)
+        #[arg(short, long)]
+        output: Option<PathBuf>,
+    },
+
+    /// Restore a warm-start snapshot into the shared memory RTDB
+    #[command(
+        about = "Restore a snapshot into shared memory (points marked restored until polled)"
+    )]
+    Restore {
+        /// Snapshot file (default: next to the shared memory file, or VOLTAGE_SHM_SNAPSHOT_PATH)
+        #[arg(short, long)]
+        input: Option<PathBuf>,
+    },
 }
 
 pub async fn handle_command(cmd: RtdbCommands, service_ctx: Option<&ServiceContext>) -> Result<()> {
     #[cfg(feature = "lib-mode")]
-    {
-        if service_ctx.is_none() {
-            warn!("RTDB commands require offline mode (--offline flag)");
-            warn!("Please run with --offline to use lib-mode RTDB access");
-            return Ok(());
-        }
-
-        let ctx = service_ctx.expect("service_ctx checked above");
-
-        // Use modsrv's RTDB (all services share same Redis)
-        let modsrv = ctx.modsrv()?;
-        let rtdb = &modsrv.rtdb;
-
-        match cmd {
-            RtdbCommands::Get { key, field } => {
-                handle_get(&**rtdb, &key, field.as_deref()).await?;
-            },
-            RtdbCommands::Set { key, value, field } => {
-                handle_set(&**rtdb, &key, &value, field.as_deref()).await?;
-            },
-            RtdbCommands::Scan { pattern, limit } => {
-                handle_scan(&**rtdb, &pattern, limit).await?;
-            },
-            RtdbCommands::Del { keys, force } => {
-                handle_del(&**rtdb, &keys, force).await?;
-            },
-            RtdbCommands::Inspect { key, full } => {
-                handle_inspect(&**rtdb, &key, full).await?;
-            },
-            RtdbCommands::Patterns => {
-                show_patterns();
-            },
-        }
+    match cmd {
+        RtdbCommands::Get { key, field } => {
+            if let Some(rtdb) = service_rtdb(service_ctx)? {
+                handle_get(rtdb, &key, field.as_deref()).await?;
+            }
+        },
+        RtdbCommands::Set { key, value, field } => {
+            if let Some(rtdb) = service_rtdb(service_ctx)? {
+                handle_set(rtdb, &key, &value, field.as_deref()).await?;
+            }
+        },
+        RtdbCommands::Scan { pattern, limit } => {
+            if let Some(rtdb) = service_rtdb(service_ctx)? {
+                handle_scan(rtdb, &pattern, limit).await?;
+            }
+        },
+        RtdbCommands::Del { keys, force } => {
+            if let Some(rtdb) = service_rtdb(service_ctx)? {
+                handle_del(rtdb, &keys, force).await?;
+            }
+        },
+        RtdbCommands::Inspect { key, full } => {
+            if let Some(rtdb) = service_rtdb(service_ctx)? {
+                handle_inspect(rtdb, &key, full).await?;
+            }
+        },
+        RtdbCommands::Patterns => {
+            show_patterns();
+        },
+        // Snapshots work on the local shared memory file, no service context needed
+        RtdbCommands::Snapshot { output } => {
+            handle_snapshot(output)?;
+        },
+        RtdbCommands::Restore { input } => {
+            handle_restore(input)?;
+        },
     }
 
     #[cfg(not(feature = "lib-mode"))]
-    {
-        let _ = (cmd, service_ctx);
-        warn!("RTDB commands are only available in lib-mode");
-        warn!("Please rebuild monarch with --features lib-mode");
+    match cmd {
+        RtdbCommands::Snapshot { output } => {
+            handle_snapshot(output)?;
+        },
+        RtdbCommands::Restore { input } => {
+            handle_restore(input)?;
+        },
+        _ => {
+            let _ = service_ctx;
+            warn!("RTDB commands are only available in lib-mode");
+            warn!("Please rebuild monarch with --features lib-mode");
+        },
     }
 
     Ok(())
 }
 
+/// Redis RTDB for key commands (None if monarch runs without service context)
+#[cfg(feature = "lib-mode")]
+fn service_rtdb(service_ctx: Option<&ServiceContext>) -> Result<Option<&RedisRtdb>> {
+    let Some(ctx) = service_ctx else {
+        warn!("RTDB commands require offline mode (--offline flag)");
+        warn!("Please run with --offline to use lib-mode RTDB access");
+        return Ok(None);
+    };
+
+    // Use modsrv's RTDB (all services share same Redis)
+    Ok(Some(ctx.modsrv()?.rtdb.as_ref()))
+}
+
 #[cfg(feature = "lib-mode")]
 async fn handle_get(rtdb: &impl Rtdb, key: &str, field: Option<&str>) -> Result<()> {
     if let Some(field) = field {
@@ -297,6 +344,43 @@ async fn handle_inspect(rtdb: &impl Rtdb, key: &str, full: bool) -> Result<()> {
     Ok(())
 }
 
+fn handle_snapshot(output: Option<PathBuf>) -> Result<()> {
+    let config = SharedConfig::from_segment(default_shm_path())?;
+    let reader = SharedVecRtdbReader::open(&config)
+        .with_context(|| format!("Failed to open shared memory at {:?}", config.path))?;
+    let path = output.unwrap_or_else(default_snapshot_path);
+
+    let snapshot = reader.snapshot();
+    snapshot.write_to(&path)?;
+
+    println!(
+        "✓ Saved {} points to {}",
+        snapshot.records.len(),
+        path.display()
+    );
+    Ok(())
+}
+
+fn handle_restore(input: Option<PathBuf>) -> Result<()> {
+    let config = SharedConfig::from_segment(default_shm_path())?;
+    let path = input.unwrap_or_else(default_snapshot_path);
+
+    let snapshot = RtdbSnapshot::read_from(&path)?;
+    let restored = restore_snapshot_into(&config, &snapshot)
+        .with_context(|| format!("Failed to restore into shared memory at {:?}", config.path))?;
+
+    println!(
+        "✓ Restored {} of {} points from {}",
+        restored,
+        snapshot.records.len(),
+        path.display()
+    );
+    if restored < snapshot.records.len() {
+        println!("  (skipped points are unregistered or have newer live values)");
+    }
+    Ok(())
+}
+
 fn show_patterns() {
     println!("=== Common Redis Key Patterns in VoltageEMS ===\n");
 
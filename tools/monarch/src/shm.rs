@@ -15,7 +15,7 @@ use rustyline::validate::Validator;
 use rustyline::{Editor, Helper};
 use std::io;
 use std::time::{Duration, Instant};
-use voltage_rtdb::{default_shm_path, SharedConfig, SharedVecRtdbReader};
+use voltage_rtdb::{default_shm_path, PointSnapshot, SharedConfig, SharedVecRtdbReader};
 
 // TUI imports
 use crossterm::event::{self, Event, KeyCode, KeyEventKind};
@@ -313,7 +313,9 @@ pub fn handle_command(cmd: Option<ShmCommands>) -> Result<()> {
 /// Open shared memory reader
 fn open_reader() -> Result<SharedVecRtdbReader> {
     let path = default_shm_path();
-    let config = SharedConfig::default().with_path(path.clone());
+    // Dimensions come from the segment comsrv created, not the defaults
+    let config = SharedConfig::from_segment(path.clone())
+        .with_context(|| format!("Failed to read shared memory layout at {:?}", path))?;
 
     SharedVecRtdbReader::open(&config)
         .with_context(|| format!("Failed to open shared memory at {:?}", path))
@@ -365,6 +367,35 @@ fn get_value(reader: &SharedVecRtdbReader, key: &ShmKey) -> Option<f64> {
     }
 }
 
+/// Get a consistent snapshot (value + timestamp) from shared memory
+fn get_snapshot(reader: &SharedVecRtdbReader, key: &ShmKey) -> Option<PointSnapshot> {
+    match key {
+        ShmKey::Instance {
+            instance_id,
+            point_type,
+            point_id,
+        } => reader.get_consistent(*instance_id, *point_type, *point_id),
+        ShmKey::Channel {
+            channel_id,
+            point_type,
+            point_id,
+        } => reader.get_channel_consistent(*channel_id, *point_type, *point_id),
+    }
+}
+
+/// Format point age (time since last write) for display
+fn format_age(timestamp: u64) -> String {
+    if timestamp == 0 {
+        return "never".to_string();
+    }
+    let age_ms = voltage_rtdb::shared_impl::timestamp_ms().saturating_sub(timestamp);
+    if age_ms < 1000 {
+        format!("{}ms", age_ms)
+    } else {
+        format!("{:.1}s", age_ms as f64 / 1000.0)
+    }
+}
+
 /// Print shared memory info/statistics
 fn print_info(reader: &SharedVecRtdbReader) {
     let stats = reader.stats();
@@ -418,19 +449,63 @@ fn watch_key(reader: &SharedVecRtdbReader, key: &ShmKey, interval_ms: u64) -> Re
 
     let interval = Duration::from_millis(interval_ms);
 
+    // With the change ring, only print when the watched slot was written
+    let slot_offset = slot_offset_of(reader, key).filter(|_| reader.has_change_ring());
+    let mut cursor = reader.change_cursor();
+    let mut first = true;
+
     loop {
-        let value = get_value(reader, key);
-        let now = format_current_time();
+        let changed = match slot_offset {
+            Some(offset) => {
+                let mut hit = false;
+                let result = reader.drain_changes(cursor, usize::MAX, |event| {
+                    hit |= event.slot_offset == offset;
+                });
+                cursor = result;
+                hit || result.lost > 0
+            },
+            None => true,
+        };
 
-        match value {
-            Some(v) => println!("[{}] {}", now, v),
-            None => println!("[{}] (nil)", now),
+        if changed || first {
+            print_watch_line(get_snapshot(reader, key));
+            first = false;
         }
 
         std::thread::sleep(interval);
     }
 }
 
+/// Absolute slot offset of a key (matches change ring events)
+fn slot_offset_of(reader: &SharedVecRtdbReader, key: &ShmKey) -> Option<usize> {
+    match key {
+        ShmKey::Instance {
+            instance_id,
+            point_type,
+            point_id,
+        } => reader.instance_slot_offset(*instance_id, *point_type, *point_id),
+        ShmKey::Channel {
+            channel_id,
+            point_type,
+            point_id,
+        } => reader.channel_slot_offset(*channel_id, *point_type, *point_id),
+    }
+}
+
+/// Print one watch output line
+fn print_watch_line(snapshot: Option<PointSnapshot>) {
+    let now = format_current_time();
+    match snapshot {
+        Some(snap) => println!(
+            "[{}] {} (age {})",
+            now,
+            snap.value,
+            format_age(snap.timestamp)
+        ),
+        None => println!("[{}] (nil)", now),
+    }
+}
+
 /// Format current time as HH:MM:SS
 fn format_current_time() -> String {
     use std::time::{SystemTime, UNIX_EPOCH};
@@ -611,6 +686,8 @@ struct PointRow {
     key: String,
     kind: &'static str,
     value: f64,
+    /// Timestamp of the last write (ms, 0 = never written)
+    timestamp: u64,
 }
 
 /// Dashboard application state
@@ -736,6 +813,7 @@ fn refresh_point_data(reader: &SharedVecRtdbReader, state: &mut DashboardState)
 
     if should_rescan {
         state.points = collect_all_points(reader);
+        update_point_values(reader, &mut state.points);
         state.last_instance_count = stats.instance_count;
         state.last_channel_count = stats.channel_count;
         state.last_scan = Instant::now();
@@ -760,6 +838,7 @@ fn collect_all_points(reader: &SharedVecRtdbReader) -> Vec<PointRow> {
                 key: format!("inst:{}:M:{}", inst_id, point_id),
                 kind: "M",
                 value,
+                timestamp: 0,
             });
         });
         // Action points
@@ -768,6 +847,7 @@ fn collect_all_points(reader: &SharedVecRtdbReader) -> Vec<PointRow> {
                 key: format!("inst:{}:A:{}", inst_id, point_id),
                 kind: "A",
                 value,
+                timestamp: 0,
             });
         });
     }
@@ -785,6 +865,7 @@ fn collect_all_points(reader: &SharedVecRtdbReader) -> Vec<PointRow> {
                     key: format!("ch:{}:{}:{}", ch_id, point_type.as_str(), point_id),
                     kind: point_type.as_str(),
                     value,
+                    timestamp: 0,
                 });
             });
         }
@@ -797,8 +878,9 @@ fn collect_all_points(reader: &SharedVecRtdbReader) -> Vec<PointRow> {
 fn update_point_values(reader: &SharedVecRtdbReader, points: &mut [PointRow]) {
     for point in points.iter_mut() {
         if let Ok(key) = parse_key(&point.key) {
-            if let Some(value) = get_value(reader, &key) {
-                point.value = value;
+            if let Some(snap) = get_snapshot(reader, &key) {
+                point.value = snap.value;
+                point.timestamp = snap.timestamp;
             }
         }
     }
@@ -849,7 +931,7 @@ fn draw_dashboard(f: &mut ratatui::Frame, reader: &SharedVecRtdbReader, state: &
         .fg(Color::Yellow)
         .add_modifier(Modifier::BOLD);
 
-    let header = Row::new(["Key", "Type", "Value"])
+    let header = Row::new(["Key", "Type", "Value", "Age"])
         .style(header_style)
         .height(1);
 
@@ -859,7 +941,12 @@ fn draw_dashboard(f: &mut ratatui::Frame, reader: &SharedVecRtdbReader, state: &
         .skip(state.scroll_offset)
         .map(|p| {
             let value_str = format!("{:.6}", p.value);
-            Row::new([p.key.clone(), p.kind.to_string(), value_str])
+            Row::new([
+                p.key.clone(),
+                p.kind.to_string(),
+                value_str,
+                format_age(p.timestamp),
+            ])
         })
         .collect();
 
@@ -867,6 +954,7 @@ fn draw_dashboard(f: &mut ratatui::Frame, reader: &SharedVecRtdbReader, state: &
         Constraint::Length(20),
         Constraint::Length(6),
         Constraint::Min(15),
+        Constraint::Length(10),
     ];
 
     let table = Table::new(visible_rows, widths)